@@ -0,0 +1,1293 @@
+/*
+ * waterspout
+ *
+ *   - simd abstraction library for audio/image manipulation -
+ *
+ * Copyright (c) 2015 Lucio Asnaghi
+ *
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __WATERSPOUT_SIMD_ABSTRACTION_FRAMEWORK_BENCH_BENCHMARK_H__
+#define __WATERSPOUT_SIMD_ABSTRACTION_FRAMEWORK_BENCH_BENCHMARK_H__
+
+#include <waterspout.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+//==============================================================================
+
+using namespace waterspout;
+
+
+//==============================================================================
+
+/**
+ * Monotonic nanoseconds clock used by the measurements
+ */
+
+class bench_clock
+{
+public:
+    static forcedinline double now()
+    {
+        return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+
+//==============================================================================
+
+/**
+ * Reduction results are accumulated here so the calls can't be optimized away
+ */
+
+static volatile double bench_sink = 0.0;
+
+
+//------------------------------------------------------------------------------
+
+/**
+ * A benchmarked operation: one function of the math interface on one datatype.
+ *
+ * Every operation receives four buffers of the same datatype: the first is
+ * the source, the second a source that never holds zeros (divisor), the third
+ * a third source and the fourth the destination. The streams member counts the
+ * elements read or written per processed element, which gives the GB/s.
+ */
+
+struct bench_op
+{
+    typedef void (*run_function) (math_interface_* m, void** buffers, uint32 size);
+    typedef void (*fill_function) (void* buffer, uint32 size, int pattern);
+
+    const char* name;
+    const char* type;
+    uint32 type_size;
+    uint32 streams;
+    run_function run;
+    fill_function fill;
+};
+
+
+//------------------------------------------------------------------------------
+
+// buffers are filled with small values that can't overflow, underflow or
+// divide by zero however many times an in place operation is repeated, so the
+// floating point exceptions enabled by the library never fire
+template<typename T>
+void bench_fill_buffer(void* buffer, uint32 size, int pattern)
+{
+    T* data = (T*)buffer;
+
+    for (uint32 i = 0; i < size; ++i)
+    {
+        switch (pattern)
+        {
+        case 0: data[i] = (T)(i % 13); break;
+        case 1: data[i] = (T)(i % 7 + 1); break;
+        case 2: data[i] = (T)(i % 5); break;
+        default: data[i] = (T)0; break;
+        }
+    }
+}
+
+template<>
+inline void bench_fill_buffer<float>(void* buffer, uint32 size, int pattern)
+{
+    float* data = (float*)buffer;
+
+    for (uint32 i = 0; i < size; ++i)
+    {
+        switch (pattern)
+        {
+        case 0: data[i] = ((int)(i % 13) - 6) * 0.25f; break;
+        case 1: data[i] = (float)(i % 7 + 1); break;
+        case 2: data[i] = ((int)(i % 5) - 2) * 0.5f; break;
+        default: data[i] = 0.0f; break;
+        }
+    }
+}
+
+template<>
+inline void bench_fill_buffer<double>(void* buffer, uint32 size, int pattern)
+{
+    double* data = (double*)buffer;
+
+    for (uint32 i = 0; i < size; ++i)
+    {
+        switch (pattern)
+        {
+        case 0: data[i] = ((int)(i % 13) - 6) * 0.25; break;
+        case 1: data[i] = (double)(i % 7 + 1); break;
+        case 2: data[i] = ((int)(i % 5) - 2) * 0.5; break;
+        default: data[i] = 0.0; break;
+        }
+    }
+}
+
+
+//------------------------------------------------------------------------------
+
+#define bench_buffer_arg(datatype, index) \
+    ((datatype*)buffers[index])
+
+#define bench_set_buffer_impl(datatype) \
+    static void bench_clear_buffer_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->clear_buffer_##datatype(bench_buffer_arg(datatype, 3), size); \
+    } \
+    \
+    static void bench_set_buffer_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->set_buffer_##datatype(bench_buffer_arg(datatype, 3), size, (datatype)3); \
+    }
+
+#define bench_scale_buffer_impl(datatype) \
+    static void bench_scale_buffer_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->scale_buffer_##datatype(bench_buffer_arg(datatype, 3), size, 1.0f); \
+    }
+
+#define bench_abs_buffer_impl(datatype) \
+    static void bench_abs_buffer_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->abs_buffer_##datatype(bench_buffer_arg(datatype, 3), size); \
+    }
+
+#define bench_copy_buffer_impl(datatype) \
+    static void bench_copy_buffer_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->copy_buffer_##datatype(bench_buffer_arg(datatype, 0), bench_buffer_arg(datatype, 3), size); \
+    }
+
+#define bench_binary_buffers_impl(function, datatype) \
+    static void bench_##function##_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->function##_##datatype(bench_buffer_arg(datatype, 0), bench_buffer_arg(datatype, 1), \
+            bench_buffer_arg(datatype, 3), size); \
+    }
+
+#define bench_reduction_impl(function, datatype) \
+    static void bench_##function##_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        bench_sink = bench_sink + (double)m->function##_##datatype(bench_buffer_arg(datatype, 0), size); \
+    }
+
+#define bench_dot_product_impl(datatype) \
+    static void bench_dot_product_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        bench_sink = bench_sink + (double)m->dot_product_##datatype( \
+            bench_buffer_arg(datatype, 0), bench_buffer_arg(datatype, 1), size); \
+    }
+
+#define bench_extreme_buffer_impl(function, datatype) \
+    static void bench_##function##_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        uint32 index = 0; \
+        bench_sink = bench_sink + (double)m->function##_##datatype(bench_buffer_arg(datatype, 0), size, &index); \
+        bench_sink = bench_sink + (double)index; \
+    }
+
+#define bench_multiply_add_buffers_impl(datatype) \
+    static void bench_multiply_add_buffers_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->multiply_add_buffers_##datatype(bench_buffer_arg(datatype, 0), bench_buffer_arg(datatype, 1), \
+            bench_buffer_arg(datatype, 2), bench_buffer_arg(datatype, 3), size); \
+    }
+
+#define bench_scale_add_buffer_impl(datatype) \
+    static void bench_scale_add_buffer_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->scale_add_buffer_##datatype(bench_buffer_arg(datatype, 0), bench_buffer_arg(datatype, 3), \
+            size, (datatype)1); \
+    }
+
+// unity ramps keep the buffer stable across runs while doing the full work
+#define bench_ramp_scale_buffer_impl(function, datatype) \
+    static void bench_##function##_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->function##_##datatype(bench_buffer_arg(datatype, 3), size, (datatype)1, (datatype)1); \
+    }
+
+// interleaving moves size / 2 stereo frames, that is size samples
+#define bench_mixing_functions_impl(datatype) \
+    static void bench_pan_mono_to_stereo_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->pan_mono_to_stereo_##datatype(bench_buffer_arg(datatype, 0), bench_buffer_arg(datatype, 2), \
+            bench_buffer_arg(datatype, 3), size, (datatype)0.25, CONSTANT_POWER_PAN_LAW); \
+    } \
+    \
+    static void bench_ramp_pan_mono_to_stereo_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->ramp_pan_mono_to_stereo_##datatype(bench_buffer_arg(datatype, 0), bench_buffer_arg(datatype, 2), \
+            bench_buffer_arg(datatype, 3), size, (datatype)-0.5, (datatype)0.5, CONSTANT_POWER_PAN_LAW); \
+    } \
+    \
+    static void bench_balance_stereo_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->balance_stereo_##datatype(bench_buffer_arg(datatype, 2), bench_buffer_arg(datatype, 3), \
+            size, (datatype)0); \
+    } \
+    \
+    static void bench_ramp_balance_stereo_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->ramp_balance_stereo_##datatype(bench_buffer_arg(datatype, 2), bench_buffer_arg(datatype, 3), \
+            size, (datatype)0, (datatype)0); \
+    } \
+    \
+    static void bench_mix_dry_wet_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->mix_dry_wet_##datatype(bench_buffer_arg(datatype, 0), bench_buffer_arg(datatype, 1), \
+            bench_buffer_arg(datatype, 3), size, (datatype)0.5); \
+    } \
+    \
+    static void bench_ramp_mix_dry_wet_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->ramp_mix_dry_wet_##datatype(bench_buffer_arg(datatype, 0), bench_buffer_arg(datatype, 1), \
+            bench_buffer_arg(datatype, 3), size, (datatype)0, (datatype)1); \
+    } \
+    \
+    static void bench_interleave_buffers_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        datatype* src_buffers[2] = { bench_buffer_arg(datatype, 0), bench_buffer_arg(datatype, 1) }; \
+        m->interleave_buffers_##datatype(src_buffers, bench_buffer_arg(datatype, 3), 2, size / 2); \
+    } \
+    \
+    static void bench_deinterleave_buffer_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        datatype* dst_buffers[2] = { bench_buffer_arg(datatype, 2), bench_buffer_arg(datatype, 3) }; \
+        m->deinterleave_buffer_##datatype(bench_buffer_arg(datatype, 0), dst_buffers, 2, size / 2); \
+    }
+
+// the integer samples live in the datatype buffers, which are wide enough
+#define bench_conversion_functions_impl(integer, datatype) \
+    static void bench_convert_from_##integer##_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->convert_buffer_##integer##_to_##datatype(bench_buffer_arg(integer, 0), \
+            bench_buffer_arg(datatype, 3), size); \
+    } \
+    \
+    static void bench_convert_to_##integer##_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->convert_buffer_##datatype##_to_##integer(bench_buffer_arg(datatype, 0), \
+            bench_buffer_arg(integer, 3), size, NEAREST, nullptr); \
+    }
+
+// a bank of 16 channels of two sections shared by every run, the state keeps
+// following the fed samples so it never decays into denormals
+template<typename T>
+biquad_bank<T>& bench_biquad_bank()
+{
+    static biquad_bank<T> bank(16, 2);
+    static bool configured = false;
+
+    if (! configured)
+    {
+        for (uint32 channel = 0; channel < bank.channels(); ++channel)
+        {
+            bank.set_section(channel, 0, T(0.25), T(0.25), T(0.125), T(-0.5), T(0.125));
+            bank.set_section(channel, 1, T(0.25), T(0.25), T(0.125), T(-0.5), T(0.125));
+        }
+
+        configured = true;
+    }
+
+    return bank;
+}
+
+// a 32 taps filter of 8 phases stepping one sample per output, like a
+// resampler running near unity ratio, over chunks of outputs sharing the
+// row and offset tables
+template<typename T>
+struct bench_polyphase_tables
+{
+    enum { taps = 32, phases = 8, chunk = 4096 };
+
+    bench_polyphase_tables()
+    {
+        for (uint32 k = 0; k < taps * phases; ++k)
+            coefficients[k] = T(1) / T(1 + k % 11);
+
+        for (uint32 i = 0; i < chunk; ++i)
+        {
+            rows[i] = i % phases;
+            offsets[i] = i;
+        }
+    }
+
+    T coefficients[taps * phases];
+    uint32 rows[chunk];
+    uint32 offsets[chunk];
+};
+
+template<typename T>
+const bench_polyphase_tables<T>& bench_polyphase()
+{
+    static const bench_polyphase_tables<T> tables;
+    return tables;
+}
+
+#define bench_filter_functions_impl(datatype) \
+    static void bench_process_biquad_bank_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        datatype##_biquad_bank& bank = bench_biquad_bank<datatype>(); \
+        m->process_biquad_bank_##datatype(bench_buffer_arg(datatype, 0), bench_buffer_arg(datatype, 3), \
+            bank.channels(), size / bank.channels(), bank.coefficients(), bank.state(), bank.sections()); \
+    } \
+    \
+    static void bench_process_polyphase_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        const bench_polyphase_tables<datatype>& tables = bench_polyphase<datatype>(); \
+        const uint32 taps = bench_polyphase_tables<datatype>::taps; \
+        const uint32 chunk = bench_polyphase_tables<datatype>::chunk; \
+        \
+        for (uint32 i = 0; i + taps < size; i += chunk) \
+        { \
+            const uint32 outputs = size - taps - i < chunk ? size - taps - i : chunk; \
+            m->process_polyphase_##datatype(bench_buffer_arg(datatype, 0) + i, bench_buffer_arg(datatype, 3) + i, \
+                outputs, const_cast<datatype*>(tables.coefficients), taps, \
+                const_cast<uint32*>(tables.rows), const_cast<uint32*>(tables.offsets)); \
+        } \
+    }
+
+// twiddles laid out as the transform functions read them, one table for each
+// size, which stops at 64k so larger buffers are run as many transforms
+template<typename T>
+const T* bench_fft_twiddles(uint32 size)
+{
+    static std::map<uint32, std::vector<T> > tables;
+
+    std::vector<T>& table = tables[size];
+    if (table.empty())
+    {
+        table.resize(size * 2 + 6);
+
+        uint32 bits = 0;
+        while ((1u << bits) < size)
+            ++bits;
+
+        T* twiddle = table.data();
+        for (uint32 span = (bits & 1) ? 2 : 1; span < size; span *= 4)
+        {
+            for (uint32 k = 0; k < span; ++k)
+            {
+                const double angle = -2.0 * 3.14159265358979323846 * k / (4.0 * span);
+
+                twiddle[k] = (T)std::cos(angle);
+                twiddle[span + k] = (T)std::sin(angle);
+                twiddle[2 * span + k] = (T)std::cos(2.0 * angle);
+                twiddle[3 * span + k] = (T)std::sin(2.0 * angle);
+                twiddle[4 * span + k] = (T)std::cos(3.0 * angle);
+                twiddle[5 * span + k] = (T)std::sin(3.0 * angle);
+            }
+
+            twiddle += 6 * span;
+        }
+    }
+
+    return table.data();
+}
+
+// the sources are copied first, transforming the same values over and over
+// would overflow them
+#define bench_transform_functions_impl(datatype) \
+    static void bench_fft_butterflies_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        uint32 fft_size = 2; \
+        while (fft_size * 2 <= size && fft_size < 65536) \
+            fft_size *= 2; \
+        \
+        const datatype* twiddles = bench_fft_twiddles<datatype>(fft_size); \
+        \
+        for (uint32 i = 0; i + fft_size <= size; i += fft_size) \
+        { \
+            m->copy_buffer_##datatype(bench_buffer_arg(datatype, 0) + i, bench_buffer_arg(datatype, 3) + i, fft_size); \
+            m->copy_buffer_##datatype(bench_buffer_arg(datatype, 1) + i, bench_buffer_arg(datatype, 2) + i, fft_size); \
+            m->fft_butterflies_##datatype(bench_buffer_arg(datatype, 3) + i, bench_buffer_arg(datatype, 2) + i, \
+                fft_size, twiddles); \
+        } \
+    }
+
+// a bank of 16 channels following the peaks with a short attack and a long
+// release, shared by every run like the biquad bank
+template<typename T>
+envelope_bank<T>& bench_envelope_bank()
+{
+    static envelope_bank<T> bank(16);
+    static bool configured = false;
+
+    if (! configured)
+    {
+        for (uint32 channel = 0; channel < bank.channels(); ++channel)
+        {
+            bank.set_times(channel, 0.001, 0.1, 48000.0);
+        }
+
+        configured = true;
+    }
+
+    return bank;
+}
+
+#define bench_dynamics_functions_impl(datatype) \
+    static void bench_process_envelope_bank_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        datatype##_envelope_bank& bank = bench_envelope_bank<datatype>(); \
+        m->process_envelope_bank_##datatype(bench_buffer_arg(datatype, 0), bench_buffer_arg(datatype, 3), \
+            bank.channels(), size / bank.channels(), bank.coefficients(), bank.state(), PEAK_ENVELOPE); \
+    } \
+    \
+    static void bench_compressor_gain_buffer_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->compressor_gain_buffer_##datatype(bench_buffer_arg(datatype, 0), bench_buffer_arg(datatype, 3), \
+            size, (datatype)-20, (datatype)4, (datatype)6); \
+    } \
+    \
+    static void bench_limiter_gain_buffer_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->limiter_gain_buffer_##datatype(bench_buffer_arg(datatype, 0), bench_buffer_arg(datatype, 3), \
+            size, (datatype)0.5); \
+    } \
+    \
+    static void bench_soft_clip_buffer_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->soft_clip_buffer_##datatype(bench_buffer_arg(datatype, 0), bench_buffer_arg(datatype, 3), size); \
+    }
+
+// both accuracies are measured, the logarithms and powers read the positive
+// buffer so they never end up in the NaN paths
+#define bench_transcendental_impl(function, datatype, source) \
+    static void bench_##function##_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->function##_##datatype(bench_buffer_arg(datatype, source), bench_buffer_arg(datatype, 3), \
+            size, ACCURATE_MATH_ACCURACY); \
+    } \
+    \
+    static void bench_##function##_fast_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->function##_##datatype(bench_buffer_arg(datatype, source), bench_buffer_arg(datatype, 3), \
+            size, FAST_MATH_ACCURACY); \
+    }
+
+#define bench_transcendental_functions_impl(datatype) \
+    bench_transcendental_impl(exp_buffer, datatype, 0) \
+    bench_transcendental_impl(log_buffer, datatype, 1) \
+    bench_transcendental_impl(sin_buffer, datatype, 0) \
+    bench_transcendental_impl(tanh_buffer, datatype, 0) \
+    \
+    static void bench_sincos_buffer_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->sincos_buffer_##datatype(bench_buffer_arg(datatype, 0), bench_buffer_arg(datatype, 2), \
+            bench_buffer_arg(datatype, 3), size, ACCURATE_MATH_ACCURACY); \
+    } \
+    \
+    static void bench_sincos_buffer_fast_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->sincos_buffer_##datatype(bench_buffer_arg(datatype, 0), bench_buffer_arg(datatype, 2), \
+            bench_buffer_arg(datatype, 3), size, FAST_MATH_ACCURACY); \
+    } \
+    \
+    static void bench_pow_buffer_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->pow_buffer_##datatype(bench_buffer_arg(datatype, 1), bench_buffer_arg(datatype, 0), \
+            bench_buffer_arg(datatype, 3), size, ACCURATE_MATH_ACCURACY); \
+    } \
+    \
+    static void bench_pow_buffer_fast_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->pow_buffer_##datatype(bench_buffer_arg(datatype, 1), bench_buffer_arg(datatype, 0), \
+            bench_buffer_arg(datatype, 3), size, FAST_MATH_ACCURACY); \
+    }
+
+// the buffers are read as rgba pixels, four elements each, so the element
+// throughput stays comparable with the other operations
+#define bench_pixel_functions_impl(datatype) \
+    static void bench_premultiply_rgba_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->premultiply_rgba_##datatype(bench_buffer_arg(datatype, 0), bench_buffer_arg(datatype, 3), size / 4); \
+    } \
+    \
+    static void bench_unpremultiply_rgba_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->unpremultiply_rgba_##datatype(bench_buffer_arg(datatype, 0), bench_buffer_arg(datatype, 3), size / 4); \
+    } \
+    \
+    static void bench_composite_rgba_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->composite_rgba_##datatype(bench_buffer_arg(datatype, 0), bench_buffer_arg(datatype, 1), \
+            bench_buffer_arg(datatype, 3), size / 4, SOURCE_OVER_COMPOSITE); \
+    } \
+    \
+    static void bench_composite_rgba_overlay_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->composite_rgba_##datatype(bench_buffer_arg(datatype, 0), bench_buffer_arg(datatype, 1), \
+            bench_buffer_arg(datatype, 3), size / 4, OVERLAY_COMPOSITE); \
+    }
+
+// the same rgba pixels as frames of up to 512 pixels per row, with the planes
+// of the yuv side one after the other in a single buffer
+#define bench_color_frame(size) \
+    const uint32 pixels = size / 4; \
+    const uint32 width = pixels < 512 ? pixels : 512; \
+    const uint32 height = width > 0 ? pixels / width : 0; \
+    const uint32 chroma_width = (width + 1) / 2; \
+    const uint32 chroma_size = chroma_width * ((height + 1) / 2);
+
+#define bench_color_functions_impl(datatype) \
+    static void bench_rgba_to_gray_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->rgba_to_gray_##datatype(bench_buffer_arg(datatype, 0), bench_buffer_arg(datatype, 3), size / 4, BT709_LIMITED_COLOR_SPACE); \
+    } \
+    \
+    static void bench_rgba_to_i420_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        bench_color_frame(size) \
+        datatype* planes = bench_buffer_arg(datatype, 3); \
+        m->rgba_to_i420_##datatype(bench_buffer_arg(datatype, 0), width * 4, planes, width, \
+            planes + pixels, chroma_width, planes + pixels + chroma_size, chroma_width, \
+            width, height, BT709_LIMITED_COLOR_SPACE); \
+    } \
+    \
+    static void bench_i420_to_rgba_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        bench_color_frame(size) \
+        datatype* planes = bench_buffer_arg(datatype, 0); \
+        m->i420_to_rgba_##datatype(planes, width, planes + pixels, chroma_width, \
+            planes + pixels + chroma_size, chroma_width, bench_buffer_arg(datatype, 3), width * 4, \
+            width, height, BT709_LIMITED_COLOR_SPACE); \
+    } \
+    \
+    static void bench_nv12_to_rgba_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        bench_color_frame(size) \
+        datatype* planes = bench_buffer_arg(datatype, 0); \
+        m->nv12_to_rgba_##datatype(planes, width, planes + pixels, chroma_width * 2, \
+            bench_buffer_arg(datatype, 3), width * 4, width, height, BT709_LIMITED_COLOR_SPACE); \
+        (void)chroma_size; \
+    } \
+    \
+    static void bench_unpack_rgba_planes_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        datatype* planes = bench_buffer_arg(datatype, 3); \
+        m->unpack_rgba_planes_##datatype(bench_buffer_arg(datatype, 0), planes, planes + size / 4, \
+            planes + size / 2, planes + size / 4 * 3, size / 4); \
+    }
+
+// frames of up to 512 samples per row like the colour ones, filtered by the
+// 13 taps gaussian of sigma 2 shared by every run
+inline float_buffer& bench_image_kernel()
+{
+    static float_buffer kernel;
+
+    if (kernel.size() == 0)
+        image_filter::gaussian_kernel(2.0, kernel);
+
+    return kernel;
+}
+
+#define bench_image_frame(size) \
+    const uint32 width = size < 512 ? size : 512; \
+    const uint32 height = width > 0 ? size / width : 0;
+
+#define bench_image_functions_impl(datatype) \
+    static void bench_convolve_rows_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        bench_image_frame(size) \
+        datatype##_buffer& kernel = bench_image_kernel(); \
+        m->convolve_rows_##datatype(bench_buffer_arg(datatype, 0), width, bench_buffer_arg(datatype, 3), width, \
+            width, height, kernel.data(), kernel.size()); \
+    } \
+    \
+    static void bench_convolve_columns_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        bench_image_frame(size) \
+        datatype##_buffer& kernel = bench_image_kernel(); \
+        m->convolve_columns_##datatype(bench_buffer_arg(datatype, 0), width, bench_buffer_arg(datatype, 3), width, \
+            width, height, kernel.data(), kernel.size()); \
+    } \
+    \
+    static void bench_box_blur_rows_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        bench_image_frame(size) \
+        m->box_blur_rows_##datatype(bench_buffer_arg(datatype, 0), width, bench_buffer_arg(datatype, 3), width, \
+            width, height, 8); \
+    } \
+    \
+    static void bench_box_blur_columns_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        bench_image_frame(size) \
+        m->box_blur_columns_##datatype(bench_buffer_arg(datatype, 0), width, bench_buffer_arg(datatype, 3), width, \
+            width, height, 8); \
+    }
+
+// thumbnails of the image frames, a quarter of the size in each direction by
+// the Lanczos-3 tables of the frame, kept between the runs of a size
+struct bench_resize_table
+{
+    float_buffer coefficients;
+    uint32_buffer offsets;
+    uint32 src_size;
+    uint32 taps;
+
+    bench_resize_table() : src_size(0), taps(0) { }
+
+    void prepare(uint32 size)
+    {
+        if (src_size != size)
+        {
+            src_size = size;
+            taps = image_resizer::design(LANCZOS3_RESIZE_FILTER, size, size / 4, coefficients, offsets);
+        }
+    }
+};
+
+inline bench_resize_table& bench_resize_rows_table()
+{
+    static bench_resize_table table;
+    return table;
+}
+
+inline bench_resize_table& bench_resize_columns_table()
+{
+    static bench_resize_table table;
+    return table;
+}
+
+#define bench_resize_functions_impl(datatype) \
+    static void bench_resize_rows_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        bench_image_frame(size) \
+        if (width < 4) \
+            return; \
+        bench_resize_table& table = bench_resize_rows_table(); \
+        table.prepare(width); \
+        m->resize_rows_##datatype(bench_buffer_arg(datatype, 0), width, (float*)buffers[3], width / 4, \
+            width / 4, height, 1, table.coefficients.data(), table.taps, table.offsets.data()); \
+    } \
+    \
+    static void bench_resize_columns_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        bench_image_frame(size) \
+        if (height < 4) \
+            return; \
+        bench_resize_table& table = bench_resize_columns_table(); \
+        table.prepare(height); \
+        m->resize_columns_##datatype((float*)buffers[0], width / 4, bench_buffer_arg(datatype, 3), width / 4, \
+            width / 4, height / 4, table.coefficients.data(), table.taps, table.offsets.data()); \
+    }
+
+//------------------------------------------------------------------------------
+
+#define bench_functions_for_datatype(datatype) \
+    bench_set_buffer_impl(datatype) \
+    bench_copy_buffer_impl(datatype) \
+    bench_scale_buffer_impl(datatype) \
+    bench_abs_buffer_impl(datatype) \
+    bench_binary_buffers_impl(add_buffers, datatype) \
+    bench_binary_buffers_impl(subtract_buffers, datatype) \
+    bench_binary_buffers_impl(multiply_buffers, datatype) \
+    bench_binary_buffers_impl(divide_buffers, datatype) \
+    bench_reduction_impl(sum_buffer, datatype) \
+    bench_dot_product_impl(datatype) \
+    bench_extreme_buffer_impl(min_buffer, datatype) \
+    bench_extreme_buffer_impl(max_buffer, datatype) \
+    bench_reduction_impl(peak_abs_buffer, datatype) \
+    bench_reduction_impl(rms_buffer, datatype)
+
+#define bench_saturating_functions_for_datatype(datatype) \
+    bench_binary_buffers_impl(add_buffers_saturate, datatype) \
+    bench_binary_buffers_impl(subtract_buffers_saturate, datatype) \
+    bench_binary_buffers_impl(average_buffers, datatype) \
+    \
+    static void bench_scale_buffer_saturate_##datatype(math_interface_* m, void** buffers, uint32 size) \
+    { \
+        m->scale_buffer_saturate_##datatype(bench_buffer_arg(datatype, 3), size, 1.5f); \
+    }
+
+#define bench_floating_functions_for_datatype(datatype) \
+    bench_multiply_add_buffers_impl(datatype) \
+    bench_scale_add_buffer_impl(datatype) \
+    bench_ramp_scale_buffer_impl(ramp_scale_buffer, datatype) \
+    bench_ramp_scale_buffer_impl(exp_ramp_scale_buffer, datatype) \
+    bench_mixing_functions_impl(datatype) \
+    bench_conversion_functions_impl(int16, datatype) \
+    bench_conversion_functions_impl(int24, datatype) \
+    bench_conversion_functions_impl(int32, datatype) \
+    bench_filter_functions_impl(datatype) \
+    bench_transform_functions_impl(datatype) \
+    bench_dynamics_functions_impl(datatype) \
+    bench_transcendental_functions_impl(datatype)
+
+bench_functions_for_datatype(int8)
+bench_functions_for_datatype(uint8)
+bench_functions_for_datatype(int16)
+bench_functions_for_datatype(uint16)
+bench_functions_for_datatype(int32)
+bench_functions_for_datatype(uint32)
+bench_functions_for_datatype(int64)
+bench_functions_for_datatype(uint64)
+bench_functions_for_datatype(float)
+bench_functions_for_datatype(double)
+bench_saturating_functions_for_datatype(int8)
+bench_saturating_functions_for_datatype(uint8)
+bench_saturating_functions_for_datatype(int16)
+bench_saturating_functions_for_datatype(uint16)
+bench_floating_functions_for_datatype(float)
+bench_floating_functions_for_datatype(double)
+bench_pixel_functions_impl(uint8)
+bench_pixel_functions_impl(float)
+bench_color_functions_impl(uint8)
+bench_image_functions_impl(float)
+bench_resize_functions_impl(uint8)
+bench_resize_functions_impl(float)
+
+
+//------------------------------------------------------------------------------
+
+#define add_bench_op(ops, function, datatype, streams) \
+    { \
+        bench_op op = { #function, #datatype, sizeof(datatype), streams, \
+            &bench_##function##_##datatype, &bench_fill_buffer<datatype> }; \
+        ops.push_back(op); \
+    }
+
+#define add_bench_ops_for_datatype(ops, datatype) \
+    add_bench_op(ops, clear_buffer, datatype, 1) \
+    add_bench_op(ops, set_buffer, datatype, 1) \
+    add_bench_op(ops, copy_buffer, datatype, 2) \
+    add_bench_op(ops, scale_buffer, datatype, 2) \
+    add_bench_op(ops, abs_buffer, datatype, 2) \
+    add_bench_op(ops, add_buffers, datatype, 3) \
+    add_bench_op(ops, subtract_buffers, datatype, 3) \
+    add_bench_op(ops, multiply_buffers, datatype, 3) \
+    add_bench_op(ops, divide_buffers, datatype, 3) \
+    add_bench_op(ops, sum_buffer, datatype, 1) \
+    add_bench_op(ops, dot_product, datatype, 2) \
+    add_bench_op(ops, min_buffer, datatype, 1) \
+    add_bench_op(ops, max_buffer, datatype, 1) \
+    add_bench_op(ops, peak_abs_buffer, datatype, 1) \
+    add_bench_op(ops, rms_buffer, datatype, 1)
+
+#define add_bench_saturating_ops_for_datatype(ops, datatype) \
+    add_bench_op(ops, add_buffers_saturate, datatype, 3) \
+    add_bench_op(ops, subtract_buffers_saturate, datatype, 3) \
+    add_bench_op(ops, scale_buffer_saturate, datatype, 1) \
+    add_bench_op(ops, average_buffers, datatype, 3)
+
+#define add_bench_floating_ops_for_datatype(ops, datatype) \
+    add_bench_op(ops, multiply_add_buffers, datatype, 4) \
+    add_bench_op(ops, scale_add_buffer, datatype, 3) \
+    add_bench_op(ops, ramp_scale_buffer, datatype, 2) \
+    add_bench_op(ops, exp_ramp_scale_buffer, datatype, 2) \
+    add_bench_op(ops, pan_mono_to_stereo, datatype, 3) \
+    add_bench_op(ops, ramp_pan_mono_to_stereo, datatype, 3) \
+    add_bench_op(ops, balance_stereo, datatype, 4) \
+    add_bench_op(ops, ramp_balance_stereo, datatype, 4) \
+    add_bench_op(ops, mix_dry_wet, datatype, 3) \
+    add_bench_op(ops, ramp_mix_dry_wet, datatype, 3) \
+    add_bench_op(ops, interleave_buffers, datatype, 2) \
+    add_bench_op(ops, deinterleave_buffer, datatype, 2) \
+    add_bench_op(ops, convert_from_int16, datatype, 2) \
+    add_bench_op(ops, convert_to_int16, datatype, 2) \
+    add_bench_op(ops, convert_from_int24, datatype, 2) \
+    add_bench_op(ops, convert_to_int24, datatype, 2) \
+    add_bench_op(ops, convert_from_int32, datatype, 2) \
+    add_bench_op(ops, convert_to_int32, datatype, 2) \
+    add_bench_op(ops, process_biquad_bank, datatype, 2) \
+    add_bench_op(ops, process_polyphase, datatype, 2) \
+    add_bench_op(ops, fft_butterflies, datatype, 4) \
+    add_bench_op(ops, process_envelope_bank, datatype, 2) \
+    add_bench_op(ops, compressor_gain_buffer, datatype, 2) \
+    add_bench_op(ops, limiter_gain_buffer, datatype, 2) \
+    add_bench_op(ops, soft_clip_buffer, datatype, 2) \
+    add_bench_op(ops, exp_buffer, datatype, 2) \
+    add_bench_op(ops, exp_buffer_fast, datatype, 2) \
+    add_bench_op(ops, log_buffer, datatype, 2) \
+    add_bench_op(ops, log_buffer_fast, datatype, 2) \
+    add_bench_op(ops, sin_buffer, datatype, 2) \
+    add_bench_op(ops, sin_buffer_fast, datatype, 2) \
+    add_bench_op(ops, sincos_buffer, datatype, 3) \
+    add_bench_op(ops, sincos_buffer_fast, datatype, 3) \
+    add_bench_op(ops, tanh_buffer, datatype, 2) \
+    add_bench_op(ops, tanh_buffer_fast, datatype, 2) \
+    add_bench_op(ops, pow_buffer, datatype, 3) \
+    add_bench_op(ops, pow_buffer_fast, datatype, 3)
+
+#define add_bench_pixel_ops_for_datatype(ops, datatype) \
+    add_bench_op(ops, premultiply_rgba, datatype, 2) \
+    add_bench_op(ops, unpremultiply_rgba, datatype, 2) \
+    add_bench_op(ops, composite_rgba, datatype, 3) \
+    add_bench_op(ops, composite_rgba_overlay, datatype, 3)
+
+#define add_bench_color_ops_for_datatype(ops, datatype) \
+    add_bench_op(ops, rgba_to_gray, datatype, 2) \
+    add_bench_op(ops, rgba_to_i420, datatype, 2) \
+    add_bench_op(ops, i420_to_rgba, datatype, 2) \
+    add_bench_op(ops, nv12_to_rgba, datatype, 2) \
+    add_bench_op(ops, unpack_rgba_planes, datatype, 2)
+
+#define add_bench_image_ops_for_datatype(ops, datatype) \
+    add_bench_op(ops, convolve_rows, datatype, 2) \
+    add_bench_op(ops, convolve_columns, datatype, 2) \
+    add_bench_op(ops, box_blur_rows, datatype, 2) \
+    add_bench_op(ops, box_blur_columns, datatype, 2)
+
+#define add_bench_resize_ops_for_datatype(ops, datatype) \
+    add_bench_op(ops, resize_rows, datatype, 2) \
+    add_bench_op(ops, resize_columns, datatype, 2)
+
+inline std::vector<bench_op> bench_operations()
+{
+    std::vector<bench_op> ops;
+
+    add_bench_ops_for_datatype(ops, int8);
+    add_bench_ops_for_datatype(ops, uint8);
+    add_bench_ops_for_datatype(ops, int16);
+    add_bench_ops_for_datatype(ops, uint16);
+    add_bench_ops_for_datatype(ops, int32);
+    add_bench_ops_for_datatype(ops, uint32);
+    add_bench_ops_for_datatype(ops, int64);
+    add_bench_ops_for_datatype(ops, uint64);
+    add_bench_ops_for_datatype(ops, float);
+    add_bench_ops_for_datatype(ops, double);
+    add_bench_saturating_ops_for_datatype(ops, int8);
+    add_bench_saturating_ops_for_datatype(ops, uint8);
+    add_bench_saturating_ops_for_datatype(ops, int16);
+    add_bench_saturating_ops_for_datatype(ops, uint16);
+    add_bench_floating_ops_for_datatype(ops, float);
+    add_bench_floating_ops_for_datatype(ops, double);
+    add_bench_pixel_ops_for_datatype(ops, uint8);
+    add_bench_pixel_ops_for_datatype(ops, float);
+    add_bench_color_ops_for_datatype(ops, uint8);
+    add_bench_image_ops_for_datatype(ops, float);
+    add_bench_resize_ops_for_datatype(ops, uint8);
+    add_bench_resize_ops_for_datatype(ops, float);
+
+    return ops;
+}
+
+
+//==============================================================================
+
+/**
+ * A backend to measure, only the ones the running cpu really supports are kept
+ */
+
+struct bench_backend
+{
+    int flag;
+    const char* name;
+};
+
+inline std::vector<bench_backend> bench_backends()
+{
+    static const bench_backend all[] =
+    {
+        { FORCE_FPU, "FPU" },
+        { FORCE_MMX, "MMX" },
+        { FORCE_SSE, "SSE" },
+        { FORCE_SSE2, "SSE2" },
+        { FORCE_SSE3, "SSE3" },
+        { FORCE_SSSE3, "SSSE3" },
+        { FORCE_SSE41, "SSE41" },
+        { FORCE_SSE42, "SSE42" },
+        { FORCE_AVX, "AVX" },
+        { FORCE_AVX2, "AVX2" },
+        { FORCE_AVX512, "AVX512" },
+        { FORCE_NEON, "NEON" }
+    };
+
+    std::vector<bench_backend> backends;
+
+    for (size_t i = 0; i < sizeof(all) / sizeof(all[0]); ++i)
+    {
+        // the factory silently falls back when a backend isn't available
+        math m(all[i].flag);
+        if (std::string(m.name()) == all[i].name)
+            backends.push_back(all[i]);
+    }
+
+    return backends;
+}
+
+
+//==============================================================================
+
+/**
+ * Benchmark settings, all of them can be changed from the command line
+ */
+
+struct bench_config
+{
+    bench_config()
+        : min_size(16),
+          max_size(64 * 1024 * 1024),
+          min_time_ms(10.0),
+          samples(5),
+          flush_bytes(64 * 1024 * 1024),
+          aligned_pointers(true),
+          misaligned_pointers(true),
+          hot_cache(true),
+          cold_cache(true)
+    {
+    }
+
+    uint32 min_size;
+    uint32 max_size;
+    double min_time_ms;
+    uint32 samples;
+    uint32 flush_bytes;
+    bool aligned_pointers;
+    bool misaligned_pointers;
+    bool hot_cache;
+    bool cold_cache;
+    std::vector<std::string> backends;
+    std::vector<std::string> ops;
+    std::vector<std::string> types;
+};
+
+
+//------------------------------------------------------------------------------
+
+/**
+ * One measured point of the matrix
+ */
+
+struct bench_result
+{
+    std::string backend;
+    std::string op;
+    std::string type;
+    uint32 size;
+    bool aligned_pointers;
+    bool hot_cache;
+    double ns_per_element;
+    double gb_per_second;
+    double speedup;
+};
+
+
+//==============================================================================
+
+/**
+ * Runs the operation x datatype x backend x size x alignment x cache matrix
+ */
+
+class bench_runner
+{
+public:
+    explicit bench_runner(const bench_config& config)
+        : config_(config),
+          flush_buffer_(config.flush_bytes)
+    {
+        memset(flush_buffer_.data(), 0, flush_buffer_.size());
+    }
+
+    const std::vector<bench_result>& results() const
+    {
+        return results_;
+    }
+
+    void run()
+    {
+        const std::vector<bench_op> ops = bench_operations();
+        const std::vector<bench_backend> backends = bench_backends();
+
+        std::vector<std::unique_ptr<math> > maths;
+        std::vector<math_interface_*> interfaces;
+        for (size_t b = 0; b < backends.size(); ++b)
+        {
+            maths.push_back(std::unique_ptr<math>(new math(backends[b].flag)));
+            interfaces.push_back((*maths.back()).operator->());
+        }
+
+        for (uint32 size = config_.min_size; size <= config_.max_size && size != 0; size *= 4)
+        {
+            for (size_t o = 0; o < ops.size(); ++o)
+            {
+                const bench_op& op = ops[o];
+                if (! selected(config_.ops, op.name) || ! selected(config_.types, op.type))
+                    continue;
+
+                if (! allocate(op, size))
+                {
+                    fprintf(stderr, "skipping %s_%s with %u elements: out of memory\n",
+                        op.name, op.type, size);
+                    continue;
+                }
+
+                for (int alignment = 0; alignment < 2; ++alignment)
+                {
+                    const bool is_aligned = (alignment == 0);
+                    if ((is_aligned && ! config_.aligned_pointers) || (! is_aligned && ! config_.misaligned_pointers))
+                        continue;
+
+                    for (int cache = 0; cache < 2; ++cache)
+                    {
+                        const bool is_hot = (cache == 0);
+                        if ((is_hot && ! config_.hot_cache) || (! is_hot && ! config_.cold_cache))
+                            continue;
+
+                        measure_backends(op, backends, interfaces, size, is_aligned, is_hot);
+                    }
+                }
+            }
+        }
+
+        buffers_.clear();
+    }
+
+private:
+    static bool selected(const std::vector<std::string>& filter, const std::string& name)
+    {
+        if (filter.empty())
+            return true;
+
+        for (size_t i = 0; i < filter.size(); ++i)
+        {
+            if (lower(filter[i]) == lower(name))
+                return true;
+        }
+
+        return false;
+    }
+
+    static std::string lower(std::string value)
+    {
+        std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+        return value;
+    }
+
+    bool allocate(const bench_op& op, uint32 size)
+    {
+        // one spare element gives room to the misaligned pointers
+        const uint64 bytes = ((uint64)size + 1) * op.type_size;
+        if (bytes > 0xffffffffull - 64)
+            return false;
+
+        buffers_.resize(4);
+        for (int i = 0; i < 4; ++i)
+        {
+            if (! buffers_[i] || buffers_[i]->size() < bytes)
+            {
+                buffers_[i].reset();
+                buffers_[i].reset(new aligned_buffer<uint8, 64>((uint32)bytes));
+
+                if (buffers_[i]->data() == nullptr)
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    void measure_backends(const bench_op& op,
+                          const std::vector<bench_backend>& backends,
+                          const std::vector<math_interface_*>& interfaces,
+                          uint32 size,
+                          bool is_aligned,
+                          bool is_hot)
+    {
+        double fpu_ns = 0.0;
+
+        for (size_t b = 0; b < backends.size(); ++b)
+        {
+            // the fpu is always measured, it's the reference for the speedup
+            const bool is_fpu = (backends[b].flag == FORCE_FPU);
+            if (! is_fpu && ! selected(config_.backends, backends[b].name))
+                continue;
+
+            void* pointers[4];
+            for (int i = 0; i < 4; ++i)
+            {
+                op.fill(buffers_[i]->data(), size + 1, i);
+                pointers[i] = buffers_[i]->data() + (is_aligned ? 0 : op.type_size);
+            }
+
+            const double ns = is_hot
+                ? measure_hot(op, interfaces[b], pointers, size)
+                : measure_cold(op, interfaces[b], pointers, size);
+
+            if (is_fpu)
+                fpu_ns = ns;
+
+            if (! is_fpu || selected(config_.backends, backends[b].name))
+            {
+                bench_result result;
+                result.backend = backends[b].name;
+                result.op = op.name;
+                result.type = op.type;
+                result.size = size;
+                result.aligned_pointers = is_aligned;
+                result.hot_cache = is_hot;
+                result.ns_per_element = ns / size;
+                result.gb_per_second = ((double)size * op.type_size * op.streams) / ns;
+                result.speedup = ns > 0.0 ? fpu_ns / ns : 0.0;
+                results_.push_back(result);
+
+                fprintf(stderr, "%-7s %-22s %-7s %10u %-10s %-4s %10.3f ns/elem\n",
+                    result.backend.c_str(), op.name, op.type, size,
+                    is_aligned ? "aligned" : "misaligned", is_hot ? "hot" : "cold",
+                    result.ns_per_element);
+            }
+        }
+    }
+
+    // hot cache: repeat the call until a batch lasts at least min_time, then
+    // keep the median per call time of the batches
+    double measure_hot(const bench_op& op, math_interface_* m, void** pointers, uint32 size)
+    {
+        op.run(m, pointers, size);
+
+        uint32 iterations = 1;
+        for (;;)
+        {
+            const double elapsed = time_calls(op, m, pointers, size, iterations);
+            if (elapsed >= config_.min_time_ms * 1e6 || iterations >= (1u << 30))
+                break;
+
+            iterations *= 2;
+        }
+
+        std::vector<double> samples;
+        for (uint32 i = 0; i < config_.samples; ++i)
+            samples.push_back(time_calls(op, m, pointers, size, iterations) / iterations);
+
+        return median(samples);
+    }
+
+    // cold cache: evict the buffers before each single timed call
+    double measure_cold(const bench_op& op, math_interface_* m, void** pointers, uint32 size)
+    {
+        std::vector<double> samples;
+        for (uint32 i = 0; i < config_.samples * 3; ++i)
+        {
+            flush_caches();
+            samples.push_back(time_calls(op, m, pointers, size, 1));
+        }
+
+        return median(samples);
+    }
+
+    static double time_calls(const bench_op& op, math_interface_* m, void** pointers, uint32 size, uint32 iterations)
+    {
+        const double start = bench_clock::now();
+
+        for (uint32 i = 0; i < iterations; ++i)
+            op.run(m, pointers, size);
+
+        return bench_clock::now() - start;
+    }
+
+    void flush_caches()
+    {
+        // read and dirty a buffer larger than the last level cache
+        uint8* data = flush_buffer_.data();
+        const uint32 size = flush_buffer_.size();
+
+        for (uint32 i = 0; i < size; i += 64)
+            data[i] = (uint8)(data[i] + 1);
+    }
+
+    static double median(std::vector<double> samples)
+    {
+        std::sort(samples.begin(), samples.end());
+        return samples[samples.size() / 2];
+    }
+
+    bench_config config_;
+    aligned_buffer<uint8, 64> flush_buffer_;
+    std::vector<std::unique_ptr<aligned_buffer<uint8, 64> > > buffers_;
+    std::vector<bench_result> results_;
+};
+
+
+//==============================================================================
+
+/**
+ * Result writers: a human readable table, csv and json
+ */
+
+inline void bench_write_table(FILE* out, const std::vector<bench_result>& results)
+{
+    fprintf(out, "%-7s %-22s %-7s %10s %-10s %-5s %12s %10s %8s\n",
+        "backend", "op", "type", "size", "alignment", "cache", "ns/elem", "GB/s", "speedup");
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const bench_result& r = results[i];
+        fprintf(out, "%-7s %-22s %-7s %10u %-10s %-5s %12.4f %10.3f %8.2f\n",
+            r.backend.c_str(), r.op.c_str(), r.type.c_str(), r.size,
+            r.aligned_pointers ? "aligned" : "misaligned", r.hot_cache ? "hot" : "cold",
+            r.ns_per_element, r.gb_per_second, r.speedup);
+    }
+}
+
+inline void bench_write_csv(FILE* out, const std::vector<bench_result>& results)
+{
+    fprintf(out, "backend,op,type,size,alignment,cache,ns_per_element,gb_per_second,speedup\n");
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const bench_result& r = results[i];
+        fprintf(out, "%s,%s,%s,%u,%s,%s,%.6f,%.6f,%.4f\n",
+            r.backend.c_str(), r.op.c_str(), r.type.c_str(), r.size,
+            r.aligned_pointers ? "aligned" : "misaligned", r.hot_cache ? "hot" : "cold",
+            r.ns_per_element, r.gb_per_second, r.speedup);
+    }
+}
+
+inline void bench_write_json(FILE* out, const std::vector<bench_result>& results)
+{
+    math autodetect;
+
+    fprintf(out, "{\n  \"autodetected\": \"%s\",\n  \"results\": [", autodetect.name());
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const bench_result& r = results[i];
+        fprintf(out, "%s\n    { \"backend\": \"%s\", \"op\": \"%s\", \"type\": \"%s\", "
+            "\"size\": %u, \"alignment\": \"%s\", \"cache\": \"%s\", "
+            "\"ns_per_element\": %.6f, \"gb_per_second\": %.6f, \"speedup\": %.4f }",
+            i == 0 ? "" : ",",
+            r.backend.c_str(), r.op.c_str(), r.type.c_str(), r.size,
+            r.aligned_pointers ? "aligned" : "misaligned", r.hot_cache ? "hot" : "cold",
+            r.ns_per_element, r.gb_per_second, r.speedup);
+    }
+
+    fprintf(out, "\n  ]\n}\n");
+}
+
+
+#endif // __WATERSPOUT_SIMD_ABSTRACTION_FRAMEWORK_BENCH_BENCHMARK_H__
@@ -0,0 +1,202 @@
+/*
+ * waterspout
+ *
+ *   - simd abstraction library for audio/image manipulation -
+ *
+ * Copyright (c) 2015 Lucio Asnaghi
+ *
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <waterspout.h>
+
+#include <cstdlib>
+
+#include "benchmark.h"
+
+
+//==============================================================================
+
+//------------------------------------------------------------------------------
+
+static void print_usage(const char* program)
+{
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "\n"
+        "  --format=table|csv|json      output format (table)\n"
+        "  --output=FILE                write the results to FILE (stdout)\n"
+        "  --backends=LIST              comma separated backends, ie. sse2,avx2 (all)\n"
+        "  --ops=LIST                   comma separated operations, ie. add_buffers (all)\n"
+        "  --types=LIST                 comma separated datatypes, ie. float,int16 (all)\n"
+        "  --min-size=N                 smallest buffer in elements (16)\n"
+        "  --max-size=N                 largest buffer in elements (67108864)\n"
+        "  --alignment=aligned|misaligned|both   pointer alignment (both)\n"
+        "  --cache=hot|cold|both        cache state before the calls (both)\n"
+        "  --min-time=MS                minimum duration of a hot batch (10)\n"
+        "  --samples=N                  batches per measure, the median is kept (5)\n"
+        "  --flush-size=MB              buffer walked to evict the caches (64)\n"
+        "  --list                       list the available backends and operations\n",
+        program);
+}
+
+static std::vector<std::string> split_list(const std::string& value)
+{
+    std::vector<std::string> items;
+
+    size_t start = 0;
+    while (start <= value.size())
+    {
+        const size_t end = std::min(value.find(',', start), value.size());
+        if (end > start)
+            items.push_back(value.substr(start, end - start));
+
+        start = end + 1;
+    }
+
+    return items;
+}
+
+static bool parse_option(const std::string& arg, const char* name, std::string& value)
+{
+    const std::string prefix = std::string("--") + name + "=";
+    if (arg.compare(0, prefix.size(), prefix) != 0)
+        return false;
+
+    value = arg.substr(prefix.size());
+    return true;
+}
+
+static void list_available()
+{
+    const std::vector<bench_backend> backends = bench_backends();
+    const std::vector<bench_op> ops = bench_operations();
+
+    printf("backends:");
+    for (size_t i = 0; i < backends.size(); ++i)
+        printf(" %s", backends[i].name);
+
+    printf("\noperations:\n");
+    for (size_t i = 0; i < ops.size(); ++i)
+        printf("  %s_%s\n", ops[i].name, ops[i].type);
+}
+
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    bench_config config;
+    std::string format = "table";
+    std::string output;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        std::string value;
+
+        if (arg == "--help" || arg == "-h")
+        {
+            print_usage(argv[0]);
+            return EXIT_SUCCESS;
+        }
+        else if (arg == "--list")
+        {
+            list_available();
+            return EXIT_SUCCESS;
+        }
+        else if (parse_option(arg, "format", value))
+            format = value;
+        else if (parse_option(arg, "output", value))
+            output = value;
+        else if (parse_option(arg, "backends", value))
+            config.backends = split_list(value);
+        else if (parse_option(arg, "ops", value))
+            config.ops = split_list(value);
+        else if (parse_option(arg, "types", value))
+            config.types = split_list(value);
+        else if (parse_option(arg, "min-size", value))
+            config.min_size = (uint32)strtoul(value.c_str(), nullptr, 10);
+        else if (parse_option(arg, "max-size", value))
+            config.max_size = (uint32)strtoul(value.c_str(), nullptr, 10);
+        else if (parse_option(arg, "min-time", value))
+            config.min_time_ms = atof(value.c_str());
+        else if (parse_option(arg, "samples", value))
+            config.samples = (uint32)strtoul(value.c_str(), nullptr, 10);
+        else if (parse_option(arg, "flush-size", value))
+            config.flush_bytes = (uint32)strtoul(value.c_str(), nullptr, 10) * 1024 * 1024;
+        else if (parse_option(arg, "alignment", value))
+        {
+            config.aligned_pointers = (value != "misaligned");
+            config.misaligned_pointers = (value != "aligned");
+        }
+        else if (parse_option(arg, "cache", value))
+        {
+            config.hot_cache = (value != "cold");
+            config.cold_cache = (value != "hot");
+        }
+        else
+        {
+            fprintf(stderr, "unknown option: %s\n\n", arg.c_str());
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (format != "table" && format != "csv" && format != "json")
+    {
+        fprintf(stderr, "unknown format: %s\n", format.c_str());
+        return EXIT_FAILURE;
+    }
+
+    if (config.min_size == 0 || config.samples == 0 || config.flush_bytes == 0)
+    {
+        fprintf(stderr, "sizes, samples and flush size must be greater than zero\n");
+        return EXIT_FAILURE;
+    }
+
+    FILE* out = stdout;
+    if (! output.empty())
+    {
+        out = fopen(output.c_str(), "w");
+        if (out == nullptr)
+        {
+            fprintf(stderr, "can't open %s for writing\n", output.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    bench_runner runner(config);
+    runner.run();
+
+    if (format == "csv")
+        bench_write_csv(out, runner.results());
+    else if (format == "json")
+        bench_write_json(out, runner.results());
+    else
+        bench_write_table(out, runner.results());
+
+    if (out != stdout)
+        fclose(out);
+
+    return EXIT_SUCCESS;
+}
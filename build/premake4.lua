@@ -19,11 +19,12 @@
 
 local projectname = "waterspout"
 local projectkind = "ConsoleApp"
+local benchname = "waterspout_bench"
 
 --===========================================================================--
 -- Common functions
 --===========================================================================--
-function setup_solution(projectname, projectkind, platformname)
+function setup_solution(projectname, platformname)
 
   -- solution
   solution(projectname)
@@ -37,9 +38,6 @@ function setup_solution(projectname, projectkind, platformname)
     configurations { "debug", "release" }
   end
 
-  -- project
-  project(projectname)
-  kind(projectkind)
   language "C++"
 
   -- build/link options
@@ -90,14 +88,32 @@ function setup_solution(projectname, projectkind, platformname)
     "../tests"
   }
 
-  -- project files
+  -- library files, shared by all the projects
   files {
     "../src/*.h",
-    "../src/*.cpp",
+    "../src/*.cpp"
+  }
+
+end
+
+function setup_projects()
+
+  -- unit tests
+  project(projectname)
+  kind(projectkind)
+  files {
     "../tests/*.h",
     "../tests/*.cpp"
   }
 
+  -- benchmarks
+  project(benchname)
+  kind(projectkind)
+  files {
+    "../bench/*.h",
+    "../bench/*.cpp"
+  }
+
 end
 
 --===========================================================================--
@@ -106,14 +122,13 @@ end
 
 --===========================================================================--
 if _ACTION == "gmake" then
-  setup_solution(projectname, projectkind, "Linux")
+  setup_solution(projectname, "Linux")
 
   defines {
     "LINUX=1"
   }
 
   buildoptions {
-    "-march=native",
     "-std=c++0x", -- should be -std=c++11 (this is needed as we build for old gcc in travis)
     "-fPIC",
     "-Wno-error"
@@ -129,7 +144,7 @@ if _ACTION == "gmake" then
 
 --===========================================================================--
 elseif _ACTION == "vs2010" then
-  setup_solution(projectname, projectkind, "Windows")
+  setup_solution(projectname, "Windows")
 
   buildoptions {
   	"/wd4127",
@@ -148,14 +163,13 @@ elseif _ACTION == "vs2010" then
 
 --===========================================================================--
 elseif _ACTION == "xcode3" then
-  setup_solution(projectname, projectkind, "MacOSX")
+  setup_solution(projectname, "MacOSX")
 
   defines {
   	"MACOSX=1",
   }
 
   buildoptions {
-  	"-march=native",
   	"-fPIC",
     "-Wno-error"
   }
@@ -167,3 +181,10 @@ elseif _ACTION == "xcode3" then
   ]]--
 
 end
+
+--===========================================================================--
+-- projects are declared last, so they inherit the platform settings above
+--===========================================================================--
+if _ACTION == "gmake" or _ACTION == "vs2010" or _ACTION == "xcode3" then
+  setup_projects()
+end
@@ -14,6 +14,8 @@ HEADERS += \
   $$INCLUDEDIR/waterspout.h \
   $$SRCDIR/math_avx.h \
   $$SRCDIR/math_avx2.h \
+  $$SRCDIR/math_avx512.h \
+  $$SRCDIR/math_dispatch.h \
   $$SRCDIR/math_fpu.h \
   $$SRCDIR/math_mmx.h \
   $$SRCDIR/math_neon.h \
@@ -23,10 +25,23 @@ HEADERS += \
   $$SRCDIR/math_sse41.h \
   $$SRCDIR/math_sse42.h \
   $$SRCDIR/math_ssse3.h \
+  $$SRCDIR/waterspout_internal.h \
   $$TESTDIR/unittest.h \
   $$TESTDIR/common.h
 
 SOURCES += \
+  $$SRCDIR/math_avx.cpp \
+  $$SRCDIR/math_avx2.cpp \
+  $$SRCDIR/math_avx512.cpp \
+  $$SRCDIR/math_fpu.cpp \
+  $$SRCDIR/math_mmx.cpp \
+  $$SRCDIR/math_neon.cpp \
+  $$SRCDIR/math_sse.cpp \
+  $$SRCDIR/math_sse2.cpp \
+  $$SRCDIR/math_sse3.cpp \
+  $$SRCDIR/math_sse41.cpp \
+  $$SRCDIR/math_sse42.cpp \
+  $$SRCDIR/math_ssse3.cpp \
   $$SRCDIR/waterspout.cpp \
   $$TESTDIR/main.cpp
 
@@ -36,17 +51,6 @@ OTHER_FILES += \
   $$ROOTDIR/AUTHORS \
   $$ROOTDIR/LICENSE
 
-DEFINES += \
-  __MMX__=1 \
-  __SSE__=1 \
-  __SSE2__=1 \
-  __SSE3__=1 \
-  __SSSE3__=1 \
-  __SSE4_1__=1 \
-  __SSE4_2__=1 \
-  __AVX__=1 \
-  __AVX2__=1
-
 unix{
   DEFINES += \
     LINUX=1
@@ -0,0 +1,60 @@
+
+TARGET   = waterspout_bench
+TEMPLATE = app
+CONFIG  -= qt
+
+ROOTDIR = $$PWD/..
+INCLUDEDIR = $$ROOTDIR/include
+SRCDIR = $$ROOTDIR/src
+BENCHDIR = $$ROOTDIR/bench
+DESTDIR = $$ROOTDIR/bin
+OBJECTS_DIR = $$DESTDIR/temp_bench
+
+HEADERS += \
+  $$INCLUDEDIR/waterspout.h \
+  $$SRCDIR/math_avx.h \
+  $$SRCDIR/math_avx2.h \
+  $$SRCDIR/math_avx512.h \
+  $$SRCDIR/math_dispatch.h \
+  $$SRCDIR/math_fpu.h \
+  $$SRCDIR/math_mmx.h \
+  $$SRCDIR/math_neon.h \
+  $$SRCDIR/math_sse.h \
+  $$SRCDIR/math_sse2.h \
+  $$SRCDIR/math_sse3.h \
+  $$SRCDIR/math_sse41.h \
+  $$SRCDIR/math_sse42.h \
+  $$SRCDIR/math_ssse3.h \
+  $$SRCDIR/waterspout_internal.h \
+  $$BENCHDIR/benchmark.h
+
+SOURCES += \
+  $$SRCDIR/math_avx.cpp \
+  $$SRCDIR/math_avx2.cpp \
+  $$SRCDIR/math_avx512.cpp \
+  $$SRCDIR/math_fpu.cpp \
+  $$SRCDIR/math_mmx.cpp \
+  $$SRCDIR/math_neon.cpp \
+  $$SRCDIR/math_sse.cpp \
+  $$SRCDIR/math_sse2.cpp \
+  $$SRCDIR/math_sse3.cpp \
+  $$SRCDIR/math_sse41.cpp \
+  $$SRCDIR/math_sse42.cpp \
+  $$SRCDIR/math_ssse3.cpp \
+  $$SRCDIR/waterspout.cpp \
+  $$BENCHDIR/main.cpp
+
+OTHER_FILES += \
+  $$PWD/premake4.lua \
+  $$ROOTDIR/README.md \
+  $$ROOTDIR/AUTHORS \
+  $$ROOTDIR/LICENSE
+
+unix{
+  DEFINES += \
+    LINUX=1
+
+  INCLUDEPATH += \
+    $$INCLUDEDIR \
+      /usr/include
+}
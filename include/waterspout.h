@@ -31,51 +31,98 @@
 #define __WATERSPOUT_SIMD_ABSTRACTION_FRAMEWORK_H__
 
 #include <cassert>
+#include <cmath>
 #include <memory>
 
 
 //------------------------------------------------------------------------------
 
+/**
+ * Architecture definitions
+ */
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+    #define WATERSPOUT_ARCH_X86 1
+
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define WATERSPOUT_ARCH_ARM 1
+    #define WATERSPOUT_ARCH_ARM64 1
+
+#elif defined(__arm__) || defined(_M_ARM)
+    #define WATERSPOUT_ARCH_ARM 1
+
+#endif
+
+
 /**
  * SIMD intrinsics definitions
  */
 
-#if defined(__MMX__) || (_MSC_VER >= 1400) || defined(_WIN64) || (_M_IX86_FP >= 1)
+#if defined(WATERSPOUT_ARCH_X86)
+
+// GCC and clang can target a single function at a newer instruction set, so
+// every backend gets built and the best one is selected with cpuid at runtime
+#if defined(__clang__)
+  #if (__clang_major__ >= 6) && ! defined(WATERSPOUT_NO_RUNTIME_DISPATCH)
+    #define WATERSPOUT_SIMD_RUNTIME_DISPATCH
+  #endif
+#elif defined(__GNUC__) && ! defined(__INTEL_COMPILER)
+  #if (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)) && ! defined(WATERSPOUT_NO_RUNTIME_DISPATCH)
+    #define WATERSPOUT_SIMD_RUNTIME_DISPATCH
+  #endif
+#endif
+
+#if defined(__MMX__) || (_MSC_VER >= 1400) || defined(_WIN64) || (_M_IX86_FP >= 1) || defined(WATERSPOUT_SIMD_RUNTIME_DISPATCH)
   #define WATERSPOUT_SIMD_MMX
 #endif
 
-#if defined(__SSE__) || (_MSC_VER >= 1400) || defined(_WIN64) || (_M_IX86_FP >= 1)
+#if defined(__SSE__) || (_MSC_VER >= 1400) || defined(_WIN64) || (_M_IX86_FP >= 1) || defined(WATERSPOUT_SIMD_RUNTIME_DISPATCH)
   #define WATERSPOUT_SIMD_SSE
 #endif
 
-#if defined(__SSE2__) || (_MSC_VER >= 1400) || defined(_WIN64) || (_M_IX86_FP >= 2)
+#if defined(__SSE2__) || (_MSC_VER >= 1400) || defined(_WIN64) || (_M_IX86_FP >= 2) || defined(WATERSPOUT_SIMD_RUNTIME_DISPATCH)
   #define WATERSPOUT_SIMD_SSE2
 #endif
 
-#if defined(__SSE3__) || (_MSC_VER >= 1400)
+#if defined(__SSE3__) || (_MSC_VER >= 1400) || defined(WATERSPOUT_SIMD_RUNTIME_DISPATCH)
   #define WATERSPOUT_SIMD_SSE3
 #endif
 
-#if defined(__SSSE3__) || (_MSC_VER >= 1500)
+#if defined(__SSSE3__) || (_MSC_VER >= 1500) || defined(WATERSPOUT_SIMD_RUNTIME_DISPATCH)
   #define WATERSPOUT_SIMD_SSSE3
 #endif
 
-#if defined(__SSE4_1__) || (_MSC_VER >= 1500)
+#if defined(__SSE4_1__) || (_MSC_VER >= 1500) || defined(WATERSPOUT_SIMD_RUNTIME_DISPATCH)
   #define WATERSPOUT_SIMD_SSE41
 #endif
 
-#if defined(__SSE4_2__) || (_MSC_VER >= 1500)
+#if defined(__SSE4_2__) || (_MSC_VER >= 1500) || defined(WATERSPOUT_SIMD_RUNTIME_DISPATCH)
   #define WATERSPOUT_SIMD_SSE42
 #endif
 
-#if defined(__AVX__) || (_MSC_VER >= 1700)
+#if defined(__AVX__) || (_MSC_VER >= 1700) || defined(WATERSPOUT_SIMD_RUNTIME_DISPATCH)
   #define WATERSPOUT_SIMD_AVX
 #endif
 
-#if defined(__AVX2__) || (_MSC_VER >= 1700)
+#if (defined(__AVX2__) && defined(__FMA__)) || (_MSC_VER >= 1700) || defined(WATERSPOUT_SIMD_RUNTIME_DISPATCH)
   #define WATERSPOUT_SIMD_AVX2
 #endif
 
+#if (defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512DQ__)) || (_MSC_VER >= 1911) || \
+    (defined(WATERSPOUT_SIMD_RUNTIME_DISPATCH) && (defined(__clang__) || __GNUC__ >= 5))
+  #define WATERSPOUT_SIMD_AVX512
+#endif
+
+#endif // WATERSPOUT_ARCH_X86
+
+#if defined(WATERSPOUT_ARCH_ARM)
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(WATERSPOUT_ARCH_ARM64)
+  #define WATERSPOUT_SIMD_NEON
+#endif
+
+#endif // WATERSPOUT_ARCH_ARM
+
 
 /**
  * System bits definitions
@@ -331,7 +378,7 @@ namespace waterspout {
  * Types valid on all architectures we build
  */
 
-typedef char int8;
+typedef signed char int8;
 typedef unsigned char uint8;
 
 typedef short int16;
@@ -412,14 +459,18 @@ class round
 public:
     static forcedinline int f2i(float f)
     {
-      #if defined(WATERSPOUT_COMPILER_MSVC)
+      #if defined(WATERSPOUT_ARCH_X86) && defined(WATERSPOUT_COMPILER_MSVC)
           __asm cvttss2si eax, f
 
-      #else
+      #elif defined(WATERSPOUT_ARCH_X86)
           int i;
           __asm__ ( "cvttss2si %1, %0" : "=r" (i) : "m" (f) );
           return i;
 
+      #else
+          // arm fcvtzs / vcvt truncates and saturates just like the simd paths
+          return (int)f;
+
       #endif
     }
 
@@ -511,7 +562,12 @@ public:
         return data_;
     }
 
-    forcedinline uint32 size()
+    forcedinline const T* data() const
+    {
+        return data_;
+    }
+
+    forcedinline uint32 size() const
     {
         return size_;
     }
@@ -562,6 +618,383 @@ typedef aligned_buffer<double, 32> double_buffer;
 
 //==============================================================================
 
+//------------------------------------------------------------------------------
+
+/**
+ * Coefficients and state of a bank of biquad filters, one cascade of sections
+ * per channel, laid out as the filter functions expect them.
+ *
+ * Both are structures of arrays, so the same value of consecutive channels is
+ * contiguous: coefficient k (b0, b1, b2, a1, a2) of a section lives at
+ * [(section * 5 + k) * channels + channel] and its state variables z1, z2 at
+ * [(section * 2 + k) * channels + channel]. Coefficients are normalized by a0,
+ * new sections pass the signal through untouched.
+ */
+
+template<class T>
+class biquad_bank
+{
+public:
+    biquad_bank(uint32 channels, uint32 sections)
+      : coefficients_(channels * sections * 5),
+        state_(channels * sections * 2),
+        channels_(channels),
+        sections_(sections)
+    {
+        for (uint32 section = 0; section < sections_; ++section)
+        {
+            for (uint32 channel = 0; channel < channels_; ++channel)
+            {
+                set_section(channel, section, T(1), T(0), T(0), T(0), T(0));
+            }
+        }
+
+        reset();
+    }
+
+    void set_section(uint32 channel, uint32 section, T b0, T b1, T b2, T a1, T a2)
+    {
+        assert(channel < channels_);
+        assert(section < sections_);
+
+        T* coefficient = coefficients_.data() + section * 5 * channels_ + channel;
+        coefficient[0] = b0;
+        coefficient[channels_] = b1;
+        coefficient[2 * channels_] = b2;
+        coefficient[3 * channels_] = a1;
+        coefficient[4 * channels_] = a2;
+    }
+
+    // clear the state of every section
+    void reset()
+    {
+        for (uint32 i = 0; i < channels_ * sections_ * 2; ++i)
+        {
+            state_[i] = T(0);
+        }
+    }
+
+    forcedinline T* coefficients()
+    {
+        return coefficients_.data();
+    }
+
+    forcedinline T* state()
+    {
+        return state_.data();
+    }
+
+    forcedinline uint32 channels() const
+    {
+        return channels_;
+    }
+
+    forcedinline uint32 sections() const
+    {
+        return sections_;
+    }
+
+private:
+    aligned_buffer<T, 32> coefficients_;
+    aligned_buffer<T, 32> state_;
+    uint32 channels_;
+    uint32 sections_;
+
+    // noncopyable
+    biquad_bank(const biquad_bank&);
+    const biquad_bank& operator=(const biquad_bank&);
+};
+
+typedef biquad_bank<float> float_biquad_bank;
+typedef biquad_bank<double> double_biquad_bank;
+
+
+//------------------------------------------------------------------------------
+
+/**
+ * Coefficients and state of a bank of envelope followers, one per channel,
+ * laid out as the dynamics functions expect them.
+ *
+ * The attack coefficients of all the channels come first, then the release
+ * ones, the state holds the envelope of each channel. A coefficient is the
+ * part of the way to the input level the envelope goes each sample: 1 follows
+ * it instantly, which is what new channels do, time_coefficient gives the one
+ * of a time constant in seconds.
+ */
+
+template<class T>
+class envelope_bank
+{
+public:
+    explicit envelope_bank(uint32 channels)
+      : coefficients_(channels * 2),
+        state_(channels),
+        channels_(channels)
+    {
+        for (uint32 channel = 0; channel < channels_; ++channel)
+        {
+            set_channel(channel, T(1), T(1));
+        }
+
+        reset();
+    }
+
+    void set_channel(uint32 channel, T attack, T release)
+    {
+        assert(channel < channels_);
+
+        coefficients_[channel] = attack;
+        coefficients_[channels_ + channel] = release;
+    }
+
+    void set_times(uint32 channel, double attack_time, double release_time, double sample_rate)
+    {
+        set_channel(channel, time_coefficient(attack_time, sample_rate),
+            time_coefficient(release_time, sample_rate));
+    }
+
+    // clear the envelope of every channel
+    void reset()
+    {
+        for (uint32 i = 0; i < channels_; ++i)
+        {
+            state_[i] = T(0);
+        }
+    }
+
+    forcedinline T* coefficients()
+    {
+        return coefficients_.data();
+    }
+
+    forcedinline T* state()
+    {
+        return state_.data();
+    }
+
+    forcedinline uint32 channels() const
+    {
+        return channels_;
+    }
+
+    static T time_coefficient(double time, double sample_rate)
+    {
+        return time > 0.0 ? T(1.0 - std::exp(-1.0 / (time * sample_rate))) : T(1);
+    }
+
+private:
+    aligned_buffer<T, 32> coefficients_;
+    aligned_buffer<T, 32> state_;
+    uint32 channels_;
+
+    // noncopyable
+    envelope_bank(const envelope_bank&);
+    const envelope_bank& operator=(const envelope_bank&);
+};
+
+typedef envelope_bank<float> float_envelope_bank;
+typedef envelope_bank<double> double_envelope_bank;
+
+
+//------------------------------------------------------------------------------
+
+/**
+ * Plane of width x height samples in an aligned buffer, each row starting
+ * stride samples after the previous one, as the image functions expect it.
+ *
+ * The default stride rounds the rows up to a multiple of 32 bytes, so every row
+ * is as aligned as the buffer. A plane of RGBA pixels is 4 * width samples wide.
+ */
+
+template<class T>
+class image_plane
+{
+public:
+    image_plane()
+      : width_(0),
+        height_(0),
+        stride_(0)
+    {
+    }
+
+    image_plane(uint32 width, uint32 height, uint32 stride = 0)
+      : width_(0),
+        height_(0),
+        stride_(0)
+    {
+        resize(width, height, stride);
+    }
+
+    // the samples are not kept
+    void resize(uint32 width, uint32 height, uint32 stride = 0)
+    {
+        assert(stride == 0 || stride >= width);
+
+        width_ = width;
+        height_ = height;
+        stride_ = stride > 0 ? stride : aligned_stride(width);
+
+        buffer_.resize(stride_ * height_);
+    }
+
+    forcedinline T* row(uint32 y)
+    {
+        assert(y < height_);
+
+        return buffer_.data() + y * stride_;
+    }
+
+    forcedinline const T* row(uint32 y) const
+    {
+        assert(y < height_);
+
+        return buffer_.data() + y * stride_;
+    }
+
+    forcedinline T& operator()(uint32 x, uint32 y)
+    {
+        assert(x < width_);
+
+        return row(y)[x];
+    }
+
+    forcedinline const T& operator()(uint32 x, uint32 y) const
+    {
+        assert(x < width_);
+
+        return row(y)[x];
+    }
+
+    forcedinline T* data()
+    {
+        return buffer_.data();
+    }
+
+    forcedinline const T* data() const
+    {
+        return buffer_.data();
+    }
+
+    forcedinline uint32 width() const
+    {
+        return width_;
+    }
+
+    forcedinline uint32 height() const
+    {
+        return height_;
+    }
+
+    forcedinline uint32 stride() const
+    {
+        return stride_;
+    }
+
+    static uint32 aligned_stride(uint32 width)
+    {
+        const uint32 samples = 32 / sizeof(T);
+
+        return (width + samples - 1) / samples * samples;
+    }
+
+private:
+    aligned_buffer<T, 32> buffer_;
+    uint32 width_;
+    uint32 height_;
+    uint32 stride_;
+
+    // noncopyable
+    image_plane(const image_plane&);
+    const image_plane& operator=(const image_plane&);
+};
+
+typedef image_plane<uint8> uint8_plane;
+typedef image_plane<float> float_plane;
+
+
+//==============================================================================
+
+//------------------------------------------------------------------------------
+
+/**
+ * Pan laws of the mixing functions
+ */
+
+enum PanLawTypes
+{
+    LINEAR_PAN_LAW,
+    CONSTANT_POWER_PAN_LAW
+};
+
+
+//------------------------------------------------------------------------------
+
+/**
+ * Level detection of the envelope followers
+ */
+
+enum EnvelopeModeTypes
+{
+    PEAK_ENVELOPE,
+    RMS_ENVELOPE
+};
+
+
+//------------------------------------------------------------------------------
+
+/**
+ * Accuracy of the transcendental functions
+ */
+
+enum MathAccuracyTypes
+{
+    FAST_MATH_ACCURACY,
+    ACCURATE_MATH_ACCURACY
+};
+
+
+//------------------------------------------------------------------------------
+
+/**
+ * Operators of the pixel compositing functions
+ */
+
+enum CompositeModeTypes
+{
+    CLEAR_COMPOSITE,
+    SOURCE_COMPOSITE,
+    DESTINATION_COMPOSITE,
+    SOURCE_OVER_COMPOSITE,
+    DESTINATION_OVER_COMPOSITE,
+    SOURCE_IN_COMPOSITE,
+    DESTINATION_IN_COMPOSITE,
+    SOURCE_OUT_COMPOSITE,
+    DESTINATION_OUT_COMPOSITE,
+    SOURCE_ATOP_COMPOSITE,
+    DESTINATION_ATOP_COMPOSITE,
+    XOR_COMPOSITE,
+    MULTIPLY_COMPOSITE,
+    SCREEN_COMPOSITE,
+    OVERLAY_COMPOSITE,
+    ADD_COMPOSITE
+};
+
+
+//------------------------------------------------------------------------------
+
+/**
+ * Standards and ranges of the colour conversion functions
+ */
+
+enum ColorSpaceTypes
+{
+    BT601_LIMITED_COLOR_SPACE,
+    BT601_FULL_COLOR_SPACE,
+    BT709_LIMITED_COLOR_SPACE,
+    BT709_FULL_COLOR_SPACE
+};
+
+
 //------------------------------------------------------------------------------
 
 /**
@@ -615,37 +1048,1347 @@ typedef aligned_buffer<double, 32> double_buffer;
         datatype * src_buffer_a, \
         datatype * src_buffer_b, \
         datatype * dst_buffer, \
+        uint32 size) const = 0; \
+    \
+    virtual void abs_buffer_ ##datatype ( \
+        datatype * src_buffer, \
         uint32 size) const = 0;
 
+/**
+ * Reductions, accumtype is int64 for signed integers, uint64 for unsigned
+ * integers and double for float and double.
+ *
+ * Integer sums and dot products are exact unless they wrap around accumtype,
+ * float and double ones are compensated (Kahan) so they stay accurate on very
+ * long buffers, their last bits depend on the backend. min_buffer and
+ * max_buffer store in index (when not null) the position of the first
+ * occurrence of the result, peak_abs_buffer of the int64 minimum wraps like
+ * abs_buffer does. Empty buffers reduce to zero, NaN values are not supported.
+ */
 
-//------------------------------------------------------------------------------
+#define math_interface_reduction_functions(datatype, accumtype) \
+    virtual accumtype sum_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 size) const = 0; \
+    \
+    virtual accumtype dot_product_ ##datatype ( \
+        datatype * src_buffer_a, \
+        datatype * src_buffer_b, \
+        uint32 size) const = 0; \
+    \
+    virtual datatype min_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 size, \
+        uint32 * index) const = 0; \
+    \
+    virtual datatype max_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 size, \
+        uint32 * index) const = 0; \
+    \
+    virtual accumtype peak_abs_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 size) const = 0; \
+    \
+    virtual double rms_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 size) const = 0;
 
-class math_interface_
-{
-public:
-    // Define a name for the math implementation
-    virtual const char* name() const = 0;
 
-    // Basic types functions
-    math_interface_common_functions(int8)
-    math_interface_common_functions(uint8)
-    math_interface_common_functions(int16)
-    math_interface_common_functions(uint16)
-    math_interface_common_functions(int32)
+/**
+ * Saturating arithmetic for the 8 and 16 bit integers, the results are clamped
+ * to the range of the datatype instead of wrapping around like add_buffers and
+ * friends do, which is what pixels and small samples need.
+ *
+ * scale_buffer_saturate scales in place in single precision and truncates
+ * like scale_buffer does. average_buffers gives (a + b + 1) >> 1 without any
+ * intermediate overflow, rounding halves up for the signed types too.
+ */
+
+#define math_interface_saturating_functions(datatype) \
+    virtual void add_buffers_saturate_ ##datatype ( \
+        datatype * src_buffer_a, \
+        datatype * src_buffer_b, \
+        datatype * dst_buffer, \
+        uint32 size) const = 0; \
+    \
+    virtual void subtract_buffers_saturate_ ##datatype ( \
+        datatype * src_buffer_a, \
+        datatype * src_buffer_b, \
+        datatype * dst_buffer, \
+        uint32 size) const = 0; \
+    \
+    virtual void scale_buffer_saturate_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 size, \
+        float gain) const = 0; \
+    \
+    virtual void average_buffers_ ##datatype ( \
+        datatype * src_buffer_a, \
+        datatype * src_buffer_b, \
+        datatype * dst_buffer, \
+        uint32 size) const = 0;
+
+
+/**
+ * Gain ramps scale the buffer in place with a gain that moves from start_gain
+ * at the first sample towards end_gain, which is reached one sample past the
+ * end of the buffer: consecutive calls chaining the gains are seamless.
+ *
+ * ramp_scale_buffer interpolates linearly, the gain of sample i being
+ * start_gain + (end_gain - start_gain) * i / size. exp_ramp_scale_buffer
+ * follows the exponential curve start_gain * (end_gain / start_gain) ^ (i / size),
+ * which sounds even for fades spanning many decibels: the gains must be non
+ * zero with the same sign, otherwise the ramp is linear. Exponential gains are
+ * accurate to about 1e-5 relative in float, so the backends differ in the last
+ * bits.
+ */
+
+#define math_interface_floating_functions(datatype) \
+    virtual void multiply_add_buffers_ ##datatype ( \
+        datatype * src_buffer_a, \
+        datatype * src_buffer_b, \
+        datatype * src_buffer_c, \
+        datatype * dst_buffer, \
+        uint32 size) const = 0; \
+    \
+    virtual void scale_add_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        datatype gain) const = 0; \
+    \
+    virtual void ramp_scale_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 size, \
+        datatype start_gain, \
+        datatype end_gain) const = 0; \
+    \
+    virtual void exp_ramp_scale_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 size, \
+        datatype start_gain, \
+        datatype end_gain) const = 0;
+
+
+/**
+ * Mixing functions work on the two channels of a stereo pair in one pass.
+ *
+ * pan_mono_to_stereo writes the source scaled by the pan gains into the left
+ * and right buffers, pan going from -1 (hard left) to 1 (hard right). The
+ * linear law sums the two gains to one, the constant power law keeps the sum
+ * of their squares to one, being 3dB down at the center. balance_stereo
+ * attenuates in place the channel opposite to the balance side, leaving the
+ * other one untouched. mix_dry_wet crossfades linearly between the dry (mix 0)
+ * and the wet (mix 1) buffers. Positions out of their range are clamped.
+ *
+ * The ramped variants move from the start to the end position like the gain
+ * ramps above, interpolating linearly the channel gains of the two positions.
+ *
+ * interleave_buffers packs size frames of the planar channel buffers into
+ * dst_buffer one frame after the other, deinterleave_buffer splits them back.
+ * On x86 the frames are transposed in groups of four channels, then a pair,
+ * leaving an odd last channel to the scalar loop (doubles go by pairs before
+ * AVX), and stereo has a path of its own. NEON stores two and four channels
+ * with vst2q / vst4q and six and eight a pair of channels at a time, other
+ * channel counts go through the FPU backend.
+ */
+
+#define math_interface_mixing_functions(datatype) \
+    virtual void pan_mono_to_stereo_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_left_buffer, \
+        datatype * dst_right_buffer, \
+        uint32 size, \
+        datatype pan, \
+        PanLawTypes law) const = 0; \
+    \
+    virtual void ramp_pan_mono_to_stereo_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_left_buffer, \
+        datatype * dst_right_buffer, \
+        uint32 size, \
+        datatype start_pan, \
+        datatype end_pan, \
+        PanLawTypes law) const = 0; \
+    \
+    virtual void balance_stereo_ ##datatype ( \
+        datatype * left_buffer, \
+        datatype * right_buffer, \
+        uint32 size, \
+        datatype balance) const = 0; \
+    \
+    virtual void ramp_balance_stereo_ ##datatype ( \
+        datatype * left_buffer, \
+        datatype * right_buffer, \
+        uint32 size, \
+        datatype start_balance, \
+        datatype end_balance) const = 0; \
+    \
+    virtual void mix_dry_wet_ ##datatype ( \
+        datatype * dry_buffer, \
+        datatype * wet_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        datatype mix) const = 0; \
+    \
+    virtual void ramp_mix_dry_wet_ ##datatype ( \
+        datatype * dry_buffer, \
+        datatype * wet_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        datatype start_mix, \
+        datatype end_mix) const = 0; \
+    \
+    virtual void interleave_buffers_ ##datatype ( \
+        datatype ** src_buffers, \
+        datatype * dst_buffer, \
+        uint32 channels, \
+        uint32 size) const = 0; \
+    \
+    virtual void deinterleave_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype ** dst_buffers, \
+        uint32 channels, \
+        uint32 size) const = 0;
+
+
+/**
+ * Conversion functions move samples between the integer formats of the audio
+ * devices and the floating point buffers. Integers map to [-1, 1) with a scale
+ * of 1 / 2^(bits - 1), int24 samples being packed in three little endian bytes.
+ *
+ * Converting to integers saturates at the range of the format and rounds with
+ * the given mode. A non null dither_seed adds triangular (TPDF) dither of one
+ * LSB peak before rounding: the noise depends only on the seed and the sample
+ * index, and the seed is advanced by size so consecutive buffers continue the
+ * same noise sequence.
+ */
+
+#define math_interface_conversion_functions(integer, datatype) \
+    virtual void convert_buffer_ ##integer ##_to_ ##datatype ( \
+        integer * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size) const = 0; \
+    \
+    virtual void convert_buffer_ ##datatype ##_to_ ##integer ( \
+        datatype * src_buffer, \
+        integer * dst_buffer, \
+        uint32 size, \
+        FloatRoundingModeTypes rounding, \
+        uint32 * dither_seed) const = 0;
+
+
+/**
+ * Filter functions run a bank of cascaded biquad sections in transposed direct
+ * form II over interleaved buffers, every channel with its own coefficients and
+ * state as laid out by biquad_bank. Each sample goes through the sections as
+ *
+ *   y = b0 * x + z1
+ *   z1 = b1 * x - a1 * y + z2
+ *   z2 = b2 * x - a2 * y
+ *
+ * The simd backends process as many channels as fit in a register at once, so
+ * banks of many channels are where they pay off. The source and destination
+ * buffers may be the same, the state is updated in place.
+ *
+ * process_polyphase computes size dot products of taps values, the kind of
+ * filtering a polyphase resampler does: each dst_buffer[i] is the sum over k
+ * of coefficients[rows[i] * taps + k] * src_buffer[offsets[i] + k]. Rows are
+ * walked with unaligned loads, so any offset runs at full simd speed.
+ */
+
+#define math_interface_filter_functions(datatype) \
+    virtual void process_biquad_bank_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 channels, \
+        uint32 frames, \
+        datatype * coefficients, \
+        datatype * state, \
+        uint32 sections) const = 0; \
+    \
+    virtual void process_polyphase_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        datatype * coefficients, \
+        uint32 taps, \
+        uint32 * rows, \
+        uint32 * offsets) const = 0;
+
+
+/**
+ * Transform functions run the butterflies of a forward complex FFT in place,
+ * over split real and imaginary buffers of a power of two size holding their
+ * input in bit reversed order. Odd powers of two start with a radix 2 pass,
+ * then every radix 4 pass of span L (1 or 2, then 4 times the previous one up
+ * to size / 4) reads 6 * L twiddles following the ones of the previous pass:
+ * the real parts of w^k for k < L, their imaginary parts, then the same for
+ * w^2k and w^3k, with w = exp(-2 pi i / (4 L)).
+ *
+ * The simd backends vectorize the passes spanning at least a register. The fft
+ * class builds and caches the twiddles, and does the reordering, scaling and
+ * real transforms around them.
+ */
+
+#define math_interface_transform_functions(datatype) \
+    virtual void fft_butterflies_ ##datatype ( \
+        datatype * real_buffer, \
+        datatype * imag_buffer, \
+        uint32 size, \
+        const datatype * twiddles) const = 0;
+
+
+/**
+ * Dynamics functions are the blocks compressors, limiters and clippers are
+ * built from.
+ *
+ * process_envelope_bank follows the level of interleaved channels with one
+ * pole smoothing, every channel with its own coefficients and state as laid
+ * out by envelope_bank. Each sample moves the envelope towards the absolute
+ * value of the input, or its square for RMS_ENVELOPE, by the attack
+ * coefficient when the level is above it and by the release one otherwise.
+ * RMS envelopes are written as their square root. Like the biquad banks, the
+ * simd backends follow as many channels as fit in a register at once.
+ *
+ * compressor_gain_buffer maps levels in decibels to gains in decibels: zero
+ * up to the threshold, then (1 / ratio - 1) times the overshoot, with a
+ * quadratic curve knee decibels wide centered on the threshold.
+ * limiter_gain_buffer maps linear levels to the linear gains bringing them
+ * down to the threshold, threshold / max(level, threshold); fed the envelope
+ * of a signal whose audio is then delayed, it makes a lookahead limiter.
+ * soft_clip_buffer saturates to -1 and 1 through the rational approximation
+ * of tanh x (27 + x^2) / (27 + 9 x^2), clamped at |x| = 3 where it reaches 1
+ * with a flat slope. These three work sample by sample at full simd width.
+ * The source and destination buffers may be the same.
+ */
+
+#define math_interface_dynamics_functions(datatype) \
+    virtual void process_envelope_bank_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 channels, \
+        uint32 frames, \
+        datatype * coefficients, \
+        datatype * state, \
+        EnvelopeModeTypes mode) const = 0; \
+    \
+    virtual void compressor_gain_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        datatype threshold, \
+        datatype ratio, \
+        datatype knee) const = 0; \
+    \
+    virtual void limiter_gain_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        datatype threshold) const = 0; \
+    \
+    virtual void soft_clip_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size) const = 0;
+
+
+/**
+ * Transcendental functions evaluate exp, log, sin, cos, tanh and pow sample by
+ * sample through range reduction and minimax polynomials, on every backend
+ * including the FPU one, so they never call the C library per element.
+ *
+ * ACCURATE_MATH_ACCURACY keeps the error within a few ulps of the exact
+ * result, FAST_MATH_ACCURACY trades it for shorter polynomials, around 2e-5
+ * relative for floats and 1e-11 for doubles. The maximum errors measured, in
+ * ulps of the datatype, are:
+ *
+ *                  float            double
+ *                  fast  accurate   fast     accurate
+ *   exp            70    1          8800     1
+ *   log            5     2          34400    2
+ *   sin / cos      26    2          40100    3
+ *   tanh           350   3          65500    3
+ *
+ * Denormal inputs are read as zeros of their sign on every backend, the FPU
+ * one included. exp returns infinity past the overflow threshold and zero
+ * below the smallest normal result. log returns minus infinity for zero, and
+ * so for denormals, and NaN for negative values. sin and cos reduce the argument by
+ * multiples of pi / 2 in double, floats included, so the bounds hold close to
+ * the zeros too, up to |x| = 2^20 with or without fused multiply add. Past
+ * 2^20 the error grows with |x|, and from 2^30 on, where floats are already
+ * 64 apart, finite arguments are reduced as zeros: sin gives 0 and cos 1, so
+ * the results stay in [-1, 1] up to the largest finite value. Infinities
+ * give NaN.
+ * sincos_buffer fills both outputs for the cost of one. pow is exp(y log x)
+ * for positive bases x: accurate floats are computed through doubles and stay
+ * within half an ulp, otherwise the error of the log is scaled by |y log x|,
+ * adding about that many ulps to the bound of exp.
+ * NaN inputs give NaN, and the source and destination buffers may be the
+ * same.
+ */
+
+#define math_interface_transcendental_functions(datatype) \
+    virtual void exp_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        MathAccuracyTypes accuracy) const = 0; \
+    \
+    virtual void log_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        MathAccuracyTypes accuracy) const = 0; \
+    \
+    virtual void sin_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        MathAccuracyTypes accuracy) const = 0; \
+    \
+    virtual void cos_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        MathAccuracyTypes accuracy) const = 0; \
+    \
+    virtual void sincos_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * sin_buffer, \
+        datatype * cos_buffer, \
+        uint32 size, \
+        MathAccuracyTypes accuracy) const = 0; \
+    \
+    virtual void tanh_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        MathAccuracyTypes accuracy) const = 0; \
+    \
+    virtual void pow_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * exponent_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        MathAccuracyTypes accuracy) const = 0;
+
+
+/**
+ * Pixel functions work on interleaved RGBA pixels, red, green, blue and alpha
+ * one after the other, with 8 bit channels for uint8 and channels in the 0..1
+ * range for float. The size is given in pixels, four elements each.
+ *
+ * premultiply_rgba multiplies the colour channels of every pixel by its alpha,
+ * unpremultiply_rgba divides them back, giving zero colours to transparent
+ * pixels. 8 bit channels are rounded to nearest, c * a / 255 exactly as the
+ * division would give it, and unpremultiplied colours are clamped to 255 since
+ * they can't be larger than alpha in a valid premultiplied pixel.
+ *
+ * composite_rgba composes premultiplied source pixels over premultiplied
+ * backdrop ones and writes premultiplied results. The Porter-Duff operators
+ * give source * Fa + backdrop * Fb, where the factors are 0, 1, the alpha of
+ * the other pixel or one minus it, so SOURCE_OVER_COMPOSITE is
+ * source + backdrop * (1 - source alpha). The blend modes mix the colours
+ * where the two pixels overlap and keep each one where the other is
+ * transparent, with source over alpha:
+ *
+ *   MULTIPLY_COMPOSITE   s * d + s * (1 - da) + d * (1 - sa)
+ *   SCREEN_COMPOSITE     s + d - s * d
+ *   OVERLAY_COMPOSITE    multiply or screen by the backdrop, then as above
+ *   ADD_COMPOSITE        min(s + d, 1)
+ *
+ * 8 bit results match the ones of the FPU implementation to the bit. The
+ * destination may be the same buffer as any of the sources.
+ */
+
+#define math_interface_pixel_functions(datatype) \
+    virtual void premultiply_rgba_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 pixels) const = 0; \
+    \
+    virtual void unpremultiply_rgba_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 pixels) const = 0; \
+    \
+    virtual void composite_rgba_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * backdrop_buffer, \
+        datatype * dst_buffer, \
+        uint32 pixels, \
+        CompositeModeTypes mode) const = 0;
+
+
+/**
+ * Colour functions convert 8 bit RGBA pixels, laid out as for the pixel
+ * functions, from and to YUV and grayscale and split them in planes.
+ *
+ * The colour space selects the BT.601 or BT.709 weights of the luma and the
+ * range of the YUV samples: full range uses all the 0..255 values, limited
+ * (video) range puts luma in 16..235 and chroma in 16..240. The conversions
+ * use fixed point coefficients, 15 bits to YUV and 13 bits back to RGB, and
+ * round to nearest, so every backend gives the same bytes as the FPU one.
+ *
+ * rgba_to_gray writes the luma of each pixel, gray_to_rgba turns luma back in
+ * opaque gray pixels. Alpha is ignored going to YUV and set to 255 coming back.
+ *
+ * The I420 and NV12 functions convert whole images of width x height pixels,
+ * with the stride of each row or plane given in bytes. Chroma is subsampled
+ * by two in both directions: the conversion to YUV averages each 2x2 block of
+ * pixels, repeating the last row and column for odd sizes, the conversion to
+ * RGBA repeats each chroma sample over its block. I420 keeps U and V in
+ * separate planes of (width + 1) / 2 x (height + 1) / 2 samples, NV12 in a
+ * single plane of interleaved U, V pairs.
+ *
+ * pack_rgba_planes interleaves four planes of channels in RGBA pixels,
+ * unpack_rgba_planes splits them back. The alpha plane can be null, to make
+ * opaque pixels or to drop the alpha channel.
+ */
+
+#define math_interface_color_functions(datatype) \
+    virtual void rgba_to_gray_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 pixels, \
+        ColorSpaceTypes space) const = 0; \
+    \
+    virtual void gray_to_rgba_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 pixels, \
+        ColorSpaceTypes space) const = 0; \
+    \
+    virtual void rgba_to_i420_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 src_stride, \
+        datatype * y_buffer, \
+        uint32 y_stride, \
+        datatype * u_buffer, \
+        uint32 u_stride, \
+        datatype * v_buffer, \
+        uint32 v_stride, \
+        uint32 width, \
+        uint32 height, \
+        ColorSpaceTypes space) const = 0; \
+    \
+    virtual void i420_to_rgba_ ##datatype ( \
+        datatype * y_buffer, \
+        uint32 y_stride, \
+        datatype * u_buffer, \
+        uint32 u_stride, \
+        datatype * v_buffer, \
+        uint32 v_stride, \
+        datatype * dst_buffer, \
+        uint32 dst_stride, \
+        uint32 width, \
+        uint32 height, \
+        ColorSpaceTypes space) const = 0; \
+    \
+    virtual void rgba_to_nv12_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 src_stride, \
+        datatype * y_buffer, \
+        uint32 y_stride, \
+        datatype * uv_buffer, \
+        uint32 uv_stride, \
+        uint32 width, \
+        uint32 height, \
+        ColorSpaceTypes space) const = 0; \
+    \
+    virtual void nv12_to_rgba_ ##datatype ( \
+        datatype * y_buffer, \
+        uint32 y_stride, \
+        datatype * uv_buffer, \
+        uint32 uv_stride, \
+        datatype * dst_buffer, \
+        uint32 dst_stride, \
+        uint32 width, \
+        uint32 height, \
+        ColorSpaceTypes space) const = 0; \
+    \
+    virtual void pack_rgba_planes_ ##datatype ( \
+        datatype * red_buffer, \
+        datatype * green_buffer, \
+        datatype * blue_buffer, \
+        datatype * alpha_buffer, \
+        datatype * dst_buffer, \
+        uint32 pixels) const = 0; \
+    \
+    virtual void unpack_rgba_planes_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * red_buffer, \
+        datatype * green_buffer, \
+        datatype * blue_buffer, \
+        datatype * alpha_buffer, \
+        uint32 pixels) const = 0;
+
+
+/**
+ * Image functions filter planes of width x height float samples, with rows
+ * stride samples apart as image_plane lays them out. Samples past the edges
+ * repeat the edge ones, and source and destination must not overlap.
+ *
+ * convolve_rows runs the kernel along every row, each destination sample being
+ * the sum over k of kernel[k] * src[x + k - kernel_size / 2], convolve_columns
+ * runs it along every column: a separable filter is one pass after the other.
+ * box_blur_rows and box_blur_columns average the 2 * radius + 1 samples around
+ * each one with running sums, so any radius costs the same.
+ *
+ * The simd backends vectorize the row passes across the pixels of a row, and
+ * the column passes go through tiles a few hundred columns wide, so the rows a
+ * kernel reads stay in cache from one output row to the next on large images.
+ */
+
+#define math_interface_image_functions(datatype) \
+    virtual void convolve_rows_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 src_stride, \
+        datatype * dst_buffer, \
+        uint32 dst_stride, \
+        uint32 width, \
+        uint32 height, \
+        datatype * kernel, \
+        uint32 kernel_size) const = 0; \
+    \
+    virtual void convolve_columns_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 src_stride, \
+        datatype * dst_buffer, \
+        uint32 dst_stride, \
+        uint32 width, \
+        uint32 height, \
+        datatype * kernel, \
+        uint32 kernel_size) const = 0; \
+    \
+    virtual void box_blur_rows_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 src_stride, \
+        datatype * dst_buffer, \
+        uint32 dst_stride, \
+        uint32 width, \
+        uint32 height, \
+        uint32 radius) const = 0; \
+    \
+    virtual void box_blur_columns_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 src_stride, \
+        datatype * dst_buffer, \
+        uint32 dst_stride, \
+        uint32 width, \
+        uint32 height, \
+        uint32 radius) const = 0;
+
+
+/**
+ * Resize functions run the two passes of a separable resampling filter with
+ * the coefficient tables image_resizer builds. Destination position i reads
+ * taps consecutive source positions from offsets[i], weighted by
+ * coefficients[i * taps + k]: the tables fold the positions past the edges in
+ * the edge ones, so no read leaves the plane.
+ *
+ * resize_rows filters height rows of pixels of channels interleaved samples in
+ * rows of width pixels, from datatype samples to float ones. resize_columns
+ * filters width samples wide float rows in height destination rows, rounding
+ * to nearest and saturating when they are uint8.
+ *
+ * The simd backends vectorize the row pass over the taps of single channel
+ * rows and over the channels of RGBA ones, and the column pass across the
+ * samples of the rows, going through the tiles of the image functions.
+ */
+
+#define math_interface_resize_functions(datatype) \
+    virtual void resize_rows_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 src_stride, \
+        float * dst_buffer, \
+        uint32 dst_stride, \
+        uint32 width, \
+        uint32 height, \
+        uint32 channels, \
+        float * coefficients, \
+        uint32 taps, \
+        uint32 * offsets) const = 0; \
+    \
+    virtual void resize_columns_ ##datatype ( \
+        float * src_buffer, \
+        uint32 src_stride, \
+        datatype * dst_buffer, \
+        uint32 dst_stride, \
+        uint32 width, \
+        uint32 height, \
+        float * coefficients, \
+        uint32 taps, \
+        uint32 * offsets) const = 0;
+
+
+//------------------------------------------------------------------------------
+
+class math_interface_
+{
+public:
+    // Define a name for the math implementation
+    virtual const char* name() const = 0;
+
+    // Basic types functions
+    math_interface_common_functions(int8)
+    math_interface_common_functions(uint8)
+    math_interface_common_functions(int16)
+    math_interface_common_functions(uint16)
+    math_interface_common_functions(int32)
     math_interface_common_functions(uint32)
     math_interface_common_functions(int64)
     math_interface_common_functions(uint64)
     math_interface_common_functions(float)
     math_interface_common_functions(double)
 
-    // Other misc functions
+    // Reduction functions
+    math_interface_reduction_functions(int8, int64)
+    math_interface_reduction_functions(uint8, uint64)
+    math_interface_reduction_functions(int16, int64)
+    math_interface_reduction_functions(uint16, uint64)
+    math_interface_reduction_functions(int32, int64)
+    math_interface_reduction_functions(uint32, uint64)
+    math_interface_reduction_functions(int64, int64)
+    math_interface_reduction_functions(uint64, uint64)
+    math_interface_reduction_functions(float, double)
+    math_interface_reduction_functions(double, double)
+
+    // Saturating functions
+    math_interface_saturating_functions(int8)
+    math_interface_saturating_functions(uint8)
+    math_interface_saturating_functions(int16)
+    math_interface_saturating_functions(uint16)
+
+    // Floating point types functions
+    math_interface_floating_functions(float)
+    math_interface_floating_functions(double)
+
+    // Mixing functions
+    math_interface_mixing_functions(float)
+    math_interface_mixing_functions(double)
+
+    // Conversion functions
+    math_interface_conversion_functions(int16, float)
+    math_interface_conversion_functions(int24, float)
+    math_interface_conversion_functions(int32, float)
+    math_interface_conversion_functions(int16, double)
+    math_interface_conversion_functions(int24, double)
+    math_interface_conversion_functions(int32, double)
+
+    // Filter functions
+    math_interface_filter_functions(float)
+    math_interface_filter_functions(double)
+
+    // Transform functions
+    math_interface_transform_functions(float)
+    math_interface_transform_functions(double)
+
+    // Dynamics functions
+    math_interface_dynamics_functions(float)
+    math_interface_dynamics_functions(double)
+
+    // Transcendental functions
+    math_interface_transcendental_functions(float)
+    math_interface_transcendental_functions(double)
+
+    // Pixel functions
+    math_interface_pixel_functions(uint8)
+    math_interface_pixel_functions(float)
+
+    // Colour functions
+    math_interface_color_functions(uint8)
+
+    // Image functions
+    math_interface_image_functions(float)
+
+    // Resize functions
+    math_interface_resize_functions(uint8)
+    math_interface_resize_functions(float)
+
+    // Other misc functions
+
+    // Destructor
+    virtual ~math_interface_() { }
+
+protected:
+    // Constructor
+    math_interface_() { }
+};
+
+
+//==============================================================================
+
+//------------------------------------------------------------------------------
+
+/**
+ * Plain function pointers table, one entry for each math_interface_ function.
+ *
+ * The math factory fills it once with the functions of the selected backend,
+ * calling through it avoids the virtual table lookup of math_interface_ so it
+ * is the cheapest way to issue lots of calls on small buffers. Being a POD it
+ * can be freely copied around.
+ */
+
+#define math_dispatch_table_common_functions(datatype) \
+    void (*clear_buffer_ ##datatype)( \
+        datatype * src_buffer, \
+        uint32 size); \
+    \
+    void (*set_buffer_ ##datatype)( \
+        datatype * src_buffer, \
+        uint32 size, \
+        datatype value); \
+    \
+    void (*scale_buffer_ ##datatype)( \
+        datatype * src_buffer, \
+        uint32 size, \
+        float gain); \
+    \
+    void (*scale_buffer_ ##datatype ##_double_gain)( \
+        datatype * src_buffer, \
+        uint32 size, \
+        double gain); \
+    \
+    void (*copy_buffer_ ##datatype)( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size); \
+    \
+    void (*add_buffers_ ##datatype)( \
+        datatype * src_buffer_a, \
+        datatype * src_buffer_b, \
+        datatype * dst_buffer, \
+        uint32 size); \
+    \
+    void (*subtract_buffers_ ##datatype)( \
+        datatype * src_buffer_a, \
+        datatype * src_buffer_b, \
+        datatype * dst_buffer, \
+        uint32 size); \
+    \
+    void (*multiply_buffers_ ##datatype)( \
+        datatype * src_buffer_a, \
+        datatype * src_buffer_b, \
+        datatype * dst_buffer, \
+        uint32 size); \
+    \
+    void (*divide_buffers_ ##datatype)( \
+        datatype * src_buffer_a, \
+        datatype * src_buffer_b, \
+        datatype * dst_buffer, \
+        uint32 size); \
+    \
+    void (*abs_buffer_ ##datatype)( \
+        datatype * src_buffer, \
+        uint32 size);
+
+
+#define math_dispatch_table_reduction_functions(datatype, accumtype) \
+    accumtype (*sum_buffer_ ##datatype)( \
+        datatype * src_buffer, \
+        uint32 size); \
+    \
+    accumtype (*dot_product_ ##datatype)( \
+        datatype * src_buffer_a, \
+        datatype * src_buffer_b, \
+        uint32 size); \
+    \
+    datatype (*min_buffer_ ##datatype)( \
+        datatype * src_buffer, \
+        uint32 size, \
+        uint32 * index); \
+    \
+    datatype (*max_buffer_ ##datatype)( \
+        datatype * src_buffer, \
+        uint32 size, \
+        uint32 * index); \
+    \
+    accumtype (*peak_abs_buffer_ ##datatype)( \
+        datatype * src_buffer, \
+        uint32 size); \
+    \
+    double (*rms_buffer_ ##datatype)( \
+        datatype * src_buffer, \
+        uint32 size);
+
+
+#define math_dispatch_table_saturating_functions(datatype) \
+    void (*add_buffers_saturate_ ##datatype)( \
+        datatype * src_buffer_a, \
+        datatype * src_buffer_b, \
+        datatype * dst_buffer, \
+        uint32 size); \
+    \
+    void (*subtract_buffers_saturate_ ##datatype)( \
+        datatype * src_buffer_a, \
+        datatype * src_buffer_b, \
+        datatype * dst_buffer, \
+        uint32 size); \
+    \
+    void (*scale_buffer_saturate_ ##datatype)( \
+        datatype * src_buffer, \
+        uint32 size, \
+        float gain); \
+    \
+    void (*average_buffers_ ##datatype)( \
+        datatype * src_buffer_a, \
+        datatype * src_buffer_b, \
+        datatype * dst_buffer, \
+        uint32 size);
+
+
+#define math_dispatch_table_floating_functions(datatype) \
+    void (*multiply_add_buffers_ ##datatype)( \
+        datatype * src_buffer_a, \
+        datatype * src_buffer_b, \
+        datatype * src_buffer_c, \
+        datatype * dst_buffer, \
+        uint32 size); \
+    \
+    void (*scale_add_buffer_ ##datatype)( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        datatype gain); \
+    \
+    void (*ramp_scale_buffer_ ##datatype)( \
+        datatype * src_buffer, \
+        uint32 size, \
+        datatype start_gain, \
+        datatype end_gain); \
+    \
+    void (*exp_ramp_scale_buffer_ ##datatype)( \
+        datatype * src_buffer, \
+        uint32 size, \
+        datatype start_gain, \
+        datatype end_gain);
+
+
+#define math_dispatch_table_mixing_functions(datatype) \
+    void (*pan_mono_to_stereo_ ##datatype)( \
+        datatype * src_buffer, \
+        datatype * dst_left_buffer, \
+        datatype * dst_right_buffer, \
+        uint32 size, \
+        datatype pan, \
+        PanLawTypes law); \
+    \
+    void (*ramp_pan_mono_to_stereo_ ##datatype)( \
+        datatype * src_buffer, \
+        datatype * dst_left_buffer, \
+        datatype * dst_right_buffer, \
+        uint32 size, \
+        datatype start_pan, \
+        datatype end_pan, \
+        PanLawTypes law); \
+    \
+    void (*balance_stereo_ ##datatype)( \
+        datatype * left_buffer, \
+        datatype * right_buffer, \
+        uint32 size, \
+        datatype balance); \
+    \
+    void (*ramp_balance_stereo_ ##datatype)( \
+        datatype * left_buffer, \
+        datatype * right_buffer, \
+        uint32 size, \
+        datatype start_balance, \
+        datatype end_balance); \
+    \
+    void (*mix_dry_wet_ ##datatype)( \
+        datatype * dry_buffer, \
+        datatype * wet_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        datatype mix); \
+    \
+    void (*ramp_mix_dry_wet_ ##datatype)( \
+        datatype * dry_buffer, \
+        datatype * wet_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        datatype start_mix, \
+        datatype end_mix); \
+    \
+    void (*interleave_buffers_ ##datatype)( \
+        datatype ** src_buffers, \
+        datatype * dst_buffer, \
+        uint32 channels, \
+        uint32 size); \
+    \
+    void (*deinterleave_buffer_ ##datatype)( \
+        datatype * src_buffer, \
+        datatype ** dst_buffers, \
+        uint32 channels, \
+        uint32 size);
+
+#define math_dispatch_table_conversion_functions(integer, datatype) \
+    void (*convert_buffer_ ##integer ##_to_ ##datatype)( \
+        integer * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size); \
+    \
+    void (*convert_buffer_ ##datatype ##_to_ ##integer)( \
+        datatype * src_buffer, \
+        integer * dst_buffer, \
+        uint32 size, \
+        FloatRoundingModeTypes rounding, \
+        uint32 * dither_seed);
+
+
+#define math_dispatch_table_filter_functions(datatype) \
+    void (*process_biquad_bank_ ##datatype)( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 channels, \
+        uint32 frames, \
+        datatype * coefficients, \
+        datatype * state, \
+        uint32 sections); \
+    \
+    void (*process_polyphase_ ##datatype)( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        datatype * coefficients, \
+        uint32 taps, \
+        uint32 * rows, \
+        uint32 * offsets);
+
+
+#define math_dispatch_table_transform_functions(datatype) \
+    void (*fft_butterflies_ ##datatype)( \
+        datatype * real_buffer, \
+        datatype * imag_buffer, \
+        uint32 size, \
+        const datatype * twiddles);
+
+
+#define math_dispatch_table_dynamics_functions(datatype) \
+    void (*process_envelope_bank_ ##datatype)( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 channels, \
+        uint32 frames, \
+        datatype * coefficients, \
+        datatype * state, \
+        EnvelopeModeTypes mode); \
+    \
+    void (*compressor_gain_buffer_ ##datatype)( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        datatype threshold, \
+        datatype ratio, \
+        datatype knee); \
+    \
+    void (*limiter_gain_buffer_ ##datatype)( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        datatype threshold); \
+    \
+    void (*soft_clip_buffer_ ##datatype)( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size);
+
+
+#define math_dispatch_table_transcendental_functions(datatype) \
+    void (*exp_buffer_ ##datatype)( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        MathAccuracyTypes accuracy); \
+    \
+    void (*log_buffer_ ##datatype)( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        MathAccuracyTypes accuracy); \
+    \
+    void (*sin_buffer_ ##datatype)( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        MathAccuracyTypes accuracy); \
+    \
+    void (*cos_buffer_ ##datatype)( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        MathAccuracyTypes accuracy); \
+    \
+    void (*sincos_buffer_ ##datatype)( \
+        datatype * src_buffer, \
+        datatype * sin_buffer, \
+        datatype * cos_buffer, \
+        uint32 size, \
+        MathAccuracyTypes accuracy); \
+    \
+    void (*tanh_buffer_ ##datatype)( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        MathAccuracyTypes accuracy); \
+    \
+    void (*pow_buffer_ ##datatype)( \
+        datatype * src_buffer, \
+        datatype * exponent_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        MathAccuracyTypes accuracy);
+
 
-    // Destructor
-    virtual ~math_interface_() { }
+#define math_dispatch_table_pixel_functions(datatype) \
+    void (*premultiply_rgba_ ##datatype)( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 pixels); \
+    \
+    void (*unpremultiply_rgba_ ##datatype)( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 pixels); \
+    \
+    void (*composite_rgba_ ##datatype)( \
+        datatype * src_buffer, \
+        datatype * backdrop_buffer, \
+        datatype * dst_buffer, \
+        uint32 pixels, \
+        CompositeModeTypes mode);
 
-protected:
-    // Constructor
-    math_interface_() { }
+
+#define math_dispatch_table_color_functions(datatype) \
+    void (*rgba_to_gray_ ##datatype)( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 pixels, \
+        ColorSpaceTypes space); \
+    \
+    void (*gray_to_rgba_ ##datatype)( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 pixels, \
+        ColorSpaceTypes space); \
+    \
+    void (*rgba_to_i420_ ##datatype)( \
+        datatype * src_buffer, \
+        uint32 src_stride, \
+        datatype * y_buffer, \
+        uint32 y_stride, \
+        datatype * u_buffer, \
+        uint32 u_stride, \
+        datatype * v_buffer, \
+        uint32 v_stride, \
+        uint32 width, \
+        uint32 height, \
+        ColorSpaceTypes space); \
+    \
+    void (*i420_to_rgba_ ##datatype)( \
+        datatype * y_buffer, \
+        uint32 y_stride, \
+        datatype * u_buffer, \
+        uint32 u_stride, \
+        datatype * v_buffer, \
+        uint32 v_stride, \
+        datatype * dst_buffer, \
+        uint32 dst_stride, \
+        uint32 width, \
+        uint32 height, \
+        ColorSpaceTypes space); \
+    \
+    void (*rgba_to_nv12_ ##datatype)( \
+        datatype * src_buffer, \
+        uint32 src_stride, \
+        datatype * y_buffer, \
+        uint32 y_stride, \
+        datatype * uv_buffer, \
+        uint32 uv_stride, \
+        uint32 width, \
+        uint32 height, \
+        ColorSpaceTypes space); \
+    \
+    void (*nv12_to_rgba_ ##datatype)( \
+        datatype * y_buffer, \
+        uint32 y_stride, \
+        datatype * uv_buffer, \
+        uint32 uv_stride, \
+        datatype * dst_buffer, \
+        uint32 dst_stride, \
+        uint32 width, \
+        uint32 height, \
+        ColorSpaceTypes space); \
+    \
+    void (*pack_rgba_planes_ ##datatype)( \
+        datatype * red_buffer, \
+        datatype * green_buffer, \
+        datatype * blue_buffer, \
+        datatype * alpha_buffer, \
+        datatype * dst_buffer, \
+        uint32 pixels); \
+    \
+    void (*unpack_rgba_planes_ ##datatype)( \
+        datatype * src_buffer, \
+        datatype * red_buffer, \
+        datatype * green_buffer, \
+        datatype * blue_buffer, \
+        datatype * alpha_buffer, \
+        uint32 pixels);
+
+
+#define math_dispatch_table_image_functions(datatype) \
+    void (*convolve_rows_ ##datatype)( \
+        datatype * src_buffer, \
+        uint32 src_stride, \
+        datatype * dst_buffer, \
+        uint32 dst_stride, \
+        uint32 width, \
+        uint32 height, \
+        datatype * kernel, \
+        uint32 kernel_size); \
+    \
+    void (*convolve_columns_ ##datatype)( \
+        datatype * src_buffer, \
+        uint32 src_stride, \
+        datatype * dst_buffer, \
+        uint32 dst_stride, \
+        uint32 width, \
+        uint32 height, \
+        datatype * kernel, \
+        uint32 kernel_size); \
+    \
+    void (*box_blur_rows_ ##datatype)( \
+        datatype * src_buffer, \
+        uint32 src_stride, \
+        datatype * dst_buffer, \
+        uint32 dst_stride, \
+        uint32 width, \
+        uint32 height, \
+        uint32 radius); \
+    \
+    void (*box_blur_columns_ ##datatype)( \
+        datatype * src_buffer, \
+        uint32 src_stride, \
+        datatype * dst_buffer, \
+        uint32 dst_stride, \
+        uint32 width, \
+        uint32 height, \
+        uint32 radius);
+
+
+#define math_dispatch_table_resize_functions(datatype) \
+    void (*resize_rows_ ##datatype)( \
+        datatype * src_buffer, \
+        uint32 src_stride, \
+        float * dst_buffer, \
+        uint32 dst_stride, \
+        uint32 width, \
+        uint32 height, \
+        uint32 channels, \
+        float * coefficients, \
+        uint32 taps, \
+        uint32 * offsets); \
+    \
+    void (*resize_columns_ ##datatype)( \
+        float * src_buffer, \
+        uint32 src_stride, \
+        datatype * dst_buffer, \
+        uint32 dst_stride, \
+        uint32 width, \
+        uint32 height, \
+        float * coefficients, \
+        uint32 taps, \
+        uint32 * offsets);
+
+
+//------------------------------------------------------------------------------
+
+struct math_dispatch_table
+{
+    // Name of the math implementation the functions come from
+    const char* name;
+
+    // Basic types functions
+    math_dispatch_table_common_functions(int8)
+    math_dispatch_table_common_functions(uint8)
+    math_dispatch_table_common_functions(int16)
+    math_dispatch_table_common_functions(uint16)
+    math_dispatch_table_common_functions(int32)
+    math_dispatch_table_common_functions(uint32)
+    math_dispatch_table_common_functions(int64)
+    math_dispatch_table_common_functions(uint64)
+    math_dispatch_table_common_functions(float)
+    math_dispatch_table_common_functions(double)
+
+    // Reduction functions
+    math_dispatch_table_reduction_functions(int8, int64)
+    math_dispatch_table_reduction_functions(uint8, uint64)
+    math_dispatch_table_reduction_functions(int16, int64)
+    math_dispatch_table_reduction_functions(uint16, uint64)
+    math_dispatch_table_reduction_functions(int32, int64)
+    math_dispatch_table_reduction_functions(uint32, uint64)
+    math_dispatch_table_reduction_functions(int64, int64)
+    math_dispatch_table_reduction_functions(uint64, uint64)
+    math_dispatch_table_reduction_functions(float, double)
+    math_dispatch_table_reduction_functions(double, double)
+
+    // Saturating functions
+    math_dispatch_table_saturating_functions(int8)
+    math_dispatch_table_saturating_functions(uint8)
+    math_dispatch_table_saturating_functions(int16)
+    math_dispatch_table_saturating_functions(uint16)
+
+    // Floating point types functions
+    math_dispatch_table_floating_functions(float)
+    math_dispatch_table_floating_functions(double)
+
+    // Mixing functions
+    math_dispatch_table_mixing_functions(float)
+    math_dispatch_table_mixing_functions(double)
+
+    // Conversion functions
+    math_dispatch_table_conversion_functions(int16, float)
+    math_dispatch_table_conversion_functions(int24, float)
+    math_dispatch_table_conversion_functions(int32, float)
+    math_dispatch_table_conversion_functions(int16, double)
+    math_dispatch_table_conversion_functions(int24, double)
+    math_dispatch_table_conversion_functions(int32, double)
+
+    // Filter functions
+    math_dispatch_table_filter_functions(float)
+    math_dispatch_table_filter_functions(double)
+
+    // Transform functions
+    math_dispatch_table_transform_functions(float)
+    math_dispatch_table_transform_functions(double)
+
+    // Dynamics functions
+    math_dispatch_table_dynamics_functions(float)
+    math_dispatch_table_dynamics_functions(double)
+
+    // Transcendental functions
+    math_dispatch_table_transcendental_functions(float)
+    math_dispatch_table_transcendental_functions(double)
+
+    // Pixel functions
+    math_dispatch_table_pixel_functions(uint8)
+    math_dispatch_table_pixel_functions(float)
+
+    // Colour functions
+    math_dispatch_table_color_functions(uint8)
+
+    // Image functions
+    math_dispatch_table_image_functions(float)
+
+    // Resize functions
+    math_dispatch_table_resize_functions(uint8)
+    math_dispatch_table_resize_functions(float)
+
+    // Other misc functions
 };
 
 
@@ -666,7 +2409,8 @@ enum MathFlags
     FORCE_SSE42 =  8,
     FORCE_AVX   =  9,
     FORCE_AVX2  = 10,
-    FORCE_NEON  = 11
+    FORCE_NEON  = 11,
+    FORCE_AVX512 = 12
 };
 
 
@@ -681,7 +2425,8 @@ enum MathFlags
 class math
 {
 public:
-    // Construct a math factory
+    // Construct a math factory, without fallback throws when the processor
+    // or the build lacks the forced instruction set
     math(int flag=AUTODETECT, bool fallback=true);
 
     // Destructor
@@ -690,14 +2435,24 @@ public:
     // Returns the current arch name
     const char* name() const;
 
+    // Returns true if the instruction set of a flag is built and runs here
+    static bool is_supported(int flag);
+
     // Operate on the underlying math object
     forcedinline math_interface_* operator->() const
     {
         return math_implementation_.get();
     }
 
+    // Operate on the underlying math functions without virtual calls
+    forcedinline const math_dispatch_table& dispatch() const
+    {
+        return dispatch_table_;
+    }
+
 private:
     std::unique_ptr<math_interface_> math_implementation_;
+    math_dispatch_table dispatch_table_;
 
     // noncopyable
     math(const math&);
@@ -705,6 +2460,414 @@ private:
 };
 
 
+//==============================================================================
+
+//------------------------------------------------------------------------------
+
+template<class T> class fft_plan;
+
+/**
+ * Fast Fourier transform of a power of two size over split real and imaginary
+ * buffers, running its butterflies through the transform functions of a math
+ * backend.
+ *
+ * The bit reversal and twiddle tables of each size are computed once and
+ * shared by all the transforms of that size. Complex transforms take size
+ * values, real ones take size samples and give back the size / 2 + 1 bins from
+ * DC to Nyquist. Forward transforms are not scaled, inverse ones are scaled by
+ * 1 / size so they give back the original values. Each destination may be its
+ * source for in place transforms. The math object must outlive the transform,
+ * which keeps some scratch memory so it can't be shared between threads.
+ */
+
+template<class T>
+class fft
+{
+public:
+    fft(const math& m, uint32 size);
+
+    // Complex transforms of size values
+    void forward(T* src_real, T* src_imag, T* dst_real, T* dst_imag);
+    void inverse(T* src_real, T* src_imag, T* dst_real, T* dst_imag);
+
+    // Real transforms of size samples to size / 2 + 1 bins and back
+    void forward_real(T* src_buffer, T* dst_real, T* dst_imag);
+    void inverse_real(T* src_real, T* src_imag, T* dst_buffer);
+
+    forcedinline uint32 size() const
+    {
+        return size_;
+    }
+
+    forcedinline uint32 bins() const
+    {
+        return size_ / 2 + 1;
+    }
+
+private:
+    void transform(const fft_plan<T>& plan, T* src_real, T* src_imag, T* dst_real, T* dst_imag);
+
+    const math_dispatch_table& dispatch_;
+    uint32 size_;
+    std::shared_ptr<const fft_plan<T> > complex_plan_;
+    std::shared_ptr<const fft_plan<T> > real_plan_;
+    aligned_buffer<T, 32> work_;
+
+    // noncopyable
+    fft(const fft&);
+    const fft& operator=(const fft&);
+};
+
+typedef fft<float> float_fft;
+typedef fft<double> double_fft;
+
+
+//==============================================================================
+
+//------------------------------------------------------------------------------
+
+/**
+ * FIR convolver running a float kernel over a stream of samples, block by
+ * block, through the functions of a math backend.
+ *
+ * Kernels shorter than direct_max_taps are convolved directly, one scaled add
+ * of the block per tap. Longer ones, like reverb impulse responses, are split
+ * in partitions of the block size and convolved with uniformly partitioned
+ * FFT overlap-add through a float_fft. Either way process takes whole blocks
+ * and has no latency, so the block size is the latency of the host buffering:
+ * keep it small for low latency, larger blocks make long kernels cheaper. The
+ * math object must outlive the convolver.
+ */
+
+class fir_convolver
+{
+public:
+    // Kernels of at least this many taps are partitioned, any block size works
+    // but the transforms are padded to twice its next power of two, so a power
+    // of two block wastes the least work
+    enum { direct_max_taps = 64 };
+
+    // Copy the kernel and prepare its partitions
+    fir_convolver(const math& m, const float* kernel, uint32 kernel_size, uint32 block_size);
+
+    // Convolve size samples, a multiple of the block size, src and dst may be the same
+    void process(float* src_buffer, float* dst_buffer, uint32 size);
+
+    // Forget the past input
+    void reset();
+
+    forcedinline bool is_partitioned() const
+    {
+        return partitions_ > 0;
+    }
+
+    forcedinline uint32 kernel_size() const
+    {
+        return kernel_size_;
+    }
+
+    forcedinline uint32 block_size() const
+    {
+        return block_size_;
+    }
+
+private:
+    void process_direct(float* src_buffer, float* dst_buffer);
+    void process_partitioned(float* src_buffer, float* dst_buffer);
+
+    const math_dispatch_table& dispatch_;
+    uint32 kernel_size_;
+    uint32 block_size_;
+    uint32 fft_size_;
+    uint32 bins_;
+    uint32 bins_stride_;
+    uint32 partitions_;
+    uint32 current_partition_;
+
+    std::unique_ptr<float_fft> fft_;
+    float_buffer kernel_;
+    float_buffer history_;
+    float_buffer spectra_;
+    float_buffer delay_line_;
+    float_buffer accumulator_;
+    float_buffer work_;
+    float_buffer overlap_;
+
+    // noncopyable
+    fir_convolver(const fir_convolver&);
+    const fir_convolver& operator=(const fir_convolver&);
+};
+
+
+//==============================================================================
+
+//------------------------------------------------------------------------------
+
+/**
+ * Qualities of the resampler, from the shortest filters to the flattest ones
+ */
+
+enum ResamplerQualityTypes
+{
+    DRAFT_RESAMPLER_QUALITY,
+    NORMAL_RESAMPLER_QUALITY,
+    HIGH_RESAMPLER_QUALITY
+};
+
+
+//------------------------------------------------------------------------------
+
+/**
+ * Polyphase resampler converting a stream of float samples from one sample
+ * rate to another, block by block, through the functions of a math backend.
+ *
+ * Integer rates with a ratio of at most max_rational_phases over the common
+ * divisor are converted exactly, one filter phase per output position. Any
+ * other ratio, like a varispeed one, interpolates linearly between the two
+ * closest of a table of phases. The quality sets the number of taps, the
+ * passband, the stopband and the phases of the Kaiser windowed sinc
+ * prototype: longer filters cost more and delay more, and the taps grow with
+ * the ratio when decimating. The filter dot products of each block run
+ * through process_polyphase. The math object must outlive the resampler.
+ */
+
+class resampler
+{
+public:
+    enum { max_rational_phases = 1024 };
+
+    // Design the filter of the conversion from src_rate to dst_rate
+    resampler(const math& m, double src_rate, double dst_rate,
+        ResamplerQualityTypes quality = NORMAL_RESAMPLER_QUALITY);
+
+    // Convert size samples of any size, returns the number of samples written
+    // to dst_buffer, which must hold max_output_size(size) of them
+    uint32 process(float* src_buffer, float* dst_buffer, uint32 size);
+
+    // Forget the past input
+    void reset();
+
+    // Most samples a block of size samples can give
+    uint32 max_output_size(uint32 size) const;
+
+    // Delay of the filter, in output samples
+    double latency() const;
+
+    forcedinline bool is_rational() const
+    {
+        return rational_;
+    }
+
+    forcedinline uint32 taps() const
+    {
+        return taps_;
+    }
+
+    forcedinline double ratio() const
+    {
+        return dst_rate_ / src_rate_;
+    }
+
+private:
+    void design(double rolloff, double beta);
+
+    const math_dispatch_table& dispatch_;
+    double src_rate_;
+    double dst_rate_;
+    bool rational_;
+    uint32 taps_;
+    uint32 phases_;
+    uint32 up_;
+    uint32 down_;
+    double step_;
+
+    uint32 position_;
+    uint32 phase_;
+    double fraction_;
+
+    float_buffer kernel_;
+    float_buffer history_;
+    float_buffer work_;
+    float_buffer products_;
+    float_buffer weights_;
+    uint32_buffer rows_;
+    uint32_buffer offsets_;
+
+    // noncopyable
+    resampler(const resampler&);
+    const resampler& operator=(const resampler&);
+};
+
+
+//==============================================================================
+
+//------------------------------------------------------------------------------
+
+/**
+ * Ways of the image filter to blur by a gaussian
+ */
+
+enum GaussianBlurTypes
+{
+    KERNEL_GAUSSIAN_BLUR,
+    BOX_GAUSSIAN_BLUR
+};
+
+
+//------------------------------------------------------------------------------
+
+/**
+ * Separable filters of float planes, through the image functions of a math
+ * backend.
+ *
+ * Every filter runs its horizontal passes into a work plane and its vertical
+ * ones into the destination, which can be the source itself but must have its
+ * size, and repeats the edge samples past the edges. Box blurs cost the same
+ * at any radius. Gaussian blurs either convolve the sampled kernel, exact but
+ * of 2 * ceil(3 * sigma) + 1 taps, or approximate it with three box blurs of
+ * the same variance, at a constant cost which is what large sigmas want. The
+ * math object must outlive the filter.
+ */
+
+class image_filter
+{
+public:
+    enum { box_gaussian_passes = 3 };
+
+    explicit image_filter(const math& m);
+
+    // Filter by a horizontal then a vertical kernel, of any size
+    void convolve(float_plane& src, float_plane& dst,
+        float* horizontal_kernel, uint32 horizontal_size,
+        float* vertical_kernel, uint32 vertical_size);
+
+    // Average the 2 * radius + 1 samples around each one in both directions
+    void box_blur(float_plane& src, float_plane& dst,
+        uint32 horizontal_radius, uint32 vertical_radius);
+
+    void gaussian_blur(float_plane& src, float_plane& dst, double sigma,
+        GaussianBlurTypes type = KERNEL_GAUSSIAN_BLUR);
+
+    // Normalized gaussian kernel of 2 * ceil(3 * sigma) + 1 taps
+    static void gaussian_kernel(double sigma, float_buffer& kernel);
+
+    // Radii of box_gaussian_passes box blurs with the variance of the gaussian
+    static void gaussian_box_radii(double sigma, uint32* radii);
+
+private:
+    void prepare(const float_plane& src, const float_plane& dst);
+
+    const math_dispatch_table& dispatch_;
+    float_plane work_;
+    float_buffer kernel_;
+
+    // noncopyable
+    image_filter(const image_filter&);
+    const image_filter& operator=(const image_filter&);
+};
+
+
+//==============================================================================
+
+//------------------------------------------------------------------------------
+
+/**
+ * Filters of the image resizer, from the cheapest to the sharpest
+ */
+
+enum ResizeFilterTypes
+{
+    BILINEAR_RESIZE_FILTER,
+    BICUBIC_RESIZE_FILTER,
+    LANCZOS3_RESIZE_FILTER
+};
+
+
+//------------------------------------------------------------------------------
+
+/**
+ * Resizer of uint8 or float planes from one size to another, through the
+ * resize functions of a math backend.
+ *
+ * The constructor builds the coefficient table of every destination column and
+ * row once, so a resizer is meant to be kept for all the images of a size. A
+ * process runs the horizontal pass into a work plane of dst_width pixels by
+ * src_height rows, then the vertical one into the destination. Pixels can have
+ * 1 to 4 channels, the plane of RGBA pixels being 4 times wider: premultiply
+ * them first so the transparent pixels do not bleed their colour.
+ *
+ * The bilinear filter reaches 1 pixel away, the bicubic one (Keys, a = -0.5) 2
+ * and the Lanczos-3 one 3. Downscaling stretches them over 1 / scale source
+ * pixels, so they also filter out what the smaller size cannot hold, and the
+ * taps grow with the ratio: from 1 / max_downscale to max_upscale times the
+ * size in each direction are supported. The math object must outlive the
+ * resizer.
+ */
+
+class image_resizer
+{
+public:
+    enum { max_downscale = 64, max_upscale = 8 };
+
+    // Build the tables of the resize from src_width x src_height pixels to
+    // dst_width x dst_height pixels
+    image_resizer(const math& m, uint32 src_width, uint32 src_height,
+        uint32 dst_width, uint32 dst_height,
+        ResizeFilterTypes filter = LANCZOS3_RESIZE_FILTER, uint32 channels = 1);
+
+    // Resize src to dst, planes of channels * width samples by height rows
+    void process(uint8_plane& src, uint8_plane& dst);
+    void process(float_plane& src, float_plane& dst);
+
+    forcedinline uint32 horizontal_taps() const
+    {
+        return horizontal_taps_;
+    }
+
+    forcedinline uint32 vertical_taps() const
+    {
+        return vertical_taps_;
+    }
+
+    forcedinline uint32 channels() const
+    {
+        return channels_;
+    }
+
+    // Weight of the filter at a distance of x source pixels, at scale 1
+    static double filter_weight(ResizeFilterTypes filter, double x);
+
+    // Distance past which the weights of the filter are zero, at scale 1
+    static double filter_support(ResizeFilterTypes filter);
+
+    // Coefficients and offsets of a resize of one direction, as the resize
+    // functions take them, returns the taps of each position
+    static uint32 design(ResizeFilterTypes filter, uint32 src_size, uint32 dst_size,
+        float_buffer& coefficients, uint32_buffer& offsets);
+
+private:
+
+    const math_dispatch_table& dispatch_;
+    uint32 src_width_;
+    uint32 src_height_;
+    uint32 dst_width_;
+    uint32 dst_height_;
+    uint32 channels_;
+    uint32 horizontal_taps_;
+    uint32 vertical_taps_;
+
+    float_buffer horizontal_coefficients_;
+    float_buffer vertical_coefficients_;
+    uint32_buffer horizontal_offsets_;
+    uint32_buffer vertical_offsets_;
+    float_plane work_;
+
+    // noncopyable
+    image_resizer(const image_resizer&);
+    const image_resizer& operator=(const image_resizer&);
+};
+
+
 } // end namespace
 
 #endif // __WATERSPOUT_SIMD_ABSTRACTION_FRAMEWORK_H__
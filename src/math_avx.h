@@ -54,7 +54,7 @@ public:
     {
         AVX_MIN_SIZE    = 8,
         AVX_MIN_SAMPLES = 32,
-        AVX_ALIGN       = 0x0F
+        AVX_ALIGN       = 0x1F
     };
 
 
@@ -85,7 +85,7 @@ public:
             const ptrdiff_t align_bytes = ((ptrdiff_t)src_buffer & AVX_ALIGN);
 
             // Copy unaligned head
-            simd_unroll_head_8(
+            simd_loop_head(float, AVX_ALIGN,
                 --size;
                 *src_buffer++ = 0.0f;
             );
@@ -130,7 +130,7 @@ public:
             const ptrdiff_t align_bytes = ((ptrdiff_t)src_buffer & AVX_ALIGN);
 
             // Copy unaligned head
-            simd_unroll_head_8(
+            simd_loop_head(float, AVX_ALIGN,
                 --size;
                 *src_buffer++ = value;
             );
@@ -175,7 +175,7 @@ public:
             const ptrdiff_t align_bytes = ((ptrdiff_t)src_buffer & AVX_ALIGN);
 
             // Copy unaligned head
-            simd_unroll_head_8(
+            simd_loop_head(float, AVX_ALIGN,
                 --size;
                 *src_buffer = *src_buffer * gain;
                 undenormalizef(*src_buffer);
@@ -224,7 +224,7 @@ public:
             const ptrdiff_t align_bytes = ((ptrdiff_t)src_buffer & AVX_ALIGN);
 
             // Copy unaligned head
-            simd_unroll_head_8(
+            simd_loop_head(float, AVX_ALIGN,
                 --size;
                 *src_buffer = *src_buffer * (float)gain;
                 undenormalizef(*src_buffer);
@@ -274,7 +274,7 @@ public:
             assert(size >= AVX_MIN_SIZE);
 
             // Copy unaligned head
-            simd_unroll_head_8(
+            simd_loop_head(float, AVX_ALIGN,
                 --size;
                 *dst_buffer++ = *src_buffer++;
             );
@@ -324,7 +324,7 @@ public:
             assert(size >= AVX_MIN_SIZE);
 
             // Copy unaligned head
-            simd_unroll_head_8(
+            simd_loop_head(float, AVX_ALIGN,
                 --size;
                 *dst_buffer++ = *src_buffer_a++ + *src_buffer_b++;
             );
@@ -378,7 +378,7 @@ public:
             assert(size >= AVX_MIN_SIZE);
 
             // Copy unaligned head
-            simd_unroll_head_8(
+            simd_loop_head(float, AVX_ALIGN,
                 --size;
                 *dst_buffer++ = *src_buffer_a++ - *src_buffer_b++;
             );
@@ -432,7 +432,7 @@ public:
             assert(size >= AVX_MIN_SIZE);
 
             // Copy unaligned head
-            simd_unroll_head_8(
+            simd_loop_head(float, AVX_ALIGN,
                 --size;
                 *dst_buffer = *src_buffer_a++ * *src_buffer_b++;
                 undenormalizef(*dst_buffer);
@@ -483,14 +483,14 @@ public:
             (align_bytes != ((ptrdiff_t)src_buffer_a & AVX_ALIGN) ||
              align_bytes != ((ptrdiff_t)src_buffer_b & AVX_ALIGN)))
         {
-            math_sse42::multiply_buffers_float(src_buffer_a, src_buffer_b, dst_buffer, size);
+            math_sse42::divide_buffers_float(src_buffer_a, src_buffer_b, dst_buffer, size);
         }
         else
         {
             assert(size >= AVX_MIN_SIZE);
 
             // Copy unaligned head
-            simd_unroll_head_8(
+            simd_loop_head(float, AVX_ALIGN,
                 --size;
                 *dst_buffer = *src_buffer_a++ / *src_buffer_b++;
                 undenormalizef(*dst_buffer);
@@ -546,7 +546,7 @@ public:
             const ptrdiff_t align_bytes = ((ptrdiff_t)src_buffer & AVX_ALIGN);
 
             // Copy unaligned head
-            simd_unroll_head_4(
+            simd_loop_head(double, AVX_ALIGN,
                 --size;
                 *src_buffer++ = 0.0;
             );
@@ -591,7 +591,7 @@ public:
             const ptrdiff_t align_bytes = ((ptrdiff_t)src_buffer & AVX_ALIGN);
 
             // Copy unaligned head
-            simd_unroll_head_4(
+            simd_loop_head(double, AVX_ALIGN,
                 --size;
                 *src_buffer++ = value;
             );
@@ -636,7 +636,7 @@ public:
             const ptrdiff_t align_bytes = ((ptrdiff_t)src_buffer & AVX_ALIGN);
 
             // Copy unaligned head
-            simd_unroll_head_4(
+            simd_loop_head(double, AVX_ALIGN,
                 --size;
                 *src_buffer = *src_buffer * (double)gain;
                 undenormalizef(*src_buffer);
@@ -686,7 +686,7 @@ public:
             assert(size >= AVX_MIN_SIZE);
 
             // Copy unaligned head
-            simd_unroll_head_4(
+            simd_loop_head(double, AVX_ALIGN,
                 --size;
                 *dst_buffer++ = *src_buffer++;
             );
@@ -714,6 +714,2657 @@ public:
         }
     }
 
+
+    //==========================================================================
+
+    //--------------------------------------------------------------------------
+
+    #define math_avx_multiply_add_buffers_impl(datatype, vector_type, scalar_madd, vector_madd) \
+        void multiply_add_buffers_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* src_buffer_c, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_buffer & AVX_ALIGN); \
+            \
+            if (size < AVX_MIN_SAMPLES || \
+                (align_bytes != ((ptrdiff_t)src_buffer_a & AVX_ALIGN) || \
+                 align_bytes != ((ptrdiff_t)src_buffer_b & AVX_ALIGN) || \
+                 align_bytes != ((ptrdiff_t)src_buffer_c & AVX_ALIGN))) \
+            { \
+                math_sse42::multiply_add_buffers_ ##datatype ( \
+                    src_buffer_a, src_buffer_b, src_buffer_c, dst_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= AVX_MIN_SIZE); \
+                \
+                const disable_sse_denormals disable_denormals; \
+                \
+                /* Copy unaligned head */ \
+                simd_loop_head(datatype, AVX_ALIGN, \
+                    --size; \
+                    *dst_buffer++ = scalar_madd(*src_buffer_a++, *src_buffer_b++, *src_buffer_c++); \
+                ); \
+                \
+                /* Multiply and add with simd */ \
+                vector_type* vector_buffer_a = (vector_type*)src_buffer_a; \
+                vector_type* vector_buffer_b = (vector_type*)src_buffer_b; \
+                vector_type* vector_buffer_c = (vector_type*)src_buffer_c; \
+                vector_type* vector_dst_buffer = (vector_type*)dst_buffer; \
+                \
+                uint32 vector_count = size / (32 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    *vector_dst_buffer = vector_madd( \
+                        *vector_buffer_a, *vector_buffer_b, *vector_buffer_c); \
+                    \
+                    ++vector_buffer_a; \
+                    ++vector_buffer_b; \
+                    ++vector_buffer_c; \
+                    ++vector_dst_buffer; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer_a = (datatype*)vector_buffer_a; \
+                src_buffer_b = (datatype*)vector_buffer_b; \
+                src_buffer_c = (datatype*)vector_buffer_c; \
+                dst_buffer = (datatype*)vector_dst_buffer; \
+                \
+                simd_loop_tail(32 / sizeof(datatype), \
+                    *dst_buffer++ = scalar_madd(*src_buffer_a++, *src_buffer_b++, *src_buffer_c++); \
+                ); \
+            } \
+        }
+
+    #define math_avx_scale_add_buffer_impl(datatype, vector_type, vector_set, scalar_madd, vector_madd) \
+        void scale_add_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype gain) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_buffer & AVX_ALIGN); \
+            \
+            if (size < AVX_MIN_SAMPLES || \
+                align_bytes != ((ptrdiff_t)src_buffer & AVX_ALIGN)) \
+            { \
+                math_sse42::scale_add_buffer_ ##datatype ( \
+                    src_buffer, dst_buffer, size, gain); \
+            } \
+            else \
+            { \
+                assert(size >= AVX_MIN_SIZE); \
+                \
+                const disable_sse_denormals disable_denormals; \
+                \
+                /* Copy unaligned head */ \
+                simd_loop_head(datatype, AVX_ALIGN, \
+                    --size; \
+                    *dst_buffer = scalar_madd(*src_buffer++, gain, *dst_buffer); \
+                    ++dst_buffer; \
+                ); \
+                \
+                /* Scale and accumulate with simd */ \
+                const vector_type vgain = vector_set; \
+                vector_type* vector_buffer = (vector_type*)src_buffer; \
+                vector_type* vector_dst_buffer = (vector_type*)dst_buffer; \
+                \
+                uint32 vector_count = size / (32 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    *vector_dst_buffer = vector_madd( \
+                        *vector_buffer, vgain, *vector_dst_buffer); \
+                    \
+                    ++vector_buffer; \
+                    ++vector_dst_buffer; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer = (datatype*)vector_buffer; \
+                dst_buffer = (datatype*)vector_dst_buffer; \
+                \
+                simd_loop_tail(32 / sizeof(datatype), \
+                    *dst_buffer = scalar_madd(*src_buffer++, gain, *dst_buffer); \
+                    ++dst_buffer; \
+                ); \
+            } \
+        }
+
+
+    //--------------------------------------------------------------------------
+
+    #define math_avx_ramp_scale_buffer_impl(datatype, vector_type, vector_set, vector_loadu, vector_mul, vector_add) \
+        void ramp_scale_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            datatype start_gain, \
+            datatype end_gain) const \
+        { \
+            if (size < AVX_MIN_SAMPLES) \
+            { \
+                math_sse42::ramp_scale_buffer_ ##datatype ( \
+                    src_buffer, size, start_gain, end_gain); \
+            } \
+            else \
+            { \
+                assert(size >= AVX_MIN_SIZE); \
+                \
+                const disable_sse_denormals disable_denormals; \
+                \
+                const uint32 vector_size = 32 / sizeof(datatype); \
+                const ptrdiff_t align_bytes = \
+                    ((ptrdiff_t)src_buffer & AVX_ALIGN); \
+                const datatype increment = \
+                    ramp_increment(start_gain, end_gain, size); \
+                \
+                /* Ramp unaligned head */ \
+                const uint32 head_count = (uint32)(((AVX_ALIGN + 1) - align_bytes) \
+                    & AVX_ALIGN) / sizeof(datatype); \
+                ramp_scale_generic(src_buffer, head_count, start_gain, increment, 0); \
+                \
+                /* Ramp with simd, the sample indices are advanced in registers */ \
+                datatype lanes[32 / sizeof(datatype)]; \
+                ramp_index_lanes(lanes, vector_size, head_count); \
+                \
+                const vector_type vstart = vector_set(start_gain); \
+                const vector_type vincrement = vector_set(increment); \
+                const vector_type vstep = vector_set((datatype)vector_size); \
+                vector_type vindex = vector_loadu(lanes); \
+                vector_type* vector_buffer = (vector_type*)(src_buffer + head_count); \
+                \
+                uint32 vector_count = (size - head_count) / vector_size; \
+                const uint32 index = head_count + vector_count * vector_size; \
+                while (vector_count--) \
+                { \
+                    *vector_buffer = vector_mul(*vector_buffer, \
+                        vector_add(vstart, vector_mul(vincrement, vindex))); \
+                    vindex = vector_add(vindex, vstep); \
+                    \
+                    ++vector_buffer; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                ramp_scale_generic((datatype*)vector_buffer, size - index, \
+                    start_gain, increment, index); \
+            } \
+        }
+
+    #define math_avx_exp_ramp_scale_buffer_impl(datatype, vector_type, vector_set, vector_loadu, vector_mul) \
+        void exp_ramp_scale_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            datatype start_gain, \
+            datatype end_gain) const \
+        { \
+            if (size < AVX_MIN_SAMPLES || \
+                ! is_exp_ramp(start_gain, end_gain, size)) \
+            { \
+                math_sse42::exp_ramp_scale_buffer_ ##datatype ( \
+                    src_buffer, size, start_gain, end_gain); \
+            } \
+            else \
+            { \
+                assert(size >= AVX_MIN_SIZE); \
+                \
+                const disable_sse_denormals disable_denormals; \
+                \
+                const uint32 vector_size = 32 / sizeof(datatype); \
+                const ptrdiff_t align_bytes = \
+                    ((ptrdiff_t)src_buffer & AVX_ALIGN); \
+                const double log_ratio = \
+                    exp_ramp_log_ratio(start_gain, end_gain, size); \
+                \
+                /* Ramp unaligned head */ \
+                const uint32 head_count = (uint32)(((AVX_ALIGN + 1) - align_bytes) \
+                    & AVX_ALIGN) / sizeof(datatype); \
+                exp_ramp_scale_generic(src_buffer, head_count, start_gain, log_ratio, 0); \
+                \
+                /* Ramp with simd, the gains are multiplied in registers and */ \
+                /* put back on the exact curve at the start of every block */ \
+                datatype lanes[32 / sizeof(datatype)]; \
+                \
+                const vector_type vstep = \
+                    vector_set((datatype)std::exp(log_ratio * vector_size)); \
+                vector_type* vector_buffer = (vector_type*)(src_buffer + head_count); \
+                \
+                uint32 index = head_count; \
+                uint32 vector_count = (size - head_count) / vector_size; \
+                while (vector_count > 0) \
+                { \
+                    uint32 block_count = vector_count < RAMP_BLOCK_SIZE / vector_size ? \
+                        vector_count : RAMP_BLOCK_SIZE / vector_size; \
+                    vector_count -= block_count; \
+                    \
+                    exp_ramp_lanes(lanes, vector_size, start_gain, log_ratio, index); \
+                    vector_type vgain = vector_loadu(lanes); \
+                    index += block_count * vector_size; \
+                    \
+                    while (block_count--) \
+                    { \
+                        *vector_buffer = vector_mul(*vector_buffer, vgain); \
+                        vgain = vector_mul(vgain, vstep); \
+                        \
+                        ++vector_buffer; \
+                    } \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                exp_ramp_scale_generic((datatype*)vector_buffer, size - index, \
+                    start_gain, log_ratio, index); \
+            } \
+        }
+
+
+    //--------------------------------------------------------------------------
+
+    #define math_avx_mixing_kernels_impl(datatype, vector_type, vector_set, vector_loadu, vector_mul, vector_add) \
+        void stereo_gain_buffers_ ##datatype ( \
+            datatype* src_left_buffer, \
+            datatype* src_right_buffer, \
+            datatype* dst_left_buffer, \
+            datatype* dst_right_buffer, \
+            uint32 size, \
+            datatype left_gain, \
+            datatype right_gain) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_left_buffer & AVX_ALIGN); \
+            \
+            if (size < AVX_MIN_SAMPLES || \
+                align_bytes != ((ptrdiff_t)dst_right_buffer & AVX_ALIGN) || \
+                align_bytes != ((ptrdiff_t)src_left_buffer & AVX_ALIGN) || \
+                align_bytes != ((ptrdiff_t)src_right_buffer & AVX_ALIGN)) \
+            { \
+                math_sse42::stereo_gain_buffers_ ##datatype (src_left_buffer, src_right_buffer, \
+                    dst_left_buffer, dst_right_buffer, size, left_gain, right_gain); \
+            } \
+            else \
+            { \
+                assert(size >= AVX_MIN_SIZE); \
+                \
+                const disable_sse_denormals disable_denormals; \
+                \
+                const uint32 vector_size = 32 / sizeof(datatype); \
+                \
+                /* Scale unaligned head */ \
+                const uint32 head_count = (uint32)(((AVX_ALIGN + 1) - align_bytes) \
+                    & AVX_ALIGN) / sizeof(datatype); \
+                stereo_gain_generic(src_left_buffer, src_right_buffer, \
+                    dst_left_buffer, dst_right_buffer, head_count, left_gain, right_gain); \
+                \
+                /* Scale both channels with simd */ \
+                const vector_type vleft_gain = vector_set(left_gain); \
+                const vector_type vright_gain = vector_set(right_gain); \
+                vector_type* vector_src_left = (vector_type*)(src_left_buffer + head_count); \
+                vector_type* vector_src_right = (vector_type*)(src_right_buffer + head_count); \
+                vector_type* vector_dst_left = (vector_type*)(dst_left_buffer + head_count); \
+                vector_type* vector_dst_right = (vector_type*)(dst_right_buffer + head_count); \
+                \
+                uint32 vector_count = (size - head_count) / vector_size; \
+                const uint32 index = head_count + vector_count * vector_size; \
+                while (vector_count--) \
+                { \
+                    const vector_type vleft = *vector_src_left++; \
+                    const vector_type vright = *vector_src_right++; \
+                    \
+                    *vector_dst_left++ = vector_mul(vleft, vleft_gain); \
+                    *vector_dst_right++ = vector_mul(vright, vright_gain); \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                stereo_gain_generic(src_left_buffer + index, src_right_buffer + index, \
+                    dst_left_buffer + index, dst_right_buffer + index, size - index, \
+                    left_gain, right_gain); \
+            } \
+        } \
+        \
+        void ramp_stereo_gain_buffers_ ##datatype ( \
+            datatype* src_left_buffer, \
+            datatype* src_right_buffer, \
+            datatype* dst_left_buffer, \
+            datatype* dst_right_buffer, \
+            uint32 size, \
+            datatype left_gain, \
+            datatype left_increment, \
+            datatype right_gain, \
+            datatype right_increment) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_left_buffer & AVX_ALIGN); \
+            \
+            if (size < AVX_MIN_SAMPLES || \
+                align_bytes != ((ptrdiff_t)dst_right_buffer & AVX_ALIGN) || \
+                align_bytes != ((ptrdiff_t)src_left_buffer & AVX_ALIGN) || \
+                align_bytes != ((ptrdiff_t)src_right_buffer & AVX_ALIGN)) \
+            { \
+                math_sse42::ramp_stereo_gain_buffers_ ##datatype (src_left_buffer, src_right_buffer, \
+                    dst_left_buffer, dst_right_buffer, size, \
+                    left_gain, left_increment, right_gain, right_increment); \
+            } \
+            else \
+            { \
+                assert(size >= AVX_MIN_SIZE); \
+                \
+                const disable_sse_denormals disable_denormals; \
+                \
+                const uint32 vector_size = 32 / sizeof(datatype); \
+                \
+                /* Ramp unaligned head */ \
+                const uint32 head_count = (uint32)(((AVX_ALIGN + 1) - align_bytes) \
+                    & AVX_ALIGN) / sizeof(datatype); \
+                ramp_stereo_gain_generic(src_left_buffer, src_right_buffer, \
+                    dst_left_buffer, dst_right_buffer, head_count, \
+                    left_gain, left_increment, right_gain, right_increment, 0); \
+                \
+                /* Ramp both channels with simd, sharing the sample indices */ \
+                datatype lanes[32 / sizeof(datatype)]; \
+                ramp_index_lanes(lanes, vector_size, head_count); \
+                \
+                const vector_type vleft_gain = vector_set(left_gain); \
+                const vector_type vleft_increment = vector_set(left_increment); \
+                const vector_type vright_gain = vector_set(right_gain); \
+                const vector_type vright_increment = vector_set(right_increment); \
+                const vector_type vstep = vector_set((datatype)vector_size); \
+                vector_type vindex = vector_loadu(lanes); \
+                vector_type* vector_src_left = (vector_type*)(src_left_buffer + head_count); \
+                vector_type* vector_src_right = (vector_type*)(src_right_buffer + head_count); \
+                vector_type* vector_dst_left = (vector_type*)(dst_left_buffer + head_count); \
+                vector_type* vector_dst_right = (vector_type*)(dst_right_buffer + head_count); \
+                \
+                uint32 vector_count = (size - head_count) / vector_size; \
+                const uint32 index = head_count + vector_count * vector_size; \
+                while (vector_count--) \
+                { \
+                    const vector_type vleft = *vector_src_left++; \
+                    const vector_type vright = *vector_src_right++; \
+                    \
+                    *vector_dst_left++ = vector_mul(vleft, \
+                        vector_add(vleft_gain, vector_mul(vleft_increment, vindex))); \
+                    *vector_dst_right++ = vector_mul(vright, \
+                        vector_add(vright_gain, vector_mul(vright_increment, vindex))); \
+                    vindex = vector_add(vindex, vstep); \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                ramp_stereo_gain_generic(src_left_buffer + index, src_right_buffer + index, \
+                    dst_left_buffer + index, dst_right_buffer + index, size - index, \
+                    left_gain, left_increment, right_gain, right_increment, index); \
+            } \
+        } \
+        \
+        void mix_gain_buffers_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype gain_a, \
+            datatype gain_b) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_buffer & AVX_ALIGN); \
+            \
+            if (size < AVX_MIN_SAMPLES || \
+                align_bytes != ((ptrdiff_t)src_buffer_a & AVX_ALIGN) || \
+                align_bytes != ((ptrdiff_t)src_buffer_b & AVX_ALIGN)) \
+            { \
+                math_sse42::mix_gain_buffers_ ##datatype (src_buffer_a, src_buffer_b, \
+                    dst_buffer, size, gain_a, gain_b); \
+            } \
+            else \
+            { \
+                assert(size >= AVX_MIN_SIZE); \
+                \
+                const disable_sse_denormals disable_denormals; \
+                \
+                const uint32 vector_size = 32 / sizeof(datatype); \
+                \
+                /* Mix unaligned head */ \
+                const uint32 head_count = (uint32)(((AVX_ALIGN + 1) - align_bytes) \
+                    & AVX_ALIGN) / sizeof(datatype); \
+                mix_gain_generic(src_buffer_a, src_buffer_b, dst_buffer, head_count, \
+                    gain_a, gain_b); \
+                \
+                /* Mix with simd */ \
+                const vector_type vgain_a = vector_set(gain_a); \
+                const vector_type vgain_b = vector_set(gain_b); \
+                vector_type* vector_buffer_a = (vector_type*)(src_buffer_a + head_count); \
+                vector_type* vector_buffer_b = (vector_type*)(src_buffer_b + head_count); \
+                vector_type* vector_dst_buffer = (vector_type*)(dst_buffer + head_count); \
+                \
+                uint32 vector_count = (size - head_count) / vector_size; \
+                const uint32 index = head_count + vector_count * vector_size; \
+                while (vector_count--) \
+                { \
+                    *vector_dst_buffer++ = vector_add( \
+                        vector_mul(*vector_buffer_a++, vgain_a), \
+                        vector_mul(*vector_buffer_b++, vgain_b)); \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                mix_gain_generic(src_buffer_a + index, src_buffer_b + index, \
+                    dst_buffer + index, size - index, gain_a, gain_b); \
+            } \
+        } \
+        \
+        void ramp_mix_gain_buffers_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype gain_a, \
+            datatype increment_a, \
+            datatype gain_b, \
+            datatype increment_b) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_buffer & AVX_ALIGN); \
+            \
+            if (size < AVX_MIN_SAMPLES || \
+                align_bytes != ((ptrdiff_t)src_buffer_a & AVX_ALIGN) || \
+                align_bytes != ((ptrdiff_t)src_buffer_b & AVX_ALIGN)) \
+            { \
+                math_sse42::ramp_mix_gain_buffers_ ##datatype (src_buffer_a, src_buffer_b, \
+                    dst_buffer, size, gain_a, increment_a, gain_b, increment_b); \
+            } \
+            else \
+            { \
+                assert(size >= AVX_MIN_SIZE); \
+                \
+                const disable_sse_denormals disable_denormals; \
+                \
+                const uint32 vector_size = 32 / sizeof(datatype); \
+                \
+                /* Mix unaligned head */ \
+                const uint32 head_count = (uint32)(((AVX_ALIGN + 1) - align_bytes) \
+                    & AVX_ALIGN) / sizeof(datatype); \
+                ramp_mix_gain_generic(src_buffer_a, src_buffer_b, dst_buffer, head_count, \
+                    gain_a, increment_a, gain_b, increment_b, 0); \
+                \
+                /* Mix with simd, both gains share the sample indices */ \
+                datatype lanes[32 / sizeof(datatype)]; \
+                ramp_index_lanes(lanes, vector_size, head_count); \
+                \
+                const vector_type vgain_a = vector_set(gain_a); \
+                const vector_type vincrement_a = vector_set(increment_a); \
+                const vector_type vgain_b = vector_set(gain_b); \
+                const vector_type vincrement_b = vector_set(increment_b); \
+                const vector_type vstep = vector_set((datatype)vector_size); \
+                vector_type vindex = vector_loadu(lanes); \
+                vector_type* vector_buffer_a = (vector_type*)(src_buffer_a + head_count); \
+                vector_type* vector_buffer_b = (vector_type*)(src_buffer_b + head_count); \
+                vector_type* vector_dst_buffer = (vector_type*)(dst_buffer + head_count); \
+                \
+                uint32 vector_count = (size - head_count) / vector_size; \
+                const uint32 index = head_count + vector_count * vector_size; \
+                while (vector_count--) \
+                { \
+                    *vector_dst_buffer++ = vector_add( \
+                        vector_mul(*vector_buffer_a++, \
+                            vector_add(vgain_a, vector_mul(vincrement_a, vindex))), \
+                        vector_mul(*vector_buffer_b++, \
+                            vector_add(vgain_b, vector_mul(vincrement_b, vindex)))); \
+                    vindex = vector_add(vindex, vstep); \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                ramp_mix_gain_generic(src_buffer_a + index, src_buffer_b + index, \
+                    dst_buffer + index, size - index, \
+                    gain_a, increment_a, gain_b, increment_b, index); \
+            } \
+        }
+
+
+    //--------------------------------------------------------------------------
+
+    #define math_avx_sum_buffer_impl(datatype, vector_type, vector_zero, vector_sum, vector_reduce) \
+        double sum_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size) const \
+        { \
+            if (size < AVX_MIN_SAMPLES) \
+            { \
+                return math_sse42::sum_buffer_ ##datatype (src_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= AVX_MIN_SIZE); \
+                \
+                const ptrdiff_t align_bytes = \
+                    ((ptrdiff_t)src_buffer & AVX_ALIGN); \
+                \
+                double result = 0.0; \
+                \
+                /* Sum unaligned head */ \
+                simd_loop_head(datatype, AVX_ALIGN, \
+                    --size; \
+                    result += *src_buffer++; \
+                ); \
+                \
+                /* Sum with simd, compensating each lane */ \
+                vector_type vsum = vector_zero; \
+                vector_type vcompensation = vector_zero; \
+                vector_type* vector_buffer = (vector_type*)src_buffer; \
+                \
+                uint32 vector_count = size / (32 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    vector_sum(vsum, vcompensation, *vector_buffer); \
+                    \
+                    ++vector_buffer; \
+                } \
+                \
+                result += vector_reduce(vsum, vcompensation); \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer = (datatype*)vector_buffer; \
+                \
+                simd_loop_tail(32 / sizeof(datatype), \
+                    result += *src_buffer++; \
+                ); \
+                \
+                return result; \
+            } \
+        }
+
+    #define math_avx_dot_product_impl(datatype, vector_type, vector_zero, vector_dot, vector_reduce) \
+        double dot_product_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            uint32 size) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)src_buffer_a & AVX_ALIGN); \
+            \
+            if (size < AVX_MIN_SAMPLES || \
+                align_bytes != ((ptrdiff_t)src_buffer_b & AVX_ALIGN)) \
+            { \
+                return math_sse42::dot_product_ ##datatype (src_buffer_a, src_buffer_b, size); \
+            } \
+            else \
+            { \
+                assert(size >= AVX_MIN_SIZE); \
+                \
+                double result = 0.0; \
+                \
+                /* Multiply and sum unaligned head */ \
+                simd_loop_head(datatype, AVX_ALIGN, \
+                    --size; \
+                    result += (double)*src_buffer_a++ * (double)*src_buffer_b++; \
+                ); \
+                \
+                /* Multiply and sum with simd, compensating each lane */ \
+                vector_type vsum = vector_zero; \
+                vector_type vcompensation = vector_zero; \
+                vector_type* vector_buffer_a = (vector_type*)src_buffer_a; \
+                vector_type* vector_buffer_b = (vector_type*)src_buffer_b; \
+                \
+                uint32 vector_count = size / (32 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    vector_dot(vsum, vcompensation, *vector_buffer_a, *vector_buffer_b); \
+                    \
+                    ++vector_buffer_a; \
+                    ++vector_buffer_b; \
+                } \
+                \
+                result += vector_reduce(vsum, vcompensation); \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer_a = (datatype*)vector_buffer_a; \
+                src_buffer_b = (datatype*)vector_buffer_b; \
+                \
+                simd_loop_tail(32 / sizeof(datatype), \
+                    result += (double)*src_buffer_a++ * (double)*src_buffer_b++; \
+                ); \
+                \
+                return result; \
+            } \
+        }
+
+    #define math_avx_extreme_buffer_impl(function, datatype, vector_type, op, vector_set, vector_op) \
+        datatype function ##_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            uint32* index) const \
+        { \
+            if (size < AVX_MIN_SAMPLES) \
+            { \
+                return math_sse42::function ##_ ##datatype (src_buffer, size, index); \
+            } \
+            else \
+            { \
+                assert(size >= AVX_MIN_SIZE); \
+                \
+                const ptrdiff_t align_bytes = \
+                    ((ptrdiff_t)src_buffer & AVX_ALIGN); \
+                \
+                datatype* const buffer = src_buffer; \
+                const uint32 buffer_size = size; \
+                datatype result = *src_buffer; \
+                \
+                /* Compare unaligned head */ \
+                simd_loop_head(datatype, AVX_ALIGN, \
+                    --size; \
+                    if (*src_buffer op result) \
+                        result = *src_buffer; \
+                    ++src_buffer; \
+                ); \
+                \
+                /* Compare with simd */ \
+                vector_type vresult = vector_set; \
+                vector_type* vector_buffer = (vector_type*)src_buffer; \
+                \
+                uint32 vector_count = size / (32 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    vresult = vector_op(*vector_buffer, vresult); \
+                    \
+                    ++vector_buffer; \
+                } \
+                \
+                datatype lanes[32 / sizeof(datatype)]; \
+                memcpy(lanes, &vresult, sizeof(vresult)); \
+                for (uint32 i = 0; i < 32 / sizeof(datatype); ++i) \
+                { \
+                    if (lanes[i] op result) \
+                        result = lanes[i]; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer = (datatype*)vector_buffer; \
+                \
+                simd_loop_tail(32 / sizeof(datatype), \
+                    if (*src_buffer op result) \
+                        result = *src_buffer; \
+                    ++src_buffer; \
+                ); \
+                \
+                if (index != nullptr) \
+                    *index = index_of_value(buffer, buffer_size, result); \
+                \
+                return result; \
+            } \
+        }
+
+    #define math_avx_peak_abs_buffer_impl(datatype, vector_type, vector_zero, vector_peak) \
+        double peak_abs_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size) const \
+        { \
+            if (size < AVX_MIN_SAMPLES) \
+            { \
+                return math_sse42::peak_abs_buffer_ ##datatype (src_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= AVX_MIN_SIZE); \
+                \
+                const ptrdiff_t align_bytes = \
+                    ((ptrdiff_t)src_buffer & AVX_ALIGN); \
+                \
+                datatype result = 0; \
+                \
+                /* Compare unaligned head */ \
+                simd_loop_head(datatype, AVX_ALIGN, \
+                    --size; \
+                    if (std::fabs(*src_buffer) > result) \
+                        result = std::fabs(*src_buffer); \
+                    ++src_buffer; \
+                ); \
+                \
+                /* Compare with simd */ \
+                vector_type vresult = vector_zero; \
+                vector_type* vector_buffer = (vector_type*)src_buffer; \
+                \
+                uint32 vector_count = size / (32 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    vresult = vector_peak(*vector_buffer, vresult); \
+                    \
+                    ++vector_buffer; \
+                } \
+                \
+                datatype lanes[32 / sizeof(datatype)]; \
+                memcpy(lanes, &vresult, sizeof(vresult)); \
+                for (uint32 i = 0; i < 32 / sizeof(datatype); ++i) \
+                { \
+                    if (lanes[i] > result) \
+                        result = lanes[i]; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer = (datatype*)vector_buffer; \
+                \
+                simd_loop_tail(32 / sizeof(datatype), \
+                    if (std::fabs(*src_buffer) > result) \
+                        result = std::fabs(*src_buffer); \
+                    ++src_buffer; \
+                ); \
+                \
+                return result; \
+            } \
+        }
+
+
+    //--------------------------------------------------------------------------
+
+    math_avx_multiply_add_buffers_impl(float, __m256, madd_scalar, madd_ps)
+    math_avx_multiply_add_buffers_impl(double, __m256d, madd_scalar, madd_pd)
+
+    math_avx_scale_add_buffer_impl(float, __m256, _mm256_set1_ps(gain), madd_scalar, madd_ps)
+    math_avx_scale_add_buffer_impl(double, __m256d, _mm256_set1_pd(gain), madd_scalar, madd_pd)
+
+    math_avx_ramp_scale_buffer_impl(float, __m256, _mm256_set1_ps, _mm256_loadu_ps, _mm256_mul_ps, _mm256_add_ps)
+    math_avx_ramp_scale_buffer_impl(double, __m256d, _mm256_set1_pd, _mm256_loadu_pd, _mm256_mul_pd, _mm256_add_pd)
+
+    math_avx_exp_ramp_scale_buffer_impl(float, __m256, _mm256_set1_ps, _mm256_loadu_ps, _mm256_mul_ps)
+    math_avx_exp_ramp_scale_buffer_impl(double, __m256d, _mm256_set1_pd, _mm256_loadu_pd, _mm256_mul_pd)
+
+    math_avx_sum_buffer_impl(float, __m256, _mm256_setzero_ps(), kahan_add_ps, reduce_kahan_ps)
+    math_avx_sum_buffer_impl(double, __m256d, _mm256_setzero_pd(), kahan_add_pd, reduce_kahan_pd)
+
+    math_avx_dot_product_impl(float, __m256, _mm256_setzero_ps(), dot_ps, reduce_kahan_ps)
+    math_avx_dot_product_impl(double, __m256d, _mm256_setzero_pd(), dot_pd, reduce_kahan_pd)
+
+    math_avx_extreme_buffer_impl(min_buffer, float, __m256, <, _mm256_set1_ps(result), _mm256_min_ps)
+    math_avx_extreme_buffer_impl(max_buffer, float, __m256, >, _mm256_set1_ps(result), _mm256_max_ps)
+    math_avx_extreme_buffer_impl(min_buffer, double, __m256d, <, _mm256_set1_pd(result), _mm256_min_pd)
+    math_avx_extreme_buffer_impl(max_buffer, double, __m256d, >, _mm256_set1_pd(result), _mm256_max_pd)
+
+    math_avx_peak_abs_buffer_impl(float, __m256, _mm256_setzero_ps(), peak_ps)
+    math_avx_peak_abs_buffer_impl(double, __m256d, _mm256_setzero_pd(), peak_pd)
+
+
+    //--------------------------------------------------------------------------
+
+    void interleave_buffers_float(
+        float** src_buffers,
+        float* dst_buffer,
+        uint32 channels,
+        uint32 size) const
+    {
+        if (size < AVX_MIN_SAMPLES || (channels != 2 && (channels & 3) != 0))
+        {
+            math_sse42::interleave_buffers_float(src_buffers, dst_buffer, channels, size);
+        }
+        else
+        {
+            const uint32 frames = size & ~7;
+
+            if (channels == 2)
+            {
+                // Unpack eight frames of the two channels, then swap the middle lanes
+                const float* left_buffer = src_buffers[0];
+                const float* right_buffer = src_buffers[1];
+
+                for (uint32 i = 0; i < frames; i += 8)
+                {
+                    const __m256 vleft = _mm256_loadu_ps(left_buffer + i);
+                    const __m256 vright = _mm256_loadu_ps(right_buffer + i);
+                    const __m256 vlo = _mm256_unpacklo_ps(vleft, vright);
+                    const __m256 vhi = _mm256_unpackhi_ps(vleft, vright);
+
+                    _mm256_storeu_ps(dst_buffer + i * 2, _mm256_permute2f128_ps(vlo, vhi, 0x20));
+                    _mm256_storeu_ps(dst_buffer + i * 2 + 8, _mm256_permute2f128_ps(vlo, vhi, 0x31));
+                }
+            }
+            else
+            {
+                // Transpose eight frames of four channels at a time, each
+                // lane holding one frame of the group
+                for (uint32 c = 0; c < channels; c += 4)
+                {
+                    const float* src0 = src_buffers[c];
+                    const float* src1 = src_buffers[c + 1];
+                    const float* src2 = src_buffers[c + 2];
+                    const float* src3 = src_buffers[c + 3];
+                    float* dst = dst_buffer + c;
+
+                    for (uint32 i = 0; i < frames; i += 8)
+                    {
+                        __m256 v0 = _mm256_loadu_ps(src0 + i);
+                        __m256 v1 = _mm256_loadu_ps(src1 + i);
+                        __m256 v2 = _mm256_loadu_ps(src2 + i);
+                        __m256 v3 = _mm256_loadu_ps(src3 + i);
+
+                        transpose_lanes_ps(v0, v1, v2, v3);
+
+                        _mm_storeu_ps(dst + i * channels, _mm256_castps256_ps128(v0));
+                        _mm_storeu_ps(dst + (i + 1) * channels, _mm256_castps256_ps128(v1));
+                        _mm_storeu_ps(dst + (i + 2) * channels, _mm256_castps256_ps128(v2));
+                        _mm_storeu_ps(dst + (i + 3) * channels, _mm256_castps256_ps128(v3));
+                        _mm_storeu_ps(dst + (i + 4) * channels, _mm256_extractf128_ps(v0, 1));
+                        _mm_storeu_ps(dst + (i + 5) * channels, _mm256_extractf128_ps(v1, 1));
+                        _mm_storeu_ps(dst + (i + 6) * channels, _mm256_extractf128_ps(v2, 1));
+                        _mm_storeu_ps(dst + (i + 7) * channels, _mm256_extractf128_ps(v3, 1));
+                    }
+                }
+            }
+
+            // Handle the leftover frames
+            interleave_generic(src_buffers, dst_buffer, channels, 0, channels, frames, size);
+        }
+    }
+
+    void interleave_buffers_double(
+        double** src_buffers,
+        double* dst_buffer,
+        uint32 channels,
+        uint32 size) const
+    {
+        if (size < AVX_MIN_SAMPLES || (channels != 2 && (channels & 3) != 0))
+        {
+            math_sse42::interleave_buffers_double(src_buffers, dst_buffer, channels, size);
+        }
+        else
+        {
+            const uint32 frames = size & ~3;
+
+            if (channels == 2)
+            {
+                // Unpack four frames of the two channels, then swap the middle lanes
+                const double* left_buffer = src_buffers[0];
+                const double* right_buffer = src_buffers[1];
+
+                for (uint32 i = 0; i < frames; i += 4)
+                {
+                    const __m256d vleft = _mm256_loadu_pd(left_buffer + i);
+                    const __m256d vright = _mm256_loadu_pd(right_buffer + i);
+                    const __m256d vlo = _mm256_unpacklo_pd(vleft, vright);
+                    const __m256d vhi = _mm256_unpackhi_pd(vleft, vright);
+
+                    _mm256_storeu_pd(dst_buffer + i * 2, _mm256_permute2f128_pd(vlo, vhi, 0x20));
+                    _mm256_storeu_pd(dst_buffer + i * 2 + 4, _mm256_permute2f128_pd(vlo, vhi, 0x31));
+                }
+            }
+            else
+            {
+                // Transpose four frames of four channels at a time
+                for (uint32 c = 0; c < channels; c += 4)
+                {
+                    const double* src0 = src_buffers[c];
+                    const double* src1 = src_buffers[c + 1];
+                    const double* src2 = src_buffers[c + 2];
+                    const double* src3 = src_buffers[c + 3];
+                    double* dst = dst_buffer + c;
+
+                    for (uint32 i = 0; i < frames; i += 4)
+                    {
+                        __m256d v0 = _mm256_loadu_pd(src0 + i);
+                        __m256d v1 = _mm256_loadu_pd(src1 + i);
+                        __m256d v2 = _mm256_loadu_pd(src2 + i);
+                        __m256d v3 = _mm256_loadu_pd(src3 + i);
+
+                        transpose_pd(v0, v1, v2, v3);
+
+                        _mm256_storeu_pd(dst + i * channels, v0);
+                        _mm256_storeu_pd(dst + (i + 1) * channels, v1);
+                        _mm256_storeu_pd(dst + (i + 2) * channels, v2);
+                        _mm256_storeu_pd(dst + (i + 3) * channels, v3);
+                    }
+                }
+            }
+
+            // Handle the leftover frames
+            interleave_generic(src_buffers, dst_buffer, channels, 0, channels, frames, size);
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void deinterleave_buffer_float(
+        float* src_buffer,
+        float** dst_buffers,
+        uint32 channels,
+        uint32 size) const
+    {
+        if (size < AVX_MIN_SAMPLES || (channels != 2 && (channels & 3) != 0))
+        {
+            math_sse42::deinterleave_buffer_float(src_buffer, dst_buffers, channels, size);
+        }
+        else
+        {
+            const uint32 frames = size & ~7;
+
+            if (channels == 2)
+            {
+                // Swap the middle lanes of eight frames, then shuffle even and odd samples apart
+                float* left_buffer = dst_buffers[0];
+                float* right_buffer = dst_buffers[1];
+
+                for (uint32 i = 0; i < frames; i += 8)
+                {
+                    const __m256 va = _mm256_loadu_ps(src_buffer + i * 2);
+                    const __m256 vb = _mm256_loadu_ps(src_buffer + i * 2 + 8);
+                    const __m256 vlo = _mm256_permute2f128_ps(va, vb, 0x20);
+                    const __m256 vhi = _mm256_permute2f128_ps(va, vb, 0x31);
+
+                    _mm256_storeu_ps(left_buffer + i, _mm256_shuffle_ps(vlo, vhi, _MM_SHUFFLE(2, 0, 2, 0)));
+                    _mm256_storeu_ps(right_buffer + i, _mm256_shuffle_ps(vlo, vhi, _MM_SHUFFLE(3, 1, 3, 1)));
+                }
+            }
+            else
+            {
+                // Transpose eight frames of four channels at a time, each
+                // lane holding one frame of the group
+                for (uint32 c = 0; c < channels; c += 4)
+                {
+                    const float* src = src_buffer + c;
+                    float* dst0 = dst_buffers[c];
+                    float* dst1 = dst_buffers[c + 1];
+                    float* dst2 = dst_buffers[c + 2];
+                    float* dst3 = dst_buffers[c + 3];
+
+                    for (uint32 i = 0; i < frames; i += 8)
+                    {
+                        __m256 v0 = load_lanes_ps(src + i * channels, src + (i + 4) * channels);
+                        __m256 v1 = load_lanes_ps(src + (i + 1) * channels, src + (i + 5) * channels);
+                        __m256 v2 = load_lanes_ps(src + (i + 2) * channels, src + (i + 6) * channels);
+                        __m256 v3 = load_lanes_ps(src + (i + 3) * channels, src + (i + 7) * channels);
+
+                        transpose_lanes_ps(v0, v1, v2, v3);
+
+                        _mm256_storeu_ps(dst0 + i, v0);
+                        _mm256_storeu_ps(dst1 + i, v1);
+                        _mm256_storeu_ps(dst2 + i, v2);
+                        _mm256_storeu_ps(dst3 + i, v3);
+                    }
+                }
+            }
+
+            // Handle the leftover frames
+            deinterleave_generic(src_buffer, dst_buffers, channels, 0, channels, frames, size);
+        }
+    }
+
+    void deinterleave_buffer_double(
+        double* src_buffer,
+        double** dst_buffers,
+        uint32 channels,
+        uint32 size) const
+    {
+        if (size < AVX_MIN_SAMPLES || (channels != 2 && (channels & 3) != 0))
+        {
+            math_sse42::deinterleave_buffer_double(src_buffer, dst_buffers, channels, size);
+        }
+        else
+        {
+            const uint32 frames = size & ~3;
+
+            if (channels == 2)
+            {
+                // Swap the middle lanes of four frames, then unpack even and odd samples apart
+                double* left_buffer = dst_buffers[0];
+                double* right_buffer = dst_buffers[1];
+
+                for (uint32 i = 0; i < frames; i += 4)
+                {
+                    const __m256d va = _mm256_loadu_pd(src_buffer + i * 2);
+                    const __m256d vb = _mm256_loadu_pd(src_buffer + i * 2 + 4);
+                    const __m256d vlo = _mm256_permute2f128_pd(va, vb, 0x20);
+                    const __m256d vhi = _mm256_permute2f128_pd(va, vb, 0x31);
+
+                    _mm256_storeu_pd(left_buffer + i, _mm256_unpacklo_pd(vlo, vhi));
+                    _mm256_storeu_pd(right_buffer + i, _mm256_unpackhi_pd(vlo, vhi));
+                }
+            }
+            else
+            {
+                // Transpose four frames of four channels at a time
+                for (uint32 c = 0; c < channels; c += 4)
+                {
+                    const double* src = src_buffer + c;
+                    double* dst0 = dst_buffers[c];
+                    double* dst1 = dst_buffers[c + 1];
+                    double* dst2 = dst_buffers[c + 2];
+                    double* dst3 = dst_buffers[c + 3];
+
+                    for (uint32 i = 0; i < frames; i += 4)
+                    {
+                        __m256d v0 = _mm256_loadu_pd(src + i * channels);
+                        __m256d v1 = _mm256_loadu_pd(src + (i + 1) * channels);
+                        __m256d v2 = _mm256_loadu_pd(src + (i + 2) * channels);
+                        __m256d v3 = _mm256_loadu_pd(src + (i + 3) * channels);
+
+                        transpose_pd(v0, v1, v2, v3);
+
+                        _mm256_storeu_pd(dst0 + i, v0);
+                        _mm256_storeu_pd(dst1 + i, v1);
+                        _mm256_storeu_pd(dst2 + i, v2);
+                        _mm256_storeu_pd(dst3 + i, v3);
+                    }
+                }
+            }
+
+            // Handle the leftover frames
+            deinterleave_generic(src_buffer, dst_buffers, channels, 0, channels, frames, size);
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    #define math_avx_biquad_bank_impl(datatype, vector_type, vector_loadu, vector_storeu, vector_mul, vector_add, vector_sub) \
+        void process_biquad_bank_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 channels, \
+            uint32 frames, \
+            datatype* coefficients, \
+            datatype* state, \
+            uint32 sections) const \
+        { \
+            const uint32 vector_size = 32 / sizeof(datatype); \
+            \
+            if (channels < vector_size) \
+            { \
+                math_sse42::process_biquad_bank_ ##datatype (src_buffer, dst_buffer, channels, frames, \
+                    coefficients, state, sections); \
+            } \
+            else \
+            { \
+                const disable_sse_denormals disable_denormals; \
+                \
+                /* Every lane runs the cascade of one channel, the groups are \
+                   walked each frame so their recurrences overlap */ \
+                const uint32 vector_channels = channels - channels % vector_size; \
+                \
+                for (uint32 frame = 0; frame < frames; ++frame) \
+                { \
+                    const datatype* src = src_buffer + frame * channels; \
+                    datatype* dst = dst_buffer + frame * channels; \
+                    \
+                    for (uint32 c = 0; c < vector_channels; c += vector_size) \
+                    { \
+                        const datatype* coefficient = coefficients + c; \
+                        datatype* z = state + c; \
+                        vector_type value = vector_loadu(src + c); \
+                        \
+                        for (uint32 section = 0; section < sections; ++section) \
+                        { \
+                            const vector_type output = vector_add(vector_mul(vector_loadu(coefficient), value), \
+                                vector_loadu(z)); \
+                            \
+                            vector_storeu(z, vector_add(vector_sub( \
+                                vector_mul(vector_loadu(coefficient + channels), value), \
+                                vector_mul(vector_loadu(coefficient + 3 * channels), output)), \
+                                vector_loadu(z + channels))); \
+                            vector_storeu(z + channels, vector_sub( \
+                                vector_mul(vector_loadu(coefficient + 2 * channels), value), \
+                                vector_mul(vector_loadu(coefficient + 4 * channels), output))); \
+                            value = output; \
+                            \
+                            coefficient += 5 * channels; \
+                            z += 2 * channels; \
+                        } \
+                        \
+                        vector_storeu(dst + c, value); \
+                    } \
+                } \
+                \
+                /* Handle the leftover channels */ \
+                biquad_bank_generic(src_buffer, dst_buffer, channels, frames, \
+                    coefficients, state, sections, vector_channels); \
+            } \
+        }
+
+    math_avx_biquad_bank_impl(float, __m256, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_mul_ps, _mm256_add_ps, _mm256_sub_ps)
+    math_avx_biquad_bank_impl(double, __m256d, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_mul_pd, _mm256_add_pd, _mm256_sub_pd)
+
+
+    //--------------------------------------------------------------------------
+
+    #define math_avx_polyphase_impl(datatype, vector_type, vector_zero, vector_loadu, vector_mul, vector_add, vector_reduce) \
+        void process_polyphase_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype* coefficients, \
+            uint32 taps, \
+            uint32* rows, \
+            uint32* offsets) const \
+        { \
+            const uint32 vector_size = 32 / sizeof(datatype); \
+            \
+            if (taps < vector_size) \
+            { \
+                math_sse42::process_polyphase_ ##datatype (src_buffer, dst_buffer, size, \
+                    coefficients, taps, rows, offsets); \
+            } \
+            else \
+            { \
+                const disable_sse_denormals disable_denormals; \
+                \
+                const uint32 vector_taps = taps - taps % vector_size; \
+                \
+                for (uint32 i = 0; i < size; ++i) \
+                { \
+                    const datatype* src = src_buffer + offsets[i]; \
+                    const datatype* coefficient = coefficients + rows[i] * taps; \
+                    vector_type sum = vector_zero; \
+                    \
+                    for (uint32 k = 0; k < vector_taps; k += vector_size) \
+                    { \
+                        sum = vector_add(sum, vector_mul(vector_loadu(coefficient + k), vector_loadu(src + k))); \
+                    } \
+                    \
+                    /* Handle the leftover taps */ \
+                    dst_buffer[i] = polyphase_row_generic(src, coefficient, vector_taps, taps, vector_reduce(sum)); \
+                } \
+            } \
+        }
+
+    math_avx_polyphase_impl(float, __m256, _mm256_setzero_ps(), _mm256_loadu_ps, _mm256_mul_ps, _mm256_add_ps, reduce_add_ps)
+    math_avx_polyphase_impl(double, __m256d, _mm256_setzero_pd(), _mm256_loadu_pd, _mm256_mul_pd, _mm256_add_pd, reduce_add_pd)
+
+
+    //--------------------------------------------------------------------------
+
+    #define math_avx_envelope_bank_impl(datatype, vector_type, vector_loadu, vector_storeu, vector_add, vector_sub, vector_mul, vector_abs, vector_sqrt, vector_select_greater) \
+        void process_envelope_bank_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 channels, \
+            uint32 frames, \
+            datatype* coefficients, \
+            datatype* state, \
+            EnvelopeModeTypes mode) const \
+        { \
+            const uint32 vector_size = 32 / sizeof(datatype); \
+            \
+            if (channels < vector_size) \
+            { \
+                math_sse42::process_envelope_bank_ ##datatype (src_buffer, dst_buffer, channels, frames, \
+                    coefficients, state, mode); \
+            } \
+            else \
+            { \
+                const disable_sse_denormals disable_denormals; \
+                \
+                /* Every lane follows the envelope of one channel, all the groups of \
+                   channels are walked each frame as the biquad banks do */ \
+                const uint32 vector_channels = channels - channels % vector_size; \
+                \
+                for (uint32 frame = 0; frame < frames; ++frame) \
+                { \
+                    const datatype* src = src_buffer + frame * channels; \
+                    datatype* dst = dst_buffer + frame * channels; \
+                    \
+                    for (uint32 c = 0; c < vector_channels; c += vector_size) \
+                    { \
+                        const vector_type value = vector_loadu(src + c); \
+                        const vector_type level = mode == RMS_ENVELOPE ? vector_mul(value, value) : vector_abs(value); \
+                        vector_type envelope = vector_loadu(state + c); \
+                        \
+                        const vector_type coefficient = vector_select_greater(level, envelope, \
+                            vector_loadu(coefficients + c), vector_loadu(coefficients + channels + c)); \
+                        \
+                        envelope = vector_add(envelope, vector_mul(coefficient, vector_sub(level, envelope))); \
+                        \
+                        vector_storeu(state + c, envelope); \
+                        vector_storeu(dst + c, mode == RMS_ENVELOPE ? vector_sqrt(envelope) : envelope); \
+                    } \
+                } \
+                \
+                /* Handle the leftover channels */ \
+                envelope_bank_generic(src_buffer, dst_buffer, channels, frames, \
+                    coefficients, state, mode, vector_channels); \
+            } \
+        }
+
+    #define math_avx_gain_functions_impl(datatype, vector_type, vector_set, vector_loadu, vector_storeu, vector_add, vector_sub, vector_mul, vector_div, vector_min, vector_max) \
+        void compressor_gain_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype threshold, \
+            datatype ratio, \
+            datatype knee) const \
+        { \
+            const uint32 vector_size = 32 / sizeof(datatype); \
+            \
+            assert(ratio > datatype(0)); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const datatype width = knee > datatype(0) ? knee : datatype(0); \
+            const vector_type vthreshold = vector_set(threshold); \
+            const vector_type vslope = vector_set(datatype(1) / ratio - datatype(1)); \
+            const vector_type vhalf_knee = vector_set(width * datatype(0.5)); \
+            const vector_type vwidth = vector_set(width); \
+            const vector_type vknee_scale = vector_set(knee > datatype(0) ? datatype(1) / (datatype(2) * knee) : datatype(0)); \
+            const vector_type vzero = vector_set(datatype(0)); \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            for (uint32 i = 0; i < vector_samples; i += vector_size) \
+            { \
+                const vector_type over = vector_sub(vector_loadu(src_buffer + i), vthreshold); \
+                const vector_type above = vector_max(vector_sub(over, vhalf_knee), vzero); \
+                const vector_type bent = vector_min(vector_max(vector_add(over, vhalf_knee), vzero), vwidth); \
+                \
+                vector_storeu(dst_buffer + i, vector_mul(vslope, \
+                    vector_add(vector_mul(vector_mul(bent, bent), vknee_scale), above))); \
+            } \
+            \
+            /* Handle the leftovers */ \
+            compressor_gain_generic(src_buffer, dst_buffer, size, threshold, ratio, knee, vector_samples); \
+        } \
+        \
+        void limiter_gain_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype threshold) const \
+        { \
+            const uint32 vector_size = 32 / sizeof(datatype); \
+            \
+            assert(threshold > datatype(0)); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const vector_type vthreshold = vector_set(threshold); \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            for (uint32 i = 0; i < vector_samples; i += vector_size) \
+            { \
+                vector_storeu(dst_buffer + i, vector_div(vthreshold, vector_max(vector_loadu(src_buffer + i), vthreshold))); \
+            } \
+            \
+            /* Handle the leftovers */ \
+            limiter_gain_generic(src_buffer, dst_buffer, size, threshold, vector_samples); \
+        } \
+        \
+        void soft_clip_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            const uint32 vector_size = 32 / sizeof(datatype); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const vector_type vlimit = vector_set(datatype(3)); \
+            const vector_type vnegative_limit = vector_set(datatype(-3)); \
+            const vector_type vnumerator = vector_set(datatype(27)); \
+            const vector_type vdenominator = vector_set(datatype(9)); \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            for (uint32 i = 0; i < vector_samples; i += vector_size) \
+            { \
+                const vector_type value = vector_min(vector_max(vector_loadu(src_buffer + i), vnegative_limit), vlimit); \
+                const vector_type square = vector_mul(value, value); \
+                \
+                vector_storeu(dst_buffer + i, vector_div(vector_mul(value, vector_add(vnumerator, square)), \
+                    vector_add(vnumerator, vector_mul(vdenominator, square)))); \
+            } \
+            \
+            /* Handle the leftovers */ \
+            soft_clip_generic(src_buffer, dst_buffer, size, vector_samples); \
+        }
+
+    math_avx_envelope_bank_impl(float, __m256, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_add_ps, _mm256_sub_ps, _mm256_mul_ps, abs_ps, _mm256_sqrt_ps, select_greater_ps)
+    math_avx_envelope_bank_impl(double, __m256d, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_add_pd, _mm256_sub_pd, _mm256_mul_pd, abs_pd, _mm256_sqrt_pd, select_greater_pd)
+
+    math_avx_gain_functions_impl(float, __m256, _mm256_set1_ps, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_add_ps, _mm256_sub_ps, _mm256_mul_ps, _mm256_div_ps, _mm256_min_ps, _mm256_max_ps)
+    math_avx_gain_functions_impl(double, __m256d, _mm256_set1_pd, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_add_pd, _mm256_sub_pd, _mm256_mul_pd, _mm256_div_pd, _mm256_min_pd, _mm256_max_pd)
+
+
+    //--------------------------------------------------------------------------
+
+    // there are no 256 bit integer instructions before AVX2, so the helpers
+    // build and split the exponents through conversions of whole numbers
+
+    #define math_avx_transcendental_functions_impl(datatype, vector_type, vector_loadu, vector_storeu, vector_exp, vector_log, vector_sincos, vector_tanh, vector_pow) \
+        void exp_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 32 / sizeof(datatype); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_storeu(dst_buffer + i, vector_exp(vector_loadu(src_buffer + i), true)); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_storeu(dst_buffer + i, vector_exp(vector_loadu(src_buffer + i), false)); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            exp_generic(src_buffer, dst_buffer, size, accuracy, vector_samples); \
+        } \
+        \
+        void log_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 32 / sizeof(datatype); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_storeu(dst_buffer + i, vector_log(vector_loadu(src_buffer + i), true)); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_storeu(dst_buffer + i, vector_log(vector_loadu(src_buffer + i), false)); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            log_generic(src_buffer, dst_buffer, size, accuracy, vector_samples); \
+        } \
+        \
+        void sin_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 32 / sizeof(datatype); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_type sin_value, cos_value; \
+                    vector_sincos(vector_loadu(src_buffer + i), sin_value, cos_value, true); \
+                    vector_storeu(dst_buffer + i, sin_value); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_type sin_value, cos_value; \
+                    vector_sincos(vector_loadu(src_buffer + i), sin_value, cos_value, false); \
+                    vector_storeu(dst_buffer + i, sin_value); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            sincos_generic(src_buffer, dst_buffer, (datatype*)0, size, accuracy, vector_samples); \
+        } \
+        \
+        void cos_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 32 / sizeof(datatype); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_type sin_value, cos_value; \
+                    vector_sincos(vector_loadu(src_buffer + i), sin_value, cos_value, true); \
+                    vector_storeu(dst_buffer + i, cos_value); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_type sin_value, cos_value; \
+                    vector_sincos(vector_loadu(src_buffer + i), sin_value, cos_value, false); \
+                    vector_storeu(dst_buffer + i, cos_value); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            sincos_generic(src_buffer, (datatype*)0, dst_buffer, size, accuracy, vector_samples); \
+        } \
+        \
+        void sincos_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* sin_buffer, \
+            datatype* cos_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 32 / sizeof(datatype); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_type sin_value, cos_value; \
+                    vector_sincos(vector_loadu(src_buffer + i), sin_value, cos_value, true); \
+                    vector_storeu(sin_buffer + i, sin_value); \
+                    vector_storeu(cos_buffer + i, cos_value); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_type sin_value, cos_value; \
+                    vector_sincos(vector_loadu(src_buffer + i), sin_value, cos_value, false); \
+                    vector_storeu(sin_buffer + i, sin_value); \
+                    vector_storeu(cos_buffer + i, cos_value); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            sincos_generic(src_buffer, sin_buffer, cos_buffer, size, accuracy, vector_samples); \
+        } \
+        \
+        void tanh_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 32 / sizeof(datatype); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_storeu(dst_buffer + i, vector_tanh(vector_loadu(src_buffer + i), true)); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_storeu(dst_buffer + i, vector_tanh(vector_loadu(src_buffer + i), false)); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            tanh_generic(src_buffer, dst_buffer, size, accuracy, vector_samples); \
+        } \
+        \
+        void pow_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* exponent_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 32 / sizeof(datatype); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_storeu(dst_buffer + i, vector_pow(vector_loadu(src_buffer + i), \
+                        vector_loadu(exponent_buffer + i), true)); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_storeu(dst_buffer + i, vector_pow(vector_loadu(src_buffer + i), \
+                        vector_loadu(exponent_buffer + i), false)); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            pow_generic(src_buffer, exponent_buffer, dst_buffer, size, accuracy, vector_samples); \
+        }
+
+    math_avx_transcendental_functions_impl(float, __m256, _mm256_loadu_ps, _mm256_storeu_ps, exp_ps, log_ps, sincos_ps, tanh_ps, pow_ps)
+    math_avx_transcendental_functions_impl(double, __m256d, _mm256_loadu_pd, _mm256_storeu_pd, exp_pd, log_pd, sincos_pd, tanh_pd, pow_pd)
+
+
+    //--------------------------------------------------------------------------
+
+    void premultiply_rgba_float(
+        float* src_buffer,
+        float* dst_buffer,
+        uint32 pixels) const
+    {
+        const disable_sse_denormals disable_denormals;
+
+        // Two pixels per register, alpha lanes are blended back
+        const uint32 vector_pixels = pixels & ~1;
+        for (uint32 i = 0; i < vector_pixels; i += 2)
+        {
+            const __m256 pixel = _mm256_loadu_ps(src_buffer + i * 4);
+
+            _mm256_storeu_ps(dst_buffer + i * 4, _mm256_blend_ps(_mm256_mul_ps(pixel, alpha_ps(pixel)), pixel, 0x88));
+        }
+
+        // Handle the leftovers
+        premultiply_rgba_generic(src_buffer, dst_buffer, pixels, vector_pixels);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void unpremultiply_rgba_float(
+        float* src_buffer,
+        float* dst_buffer,
+        uint32 pixels) const
+    {
+        const disable_sse_denormals disable_denormals;
+
+        const __m256 vzero = _mm256_setzero_ps();
+        const __m256 vone = _mm256_set1_ps(1.0f);
+
+        const uint32 vector_pixels = pixels & ~1;
+        for (uint32 i = 0; i < vector_pixels; i += 2)
+        {
+            const __m256 pixel = _mm256_loadu_ps(src_buffer + i * 4);
+            const __m256 alpha = alpha_ps(pixel);
+
+            // Transparent pixels divide by one and are cleared after
+            const __m256 opaque = _mm256_cmp_ps(alpha, vzero, _CMP_NEQ_UQ);
+            const __m256 colour = _mm256_and_ps(opaque, _mm256_div_ps(pixel, _mm256_blendv_ps(vone, alpha, opaque)));
+
+            _mm256_storeu_ps(dst_buffer + i * 4, _mm256_blend_ps(colour, pixel, 0x88));
+        }
+
+        // Handle the leftovers
+        unpremultiply_rgba_generic(src_buffer, dst_buffer, pixels, vector_pixels);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // the pixels of the source and backdrop two at a time into the composited
+    // expression
+    #define math_avx_composite_loop(expression) \
+        for (uint32 i = 0; i < vector_pixels; i += 2) \
+        { \
+            const __m256 s = _mm256_loadu_ps(src_buffer + i * 4); \
+            const __m256 d = _mm256_loadu_ps(backdrop_buffer + i * 4); \
+            \
+            _mm256_storeu_ps(dst_buffer + i * 4, expression); \
+        }
+
+    void composite_rgba_float(
+        float* src_buffer,
+        float* backdrop_buffer,
+        float* dst_buffer,
+        uint32 pixels,
+        CompositeModeTypes mode) const
+    {
+        const disable_sse_denormals disable_denormals;
+
+        const __m256 vone = _mm256_set1_ps(1.0f);
+        const __m256 vtwo = _mm256_set1_ps(2.0f);
+
+        const uint32 vector_pixels = pixels & ~1;
+        switch (mode)
+        {
+        case MULTIPLY_COMPOSITE:
+            math_avx_composite_loop(multiply_pixel_ps(s, d, alpha_ps(s), alpha_ps(d), vone))
+            break;
+
+        case SCREEN_COMPOSITE:
+            math_avx_composite_loop(screen_pixel_ps(s, d))
+            break;
+
+        case OVERLAY_COMPOSITE:
+            math_avx_composite_loop(overlay_pixel_ps(s, d, alpha_ps(s), alpha_ps(d), vone, vtwo))
+            break;
+
+        case ADD_COMPOSITE:
+            math_avx_composite_loop(_mm256_min_ps(_mm256_add_ps(s, d), vone))
+            break;
+
+        default:
+        {
+            const uint32 source = porter_duff_factor(mode, true);
+            const uint32 backdrop = porter_duff_factor(mode, false);
+            const __m256 source_offset = _mm256_set1_ps(pixel_factor_offset(source));
+            const __m256 source_scale = _mm256_set1_ps(pixel_factor_scale(source));
+            const __m256 backdrop_offset = _mm256_set1_ps(pixel_factor_offset(backdrop));
+            const __m256 backdrop_scale = _mm256_set1_ps(pixel_factor_scale(backdrop));
+
+            math_avx_composite_loop(_mm256_add_ps(
+                _mm256_mul_ps(s, _mm256_add_ps(source_offset, _mm256_mul_ps(source_scale, alpha_ps(d)))),
+                _mm256_mul_ps(d, _mm256_add_ps(backdrop_offset, _mm256_mul_ps(backdrop_scale, alpha_ps(s))))))
+            break;
+        }
+        }
+
+        // Handle the leftovers
+        composite_rgba_generic(src_buffer, backdrop_buffer, dst_buffer, pixels, mode, vector_pixels);
+    }
+
+
+protected:
+
+    //--------------------------------------------------------------------------
+
+    math_avx_mixing_kernels_impl(float, __m256, _mm256_set1_ps, _mm256_loadu_ps, _mm256_mul_ps, _mm256_add_ps)
+    math_avx_mixing_kernels_impl(double, __m256d, _mm256_set1_pd, _mm256_loadu_pd, _mm256_mul_pd, _mm256_add_pd)
+
+
+    //--------------------------------------------------------------------------
+
+    #define math_avx_fft_radix4_pass_impl(datatype, vector_type, vector_loadu, vector_storeu, vector_mul, vector_add, vector_sub) \
+        void fft_radix4_pass_ ##datatype ( \
+            datatype* real_buffer, \
+            datatype* imag_buffer, \
+            uint32 size, \
+            uint32 span, \
+            const datatype* twiddles) const \
+        { \
+            const uint32 vector_size = 32 / sizeof(datatype); \
+            \
+            if (span < vector_size) \
+            { \
+                math_sse42::fft_radix4_pass_ ##datatype (real_buffer, imag_buffer, size, span, twiddles); \
+            } \
+            else \
+            { \
+                const disable_sse_denormals disable_denormals; \
+                \
+                for (uint32 group = 0; group < size; group += 4 * span) \
+                { \
+                    datatype* real = real_buffer + group; \
+                    datatype* imag = imag_buffer + group; \
+                    \
+                    for (uint32 k = 0; k < span; k += vector_size) \
+                    { \
+                        const vector_type w1_real = vector_loadu(twiddles + k); \
+                        const vector_type w1_imag = vector_loadu(twiddles + span + k); \
+                        const vector_type w2_real = vector_loadu(twiddles + 2 * span + k); \
+                        const vector_type w2_imag = vector_loadu(twiddles + 3 * span + k); \
+                        const vector_type w3_real = vector_loadu(twiddles + 4 * span + k); \
+                        const vector_type w3_imag = vector_loadu(twiddles + 5 * span + k); \
+                        \
+                        const vector_type a_real = vector_loadu(real + k); \
+                        const vector_type a_imag = vector_loadu(imag + k); \
+                        const vector_type x1_real = vector_loadu(real + span + k); \
+                        const vector_type x1_imag = vector_loadu(imag + span + k); \
+                        const vector_type x2_real = vector_loadu(real + 2 * span + k); \
+                        const vector_type x2_imag = vector_loadu(imag + 2 * span + k); \
+                        const vector_type x3_real = vector_loadu(real + 3 * span + k); \
+                        const vector_type x3_imag = vector_loadu(imag + 3 * span + k); \
+                        \
+                        const vector_type b_real = vector_sub(vector_mul(x1_real, w2_real), vector_mul(x1_imag, w2_imag)); \
+                        const vector_type b_imag = vector_add(vector_mul(x1_real, w2_imag), vector_mul(x1_imag, w2_real)); \
+                        const vector_type c_real = vector_sub(vector_mul(x2_real, w1_real), vector_mul(x2_imag, w1_imag)); \
+                        const vector_type c_imag = vector_add(vector_mul(x2_real, w1_imag), vector_mul(x2_imag, w1_real)); \
+                        const vector_type d_real = vector_sub(vector_mul(x3_real, w3_real), vector_mul(x3_imag, w3_imag)); \
+                        const vector_type d_imag = vector_add(vector_mul(x3_real, w3_imag), vector_mul(x3_imag, w3_real)); \
+                        \
+                        const vector_type t0_real = vector_add(a_real, b_real); \
+                        const vector_type t0_imag = vector_add(a_imag, b_imag); \
+                        const vector_type t1_real = vector_sub(a_real, b_real); \
+                        const vector_type t1_imag = vector_sub(a_imag, b_imag); \
+                        const vector_type t2_real = vector_add(c_real, d_real); \
+                        const vector_type t2_imag = vector_add(c_imag, d_imag); \
+                        const vector_type t3_real = vector_sub(c_real, d_real); \
+                        const vector_type t3_imag = vector_sub(c_imag, d_imag); \
+                        \
+                        vector_storeu(real + k, vector_add(t0_real, t2_real)); \
+                        vector_storeu(imag + k, vector_add(t0_imag, t2_imag)); \
+                        vector_storeu(real + span + k, vector_add(t1_real, t3_imag)); \
+                        vector_storeu(imag + span + k, vector_sub(t1_imag, t3_real)); \
+                        vector_storeu(real + 2 * span + k, vector_sub(t0_real, t2_real)); \
+                        vector_storeu(imag + 2 * span + k, vector_sub(t0_imag, t2_imag)); \
+                        vector_storeu(real + 3 * span + k, vector_sub(t1_real, t3_imag)); \
+                        vector_storeu(imag + 3 * span + k, vector_add(t1_imag, t3_real)); \
+                    } \
+                } \
+            } \
+        }
+
+    math_avx_fft_radix4_pass_impl(float, __m256, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_mul_ps, _mm256_add_ps, _mm256_sub_ps)
+    math_avx_fft_radix4_pass_impl(double, __m256d, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_mul_pd, _mm256_add_pd, _mm256_sub_pd)
+
+
+    //--------------------------------------------------------------------------
+
+    void convolve_row_float(
+        float* src_buffer,
+        float* dst_buffer,
+        uint32 width,
+        float* kernel,
+        uint32 kernel_size) const
+    {
+        // the pixels from center to end have their whole window in the row
+        const uint32 center = kernel_size / 2;
+        const uint32 end = width + center + 1 > kernel_size ? width + center + 1 - kernel_size : 0;
+
+        if (end < center + 8)
+        {
+            math_sse42::convolve_row_float(src_buffer, dst_buffer, width, kernel, kernel_size);
+            return;
+        }
+
+        const disable_sse_denormals disable_denormals;
+
+        convolve_row_generic(src_buffer, dst_buffer, width, kernel, kernel_size, 0, center);
+
+        uint32 i = center;
+        for (; i + 32 <= end; i += 32)
+        {
+            const float* window = src_buffer + i - center;
+            __m256 sum0 = _mm256_setzero_ps();
+            __m256 sum1 = _mm256_setzero_ps();
+            __m256 sum2 = _mm256_setzero_ps();
+            __m256 sum3 = _mm256_setzero_ps();
+
+            for (uint32 k = 0; k < kernel_size; ++k)
+            {
+                const __m256 coefficient = _mm256_set1_ps(kernel[k]);
+
+                sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(coefficient, _mm256_loadu_ps(window + k)));
+                sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(coefficient, _mm256_loadu_ps(window + k + 8)));
+                sum2 = _mm256_add_ps(sum2, _mm256_mul_ps(coefficient, _mm256_loadu_ps(window + k + 16)));
+                sum3 = _mm256_add_ps(sum3, _mm256_mul_ps(coefficient, _mm256_loadu_ps(window + k + 24)));
+            }
+
+            _mm256_storeu_ps(dst_buffer + i, sum0);
+            _mm256_storeu_ps(dst_buffer + i + 8, sum1);
+            _mm256_storeu_ps(dst_buffer + i + 16, sum2);
+            _mm256_storeu_ps(dst_buffer + i + 24, sum3);
+        }
+
+        for (; i + 8 <= end; i += 8)
+        {
+            const float* window = src_buffer + i - center;
+            __m256 sum = _mm256_setzero_ps();
+
+            for (uint32 k = 0; k < kernel_size; ++k)
+                sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(kernel[k]), _mm256_loadu_ps(window + k)));
+
+            _mm256_storeu_ps(dst_buffer + i, sum);
+        }
+
+        // Handle the right edge and the leftover pixels
+        convolve_row_generic(src_buffer, dst_buffer, width, kernel, kernel_size, i, width);
+    }
+
+    //--------------------------------------------------------------------------
+
+    void convolve_column_tile_float(
+        float* src_buffer,
+        uint32 src_stride,
+        float* dst_buffer,
+        uint32 dst_stride,
+        uint32 columns,
+        uint32 height,
+        float* kernel,
+        uint32 kernel_size) const
+    {
+        const disable_sse_denormals disable_denormals;
+
+        const int32 center = int32(kernel_size / 2);
+        const uint32 vector_columns = columns & ~7;
+
+        for (uint32 row = 0; row < height; ++row)
+        {
+            float* dst_row = dst_buffer + row * dst_stride;
+
+            uint32 i = 0;
+            for (; i + 32 <= vector_columns; i += 32)
+            {
+                __m256 sum0 = _mm256_setzero_ps();
+                __m256 sum1 = _mm256_setzero_ps();
+                __m256 sum2 = _mm256_setzero_ps();
+                __m256 sum3 = _mm256_setzero_ps();
+
+                for (uint32 k = 0; k < kernel_size; ++k)
+                {
+                    const float* src_row = image_row(src_buffer, src_stride, int32(row + k) - center, height) + i;
+                    const __m256 coefficient = _mm256_set1_ps(kernel[k]);
+
+                    sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(coefficient, _mm256_loadu_ps(src_row)));
+                    sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(coefficient, _mm256_loadu_ps(src_row + 8)));
+                    sum2 = _mm256_add_ps(sum2, _mm256_mul_ps(coefficient, _mm256_loadu_ps(src_row + 16)));
+                    sum3 = _mm256_add_ps(sum3, _mm256_mul_ps(coefficient, _mm256_loadu_ps(src_row + 24)));
+                }
+
+                _mm256_storeu_ps(dst_row + i, sum0);
+                _mm256_storeu_ps(dst_row + i + 8, sum1);
+                _mm256_storeu_ps(dst_row + i + 16, sum2);
+                _mm256_storeu_ps(dst_row + i + 24, sum3);
+            }
+
+            for (; i < vector_columns; i += 8)
+            {
+                __m256 sum = _mm256_setzero_ps();
+
+                for (uint32 k = 0; k < kernel_size; ++k)
+                {
+                    const float* src_row = image_row(src_buffer, src_stride, int32(row + k) - center, height) + i;
+
+                    sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(kernel[k]), _mm256_loadu_ps(src_row)));
+                }
+
+                _mm256_storeu_ps(dst_row + i, sum);
+            }
+        }
+
+        // Handle the leftover columns
+        math_sse42::convolve_column_tile_float(src_buffer + vector_columns, src_stride,
+            dst_buffer + vector_columns, dst_stride, columns - vector_columns, height, kernel, kernel_size);
+    }
+
+    //--------------------------------------------------------------------------
+
+    void box_blur_row_float(
+        float* src_buffer,
+        float* dst_buffer,
+        uint32 width,
+        uint32 radius) const
+    {
+        // the running sum of the pixels from begin to end adds and removes
+        // pixels inside the row, a register of them is one prefix sum of the
+        // differences
+        const uint32 begin = radius + 1;
+        const uint32 end = width > radius ? width - radius : 0;
+
+        if (end < begin + 8)
+        {
+            math_sse42::box_blur_row_float(src_buffer, dst_buffer, width, radius);
+            return;
+        }
+
+        const disable_sse_denormals disable_denormals;
+
+        box_blur_row_generic(src_buffer, dst_buffer, width, radius, 0, begin);
+
+        const __m256 scale = _mm256_set1_ps(1.0f / float(2 * radius + 1));
+        __m256 sum = _mm256_set1_ps(box_window_sum(src_buffer, width, radius, radius));
+
+        uint32 i = begin;
+        for (; i + 8 <= end; i += 8)
+        {
+            const __m256 delta = _mm256_sub_ps(_mm256_loadu_ps(src_buffer + i + radius),
+                _mm256_loadu_ps(src_buffer + i - radius - 1));
+
+            sum = _mm256_add_ps(sum, prefix_sum_ps(delta));
+            _mm256_storeu_ps(dst_buffer + i, _mm256_mul_ps(sum, scale));
+            sum = broadcast_last_ps(sum);
+        }
+
+        // Handle the right edge and the leftover pixels
+        box_blur_row_generic(src_buffer, dst_buffer, width, radius, i, width);
+    }
+
+    //--------------------------------------------------------------------------
+
+    void box_blur_column_tile_float(
+        float* src_buffer,
+        uint32 src_stride,
+        float* dst_buffer,
+        uint32 dst_stride,
+        uint32 columns,
+        uint32 height,
+        uint32 radius) const
+    {
+        assert(columns <= image_tile_columns);
+
+        const disable_sse_denormals disable_denormals;
+
+        const __m256 scale = _mm256_set1_ps(1.0f / float(2 * radius + 1));
+        const uint32 vector_columns = columns & ~7;
+        float sums[image_tile_columns];
+
+        for (uint32 i = 0; i < vector_columns; i += 8)
+            _mm256_storeu_ps(sums + i, _mm256_setzero_ps());
+
+        for (int32 k = -int32(radius); k <= int32(radius); ++k)
+        {
+            const float* src_row = image_row(src_buffer, src_stride, k, height);
+
+            for (uint32 i = 0; i < vector_columns; i += 8)
+                _mm256_storeu_ps(sums + i, _mm256_add_ps(_mm256_loadu_ps(sums + i), _mm256_loadu_ps(src_row + i)));
+        }
+
+        for (uint32 row = 0; row < height; ++row)
+        {
+            const float* add_row = image_row(src_buffer, src_stride, int32(row + radius + 1), height);
+            const float* sub_row = image_row(src_buffer, src_stride, int32(row) - int32(radius), height);
+            float* dst_row = dst_buffer + row * dst_stride;
+
+            for (uint32 i = 0; i < vector_columns; i += 8)
+            {
+                const __m256 sum = _mm256_loadu_ps(sums + i);
+
+                _mm256_storeu_ps(dst_row + i, _mm256_mul_ps(sum, scale));
+                _mm256_storeu_ps(sums + i, _mm256_add_ps(sum,
+                    _mm256_sub_ps(_mm256_loadu_ps(add_row + i), _mm256_loadu_ps(sub_row + i))));
+            }
+        }
+
+        // Handle the leftover columns
+        math_sse42::box_blur_column_tile_float(src_buffer + vector_columns, src_stride,
+            dst_buffer + vector_columns, dst_stride, columns - vector_columns, height, radius);
+    }
+
+    //--------------------------------------------------------------------------
+
+    void resize_row_float(
+        float* src_buffer,
+        float* dst_buffer,
+        uint32 width,
+        uint32 channels,
+        float* coefficients,
+        uint32 taps,
+        uint32* offsets) const
+    {
+        // RGBA pixels fill half a register, they stay on the sse kernel
+        if (channels != 1 || taps < 8)
+        {
+            math_sse42::resize_row_float(src_buffer, dst_buffer, width, channels, coefficients, taps, offsets);
+            return;
+        }
+
+        const disable_sse_denormals disable_denormals;
+
+        const uint32 vector_taps = taps & ~7;
+
+        for (uint32 i = 0; i < width; ++i)
+        {
+            const float* window = src_buffer + offsets[i];
+            const float* coefficient = coefficients + i * taps;
+            __m256 sum = _mm256_setzero_ps();
+
+            for (uint32 k = 0; k < vector_taps; k += 8)
+                sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(coefficient + k), _mm256_loadu_ps(window + k)));
+
+            // Handle the leftover taps
+            dst_buffer[i] = polyphase_row_generic(window, coefficient, vector_taps, taps, reduce_add_ps(sum));
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    void resize_column_tile_float(
+        float* src_buffer,
+        uint32 src_stride,
+        float* dst_buffer,
+        uint32 dst_stride,
+        uint32 columns,
+        uint32 height,
+        float* coefficients,
+        uint32 taps,
+        uint32* offsets) const
+    {
+        const disable_sse_denormals disable_denormals;
+
+        const uint32 vector_columns = columns & ~7;
+
+        for (uint32 row = 0; row < height; ++row)
+        {
+            const float* window = src_buffer + offsets[row] * src_stride;
+            const float* coefficient = coefficients + row * taps;
+            float* dst_row = dst_buffer + row * dst_stride;
+
+            uint32 i = 0;
+            for (; i + 32 <= vector_columns; i += 32)
+            {
+                __m256 sum0 = _mm256_setzero_ps();
+                __m256 sum1 = _mm256_setzero_ps();
+                __m256 sum2 = _mm256_setzero_ps();
+                __m256 sum3 = _mm256_setzero_ps();
+
+                for (uint32 k = 0; k < taps; ++k)
+                {
+                    const float* src_row = window + k * src_stride + i;
+                    const __m256 weight = _mm256_set1_ps(coefficient[k]);
+
+                    sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(weight, _mm256_loadu_ps(src_row)));
+                    sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(weight, _mm256_loadu_ps(src_row + 8)));
+                    sum2 = _mm256_add_ps(sum2, _mm256_mul_ps(weight, _mm256_loadu_ps(src_row + 16)));
+                    sum3 = _mm256_add_ps(sum3, _mm256_mul_ps(weight, _mm256_loadu_ps(src_row + 24)));
+                }
+
+                _mm256_storeu_ps(dst_row + i, sum0);
+                _mm256_storeu_ps(dst_row + i + 8, sum1);
+                _mm256_storeu_ps(dst_row + i + 16, sum2);
+                _mm256_storeu_ps(dst_row + i + 24, sum3);
+            }
+
+            for (; i < vector_columns; i += 8)
+            {
+                __m256 sum = _mm256_setzero_ps();
+
+                for (uint32 k = 0; k < taps; ++k)
+                    sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(coefficient[k]), _mm256_loadu_ps(window + k * src_stride + i)));
+
+                _mm256_storeu_ps(dst_row + i, sum);
+            }
+        }
+
+        // Handle the leftover columns
+        math_sse42::resize_column_tile_float(src_buffer + vector_columns, src_stride,
+            dst_buffer + vector_columns, dst_stride, columns - vector_columns, height, coefficients, taps, offsets);
+    }
+
+    //--------------------------------------------------------------------------
+
+    void resize_column_tile_uint8(
+        float* src_buffer,
+        uint32 src_stride,
+        uint8* dst_buffer,
+        uint32 dst_stride,
+        uint32 columns,
+        uint32 height,
+        float* coefficients,
+        uint32 taps,
+        uint32* offsets) const
+    {
+        const disable_sse_denormals disable_denormals;
+
+        // 32 columns a step, the halves of the converted sums packed by the
+        // sse2 saturating packs
+        const uint32 vector_columns = columns & ~31;
+
+        for (uint32 row = 0; row < height; ++row)
+        {
+            const float* window = src_buffer + offsets[row] * src_stride;
+            const float* coefficient = coefficients + row * taps;
+            uint8* dst_row = dst_buffer + row * dst_stride;
+
+            for (uint32 i = 0; i < vector_columns; i += 32)
+            {
+                __m256 sum[4] = { _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps() };
+
+                for (uint32 k = 0; k < taps; ++k)
+                {
+                    const float* src_row = window + k * src_stride + i;
+                    const __m256 weight = _mm256_set1_ps(coefficient[k]);
+
+                    for (uint32 j = 0; j < 4; ++j)
+                        sum[j] = _mm256_add_ps(sum[j], _mm256_mul_ps(weight, _mm256_loadu_ps(src_row + j * 8)));
+                }
+
+                __m128i values[8];
+                for (uint32 j = 0; j < 4; ++j)
+                {
+                    const __m256i value = _mm256_cvtps_epi32(sum[j]);
+
+                    values[j * 2] = _mm256_castsi256_si128(value);
+                    values[j * 2 + 1] = _mm256_extractf128_si256(value, 1);
+                }
+
+                _mm_storeu_si128((__m128i*)(dst_row + i), pack_epi32_epi8(values));
+                _mm_storeu_si128((__m128i*)(dst_row + i + 16), pack_epi32_epi8(values + 4));
+            }
+        }
+
+        // Handle the leftover columns
+        math_sse42::resize_column_tile_uint8(src_buffer + vector_columns, src_stride,
+            dst_buffer + vector_columns, dst_stride, columns - vector_columns, height, coefficients, taps, offsets);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // transposes the 4x4 blocks held in each 128 bit lane of the vectors
+    static forcedinline void transpose_lanes_ps(__m256& v0, __m256& v1, __m256& v2, __m256& v3)
+    {
+        const __m256 t0 = _mm256_unpacklo_ps(v0, v1);
+        const __m256 t1 = _mm256_unpacklo_ps(v2, v3);
+        const __m256 t2 = _mm256_unpackhi_ps(v0, v1);
+        const __m256 t3 = _mm256_unpackhi_ps(v2, v3);
+
+        v0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+        v1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+        v2 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+        v3 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    }
+
+    static forcedinline __m256 load_lanes_ps(const float* lo, const float* hi)
+    {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(lo)), _mm_loadu_ps(hi), 1);
+    }
+
+    // running sums of the lanes, each one added to all the following ones
+    static forcedinline __m256 prefix_sum_ps(__m256 value)
+    {
+        const __m256 zero = _mm256_setzero_ps();
+
+        value = _mm256_add_ps(value, _mm256_blend_ps(_mm256_permute_ps(value, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x11));
+        value = _mm256_add_ps(value, _mm256_blend_ps(_mm256_permute_ps(value, _MM_SHUFFLE(1, 0, 0, 0)), zero, 0x33));
+
+        const __m256 low_total = _mm256_permute_ps(value, _MM_SHUFFLE(3, 3, 3, 3));
+        return _mm256_add_ps(value, _mm256_permute2f128_ps(low_total, low_total, 0x08));
+    }
+
+    static forcedinline __m256 broadcast_last_ps(__m256 value)
+    {
+        const __m256 last = _mm256_permute_ps(value, _MM_SHUFFLE(3, 3, 3, 3));
+        return _mm256_permute2f128_ps(last, last, 0x11);
+    }
+
+    static forcedinline void transpose_pd(__m256d& v0, __m256d& v1, __m256d& v2, __m256d& v3)
+    {
+        const __m256d t0 = _mm256_unpacklo_pd(v0, v1);
+        const __m256d t1 = _mm256_unpackhi_pd(v0, v1);
+        const __m256d t2 = _mm256_unpacklo_pd(v2, v3);
+        const __m256d t3 = _mm256_unpackhi_pd(v2, v3);
+
+        v0 = _mm256_permute2f128_pd(t0, t2, 0x20);
+        v1 = _mm256_permute2f128_pd(t1, t3, 0x20);
+        v2 = _mm256_permute2f128_pd(t0, t2, 0x31);
+        v3 = _mm256_permute2f128_pd(t1, t3, 0x31);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    template<typename T> static forcedinline T madd_scalar(T a, T b, T c)
+    {
+        return a * b + c;
+    }
+
+    static forcedinline __m256 madd_ps(__m256 a, __m256 b, __m256 c)
+    {
+        return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+    }
+
+    static forcedinline __m256d madd_pd(__m256d a, __m256d b, __m256d c)
+    {
+        return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline void kahan_add_ps(__m256& sum, __m256& compensation, __m256 value)
+    {
+        const __m256 y = _mm256_sub_ps(value, compensation);
+        const __m256 t = _mm256_add_ps(sum, y);
+        compensation = _mm256_sub_ps(_mm256_sub_ps(t, sum), y);
+        sum = t;
+    }
+
+    static forcedinline void kahan_add_pd(__m256d& sum, __m256d& compensation, __m256d value)
+    {
+        const __m256d y = _mm256_sub_pd(value, compensation);
+        const __m256d t = _mm256_add_pd(sum, y);
+        compensation = _mm256_sub_pd(_mm256_sub_pd(t, sum), y);
+        sum = t;
+    }
+
+    static forcedinline void dot_ps(__m256& sum, __m256& compensation, __m256 a, __m256 b)
+    {
+        kahan_add_ps(sum, compensation, _mm256_mul_ps(a, b));
+    }
+
+    static forcedinline void dot_pd(__m256d& sum, __m256d& compensation, __m256d a, __m256d b)
+    {
+        kahan_add_pd(sum, compensation, _mm256_mul_pd(a, b));
+    }
+
+    static forcedinline double reduce_kahan_ps(__m256 sum, __m256 compensation)
+    {
+        float sums[8], compensations[8];
+        _mm256_storeu_ps(sums, sum);
+        _mm256_storeu_ps(compensations, compensation);
+
+        double result = 0.0;
+        for (uint32 i = 0; i < 8; ++i)
+        {
+            result += (double)sums[i] - (double)compensations[i];
+        }
+
+        return result;
+    }
+
+    static forcedinline double reduce_kahan_pd(__m256d sum, __m256d compensation)
+    {
+        double sums[4], compensations[4];
+        _mm256_storeu_pd(sums, sum);
+        _mm256_storeu_pd(compensations, compensation);
+
+        double result = 0.0;
+        for (uint32 i = 0; i < 4; ++i)
+        {
+            result += sums[i] - compensations[i];
+        }
+
+        return result;
+    }
+
+    // folds the halves of the register down to one sum
+    static forcedinline float reduce_add_ps(__m256 sum)
+    {
+        const __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+
+        float lanes[4];
+        _mm_storeu_ps(lanes, half);
+
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+
+    static forcedinline double reduce_add_pd(__m256d sum)
+    {
+        const __m128d half = _mm_add_pd(_mm256_castpd256_pd128(sum), _mm256_extractf128_pd(sum, 1));
+
+        double lanes[2];
+        _mm_storeu_pd(lanes, half);
+
+        return lanes[0] + lanes[1];
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline __m256 peak_ps(__m256 value, __m256 peak)
+    {
+        return _mm256_max_ps(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), value), peak);
+    }
+
+    static forcedinline __m256d peak_pd(__m256d value, __m256d peak)
+    {
+        return _mm256_max_pd(_mm256_andnot_pd(_mm256_set1_pd(-0.0), value), peak);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline __m256 abs_ps(__m256 value)
+    {
+        return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), value);
+    }
+
+    static forcedinline __m256d abs_pd(__m256d value)
+    {
+        return _mm256_andnot_pd(_mm256_set1_pd(-0.0), value);
+    }
+
+    // a > b ? greater : otherwise, lane by lane
+    static forcedinline __m256 select_greater_ps(__m256 a, __m256 b, __m256 greater, __m256 otherwise)
+    {
+        return _mm256_blendv_ps(otherwise, greater, _mm256_cmp_ps(a, b, _CMP_GT_OQ));
+    }
+
+    static forcedinline __m256d select_greater_pd(__m256d a, __m256d b, __m256d greater, __m256d otherwise)
+    {
+        return _mm256_blendv_pd(otherwise, greater, _mm256_cmp_pd(a, b, _CMP_GT_OQ));
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // the alpha of each of the two pixels in all of its lanes
+    static forcedinline __m256 alpha_ps(__m256 pixels)
+    {
+        return _mm256_permute_ps(pixels, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+
+    // the blend modes of the fpu composite_channel on premultiplied pixels
+    static forcedinline __m256 multiply_pixel_ps(__m256 s, __m256 d, __m256 sa, __m256 da, __m256 one)
+    {
+        return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(s, _mm256_sub_ps(one, da)),
+            _mm256_mul_ps(d, _mm256_sub_ps(one, sa))), _mm256_mul_ps(s, d));
+    }
+
+    static forcedinline __m256 screen_pixel_ps(__m256 s, __m256 d)
+    {
+        return _mm256_sub_ps(_mm256_add_ps(s, d), _mm256_mul_ps(s, d));
+    }
+
+    static forcedinline __m256 overlay_pixel_ps(__m256 s, __m256 d, __m256 sa, __m256 da, __m256 one, __m256 two)
+    {
+        const __m256 blend = select_greater_ps(_mm256_mul_ps(two, d), da,
+            _mm256_sub_ps(_mm256_mul_ps(sa, da), _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(da, d)), _mm256_sub_ps(sa, s))),
+            _mm256_mul_ps(_mm256_mul_ps(two, s), d));
+
+        return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(s, _mm256_sub_ps(one, da)),
+            _mm256_mul_ps(d, _mm256_sub_ps(one, sa))), blend);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline __m256 round_ps(__m256 value)
+    {
+        return _mm256_round_ps(value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    }
+
+    static forcedinline __m256d round_pd(__m256d value)
+    {
+        return _mm256_round_pd(value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    }
+
+    // 2^n for the integers n of a normal exponent, the biased exponent is
+    // converted already shifted in place
+    static forcedinline __m256 pow2_ps(__m256 n)
+    {
+        return _mm256_castsi256_ps(_mm256_cvttps_epi32(
+            _mm256_mul_ps(_mm256_add_ps(n, _mm256_set1_ps(127.0f)), _mm256_set1_ps(8388608.0f))));
+    }
+
+    static forcedinline __m256d pow2_pd(__m256d n)
+    {
+        // the shifted exponents go in the high words of the lanes
+        const __m128i exponents = _mm256_cvttpd_epi32(
+            _mm256_mul_pd(_mm256_add_pd(n, _mm256_set1_pd(1023.0)), _mm256_set1_pd(1048576.0)));
+        const __m128i zero = _mm_setzero_si128();
+
+        return _mm256_castsi256_pd(_mm256_insertf128_si256(_mm256_castsi128_si256(
+            _mm_unpacklo_epi32(zero, exponents)), _mm_unpackhi_epi32(zero, exponents), 1));
+    }
+
+    template<uint32 count> static forcedinline __m256 polynomial_ps(__m256 x, const float (&coefficients)[count])
+    {
+        __m256 result = _mm256_set1_ps(coefficients[0]);
+        for (uint32 i = 1; i < count; ++i)
+        {
+            result = _mm256_add_ps(_mm256_mul_ps(result, x), _mm256_set1_ps(coefficients[i]));
+        }
+
+        return result;
+    }
+
+    template<uint32 count> static forcedinline __m256d polynomial_pd(__m256d x, const double (&coefficients)[count])
+    {
+        __m256d result = _mm256_set1_pd(coefficients[0]);
+        for (uint32 i = 1; i < count; ++i)
+        {
+            result = _mm256_add_pd(_mm256_mul_pd(result, x), _mm256_set1_pd(coefficients[i]));
+        }
+
+        return result;
+    }
+
+    // e^r - 1 for |r| <= log(2) / 2
+    static forcedinline __m256 expm1_ps(__m256 r, bool accurate)
+    {
+        const __m256 p = accurate
+            ? polynomial_ps(r, accurate_exp_coefficients_float)
+            : polynomial_ps(r, fast_exp_coefficients_float);
+
+        return _mm256_add_ps(r, _mm256_mul_ps(_mm256_mul_ps(r, r), p));
+    }
+
+    static forcedinline __m256d expm1_pd(__m256d r, bool accurate)
+    {
+        const __m256d p = accurate
+            ? polynomial_pd(r, accurate_exp_coefficients_double)
+            : polynomial_pd(r, fast_exp_coefficients_double);
+
+        return _mm256_add_pd(r, _mm256_mul_pd(_mm256_mul_pd(r, r), p));
+    }
+
+    // the same reductions as exp_scalar, the top of the range needs 2^128 so
+    // the scaling is split in 2^min(n, 127) and the 1 or 2 left
+    static forcedinline __m256 exp_ps(__m256 x, bool accurate)
+    {
+        const __m256 high = _mm256_set1_ps(88.72283172607421875f);
+        const __m256 low = _mm256_set1_ps(-87.33654022216796875f);
+        const __m256 one = _mm256_set1_ps(1.0f);
+
+        const __m256 clamped = _mm256_min_ps(_mm256_max_ps(x, low), high);
+        const __m256 n = round_ps(_mm256_mul_ps(clamped, _mm256_set1_ps(1.44269504088896341f)));
+        const __m256 r = _mm256_sub_ps(_mm256_sub_ps(clamped, _mm256_mul_ps(n, _mm256_set1_ps(0.693359375f))),
+            _mm256_mul_ps(n, _mm256_set1_ps(-2.12194440e-4f)));
+
+        const __m256 normal = _mm256_min_ps(n, _mm256_set1_ps(127.0f));
+        __m256 result = _mm256_mul_ps(_mm256_mul_ps(_mm256_add_ps(expm1_ps(r, accurate), one), pow2_ps(normal)),
+            _mm256_add_ps(one, _mm256_sub_ps(n, normal)));
+
+        result = _mm256_blendv_ps(result, _mm256_set1_ps(std::numeric_limits<float>::infinity()), _mm256_cmp_ps(x, high, _CMP_GT_OQ));
+        result = _mm256_and_ps(_mm256_cmp_ps(x, low, _CMP_NLT_UQ), result);
+
+        return _mm256_blendv_ps(result, x, _mm256_cmp_ps(x, x, _CMP_UNORD_Q));
+    }
+
+    static forcedinline __m256d exp_pd(__m256d x, bool accurate)
+    {
+        const __m256d high = _mm256_set1_pd(709.782712893383);
+        const __m256d low = _mm256_set1_pd(-708.396418532264);
+        const __m256d one = _mm256_set1_pd(1.0);
+
+        const __m256d clamped = _mm256_min_pd(_mm256_max_pd(x, low), high);
+        const __m256d n = round_pd(_mm256_mul_pd(clamped, _mm256_set1_pd(1.4426950408889634074)));
+        const __m256d r = _mm256_sub_pd(_mm256_sub_pd(clamped, _mm256_mul_pd(n, _mm256_set1_pd(6.93147180369123816490e-1))),
+            _mm256_mul_pd(n, _mm256_set1_pd(1.90821492927058770002e-10)));
+
+        const __m256d normal = _mm256_min_pd(n, _mm256_set1_pd(1023.0));
+        __m256d result = _mm256_mul_pd(_mm256_mul_pd(_mm256_add_pd(expm1_pd(r, accurate), one), pow2_pd(normal)),
+            _mm256_add_pd(one, _mm256_sub_pd(n, normal)));
+
+        result = _mm256_blendv_pd(result, _mm256_set1_pd(std::numeric_limits<double>::infinity()), _mm256_cmp_pd(x, high, _CMP_GT_OQ));
+        result = _mm256_and_pd(_mm256_cmp_pd(x, low, _CMP_NLT_UQ), result);
+
+        return _mm256_blendv_pd(result, x, _mm256_cmp_pd(x, x, _CMP_UNORD_Q));
+    }
+
+    // the exponent and mantissa come out of the bits, zero and denormals give
+    // minus infinity and anything not positive a NaN
+    static forcedinline __m256 log_ps(__m256 x, bool accurate)
+    {
+        const __m256 one = _mm256_set1_ps(1.0f);
+
+        const __m256 biased = _mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(0x7f800000)));
+        __m256 e = _mm256_sub_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_castps_si256(biased)),
+            _mm256_set1_ps(1.0f / 8388608.0f)), _mm256_set1_ps(127.0f));
+        __m256 m = _mm256_or_ps(_mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(0x007fffff))), one);
+
+        const __m256 above = _mm256_cmp_ps(m, _mm256_set1_ps(1.41421356237309505f), _CMP_GT_OQ);
+        m = _mm256_blendv_ps(m, _mm256_mul_ps(m, _mm256_set1_ps(0.5f)), above);
+        e = _mm256_add_ps(e, _mm256_and_ps(above, one));
+
+        const __m256 s = _mm256_div_ps(_mm256_sub_ps(m, one), _mm256_add_ps(m, one));
+        const __m256 w = _mm256_mul_ps(s, s);
+        const __m256 q = accurate
+            ? polynomial_ps(w, accurate_log_coefficients_float)
+            : polynomial_ps(w, fast_log_coefficients_float);
+
+        const __m256 log_m = _mm256_add_ps(_mm256_add_ps(s, s), _mm256_mul_ps(_mm256_mul_ps(s, w), q));
+        __m256 result = _mm256_add_ps(_mm256_mul_ps(e, _mm256_set1_ps(0.693359375f)),
+            _mm256_add_ps(log_m, _mm256_mul_ps(e, _mm256_set1_ps(-2.12194440e-4f))));
+
+        result = _mm256_blendv_ps(result, x, _mm256_cmp_ps(x, _mm256_set1_ps(std::numeric_limits<float>::infinity()), _CMP_EQ_OQ));
+        result = _mm256_blendv_ps(result, _mm256_set1_ps(-std::numeric_limits<float>::infinity()), _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_EQ_OQ));
+
+        return _mm256_blendv_ps(result, _mm256_set1_ps(std::numeric_limits<float>::quiet_NaN()), _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_NGE_UQ));
+    }
+
+    static forcedinline __m256d log_pd(__m256d x, bool accurate)
+    {
+        const __m256d one = _mm256_set1_pd(1.0);
+
+        // the biased exponents sit in the high words of the lanes
+        const __m256 biased = _mm256_castpd_ps(_mm256_and_pd(x, _mm256_castsi256_pd(_mm256_set1_epi64x(0x7ff0000000000000LL))));
+        const __m128 words = _mm_shuffle_ps(_mm256_castps256_ps128(biased), _mm256_extractf128_ps(biased, 1), _MM_SHUFFLE(3, 1, 3, 1));
+        __m256d e = _mm256_sub_pd(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm_castps_si128(words)),
+            _mm256_set1_pd(1.0 / 1048576.0)), _mm256_set1_pd(1023.0));
+        __m256d m = _mm256_or_pd(_mm256_and_pd(x, _mm256_castsi256_pd(_mm256_set1_epi64x(0x000fffffffffffffLL))), one);
+
+        const __m256d above = _mm256_cmp_pd(m, _mm256_set1_pd(1.41421356237309504880), _CMP_GT_OQ);
+        m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), above);
+        e = _mm256_add_pd(e, _mm256_and_pd(above, one));
+
+        const __m256d s = _mm256_div_pd(_mm256_sub_pd(m, one), _mm256_add_pd(m, one));
+        const __m256d w = _mm256_mul_pd(s, s);
+        const __m256d q = accurate
+            ? polynomial_pd(w, accurate_log_coefficients_double)
+            : polynomial_pd(w, fast_log_coefficients_double);
+
+        const __m256d log_m = _mm256_add_pd(_mm256_add_pd(s, s), _mm256_mul_pd(_mm256_mul_pd(s, w), q));
+        __m256d result = _mm256_add_pd(_mm256_mul_pd(e, _mm256_set1_pd(6.93147180369123816490e-1)),
+            _mm256_add_pd(log_m, _mm256_mul_pd(e, _mm256_set1_pd(1.90821492927058770002e-10))));
+
+        result = _mm256_blendv_pd(result, x, _mm256_cmp_pd(x, _mm256_set1_pd(std::numeric_limits<double>::infinity()), _CMP_EQ_OQ));
+        result = _mm256_blendv_pd(result, _mm256_set1_pd(-std::numeric_limits<double>::infinity()), _mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_EQ_OQ));
+
+        return _mm256_blendv_pd(result, _mm256_set1_pd(std::numeric_limits<double>::quiet_NaN()), _mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_NGE_UQ));
+    }
+
+    // r = x - j pi / 2 with pi / 2 in four parts, the first three of 33 bits
+    // so their products by j are exact. From 2^30 on r has lost most of its
+    // bits and would grow past the polynomials, so those arguments reduce as
+    // zeros: x - x keeps infinities and NaNs as NaNs
+    static forcedinline __m256d reduce_angle_pd(__m256d x, __m256d& j)
+    {
+        x = _mm256_blendv_pd(x, _mm256_sub_pd(x, x),
+            _mm256_cmp_pd(_mm256_andnot_pd(_mm256_set1_pd(-0.0), x), _mm256_set1_pd(1073741824.0), _CMP_GE_OQ));
+        j = round_pd(_mm256_mul_pd(x, _mm256_set1_pd(6.36619772367581382433e-1)));
+
+        return _mm256_sub_pd(_mm256_sub_pd(_mm256_sub_pd(_mm256_sub_pd(x,
+            _mm256_mul_pd(j, _mm256_set1_pd(1.57079632673412561417))),
+            _mm256_mul_pd(j, _mm256_set1_pd(6.07710050630396597660e-11))),
+            _mm256_mul_pd(j, _mm256_set1_pd(2.02226624871116645580e-21))),
+            _mm256_mul_pd(j, _mm256_set1_pd(8.47842766036889956997e-32)));
+    }
+
+    // the quadrant q = j mod 4 stays in floating point: the odd ones swap the
+    // polynomials, sin is negated in 2 and 3 and cos in 1 and 2. Floats are
+    // reduced in double four at a time, close to the zeros a float pi / 2
+    // loses r
+    static forcedinline void sincos_ps(__m256 x, __m256& sin_value, __m256& cos_value, bool accurate)
+    {
+        __m256d j_lo, j_hi;
+        const __m256 r = _mm256_insertf128_ps(_mm256_castps128_ps256(
+            _mm256_cvtpd_ps(reduce_angle_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(x)), j_lo))),
+            _mm256_cvtpd_ps(reduce_angle_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)), j_hi)), 1);
+        const __m256 j = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(j_lo)), _mm256_cvtpd_ps(j_hi), 1);
+        const __m256 z = _mm256_mul_ps(r, r);
+
+        const __m256 sine = _mm256_add_ps(r, _mm256_mul_ps(_mm256_mul_ps(r, z), accurate
+            ? polynomial_ps(z, accurate_sin_coefficients_float)
+            : polynomial_ps(z, fast_sin_coefficients_float)));
+        const __m256 cosine = _mm256_add_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(z, _mm256_set1_ps(0.5f))),
+            _mm256_mul_ps(_mm256_mul_ps(z, z), accurate
+                ? polynomial_ps(z, accurate_cos_coefficients_float)
+                : polynomial_ps(z, fast_cos_coefficients_float)));
+
+        const __m256 quadrant = _mm256_sub_ps(j, _mm256_mul_ps(_mm256_floor_ps(_mm256_mul_ps(j, _mm256_set1_ps(0.25f))), _mm256_set1_ps(4.0f)));
+        const __m256 odd = _mm256_sub_ps(quadrant, _mm256_mul_ps(_mm256_floor_ps(_mm256_mul_ps(quadrant, _mm256_set1_ps(0.5f))), _mm256_set1_ps(2.0f)));
+        const __m256 swap = _mm256_cmp_ps(odd, _mm256_set1_ps(0.5f), _CMP_GT_OQ);
+        const __m256 sign = _mm256_set1_ps(-0.0f);
+
+        sin_value = _mm256_xor_ps(_mm256_blendv_ps(sine, cosine, swap),
+            _mm256_and_ps(sign, _mm256_cmp_ps(quadrant, _mm256_set1_ps(1.5f), _CMP_GT_OQ)));
+        cos_value = _mm256_xor_ps(_mm256_blendv_ps(cosine, sine, swap),
+            _mm256_and_ps(sign, _mm256_and_ps(_mm256_cmp_ps(quadrant, _mm256_set1_ps(0.5f), _CMP_GT_OQ),
+                _mm256_cmp_ps(quadrant, _mm256_set1_ps(2.5f), _CMP_LT_OQ))));
+    }
+
+    static forcedinline void sincos_pd(__m256d x, __m256d& sin_value, __m256d& cos_value, bool accurate)
+    {
+        __m256d j;
+        const __m256d r = reduce_angle_pd(x, j);
+        const __m256d z = _mm256_mul_pd(r, r);
+
+        const __m256d sine = _mm256_add_pd(r, _mm256_mul_pd(_mm256_mul_pd(r, z), accurate
+            ? polynomial_pd(z, accurate_sin_coefficients_double)
+            : polynomial_pd(z, fast_sin_coefficients_double)));
+        const __m256d cosine = _mm256_add_pd(_mm256_sub_pd(_mm256_set1_pd(1.0), _mm256_mul_pd(z, _mm256_set1_pd(0.5))),
+            _mm256_mul_pd(_mm256_mul_pd(z, z), accurate
+                ? polynomial_pd(z, accurate_cos_coefficients_double)
+                : polynomial_pd(z, fast_cos_coefficients_double)));
+
+        const __m256d quadrant = _mm256_sub_pd(j, _mm256_mul_pd(_mm256_floor_pd(_mm256_mul_pd(j, _mm256_set1_pd(0.25))), _mm256_set1_pd(4.0)));
+        const __m256d odd = _mm256_sub_pd(quadrant, _mm256_mul_pd(_mm256_floor_pd(_mm256_mul_pd(quadrant, _mm256_set1_pd(0.5))), _mm256_set1_pd(2.0)));
+        const __m256d swap = _mm256_cmp_pd(odd, _mm256_set1_pd(0.5), _CMP_GT_OQ);
+        const __m256d sign = _mm256_set1_pd(-0.0);
+
+        sin_value = _mm256_xor_pd(_mm256_blendv_pd(sine, cosine, swap),
+            _mm256_and_pd(sign, _mm256_cmp_pd(quadrant, _mm256_set1_pd(1.5), _CMP_GT_OQ)));
+        cos_value = _mm256_xor_pd(_mm256_blendv_pd(cosine, sine, swap),
+            _mm256_and_pd(sign, _mm256_and_pd(_mm256_cmp_pd(quadrant, _mm256_set1_pd(0.5), _CMP_GT_OQ),
+                _mm256_cmp_pd(quadrant, _mm256_set1_pd(2.5), _CMP_LT_OQ))));
+    }
+
+    // tanh |x| is -u / (2 + u) for u = e^(-2 |x|) - 1, with the sign of x
+    static forcedinline __m256 tanh_ps(__m256 x, bool accurate)
+    {
+        const __m256 sign = _mm256_set1_ps(-0.0f);
+
+        const __m256 a = _mm256_mul_ps(_mm256_min_ps(_mm256_andnot_ps(sign, x), _mm256_set1_ps(9.0f)), _mm256_set1_ps(-2.0f));
+        const __m256 n = round_ps(_mm256_mul_ps(a, _mm256_set1_ps(1.44269504088896341f)));
+        const __m256 r = _mm256_sub_ps(_mm256_sub_ps(a, _mm256_mul_ps(n, _mm256_set1_ps(0.693359375f))),
+            _mm256_mul_ps(n, _mm256_set1_ps(-2.12194440e-4f)));
+
+        const __m256 scale = pow2_ps(n);
+        const __m256 u = _mm256_add_ps(_mm256_mul_ps(scale, expm1_ps(r, accurate)), _mm256_sub_ps(scale, _mm256_set1_ps(1.0f)));
+        const __m256 result = _mm256_or_ps(_mm256_div_ps(_mm256_sub_ps(_mm256_setzero_ps(), u), _mm256_add_ps(_mm256_set1_ps(2.0f), u)),
+            _mm256_and_ps(sign, x));
+
+        return _mm256_blendv_ps(result, x, _mm256_cmp_ps(x, x, _CMP_UNORD_Q));
+    }
+
+    static forcedinline __m256d tanh_pd(__m256d x, bool accurate)
+    {
+        const __m256d sign = _mm256_set1_pd(-0.0);
+
+        const __m256d a = _mm256_mul_pd(_mm256_min_pd(_mm256_andnot_pd(sign, x), _mm256_set1_pd(20.0)), _mm256_set1_pd(-2.0));
+        const __m256d n = round_pd(_mm256_mul_pd(a, _mm256_set1_pd(1.4426950408889634074)));
+        const __m256d r = _mm256_sub_pd(_mm256_sub_pd(a, _mm256_mul_pd(n, _mm256_set1_pd(6.93147180369123816490e-1))),
+            _mm256_mul_pd(n, _mm256_set1_pd(1.90821492927058770002e-10)));
+
+        const __m256d scale = pow2_pd(n);
+        const __m256d u = _mm256_add_pd(_mm256_mul_pd(scale, expm1_pd(r, accurate)), _mm256_sub_pd(scale, _mm256_set1_pd(1.0)));
+        const __m256d result = _mm256_or_pd(_mm256_div_pd(_mm256_sub_pd(_mm256_setzero_pd(), u), _mm256_add_pd(_mm256_set1_pd(2.0), u)),
+            _mm256_and_pd(sign, x));
+
+        return _mm256_blendv_pd(result, x, _mm256_cmp_pd(x, x, _CMP_UNORD_Q));
+    }
+
+    // the accurate powers of floats go through the fast double functions,
+    // like pow_scalar does
+    static forcedinline __m256 pow_ps(__m256 x, __m256 y, bool accurate)
+    {
+        if (accurate)
+        {
+            const __m256d low = exp_pd(_mm256_mul_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(y)),
+                log_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(x)), false)), false);
+            const __m256d high = exp_pd(_mm256_mul_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(y, 1)),
+                log_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)), false)), false);
+
+            return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(low)), _mm256_cvtpd_ps(high), 1);
+        }
+
+        return exp_ps(_mm256_mul_ps(y, log_ps(x, false)), false);
+    }
+
+    static forcedinline __m256d pow_pd(__m256d x, __m256d y, bool accurate)
+    {
+        return exp_pd(_mm256_mul_pd(y, log_pd(x, accurate)), accurate);
+    }
+
 };
 
 
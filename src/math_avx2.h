@@ -45,7 +45,7 @@ public:
 
     //--------------------------------------------------------------------------
 
-    const char* name() const { return "AVX"; }
+    const char* name() const { return "AVX2"; }
 
 
     //--------------------------------------------------------------------------
@@ -54,7 +54,7 @@ public:
     {
         AVX2_MIN_SIZE    = 8,
         AVX2_MIN_SAMPLES = 32,
-        AVX2_ALIGN       = 0x0F
+        AVX2_ALIGN       = 0x1F
     };
 
 
@@ -65,6 +65,1856 @@ public:
         //assertfalse; // not implemented !
     }
 
+
+    //==========================================================================
+
+    //--------------------------------------------------------------------------
+
+    #define math_avx2_clear_buffer_impl(datatype) \
+        void clear_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size) const \
+        { \
+            if (size < AVX2_MIN_SAMPLES) \
+            { \
+                math_avx::clear_buffer_ ##datatype (src_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= AVX2_MIN_SIZE); \
+                \
+                const ptrdiff_t align_bytes = \
+                    ((ptrdiff_t)src_buffer & AVX2_ALIGN); \
+                \
+                /* Copy unaligned head */ \
+                simd_loop_head(datatype, AVX2_ALIGN, \
+                    --size; \
+                    *src_buffer++ = datatype(0); \
+                ); \
+                \
+                /* Clear with simd */ \
+                const __m256i vvalue = _mm256_setzero_si256(); \
+                __m256i* vector_buffer = (__m256i*)src_buffer; \
+                \
+                uint32 vector_count = size / (32 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    *vector_buffer = vvalue; \
+                    \
+                    ++vector_buffer; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer = (datatype*)vector_buffer; \
+                \
+                simd_loop_tail(32 / sizeof(datatype), \
+                    *src_buffer++ = datatype(0); \
+                ); \
+            } \
+        }
+
+    #define math_avx2_set_buffer_impl(datatype, vector_set) \
+        void set_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            datatype value) const \
+        { \
+            if (size < AVX2_MIN_SAMPLES) \
+            { \
+                math_avx::set_buffer_ ##datatype (src_buffer, size, value); \
+            } \
+            else \
+            { \
+                assert(size >= AVX2_MIN_SIZE); \
+                \
+                const ptrdiff_t align_bytes = \
+                    ((ptrdiff_t)src_buffer & AVX2_ALIGN); \
+                \
+                /* Copy unaligned head */ \
+                simd_loop_head(datatype, AVX2_ALIGN, \
+                    --size; \
+                    *src_buffer++ = value; \
+                ); \
+                \
+                /* Set with simd */ \
+                const __m256i vvalue = vector_set; \
+                __m256i* vector_buffer = (__m256i*)src_buffer; \
+                \
+                uint32 vector_count = size / (32 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    *vector_buffer = vvalue; \
+                    \
+                    ++vector_buffer; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer = (datatype*)vector_buffer; \
+                \
+                simd_loop_tail(32 / sizeof(datatype), \
+                    *src_buffer++ = value; \
+                ); \
+            } \
+        }
+
+    #define math_avx2_scale_buffer_impl(datatype, gaintype, vector_type, vector_set, round_function) \
+        void scale_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            gaintype gain) const \
+        { \
+            if (size < AVX2_MIN_SAMPLES) \
+            { \
+                math_avx::scale_buffer_ ##datatype (src_buffer, size, gain); \
+            } \
+            else \
+            { \
+                assert(size >= AVX2_MIN_SIZE); \
+                \
+                const disable_sse_denormals disable_denormals; \
+                \
+                const ptrdiff_t align_bytes = \
+                    ((ptrdiff_t)src_buffer & AVX2_ALIGN); \
+                \
+                /* Scale unaligned head */ \
+                simd_loop_head(datatype, AVX2_ALIGN, \
+                    --size; \
+                    *src_buffer = static_cast<datatype>( \
+                        round::round_function((gaintype)(*src_buffer) * gain)); \
+                    ++src_buffer; \
+                ); \
+                \
+                /* Scale with simd */ \
+                const vector_type vscale = vector_set(gain); \
+                __m256i* vector_buffer = (__m256i*)src_buffer; \
+                \
+                uint32 vector_count = size / (32 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    *vector_buffer = scale_vector_ ##datatype (*vector_buffer, vscale); \
+                    \
+                    ++vector_buffer; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer = (datatype*)vector_buffer; \
+                \
+                simd_loop_tail(32 / sizeof(datatype), \
+                    *src_buffer = static_cast<datatype>( \
+                        round::round_function((gaintype)(*src_buffer) * gain)); \
+                    ++src_buffer; \
+                ); \
+            } \
+        }
+
+    #define math_avx2_copy_buffer_impl(datatype) \
+        void copy_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)src_buffer & AVX2_ALIGN); \
+            \
+            if (size < AVX2_MIN_SAMPLES || \
+                ((ptrdiff_t)dst_buffer & AVX2_ALIGN) != align_bytes) \
+            { \
+                math_avx::copy_buffer_ ##datatype (src_buffer, dst_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= AVX2_MIN_SIZE); \
+                \
+                /* Copy unaligned head */ \
+                simd_loop_head(datatype, AVX2_ALIGN, \
+                    --size; \
+                    *dst_buffer++ = *src_buffer++; \
+                ); \
+                \
+                /* Copy with simd */ \
+                __m256i* source_vector = (__m256i*)src_buffer; \
+                __m256i* dest_vector = (__m256i*)dst_buffer; \
+                \
+                uint32 vector_count = size / (32 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    *dest_vector = *source_vector; \
+                    \
+                    ++dest_vector; \
+                    ++source_vector; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer = (datatype*)source_vector; \
+                dst_buffer = (datatype*)dest_vector; \
+                \
+                simd_loop_tail(32 / sizeof(datatype), \
+                    *dst_buffer++ = *src_buffer++; \
+                ); \
+            } \
+        }
+
+    #define math_avx2_binary_buffers_impl(function, datatype, op, vector_op) \
+        void function ##_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_buffer & AVX2_ALIGN); \
+            \
+            if (size < AVX2_MIN_SAMPLES || \
+                (align_bytes != ((ptrdiff_t)src_buffer_a & AVX2_ALIGN) || \
+                 align_bytes != ((ptrdiff_t)src_buffer_b & AVX2_ALIGN))) \
+            { \
+                math_avx::function ##_ ##datatype ( \
+                    src_buffer_a, src_buffer_b, dst_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= AVX2_MIN_SIZE); \
+                \
+                /* Copy unaligned head */ \
+                simd_loop_head(datatype, AVX2_ALIGN, \
+                    --size; \
+                    *dst_buffer++ = *src_buffer_a++ op *src_buffer_b++; \
+                ); \
+                \
+                /* Operate with simd */ \
+                __m256i* vector_buffer_a = (__m256i*)src_buffer_a; \
+                __m256i* vector_buffer_b = (__m256i*)src_buffer_b; \
+                __m256i* vector_dst_buffer = (__m256i*)dst_buffer; \
+                \
+                uint32 vector_count = size / (32 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    *vector_dst_buffer = \
+                      vector_op(*vector_buffer_a, *vector_buffer_b); \
+                    \
+                    ++vector_buffer_a; \
+                    ++vector_buffer_b; \
+                    ++vector_dst_buffer; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer_a = (datatype*)vector_buffer_a; \
+                src_buffer_b = (datatype*)vector_buffer_b; \
+                dst_buffer = (datatype*)vector_dst_buffer; \
+                \
+                simd_loop_tail(32 / sizeof(datatype), \
+                    *dst_buffer++ = *src_buffer_a++ op *src_buffer_b++; \
+                ); \
+            } \
+        }
+
+    #define math_avx2_saturating_buffers_impl(function, datatype, scalar_op, vector_op) \
+        void function ##_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_buffer & AVX2_ALIGN); \
+            \
+            if (size < AVX2_MIN_SAMPLES || \
+                (align_bytes != ((ptrdiff_t)src_buffer_a & AVX2_ALIGN) || \
+                 align_bytes != ((ptrdiff_t)src_buffer_b & AVX2_ALIGN))) \
+            { \
+                math_avx::function ##_ ##datatype ( \
+                    src_buffer_a, src_buffer_b, dst_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= AVX2_MIN_SIZE); \
+                \
+                /* Copy unaligned head */ \
+                simd_loop_head(datatype, AVX2_ALIGN, \
+                    --size; \
+                    *dst_buffer++ = scalar_op(*src_buffer_a++, *src_buffer_b++); \
+                ); \
+                \
+                /* Operate with simd */ \
+                __m256i* vector_buffer_a = (__m256i*)src_buffer_a; \
+                __m256i* vector_buffer_b = (__m256i*)src_buffer_b; \
+                __m256i* vector_dst_buffer = (__m256i*)dst_buffer; \
+                \
+                uint32 vector_count = size / (32 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    *vector_dst_buffer = \
+                      vector_op(*vector_buffer_a, *vector_buffer_b); \
+                    \
+                    ++vector_buffer_a; \
+                    ++vector_buffer_b; \
+                    ++vector_dst_buffer; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer_a = (datatype*)vector_buffer_a; \
+                src_buffer_b = (datatype*)vector_buffer_b; \
+                dst_buffer = (datatype*)vector_dst_buffer; \
+                \
+                simd_loop_tail(32 / sizeof(datatype), \
+                    *dst_buffer++ = scalar_op(*src_buffer_a++, *src_buffer_b++); \
+                ); \
+            } \
+        }
+
+    #define math_avx2_scale_saturate_buffer_impl(datatype) \
+        void scale_buffer_saturate_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            float gain) const \
+        { \
+            if (size < AVX2_MIN_SAMPLES) \
+            { \
+                math_avx::scale_buffer_saturate_ ##datatype (src_buffer, size, gain); \
+            } \
+            else \
+            { \
+                assert(size >= AVX2_MIN_SIZE); \
+                \
+                const disable_sse_denormals disable_denormals; \
+                \
+                const ptrdiff_t align_bytes = \
+                    ((ptrdiff_t)src_buffer & AVX2_ALIGN); \
+                \
+                /* Scale unaligned head */ \
+                simd_loop_head(datatype, AVX2_ALIGN, \
+                    --size; \
+                    *src_buffer = scale_saturate_scalar(*src_buffer, gain); \
+                    ++src_buffer; \
+                ); \
+                \
+                /* Scale with simd */ \
+                const __m256 vscale = _mm256_set1_ps(gain); \
+                __m256i* vector_buffer = (__m256i*)src_buffer; \
+                \
+                uint32 vector_count = size / (32 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    *vector_buffer = scale_saturate_vector_ ##datatype (*vector_buffer, vscale); \
+                    \
+                    ++vector_buffer; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer = (datatype*)vector_buffer; \
+                \
+                simd_loop_tail(32 / sizeof(datatype), \
+                    *src_buffer = scale_saturate_scalar(*src_buffer, gain); \
+                    ++src_buffer; \
+                ); \
+            } \
+        }
+
+    #define math_avx2_multiply_add_buffers_impl(datatype, vector_type, scalar_madd, vector_madd) \
+        void multiply_add_buffers_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* src_buffer_c, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_buffer & AVX2_ALIGN); \
+            \
+            if (size < AVX2_MIN_SAMPLES || \
+                (align_bytes != ((ptrdiff_t)src_buffer_a & AVX2_ALIGN) || \
+                 align_bytes != ((ptrdiff_t)src_buffer_b & AVX2_ALIGN) || \
+                 align_bytes != ((ptrdiff_t)src_buffer_c & AVX2_ALIGN))) \
+            { \
+                math_avx::multiply_add_buffers_ ##datatype ( \
+                    src_buffer_a, src_buffer_b, src_buffer_c, dst_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= AVX2_MIN_SIZE); \
+                \
+                const disable_sse_denormals disable_denormals; \
+                \
+                /* Copy unaligned head */ \
+                simd_loop_head(datatype, AVX2_ALIGN, \
+                    --size; \
+                    *dst_buffer++ = scalar_madd(*src_buffer_a++, *src_buffer_b++, *src_buffer_c++); \
+                ); \
+                \
+                /* Multiply and add with simd */ \
+                vector_type* vector_buffer_a = (vector_type*)src_buffer_a; \
+                vector_type* vector_buffer_b = (vector_type*)src_buffer_b; \
+                vector_type* vector_buffer_c = (vector_type*)src_buffer_c; \
+                vector_type* vector_dst_buffer = (vector_type*)dst_buffer; \
+                \
+                uint32 vector_count = size / (32 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    *vector_dst_buffer = vector_madd( \
+                        *vector_buffer_a, *vector_buffer_b, *vector_buffer_c); \
+                    \
+                    ++vector_buffer_a; \
+                    ++vector_buffer_b; \
+                    ++vector_buffer_c; \
+                    ++vector_dst_buffer; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer_a = (datatype*)vector_buffer_a; \
+                src_buffer_b = (datatype*)vector_buffer_b; \
+                src_buffer_c = (datatype*)vector_buffer_c; \
+                dst_buffer = (datatype*)vector_dst_buffer; \
+                \
+                simd_loop_tail(32 / sizeof(datatype), \
+                    *dst_buffer++ = scalar_madd(*src_buffer_a++, *src_buffer_b++, *src_buffer_c++); \
+                ); \
+            } \
+        }
+
+    #define math_avx2_scale_add_buffer_impl(datatype, vector_type, vector_set, scalar_madd, vector_madd) \
+        void scale_add_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype gain) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_buffer & AVX2_ALIGN); \
+            \
+            if (size < AVX2_MIN_SAMPLES || \
+                align_bytes != ((ptrdiff_t)src_buffer & AVX2_ALIGN)) \
+            { \
+                math_avx::scale_add_buffer_ ##datatype ( \
+                    src_buffer, dst_buffer, size, gain); \
+            } \
+            else \
+            { \
+                assert(size >= AVX2_MIN_SIZE); \
+                \
+                const disable_sse_denormals disable_denormals; \
+                \
+                /* Copy unaligned head */ \
+                simd_loop_head(datatype, AVX2_ALIGN, \
+                    --size; \
+                    *dst_buffer = scalar_madd(*src_buffer++, gain, *dst_buffer); \
+                    ++dst_buffer; \
+                ); \
+                \
+                /* Scale and accumulate with simd */ \
+                const vector_type vgain = vector_set; \
+                vector_type* vector_buffer = (vector_type*)src_buffer; \
+                vector_type* vector_dst_buffer = (vector_type*)dst_buffer; \
+                \
+                uint32 vector_count = size / (32 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    *vector_dst_buffer = vector_madd( \
+                        *vector_buffer, vgain, *vector_dst_buffer); \
+                    \
+                    ++vector_buffer; \
+                    ++vector_dst_buffer; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer = (datatype*)vector_buffer; \
+                dst_buffer = (datatype*)vector_dst_buffer; \
+                \
+                simd_loop_tail(32 / sizeof(datatype), \
+                    *dst_buffer = scalar_madd(*src_buffer++, gain, *dst_buffer); \
+                    ++dst_buffer; \
+                ); \
+            } \
+        }
+
+
+    //--------------------------------------------------------------------------
+
+    // eight samples at a time through 32 bit lanes, like the SSE2 conversions
+    #define math_avx2_conversion_functions_impl(integer, datatype, bits) \
+        void convert_buffer_ ##integer ##_to_ ##datatype ( \
+            integer* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            if (size < AVX2_MIN_SAMPLES) \
+            { \
+                math_avx::convert_buffer_ ##integer ##_to_ ##datatype ( \
+                    src_buffer, dst_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= AVX2_MIN_SIZE); \
+                \
+                const integer_format<datatype> format(bits); \
+                \
+                /* Widen the samples to 32 bit lanes, then convert and scale */ \
+                uint32 vector_count = size >> 3; \
+                while (vector_count--) \
+                { \
+                    store_scaled_samples(dst_buffer, load_samples(src_buffer), format.scale); \
+                    \
+                    src_buffer += 8; \
+                    dst_buffer += 8; \
+                } \
+                \
+                /* Handle any leftovers */ \
+                convert_from_integer_generic(src_buffer, dst_buffer, size & 7, format); \
+            } \
+        } \
+        \
+        void convert_buffer_ ##datatype ##_to_ ##integer ( \
+            datatype* src_buffer, \
+            integer* dst_buffer, \
+            uint32 size, \
+            FloatRoundingModeTypes rounding, \
+            uint32* dither_seed) const \
+        { \
+            if (size < AVX2_MIN_SAMPLES) \
+            { \
+                math_avx::convert_buffer_ ##datatype ##_to_ ##integer ( \
+                    src_buffer, dst_buffer, size, rounding, dither_seed); \
+            } \
+            else \
+            { \
+                assert(size >= AVX2_MIN_SIZE); \
+                \
+                const integer_format<datatype> format(bits); \
+                const float_rounding_mode round_mode(rounding); \
+                \
+                /* Scale, dither and saturate, then round and narrow the lanes */ \
+                const bool dither = dither_seed != nullptr; \
+                const __m256i vstep = _mm256_set1_epi32(8); \
+                __m256i vindex = _mm256_add_epi32(_mm256_set1_epi32(dither ? (int32)*dither_seed : 0), \
+                    _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0)); \
+                \
+                uint32 vector_count = size >> 3; \
+                while (vector_count--) \
+                { \
+                    store_samples(dst_buffer, round_samples(src_buffer, format, dither, vindex)); \
+                    vindex = _mm256_add_epi32(vindex, vstep); \
+                    \
+                    src_buffer += 8; \
+                    dst_buffer += 8; \
+                } \
+                \
+                /* Handle any leftovers */ \
+                convert_to_integer_generic(src_buffer, dst_buffer, size & 7, \
+                    format, dither_seed, size & ~7); \
+                \
+                advance_dither_seed(dither_seed, size); \
+            } \
+        }
+
+
+    //--------------------------------------------------------------------------
+
+
+    #define math_avx2_sum_buffer_impl(datatype, accumtype, vector_sum) \
+        accumtype sum_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size) const \
+        { \
+            if (size < AVX2_MIN_SAMPLES) \
+            { \
+                return math_avx::sum_buffer_ ##datatype (src_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= AVX2_MIN_SIZE); \
+                \
+                const ptrdiff_t align_bytes = \
+                    ((ptrdiff_t)src_buffer & AVX2_ALIGN); \
+                \
+                uint64 result = 0; \
+                \
+                /* Sum unaligned head */ \
+                simd_loop_head(datatype, AVX2_ALIGN, \
+                    --size; \
+                    result += static_cast<uint64>(*src_buffer++); \
+                ); \
+                \
+                /* Sum with simd */ \
+                __m256i vsum = _mm256_setzero_si256(); \
+                __m256i* vector_buffer = (__m256i*)src_buffer; \
+                \
+                uint32 vector_count = size / (32 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    vsum = vector_sum(vsum, *vector_buffer); \
+                    \
+                    ++vector_buffer; \
+                } \
+                \
+                result += reduce_epi64(vsum); \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer = (datatype*)vector_buffer; \
+                \
+                simd_loop_tail(32 / sizeof(datatype), \
+                    result += static_cast<uint64>(*src_buffer++); \
+                ); \
+                \
+                return static_cast<accumtype>(result); \
+            } \
+        }
+
+    #define math_avx2_dot_product_impl(datatype, accumtype, vector_dot) \
+        accumtype dot_product_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            uint32 size) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)src_buffer_a & AVX2_ALIGN); \
+            \
+            if (size < AVX2_MIN_SAMPLES || \
+                align_bytes != ((ptrdiff_t)src_buffer_b & AVX2_ALIGN)) \
+            { \
+                return math_avx::dot_product_ ##datatype (src_buffer_a, src_buffer_b, size); \
+            } \
+            else \
+            { \
+                assert(size >= AVX2_MIN_SIZE); \
+                \
+                uint64 result = 0; \
+                \
+                /* Multiply and sum unaligned head */ \
+                simd_loop_head(datatype, AVX2_ALIGN, \
+                    --size; \
+                    result += static_cast<uint64>(*src_buffer_a++) * \
+                        static_cast<uint64>(*src_buffer_b++); \
+                ); \
+                \
+                /* Multiply and sum with simd */ \
+                __m256i vsum = _mm256_setzero_si256(); \
+                __m256i* vector_buffer_a = (__m256i*)src_buffer_a; \
+                __m256i* vector_buffer_b = (__m256i*)src_buffer_b; \
+                \
+                uint32 vector_count = size / (32 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    vsum = vector_dot(vsum, *vector_buffer_a, *vector_buffer_b); \
+                    \
+                    ++vector_buffer_a; \
+                    ++vector_buffer_b; \
+                } \
+                \
+                result += reduce_epi64(vsum); \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer_a = (datatype*)vector_buffer_a; \
+                src_buffer_b = (datatype*)vector_buffer_b; \
+                \
+                simd_loop_tail(32 / sizeof(datatype), \
+                    result += static_cast<uint64>(*src_buffer_a++) * \
+                        static_cast<uint64>(*src_buffer_b++); \
+                ); \
+                \
+                return static_cast<accumtype>(result); \
+            } \
+        }
+
+    #define math_avx2_extreme_buffer_impl(function, datatype, op, vector_set, vector_op) \
+        datatype function ##_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            uint32* index) const \
+        { \
+            if (size < AVX2_MIN_SAMPLES) \
+            { \
+                return math_avx::function ##_ ##datatype (src_buffer, size, index); \
+            } \
+            else \
+            { \
+                assert(size >= AVX2_MIN_SIZE); \
+                \
+                const ptrdiff_t align_bytes = \
+                    ((ptrdiff_t)src_buffer & AVX2_ALIGN); \
+                \
+                datatype* const buffer = src_buffer; \
+                const uint32 buffer_size = size; \
+                datatype result = *src_buffer; \
+                \
+                /* Compare unaligned head */ \
+                simd_loop_head(datatype, AVX2_ALIGN, \
+                    --size; \
+                    if (*src_buffer op result) \
+                        result = *src_buffer; \
+                    ++src_buffer; \
+                ); \
+                \
+                /* Compare with simd */ \
+                __m256i vresult = vector_set; \
+                __m256i* vector_buffer = (__m256i*)src_buffer; \
+                \
+                uint32 vector_count = size / (32 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    vresult = vector_op(*vector_buffer, vresult); \
+                    \
+                    ++vector_buffer; \
+                } \
+                \
+                datatype lanes[32 / sizeof(datatype)]; \
+                memcpy(lanes, &vresult, sizeof(vresult)); \
+                for (uint32 i = 0; i < 32 / sizeof(datatype); ++i) \
+                { \
+                    if (lanes[i] op result) \
+                        result = lanes[i]; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer = (datatype*)vector_buffer; \
+                \
+                simd_loop_tail(32 / sizeof(datatype), \
+                    if (*src_buffer op result) \
+                        result = *src_buffer; \
+                    ++src_buffer; \
+                ); \
+                \
+                if (index != nullptr) \
+                    *index = index_of_value(buffer, buffer_size, result); \
+                \
+                return result; \
+            } \
+        }
+
+    #define math_avx2_reduction_functions_impl(datatype, accumtype, vector_set, vector_sum, vector_dot, vector_min, vector_max) \
+        math_avx2_sum_buffer_impl(datatype, accumtype, vector_sum) \
+        math_avx2_dot_product_impl(datatype, accumtype, vector_dot) \
+        math_avx2_extreme_buffer_impl(min_buffer, datatype, <, vector_set, vector_min) \
+        math_avx2_extreme_buffer_impl(max_buffer, datatype, >, vector_set, vector_max)
+
+    #define math_avx2_common_functions_impl(datatype, vector_set, add, sub, mul) \
+        math_avx2_clear_buffer_impl(datatype) \
+        math_avx2_set_buffer_impl(datatype, vector_set) \
+        math_avx2_copy_buffer_impl(datatype) \
+        math_avx2_binary_buffers_impl(add_buffers, datatype, +, add) \
+        math_avx2_binary_buffers_impl(subtract_buffers, datatype, -, sub) \
+        math_avx2_binary_buffers_impl(multiply_buffers, datatype, *, mul)
+
+    #define math_avx2_scale_functions_impl(datatype) \
+        math_avx2_scale_buffer_impl(datatype, float, __m256, _mm256_set1_ps, f2i) \
+        math_avx2_scale_buffer_impl(datatype, double, __m256d, _mm256_set1_pd, d2i)
+
+    #define math_avx2_saturating_functions_impl(datatype, adds, subs, avg) \
+        math_avx2_saturating_buffers_impl(add_buffers_saturate, datatype, add_saturate_scalar, adds) \
+        math_avx2_saturating_buffers_impl(subtract_buffers_saturate, datatype, subtract_saturate_scalar, subs) \
+        math_avx2_saturating_buffers_impl(average_buffers, datatype, average_scalar, avg) \
+        math_avx2_scale_saturate_buffer_impl(datatype)
+
+
+    //==========================================================================
+
+    //--------------------------------------------------------------------------
+
+    math_avx2_common_functions_impl(int8, _mm256_set1_epi8(value),
+        _mm256_add_epi8, _mm256_sub_epi8, mullo_epi8)
+    math_avx2_common_functions_impl(uint8, _mm256_set1_epi8((char)value),
+        _mm256_add_epi8, _mm256_sub_epi8, mullo_epi8)
+    math_avx2_common_functions_impl(int16, _mm256_set1_epi16(value),
+        _mm256_add_epi16, _mm256_sub_epi16, _mm256_mullo_epi16)
+    math_avx2_common_functions_impl(uint16, _mm256_set1_epi16((short)value),
+        _mm256_add_epi16, _mm256_sub_epi16, _mm256_mullo_epi16)
+    math_avx2_common_functions_impl(int32, _mm256_set1_epi32(value),
+        _mm256_add_epi32, _mm256_sub_epi32, _mm256_mullo_epi32)
+    math_avx2_common_functions_impl(uint32, _mm256_set1_epi32((int)value),
+        _mm256_add_epi32, _mm256_sub_epi32, _mm256_mullo_epi32)
+    math_avx2_common_functions_impl(int64, _mm256_set1_epi64x(value),
+        _mm256_add_epi64, _mm256_sub_epi64, mullo_epi64)
+    math_avx2_common_functions_impl(uint64, _mm256_set1_epi64x((long long)value),
+        _mm256_add_epi64, _mm256_sub_epi64, mullo_epi64)
+
+    // 64 bit integers scaling is left to the base class, as there is no
+    // packed conversion between 64 bit integers and floating point in AVX2
+    math_avx2_scale_functions_impl(int8)
+    math_avx2_scale_functions_impl(uint8)
+    math_avx2_scale_functions_impl(int16)
+    math_avx2_scale_functions_impl(uint16)
+    math_avx2_scale_functions_impl(int32)
+    math_avx2_scale_functions_impl(uint32)
+
+    math_avx2_saturating_functions_impl(int8, _mm256_adds_epi8, _mm256_subs_epi8, avg_epi8)
+    math_avx2_saturating_functions_impl(uint8, _mm256_adds_epu8, _mm256_subs_epu8, _mm256_avg_epu8)
+    math_avx2_saturating_functions_impl(int16, _mm256_adds_epi16, _mm256_subs_epi16, avg_epi16)
+    math_avx2_saturating_functions_impl(uint16, _mm256_adds_epu16, _mm256_subs_epu16, _mm256_avg_epu16)
+
+    // fused multiply add rounds once, so results can differ from the other
+    // backends in the last bit
+    math_avx2_multiply_add_buffers_impl(float, __m256, fma_scalar, _mm256_fmadd_ps)
+    math_avx2_multiply_add_buffers_impl(double, __m256d, fma_scalar, _mm256_fmadd_pd)
+
+    math_avx2_scale_add_buffer_impl(float, __m256, _mm256_set1_ps(gain), fma_scalar, _mm256_fmadd_ps)
+    math_avx2_scale_add_buffer_impl(double, __m256d, _mm256_set1_pd(gain), fma_scalar, _mm256_fmadd_pd)
+
+    math_avx2_reduction_functions_impl(int8, int64, _mm256_set1_epi8(result),
+        sum_epi8, dot_epi8, _mm256_min_epi8, _mm256_max_epi8)
+    math_avx2_reduction_functions_impl(uint8, uint64, _mm256_set1_epi8((char)result),
+        sum_epu8, dot_epu8, _mm256_min_epu8, _mm256_max_epu8)
+    math_avx2_reduction_functions_impl(int16, int64, _mm256_set1_epi16(result),
+        sum_epi16, dot_epi16, _mm256_min_epi16, _mm256_max_epi16)
+    math_avx2_reduction_functions_impl(uint16, uint64, _mm256_set1_epi16((short)result),
+        sum_epu16, dot_epu16, _mm256_min_epu16, _mm256_max_epu16)
+    math_avx2_reduction_functions_impl(int32, int64, _mm256_set1_epi32(result),
+        sum_epi32, dot_epi32, _mm256_min_epi32, _mm256_max_epi32)
+    math_avx2_reduction_functions_impl(uint32, uint64, _mm256_set1_epi32((int)result),
+        sum_epu32, dot_epu32, _mm256_min_epu32, _mm256_max_epu32)
+    math_avx2_reduction_functions_impl(int64, int64, _mm256_set1_epi64x(result),
+        _mm256_add_epi64, dot_epi64, min_epi64, max_epi64)
+    math_avx2_reduction_functions_impl(uint64, uint64, _mm256_set1_epi64x((long long)result),
+        _mm256_add_epi64, dot_epi64, min_epu64, max_epu64)
+
+    // AVX2 has the 64 bit compare SSE2 lacks, so their peak can come from the
+    // extremes as well
+    math_sse2_integer_peak_abs_buffer_impl(int64, int64)
+    math_sse2_integer_peak_abs_buffer_impl(uint64, uint64)
+
+    math_avx2_conversion_functions_impl(int16, float, 16)
+    math_avx2_conversion_functions_impl(int24, float, 24)
+    math_avx2_conversion_functions_impl(int32, float, 32)
+    math_avx2_conversion_functions_impl(int16, double, 16)
+    math_avx2_conversion_functions_impl(int24, double, 24)
+    math_avx2_conversion_functions_impl(int32, double, 32)
+
+
+    //--------------------------------------------------------------------------
+
+    // 8 bit pixels are widened to 16 bit lanes within each half, four pixels
+    // per register, and packed back in the same order
+
+    void premultiply_rgba_uint8(
+        uint8* src_buffer,
+        uint8* dst_buffer,
+        uint32 pixels) const
+    {
+        const __m256i vzero = _mm256_setzero_si256();
+
+        // Alpha is multiplied by 255, which leaves it as it is
+        const __m256i alpha_one = _mm256_set1_epi64x(0x00FF000000000000LL);
+
+        const uint32 vector_pixels = pixels & ~7;
+        for (uint32 i = 0; i < vector_pixels; i += 8)
+        {
+            const __m256i pixel = _mm256_loadu_si256((const __m256i*)(src_buffer + i * 4));
+            const __m256i lo = _mm256_unpacklo_epi8(pixel, vzero);
+            const __m256i hi = _mm256_unpackhi_epi8(pixel, vzero);
+
+            _mm256_storeu_si256((__m256i*)(dst_buffer + i * 4), _mm256_packus_epi16(
+                multiply_255_epi16(lo, _mm256_or_si256(alpha_epi16(lo), alpha_one)),
+                multiply_255_epi16(hi, _mm256_or_si256(alpha_epi16(hi), alpha_one))));
+        }
+
+        // Handle the leftovers
+        premultiply_rgba_generic(src_buffer, dst_buffer, pixels, vector_pixels);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void unpremultiply_rgba_uint8(
+        uint8* src_buffer,
+        uint8* dst_buffer,
+        uint32 pixels) const
+    {
+        const disable_sse_denormals disable_denormals;
+
+        const __m256i vzero = _mm256_setzero_si256();
+        const __m256i alpha_mask = _mm256_set1_epi32((int)0xFF000000);
+
+        const uint32 vector_pixels = pixels & ~7;
+        for (uint32 i = 0; i < vector_pixels; i += 8)
+        {
+            const __m256i pixel = _mm256_loadu_si256((const __m256i*)(src_buffer + i * 4));
+            const __m256i colour = _mm256_packus_epi16(
+                unpremultiply_epi16(_mm256_unpacklo_epi8(pixel, vzero)),
+                unpremultiply_epi16(_mm256_unpackhi_epi8(pixel, vzero)));
+
+            _mm256_storeu_si256((__m256i*)(dst_buffer + i * 4), _mm256_blendv_epi8(colour, pixel, alpha_mask));
+        }
+
+        // Handle the leftovers
+        unpremultiply_rgba_generic(src_buffer, dst_buffer, pixels, vector_pixels);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // the pixels of the source and backdrop eight at a time, widened, into
+    // the composited expression
+    #define math_avx2_composite_loop(expression) \
+        for (uint32 i = 0; i < vector_pixels; i += 8) \
+        { \
+            const __m256i source_pixels = _mm256_loadu_si256((const __m256i*)(src_buffer + i * 4)); \
+            const __m256i backdrop_pixels = _mm256_loadu_si256((const __m256i*)(backdrop_buffer + i * 4)); \
+            \
+            __m256i s = _mm256_unpacklo_epi8(source_pixels, vzero); \
+            __m256i d = _mm256_unpacklo_epi8(backdrop_pixels, vzero); \
+            const __m256i lo = expression; \
+            \
+            s = _mm256_unpackhi_epi8(source_pixels, vzero); \
+            d = _mm256_unpackhi_epi8(backdrop_pixels, vzero); \
+            const __m256i hi = expression; \
+            \
+            _mm256_storeu_si256((__m256i*)(dst_buffer + i * 4), _mm256_packus_epi16(lo, hi)); \
+        }
+
+    void composite_rgba_uint8(
+        uint8* src_buffer,
+        uint8* backdrop_buffer,
+        uint8* dst_buffer,
+        uint32 pixels,
+        CompositeModeTypes mode) const
+    {
+        const __m256i vzero = _mm256_setzero_si256();
+        const __m256i vmax = _mm256_set1_epi16(255);
+
+        const uint32 vector_pixels = pixels & ~7;
+        switch (mode)
+        {
+        case MULTIPLY_COMPOSITE:
+            math_avx2_composite_loop(multiply_pixel_epi16(s, d, alpha_epi16(s), alpha_epi16(d), vmax))
+            break;
+
+        case SCREEN_COMPOSITE:
+            math_avx2_composite_loop(screen_pixel_epi16(s, d))
+            break;
+
+        case OVERLAY_COMPOSITE:
+            math_avx2_composite_loop(overlay_pixel_epi16(s, d, alpha_epi16(s), alpha_epi16(d), vmax))
+            break;
+
+        case ADD_COMPOSITE:
+            // Saturated bytes need no widening
+            for (uint32 i = 0; i < vector_pixels; i += 8)
+            {
+                _mm256_storeu_si256((__m256i*)(dst_buffer + i * 4), _mm256_adds_epu8(
+                    _mm256_loadu_si256((const __m256i*)(src_buffer + i * 4)),
+                    _mm256_loadu_si256((const __m256i*)(backdrop_buffer + i * 4))));
+            }
+            break;
+
+        default:
+        {
+            const uint32 source = porter_duff_factor(mode, true);
+            const uint32 backdrop = porter_duff_factor(mode, false);
+            const __m256i source_mask = _mm256_set1_epi16(pixel_factor_mask(source));
+            const __m256i source_invert = _mm256_set1_epi16(pixel_factor_invert(source));
+            const __m256i backdrop_mask = _mm256_set1_epi16(pixel_factor_mask(backdrop));
+            const __m256i backdrop_invert = _mm256_set1_epi16(pixel_factor_invert(backdrop));
+
+            math_avx2_composite_loop(_mm256_add_epi16(
+                multiply_255_epi16(s, _mm256_xor_si256(_mm256_and_si256(alpha_epi16(d), source_mask), source_invert)),
+                multiply_255_epi16(d, _mm256_xor_si256(_mm256_and_si256(alpha_epi16(s), backdrop_mask), backdrop_invert))))
+            break;
+        }
+        }
+
+        // Handle the leftovers
+        composite_rgba_generic(src_buffer, backdrop_buffer, dst_buffer, pixels, mode, vector_pixels);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void pack_rgba_planes_uint8(
+        uint8* red_buffer,
+        uint8* green_buffer,
+        uint8* blue_buffer,
+        uint8* alpha_buffer,
+        uint8* dst_buffer,
+        uint32 pixels) const
+    {
+        const __m256i opaque = _mm256_set1_epi8((char)0xFF);
+
+        const uint32 vector_pixels = pixels & ~31;
+        for (uint32 i = 0; i < vector_pixels; i += 32)
+        {
+            store_rgba_epi8(dst_buffer + i * 4,
+                _mm256_loadu_si256((const __m256i*)(red_buffer + i)),
+                _mm256_loadu_si256((const __m256i*)(green_buffer + i)),
+                _mm256_loadu_si256((const __m256i*)(blue_buffer + i)),
+                alpha_buffer ? _mm256_loadu_si256((const __m256i*)(alpha_buffer + i)) : opaque);
+        }
+
+        // Handle the leftovers
+        pack_rgba_planes_generic(red_buffer, green_buffer, blue_buffer, alpha_buffer, dst_buffer, pixels, vector_pixels);
+    }
+
+    void unpack_rgba_planes_uint8(
+        uint8* src_buffer,
+        uint8* red_buffer,
+        uint8* green_buffer,
+        uint8* blue_buffer,
+        uint8* alpha_buffer,
+        uint32 pixels) const
+    {
+        const uint32 vector_pixels = pixels & ~31;
+        for (uint32 i = 0; i < vector_pixels; i += 32)
+        {
+            __m256i rgba[4];
+            for (uint32 j = 0; j < 4; ++j)
+                rgba[j] = _mm256_loadu_si256((const __m256i*)(src_buffer + i * 4 + j * 32));
+
+            _mm256_storeu_si256((__m256i*)(red_buffer + i), rgba_channel_epi8(rgba, 0));
+            _mm256_storeu_si256((__m256i*)(green_buffer + i), rgba_channel_epi8(rgba, 8));
+            _mm256_storeu_si256((__m256i*)(blue_buffer + i), rgba_channel_epi8(rgba, 16));
+            if (alpha_buffer)
+                _mm256_storeu_si256((__m256i*)(alpha_buffer + i), rgba_channel_epi8(rgba, 24));
+        }
+
+        // Handle the leftovers
+        unpack_rgba_planes_generic(src_buffer, red_buffer, green_buffer, blue_buffer, alpha_buffer, pixels, vector_pixels);
+    }
+
+
+protected:
+
+    //--------------------------------------------------------------------------
+
+    // the colour kernels of sse2 on 32 pixels or 16 chroma samples at a time:
+    // the halves of the registers hold pixels 16 apart in the luma to RGBA
+    // direction, which the packs put back in order, and get reordered by a
+    // permute in the other direction
+
+    void rgba_to_luma_row_uint8(
+        uint8* src_buffer,
+        uint8* dst_buffer,
+        uint32 pixels,
+        const color_matrix& matrix) const
+    {
+        const __m256i weights = color_weights_epi16(matrix.y_red, matrix.y_green, matrix.y_blue);
+        const __m256i rounding = _mm256_set1_epi32(matrix.luma_rounding);
+
+        const uint32 vector_pixels = pixels & ~31;
+        for (uint32 i = 0; i < vector_pixels; i += 32)
+        {
+            __m256i luma[4];
+            for (uint32 j = 0; j < 4; ++j)
+            {
+                const __m256i rgba = _mm256_loadu_si256((const __m256i*)(src_buffer + i * 4 + j * 32));
+
+                luma[j] = _mm256_srai_epi32(_mm256_add_epi32(weight_pixels_epi32(
+                    _mm256_unpacklo_epi8(rgba, _mm256_setzero_si256()),
+                    _mm256_unpackhi_epi8(rgba, _mm256_setzero_si256()), weights), rounding), 15);
+            }
+
+            _mm256_storeu_si256((__m256i*)(dst_buffer + i), reorder_epi8(pack_epi32_epi8(luma)));
+        }
+
+        // Handle the leftovers
+        rgba_to_luma_generic(src_buffer, dst_buffer, pixels, matrix, vector_pixels);
+    }
+
+    void rgba_to_chroma_row_uint8(
+        uint8* src_buffer,
+        uint8* next_buffer,
+        uint8* u_buffer,
+        uint8* v_buffer,
+        uint32 step,
+        uint32 pixels,
+        const color_matrix& matrix) const
+    {
+        const __m256i u_weights = color_weights_epi16(matrix.u_red, matrix.u_green, matrix.u_blue);
+        const __m256i v_weights = color_weights_epi16(matrix.v_red, matrix.v_green, matrix.v_blue);
+        const __m256i rounding = _mm256_set1_epi32(matrix.chroma_rounding);
+
+        const uint32 vector_samples = (pixels / 2) & ~15;
+        for (uint32 i = 0; i < vector_samples; i += 16)
+        {
+            // Sums of the 2x2 blocks, four blocks each
+            __m256i sums[4];
+            for (uint32 j = 0; j < 4; ++j)
+            {
+                sums[j] = block_sums_epi16(
+                    _mm256_loadu_si256((const __m256i*)(src_buffer + i * 8 + j * 32)),
+                    _mm256_loadu_si256((const __m256i*)(next_buffer + i * 8 + j * 32)));
+            }
+
+            // Blocks 0, 1 | 4, 5 and 2, 3 | 6, 7 give them back in order
+            const __m256i sums_a = _mm256_permute2x128_si256(sums[0], sums[1], 0x20);
+            const __m256i sums_b = _mm256_permute2x128_si256(sums[0], sums[1], 0x31);
+            const __m256i sums_c = _mm256_permute2x128_si256(sums[2], sums[3], 0x20);
+            const __m256i sums_d = _mm256_permute2x128_si256(sums[2], sums[3], 0x31);
+
+            __m256i chroma[4];
+            chroma[0] = _mm256_srai_epi32(_mm256_add_epi32(weight_pixels_epi32(sums_a, sums_b, u_weights), rounding), 17);
+            chroma[1] = _mm256_srai_epi32(_mm256_add_epi32(weight_pixels_epi32(sums_c, sums_d, u_weights), rounding), 17);
+            chroma[2] = _mm256_srai_epi32(_mm256_add_epi32(weight_pixels_epi32(sums_a, sums_b, v_weights), rounding), 17);
+            chroma[3] = _mm256_srai_epi32(_mm256_add_epi32(weight_pixels_epi32(sums_c, sums_d, v_weights), rounding), 17);
+
+            // U samples in the low half, V ones in the high half
+            const __m256i uv = reorder_epi8(pack_epi32_epi8(chroma));
+            const __m128i u = _mm256_castsi256_si128(uv);
+            const __m128i v = _mm256_extracti128_si256(uv, 1);
+            if (step == 1)
+            {
+                _mm_storeu_si128((__m128i*)(u_buffer + i), u);
+                _mm_storeu_si128((__m128i*)(v_buffer + i), v);
+            }
+            else
+            {
+                _mm_storeu_si128((__m128i*)(u_buffer + i * 2), _mm_unpacklo_epi8(u, v));
+                _mm_storeu_si128((__m128i*)(u_buffer + i * 2 + 16), _mm_unpackhi_epi8(u, v));
+            }
+        }
+
+        // Handle the leftovers
+        rgba_to_chroma_generic(src_buffer, next_buffer, u_buffer, v_buffer, step, pixels, matrix, vector_samples);
+    }
+
+    void yuv_to_rgba_row_uint8(
+        uint8* y_buffer,
+        uint8* u_buffer,
+        uint8* v_buffer,
+        uint32 step,
+        uint8* dst_buffer,
+        uint32 pixels,
+        const color_matrix& matrix) const
+    {
+        const __m256i vzero = _mm256_setzero_si256();
+        const __m256i luma_weights = _mm256_set1_epi32((1 << 28) | (uint16)matrix.luma);
+        const __m256i luma_offset = _mm256_set1_epi16((short)matrix.luma_offset);
+        const __m256i chroma_offset = _mm256_set1_epi16(128);
+        const __m256i low_mask = _mm256_set1_epi16(0xFF);
+        const __m256i one = _mm256_set1_epi16(1);
+        const __m256i red_weights = _mm256_set1_epi32((int)((uint32)(uint16)matrix.red_v << 16));
+        const __m256i green_weights = _mm256_set1_epi32((int)(((uint32)(uint16)matrix.green_v << 16) | (uint16)matrix.green_u));
+        const __m256i blue_weights = _mm256_set1_epi32((uint16)matrix.blue_u);
+
+        const uint32 vector_pixels = pixels & ~31;
+        for (uint32 i = 0; i < vector_pixels; i += 32)
+        {
+            __m256i u, v;
+            if (step == 1)
+            {
+                u = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(u_buffer + i / 2)));
+                v = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(v_buffer + i / 2)));
+            }
+            else
+            {
+                const __m256i uv = _mm256_loadu_si256((const __m256i*)(u_buffer + i));
+                u = _mm256_and_si256(uv, low_mask);
+                v = _mm256_srli_epi16(uv, 8);
+            }
+
+            // U, V pairs of samples 0..7 | 8..15, each one repeated for two
+            // pixels as the luma of pixels 0..15 | 16..31 needs them
+            const __m256i uv_lo = _mm256_unpacklo_epi16(_mm256_sub_epi16(u, chroma_offset), _mm256_sub_epi16(v, chroma_offset));
+            const __m256i uv_hi = _mm256_unpackhi_epi16(_mm256_sub_epi16(u, chroma_offset), _mm256_sub_epi16(v, chroma_offset));
+
+            __m256i chroma[4];
+            chroma[0] = _mm256_unpacklo_epi32(uv_lo, uv_lo);
+            chroma[1] = _mm256_unpackhi_epi32(uv_lo, uv_lo);
+            chroma[2] = _mm256_unpacklo_epi32(uv_hi, uv_hi);
+            chroma[3] = _mm256_unpackhi_epi32(uv_hi, uv_hi);
+
+            // Luma paired with one, to add the rounding in the same madd
+            const __m256i y = _mm256_loadu_si256((const __m256i*)(y_buffer + i));
+            const __m256i y_lo = _mm256_sub_epi16(_mm256_unpacklo_epi8(y, vzero), luma_offset);
+            const __m256i y_hi = _mm256_sub_epi16(_mm256_unpackhi_epi8(y, vzero), luma_offset);
+
+            __m256i luma[4];
+            luma[0] = _mm256_madd_epi16(_mm256_unpacklo_epi16(y_lo, one), luma_weights);
+            luma[1] = _mm256_madd_epi16(_mm256_unpackhi_epi16(y_lo, one), luma_weights);
+            luma[2] = _mm256_madd_epi16(_mm256_unpacklo_epi16(y_hi, one), luma_weights);
+            luma[3] = _mm256_madd_epi16(_mm256_unpackhi_epi16(y_hi, one), luma_weights);
+
+            store_rgba_epi8(dst_buffer + i * 4,
+                rgb_channel_epi8(luma, chroma, red_weights),
+                rgb_channel_epi8(luma, chroma, green_weights),
+                rgb_channel_epi8(luma, chroma, blue_weights),
+                _mm256_set1_epi8((char)0xFF));
+        }
+
+        // Handle the leftovers
+        yuv_to_rgba_generic(y_buffer, u_buffer, v_buffer, step, dst_buffer, pixels, matrix, vector_pixels);
+    }
+
+    void luma_to_rgba_row_uint8(
+        uint8* src_buffer,
+        uint8* dst_buffer,
+        uint32 pixels,
+        const color_matrix& matrix) const
+    {
+        const __m256i vzero = _mm256_setzero_si256();
+        const __m256i luma_weights = _mm256_set1_epi32((1 << 28) | (uint16)matrix.luma);
+        const __m256i luma_offset = _mm256_set1_epi16((short)matrix.luma_offset);
+        const __m256i one = _mm256_set1_epi16(1);
+
+        const uint32 vector_pixels = pixels & ~31;
+        for (uint32 i = 0; i < vector_pixels; i += 32)
+        {
+            const __m256i y = _mm256_loadu_si256((const __m256i*)(src_buffer + i));
+            const __m256i y_lo = _mm256_sub_epi16(_mm256_unpacklo_epi8(y, vzero), luma_offset);
+            const __m256i y_hi = _mm256_sub_epi16(_mm256_unpackhi_epi8(y, vzero), luma_offset);
+
+            __m256i gray[4];
+            gray[0] = _mm256_srai_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(y_lo, one), luma_weights), 13);
+            gray[1] = _mm256_srai_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(y_lo, one), luma_weights), 13);
+            gray[2] = _mm256_srai_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(y_hi, one), luma_weights), 13);
+            gray[3] = _mm256_srai_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(y_hi, one), luma_weights), 13);
+
+            const __m256i g = pack_epi32_epi8(gray);
+            store_rgba_epi8(dst_buffer + i * 4, g, g, g, _mm256_set1_epi8((char)0xFF));
+        }
+
+        // Handle the leftovers
+        luma_to_rgba_generic(src_buffer, dst_buffer, pixels, matrix, vector_pixels);
+    }
+
+
+private:
+
+    //--------------------------------------------------------------------------
+
+    template<typename T> static forcedinline T fma_scalar(T a, T b, T c)
+    {
+        return std::fma(a, b, c);
+    }
+
+    static forcedinline __m256i mullo_epi8(__m256i a, __m256i b)
+    {
+        // multiply even and odd bytes separately as 16 bit lanes
+        const __m256i even = _mm256_mullo_epi16(a, b);
+        const __m256i odd = _mm256_mullo_epi16(
+            _mm256_srli_epi16(a, 8), _mm256_srli_epi16(b, 8));
+
+        return _mm256_or_si256(
+            _mm256_slli_epi16(odd, 8),
+            _mm256_and_si256(even, _mm256_set1_epi16(0x00FF)));
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // the alpha of the pixels in 16 bit lanes in all of their lanes, with a
+    // single byte shuffle
+    static forcedinline __m256i alpha_epi16(__m256i pixels)
+    {
+        return _mm256_shuffle_epi8(pixels, _mm256_setr_epi8(
+            6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15,
+            6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15));
+    }
+
+    // the multiply_255 of the fpu as the high half of (x * y + 128) * 257
+    static forcedinline __m256i multiply_255_epi16(__m256i x, __m256i y)
+    {
+        return _mm256_mulhi_epu16(_mm256_add_epi16(_mm256_mullo_epi16(x, y), _mm256_set1_epi16(128)), _mm256_set1_epi16(257));
+    }
+
+    // (c * 255 + a / 2) / a of the pixels in 32 bit lanes, truncated from
+    // the float division as in the sse2 backend
+    static forcedinline __m256i unpremultiply_epi32(__m256i pixels)
+    {
+        const __m256i alpha = _mm256_shuffle_epi32(pixels, _MM_SHUFFLE(3, 3, 3, 3));
+        const __m256i numerator = _mm256_add_epi32(_mm256_sub_epi32(_mm256_slli_epi32(pixels, 8), pixels), _mm256_srli_epi32(alpha, 1));
+        const __m256 quotient = _mm256_div_ps(_mm256_cvtepi32_ps(numerator), _mm256_max_ps(_mm256_cvtepi32_ps(alpha), _mm256_set1_ps(1.0f)));
+
+        return _mm256_and_si256(_mm256_cmpgt_epi32(alpha, _mm256_setzero_si256()),
+            _mm256_cvttps_epi32(_mm256_min_ps(quotient, _mm256_set1_ps(255.0f))));
+    }
+
+    static forcedinline __m256i unpremultiply_epi16(__m256i pixels)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+
+        return _mm256_packs_epi32(unpremultiply_epi32(_mm256_unpacklo_epi16(pixels, zero)),
+            unpremultiply_epi32(_mm256_unpackhi_epi16(pixels, zero)));
+    }
+
+    // the blend modes of the fpu composite_channel on 8 bit channels in 16
+    // bit lanes, the results are clamped when packed back
+    static forcedinline __m256i multiply_pixel_epi16(__m256i s, __m256i d, __m256i sa, __m256i da, __m256i max)
+    {
+        return _mm256_add_epi16(_mm256_add_epi16(multiply_255_epi16(s, _mm256_xor_si256(da, max)),
+            multiply_255_epi16(d, _mm256_xor_si256(sa, max))), multiply_255_epi16(s, d));
+    }
+
+    static forcedinline __m256i screen_pixel_epi16(__m256i s, __m256i d)
+    {
+        return _mm256_sub_epi16(_mm256_add_epi16(s, d), multiply_255_epi16(s, d));
+    }
+
+    static forcedinline __m256i overlay_pixel_epi16(__m256i s, __m256i d, __m256i sa, __m256i da, __m256i max)
+    {
+        const __m256i screen = _mm256_sub_epi16(multiply_255_epi16(sa, da),
+            _mm256_slli_epi16(multiply_255_epi16(_mm256_subs_epu16(da, d), _mm256_subs_epu16(sa, s)), 1));
+        const __m256i multiply = _mm256_slli_epi16(multiply_255_epi16(s, d), 1);
+
+        return _mm256_add_epi16(_mm256_add_epi16(multiply_255_epi16(s, _mm256_xor_si256(da, max)),
+            multiply_255_epi16(d, _mm256_xor_si256(sa, max))),
+            _mm256_blendv_epi8(multiply, screen, _mm256_cmpgt_epi16(_mm256_add_epi16(d, d), da)));
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline __m256i mullo_epi64(__m256i a, __m256i b)
+    {
+        // lo(a) * lo(b) + ((hi(a) * lo(b) + lo(a) * hi(b)) << 32)
+        const __m256i lo = _mm256_mul_epu32(a, b);
+        const __m256i cross = _mm256_add_epi64(
+            _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+            _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+
+        return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // int24 samples go through the SSE2 packing, one 128 bit half at a time
+
+    static forcedinline __m256i load_samples(const int16* src_buffer)
+    {
+        return _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)src_buffer));
+    }
+
+    static forcedinline __m256i load_samples(const int32* src_buffer)
+    {
+        return _mm256_loadu_si256((const __m256i*)src_buffer);
+    }
+
+    static forcedinline __m256i load_samples(const int24* src_buffer)
+    {
+        return _mm256_inserti128_si256(_mm256_castsi128_si256(
+            math_sse2::load_samples(src_buffer)), math_sse2::load_samples(src_buffer + 4), 1);
+    }
+
+    static forcedinline void store_samples(int16* dst_buffer, __m256i samples)
+    {
+        _mm_storeu_si128((__m128i*)dst_buffer, _mm_packs_epi32(
+            _mm256_castsi256_si128(samples), _mm256_extracti128_si256(samples, 1)));
+    }
+
+    static forcedinline void store_samples(int32* dst_buffer, __m256i samples)
+    {
+        _mm256_storeu_si256((__m256i*)dst_buffer, samples);
+    }
+
+    static forcedinline void store_samples(int24* dst_buffer, __m256i samples)
+    {
+        math_sse2::store_samples(dst_buffer, _mm256_castsi256_si128(samples));
+        math_sse2::store_samples(dst_buffer + 4, _mm256_extracti128_si256(samples, 1));
+    }
+
+    static forcedinline void store_scaled_samples(float* dst_buffer, __m256i samples, float scale)
+    {
+        _mm256_storeu_ps(dst_buffer, _mm256_mul_ps(_mm256_cvtepi32_ps(samples), _mm256_set1_ps(scale)));
+    }
+
+    static forcedinline void store_scaled_samples(double* dst_buffer, __m256i samples, double scale)
+    {
+        const __m256d vscale = _mm256_set1_pd(scale);
+
+        _mm256_storeu_pd(dst_buffer, _mm256_mul_pd(
+            _mm256_cvtepi32_pd(_mm256_castsi256_si128(samples)), vscale));
+        _mm256_storeu_pd(dst_buffer + 4, _mm256_mul_pd(
+            _mm256_cvtepi32_pd(_mm256_extracti128_si256(samples, 1)), vscale));
+    }
+
+    static forcedinline __m256i round_samples(
+        const float* src_buffer,
+        const integer_format<float>& format,
+        bool dither,
+        __m256i vindex)
+    {
+        __m256 value = _mm256_mul_ps(_mm256_loadu_ps(src_buffer), _mm256_set1_ps(format.range));
+
+        if (dither)
+        {
+            value = _mm256_add_ps(value, _mm256_mul_ps(
+                _mm256_cvtepi32_ps(tpdf_dither_epi32(vindex)), _mm256_set1_ps(1.0f / 65536.0f)));
+        }
+
+        const __m256 vmax = _mm256_set1_ps(format.max_value);
+        const __m256i saturated = _mm256_castps_si256(_mm256_cmp_ps(value, vmax, _CMP_GE_OQ));
+        const __m256i samples = _mm256_cvtps_epi32(
+            _mm256_min_ps(_mm256_max_ps(value, _mm256_set1_ps(format.min_value)), vmax));
+
+        return _mm256_blendv_epi8(samples, _mm256_set1_epi32(format.max_sample), saturated);
+    }
+
+    static forcedinline __m256i round_samples(
+        const double* src_buffer,
+        const integer_format<double>& format,
+        bool dither,
+        __m256i vindex)
+    {
+        const __m256d vscale = _mm256_set1_pd(format.range);
+        const __m256d vmin = _mm256_set1_pd(format.min_value);
+        const __m256d vmax = _mm256_set1_pd(format.max_value);
+
+        __m256d lo = _mm256_mul_pd(_mm256_loadu_pd(src_buffer), vscale);
+        __m256d hi = _mm256_mul_pd(_mm256_loadu_pd(src_buffer + 4), vscale);
+
+        if (dither)
+        {
+            const __m256i noise = tpdf_dither_epi32(vindex);
+            const __m256d vdither = _mm256_set1_pd(1.0 / 65536.0);
+
+            lo = _mm256_add_pd(lo, _mm256_mul_pd(
+                _mm256_cvtepi32_pd(_mm256_castsi256_si128(noise)), vdither));
+            hi = _mm256_add_pd(hi, _mm256_mul_pd(
+                _mm256_cvtepi32_pd(_mm256_extracti128_si256(noise, 1)), vdither));
+        }
+
+        return _mm256_inserti128_si256(_mm256_castsi128_si256(
+            _mm256_cvtpd_epi32(_mm256_min_pd(_mm256_max_pd(lo, vmin), vmax))),
+            _mm256_cvtpd_epi32(_mm256_min_pd(_mm256_max_pd(hi, vmin), vmax)), 1);
+    }
+
+    static forcedinline __m256i tpdf_dither_epi32(__m256i vindex)
+    {
+        __m256i hash = _mm256_xor_si256(vindex, _mm256_srli_epi32(vindex, 16));
+        hash = _mm256_mullo_epi32(hash, _mm256_set1_epi32(0x7feb352d));
+        hash = _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 15));
+        hash = _mm256_mullo_epi32(hash, _mm256_set1_epi32((int32)0x846ca68bU));
+        hash = _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 16));
+
+        return _mm256_sub_epi32(_mm256_add_epi32(
+            _mm256_and_si256(hash, _mm256_set1_epi32(0xFFFF)), _mm256_srli_epi32(hash, 16)),
+            _mm256_set1_epi32(65535));
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline __m256i widen_lo_epi32(__m256i value)
+    {
+        return _mm256_cvtepi32_epi64(_mm256_castsi256_si128(value));
+    }
+
+    static forcedinline __m256i widen_hi_epi32(__m256i value)
+    {
+        return _mm256_cvtepi32_epi64(_mm256_extracti128_si256(value, 1));
+    }
+
+    static forcedinline __m256i sum_epi8(__m256i sum, __m256i value)
+    {
+        // bias to unsigned bytes for sad, then take the bias of 8 bytes back
+        const __m256i bias = _mm256_set1_epi8((char)0x80);
+        return _mm256_add_epi64(sum, _mm256_sub_epi64(
+            _mm256_sad_epu8(_mm256_xor_si256(value, bias), _mm256_setzero_si256()),
+            _mm256_set1_epi64x(8 * 128)));
+    }
+
+    static forcedinline __m256i sum_epu8(__m256i sum, __m256i value)
+    {
+        return _mm256_add_epi64(sum, _mm256_sad_epu8(value, _mm256_setzero_si256()));
+    }
+
+    static forcedinline __m256i sum_epi16(__m256i sum, __m256i value)
+    {
+        return sum_epi32(sum, _mm256_madd_epi16(value, _mm256_set1_epi16(1)));
+    }
+
+    static forcedinline __m256i sum_epu16(__m256i sum, __m256i value)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        return sum_epu32(sum, _mm256_add_epi32(
+            _mm256_unpacklo_epi16(value, zero), _mm256_unpackhi_epi16(value, zero)));
+    }
+
+    static forcedinline __m256i sum_epi32(__m256i sum, __m256i value)
+    {
+        return _mm256_add_epi64(sum,
+            _mm256_add_epi64(widen_lo_epi32(value), widen_hi_epi32(value)));
+    }
+
+    static forcedinline __m256i sum_epu32(__m256i sum, __m256i value)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        return _mm256_add_epi64(sum, _mm256_add_epi64(
+            _mm256_unpacklo_epi32(value, zero), _mm256_unpackhi_epi32(value, zero)));
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline __m256i dot_epi8(__m256i sum, __m256i a, __m256i b)
+    {
+        // pairs of 8 bit products can't overflow 32 bit lanes
+        return sum_epi32(sum, _mm256_add_epi32(
+            _mm256_madd_epi16(
+                _mm256_cvtepi8_epi16(_mm256_castsi256_si128(a)),
+                _mm256_cvtepi8_epi16(_mm256_castsi256_si128(b))),
+            _mm256_madd_epi16(
+                _mm256_cvtepi8_epi16(_mm256_extracti128_si256(a, 1)),
+                _mm256_cvtepi8_epi16(_mm256_extracti128_si256(b, 1)))));
+    }
+
+    static forcedinline __m256i dot_epu8(__m256i sum, __m256i a, __m256i b)
+    {
+        return sum_epu32(sum, _mm256_add_epi32(
+            _mm256_madd_epi16(
+                _mm256_cvtepu8_epi16(_mm256_castsi256_si128(a)),
+                _mm256_cvtepu8_epi16(_mm256_castsi256_si128(b))),
+            _mm256_madd_epi16(
+                _mm256_cvtepu8_epi16(_mm256_extracti128_si256(a, 1)),
+                _mm256_cvtepu8_epi16(_mm256_extracti128_si256(b, 1)))));
+    }
+
+    static forcedinline __m256i dot_epi16(__m256i sum, __m256i a, __m256i b)
+    {
+        // full 32 bit products, a pair of them could overflow so widen each
+        const __m256i lo = _mm256_mullo_epi16(a, b);
+        const __m256i hi = _mm256_mulhi_epi16(a, b);
+        return sum_epi32(sum_epi32(sum, _mm256_unpacklo_epi16(lo, hi)),
+            _mm256_unpackhi_epi16(lo, hi));
+    }
+
+    static forcedinline __m256i dot_epu16(__m256i sum, __m256i a, __m256i b)
+    {
+        const __m256i lo = _mm256_mullo_epi16(a, b);
+        const __m256i hi = _mm256_mulhi_epu16(a, b);
+        return sum_epu32(sum_epu32(sum, _mm256_unpacklo_epi16(lo, hi)),
+            _mm256_unpackhi_epi16(lo, hi));
+    }
+
+    static forcedinline __m256i dot_epi32(__m256i sum, __m256i a, __m256i b)
+    {
+        return _mm256_add_epi64(sum, _mm256_add_epi64(_mm256_mul_epi32(a, b),
+            _mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32))));
+    }
+
+    static forcedinline __m256i dot_epu32(__m256i sum, __m256i a, __m256i b)
+    {
+        return _mm256_add_epi64(sum, _mm256_add_epi64(_mm256_mul_epu32(a, b),
+            _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32))));
+    }
+
+    static forcedinline __m256i dot_epi64(__m256i sum, __m256i a, __m256i b)
+    {
+        return _mm256_add_epi64(sum, mullo_epi64(a, b));
+    }
+
+    static forcedinline uint64 reduce_epi64(__m256i sum)
+    {
+        uint64 lanes[4];
+        _mm256_storeu_si256((__m256i*)lanes, sum);
+        return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline __m256i min_epi64(__m256i a, __m256i b)
+    {
+        return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+    }
+
+    static forcedinline __m256i max_epi64(__m256i a, __m256i b)
+    {
+        return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b));
+    }
+
+    static forcedinline __m256i min_epu64(__m256i a, __m256i b)
+    {
+        const __m256i bias = _mm256_set1_epi64x((long long)0x8000000000000000ULL);
+        return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(
+            _mm256_xor_si256(a, bias), _mm256_xor_si256(b, bias)));
+    }
+
+    static forcedinline __m256i max_epu64(__m256i a, __m256i b)
+    {
+        const __m256i bias = _mm256_set1_epi64x((long long)0x8000000000000000ULL);
+        return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(
+            _mm256_xor_si256(a, bias), _mm256_xor_si256(b, bias)));
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline __m256i scale_epi32(__m256i value, __m256 vscale)
+    {
+        return _mm256_cvttps_epi32(
+            _mm256_mul_ps(_mm256_cvtepi32_ps(value), vscale));
+    }
+
+    static forcedinline __m256i scale_epi32(__m256i value, __m256d vscale)
+    {
+        const __m128i lo = _mm256_cvttpd_epi32(_mm256_mul_pd(
+            _mm256_cvtepi32_pd(_mm256_castsi256_si128(value)), vscale));
+        const __m128i hi = _mm256_cvttpd_epi32(_mm256_mul_pd(
+            _mm256_cvtepi32_pd(_mm256_extracti128_si256(value, 1)), vscale));
+
+        return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline __m256i scale_epu32(__m256i value, __m256 vscale)
+    {
+        // convert as unsigned splitting in two exact 16 bit halves
+        const __m256 vhi = _mm256_cvtepi32_ps(_mm256_srli_epi32(value, 16));
+        const __m256 vlo = _mm256_cvtepi32_ps(
+            _mm256_and_si256(value, _mm256_set1_epi32(0xFFFF)));
+        const __m256 vfloat = _mm256_add_ps(
+            _mm256_mul_ps(vhi, _mm256_set1_ps(65536.0f)), vlo);
+
+        return _mm256_cvttps_epi32(_mm256_mul_ps(vfloat, vscale));
+    }
+
+    static forcedinline __m256i scale_epu32(__m256i value, __m256d vscale)
+    {
+        const __m256d vmul = _mm256_set1_pd(65536.0);
+        const __m256i vhi = _mm256_srli_epi32(value, 16);
+        const __m256i vlo = _mm256_and_si256(value, _mm256_set1_epi32(0xFFFF));
+
+        const __m256d dlo = _mm256_add_pd(
+            _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(vhi)), vmul),
+            _mm256_cvtepi32_pd(_mm256_castsi256_si128(vlo)));
+        const __m256d dhi = _mm256_add_pd(
+            _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(vhi, 1)), vmul),
+            _mm256_cvtepi32_pd(_mm256_extracti128_si256(vlo, 1)));
+
+        const __m128i lo = _mm256_cvttpd_epi32(_mm256_mul_pd(dlo, vscale));
+        const __m128i hi = _mm256_cvttpd_epi32(_mm256_mul_pd(dhi, vscale));
+
+        return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline __m256i narrow_epi32_epi16(__m256i lo, __m256i hi)
+    {
+        // truncate like a static_cast, then fix the lane interleaving
+        const __m256i mask = _mm256_set1_epi32(0xFFFF);
+        const __m256i packed = _mm256_packus_epi32(
+            _mm256_and_si256(lo, mask), _mm256_and_si256(hi, mask));
+
+        return _mm256_permute4x64_epi64(packed, 0xD8);
+    }
+
+    static forcedinline __m256i narrow_epi16_epi8(__m256i lo, __m256i hi)
+    {
+        // truncate like a static_cast, then fix the lane interleaving
+        const __m256i mask = _mm256_set1_epi16(0x00FF);
+        const __m256i packed = _mm256_packus_epi16(
+            _mm256_and_si256(lo, mask), _mm256_and_si256(hi, mask));
+
+        return _mm256_permute4x64_epi64(packed, 0xD8);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    template<typename vector_type>
+    static forcedinline __m256i scale_vector_int8(__m256i value, vector_type vscale)
+    {
+        const __m128i lo = _mm256_castsi256_si128(value);
+        const __m128i hi = _mm256_extracti128_si256(value, 1);
+
+        return narrow_epi16_epi8(
+            narrow_epi32_epi16(
+                scale_epi32(_mm256_cvtepi8_epi32(lo), vscale),
+                scale_epi32(_mm256_cvtepi8_epi32(_mm_srli_si128(lo, 8)), vscale)),
+            narrow_epi32_epi16(
+                scale_epi32(_mm256_cvtepi8_epi32(hi), vscale),
+                scale_epi32(_mm256_cvtepi8_epi32(_mm_srli_si128(hi, 8)), vscale)));
+    }
+
+    template<typename vector_type>
+    static forcedinline __m256i scale_vector_uint8(__m256i value, vector_type vscale)
+    {
+        const __m128i lo = _mm256_castsi256_si128(value);
+        const __m128i hi = _mm256_extracti128_si256(value, 1);
+
+        return narrow_epi16_epi8(
+            narrow_epi32_epi16(
+                scale_epi32(_mm256_cvtepu8_epi32(lo), vscale),
+                scale_epi32(_mm256_cvtepu8_epi32(_mm_srli_si128(lo, 8)), vscale)),
+            narrow_epi32_epi16(
+                scale_epi32(_mm256_cvtepu8_epi32(hi), vscale),
+                scale_epi32(_mm256_cvtepu8_epi32(_mm_srli_si128(hi, 8)), vscale)));
+    }
+
+    template<typename vector_type>
+    static forcedinline __m256i scale_vector_int16(__m256i value, vector_type vscale)
+    {
+        return narrow_epi32_epi16(
+            scale_epi32(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(value)), vscale),
+            scale_epi32(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(value, 1)), vscale));
+    }
+
+    template<typename vector_type>
+    static forcedinline __m256i scale_vector_uint16(__m256i value, vector_type vscale)
+    {
+        return narrow_epi32_epi16(
+            scale_epi32(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(value)), vscale),
+            scale_epi32(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(value, 1)), vscale));
+    }
+
+    template<typename vector_type>
+    static forcedinline __m256i scale_vector_int32(__m256i value, vector_type vscale)
+    {
+        return scale_epi32(value, vscale);
+    }
+
+    template<typename vector_type>
+    static forcedinline __m256i scale_vector_uint32(__m256i value, vector_type vscale)
+    {
+        return scale_epu32(value, vscale);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // the products are clamped to the range of the datatype before being
+    // truncated, so the saturating packs never clamp anything else, they only
+    // leave the lanes interleaved
+
+    static forcedinline __m256i scale_saturate_epi32(__m256i value, __m256 vscale, float lowest, float highest)
+    {
+        return _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(
+            _mm256_mul_ps(_mm256_cvtepi32_ps(value), vscale), _mm256_set1_ps(lowest)), _mm256_set1_ps(highest)));
+    }
+
+    static forcedinline __m256i scale_saturate_vector_int8(__m256i value, __m256 vscale)
+    {
+        const __m128i lo = _mm256_castsi256_si128(value);
+        const __m128i hi = _mm256_extracti128_si256(value, 1);
+
+        const __m256i packed_lo = _mm256_permute4x64_epi64(_mm256_packs_epi32(
+            scale_saturate_epi32(_mm256_cvtepi8_epi32(lo), vscale, -128.0f, 127.0f),
+            scale_saturate_epi32(_mm256_cvtepi8_epi32(_mm_srli_si128(lo, 8)), vscale, -128.0f, 127.0f)), 0xD8);
+        const __m256i packed_hi = _mm256_permute4x64_epi64(_mm256_packs_epi32(
+            scale_saturate_epi32(_mm256_cvtepi8_epi32(hi), vscale, -128.0f, 127.0f),
+            scale_saturate_epi32(_mm256_cvtepi8_epi32(_mm_srli_si128(hi, 8)), vscale, -128.0f, 127.0f)), 0xD8);
+
+        return _mm256_permute4x64_epi64(_mm256_packs_epi16(packed_lo, packed_hi), 0xD8);
+    }
+
+    static forcedinline __m256i scale_saturate_vector_uint8(__m256i value, __m256 vscale)
+    {
+        const __m128i lo = _mm256_castsi256_si128(value);
+        const __m128i hi = _mm256_extracti128_si256(value, 1);
+
+        const __m256i packed_lo = _mm256_permute4x64_epi64(_mm256_packs_epi32(
+            scale_saturate_epi32(_mm256_cvtepu8_epi32(lo), vscale, 0.0f, 255.0f),
+            scale_saturate_epi32(_mm256_cvtepu8_epi32(_mm_srli_si128(lo, 8)), vscale, 0.0f, 255.0f)), 0xD8);
+        const __m256i packed_hi = _mm256_permute4x64_epi64(_mm256_packs_epi32(
+            scale_saturate_epi32(_mm256_cvtepu8_epi32(hi), vscale, 0.0f, 255.0f),
+            scale_saturate_epi32(_mm256_cvtepu8_epi32(_mm_srli_si128(hi, 8)), vscale, 0.0f, 255.0f)), 0xD8);
+
+        return _mm256_permute4x64_epi64(_mm256_packus_epi16(packed_lo, packed_hi), 0xD8);
+    }
+
+    static forcedinline __m256i scale_saturate_vector_int16(__m256i value, __m256 vscale)
+    {
+        return _mm256_permute4x64_epi64(_mm256_packs_epi32(
+            scale_saturate_epi32(_mm256_cvtepi16_epi32(
+                _mm256_castsi256_si128(value)), vscale, -32768.0f, 32767.0f),
+            scale_saturate_epi32(_mm256_cvtepi16_epi32(
+                _mm256_extracti128_si256(value, 1)), vscale, -32768.0f, 32767.0f)), 0xD8);
+    }
+
+    static forcedinline __m256i scale_saturate_vector_uint16(__m256i value, __m256 vscale)
+    {
+        return _mm256_permute4x64_epi64(_mm256_packus_epi32(
+            scale_saturate_epi32(_mm256_cvtepu16_epi32(
+                _mm256_castsi256_si128(value)), vscale, 0.0f, 65535.0f),
+            scale_saturate_epi32(_mm256_cvtepu16_epi32(
+                _mm256_extracti128_si256(value, 1)), vscale, 0.0f, 65535.0f)), 0xD8);
+    }
+
+    static forcedinline __m256i avg_epi8(__m256i a, __m256i b)
+    {
+        // pavgb only exists for unsigned lanes, bias the signed ones around it
+        const __m256i bias = _mm256_set1_epi8((char)0x80);
+        return _mm256_xor_si256(_mm256_avg_epu8(
+            _mm256_xor_si256(a, bias), _mm256_xor_si256(b, bias)), bias);
+    }
+
+    static forcedinline __m256i avg_epi16(__m256i a, __m256i b)
+    {
+        const __m256i bias = _mm256_set1_epi16((short)0x8000);
+        return _mm256_xor_si256(_mm256_avg_epu16(
+            _mm256_xor_si256(a, bias), _mm256_xor_si256(b, bias)), bias);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // the colour helpers of sse2, working on each half of the registers
+
+    static forcedinline __m256i color_weights_epi16(int16 red, int16 green, int16 blue)
+    {
+        return _mm256_set1_epi64x((long long)(((uint64)(uint16)blue << 32) | ((uint64)(uint16)green << 16) | (uint16)red));
+    }
+
+    static forcedinline __m256i weight_pixels_epi32(__m256i lo, __m256i hi, __m256i weights)
+    {
+        const __m256 a = _mm256_castsi256_ps(_mm256_madd_epi16(lo, weights));
+        const __m256 b = _mm256_castsi256_ps(_mm256_madd_epi16(hi, weights));
+
+        return _mm256_add_epi32(_mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))),
+            _mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))));
+    }
+
+    static forcedinline __m256i block_sums_epi16(__m256i pixels, __m256i next_pixels)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i lo = _mm256_add_epi16(_mm256_unpacklo_epi8(pixels, zero), _mm256_unpacklo_epi8(next_pixels, zero));
+        const __m256i hi = _mm256_add_epi16(_mm256_unpackhi_epi8(pixels, zero), _mm256_unpackhi_epi8(next_pixels, zero));
+
+        return _mm256_add_epi16(_mm256_unpacklo_epi64(lo, hi), _mm256_unpackhi_epi64(lo, hi));
+    }
+
+    // the packs leave each half with every other group of four values
+    static forcedinline __m256i pack_epi32_epi8(const __m256i* values)
+    {
+        return _mm256_packus_epi16(_mm256_packs_epi32(values[0], values[1]), _mm256_packs_epi32(values[2], values[3]));
+    }
+
+    static forcedinline __m256i reorder_epi8(__m256i packed)
+    {
+        return _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+    }
+
+    static forcedinline __m256i rgb_channel_epi8(const __m256i* luma, const __m256i* chroma, __m256i weights)
+    {
+        __m256i channel[4];
+        for (uint32 j = 0; j < 4; ++j)
+            channel[j] = _mm256_srai_epi32(_mm256_add_epi32(luma[j], _mm256_madd_epi16(chroma[j], weights)), 13);
+
+        return pack_epi32_epi8(channel);
+    }
+
+    static forcedinline __m256i rgba_channel_epi8(const __m256i* pixels, int shift)
+    {
+        const __m256i mask = _mm256_set1_epi32(0xFF);
+        const __m128i count = _mm_cvtsi32_si128(shift);
+
+        __m256i channel[4];
+        for (uint32 j = 0; j < 4; ++j)
+            channel[j] = _mm256_and_si256(_mm256_srl_epi32(pixels[j], count), mask);
+
+        return reorder_epi8(pack_epi32_epi8(channel));
+    }
+
+    // the unpacks interleave pixels 0..7 with 16..23 and 8..15 with 24..31
+    static forcedinline void store_rgba_epi8(uint8* dst_buffer, __m256i red, __m256i green, __m256i blue, __m256i alpha)
+    {
+        const __m256i rg_lo = _mm256_unpacklo_epi8(red, green);
+        const __m256i rg_hi = _mm256_unpackhi_epi8(red, green);
+        const __m256i ba_lo = _mm256_unpacklo_epi8(blue, alpha);
+        const __m256i ba_hi = _mm256_unpackhi_epi8(blue, alpha);
+
+        const __m256i p0 = _mm256_unpacklo_epi16(rg_lo, ba_lo);
+        const __m256i p1 = _mm256_unpackhi_epi16(rg_lo, ba_lo);
+        const __m256i p2 = _mm256_unpacklo_epi16(rg_hi, ba_hi);
+        const __m256i p3 = _mm256_unpackhi_epi16(rg_hi, ba_hi);
+
+        _mm256_storeu_si256((__m256i*)(dst_buffer + 0), _mm256_permute2x128_si256(p0, p1, 0x20));
+        _mm256_storeu_si256((__m256i*)(dst_buffer + 32), _mm256_permute2x128_si256(p2, p3, 0x20));
+        _mm256_storeu_si256((__m256i*)(dst_buffer + 64), _mm256_permute2x128_si256(p0, p1, 0x31));
+        _mm256_storeu_si256((__m256i*)(dst_buffer + 96), _mm256_permute2x128_si256(p2, p3, 0x31));
+    }
+
 };
 
 
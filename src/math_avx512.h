@@ -0,0 +1,3006 @@
+/*
+ * waterspout
+ *
+ *   - simd abstraction library for audio/image manipulation -
+ *
+ * Copyright (c) 2015 Lucio Asnaghi
+ *
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __WATERSPOUT_SIMD_ABSTRACTION_FRAMEWORK_MATH_AVX512_H__
+#define __WATERSPOUT_SIMD_ABSTRACTION_FRAMEWORK_MATH_AVX512_H__
+
+
+//==============================================================================
+
+//------------------------------------------------------------------------------
+
+/**
+ * Specific AVX-512 math class elaborating on __m512 / __m512d / __m512i
+ * buffers (requires AVX512F, AVX512BW and AVX512DQ).
+ *
+ * Instead of falling back to scalar code, the unaligned head and the tail of
+ * a buffer are processed with a single masked vector operation each, so short
+ * buffers never pay for per element loops. Source buffers are read unaligned,
+ * only the destination buffer is brought to the vector alignment.
+ */
+
+class math_avx512 : public math_avx2
+{
+public:
+
+    //--------------------------------------------------------------------------
+
+    const char* name() const { return "AVX512"; }
+
+
+    //--------------------------------------------------------------------------
+
+    enum AVX512MathDefines
+    {
+        AVX512_ALIGN = 0x3F
+    };
+
+
+    //--------------------------------------------------------------------------
+
+    math_avx512()
+    {
+        //assertfalse; // not implemented !
+    }
+
+
+    //==========================================================================
+
+    //--------------------------------------------------------------------------
+
+    #define math_avx512_set_buffer_impl(datatype, mask_type, vector_type, vector_set) \
+        void set_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            datatype value) const \
+        { \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)src_buffer & AVX512_ALIGN); \
+            \
+            const vector_type vvalue = vector_set; \
+            \
+            /* Set unaligned head with a mask */ \
+            uint32 head_count = (uint32)(((AVX512_ALIGN + 1) - align_bytes) \
+                & AVX512_ALIGN) / sizeof(datatype); \
+            if (head_count > size) \
+                head_count = size; \
+            \
+            if (head_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(head_count); \
+                store_vector_masked(src_buffer, mask, vvalue); \
+                \
+                src_buffer += head_count; \
+                size -= head_count; \
+            } \
+            \
+            /* Set with simd */ \
+            uint32 vector_count = size / vector_size; \
+            while (vector_count--) \
+            { \
+                store_vector(src_buffer, vvalue); \
+                \
+                src_buffer += vector_size; \
+            } \
+            \
+            /* Set leftovers with a mask */ \
+            const uint32 tail_count = size & (vector_size - 1); \
+            if (tail_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(tail_count); \
+                store_vector_masked(src_buffer, mask, vvalue); \
+            } \
+        } \
+        \
+        void clear_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size) const \
+        { \
+            math_avx512::set_buffer_ ##datatype (src_buffer, size, datatype(0)); \
+        }
+
+    #define math_avx512_scale_buffer_impl(datatype, mask_type, gaintype, vector_scale_type, vector_scale_set) \
+        void scale_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            gaintype gain) const \
+        { \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)src_buffer & AVX512_ALIGN); \
+            \
+            const vector_scale_type vscale = vector_scale_set; \
+            \
+            /* Scale unaligned head with a mask */ \
+            uint32 head_count = (uint32)(((AVX512_ALIGN + 1) - align_bytes) \
+                & AVX512_ALIGN) / sizeof(datatype); \
+            if (head_count > size) \
+                head_count = size; \
+            \
+            if (head_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(head_count); \
+                store_vector_masked(src_buffer, mask, scale_vector_ ##datatype ( \
+                    load_vector_masked(src_buffer, mask), vscale)); \
+                \
+                src_buffer += head_count; \
+                size -= head_count; \
+            } \
+            \
+            /* Scale with simd */ \
+            uint32 vector_count = size / vector_size; \
+            while (vector_count--) \
+            { \
+                store_vector(src_buffer, scale_vector_ ##datatype ( \
+                    load_vector(src_buffer), vscale)); \
+                \
+                src_buffer += vector_size; \
+            } \
+            \
+            /* Scale leftovers with a mask */ \
+            const uint32 tail_count = size & (vector_size - 1); \
+            if (tail_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(tail_count); \
+                store_vector_masked(src_buffer, mask, scale_vector_ ##datatype ( \
+                    load_vector_masked(src_buffer, mask), vscale)); \
+            } \
+        }
+
+    #define math_avx512_copy_buffer_impl(datatype, mask_type) \
+        void copy_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_buffer & AVX512_ALIGN); \
+            \
+            /* Copy unaligned head with a mask */ \
+            uint32 head_count = (uint32)(((AVX512_ALIGN + 1) - align_bytes) \
+                & AVX512_ALIGN) / sizeof(datatype); \
+            if (head_count > size) \
+                head_count = size; \
+            \
+            if (head_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(head_count); \
+                store_vector_masked(dst_buffer, mask, \
+                    load_vector_masked(src_buffer, mask)); \
+                \
+                src_buffer += head_count; \
+                dst_buffer += head_count; \
+                size -= head_count; \
+            } \
+            \
+            /* Copy with simd */ \
+            uint32 vector_count = size / vector_size; \
+            while (vector_count--) \
+            { \
+                store_vector(dst_buffer, load_vector(src_buffer)); \
+                \
+                src_buffer += vector_size; \
+                dst_buffer += vector_size; \
+            } \
+            \
+            /* Copy leftovers with a mask */ \
+            const uint32 tail_count = size & (vector_size - 1); \
+            if (tail_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(tail_count); \
+                store_vector_masked(dst_buffer, mask, \
+                    load_vector_masked(src_buffer, mask)); \
+            } \
+        }
+
+    #define math_avx512_binary_buffers_impl(function, datatype, mask_type, vector_op, guard, load_masked_b) \
+        void function ##_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            guard \
+            \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_buffer & AVX512_ALIGN); \
+            \
+            /* Operate on unaligned head with a mask */ \
+            uint32 head_count = (uint32)(((AVX512_ALIGN + 1) - align_bytes) \
+                & AVX512_ALIGN) / sizeof(datatype); \
+            if (head_count > size) \
+                head_count = size; \
+            \
+            if (head_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(head_count); \
+                store_vector_masked(dst_buffer, mask, vector_op( \
+                    load_vector_masked(src_buffer_a, mask), \
+                    load_masked_b(src_buffer_b, mask))); \
+                \
+                src_buffer_a += head_count; \
+                src_buffer_b += head_count; \
+                dst_buffer += head_count; \
+                size -= head_count; \
+            } \
+            \
+            /* Operate with simd */ \
+            uint32 vector_count = size / vector_size; \
+            while (vector_count--) \
+            { \
+                store_vector(dst_buffer, vector_op( \
+                    load_vector(src_buffer_a), \
+                    load_vector(src_buffer_b))); \
+                \
+                src_buffer_a += vector_size; \
+                src_buffer_b += vector_size; \
+                dst_buffer += vector_size; \
+            } \
+            \
+            /* Operate on leftovers with a mask */ \
+            const uint32 tail_count = size & (vector_size - 1); \
+            if (tail_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(tail_count); \
+                store_vector_masked(dst_buffer, mask, vector_op( \
+                    load_vector_masked(src_buffer_a, mask), \
+                    load_masked_b(src_buffer_b, mask))); \
+            } \
+        }
+
+    #define math_avx512_multiply_add_buffers_impl(datatype, mask_type, vector_madd) \
+        void multiply_add_buffers_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* src_buffer_c, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_buffer & AVX512_ALIGN); \
+            \
+            /* Operate on unaligned head with a mask */ \
+            uint32 head_count = (uint32)(((AVX512_ALIGN + 1) - align_bytes) \
+                & AVX512_ALIGN) / sizeof(datatype); \
+            if (head_count > size) \
+                head_count = size; \
+            \
+            if (head_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(head_count); \
+                store_vector_masked(dst_buffer, mask, vector_madd( \
+                    load_vector_masked(src_buffer_a, mask), \
+                    load_vector_masked(src_buffer_b, mask), \
+                    load_vector_masked(src_buffer_c, mask))); \
+                \
+                src_buffer_a += head_count; \
+                src_buffer_b += head_count; \
+                src_buffer_c += head_count; \
+                dst_buffer += head_count; \
+                size -= head_count; \
+            } \
+            \
+            /* Operate with simd */ \
+            uint32 vector_count = size / vector_size; \
+            while (vector_count--) \
+            { \
+                store_vector(dst_buffer, vector_madd( \
+                    load_vector(src_buffer_a), \
+                    load_vector(src_buffer_b), \
+                    load_vector(src_buffer_c))); \
+                \
+                src_buffer_a += vector_size; \
+                src_buffer_b += vector_size; \
+                src_buffer_c += vector_size; \
+                dst_buffer += vector_size; \
+            } \
+            \
+            /* Operate on leftovers with a mask */ \
+            const uint32 tail_count = size & (vector_size - 1); \
+            if (tail_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(tail_count); \
+                store_vector_masked(dst_buffer, mask, vector_madd( \
+                    load_vector_masked(src_buffer_a, mask), \
+                    load_vector_masked(src_buffer_b, mask), \
+                    load_vector_masked(src_buffer_c, mask))); \
+            } \
+        }
+
+    #define math_avx512_scale_add_buffer_impl(datatype, mask_type, vector_type, vector_set, vector_madd) \
+        void scale_add_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype gain) const \
+        { \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_buffer & AVX512_ALIGN); \
+            const vector_type vgain = vector_set; \
+            \
+            /* Operate on unaligned head with a mask */ \
+            uint32 head_count = (uint32)(((AVX512_ALIGN + 1) - align_bytes) \
+                & AVX512_ALIGN) / sizeof(datatype); \
+            if (head_count > size) \
+                head_count = size; \
+            \
+            if (head_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(head_count); \
+                store_vector_masked(dst_buffer, mask, vector_madd( \
+                    load_vector_masked(src_buffer, mask), vgain, \
+                    load_vector_masked(dst_buffer, mask))); \
+                \
+                src_buffer += head_count; \
+                dst_buffer += head_count; \
+                size -= head_count; \
+            } \
+            \
+            /* Operate with simd */ \
+            uint32 vector_count = size / vector_size; \
+            while (vector_count--) \
+            { \
+                store_vector(dst_buffer, vector_madd( \
+                    load_vector(src_buffer), vgain, \
+                    load_vector(dst_buffer))); \
+                \
+                src_buffer += vector_size; \
+                dst_buffer += vector_size; \
+            } \
+            \
+            /* Operate on leftovers with a mask */ \
+            const uint32 tail_count = size & (vector_size - 1); \
+            if (tail_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(tail_count); \
+                store_vector_masked(dst_buffer, mask, vector_madd( \
+                    load_vector_masked(src_buffer, mask), vgain, \
+                    load_vector_masked(dst_buffer, mask))); \
+            } \
+        }
+
+    //--------------------------------------------------------------------------
+
+    #define math_avx512_ramp_scale_buffer_impl(datatype, mask_type, vector_type, vector_set, vector_loadu, vector_mul, vector_add) \
+        void ramp_scale_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            datatype start_gain, \
+            datatype end_gain) const \
+        { \
+            if (size == 0) \
+                return; \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)src_buffer & AVX512_ALIGN); \
+            \
+            datatype lanes[64 / sizeof(datatype)]; \
+            ramp_index_lanes(lanes, vector_size, 0); \
+            \
+            const vector_type vstart = vector_set(start_gain); \
+            const vector_type vincrement = \
+                vector_set(ramp_increment(start_gain, end_gain, size)); \
+            vector_type vindex = vector_loadu(lanes); \
+            \
+            /* Ramp unaligned head with a mask */ \
+            uint32 head_count = (uint32)(((AVX512_ALIGN + 1) - align_bytes) \
+                & AVX512_ALIGN) / sizeof(datatype); \
+            if (head_count > size) \
+                head_count = size; \
+            \
+            if (head_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(head_count); \
+                store_vector_masked(src_buffer, mask, vector_mul( \
+                    load_vector_masked(src_buffer, mask), \
+                    vector_add(vstart, vector_mul(vincrement, vindex)))); \
+                vindex = vector_add(vindex, vector_set((datatype)head_count)); \
+                \
+                src_buffer += head_count; \
+                size -= head_count; \
+            } \
+            \
+            /* Ramp with simd, the sample indices are advanced in registers */ \
+            const vector_type vstep = vector_set((datatype)vector_size); \
+            \
+            uint32 vector_count = size / vector_size; \
+            while (vector_count--) \
+            { \
+                store_vector(src_buffer, vector_mul(load_vector(src_buffer), \
+                    vector_add(vstart, vector_mul(vincrement, vindex)))); \
+                vindex = vector_add(vindex, vstep); \
+                \
+                src_buffer += vector_size; \
+            } \
+            \
+            /* Ramp leftovers with a mask */ \
+            const uint32 tail_count = size & (vector_size - 1); \
+            if (tail_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(tail_count); \
+                store_vector_masked(src_buffer, mask, vector_mul( \
+                    load_vector_masked(src_buffer, mask), \
+                    vector_add(vstart, vector_mul(vincrement, vindex)))); \
+            } \
+        }
+
+    #define math_avx512_exp_ramp_scale_buffer_impl(datatype, mask_type, vector_type, vector_set, vector_loadu, vector_mul) \
+        void exp_ramp_scale_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            datatype start_gain, \
+            datatype end_gain) const \
+        { \
+            if (! is_exp_ramp(start_gain, end_gain, size)) \
+            { \
+                ramp_scale_buffer_ ##datatype (src_buffer, size, start_gain, end_gain); \
+                return; \
+            } \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)src_buffer & AVX512_ALIGN); \
+            const double log_ratio = \
+                exp_ramp_log_ratio(start_gain, end_gain, size); \
+            \
+            /* lanes past the ones we compute must not overflow */ \
+            datatype lanes[64 / sizeof(datatype)] = { 0 }; \
+            uint32 index = 0; \
+            \
+            /* Ramp unaligned head with a mask */ \
+            uint32 head_count = (uint32)(((AVX512_ALIGN + 1) - align_bytes) \
+                & AVX512_ALIGN) / sizeof(datatype); \
+            if (head_count > size) \
+                head_count = size; \
+            \
+            if (head_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(head_count); \
+                exp_ramp_lanes(lanes, head_count, start_gain, log_ratio, 0); \
+                store_vector_masked(src_buffer, mask, vector_mul( \
+                    load_vector_masked(src_buffer, mask), vector_loadu(lanes))); \
+                \
+                src_buffer += head_count; \
+                size -= head_count; \
+                index = head_count; \
+            } \
+            \
+            /* Ramp with simd, the gains are multiplied in registers and put */ \
+            /* back on the exact curve at the start of every block */ \
+            const vector_type vstep = \
+                vector_set((datatype)std::exp(log_ratio * vector_size)); \
+            \
+            uint32 vector_count = size / vector_size; \
+            while (vector_count > 0) \
+            { \
+                uint32 block_count = vector_count < RAMP_BLOCK_SIZE / vector_size ? \
+                    vector_count : RAMP_BLOCK_SIZE / vector_size; \
+                vector_count -= block_count; \
+                \
+                exp_ramp_lanes(lanes, vector_size, start_gain, log_ratio, index); \
+                vector_type vgain = vector_loadu(lanes); \
+                index += block_count * vector_size; \
+                \
+                while (block_count--) \
+                { \
+                    store_vector(src_buffer, vector_mul(load_vector(src_buffer), vgain)); \
+                    vgain = vector_mul(vgain, vstep); \
+                    \
+                    src_buffer += vector_size; \
+                } \
+            } \
+            \
+            /* Ramp leftovers with a mask */ \
+            const uint32 tail_count = size & (vector_size - 1); \
+            if (tail_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(tail_count); \
+                exp_ramp_lanes(lanes, tail_count, start_gain, log_ratio, index); \
+                store_vector_masked(src_buffer, mask, vector_mul( \
+                    load_vector_masked(src_buffer, mask), vector_loadu(lanes))); \
+            } \
+        }
+
+
+    //--------------------------------------------------------------------------
+
+    #define math_avx512_mixing_kernels_impl(datatype, mask_type, vector_type, vector_set, vector_loadu, vector_mul, vector_add) \
+        void stereo_gain_buffers_ ##datatype ( \
+            datatype* src_left_buffer, \
+            datatype* src_right_buffer, \
+            datatype* dst_left_buffer, \
+            datatype* dst_right_buffer, \
+            uint32 size, \
+            datatype left_gain, \
+            datatype right_gain) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_left_buffer & AVX512_ALIGN); \
+            \
+            /* both destinations are stored aligned */ \
+            if (align_bytes != ((ptrdiff_t)dst_right_buffer & AVX512_ALIGN)) \
+            { \
+                math_avx2::stereo_gain_buffers_ ##datatype (src_left_buffer, src_right_buffer, \
+                    dst_left_buffer, dst_right_buffer, size, left_gain, right_gain); \
+                return; \
+            } \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            const vector_type vleft_gain = vector_set(left_gain); \
+            const vector_type vright_gain = vector_set(right_gain); \
+            \
+            /* Scale unaligned head with a mask */ \
+            uint32 head_count = (uint32)(((AVX512_ALIGN + 1) - align_bytes) \
+                & AVX512_ALIGN) / sizeof(datatype); \
+            if (head_count > size) \
+                head_count = size; \
+            \
+            if (head_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(head_count); \
+                const vector_type vleft = load_vector_masked(src_left_buffer, mask); \
+                const vector_type vright = load_vector_masked(src_right_buffer, mask); \
+                \
+                store_vector_masked(dst_left_buffer, mask, vector_mul(vleft, vleft_gain)); \
+                store_vector_masked(dst_right_buffer, mask, vector_mul(vright, vright_gain)); \
+                \
+                src_left_buffer += head_count; \
+                src_right_buffer += head_count; \
+                dst_left_buffer += head_count; \
+                dst_right_buffer += head_count; \
+                size -= head_count; \
+            } \
+            \
+            /* Scale both channels with simd */ \
+            uint32 vector_count = size / vector_size; \
+            while (vector_count--) \
+            { \
+                const vector_type vleft = load_vector(src_left_buffer); \
+                const vector_type vright = load_vector(src_right_buffer); \
+                \
+                store_vector(dst_left_buffer, vector_mul(vleft, vleft_gain)); \
+                store_vector(dst_right_buffer, vector_mul(vright, vright_gain)); \
+                \
+                src_left_buffer += vector_size; \
+                src_right_buffer += vector_size; \
+                dst_left_buffer += vector_size; \
+                dst_right_buffer += vector_size; \
+            } \
+            \
+            /* Scale leftovers with a mask */ \
+            const uint32 tail_count = size & (vector_size - 1); \
+            if (tail_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(tail_count); \
+                const vector_type vleft = load_vector_masked(src_left_buffer, mask); \
+                const vector_type vright = load_vector_masked(src_right_buffer, mask); \
+                \
+                store_vector_masked(dst_left_buffer, mask, vector_mul(vleft, vleft_gain)); \
+                store_vector_masked(dst_right_buffer, mask, vector_mul(vright, vright_gain)); \
+            } \
+        } \
+        \
+        void ramp_stereo_gain_buffers_ ##datatype ( \
+            datatype* src_left_buffer, \
+            datatype* src_right_buffer, \
+            datatype* dst_left_buffer, \
+            datatype* dst_right_buffer, \
+            uint32 size, \
+            datatype left_gain, \
+            datatype left_increment, \
+            datatype right_gain, \
+            datatype right_increment) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_left_buffer & AVX512_ALIGN); \
+            \
+            /* both destinations are stored aligned */ \
+            if (align_bytes != ((ptrdiff_t)dst_right_buffer & AVX512_ALIGN)) \
+            { \
+                math_avx2::ramp_stereo_gain_buffers_ ##datatype (src_left_buffer, src_right_buffer, \
+                    dst_left_buffer, dst_right_buffer, size, \
+                    left_gain, left_increment, right_gain, right_increment); \
+                return; \
+            } \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            \
+            datatype lanes[64 / sizeof(datatype)]; \
+            ramp_index_lanes(lanes, vector_size, 0); \
+            \
+            const vector_type vleft_gain = vector_set(left_gain); \
+            const vector_type vleft_increment = vector_set(left_increment); \
+            const vector_type vright_gain = vector_set(right_gain); \
+            const vector_type vright_increment = vector_set(right_increment); \
+            const vector_type vstep = vector_set((datatype)vector_size); \
+            vector_type vindex = vector_loadu(lanes); \
+            \
+            /* Ramp unaligned head with a mask */ \
+            uint32 head_count = (uint32)(((AVX512_ALIGN + 1) - align_bytes) \
+                & AVX512_ALIGN) / sizeof(datatype); \
+            if (head_count > size) \
+                head_count = size; \
+            \
+            if (head_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(head_count); \
+                const vector_type vleft = load_vector_masked(src_left_buffer, mask); \
+                const vector_type vright = load_vector_masked(src_right_buffer, mask); \
+                \
+                store_vector_masked(dst_left_buffer, mask, vector_mul(vleft, \
+                    vector_add(vleft_gain, vector_mul(vleft_increment, vindex)))); \
+                store_vector_masked(dst_right_buffer, mask, vector_mul(vright, \
+                    vector_add(vright_gain, vector_mul(vright_increment, vindex)))); \
+                vindex = vector_add(vindex, vector_set((datatype)head_count)); \
+                \
+                src_left_buffer += head_count; \
+                src_right_buffer += head_count; \
+                dst_left_buffer += head_count; \
+                dst_right_buffer += head_count; \
+                size -= head_count; \
+            } \
+            \
+            /* Ramp both channels with simd */ \
+            uint32 vector_count = size / vector_size; \
+            while (vector_count--) \
+            { \
+                const vector_type vleft = load_vector(src_left_buffer); \
+                const vector_type vright = load_vector(src_right_buffer); \
+                \
+                store_vector(dst_left_buffer, vector_mul(vleft, \
+                    vector_add(vleft_gain, vector_mul(vleft_increment, vindex)))); \
+                store_vector(dst_right_buffer, vector_mul(vright, \
+                    vector_add(vright_gain, vector_mul(vright_increment, vindex)))); \
+                vindex = vector_add(vindex, vstep); \
+                \
+                src_left_buffer += vector_size; \
+                src_right_buffer += vector_size; \
+                dst_left_buffer += vector_size; \
+                dst_right_buffer += vector_size; \
+            } \
+            \
+            /* Ramp leftovers with a mask */ \
+            const uint32 tail_count = size & (vector_size - 1); \
+            if (tail_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(tail_count); \
+                const vector_type vleft = load_vector_masked(src_left_buffer, mask); \
+                const vector_type vright = load_vector_masked(src_right_buffer, mask); \
+                \
+                store_vector_masked(dst_left_buffer, mask, vector_mul(vleft, \
+                    vector_add(vleft_gain, vector_mul(vleft_increment, vindex)))); \
+                store_vector_masked(dst_right_buffer, mask, vector_mul(vright, \
+                    vector_add(vright_gain, vector_mul(vright_increment, vindex)))); \
+            } \
+        } \
+        \
+        void mix_gain_buffers_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype gain_a, \
+            datatype gain_b) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_buffer & AVX512_ALIGN); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            const vector_type vgain_a = vector_set(gain_a); \
+            const vector_type vgain_b = vector_set(gain_b); \
+            \
+            /* Mix unaligned head with a mask */ \
+            uint32 head_count = (uint32)(((AVX512_ALIGN + 1) - align_bytes) \
+                & AVX512_ALIGN) / sizeof(datatype); \
+            if (head_count > size) \
+                head_count = size; \
+            \
+            if (head_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(head_count); \
+                store_vector_masked(dst_buffer, mask, vector_add( \
+                    vector_mul(load_vector_masked(src_buffer_a, mask), vgain_a), \
+                    vector_mul(load_vector_masked(src_buffer_b, mask), vgain_b))); \
+                \
+                src_buffer_a += head_count; \
+                src_buffer_b += head_count; \
+                dst_buffer += head_count; \
+                size -= head_count; \
+            } \
+            \
+            /* Mix with simd */ \
+            uint32 vector_count = size / vector_size; \
+            while (vector_count--) \
+            { \
+                store_vector(dst_buffer, vector_add( \
+                    vector_mul(load_vector(src_buffer_a), vgain_a), \
+                    vector_mul(load_vector(src_buffer_b), vgain_b))); \
+                \
+                src_buffer_a += vector_size; \
+                src_buffer_b += vector_size; \
+                dst_buffer += vector_size; \
+            } \
+            \
+            /* Mix leftovers with a mask */ \
+            const uint32 tail_count = size & (vector_size - 1); \
+            if (tail_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(tail_count); \
+                store_vector_masked(dst_buffer, mask, vector_add( \
+                    vector_mul(load_vector_masked(src_buffer_a, mask), vgain_a), \
+                    vector_mul(load_vector_masked(src_buffer_b, mask), vgain_b))); \
+            } \
+        } \
+        \
+        void ramp_mix_gain_buffers_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype gain_a, \
+            datatype increment_a, \
+            datatype gain_b, \
+            datatype increment_b) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_buffer & AVX512_ALIGN); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            \
+            datatype lanes[64 / sizeof(datatype)]; \
+            ramp_index_lanes(lanes, vector_size, 0); \
+            \
+            const vector_type vgain_a = vector_set(gain_a); \
+            const vector_type vincrement_a = vector_set(increment_a); \
+            const vector_type vgain_b = vector_set(gain_b); \
+            const vector_type vincrement_b = vector_set(increment_b); \
+            const vector_type vstep = vector_set((datatype)vector_size); \
+            vector_type vindex = vector_loadu(lanes); \
+            \
+            /* Mix unaligned head with a mask */ \
+            uint32 head_count = (uint32)(((AVX512_ALIGN + 1) - align_bytes) \
+                & AVX512_ALIGN) / sizeof(datatype); \
+            if (head_count > size) \
+                head_count = size; \
+            \
+            if (head_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(head_count); \
+                store_vector_masked(dst_buffer, mask, vector_add( \
+                    vector_mul(load_vector_masked(src_buffer_a, mask), \
+                        vector_add(vgain_a, vector_mul(vincrement_a, vindex))), \
+                    vector_mul(load_vector_masked(src_buffer_b, mask), \
+                        vector_add(vgain_b, vector_mul(vincrement_b, vindex))))); \
+                vindex = vector_add(vindex, vector_set((datatype)head_count)); \
+                \
+                src_buffer_a += head_count; \
+                src_buffer_b += head_count; \
+                dst_buffer += head_count; \
+                size -= head_count; \
+            } \
+            \
+            /* Mix with simd */ \
+            uint32 vector_count = size / vector_size; \
+            while (vector_count--) \
+            { \
+                store_vector(dst_buffer, vector_add( \
+                    vector_mul(load_vector(src_buffer_a), \
+                        vector_add(vgain_a, vector_mul(vincrement_a, vindex))), \
+                    vector_mul(load_vector(src_buffer_b), \
+                        vector_add(vgain_b, vector_mul(vincrement_b, vindex))))); \
+                vindex = vector_add(vindex, vstep); \
+                \
+                src_buffer_a += vector_size; \
+                src_buffer_b += vector_size; \
+                dst_buffer += vector_size; \
+            } \
+            \
+            /* Mix leftovers with a mask */ \
+            const uint32 tail_count = size & (vector_size - 1); \
+            if (tail_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(tail_count); \
+                store_vector_masked(dst_buffer, mask, vector_add( \
+                    vector_mul(load_vector_masked(src_buffer_a, mask), \
+                        vector_add(vgain_a, vector_mul(vincrement_a, vindex))), \
+                    vector_mul(load_vector_masked(src_buffer_b, mask), \
+                        vector_add(vgain_b, vector_mul(vincrement_b, vindex))))); \
+            } \
+        }
+
+
+    //--------------------------------------------------------------------------
+
+    #define math_avx512_sum_buffer_impl(datatype, accumtype, mask_type, accum_type, accum_zero, vector_sum, vector_reduce) \
+        accumtype sum_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size) const \
+        { \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)src_buffer & AVX512_ALIGN); \
+            \
+            accum_type vsum = accum_zero; \
+            accum_type vcompensation = accum_zero; \
+            \
+            /* Sum unaligned head with a mask, masked out lanes are zero */ \
+            uint32 head_count = (uint32)(((AVX512_ALIGN + 1) - align_bytes) \
+                & AVX512_ALIGN) / sizeof(datatype); \
+            if (head_count > size) \
+                head_count = size; \
+            \
+            if (head_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(head_count); \
+                vector_sum(vsum, vcompensation, load_vector_masked(src_buffer, mask)); \
+                \
+                src_buffer += head_count; \
+                size -= head_count; \
+            } \
+            \
+            /* Sum with simd */ \
+            uint32 vector_count = size / vector_size; \
+            while (vector_count--) \
+            { \
+                vector_sum(vsum, vcompensation, load_vector(src_buffer)); \
+                \
+                src_buffer += vector_size; \
+            } \
+            \
+            /* Sum leftovers with a mask */ \
+            const uint32 tail_count = size & (vector_size - 1); \
+            if (tail_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(tail_count); \
+                vector_sum(vsum, vcompensation, load_vector_masked(src_buffer, mask)); \
+            } \
+            \
+            return static_cast<accumtype>(vector_reduce(vsum, vcompensation)); \
+        }
+
+    #define math_avx512_dot_product_impl(datatype, accumtype, mask_type, accum_type, accum_zero, vector_dot, vector_reduce) \
+        accumtype dot_product_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            uint32 size) const \
+        { \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)src_buffer_a & AVX512_ALIGN); \
+            \
+            accum_type vsum = accum_zero; \
+            accum_type vcompensation = accum_zero; \
+            \
+            /* Multiply and sum unaligned head with a mask */ \
+            uint32 head_count = (uint32)(((AVX512_ALIGN + 1) - align_bytes) \
+                & AVX512_ALIGN) / sizeof(datatype); \
+            if (head_count > size) \
+                head_count = size; \
+            \
+            if (head_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(head_count); \
+                vector_dot(vsum, vcompensation, \
+                    load_vector_masked(src_buffer_a, mask), \
+                    load_vector_masked(src_buffer_b, mask)); \
+                \
+                src_buffer_a += head_count; \
+                src_buffer_b += head_count; \
+                size -= head_count; \
+            } \
+            \
+            /* Multiply and sum with simd */ \
+            uint32 vector_count = size / vector_size; \
+            while (vector_count--) \
+            { \
+                vector_dot(vsum, vcompensation, \
+                    load_vector(src_buffer_a), \
+                    load_vector(src_buffer_b)); \
+                \
+                src_buffer_a += vector_size; \
+                src_buffer_b += vector_size; \
+            } \
+            \
+            /* Multiply and sum leftovers with a mask */ \
+            const uint32 tail_count = size & (vector_size - 1); \
+            if (tail_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(tail_count); \
+                vector_dot(vsum, vcompensation, \
+                    load_vector_masked(src_buffer_a, mask), \
+                    load_vector_masked(src_buffer_b, mask)); \
+            } \
+            \
+            return static_cast<accumtype>(vector_reduce(vsum, vcompensation)); \
+        }
+
+    #define math_avx512_extreme_buffer_impl(function, datatype, mask_type, vector_type, op, vector_set, vector_op) \
+        datatype function ##_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            uint32* index) const \
+        { \
+            if (size == 0) \
+            { \
+                return math_avx2::function ##_ ##datatype (src_buffer, size, index); \
+            } \
+            \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)src_buffer & AVX512_ALIGN); \
+            \
+            datatype* const buffer = src_buffer; \
+            const uint32 buffer_size = size; \
+            datatype result = *src_buffer; \
+            vector_type vresult = vector_set; \
+            \
+            /* Compare unaligned head with a mask, masked out lanes keep the result */ \
+            uint32 head_count = (uint32)(((AVX512_ALIGN + 1) - align_bytes) \
+                & AVX512_ALIGN) / sizeof(datatype); \
+            if (head_count > size) \
+                head_count = size; \
+            \
+            if (head_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(head_count); \
+                vresult = vector_op(load_vector_merged(src_buffer, mask, vresult), vresult); \
+                \
+                src_buffer += head_count; \
+                size -= head_count; \
+            } \
+            \
+            /* Compare with simd */ \
+            uint32 vector_count = size / vector_size; \
+            while (vector_count--) \
+            { \
+                vresult = vector_op(load_vector(src_buffer), vresult); \
+                \
+                src_buffer += vector_size; \
+            } \
+            \
+            /* Compare leftovers with a mask */ \
+            const uint32 tail_count = size & (vector_size - 1); \
+            if (tail_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(tail_count); \
+                vresult = vector_op(load_vector_merged(src_buffer, mask, vresult), vresult); \
+            } \
+            \
+            datatype lanes[64 / sizeof(datatype)]; \
+            memcpy(lanes, &vresult, sizeof(vresult)); \
+            for (uint32 i = 0; i < vector_size; ++i) \
+            { \
+                if (lanes[i] op result) \
+                    result = lanes[i]; \
+            } \
+            \
+            if (index != nullptr) \
+                *index = index_of_value(buffer, buffer_size, result); \
+            \
+            return result; \
+        }
+
+    #define math_avx512_peak_abs_buffer_impl(datatype, mask_type, vector_type, vector_zero, vector_peak) \
+        double peak_abs_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size) const \
+        { \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)src_buffer & AVX512_ALIGN); \
+            \
+            vector_type vresult = vector_zero; \
+            \
+            /* Compare unaligned head with a mask, masked out lanes are zero */ \
+            uint32 head_count = (uint32)(((AVX512_ALIGN + 1) - align_bytes) \
+                & AVX512_ALIGN) / sizeof(datatype); \
+            if (head_count > size) \
+                head_count = size; \
+            \
+            if (head_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(head_count); \
+                vresult = vector_peak(load_vector_masked(src_buffer, mask), vresult); \
+                \
+                src_buffer += head_count; \
+                size -= head_count; \
+            } \
+            \
+            /* Compare with simd */ \
+            uint32 vector_count = size / vector_size; \
+            while (vector_count--) \
+            { \
+                vresult = vector_peak(load_vector(src_buffer), vresult); \
+                \
+                src_buffer += vector_size; \
+            } \
+            \
+            /* Compare leftovers with a mask */ \
+            const uint32 tail_count = size & (vector_size - 1); \
+            if (tail_count > 0) \
+            { \
+                const mask_type mask = (mask_type)lanes_mask(tail_count); \
+                vresult = vector_peak(load_vector_masked(src_buffer, mask), vresult); \
+            } \
+            \
+            datatype lanes[64 / sizeof(datatype)]; \
+            memcpy(lanes, &vresult, sizeof(vresult)); \
+            \
+            datatype result = 0; \
+            for (uint32 i = 0; i < vector_size; ++i) \
+            { \
+                if (lanes[i] > result) \
+                    result = lanes[i]; \
+            } \
+            \
+            return result; \
+        }
+
+    #define math_avx512_reduction_functions_impl(datatype, accumtype, mask_type, vector_type, vector_set, sum, dot, min, max) \
+        math_avx512_sum_buffer_impl(datatype, accumtype, mask_type, __m512i, _mm512_setzero_si512(), sum, reduce_epi64) \
+        math_avx512_dot_product_impl(datatype, accumtype, mask_type, __m512i, _mm512_setzero_si512(), dot, reduce_epi64) \
+        math_avx512_extreme_buffer_impl(min_buffer, datatype, mask_type, vector_type, <, vector_set, min) \
+        math_avx512_extreme_buffer_impl(max_buffer, datatype, mask_type, vector_type, >, vector_set, max)
+
+    //--------------------------------------------------------------------------
+
+    #define math_avx512_common_functions_impl(datatype, mask_type, vector_type, vector_set, add, sub, mul, div) \
+        math_avx512_set_buffer_impl(datatype, mask_type, vector_type, vector_set) \
+        math_avx512_copy_buffer_impl(datatype, mask_type) \
+        math_avx512_binary_buffers_impl(add_buffers, datatype, mask_type, add, \
+            /* no guard */, load_vector_masked) \
+        math_avx512_binary_buffers_impl(subtract_buffers, datatype, mask_type, sub, \
+            /* no guard */, load_vector_masked) \
+        math_avx512_binary_buffers_impl(multiply_buffers, datatype, mask_type, mul, \
+            const disable_sse_denormals disable_denormals;, load_vector_masked) \
+        math_avx512_binary_buffers_impl(divide_buffers, datatype, mask_type, div, \
+            const disable_sse_denormals disable_denormals;, load_divisor_masked)
+
+    #define math_avx512_integer_scale_functions_impl(datatype, mask_type) \
+        math_avx512_scale_buffer_impl(datatype, mask_type, float, __m512, _mm512_set1_ps(gain)) \
+        math_avx512_scale_buffer_impl(datatype, mask_type, double, __m512d, _mm512_set1_pd(gain))
+
+
+    //==========================================================================
+
+    //--------------------------------------------------------------------------
+
+    math_avx512_common_functions_impl(int8, __mmask64, __m512i,
+        _mm512_set1_epi8(value),
+        _mm512_add_epi8, _mm512_sub_epi8, mullo_epi8, div_epi8)
+    math_avx512_common_functions_impl(uint8, __mmask64, __m512i,
+        _mm512_set1_epi8((char)value),
+        _mm512_add_epi8, _mm512_sub_epi8, mullo_epi8, div_epu8)
+    math_avx512_common_functions_impl(int16, __mmask32, __m512i,
+        _mm512_set1_epi16(value),
+        _mm512_add_epi16, _mm512_sub_epi16, _mm512_mullo_epi16, div_epi16)
+    math_avx512_common_functions_impl(uint16, __mmask32, __m512i,
+        _mm512_set1_epi16((short)value),
+        _mm512_add_epi16, _mm512_sub_epi16, _mm512_mullo_epi16, div_epu16)
+    math_avx512_common_functions_impl(int32, __mmask16, __m512i,
+        _mm512_set1_epi32(value),
+        _mm512_add_epi32, _mm512_sub_epi32, _mm512_mullo_epi32, div_epi32)
+    math_avx512_common_functions_impl(uint32, __mmask16, __m512i,
+        _mm512_set1_epi32((int)value),
+        _mm512_add_epi32, _mm512_sub_epi32, _mm512_mullo_epi32, div_epu32)
+    math_avx512_common_functions_impl(int64, __mmask8, __m512i,
+        _mm512_set1_epi64(value),
+        _mm512_add_epi64, _mm512_sub_epi64, _mm512_mullo_epi64, div_epi64)
+    math_avx512_common_functions_impl(uint64, __mmask8, __m512i,
+        _mm512_set1_epi64((long long)value),
+        _mm512_add_epi64, _mm512_sub_epi64, _mm512_mullo_epi64, div_epu64)
+    math_avx512_common_functions_impl(float, __mmask16, __m512,
+        _mm512_set1_ps(value),
+        _mm512_add_ps, _mm512_sub_ps, _mm512_mul_ps, _mm512_div_ps)
+    math_avx512_common_functions_impl(double, __mmask8, __m512d,
+        _mm512_set1_pd(value),
+        _mm512_add_pd, _mm512_sub_pd, _mm512_mul_pd, _mm512_div_pd)
+
+    math_avx512_integer_scale_functions_impl(int8, __mmask64)
+    math_avx512_integer_scale_functions_impl(uint8, __mmask64)
+    math_avx512_integer_scale_functions_impl(int16, __mmask32)
+    math_avx512_integer_scale_functions_impl(uint16, __mmask32)
+    math_avx512_integer_scale_functions_impl(int32, __mmask16)
+    math_avx512_integer_scale_functions_impl(uint32, __mmask16)
+    math_avx512_integer_scale_functions_impl(int64, __mmask8)
+    math_avx512_integer_scale_functions_impl(uint64, __mmask8)
+
+    math_avx512_scale_buffer_impl(float, __mmask16, float, __m512, _mm512_set1_ps(gain))
+    math_avx512_scale_buffer_impl(float, __mmask16, double, __m512, _mm512_set1_ps((float)gain))
+    math_avx512_scale_buffer_impl(double, __mmask8, float, __m512d, _mm512_set1_pd((double)gain))
+    math_avx512_scale_buffer_impl(double, __mmask8, double, __m512d, _mm512_set1_pd(gain))
+
+    // fused multiply add rounds once, so results can differ from the non fma
+    // backends in the last bit
+    math_avx512_multiply_add_buffers_impl(float, __mmask16, _mm512_fmadd_ps)
+    math_avx512_multiply_add_buffers_impl(double, __mmask8, _mm512_fmadd_pd)
+
+    math_avx512_scale_add_buffer_impl(float, __mmask16, __m512, _mm512_set1_ps(gain), _mm512_fmadd_ps)
+    math_avx512_scale_add_buffer_impl(double, __mmask8, __m512d, _mm512_set1_pd(gain), _mm512_fmadd_pd)
+
+    math_avx512_ramp_scale_buffer_impl(float, __mmask16, __m512, _mm512_set1_ps, _mm512_loadu_ps, _mm512_mul_ps, _mm512_add_ps)
+    math_avx512_ramp_scale_buffer_impl(double, __mmask8, __m512d, _mm512_set1_pd, _mm512_loadu_pd, _mm512_mul_pd, _mm512_add_pd)
+
+    math_avx512_exp_ramp_scale_buffer_impl(float, __mmask16, __m512, _mm512_set1_ps, _mm512_loadu_ps, _mm512_mul_ps)
+    math_avx512_exp_ramp_scale_buffer_impl(double, __mmask8, __m512d, _mm512_set1_pd, _mm512_loadu_pd, _mm512_mul_pd)
+
+    math_avx512_reduction_functions_impl(int8, int64, __mmask64, __m512i, _mm512_set1_epi8(result),
+        sum_epi8, dot_epi8, _mm512_min_epi8, _mm512_max_epi8)
+    math_avx512_reduction_functions_impl(uint8, uint64, __mmask64, __m512i, _mm512_set1_epi8((char)result),
+        sum_epu8, dot_epu8, _mm512_min_epu8, _mm512_max_epu8)
+    math_avx512_reduction_functions_impl(int16, int64, __mmask32, __m512i, _mm512_set1_epi16(result),
+        sum_epi16, dot_epi16, _mm512_min_epi16, _mm512_max_epi16)
+    math_avx512_reduction_functions_impl(uint16, uint64, __mmask32, __m512i, _mm512_set1_epi16((short)result),
+        sum_epu16, dot_epu16, _mm512_min_epu16, _mm512_max_epu16)
+    math_avx512_reduction_functions_impl(int32, int64, __mmask16, __m512i, _mm512_set1_epi32(result),
+        sum_epi32, dot_epi32, _mm512_min_epi32, _mm512_max_epi32)
+    math_avx512_reduction_functions_impl(uint32, uint64, __mmask16, __m512i, _mm512_set1_epi32((int)result),
+        sum_epu32, dot_epu32, _mm512_min_epu32, _mm512_max_epu32)
+    math_avx512_reduction_functions_impl(int64, int64, __mmask8, __m512i, _mm512_set1_epi64(result),
+        sum_epi64, dot_epi64, _mm512_min_epi64, _mm512_max_epi64)
+    math_avx512_reduction_functions_impl(uint64, uint64, __mmask8, __m512i, _mm512_set1_epi64((long long)result),
+        sum_epi64, dot_epi64, _mm512_min_epu64, _mm512_max_epu64)
+
+    math_avx512_sum_buffer_impl(float, double, __mmask16, __m512, _mm512_setzero_ps(), kahan_add_ps, reduce_kahan_ps)
+    math_avx512_sum_buffer_impl(double, double, __mmask8, __m512d, _mm512_setzero_pd(), kahan_add_pd, reduce_kahan_pd)
+
+    math_avx512_dot_product_impl(float, double, __mmask16, __m512, _mm512_setzero_ps(), dot_ps, reduce_kahan_ps)
+    math_avx512_dot_product_impl(double, double, __mmask8, __m512d, _mm512_setzero_pd(), dot_pd, reduce_kahan_pd)
+
+    math_avx512_extreme_buffer_impl(min_buffer, float, __mmask16, __m512, <, _mm512_set1_ps(result), _mm512_min_ps)
+    math_avx512_extreme_buffer_impl(max_buffer, float, __mmask16, __m512, >, _mm512_set1_ps(result), _mm512_max_ps)
+    math_avx512_extreme_buffer_impl(min_buffer, double, __mmask8, __m512d, <, _mm512_set1_pd(result), _mm512_min_pd)
+    math_avx512_extreme_buffer_impl(max_buffer, double, __mmask8, __m512d, >, _mm512_set1_pd(result), _mm512_max_pd)
+
+    math_avx512_peak_abs_buffer_impl(float, __mmask16, __m512, _mm512_setzero_ps(), peak_ps)
+    math_avx512_peak_abs_buffer_impl(double, __mmask8, __m512d, _mm512_setzero_pd(), peak_pd)
+
+
+    //--------------------------------------------------------------------------
+
+    // the last group of channels is masked, so every channel stays in simd
+
+    #define math_avx512_biquad_bank_impl(datatype, mask_type, vector_type, vector_mul, vector_add, vector_sub) \
+        void process_biquad_bank_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 channels, \
+            uint32 frames, \
+            datatype* coefficients, \
+            datatype* state, \
+            uint32 sections) const \
+        { \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            \
+            /* Every lane runs the cascade of one channel, the groups are \
+               walked each frame so their recurrences overlap */ \
+            for (uint32 frame = 0; frame < frames; ++frame) \
+            { \
+                const datatype* src = src_buffer + frame * channels; \
+                datatype* dst = dst_buffer + frame * channels; \
+                \
+                for (uint32 c = 0; c < channels; c += vector_size) \
+                { \
+                    const mask_type mask = (mask_type)(channels - c < vector_size ? \
+                        lanes_mask(channels - c) : ~(uint64)0); \
+                    const datatype* coefficient = coefficients + c; \
+                    datatype* z = state + c; \
+                    vector_type value = load_vector_masked(src + c, mask); \
+                    \
+                    for (uint32 section = 0; section < sections; ++section) \
+                    { \
+                        const vector_type output = vector_add(vector_mul( \
+                            load_vector_masked(coefficient, mask), value), \
+                            load_vector_masked(z, mask)); \
+                        \
+                        store_vector_masked(z, mask, vector_add(vector_sub( \
+                            vector_mul(load_vector_masked(coefficient + channels, mask), value), \
+                            vector_mul(load_vector_masked(coefficient + 3 * channels, mask), output)), \
+                            load_vector_masked(z + channels, mask))); \
+                        store_vector_masked(z + channels, mask, vector_sub( \
+                            vector_mul(load_vector_masked(coefficient + 2 * channels, mask), value), \
+                            vector_mul(load_vector_masked(coefficient + 4 * channels, mask), output))); \
+                        value = output; \
+                        \
+                        coefficient += 5 * channels; \
+                        z += 2 * channels; \
+                    } \
+                    \
+                    store_vector_masked(dst + c, mask, value); \
+                } \
+            } \
+        }
+
+    math_avx512_biquad_bank_impl(float, __mmask16, __m512, _mm512_mul_ps, _mm512_add_ps, _mm512_sub_ps)
+    math_avx512_biquad_bank_impl(double, __mmask8, __m512d, _mm512_mul_pd, _mm512_add_pd, _mm512_sub_pd)
+
+
+    //--------------------------------------------------------------------------
+
+    #define math_avx512_polyphase_impl(datatype, vector_type, vector_zero, vector_loadu, vector_mul, vector_add, vector_reduce) \
+        void process_polyphase_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype* coefficients, \
+            uint32 taps, \
+            uint32* rows, \
+            uint32* offsets) const \
+        { \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            \
+            if (taps < vector_size) \
+            { \
+                math_avx2::process_polyphase_ ##datatype (src_buffer, dst_buffer, size, \
+                    coefficients, taps, rows, offsets); \
+            } \
+            else \
+            { \
+                const disable_sse_denormals disable_denormals; \
+                \
+                const uint32 vector_taps = taps - taps % vector_size; \
+                \
+                for (uint32 i = 0; i < size; ++i) \
+                { \
+                    const datatype* src = src_buffer + offsets[i]; \
+                    const datatype* coefficient = coefficients + rows[i] * taps; \
+                    vector_type sum = vector_zero; \
+                    \
+                    for (uint32 k = 0; k < vector_taps; k += vector_size) \
+                    { \
+                        sum = vector_add(sum, vector_mul(vector_loadu(coefficient + k), vector_loadu(src + k))); \
+                    } \
+                    \
+                    /* Handle the leftover taps */ \
+                    dst_buffer[i] = polyphase_row_generic(src, coefficient, vector_taps, taps, vector_reduce(sum)); \
+                } \
+            } \
+        }
+
+    math_avx512_polyphase_impl(float, __m512, _mm512_setzero_ps(), _mm512_loadu_ps, _mm512_mul_ps, _mm512_add_ps, reduce_add_ps)
+    math_avx512_polyphase_impl(double, __m512d, _mm512_setzero_pd(), _mm512_loadu_pd, _mm512_mul_pd, _mm512_add_pd, reduce_add_pd)
+
+
+    //--------------------------------------------------------------------------
+
+    #define math_avx512_envelope_bank_impl(datatype, vector_type, vector_loadu, vector_storeu, vector_add, vector_sub, vector_mul, vector_abs, vector_sqrt, vector_select_greater) \
+        void process_envelope_bank_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 channels, \
+            uint32 frames, \
+            datatype* coefficients, \
+            datatype* state, \
+            EnvelopeModeTypes mode) const \
+        { \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            \
+            if (channels < vector_size) \
+            { \
+                math_avx2::process_envelope_bank_ ##datatype (src_buffer, dst_buffer, channels, frames, \
+                    coefficients, state, mode); \
+            } \
+            else \
+            { \
+                const disable_sse_denormals disable_denormals; \
+                \
+                /* Every lane follows the envelope of one channel, all the groups of \
+                   channels are walked each frame as the biquad banks do */ \
+                const uint32 vector_channels = channels - channels % vector_size; \
+                \
+                for (uint32 frame = 0; frame < frames; ++frame) \
+                { \
+                    const datatype* src = src_buffer + frame * channels; \
+                    datatype* dst = dst_buffer + frame * channels; \
+                    \
+                    for (uint32 c = 0; c < vector_channels; c += vector_size) \
+                    { \
+                        const vector_type value = vector_loadu(src + c); \
+                        const vector_type level = mode == RMS_ENVELOPE ? vector_mul(value, value) : vector_abs(value); \
+                        vector_type envelope = vector_loadu(state + c); \
+                        \
+                        const vector_type coefficient = vector_select_greater(level, envelope, \
+                            vector_loadu(coefficients + c), vector_loadu(coefficients + channels + c)); \
+                        \
+                        envelope = vector_add(envelope, vector_mul(coefficient, vector_sub(level, envelope))); \
+                        \
+                        vector_storeu(state + c, envelope); \
+                        vector_storeu(dst + c, mode == RMS_ENVELOPE ? vector_sqrt(envelope) : envelope); \
+                    } \
+                } \
+                \
+                /* Handle the leftover channels */ \
+                envelope_bank_generic(src_buffer, dst_buffer, channels, frames, \
+                    coefficients, state, mode, vector_channels); \
+            } \
+        }
+
+    #define math_avx512_gain_functions_impl(datatype, vector_type, vector_set, vector_loadu, vector_storeu, vector_add, vector_sub, vector_mul, vector_div, vector_min, vector_max) \
+        void compressor_gain_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype threshold, \
+            datatype ratio, \
+            datatype knee) const \
+        { \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            \
+            assert(ratio > datatype(0)); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const datatype width = knee > datatype(0) ? knee : datatype(0); \
+            const vector_type vthreshold = vector_set(threshold); \
+            const vector_type vslope = vector_set(datatype(1) / ratio - datatype(1)); \
+            const vector_type vhalf_knee = vector_set(width * datatype(0.5)); \
+            const vector_type vwidth = vector_set(width); \
+            const vector_type vknee_scale = vector_set(knee > datatype(0) ? datatype(1) / (datatype(2) * knee) : datatype(0)); \
+            const vector_type vzero = vector_set(datatype(0)); \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            for (uint32 i = 0; i < vector_samples; i += vector_size) \
+            { \
+                const vector_type over = vector_sub(vector_loadu(src_buffer + i), vthreshold); \
+                const vector_type above = vector_max(vector_sub(over, vhalf_knee), vzero); \
+                const vector_type bent = vector_min(vector_max(vector_add(over, vhalf_knee), vzero), vwidth); \
+                \
+                vector_storeu(dst_buffer + i, vector_mul(vslope, \
+                    vector_add(vector_mul(vector_mul(bent, bent), vknee_scale), above))); \
+            } \
+            \
+            /* Handle the leftovers */ \
+            compressor_gain_generic(src_buffer, dst_buffer, size, threshold, ratio, knee, vector_samples); \
+        } \
+        \
+        void limiter_gain_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype threshold) const \
+        { \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            \
+            assert(threshold > datatype(0)); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const vector_type vthreshold = vector_set(threshold); \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            for (uint32 i = 0; i < vector_samples; i += vector_size) \
+            { \
+                vector_storeu(dst_buffer + i, vector_div(vthreshold, vector_max(vector_loadu(src_buffer + i), vthreshold))); \
+            } \
+            \
+            /* Handle the leftovers */ \
+            limiter_gain_generic(src_buffer, dst_buffer, size, threshold, vector_samples); \
+        } \
+        \
+        void soft_clip_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const vector_type vlimit = vector_set(datatype(3)); \
+            const vector_type vnegative_limit = vector_set(datatype(-3)); \
+            const vector_type vnumerator = vector_set(datatype(27)); \
+            const vector_type vdenominator = vector_set(datatype(9)); \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            for (uint32 i = 0; i < vector_samples; i += vector_size) \
+            { \
+                const vector_type value = vector_min(vector_max(vector_loadu(src_buffer + i), vnegative_limit), vlimit); \
+                const vector_type square = vector_mul(value, value); \
+                \
+                vector_storeu(dst_buffer + i, vector_div(vector_mul(value, vector_add(vnumerator, square)), \
+                    vector_add(vnumerator, vector_mul(vdenominator, square)))); \
+            } \
+            \
+            /* Handle the leftovers */ \
+            soft_clip_generic(src_buffer, dst_buffer, size, vector_samples); \
+        }
+
+    math_avx512_envelope_bank_impl(float, __m512, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_add_ps, _mm512_sub_ps, _mm512_mul_ps, _mm512_abs_ps, _mm512_sqrt_ps, select_greater_ps)
+    math_avx512_envelope_bank_impl(double, __m512d, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_add_pd, _mm512_sub_pd, _mm512_mul_pd, _mm512_abs_pd, _mm512_sqrt_pd, select_greater_pd)
+
+    math_avx512_gain_functions_impl(float, __m512, _mm512_set1_ps, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_add_ps, _mm512_sub_ps, _mm512_mul_ps, _mm512_div_ps, _mm512_min_ps, _mm512_max_ps)
+    math_avx512_gain_functions_impl(double, __m512d, _mm512_set1_pd, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_add_pd, _mm512_sub_pd, _mm512_mul_pd, _mm512_div_pd, _mm512_min_pd, _mm512_max_pd)
+
+
+    //--------------------------------------------------------------------------
+
+    // the exponents are applied with scalef and taken apart with getexp and
+    // getmant, so there is no need to split the scaling at the top of exp
+
+    #define math_avx512_transcendental_functions_impl(datatype, vector_type, vector_loadu, vector_storeu, vector_exp, vector_log, vector_sincos, vector_tanh, vector_pow) \
+        void exp_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_storeu(dst_buffer + i, vector_exp(vector_loadu(src_buffer + i), true)); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_storeu(dst_buffer + i, vector_exp(vector_loadu(src_buffer + i), false)); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            exp_generic(src_buffer, dst_buffer, size, accuracy, vector_samples); \
+        } \
+        \
+        void log_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_storeu(dst_buffer + i, vector_log(vector_loadu(src_buffer + i), true)); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_storeu(dst_buffer + i, vector_log(vector_loadu(src_buffer + i), false)); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            log_generic(src_buffer, dst_buffer, size, accuracy, vector_samples); \
+        } \
+        \
+        void sin_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_type sin_value, cos_value; \
+                    vector_sincos(vector_loadu(src_buffer + i), sin_value, cos_value, true); \
+                    vector_storeu(dst_buffer + i, sin_value); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_type sin_value, cos_value; \
+                    vector_sincos(vector_loadu(src_buffer + i), sin_value, cos_value, false); \
+                    vector_storeu(dst_buffer + i, sin_value); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            sincos_generic(src_buffer, dst_buffer, (datatype*)0, size, accuracy, vector_samples); \
+        } \
+        \
+        void cos_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_type sin_value, cos_value; \
+                    vector_sincos(vector_loadu(src_buffer + i), sin_value, cos_value, true); \
+                    vector_storeu(dst_buffer + i, cos_value); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_type sin_value, cos_value; \
+                    vector_sincos(vector_loadu(src_buffer + i), sin_value, cos_value, false); \
+                    vector_storeu(dst_buffer + i, cos_value); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            sincos_generic(src_buffer, (datatype*)0, dst_buffer, size, accuracy, vector_samples); \
+        } \
+        \
+        void sincos_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* sin_buffer, \
+            datatype* cos_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_type sin_value, cos_value; \
+                    vector_sincos(vector_loadu(src_buffer + i), sin_value, cos_value, true); \
+                    vector_storeu(sin_buffer + i, sin_value); \
+                    vector_storeu(cos_buffer + i, cos_value); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_type sin_value, cos_value; \
+                    vector_sincos(vector_loadu(src_buffer + i), sin_value, cos_value, false); \
+                    vector_storeu(sin_buffer + i, sin_value); \
+                    vector_storeu(cos_buffer + i, cos_value); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            sincos_generic(src_buffer, sin_buffer, cos_buffer, size, accuracy, vector_samples); \
+        } \
+        \
+        void tanh_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_storeu(dst_buffer + i, vector_tanh(vector_loadu(src_buffer + i), true)); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_storeu(dst_buffer + i, vector_tanh(vector_loadu(src_buffer + i), false)); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            tanh_generic(src_buffer, dst_buffer, size, accuracy, vector_samples); \
+        } \
+        \
+        void pow_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* exponent_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_storeu(dst_buffer + i, vector_pow(vector_loadu(src_buffer + i), \
+                        vector_loadu(exponent_buffer + i), true)); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_storeu(dst_buffer + i, vector_pow(vector_loadu(src_buffer + i), \
+                        vector_loadu(exponent_buffer + i), false)); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            pow_generic(src_buffer, exponent_buffer, dst_buffer, size, accuracy, vector_samples); \
+        }
+
+    math_avx512_transcendental_functions_impl(float, __m512, _mm512_loadu_ps, _mm512_storeu_ps, exp_ps, log_ps, sincos_ps, tanh_ps, pow_ps)
+    math_avx512_transcendental_functions_impl(double, __m512d, _mm512_loadu_pd, _mm512_storeu_pd, exp_pd, log_pd, sincos_pd, tanh_pd, pow_pd)
+
+
+protected:
+
+    //--------------------------------------------------------------------------
+
+    math_avx512_mixing_kernels_impl(float, __mmask16, __m512, _mm512_set1_ps, _mm512_loadu_ps, _mm512_mul_ps, _mm512_add_ps)
+    math_avx512_mixing_kernels_impl(double, __mmask8, __m512d, _mm512_set1_pd, _mm512_loadu_pd, _mm512_mul_pd, _mm512_add_pd)
+
+
+    //--------------------------------------------------------------------------
+
+    #define math_avx512_fft_radix4_pass_impl(datatype, vector_type, vector_loadu, vector_storeu, vector_mul, vector_add, vector_sub) \
+        void fft_radix4_pass_ ##datatype ( \
+            datatype* real_buffer, \
+            datatype* imag_buffer, \
+            uint32 size, \
+            uint32 span, \
+            const datatype* twiddles) const \
+        { \
+            const uint32 vector_size = 64 / sizeof(datatype); \
+            \
+            if (span < vector_size) \
+            { \
+                math_avx2::fft_radix4_pass_ ##datatype (real_buffer, imag_buffer, size, span, twiddles); \
+            } \
+            else \
+            { \
+                const disable_sse_denormals disable_denormals; \
+                \
+                for (uint32 group = 0; group < size; group += 4 * span) \
+                { \
+                    datatype* real = real_buffer + group; \
+                    datatype* imag = imag_buffer + group; \
+                    \
+                    for (uint32 k = 0; k < span; k += vector_size) \
+                    { \
+                        const vector_type w1_real = vector_loadu(twiddles + k); \
+                        const vector_type w1_imag = vector_loadu(twiddles + span + k); \
+                        const vector_type w2_real = vector_loadu(twiddles + 2 * span + k); \
+                        const vector_type w2_imag = vector_loadu(twiddles + 3 * span + k); \
+                        const vector_type w3_real = vector_loadu(twiddles + 4 * span + k); \
+                        const vector_type w3_imag = vector_loadu(twiddles + 5 * span + k); \
+                        \
+                        const vector_type a_real = vector_loadu(real + k); \
+                        const vector_type a_imag = vector_loadu(imag + k); \
+                        const vector_type x1_real = vector_loadu(real + span + k); \
+                        const vector_type x1_imag = vector_loadu(imag + span + k); \
+                        const vector_type x2_real = vector_loadu(real + 2 * span + k); \
+                        const vector_type x2_imag = vector_loadu(imag + 2 * span + k); \
+                        const vector_type x3_real = vector_loadu(real + 3 * span + k); \
+                        const vector_type x3_imag = vector_loadu(imag + 3 * span + k); \
+                        \
+                        const vector_type b_real = vector_sub(vector_mul(x1_real, w2_real), vector_mul(x1_imag, w2_imag)); \
+                        const vector_type b_imag = vector_add(vector_mul(x1_real, w2_imag), vector_mul(x1_imag, w2_real)); \
+                        const vector_type c_real = vector_sub(vector_mul(x2_real, w1_real), vector_mul(x2_imag, w1_imag)); \
+                        const vector_type c_imag = vector_add(vector_mul(x2_real, w1_imag), vector_mul(x2_imag, w1_real)); \
+                        const vector_type d_real = vector_sub(vector_mul(x3_real, w3_real), vector_mul(x3_imag, w3_imag)); \
+                        const vector_type d_imag = vector_add(vector_mul(x3_real, w3_imag), vector_mul(x3_imag, w3_real)); \
+                        \
+                        const vector_type t0_real = vector_add(a_real, b_real); \
+                        const vector_type t0_imag = vector_add(a_imag, b_imag); \
+                        const vector_type t1_real = vector_sub(a_real, b_real); \
+                        const vector_type t1_imag = vector_sub(a_imag, b_imag); \
+                        const vector_type t2_real = vector_add(c_real, d_real); \
+                        const vector_type t2_imag = vector_add(c_imag, d_imag); \
+                        const vector_type t3_real = vector_sub(c_real, d_real); \
+                        const vector_type t3_imag = vector_sub(c_imag, d_imag); \
+                        \
+                        vector_storeu(real + k, vector_add(t0_real, t2_real)); \
+                        vector_storeu(imag + k, vector_add(t0_imag, t2_imag)); \
+                        vector_storeu(real + span + k, vector_add(t1_real, t3_imag)); \
+                        vector_storeu(imag + span + k, vector_sub(t1_imag, t3_real)); \
+                        vector_storeu(real + 2 * span + k, vector_sub(t0_real, t2_real)); \
+                        vector_storeu(imag + 2 * span + k, vector_sub(t0_imag, t2_imag)); \
+                        vector_storeu(real + 3 * span + k, vector_sub(t1_real, t3_imag)); \
+                        vector_storeu(imag + 3 * span + k, vector_add(t1_imag, t3_real)); \
+                    } \
+                } \
+            } \
+        }
+
+    math_avx512_fft_radix4_pass_impl(float, __m512, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_mul_ps, _mm512_add_ps, _mm512_sub_ps)
+    math_avx512_fft_radix4_pass_impl(double, __m512d, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_mul_pd, _mm512_add_pd, _mm512_sub_pd)
+
+
+    //--------------------------------------------------------------------------
+
+    void convolve_row_float(
+        float* src_buffer,
+        float* dst_buffer,
+        uint32 width,
+        float* kernel,
+        uint32 kernel_size) const
+    {
+        // the pixels from center to end have their whole window in the row
+        const uint32 center = kernel_size / 2;
+        const uint32 end = width + center + 1 > kernel_size ? width + center + 1 - kernel_size : 0;
+
+        if (end < center + 16)
+        {
+            math_avx2::convolve_row_float(src_buffer, dst_buffer, width, kernel, kernel_size);
+            return;
+        }
+
+        const disable_sse_denormals disable_denormals;
+
+        convolve_row_generic(src_buffer, dst_buffer, width, kernel, kernel_size, 0, center);
+
+        uint32 i = center;
+        for (; i + 64 <= end; i += 64)
+        {
+            const float* window = src_buffer + i - center;
+            __m512 sum0 = _mm512_setzero_ps();
+            __m512 sum1 = _mm512_setzero_ps();
+            __m512 sum2 = _mm512_setzero_ps();
+            __m512 sum3 = _mm512_setzero_ps();
+
+            for (uint32 k = 0; k < kernel_size; ++k)
+            {
+                const __m512 coefficient = _mm512_set1_ps(kernel[k]);
+
+                sum0 = _mm512_add_ps(sum0, _mm512_mul_ps(coefficient, _mm512_loadu_ps(window + k)));
+                sum1 = _mm512_add_ps(sum1, _mm512_mul_ps(coefficient, _mm512_loadu_ps(window + k + 16)));
+                sum2 = _mm512_add_ps(sum2, _mm512_mul_ps(coefficient, _mm512_loadu_ps(window + k + 32)));
+                sum3 = _mm512_add_ps(sum3, _mm512_mul_ps(coefficient, _mm512_loadu_ps(window + k + 48)));
+            }
+
+            _mm512_storeu_ps(dst_buffer + i, sum0);
+            _mm512_storeu_ps(dst_buffer + i + 16, sum1);
+            _mm512_storeu_ps(dst_buffer + i + 32, sum2);
+            _mm512_storeu_ps(dst_buffer + i + 48, sum3);
+        }
+
+        for (; i + 16 <= end; i += 16)
+        {
+            const float* window = src_buffer + i - center;
+            __m512 sum = _mm512_setzero_ps();
+
+            for (uint32 k = 0; k < kernel_size; ++k)
+                sum = _mm512_add_ps(sum, _mm512_mul_ps(_mm512_set1_ps(kernel[k]), _mm512_loadu_ps(window + k)));
+
+            _mm512_storeu_ps(dst_buffer + i, sum);
+        }
+
+        // Handle the right edge and the leftover pixels
+        convolve_row_generic(src_buffer, dst_buffer, width, kernel, kernel_size, i, width);
+    }
+
+    //--------------------------------------------------------------------------
+
+    void convolve_column_tile_float(
+        float* src_buffer,
+        uint32 src_stride,
+        float* dst_buffer,
+        uint32 dst_stride,
+        uint32 columns,
+        uint32 height,
+        float* kernel,
+        uint32 kernel_size) const
+    {
+        const disable_sse_denormals disable_denormals;
+
+        const int32 center = int32(kernel_size / 2);
+        const uint32 vector_columns = columns & ~15;
+
+        for (uint32 row = 0; row < height; ++row)
+        {
+            float* dst_row = dst_buffer + row * dst_stride;
+
+            uint32 i = 0;
+            for (; i + 64 <= vector_columns; i += 64)
+            {
+                __m512 sum0 = _mm512_setzero_ps();
+                __m512 sum1 = _mm512_setzero_ps();
+                __m512 sum2 = _mm512_setzero_ps();
+                __m512 sum3 = _mm512_setzero_ps();
+
+                for (uint32 k = 0; k < kernel_size; ++k)
+                {
+                    const float* src_row = image_row(src_buffer, src_stride, int32(row + k) - center, height) + i;
+                    const __m512 coefficient = _mm512_set1_ps(kernel[k]);
+
+                    sum0 = _mm512_add_ps(sum0, _mm512_mul_ps(coefficient, _mm512_loadu_ps(src_row)));
+                    sum1 = _mm512_add_ps(sum1, _mm512_mul_ps(coefficient, _mm512_loadu_ps(src_row + 16)));
+                    sum2 = _mm512_add_ps(sum2, _mm512_mul_ps(coefficient, _mm512_loadu_ps(src_row + 32)));
+                    sum3 = _mm512_add_ps(sum3, _mm512_mul_ps(coefficient, _mm512_loadu_ps(src_row + 48)));
+                }
+
+                _mm512_storeu_ps(dst_row + i, sum0);
+                _mm512_storeu_ps(dst_row + i + 16, sum1);
+                _mm512_storeu_ps(dst_row + i + 32, sum2);
+                _mm512_storeu_ps(dst_row + i + 48, sum3);
+            }
+
+            for (; i < vector_columns; i += 16)
+            {
+                __m512 sum = _mm512_setzero_ps();
+
+                for (uint32 k = 0; k < kernel_size; ++k)
+                {
+                    const float* src_row = image_row(src_buffer, src_stride, int32(row + k) - center, height) + i;
+
+                    sum = _mm512_add_ps(sum, _mm512_mul_ps(_mm512_set1_ps(kernel[k]), _mm512_loadu_ps(src_row)));
+                }
+
+                _mm512_storeu_ps(dst_row + i, sum);
+            }
+        }
+
+        // Handle the leftover columns
+        math_avx2::convolve_column_tile_float(src_buffer + vector_columns, src_stride,
+            dst_buffer + vector_columns, dst_stride, columns - vector_columns, height, kernel, kernel_size);
+    }
+
+    //--------------------------------------------------------------------------
+
+    void box_blur_row_float(
+        float* src_buffer,
+        float* dst_buffer,
+        uint32 width,
+        uint32 radius) const
+    {
+        // the running sum of the pixels from begin to end adds and removes
+        // pixels inside the row, a register of them is one prefix sum of the
+        // differences
+        const uint32 begin = radius + 1;
+        const uint32 end = width > radius ? width - radius : 0;
+
+        if (end < begin + 16)
+        {
+            math_avx2::box_blur_row_float(src_buffer, dst_buffer, width, radius);
+            return;
+        }
+
+        const disable_sse_denormals disable_denormals;
+
+        box_blur_row_generic(src_buffer, dst_buffer, width, radius, 0, begin);
+
+        const __m512 scale = _mm512_set1_ps(1.0f / float(2 * radius + 1));
+        const __m512i last_lane = _mm512_set1_epi32(15);
+        __m512 sum = _mm512_set1_ps(box_window_sum(src_buffer, width, radius, radius));
+
+        uint32 i = begin;
+        for (; i + 16 <= end; i += 16)
+        {
+            const __m512 delta = _mm512_sub_ps(_mm512_loadu_ps(src_buffer + i + radius),
+                _mm512_loadu_ps(src_buffer + i - radius - 1));
+
+            sum = _mm512_add_ps(sum, prefix_sum_ps(delta));
+            _mm512_storeu_ps(dst_buffer + i, _mm512_mul_ps(sum, scale));
+            sum = _mm512_permutexvar_ps(last_lane, sum);
+        }
+
+        // Handle the right edge and the leftover pixels
+        box_blur_row_generic(src_buffer, dst_buffer, width, radius, i, width);
+    }
+
+    //--------------------------------------------------------------------------
+
+    void box_blur_column_tile_float(
+        float* src_buffer,
+        uint32 src_stride,
+        float* dst_buffer,
+        uint32 dst_stride,
+        uint32 columns,
+        uint32 height,
+        uint32 radius) const
+    {
+        assert(columns <= image_tile_columns);
+
+        const disable_sse_denormals disable_denormals;
+
+        const __m512 scale = _mm512_set1_ps(1.0f / float(2 * radius + 1));
+        const uint32 vector_columns = columns & ~15;
+        float sums[image_tile_columns];
+
+        for (uint32 i = 0; i < vector_columns; i += 16)
+            _mm512_storeu_ps(sums + i, _mm512_setzero_ps());
+
+        for (int32 k = -int32(radius); k <= int32(radius); ++k)
+        {
+            const float* src_row = image_row(src_buffer, src_stride, k, height);
+
+            for (uint32 i = 0; i < vector_columns; i += 16)
+                _mm512_storeu_ps(sums + i, _mm512_add_ps(_mm512_loadu_ps(sums + i), _mm512_loadu_ps(src_row + i)));
+        }
+
+        for (uint32 row = 0; row < height; ++row)
+        {
+            const float* add_row = image_row(src_buffer, src_stride, int32(row + radius + 1), height);
+            const float* sub_row = image_row(src_buffer, src_stride, int32(row) - int32(radius), height);
+            float* dst_row = dst_buffer + row * dst_stride;
+
+            for (uint32 i = 0; i < vector_columns; i += 16)
+            {
+                const __m512 sum = _mm512_loadu_ps(sums + i);
+
+                _mm512_storeu_ps(dst_row + i, _mm512_mul_ps(sum, scale));
+                _mm512_storeu_ps(sums + i, _mm512_add_ps(sum,
+                    _mm512_sub_ps(_mm512_loadu_ps(add_row + i), _mm512_loadu_ps(sub_row + i))));
+            }
+        }
+
+        // Handle the leftover columns
+        math_avx2::box_blur_column_tile_float(src_buffer + vector_columns, src_stride,
+            dst_buffer + vector_columns, dst_stride, columns - vector_columns, height, radius);
+    }
+
+    //--------------------------------------------------------------------------
+
+    void resize_column_tile_float(
+        float* src_buffer,
+        uint32 src_stride,
+        float* dst_buffer,
+        uint32 dst_stride,
+        uint32 columns,
+        uint32 height,
+        float* coefficients,
+        uint32 taps,
+        uint32* offsets) const
+    {
+        const disable_sse_denormals disable_denormals;
+
+        const uint32 vector_columns = columns & ~15;
+
+        for (uint32 row = 0; row < height; ++row)
+        {
+            const float* window = src_buffer + offsets[row] * src_stride;
+            const float* coefficient = coefficients + row * taps;
+            float* dst_row = dst_buffer + row * dst_stride;
+
+            uint32 i = 0;
+            for (; i + 64 <= vector_columns; i += 64)
+            {
+                __m512 sum0 = _mm512_setzero_ps();
+                __m512 sum1 = _mm512_setzero_ps();
+                __m512 sum2 = _mm512_setzero_ps();
+                __m512 sum3 = _mm512_setzero_ps();
+
+                for (uint32 k = 0; k < taps; ++k)
+                {
+                    const float* src_row = window + k * src_stride + i;
+                    const __m512 weight = _mm512_set1_ps(coefficient[k]);
+
+                    sum0 = _mm512_add_ps(sum0, _mm512_mul_ps(weight, _mm512_loadu_ps(src_row)));
+                    sum1 = _mm512_add_ps(sum1, _mm512_mul_ps(weight, _mm512_loadu_ps(src_row + 16)));
+                    sum2 = _mm512_add_ps(sum2, _mm512_mul_ps(weight, _mm512_loadu_ps(src_row + 32)));
+                    sum3 = _mm512_add_ps(sum3, _mm512_mul_ps(weight, _mm512_loadu_ps(src_row + 48)));
+                }
+
+                _mm512_storeu_ps(dst_row + i, sum0);
+                _mm512_storeu_ps(dst_row + i + 16, sum1);
+                _mm512_storeu_ps(dst_row + i + 32, sum2);
+                _mm512_storeu_ps(dst_row + i + 48, sum3);
+            }
+
+            for (; i < vector_columns; i += 16)
+            {
+                __m512 sum = _mm512_setzero_ps();
+
+                for (uint32 k = 0; k < taps; ++k)
+                    sum = _mm512_add_ps(sum, _mm512_mul_ps(_mm512_set1_ps(coefficient[k]), _mm512_loadu_ps(window + k * src_stride + i)));
+
+                _mm512_storeu_ps(dst_row + i, sum);
+            }
+        }
+
+        // Handle the leftover columns
+        math_avx2::resize_column_tile_float(src_buffer + vector_columns, src_stride,
+            dst_buffer + vector_columns, dst_stride, columns - vector_columns, height, coefficients, taps, offsets);
+    }
+
+    //--------------------------------------------------------------------------
+
+    void resize_column_tile_uint8(
+        float* src_buffer,
+        uint32 src_stride,
+        uint8* dst_buffer,
+        uint32 dst_stride,
+        uint32 columns,
+        uint32 height,
+        float* coefficients,
+        uint32 taps,
+        uint32* offsets) const
+    {
+        const disable_sse_denormals disable_denormals;
+
+        // 16 columns a step, converted with the default round to nearest and
+        // narrowed with unsigned saturation
+        const uint32 vector_columns = columns & ~15;
+        const __m512i zero = _mm512_setzero_si512();
+
+        for (uint32 row = 0; row < height; ++row)
+        {
+            const float* window = src_buffer + offsets[row] * src_stride;
+            const float* coefficient = coefficients + row * taps;
+            uint8* dst_row = dst_buffer + row * dst_stride;
+
+            for (uint32 i = 0; i < vector_columns; i += 16)
+            {
+                __m512 sum = _mm512_setzero_ps();
+
+                for (uint32 k = 0; k < taps; ++k)
+                    sum = _mm512_add_ps(sum, _mm512_mul_ps(_mm512_set1_ps(coefficient[k]), _mm512_loadu_ps(window + k * src_stride + i)));
+
+                const __m512i value = _mm512_max_epi32(_mm512_cvtps_epi32(sum), zero);
+                _mm_storeu_si128((__m128i*)(dst_row + i), _mm512_cvtusepi32_epi8(value));
+            }
+        }
+
+        // Handle the leftover columns
+        math_avx2::resize_column_tile_uint8(src_buffer + vector_columns, src_stride,
+            dst_buffer + vector_columns, dst_stride, columns - vector_columns, height, coefficients, taps, offsets);
+    }
+
+
+private:
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline uint64 lanes_mask(uint32 count)
+    {
+        // count is always less than the lanes in a vector
+        return (((uint64)1) << count) - 1;
+    }
+
+    // running sums of the lanes, each one added to all the following ones
+    static forcedinline __m512 prefix_sum_ps(__m512 value)
+    {
+        const __m512i zero = _mm512_setzero_si512();
+
+        value = _mm512_add_ps(value, _mm512_castsi512_ps(_mm512_alignr_epi32(_mm512_castps_si512(value), zero, 15)));
+        value = _mm512_add_ps(value, _mm512_castsi512_ps(_mm512_alignr_epi32(_mm512_castps_si512(value), zero, 14)));
+        value = _mm512_add_ps(value, _mm512_castsi512_ps(_mm512_alignr_epi32(_mm512_castps_si512(value), zero, 12)));
+        return _mm512_add_ps(value, _mm512_castsi512_ps(_mm512_alignr_epi32(_mm512_castps_si512(value), zero, 8)));
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    #define math_avx512_memory_functions_impl(datatype, mask_type, vector_type, suffix, vector_suffix) \
+        static forcedinline vector_type load_vector( \
+            const datatype* buffer) \
+        { \
+            return _mm512_loadu_ ##vector_suffix (buffer); \
+        } \
+        \
+        static forcedinline vector_type load_vector_masked( \
+            const datatype* buffer, \
+            mask_type mask) \
+        { \
+            return _mm512_maskz_loadu_ ##suffix (mask, buffer); \
+        } \
+        \
+        static forcedinline vector_type load_vector_merged( \
+            const datatype* buffer, \
+            mask_type mask, \
+            vector_type fill) \
+        { \
+            /* masked out lanes are taken from fill */ \
+            return _mm512_mask_loadu_ ##suffix (fill, mask, buffer); \
+        } \
+        \
+        static forcedinline vector_type load_divisor_masked( \
+            const datatype* buffer, \
+            mask_type mask) \
+        { \
+            /* masked out lanes are filled with ones to avoid dividing by zero */ \
+            return _mm512_mask_loadu_ ##suffix (_mm512_set1_ ##suffix (1), mask, buffer); \
+        } \
+        \
+        static forcedinline void store_vector( \
+            datatype* buffer, \
+            vector_type value) \
+        { \
+            _mm512_store_ ##vector_suffix (buffer, value); \
+        } \
+        \
+        static forcedinline void store_vector_masked( \
+            datatype* buffer, \
+            mask_type mask, \
+            vector_type value) \
+        { \
+            _mm512_mask_storeu_ ##suffix (buffer, mask, value); \
+        }
+
+    math_avx512_memory_functions_impl(int8, __mmask64, __m512i, epi8, si512)
+    math_avx512_memory_functions_impl(uint8, __mmask64, __m512i, epi8, si512)
+    math_avx512_memory_functions_impl(int16, __mmask32, __m512i, epi16, si512)
+    math_avx512_memory_functions_impl(uint16, __mmask32, __m512i, epi16, si512)
+    math_avx512_memory_functions_impl(int32, __mmask16, __m512i, epi32, si512)
+    math_avx512_memory_functions_impl(uint32, __mmask16, __m512i, epi32, si512)
+    math_avx512_memory_functions_impl(int64, __mmask8, __m512i, epi64, si512)
+    math_avx512_memory_functions_impl(uint64, __mmask8, __m512i, epi64, si512)
+    math_avx512_memory_functions_impl(float, __mmask16, __m512, ps, ps)
+    math_avx512_memory_functions_impl(double, __mmask8, __m512d, pd, pd)
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline __m512i mullo_epi8(__m512i a, __m512i b)
+    {
+        // multiply even and odd bytes separately as 16 bit lanes
+        const __m512i even = _mm512_mullo_epi16(a, b);
+        const __m512i odd = _mm512_mullo_epi16(
+            _mm512_srli_epi16(a, 8), _mm512_srli_epi16(b, 8));
+
+        return _mm512_mask_blend_epi8(0x5555555555555555ULL,
+            _mm512_slli_epi16(odd, 8), even);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // integer reductions accumulate eight 64 bit lanes, the compensation is
+    // only used by the floating point ones
+    static forcedinline void sum_epi8(__m512i& sum, __m512i&, __m512i value)
+    {
+        // bias to unsigned bytes for sad, then take the bias of 8 bytes back
+        const __m512i bias = _mm512_set1_epi8((char)0x80);
+        sum = _mm512_add_epi64(sum, _mm512_sub_epi64(
+            _mm512_sad_epu8(_mm512_xor_si512(value, bias), _mm512_setzero_si512()),
+            _mm512_set1_epi64(8 * 128)));
+    }
+
+    static forcedinline void sum_epu8(__m512i& sum, __m512i&, __m512i value)
+    {
+        sum = _mm512_add_epi64(sum, _mm512_sad_epu8(value, _mm512_setzero_si512()));
+    }
+
+    static forcedinline void sum_epi16(__m512i& sum, __m512i& compensation, __m512i value)
+    {
+        sum_epi32(sum, compensation, _mm512_madd_epi16(value, _mm512_set1_epi16(1)));
+    }
+
+    static forcedinline void sum_epu16(__m512i& sum, __m512i& compensation, __m512i value)
+    {
+        const __m512i zero = _mm512_setzero_si512();
+        sum_epu32(sum, compensation, _mm512_add_epi32(
+            _mm512_unpacklo_epi16(value, zero), _mm512_unpackhi_epi16(value, zero)));
+    }
+
+    static forcedinline void sum_epi32(__m512i& sum, __m512i&, __m512i value)
+    {
+        sum = _mm512_add_epi64(sum, _mm512_add_epi64(
+            _mm512_cvtepi32_epi64(_mm512_castsi512_si256(value)),
+            _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(value, 1))));
+    }
+
+    static forcedinline void sum_epu32(__m512i& sum, __m512i&, __m512i value)
+    {
+        sum = _mm512_add_epi64(sum, _mm512_add_epi64(
+            _mm512_cvtepu32_epi64(_mm512_castsi512_si256(value)),
+            _mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(value, 1))));
+    }
+
+    static forcedinline void sum_epi64(__m512i& sum, __m512i&, __m512i value)
+    {
+        sum = _mm512_add_epi64(sum, value);
+    }
+
+    static forcedinline void kahan_add_ps(__m512& sum, __m512& compensation, __m512 value)
+    {
+        const __m512 y = _mm512_sub_ps(value, compensation);
+        const __m512 t = _mm512_add_ps(sum, y);
+        compensation = _mm512_sub_ps(_mm512_sub_ps(t, sum), y);
+        sum = t;
+    }
+
+    static forcedinline void kahan_add_pd(__m512d& sum, __m512d& compensation, __m512d value)
+    {
+        const __m512d y = _mm512_sub_pd(value, compensation);
+        const __m512d t = _mm512_add_pd(sum, y);
+        compensation = _mm512_sub_pd(_mm512_sub_pd(t, sum), y);
+        sum = t;
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline void dot_epi8(__m512i& sum, __m512i& compensation, __m512i a, __m512i b)
+    {
+        // pairs of 8 bit products can't overflow 32 bit lanes
+        sum_epi32(sum, compensation, _mm512_add_epi32(
+            _mm512_madd_epi16(
+                _mm512_cvtepi8_epi16(_mm512_castsi512_si256(a)),
+                _mm512_cvtepi8_epi16(_mm512_castsi512_si256(b))),
+            _mm512_madd_epi16(
+                _mm512_cvtepi8_epi16(_mm512_extracti64x4_epi64(a, 1)),
+                _mm512_cvtepi8_epi16(_mm512_extracti64x4_epi64(b, 1)))));
+    }
+
+    static forcedinline void dot_epu8(__m512i& sum, __m512i& compensation, __m512i a, __m512i b)
+    {
+        sum_epu32(sum, compensation, _mm512_add_epi32(
+            _mm512_madd_epi16(
+                _mm512_cvtepu8_epi16(_mm512_castsi512_si256(a)),
+                _mm512_cvtepu8_epi16(_mm512_castsi512_si256(b))),
+            _mm512_madd_epi16(
+                _mm512_cvtepu8_epi16(_mm512_extracti64x4_epi64(a, 1)),
+                _mm512_cvtepu8_epi16(_mm512_extracti64x4_epi64(b, 1)))));
+    }
+
+    static forcedinline void dot_epi16(__m512i& sum, __m512i& compensation, __m512i a, __m512i b)
+    {
+        // full 32 bit products, a pair of them could overflow so widen each
+        const __m512i lo = _mm512_mullo_epi16(a, b);
+        const __m512i hi = _mm512_mulhi_epi16(a, b);
+        sum_epi32(sum, compensation, _mm512_unpacklo_epi16(lo, hi));
+        sum_epi32(sum, compensation, _mm512_unpackhi_epi16(lo, hi));
+    }
+
+    static forcedinline void dot_epu16(__m512i& sum, __m512i& compensation, __m512i a, __m512i b)
+    {
+        const __m512i lo = _mm512_mullo_epi16(a, b);
+        const __m512i hi = _mm512_mulhi_epu16(a, b);
+        sum_epu32(sum, compensation, _mm512_unpacklo_epi16(lo, hi));
+        sum_epu32(sum, compensation, _mm512_unpackhi_epi16(lo, hi));
+    }
+
+    static forcedinline void dot_epi32(__m512i& sum, __m512i&, __m512i a, __m512i b)
+    {
+        sum = _mm512_add_epi64(sum, _mm512_add_epi64(_mm512_mul_epi32(a, b),
+            _mm512_mul_epi32(_mm512_srli_epi64(a, 32), _mm512_srli_epi64(b, 32))));
+    }
+
+    static forcedinline void dot_epu32(__m512i& sum, __m512i&, __m512i a, __m512i b)
+    {
+        sum = _mm512_add_epi64(sum, _mm512_add_epi64(_mm512_mul_epu32(a, b),
+            _mm512_mul_epu32(_mm512_srli_epi64(a, 32), _mm512_srli_epi64(b, 32))));
+    }
+
+    static forcedinline void dot_epi64(__m512i& sum, __m512i&, __m512i a, __m512i b)
+    {
+        sum = _mm512_add_epi64(sum, _mm512_mullo_epi64(a, b));
+    }
+
+    static forcedinline void dot_ps(__m512& sum, __m512& compensation, __m512 a, __m512 b)
+    {
+        kahan_add_ps(sum, compensation, _mm512_mul_ps(a, b));
+    }
+
+    static forcedinline void dot_pd(__m512d& sum, __m512d& compensation, __m512d a, __m512d b)
+    {
+        kahan_add_pd(sum, compensation, _mm512_mul_pd(a, b));
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline uint64 reduce_epi64(__m512i sum, __m512i)
+    {
+        uint64 lanes[8];
+        _mm512_storeu_si512(lanes, sum);
+
+        uint64 result = 0;
+        for (uint32 i = 0; i < 8; ++i)
+        {
+            result += lanes[i];
+        }
+
+        return result;
+    }
+
+    static forcedinline double reduce_kahan_ps(__m512 sum, __m512 compensation)
+    {
+        float sums[16], compensations[16];
+        _mm512_storeu_ps(sums, sum);
+        _mm512_storeu_ps(compensations, compensation);
+
+        double result = 0.0;
+        for (uint32 i = 0; i < 16; ++i)
+        {
+            result += (double)sums[i] - (double)compensations[i];
+        }
+
+        return result;
+    }
+
+    static forcedinline double reduce_kahan_pd(__m512d sum, __m512d compensation)
+    {
+        double sums[8], compensations[8];
+        _mm512_storeu_pd(sums, sum);
+        _mm512_storeu_pd(compensations, compensation);
+
+        double result = 0.0;
+        for (uint32 i = 0; i < 8; ++i)
+        {
+            result += sums[i] - compensations[i];
+        }
+
+        return result;
+    }
+
+    // folds the halves of the register down to one sum
+    static forcedinline float reduce_add_ps(__m512 sum)
+    {
+        const __m256 upper = _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(sum), 1));
+        const __m256 half = _mm256_add_ps(_mm512_castps512_ps256(sum), upper);
+        const __m128 quarter = _mm_add_ps(_mm256_castps256_ps128(half), _mm256_extractf128_ps(half, 1));
+
+        float lanes[4];
+        _mm_storeu_ps(lanes, quarter);
+
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+
+    static forcedinline double reduce_add_pd(__m512d sum)
+    {
+        const __m256d half = _mm256_add_pd(_mm512_castpd512_pd256(sum), _mm512_extractf64x4_pd(sum, 1));
+        const __m128d quarter = _mm_add_pd(_mm256_castpd256_pd128(half), _mm256_extractf128_pd(half, 1));
+
+        double lanes[2];
+        _mm_storeu_pd(lanes, quarter);
+
+        return lanes[0] + lanes[1];
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline __m512 peak_ps(__m512 value, __m512 peak)
+    {
+        return _mm512_max_ps(_mm512_abs_ps(value), peak);
+    }
+
+    static forcedinline __m512d peak_pd(__m512d value, __m512d peak)
+    {
+        return _mm512_max_pd(_mm512_abs_pd(value), peak);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // a > b ? greater : otherwise, lane by lane
+    static forcedinline __m512 select_greater_ps(__m512 a, __m512 b, __m512 greater, __m512 otherwise)
+    {
+        return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(a, b, _CMP_GT_OQ), otherwise, greater);
+    }
+
+    static forcedinline __m512d select_greater_pd(__m512d a, __m512d b, __m512d greater, __m512d otherwise)
+    {
+        return _mm512_mask_blend_pd(_mm512_cmp_pd_mask(a, b, _CMP_GT_OQ), otherwise, greater);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline __m512 round_ps(__m512 value)
+    {
+        return _mm512_roundscale_ps(value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    }
+
+    static forcedinline __m512d round_pd(__m512d value)
+    {
+        return _mm512_roundscale_pd(value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    }
+
+    // the sign of b on the magnitude of a
+    static forcedinline __m512 copysign_ps(__m512 a, __m512 b)
+    {
+        return _mm512_castsi512_ps(_mm512_ternarylogic_epi32(_mm512_castps_si512(a),
+            _mm512_castps_si512(b), _mm512_set1_epi32(0x7fffffff), 0xe4));
+    }
+
+    static forcedinline __m512d copysign_pd(__m512d a, __m512d b)
+    {
+        return _mm512_castsi512_pd(_mm512_ternarylogic_epi64(_mm512_castpd_si512(a),
+            _mm512_castpd_si512(b), _mm512_set1_epi64(0x7fffffffffffffffLL), 0xe4));
+    }
+
+    template<uint32 count> static forcedinline __m512 polynomial_ps(__m512 x, const float (&coefficients)[count])
+    {
+        __m512 result = _mm512_set1_ps(coefficients[0]);
+        for (uint32 i = 1; i < count; ++i)
+        {
+            result = _mm512_fmadd_ps(result, x, _mm512_set1_ps(coefficients[i]));
+        }
+
+        return result;
+    }
+
+    template<uint32 count> static forcedinline __m512d polynomial_pd(__m512d x, const double (&coefficients)[count])
+    {
+        __m512d result = _mm512_set1_pd(coefficients[0]);
+        for (uint32 i = 1; i < count; ++i)
+        {
+            result = _mm512_fmadd_pd(result, x, _mm512_set1_pd(coefficients[i]));
+        }
+
+        return result;
+    }
+
+    // e^r - 1 for |r| <= log(2) / 2
+    static forcedinline __m512 expm1_ps(__m512 r, bool accurate)
+    {
+        const __m512 p = accurate
+            ? polynomial_ps(r, accurate_exp_coefficients_float)
+            : polynomial_ps(r, fast_exp_coefficients_float);
+
+        return _mm512_fmadd_ps(_mm512_mul_ps(r, r), p, r);
+    }
+
+    static forcedinline __m512d expm1_pd(__m512d r, bool accurate)
+    {
+        const __m512d p = accurate
+            ? polynomial_pd(r, accurate_exp_coefficients_double)
+            : polynomial_pd(r, fast_exp_coefficients_double);
+
+        return _mm512_fmadd_pd(_mm512_mul_pd(r, r), p, r);
+    }
+
+    // the same reductions as exp_scalar
+    static forcedinline __m512 exp_ps(__m512 x, bool accurate)
+    {
+        const __m512 high = _mm512_set1_ps(88.72283172607421875f);
+        const __m512 low = _mm512_set1_ps(-87.33654022216796875f);
+
+        const __m512 clamped = _mm512_min_ps(_mm512_max_ps(x, low), high);
+        const __m512 n = round_ps(_mm512_mul_ps(clamped, _mm512_set1_ps(1.44269504088896341f)));
+        const __m512 r = _mm512_fnmadd_ps(n, _mm512_set1_ps(-2.12194440e-4f),
+            _mm512_fnmadd_ps(n, _mm512_set1_ps(0.693359375f), clamped));
+
+        __m512 result = _mm512_scalef_ps(_mm512_add_ps(expm1_ps(r, accurate), _mm512_set1_ps(1.0f)), n);
+
+        result = _mm512_mask_mov_ps(result, _mm512_cmp_ps_mask(x, high, _CMP_GT_OQ), _mm512_set1_ps(std::numeric_limits<float>::infinity()));
+        result = _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(x, low, _CMP_NLT_UQ), result);
+
+        return _mm512_mask_mov_ps(result, _mm512_cmp_ps_mask(x, x, _CMP_UNORD_Q), x);
+    }
+
+    static forcedinline __m512d exp_pd(__m512d x, bool accurate)
+    {
+        const __m512d high = _mm512_set1_pd(709.782712893383);
+        const __m512d low = _mm512_set1_pd(-708.396418532264);
+
+        const __m512d clamped = _mm512_min_pd(_mm512_max_pd(x, low), high);
+        const __m512d n = round_pd(_mm512_mul_pd(clamped, _mm512_set1_pd(1.4426950408889634074)));
+        const __m512d r = _mm512_fnmadd_pd(n, _mm512_set1_pd(1.90821492927058770002e-10),
+            _mm512_fnmadd_pd(n, _mm512_set1_pd(6.93147180369123816490e-1), clamped));
+
+        __m512d result = _mm512_scalef_pd(_mm512_add_pd(expm1_pd(r, accurate), _mm512_set1_pd(1.0)), n);
+
+        result = _mm512_mask_mov_pd(result, _mm512_cmp_pd_mask(x, high, _CMP_GT_OQ), _mm512_set1_pd(std::numeric_limits<double>::infinity()));
+        result = _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(x, low, _CMP_NLT_UQ), result);
+
+        return _mm512_mask_mov_pd(result, _mm512_cmp_pd_mask(x, x, _CMP_UNORD_Q), x);
+    }
+
+    // zero and denormals give minus infinity and anything not positive a NaN
+    static forcedinline __m512 log_ps(__m512 x, bool accurate)
+    {
+        const __m512 one = _mm512_set1_ps(1.0f);
+
+        __m512 e = _mm512_getexp_ps(x);
+        __m512 m = _mm512_getmant_ps(x, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_zero);
+
+        const __mmask16 above = _mm512_cmp_ps_mask(m, _mm512_set1_ps(1.41421356237309505f), _CMP_GT_OQ);
+        m = _mm512_mask_mul_ps(m, above, m, _mm512_set1_ps(0.5f));
+        e = _mm512_mask_add_ps(e, above, e, one);
+
+        const __m512 s = _mm512_div_ps(_mm512_sub_ps(m, one), _mm512_add_ps(m, one));
+        const __m512 w = _mm512_mul_ps(s, s);
+        const __m512 q = accurate
+            ? polynomial_ps(w, accurate_log_coefficients_float)
+            : polynomial_ps(w, fast_log_coefficients_float);
+
+        const __m512 log_m = _mm512_fmadd_ps(_mm512_mul_ps(s, w), q, _mm512_add_ps(s, s));
+        __m512 result = _mm512_fmadd_ps(e, _mm512_set1_ps(0.693359375f),
+            _mm512_fmadd_ps(e, _mm512_set1_ps(-2.12194440e-4f), log_m));
+
+        result = _mm512_mask_mov_ps(result, _mm512_cmp_ps_mask(x, _mm512_set1_ps(std::numeric_limits<float>::infinity()), _CMP_EQ_OQ), x);
+        result = _mm512_mask_mov_ps(result, _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_EQ_OQ), _mm512_set1_ps(-std::numeric_limits<float>::infinity()));
+
+        return _mm512_mask_mov_ps(result, _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_NGE_UQ), _mm512_set1_ps(std::numeric_limits<float>::quiet_NaN()));
+    }
+
+    static forcedinline __m512d log_pd(__m512d x, bool accurate)
+    {
+        const __m512d one = _mm512_set1_pd(1.0);
+
+        __m512d e = _mm512_getexp_pd(x);
+        __m512d m = _mm512_getmant_pd(x, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_zero);
+
+        const __mmask8 above = _mm512_cmp_pd_mask(m, _mm512_set1_pd(1.41421356237309504880), _CMP_GT_OQ);
+        m = _mm512_mask_mul_pd(m, above, m, _mm512_set1_pd(0.5));
+        e = _mm512_mask_add_pd(e, above, e, one);
+
+        const __m512d s = _mm512_div_pd(_mm512_sub_pd(m, one), _mm512_add_pd(m, one));
+        const __m512d w = _mm512_mul_pd(s, s);
+        const __m512d q = accurate
+            ? polynomial_pd(w, accurate_log_coefficients_double)
+            : polynomial_pd(w, fast_log_coefficients_double);
+
+        const __m512d log_m = _mm512_fmadd_pd(_mm512_mul_pd(s, w), q, _mm512_add_pd(s, s));
+        __m512d result = _mm512_fmadd_pd(e, _mm512_set1_pd(6.93147180369123816490e-1),
+            _mm512_fmadd_pd(e, _mm512_set1_pd(1.90821492927058770002e-10), log_m));
+
+        result = _mm512_mask_mov_pd(result, _mm512_cmp_pd_mask(x, _mm512_set1_pd(std::numeric_limits<double>::infinity()), _CMP_EQ_OQ), x);
+        result = _mm512_mask_mov_pd(result, _mm512_cmp_pd_mask(x, _mm512_setzero_pd(), _CMP_EQ_OQ), _mm512_set1_pd(-std::numeric_limits<double>::infinity()));
+
+        return _mm512_mask_mov_pd(result, _mm512_cmp_pd_mask(x, _mm512_setzero_pd(), _CMP_NGE_UQ), _mm512_set1_pd(std::numeric_limits<double>::quiet_NaN()));
+    }
+
+    // r = x - j pi / 2 with pi / 2 in four parts, the first three of 33 bits
+    // so their products by j are exact. From 2^30 on r has lost most of its
+    // bits and would grow past the polynomials, so those arguments reduce as
+    // zeros: x - x keeps infinities and NaNs as NaNs
+    static forcedinline __m512d reduce_angle_pd(__m512d x, __m512d& j)
+    {
+        x = _mm512_mask_sub_pd(x, _mm512_cmp_pd_mask(_mm512_abs_pd(x), _mm512_set1_pd(1073741824.0), _CMP_GE_OQ), x, x);
+        j = round_pd(_mm512_mul_pd(x, _mm512_set1_pd(6.36619772367581382433e-1)));
+
+        return _mm512_fnmadd_pd(j, _mm512_set1_pd(8.47842766036889956997e-32),
+            _mm512_fnmadd_pd(j, _mm512_set1_pd(2.02226624871116645580e-21),
+            _mm512_fnmadd_pd(j, _mm512_set1_pd(6.07710050630396597660e-11),
+            _mm512_fnmadd_pd(j, _mm512_set1_pd(1.57079632673412561417), x))));
+    }
+
+    // the odd quadrants swap the polynomials, the sign flips follow the
+    // second bit of the quadrant, plus one for the cosine. Floats are reduced
+    // in double eight at a time, close to the zeros a float pi / 2 loses r
+    static forcedinline void sincos_ps(__m512 x, __m512& sin_value, __m512& cos_value, bool accurate)
+    {
+        __m512d j_lo, j_hi;
+        const __m256 r_lo = _mm512_cvtpd_ps(reduce_angle_pd(_mm512_cvtps_pd(_mm512_castps512_ps256(x)), j_lo));
+        const __m256 r_hi = _mm512_cvtpd_ps(reduce_angle_pd(_mm512_cvtps_pd(
+            _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(x), 1))), j_hi));
+        const __m512 r = _mm512_castpd_ps(_mm512_insertf64x4(
+            _mm512_castps_pd(_mm512_castps256_ps512(r_lo)), _mm256_castps_pd(r_hi), 1));
+        const __m512 z = _mm512_mul_ps(r, r);
+
+        const __m512 sine = _mm512_fmadd_ps(_mm512_mul_ps(r, z), accurate
+            ? polynomial_ps(z, accurate_sin_coefficients_float)
+            : polynomial_ps(z, fast_sin_coefficients_float), r);
+        const __m512 cosine = _mm512_fmadd_ps(_mm512_mul_ps(z, z), accurate
+            ? polynomial_ps(z, accurate_cos_coefficients_float)
+            : polynomial_ps(z, fast_cos_coefficients_float), _mm512_fnmadd_ps(z, _mm512_set1_ps(0.5f), _mm512_set1_ps(1.0f)));
+
+        const __m512i quadrant = _mm512_inserti64x4(_mm512_castsi256_si512(_mm512_cvtpd_epi32(j_lo)),
+            _mm512_cvtpd_epi32(j_hi), 1);
+        const __m512i one = _mm512_set1_epi32(1);
+        const __m512i two = _mm512_set1_epi32(2);
+        const __mmask16 swap = _mm512_test_epi32_mask(quadrant, one);
+
+        sin_value = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(_mm512_mask_blend_ps(swap, sine, cosine)),
+            _mm512_slli_epi32(_mm512_and_si512(quadrant, two), 30)));
+        cos_value = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(_mm512_mask_blend_ps(swap, cosine, sine)),
+            _mm512_slli_epi32(_mm512_and_si512(_mm512_add_epi32(quadrant, one), two), 30)));
+    }
+
+    static forcedinline void sincos_pd(__m512d x, __m512d& sin_value, __m512d& cos_value, bool accurate)
+    {
+        __m512d j;
+        const __m512d r = reduce_angle_pd(x, j);
+        const __m512d z = _mm512_mul_pd(r, r);
+
+        const __m512d sine = _mm512_fmadd_pd(_mm512_mul_pd(r, z), accurate
+            ? polynomial_pd(z, accurate_sin_coefficients_double)
+            : polynomial_pd(z, fast_sin_coefficients_double), r);
+        const __m512d cosine = _mm512_fmadd_pd(_mm512_mul_pd(z, z), accurate
+            ? polynomial_pd(z, accurate_cos_coefficients_double)
+            : polynomial_pd(z, fast_cos_coefficients_double), _mm512_fnmadd_pd(z, _mm512_set1_pd(0.5), _mm512_set1_pd(1.0)));
+
+        const __m512i quadrant = _mm512_cvtpd_epi64(j);
+        const __m512i one = _mm512_set1_epi64(1);
+        const __m512i two = _mm512_set1_epi64(2);
+        const __mmask8 swap = _mm512_test_epi64_mask(quadrant, one);
+
+        sin_value = _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(_mm512_mask_blend_pd(swap, sine, cosine)),
+            _mm512_slli_epi64(_mm512_and_si512(quadrant, two), 62)));
+        cos_value = _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(_mm512_mask_blend_pd(swap, cosine, sine)),
+            _mm512_slli_epi64(_mm512_and_si512(_mm512_add_epi64(quadrant, one), two), 62)));
+    }
+
+    // tanh |x| is -u / (2 + u) for u = e^(-2 |x|) - 1, with the sign of x
+    static forcedinline __m512 tanh_ps(__m512 x, bool accurate)
+    {
+        const __m512 a = _mm512_mul_ps(_mm512_min_ps(_mm512_abs_ps(x), _mm512_set1_ps(9.0f)), _mm512_set1_ps(-2.0f));
+        const __m512 n = round_ps(_mm512_mul_ps(a, _mm512_set1_ps(1.44269504088896341f)));
+        const __m512 r = _mm512_fnmadd_ps(n, _mm512_set1_ps(-2.12194440e-4f),
+            _mm512_fnmadd_ps(n, _mm512_set1_ps(0.693359375f), a));
+
+        const __m512 one = _mm512_set1_ps(1.0f);
+        const __m512 u = _mm512_add_ps(_mm512_scalef_ps(expm1_ps(r, accurate), n), _mm512_sub_ps(_mm512_scalef_ps(one, n), one));
+        const __m512 result = copysign_ps(_mm512_div_ps(_mm512_sub_ps(_mm512_setzero_ps(), u), _mm512_add_ps(_mm512_set1_ps(2.0f), u)), x);
+
+        return _mm512_mask_mov_ps(result, _mm512_cmp_ps_mask(x, x, _CMP_UNORD_Q), x);
+    }
+
+    static forcedinline __m512d tanh_pd(__m512d x, bool accurate)
+    {
+        const __m512d a = _mm512_mul_pd(_mm512_min_pd(_mm512_abs_pd(x), _mm512_set1_pd(20.0)), _mm512_set1_pd(-2.0));
+        const __m512d n = round_pd(_mm512_mul_pd(a, _mm512_set1_pd(1.4426950408889634074)));
+        const __m512d r = _mm512_fnmadd_pd(n, _mm512_set1_pd(1.90821492927058770002e-10),
+            _mm512_fnmadd_pd(n, _mm512_set1_pd(6.93147180369123816490e-1), a));
+
+        const __m512d one = _mm512_set1_pd(1.0);
+        const __m512d u = _mm512_add_pd(_mm512_scalef_pd(expm1_pd(r, accurate), n), _mm512_sub_pd(_mm512_scalef_pd(one, n), one));
+        const __m512d result = copysign_pd(_mm512_div_pd(_mm512_sub_pd(_mm512_setzero_pd(), u), _mm512_add_pd(_mm512_set1_pd(2.0), u)), x);
+
+        return _mm512_mask_mov_pd(result, _mm512_cmp_pd_mask(x, x, _CMP_UNORD_Q), x);
+    }
+
+    // the accurate powers of floats go through the fast double functions,
+    // like pow_scalar does
+    static forcedinline __m512 pow_ps(__m512 x, __m512 y, bool accurate)
+    {
+        if (accurate)
+        {
+            const __m512d low = exp_pd(_mm512_mul_pd(_mm512_cvtps_pd(_mm512_castps512_ps256(y)),
+                log_pd(_mm512_cvtps_pd(_mm512_castps512_ps256(x)), false)), false);
+            const __m512d high = exp_pd(_mm512_mul_pd(_mm512_cvtps_pd(_mm512_extractf32x8_ps(y, 1)),
+                log_pd(_mm512_cvtps_pd(_mm512_extractf32x8_ps(x, 1)), false)), false);
+
+            return _mm512_insertf32x8(_mm512_castps256_ps512(_mm512_cvtpd_ps(low)), _mm512_cvtpd_ps(high), 1);
+        }
+
+        return exp_ps(_mm512_mul_ps(y, log_ps(x, false)), false);
+    }
+
+    static forcedinline __m512d pow_pd(__m512d x, __m512d y, bool accurate)
+    {
+        return exp_pd(_mm512_mul_pd(y, log_pd(x, accurate)), accurate);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline __m512i combine_epi32(__m256i lo, __m256i hi)
+    {
+        return _mm512_inserti64x4(_mm512_castsi256_si512(lo), hi, 1);
+    }
+
+    static forcedinline __m512i combine_epi8(__m128i a, __m128i b, __m128i c, __m128i d)
+    {
+        return _mm512_inserti64x4(
+            _mm512_castsi256_si512(
+                _mm256_inserti128_si256(_mm256_castsi128_si256(a), b, 1)),
+            _mm256_inserti128_si256(_mm256_castsi128_si256(c), d, 1), 1);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // 16 x int32 lanes, truncated like round::f2i and round::d2i
+    static forcedinline __m512i scale_epi32(__m512i value, __m512 vscale)
+    {
+        return _mm512_cvttps_epi32(
+            _mm512_mul_ps(_mm512_cvtepi32_ps(value), vscale));
+    }
+
+    static forcedinline __m512i scale_epi32(__m512i value, __m512d vscale)
+    {
+        return combine_epi32(
+            _mm512_cvttpd_epi32(_mm512_mul_pd(
+                _mm512_cvtepi32_pd(_mm512_castsi512_si256(value)), vscale)),
+            _mm512_cvttpd_epi32(_mm512_mul_pd(
+                _mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(value, 1)), vscale)));
+    }
+
+    static forcedinline __m512i scale_epu32(__m512i value, __m512 vscale)
+    {
+        return _mm512_cvttps_epi32(
+            _mm512_mul_ps(_mm512_cvtepu32_ps(value), vscale));
+    }
+
+    static forcedinline __m512i scale_epu32(__m512i value, __m512d vscale)
+    {
+        return combine_epi32(
+            _mm512_cvttpd_epi32(_mm512_mul_pd(
+                _mm512_cvtepu32_pd(_mm512_castsi512_si256(value)), vscale)),
+            _mm512_cvttpd_epi32(_mm512_mul_pd(
+                _mm512_cvtepu32_pd(_mm512_extracti64x4_epi64(value, 1)), vscale)));
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    template<typename vector_type>
+    static forcedinline __m512i scale_vector_int8(__m512i value, vector_type vscale)
+    {
+        return combine_epi8(
+            _mm512_cvtepi32_epi8(scale_epi32(_mm512_cvtepi8_epi32(_mm512_extracti32x4_epi32(value, 0)), vscale)),
+            _mm512_cvtepi32_epi8(scale_epi32(_mm512_cvtepi8_epi32(_mm512_extracti32x4_epi32(value, 1)), vscale)),
+            _mm512_cvtepi32_epi8(scale_epi32(_mm512_cvtepi8_epi32(_mm512_extracti32x4_epi32(value, 2)), vscale)),
+            _mm512_cvtepi32_epi8(scale_epi32(_mm512_cvtepi8_epi32(_mm512_extracti32x4_epi32(value, 3)), vscale)));
+    }
+
+    template<typename vector_type>
+    static forcedinline __m512i scale_vector_uint8(__m512i value, vector_type vscale)
+    {
+        return combine_epi8(
+            _mm512_cvtepi32_epi8(scale_epi32(_mm512_cvtepu8_epi32(_mm512_extracti32x4_epi32(value, 0)), vscale)),
+            _mm512_cvtepi32_epi8(scale_epi32(_mm512_cvtepu8_epi32(_mm512_extracti32x4_epi32(value, 1)), vscale)),
+            _mm512_cvtepi32_epi8(scale_epi32(_mm512_cvtepu8_epi32(_mm512_extracti32x4_epi32(value, 2)), vscale)),
+            _mm512_cvtepi32_epi8(scale_epi32(_mm512_cvtepu8_epi32(_mm512_extracti32x4_epi32(value, 3)), vscale)));
+    }
+
+    template<typename vector_type>
+    static forcedinline __m512i scale_vector_int16(__m512i value, vector_type vscale)
+    {
+        return combine_epi32(
+            _mm512_cvtepi32_epi16(scale_epi32(_mm512_cvtepi16_epi32(_mm512_castsi512_si256(value)), vscale)),
+            _mm512_cvtepi32_epi16(scale_epi32(_mm512_cvtepi16_epi32(_mm512_extracti64x4_epi64(value, 1)), vscale)));
+    }
+
+    template<typename vector_type>
+    static forcedinline __m512i scale_vector_uint16(__m512i value, vector_type vscale)
+    {
+        return combine_epi32(
+            _mm512_cvtepi32_epi16(scale_epi32(_mm512_cvtepu16_epi32(_mm512_castsi512_si256(value)), vscale)),
+            _mm512_cvtepi32_epi16(scale_epi32(_mm512_cvtepu16_epi32(_mm512_extracti64x4_epi64(value, 1)), vscale)));
+    }
+
+    template<typename vector_type>
+    static forcedinline __m512i scale_vector_int32(__m512i value, vector_type vscale)
+    {
+        return scale_epi32(value, vscale);
+    }
+
+    template<typename vector_type>
+    static forcedinline __m512i scale_vector_uint32(__m512i value, vector_type vscale)
+    {
+        return scale_epu32(value, vscale);
+    }
+
+    // round::f2i and round::d2i return a 32 bit integer which is then widened
+    static forcedinline __m512i scale_vector_int64(__m512i value, __m512 vscale)
+    {
+        return _mm512_cvtepi32_epi64(_mm256_cvttps_epi32(_mm256_mul_ps(
+            _mm512_cvtepi64_ps(value), _mm512_castps512_ps256(vscale))));
+    }
+
+    static forcedinline __m512i scale_vector_int64(__m512i value, __m512d vscale)
+    {
+        return _mm512_cvtepi32_epi64(_mm512_cvttpd_epi32(_mm512_mul_pd(
+            _mm512_cvtepi64_pd(value), vscale)));
+    }
+
+    static forcedinline __m512i scale_vector_uint64(__m512i value, __m512 vscale)
+    {
+        return _mm512_cvtepi32_epi64(_mm256_cvttps_epi32(_mm256_mul_ps(
+            _mm512_cvtepu64_ps(value), _mm512_castps512_ps256(vscale))));
+    }
+
+    static forcedinline __m512i scale_vector_uint64(__m512i value, __m512d vscale)
+    {
+        return _mm512_cvtepi32_epi64(_mm512_cvttpd_epi32(_mm512_mul_pd(
+            _mm512_cvtepu64_pd(value), vscale)));
+    }
+
+    static forcedinline __m512 scale_vector_float(__m512 value, __m512 vscale)
+    {
+        return _mm512_mul_ps(value, vscale);
+    }
+
+    static forcedinline __m512d scale_vector_double(__m512d value, __m512d vscale)
+    {
+        return _mm512_mul_pd(value, vscale);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // 8 and 16 bit quotients are exact in single precision
+    static forcedinline __m128i div_epi32_ps(__m512i a, __m512i b)
+    {
+        return _mm512_cvtepi32_epi8(_mm512_cvttps_epi32(
+            _mm512_div_ps(_mm512_cvtepi32_ps(a), _mm512_cvtepi32_ps(b))));
+    }
+
+    static forcedinline __m512i div_epi8(__m512i a, __m512i b)
+    {
+        return combine_epi8(
+            div_epi32_ps(_mm512_cvtepi8_epi32(_mm512_extracti32x4_epi32(a, 0)),
+                         _mm512_cvtepi8_epi32(_mm512_extracti32x4_epi32(b, 0))),
+            div_epi32_ps(_mm512_cvtepi8_epi32(_mm512_extracti32x4_epi32(a, 1)),
+                         _mm512_cvtepi8_epi32(_mm512_extracti32x4_epi32(b, 1))),
+            div_epi32_ps(_mm512_cvtepi8_epi32(_mm512_extracti32x4_epi32(a, 2)),
+                         _mm512_cvtepi8_epi32(_mm512_extracti32x4_epi32(b, 2))),
+            div_epi32_ps(_mm512_cvtepi8_epi32(_mm512_extracti32x4_epi32(a, 3)),
+                         _mm512_cvtepi8_epi32(_mm512_extracti32x4_epi32(b, 3))));
+    }
+
+    static forcedinline __m512i div_epu8(__m512i a, __m512i b)
+    {
+        return combine_epi8(
+            div_epi32_ps(_mm512_cvtepu8_epi32(_mm512_extracti32x4_epi32(a, 0)),
+                         _mm512_cvtepu8_epi32(_mm512_extracti32x4_epi32(b, 0))),
+            div_epi32_ps(_mm512_cvtepu8_epi32(_mm512_extracti32x4_epi32(a, 1)),
+                         _mm512_cvtepu8_epi32(_mm512_extracti32x4_epi32(b, 1))),
+            div_epi32_ps(_mm512_cvtepu8_epi32(_mm512_extracti32x4_epi32(a, 2)),
+                         _mm512_cvtepu8_epi32(_mm512_extracti32x4_epi32(b, 2))),
+            div_epi32_ps(_mm512_cvtepu8_epi32(_mm512_extracti32x4_epi32(a, 3)),
+                         _mm512_cvtepu8_epi32(_mm512_extracti32x4_epi32(b, 3))));
+    }
+
+    static forcedinline __m256i div_epi32_ps_epi16(__m512i a, __m512i b)
+    {
+        return _mm512_cvtepi32_epi16(_mm512_cvttps_epi32(
+            _mm512_div_ps(_mm512_cvtepi32_ps(a), _mm512_cvtepi32_ps(b))));
+    }
+
+    static forcedinline __m512i div_epi16(__m512i a, __m512i b)
+    {
+        return combine_epi32(
+            div_epi32_ps_epi16(
+                _mm512_cvtepi16_epi32(_mm512_castsi512_si256(a)),
+                _mm512_cvtepi16_epi32(_mm512_castsi512_si256(b))),
+            div_epi32_ps_epi16(
+                _mm512_cvtepi16_epi32(_mm512_extracti64x4_epi64(a, 1)),
+                _mm512_cvtepi16_epi32(_mm512_extracti64x4_epi64(b, 1))));
+    }
+
+    static forcedinline __m512i div_epu16(__m512i a, __m512i b)
+    {
+        return combine_epi32(
+            div_epi32_ps_epi16(
+                _mm512_cvtepu16_epi32(_mm512_castsi512_si256(a)),
+                _mm512_cvtepu16_epi32(_mm512_castsi512_si256(b))),
+            div_epi32_ps_epi16(
+                _mm512_cvtepu16_epi32(_mm512_extracti64x4_epi64(a, 1)),
+                _mm512_cvtepu16_epi32(_mm512_extracti64x4_epi64(b, 1))));
+    }
+
+    // 32 bit quotients are exact in double precision
+    static forcedinline __m512i div_epi32(__m512i a, __m512i b)
+    {
+        return combine_epi32(
+            _mm512_cvttpd_epi32(_mm512_div_pd(
+                _mm512_cvtepi32_pd(_mm512_castsi512_si256(a)),
+                _mm512_cvtepi32_pd(_mm512_castsi512_si256(b)))),
+            _mm512_cvttpd_epi32(_mm512_div_pd(
+                _mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(a, 1)),
+                _mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(b, 1)))));
+    }
+
+    static forcedinline __m512i div_epu32(__m512i a, __m512i b)
+    {
+        return combine_epi32(
+            _mm512_cvttpd_epu32(_mm512_div_pd(
+                _mm512_cvtepu32_pd(_mm512_castsi512_si256(a)),
+                _mm512_cvtepu32_pd(_mm512_castsi512_si256(b)))),
+            _mm512_cvttpd_epu32(_mm512_div_pd(
+                _mm512_cvtepu32_pd(_mm512_extracti64x4_epi64(a, 1)),
+                _mm512_cvtepu32_pd(_mm512_extracti64x4_epi64(b, 1)))));
+    }
+
+    // 64 bit quotients are exact in double precision only below 2^53, so
+    // vectors holding larger values are divided one lane at a time
+    static forcedinline __m512i div_epi64(__m512i a, __m512i b)
+    {
+        const __m512i limit = _mm512_set1_epi64(1LL << 53);
+
+        if (_mm512_cmplt_epu64_mask(_mm512_abs_epi64(a), limit) == 0xFF &&
+            _mm512_cmplt_epu64_mask(_mm512_abs_epi64(b), limit) == 0xFF)
+        {
+            return _mm512_cvttpd_epi64(_mm512_div_pd(
+                _mm512_cvtepi64_pd(a), _mm512_cvtepi64_pd(b)));
+        }
+
+        aligned(int64 values_a[8], 64);
+        aligned(int64 values_b[8], 64);
+        _mm512_store_si512(values_a, a);
+        _mm512_store_si512(values_b, b);
+
+        for (uint32 i = 0; i < 8; ++i)
+        {
+            values_a[i] = values_a[i] / values_b[i];
+        }
+
+        return _mm512_load_si512(values_a);
+    }
+
+    static forcedinline __m512i div_epu64(__m512i a, __m512i b)
+    {
+        const __m512i limit = _mm512_set1_epi64(1LL << 53);
+
+        if (_mm512_cmplt_epu64_mask(a, limit) == 0xFF &&
+            _mm512_cmplt_epu64_mask(b, limit) == 0xFF)
+        {
+            return _mm512_cvttpd_epu64(_mm512_div_pd(
+                _mm512_cvtepu64_pd(a), _mm512_cvtepu64_pd(b)));
+        }
+
+        aligned(uint64 values_a[8], 64);
+        aligned(uint64 values_b[8], 64);
+        _mm512_store_si512(values_a, a);
+        _mm512_store_si512(values_b, b);
+
+        for (uint32 i = 0; i < 8; ++i)
+        {
+            values_a[i] = values_a[i] / values_b[i];
+        }
+
+        return _mm512_load_si512(values_a);
+    }
+
+};
+
+
+#endif
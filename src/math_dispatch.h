@@ -0,0 +1,958 @@
+/*
+ * waterspout
+ *
+ *   - simd abstraction library for audio/image manipulation -
+ *
+ * Copyright (c) 2015 Lucio Asnaghi
+ *
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __WATERSPOUT_SIMD_ABSTRACTION_FRAMEWORK_MATH_DISPATCH_H__
+#define __WATERSPOUT_SIMD_ABSTRACTION_FRAMEWORK_MATH_DISPATCH_H__
+
+
+//==============================================================================
+
+//------------------------------------------------------------------------------
+
+/**
+ * The functions of a backend as the math factory stores them in
+ * math_dispatch_table, private to the backend translation units.
+ *
+ * Every function calls the backend kernel non virtually on a temporary (the
+ * backends are stateless), so the kernel is inlined in the function the table
+ * points to and a dispatched call costs one indirect call.
+ */
+
+#define math_dispatch_common_functions(datatype) \
+    static forcedinline void clear_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 size) \
+    { \
+        math_impl().math_impl::clear_buffer_ ##datatype (src_buffer, size); \
+    } \
+    \
+    static forcedinline void set_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 size, \
+        datatype value) \
+    { \
+        math_impl().math_impl::set_buffer_ ##datatype (src_buffer, size, value); \
+    } \
+    \
+    static forcedinline void scale_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 size, \
+        float gain) \
+    { \
+        math_impl().math_impl::scale_buffer_ ##datatype (src_buffer, size, gain); \
+    } \
+    \
+    static forcedinline void scale_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 size, \
+        double gain) \
+    { \
+        math_impl().math_impl::scale_buffer_ ##datatype (src_buffer, size, gain); \
+    } \
+    \
+    static forcedinline void copy_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size) \
+    { \
+        math_impl().math_impl::copy_buffer_ ##datatype (src_buffer, dst_buffer, size); \
+    } \
+    \
+    static forcedinline void add_buffers_ ##datatype ( \
+        datatype * src_buffer_a, \
+        datatype * src_buffer_b, \
+        datatype * dst_buffer, \
+        uint32 size) \
+    { \
+        math_impl().math_impl::add_buffers_ ##datatype (src_buffer_a, src_buffer_b, dst_buffer, size); \
+    } \
+    \
+    static forcedinline void subtract_buffers_ ##datatype ( \
+        datatype * src_buffer_a, \
+        datatype * src_buffer_b, \
+        datatype * dst_buffer, \
+        uint32 size) \
+    { \
+        math_impl().math_impl::subtract_buffers_ ##datatype (src_buffer_a, src_buffer_b, dst_buffer, size); \
+    } \
+    \
+    static forcedinline void multiply_buffers_ ##datatype ( \
+        datatype * src_buffer_a, \
+        datatype * src_buffer_b, \
+        datatype * dst_buffer, \
+        uint32 size) \
+    { \
+        math_impl().math_impl::multiply_buffers_ ##datatype (src_buffer_a, src_buffer_b, dst_buffer, size); \
+    } \
+    \
+    static forcedinline void divide_buffers_ ##datatype ( \
+        datatype * src_buffer_a, \
+        datatype * src_buffer_b, \
+        datatype * dst_buffer, \
+        uint32 size) \
+    { \
+        math_impl().math_impl::divide_buffers_ ##datatype (src_buffer_a, src_buffer_b, dst_buffer, size); \
+    } \
+    \
+    static forcedinline void abs_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 size) \
+    { \
+        math_impl().math_impl::abs_buffer_ ##datatype (src_buffer, size); \
+    }
+
+#define math_dispatch_reduction_functions(datatype, accumtype) \
+    static forcedinline accumtype sum_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 size) \
+    { \
+        return math_impl().math_impl::sum_buffer_ ##datatype (src_buffer, size); \
+    } \
+    \
+    static forcedinline accumtype dot_product_ ##datatype ( \
+        datatype * src_buffer_a, \
+        datatype * src_buffer_b, \
+        uint32 size) \
+    { \
+        return math_impl().math_impl::dot_product_ ##datatype (src_buffer_a, src_buffer_b, size); \
+    } \
+    \
+    static forcedinline datatype min_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 size, \
+        uint32 * index) \
+    { \
+        return math_impl().math_impl::min_buffer_ ##datatype (src_buffer, size, index); \
+    } \
+    \
+    static forcedinline datatype max_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 size, \
+        uint32 * index) \
+    { \
+        return math_impl().math_impl::max_buffer_ ##datatype (src_buffer, size, index); \
+    } \
+    \
+    static forcedinline accumtype peak_abs_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 size) \
+    { \
+        return math_impl().math_impl::peak_abs_buffer_ ##datatype (src_buffer, size); \
+    } \
+    \
+    static forcedinline double rms_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 size) \
+    { \
+        return math_impl().math_impl::rms_buffer_ ##datatype (src_buffer, size); \
+    }
+
+#define math_dispatch_saturating_functions(datatype) \
+    static forcedinline void add_buffers_saturate_ ##datatype ( \
+        datatype * src_buffer_a, \
+        datatype * src_buffer_b, \
+        datatype * dst_buffer, \
+        uint32 size) \
+    { \
+        math_impl().math_impl::add_buffers_saturate_ ##datatype (src_buffer_a, src_buffer_b, dst_buffer, size); \
+    } \
+    \
+    static forcedinline void subtract_buffers_saturate_ ##datatype ( \
+        datatype * src_buffer_a, \
+        datatype * src_buffer_b, \
+        datatype * dst_buffer, \
+        uint32 size) \
+    { \
+        math_impl().math_impl::subtract_buffers_saturate_ ##datatype (src_buffer_a, src_buffer_b, dst_buffer, size); \
+    } \
+    \
+    static forcedinline void scale_buffer_saturate_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 size, \
+        float gain) \
+    { \
+        math_impl().math_impl::scale_buffer_saturate_ ##datatype (src_buffer, size, gain); \
+    } \
+    \
+    static forcedinline void average_buffers_ ##datatype ( \
+        datatype * src_buffer_a, \
+        datatype * src_buffer_b, \
+        datatype * dst_buffer, \
+        uint32 size) \
+    { \
+        math_impl().math_impl::average_buffers_ ##datatype (src_buffer_a, src_buffer_b, dst_buffer, size); \
+    }
+
+#define math_dispatch_floating_functions(datatype) \
+    static forcedinline void multiply_add_buffers_ ##datatype ( \
+        datatype * src_buffer_a, \
+        datatype * src_buffer_b, \
+        datatype * src_buffer_c, \
+        datatype * dst_buffer, \
+        uint32 size) \
+    { \
+        math_impl().math_impl::multiply_add_buffers_ ##datatype (src_buffer_a, src_buffer_b, src_buffer_c, dst_buffer, size); \
+    } \
+    \
+    static forcedinline void scale_add_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        datatype gain) \
+    { \
+        math_impl().math_impl::scale_add_buffer_ ##datatype (src_buffer, dst_buffer, size, gain); \
+    } \
+    \
+    static forcedinline void ramp_scale_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 size, \
+        datatype start_gain, \
+        datatype end_gain) \
+    { \
+        math_impl().math_impl::ramp_scale_buffer_ ##datatype (src_buffer, size, start_gain, end_gain); \
+    } \
+    \
+    static forcedinline void exp_ramp_scale_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 size, \
+        datatype start_gain, \
+        datatype end_gain) \
+    { \
+        math_impl().math_impl::exp_ramp_scale_buffer_ ##datatype (src_buffer, size, start_gain, end_gain); \
+    }
+
+#define math_dispatch_mixing_functions(datatype) \
+    static forcedinline void pan_mono_to_stereo_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_left_buffer, \
+        datatype * dst_right_buffer, \
+        uint32 size, \
+        datatype pan, \
+        PanLawTypes law) \
+    { \
+        math_impl().math_impl::pan_mono_to_stereo_ ##datatype (src_buffer, dst_left_buffer, dst_right_buffer, size, pan, law); \
+    } \
+    \
+    static forcedinline void ramp_pan_mono_to_stereo_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_left_buffer, \
+        datatype * dst_right_buffer, \
+        uint32 size, \
+        datatype start_pan, \
+        datatype end_pan, \
+        PanLawTypes law) \
+    { \
+        math_impl().math_impl::ramp_pan_mono_to_stereo_ ##datatype (src_buffer, dst_left_buffer, dst_right_buffer, size, start_pan, end_pan, law); \
+    } \
+    \
+    static forcedinline void balance_stereo_ ##datatype ( \
+        datatype * left_buffer, \
+        datatype * right_buffer, \
+        uint32 size, \
+        datatype balance) \
+    { \
+        math_impl().math_impl::balance_stereo_ ##datatype (left_buffer, right_buffer, size, balance); \
+    } \
+    \
+    static forcedinline void ramp_balance_stereo_ ##datatype ( \
+        datatype * left_buffer, \
+        datatype * right_buffer, \
+        uint32 size, \
+        datatype start_balance, \
+        datatype end_balance) \
+    { \
+        math_impl().math_impl::ramp_balance_stereo_ ##datatype (left_buffer, right_buffer, size, start_balance, end_balance); \
+    } \
+    \
+    static forcedinline void mix_dry_wet_ ##datatype ( \
+        datatype * dry_buffer, \
+        datatype * wet_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        datatype mix) \
+    { \
+        math_impl().math_impl::mix_dry_wet_ ##datatype (dry_buffer, wet_buffer, dst_buffer, size, mix); \
+    } \
+    \
+    static forcedinline void ramp_mix_dry_wet_ ##datatype ( \
+        datatype * dry_buffer, \
+        datatype * wet_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        datatype start_mix, \
+        datatype end_mix) \
+    { \
+        math_impl().math_impl::ramp_mix_dry_wet_ ##datatype (dry_buffer, wet_buffer, dst_buffer, size, start_mix, end_mix); \
+    } \
+    \
+    static forcedinline void interleave_buffers_ ##datatype ( \
+        datatype ** src_buffers, \
+        datatype * dst_buffer, \
+        uint32 channels, \
+        uint32 size) \
+    { \
+        math_impl().math_impl::interleave_buffers_ ##datatype (src_buffers, dst_buffer, channels, size); \
+    } \
+    \
+    static forcedinline void deinterleave_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype ** dst_buffers, \
+        uint32 channels, \
+        uint32 size) \
+    { \
+        math_impl().math_impl::deinterleave_buffer_ ##datatype (src_buffer, dst_buffers, channels, size); \
+    }
+
+#define math_dispatch_conversion_functions(integer, datatype) \
+    static forcedinline void convert_buffer_ ##integer ##_to_ ##datatype ( \
+        integer * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size) \
+    { \
+        math_impl().math_impl::convert_buffer_ ##integer ##_to_ ##datatype (src_buffer, dst_buffer, size); \
+    } \
+    \
+    static forcedinline void convert_buffer_ ##datatype ##_to_ ##integer ( \
+        datatype * src_buffer, \
+        integer * dst_buffer, \
+        uint32 size, \
+        FloatRoundingModeTypes rounding, \
+        uint32 * dither_seed) \
+    { \
+        math_impl().math_impl::convert_buffer_ ##datatype ##_to_ ##integer (src_buffer, dst_buffer, size, rounding, dither_seed); \
+    }
+
+#define math_dispatch_filter_functions(datatype) \
+    static forcedinline void process_biquad_bank_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 channels, \
+        uint32 frames, \
+        datatype * coefficients, \
+        datatype * state, \
+        uint32 sections) \
+    { \
+        math_impl().math_impl::process_biquad_bank_ ##datatype (src_buffer, dst_buffer, channels, frames, coefficients, state, sections); \
+    } \
+    \
+    static forcedinline void process_polyphase_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        datatype * coefficients, \
+        uint32 taps, \
+        uint32 * rows, \
+        uint32 * offsets) \
+    { \
+        math_impl().math_impl::process_polyphase_ ##datatype (src_buffer, dst_buffer, size, coefficients, taps, rows, offsets); \
+    }
+
+#define math_dispatch_transform_functions(datatype) \
+    static forcedinline void fft_butterflies_ ##datatype ( \
+        datatype * real_buffer, \
+        datatype * imag_buffer, \
+        uint32 size, \
+        const datatype * twiddles) \
+    { \
+        math_impl().math_impl::fft_butterflies_ ##datatype (real_buffer, imag_buffer, size, twiddles); \
+    }
+
+#define math_dispatch_dynamics_functions(datatype) \
+    static forcedinline void process_envelope_bank_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 channels, \
+        uint32 frames, \
+        datatype * coefficients, \
+        datatype * state, \
+        EnvelopeModeTypes mode) \
+    { \
+        math_impl().math_impl::process_envelope_bank_ ##datatype (src_buffer, dst_buffer, channels, frames, coefficients, state, mode); \
+    } \
+    \
+    static forcedinline void compressor_gain_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        datatype threshold, \
+        datatype ratio, \
+        datatype knee) \
+    { \
+        math_impl().math_impl::compressor_gain_buffer_ ##datatype (src_buffer, dst_buffer, size, threshold, ratio, knee); \
+    } \
+    \
+    static forcedinline void limiter_gain_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        datatype threshold) \
+    { \
+        math_impl().math_impl::limiter_gain_buffer_ ##datatype (src_buffer, dst_buffer, size, threshold); \
+    } \
+    \
+    static forcedinline void soft_clip_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size) \
+    { \
+        math_impl().math_impl::soft_clip_buffer_ ##datatype (src_buffer, dst_buffer, size); \
+    }
+
+#define math_dispatch_transcendental_functions(datatype) \
+    static forcedinline void exp_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        MathAccuracyTypes accuracy) \
+    { \
+        math_impl().math_impl::exp_buffer_ ##datatype (src_buffer, dst_buffer, size, accuracy); \
+    } \
+    \
+    static forcedinline void log_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        MathAccuracyTypes accuracy) \
+    { \
+        math_impl().math_impl::log_buffer_ ##datatype (src_buffer, dst_buffer, size, accuracy); \
+    } \
+    \
+    static forcedinline void sin_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        MathAccuracyTypes accuracy) \
+    { \
+        math_impl().math_impl::sin_buffer_ ##datatype (src_buffer, dst_buffer, size, accuracy); \
+    } \
+    \
+    static forcedinline void cos_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        MathAccuracyTypes accuracy) \
+    { \
+        math_impl().math_impl::cos_buffer_ ##datatype (src_buffer, dst_buffer, size, accuracy); \
+    } \
+    \
+    static forcedinline void sincos_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * sin_buffer, \
+        datatype * cos_buffer, \
+        uint32 size, \
+        MathAccuracyTypes accuracy) \
+    { \
+        math_impl().math_impl::sincos_buffer_ ##datatype (src_buffer, sin_buffer, cos_buffer, size, accuracy); \
+    } \
+    \
+    static forcedinline void tanh_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        MathAccuracyTypes accuracy) \
+    { \
+        math_impl().math_impl::tanh_buffer_ ##datatype (src_buffer, dst_buffer, size, accuracy); \
+    } \
+    \
+    static forcedinline void pow_buffer_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * exponent_buffer, \
+        datatype * dst_buffer, \
+        uint32 size, \
+        MathAccuracyTypes accuracy) \
+    { \
+        math_impl().math_impl::pow_buffer_ ##datatype (src_buffer, exponent_buffer, dst_buffer, size, accuracy); \
+    }
+
+#define math_dispatch_pixel_functions(datatype) \
+    static forcedinline void premultiply_rgba_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 pixels) \
+    { \
+        math_impl().math_impl::premultiply_rgba_ ##datatype (src_buffer, dst_buffer, pixels); \
+    } \
+    \
+    static forcedinline void unpremultiply_rgba_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 pixels) \
+    { \
+        math_impl().math_impl::unpremultiply_rgba_ ##datatype (src_buffer, dst_buffer, pixels); \
+    } \
+    \
+    static forcedinline void composite_rgba_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * backdrop_buffer, \
+        datatype * dst_buffer, \
+        uint32 pixels, \
+        CompositeModeTypes mode) \
+    { \
+        math_impl().math_impl::composite_rgba_ ##datatype (src_buffer, backdrop_buffer, dst_buffer, pixels, mode); \
+    }
+
+#define math_dispatch_color_functions(datatype) \
+    static forcedinline void rgba_to_gray_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 pixels, \
+        ColorSpaceTypes space) \
+    { \
+        math_impl().math_impl::rgba_to_gray_ ##datatype (src_buffer, dst_buffer, pixels, space); \
+    } \
+    \
+    static forcedinline void gray_to_rgba_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * dst_buffer, \
+        uint32 pixels, \
+        ColorSpaceTypes space) \
+    { \
+        math_impl().math_impl::gray_to_rgba_ ##datatype (src_buffer, dst_buffer, pixels, space); \
+    } \
+    \
+    static forcedinline void rgba_to_i420_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 src_stride, \
+        datatype * y_buffer, \
+        uint32 y_stride, \
+        datatype * u_buffer, \
+        uint32 u_stride, \
+        datatype * v_buffer, \
+        uint32 v_stride, \
+        uint32 width, \
+        uint32 height, \
+        ColorSpaceTypes space) \
+    { \
+        math_impl().math_impl::rgba_to_i420_ ##datatype (src_buffer, src_stride, y_buffer, y_stride, u_buffer, u_stride, v_buffer, v_stride, width, height, space); \
+    } \
+    \
+    static forcedinline void i420_to_rgba_ ##datatype ( \
+        datatype * y_buffer, \
+        uint32 y_stride, \
+        datatype * u_buffer, \
+        uint32 u_stride, \
+        datatype * v_buffer, \
+        uint32 v_stride, \
+        datatype * dst_buffer, \
+        uint32 dst_stride, \
+        uint32 width, \
+        uint32 height, \
+        ColorSpaceTypes space) \
+    { \
+        math_impl().math_impl::i420_to_rgba_ ##datatype (y_buffer, y_stride, u_buffer, u_stride, v_buffer, v_stride, dst_buffer, dst_stride, width, height, space); \
+    } \
+    \
+    static forcedinline void rgba_to_nv12_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 src_stride, \
+        datatype * y_buffer, \
+        uint32 y_stride, \
+        datatype * uv_buffer, \
+        uint32 uv_stride, \
+        uint32 width, \
+        uint32 height, \
+        ColorSpaceTypes space) \
+    { \
+        math_impl().math_impl::rgba_to_nv12_ ##datatype (src_buffer, src_stride, y_buffer, y_stride, uv_buffer, uv_stride, width, height, space); \
+    } \
+    \
+    static forcedinline void nv12_to_rgba_ ##datatype ( \
+        datatype * y_buffer, \
+        uint32 y_stride, \
+        datatype * uv_buffer, \
+        uint32 uv_stride, \
+        datatype * dst_buffer, \
+        uint32 dst_stride, \
+        uint32 width, \
+        uint32 height, \
+        ColorSpaceTypes space) \
+    { \
+        math_impl().math_impl::nv12_to_rgba_ ##datatype (y_buffer, y_stride, uv_buffer, uv_stride, dst_buffer, dst_stride, width, height, space); \
+    } \
+    \
+    static forcedinline void pack_rgba_planes_ ##datatype ( \
+        datatype * red_buffer, \
+        datatype * green_buffer, \
+        datatype * blue_buffer, \
+        datatype * alpha_buffer, \
+        datatype * dst_buffer, \
+        uint32 pixels) \
+    { \
+        math_impl().math_impl::pack_rgba_planes_ ##datatype (red_buffer, green_buffer, blue_buffer, alpha_buffer, dst_buffer, pixels); \
+    } \
+    \
+    static forcedinline void unpack_rgba_planes_ ##datatype ( \
+        datatype * src_buffer, \
+        datatype * red_buffer, \
+        datatype * green_buffer, \
+        datatype * blue_buffer, \
+        datatype * alpha_buffer, \
+        uint32 pixels) \
+    { \
+        math_impl().math_impl::unpack_rgba_planes_ ##datatype (src_buffer, red_buffer, green_buffer, blue_buffer, alpha_buffer, pixels); \
+    }
+
+#define math_dispatch_image_functions(datatype) \
+    static forcedinline void convolve_rows_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 src_stride, \
+        datatype * dst_buffer, \
+        uint32 dst_stride, \
+        uint32 width, \
+        uint32 height, \
+        datatype * kernel, \
+        uint32 kernel_size) \
+    { \
+        math_impl().math_impl::convolve_rows_ ##datatype (src_buffer, src_stride, dst_buffer, dst_stride, width, height, kernel, kernel_size); \
+    } \
+    \
+    static forcedinline void convolve_columns_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 src_stride, \
+        datatype * dst_buffer, \
+        uint32 dst_stride, \
+        uint32 width, \
+        uint32 height, \
+        datatype * kernel, \
+        uint32 kernel_size) \
+    { \
+        math_impl().math_impl::convolve_columns_ ##datatype (src_buffer, src_stride, dst_buffer, dst_stride, width, height, kernel, kernel_size); \
+    } \
+    \
+    static forcedinline void box_blur_rows_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 src_stride, \
+        datatype * dst_buffer, \
+        uint32 dst_stride, \
+        uint32 width, \
+        uint32 height, \
+        uint32 radius) \
+    { \
+        math_impl().math_impl::box_blur_rows_ ##datatype (src_buffer, src_stride, dst_buffer, dst_stride, width, height, radius); \
+    } \
+    \
+    static forcedinline void box_blur_columns_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 src_stride, \
+        datatype * dst_buffer, \
+        uint32 dst_stride, \
+        uint32 width, \
+        uint32 height, \
+        uint32 radius) \
+    { \
+        math_impl().math_impl::box_blur_columns_ ##datatype (src_buffer, src_stride, dst_buffer, dst_stride, width, height, radius); \
+    }
+
+#define math_dispatch_resize_functions(datatype) \
+    static forcedinline void resize_rows_ ##datatype ( \
+        datatype * src_buffer, \
+        uint32 src_stride, \
+        float * dst_buffer, \
+        uint32 dst_stride, \
+        uint32 width, \
+        uint32 height, \
+        uint32 channels, \
+        float * coefficients, \
+        uint32 taps, \
+        uint32 * offsets) \
+    { \
+        math_impl().math_impl::resize_rows_ ##datatype (src_buffer, src_stride, dst_buffer, dst_stride, width, height, channels, coefficients, taps, offsets); \
+    } \
+    \
+    static forcedinline void resize_columns_ ##datatype ( \
+        float * src_buffer, \
+        uint32 src_stride, \
+        datatype * dst_buffer, \
+        uint32 dst_stride, \
+        uint32 width, \
+        uint32 height, \
+        float * coefficients, \
+        uint32 taps, \
+        uint32 * offsets) \
+    { \
+        math_impl().math_impl::resize_columns_ ##datatype (src_buffer, src_stride, dst_buffer, dst_stride, width, height, coefficients, taps, offsets); \
+    }
+
+#define math_dispatch_fill_functions(datatype) \
+    table.clear_buffer_ ##datatype = &clear_buffer_ ##datatype; \
+    table.set_buffer_ ##datatype = &set_buffer_ ##datatype; \
+    table.scale_buffer_ ##datatype = &scale_buffer_ ##datatype; \
+    table.scale_buffer_ ##datatype ##_double_gain = &scale_buffer_ ##datatype; \
+    table.copy_buffer_ ##datatype = &copy_buffer_ ##datatype; \
+    table.add_buffers_ ##datatype = &add_buffers_ ##datatype; \
+    table.subtract_buffers_ ##datatype = &subtract_buffers_ ##datatype; \
+    table.multiply_buffers_ ##datatype = &multiply_buffers_ ##datatype; \
+    table.divide_buffers_ ##datatype = &divide_buffers_ ##datatype; \
+    table.abs_buffer_ ##datatype = &abs_buffer_ ##datatype;
+
+#define math_dispatch_fill_reduction_functions(datatype) \
+    table.sum_buffer_ ##datatype = &sum_buffer_ ##datatype; \
+    table.dot_product_ ##datatype = &dot_product_ ##datatype; \
+    table.min_buffer_ ##datatype = &min_buffer_ ##datatype; \
+    table.max_buffer_ ##datatype = &max_buffer_ ##datatype; \
+    table.peak_abs_buffer_ ##datatype = &peak_abs_buffer_ ##datatype; \
+    table.rms_buffer_ ##datatype = &rms_buffer_ ##datatype;
+
+#define math_dispatch_fill_saturating_functions(datatype) \
+    table.add_buffers_saturate_ ##datatype = &add_buffers_saturate_ ##datatype; \
+    table.subtract_buffers_saturate_ ##datatype = &subtract_buffers_saturate_ ##datatype; \
+    table.scale_buffer_saturate_ ##datatype = &scale_buffer_saturate_ ##datatype; \
+    table.average_buffers_ ##datatype = &average_buffers_ ##datatype;
+
+#define math_dispatch_fill_floating_functions(datatype) \
+    table.multiply_add_buffers_ ##datatype = &multiply_add_buffers_ ##datatype; \
+    table.scale_add_buffer_ ##datatype = &scale_add_buffer_ ##datatype; \
+    table.ramp_scale_buffer_ ##datatype = &ramp_scale_buffer_ ##datatype; \
+    table.exp_ramp_scale_buffer_ ##datatype = &exp_ramp_scale_buffer_ ##datatype;
+
+#define math_dispatch_fill_mixing_functions(datatype) \
+    table.pan_mono_to_stereo_ ##datatype = &pan_mono_to_stereo_ ##datatype; \
+    table.ramp_pan_mono_to_stereo_ ##datatype = &ramp_pan_mono_to_stereo_ ##datatype; \
+    table.balance_stereo_ ##datatype = &balance_stereo_ ##datatype; \
+    table.ramp_balance_stereo_ ##datatype = &ramp_balance_stereo_ ##datatype; \
+    table.mix_dry_wet_ ##datatype = &mix_dry_wet_ ##datatype; \
+    table.ramp_mix_dry_wet_ ##datatype = &ramp_mix_dry_wet_ ##datatype; \
+    table.interleave_buffers_ ##datatype = &interleave_buffers_ ##datatype; \
+    table.deinterleave_buffer_ ##datatype = &deinterleave_buffer_ ##datatype;
+
+#define math_dispatch_fill_conversion_functions(integer, datatype) \
+    table.convert_buffer_ ##integer ##_to_ ##datatype = &convert_buffer_ ##integer ##_to_ ##datatype; \
+    table.convert_buffer_ ##datatype ##_to_ ##integer = &convert_buffer_ ##datatype ##_to_ ##integer;
+
+#define math_dispatch_fill_filter_functions(datatype) \
+    table.process_biquad_bank_ ##datatype = &process_biquad_bank_ ##datatype; \
+    table.process_polyphase_ ##datatype = &process_polyphase_ ##datatype;
+
+#define math_dispatch_fill_transform_functions(datatype) \
+    table.fft_butterflies_ ##datatype = &fft_butterflies_ ##datatype;
+
+#define math_dispatch_fill_dynamics_functions(datatype) \
+    table.process_envelope_bank_ ##datatype = &process_envelope_bank_ ##datatype; \
+    table.compressor_gain_buffer_ ##datatype = &compressor_gain_buffer_ ##datatype; \
+    table.limiter_gain_buffer_ ##datatype = &limiter_gain_buffer_ ##datatype; \
+    table.soft_clip_buffer_ ##datatype = &soft_clip_buffer_ ##datatype;
+
+#define math_dispatch_fill_transcendental_functions(datatype) \
+    table.exp_buffer_ ##datatype = &exp_buffer_ ##datatype; \
+    table.log_buffer_ ##datatype = &log_buffer_ ##datatype; \
+    table.sin_buffer_ ##datatype = &sin_buffer_ ##datatype; \
+    table.cos_buffer_ ##datatype = &cos_buffer_ ##datatype; \
+    table.sincos_buffer_ ##datatype = &sincos_buffer_ ##datatype; \
+    table.tanh_buffer_ ##datatype = &tanh_buffer_ ##datatype; \
+    table.pow_buffer_ ##datatype = &pow_buffer_ ##datatype;
+
+#define math_dispatch_fill_pixel_functions(datatype) \
+    table.premultiply_rgba_ ##datatype = &premultiply_rgba_ ##datatype; \
+    table.unpremultiply_rgba_ ##datatype = &unpremultiply_rgba_ ##datatype; \
+    table.composite_rgba_ ##datatype = &composite_rgba_ ##datatype;
+
+#define math_dispatch_fill_color_functions(datatype) \
+    table.rgba_to_gray_ ##datatype = &rgba_to_gray_ ##datatype; \
+    table.gray_to_rgba_ ##datatype = &gray_to_rgba_ ##datatype; \
+    table.rgba_to_i420_ ##datatype = &rgba_to_i420_ ##datatype; \
+    table.i420_to_rgba_ ##datatype = &i420_to_rgba_ ##datatype; \
+    table.rgba_to_nv12_ ##datatype = &rgba_to_nv12_ ##datatype; \
+    table.nv12_to_rgba_ ##datatype = &nv12_to_rgba_ ##datatype; \
+    table.pack_rgba_planes_ ##datatype = &pack_rgba_planes_ ##datatype; \
+    table.unpack_rgba_planes_ ##datatype = &unpack_rgba_planes_ ##datatype;
+
+#define math_dispatch_fill_image_functions(datatype) \
+    table.convolve_rows_ ##datatype = &convolve_rows_ ##datatype; \
+    table.convolve_columns_ ##datatype = &convolve_columns_ ##datatype; \
+    table.box_blur_rows_ ##datatype = &box_blur_rows_ ##datatype; \
+    table.box_blur_columns_ ##datatype = &box_blur_columns_ ##datatype;
+
+#define math_dispatch_fill_resize_functions(datatype) \
+    table.resize_rows_ ##datatype = &resize_rows_ ##datatype; \
+    table.resize_columns_ ##datatype = &resize_columns_ ##datatype;
+
+
+//------------------------------------------------------------------------------
+
+template<class math_impl>
+class math_dispatch
+{
+public:
+    // Define a name for the math implementation
+    static const char* name()
+    {
+        return math_impl().math_impl::name();
+    }
+
+    // Basic types functions
+    math_dispatch_common_functions(int8)
+    math_dispatch_common_functions(uint8)
+    math_dispatch_common_functions(int16)
+    math_dispatch_common_functions(uint16)
+    math_dispatch_common_functions(int32)
+    math_dispatch_common_functions(uint32)
+    math_dispatch_common_functions(int64)
+    math_dispatch_common_functions(uint64)
+    math_dispatch_common_functions(float)
+    math_dispatch_common_functions(double)
+
+    // Reduction functions
+    math_dispatch_reduction_functions(int8, int64)
+    math_dispatch_reduction_functions(uint8, uint64)
+    math_dispatch_reduction_functions(int16, int64)
+    math_dispatch_reduction_functions(uint16, uint64)
+    math_dispatch_reduction_functions(int32, int64)
+    math_dispatch_reduction_functions(uint32, uint64)
+    math_dispatch_reduction_functions(int64, int64)
+    math_dispatch_reduction_functions(uint64, uint64)
+    math_dispatch_reduction_functions(float, double)
+    math_dispatch_reduction_functions(double, double)
+
+    // Saturating functions
+    math_dispatch_saturating_functions(int8)
+    math_dispatch_saturating_functions(uint8)
+    math_dispatch_saturating_functions(int16)
+    math_dispatch_saturating_functions(uint16)
+
+    // Floating point types functions
+    math_dispatch_floating_functions(float)
+    math_dispatch_floating_functions(double)
+
+    // Mixing functions
+    math_dispatch_mixing_functions(float)
+    math_dispatch_mixing_functions(double)
+
+    // Conversion functions
+    math_dispatch_conversion_functions(int16, float)
+    math_dispatch_conversion_functions(int24, float)
+    math_dispatch_conversion_functions(int32, float)
+    math_dispatch_conversion_functions(int16, double)
+    math_dispatch_conversion_functions(int24, double)
+    math_dispatch_conversion_functions(int32, double)
+
+    // Filter functions
+    math_dispatch_filter_functions(float)
+    math_dispatch_filter_functions(double)
+
+    // Transform functions
+    math_dispatch_transform_functions(float)
+    math_dispatch_transform_functions(double)
+
+    // Dynamics functions
+    math_dispatch_dynamics_functions(float)
+    math_dispatch_dynamics_functions(double)
+
+    // Transcendental functions
+    math_dispatch_transcendental_functions(float)
+    math_dispatch_transcendental_functions(double)
+
+    // Pixel functions
+    math_dispatch_pixel_functions(uint8)
+    math_dispatch_pixel_functions(float)
+
+    // Colour functions
+    math_dispatch_color_functions(uint8)
+
+    // Image functions
+    math_dispatch_image_functions(float)
+
+    // Resize functions
+    math_dispatch_resize_functions(uint8)
+    math_dispatch_resize_functions(float)
+
+    // Other misc functions
+
+    // Fill a dispatch table with the functions of this backend
+    static void fill_dispatch_table(math_dispatch_table& table)
+    {
+        table.name = name();
+
+        math_dispatch_fill_functions(int8)
+        math_dispatch_fill_functions(uint8)
+        math_dispatch_fill_functions(int16)
+        math_dispatch_fill_functions(uint16)
+        math_dispatch_fill_functions(int32)
+        math_dispatch_fill_functions(uint32)
+        math_dispatch_fill_functions(int64)
+        math_dispatch_fill_functions(uint64)
+        math_dispatch_fill_functions(float)
+        math_dispatch_fill_functions(double)
+
+        math_dispatch_fill_reduction_functions(int8)
+        math_dispatch_fill_reduction_functions(uint8)
+        math_dispatch_fill_reduction_functions(int16)
+        math_dispatch_fill_reduction_functions(uint16)
+        math_dispatch_fill_reduction_functions(int32)
+        math_dispatch_fill_reduction_functions(uint32)
+        math_dispatch_fill_reduction_functions(int64)
+        math_dispatch_fill_reduction_functions(uint64)
+        math_dispatch_fill_reduction_functions(float)
+        math_dispatch_fill_reduction_functions(double)
+
+        math_dispatch_fill_saturating_functions(int8)
+        math_dispatch_fill_saturating_functions(uint8)
+        math_dispatch_fill_saturating_functions(int16)
+        math_dispatch_fill_saturating_functions(uint16)
+
+        math_dispatch_fill_floating_functions(float)
+        math_dispatch_fill_floating_functions(double)
+
+        math_dispatch_fill_mixing_functions(float)
+        math_dispatch_fill_mixing_functions(double)
+
+        math_dispatch_fill_conversion_functions(int16, float)
+        math_dispatch_fill_conversion_functions(int24, float)
+        math_dispatch_fill_conversion_functions(int32, float)
+        math_dispatch_fill_conversion_functions(int16, double)
+        math_dispatch_fill_conversion_functions(int24, double)
+        math_dispatch_fill_conversion_functions(int32, double)
+
+        math_dispatch_fill_filter_functions(float)
+        math_dispatch_fill_filter_functions(double)
+
+        math_dispatch_fill_transform_functions(float)
+        math_dispatch_fill_transform_functions(double)
+
+        math_dispatch_fill_dynamics_functions(float)
+        math_dispatch_fill_dynamics_functions(double)
+
+        math_dispatch_fill_transcendental_functions(float)
+        math_dispatch_fill_transcendental_functions(double)
+
+        math_dispatch_fill_pixel_functions(uint8)
+        math_dispatch_fill_pixel_functions(float)
+
+        math_dispatch_fill_color_functions(uint8)
+
+        math_dispatch_fill_image_functions(float)
+
+        math_dispatch_fill_resize_functions(uint8)
+        math_dispatch_fill_resize_functions(float)
+    }
+
+private:
+    // not instantiable
+    math_dispatch();
+};
+
+#endif // __WATERSPOUT_SIMD_ABSTRACTION_FRAMEWORK_MATH_DISPATCH_H__
@@ -49,6 +49,79 @@ struct disable_fpu_denormals
 };
 
 
+//------------------------------------------------------------------------------
+
+/**
+ * Minimax polynomials of the transcendental functions, highest power first,
+ * shared by every backend:
+ *
+ *   e^r    = 1 + r + r^2 P(r)         for |r| <= log(2) / 2
+ *   log(x) = 2 s + s^3 Q(s^2)         for s = (x - 1) / (x + 1), sqrt(1/2) <= x <= sqrt(2)
+ *   sin(r) = r + r^3 S(r^2)           for |r| <= pi / 4
+ *   cos(r) = 1 - r^2 / 2 + r^4 C(r^2) for |r| <= pi / 4
+ */
+
+static const float fast_exp_coefficients_float[] = {
+    4.127774807e-2f, 1.675351392e-1f, 5.000511602e-1f };
+
+static const float accurate_exp_coefficients_float[] = {
+    1.381461326e-3f, 8.368709824e-3f, 4.166838736e-2f, 1.666652069e-1f, 4.999999345e-1f };
+
+static const float fast_log_coefficients_float[] = {
+    4.120291403e-1f, 6.665559955e-1f };
+
+static const float accurate_log_coefficients_float[] = {
+    2.987172776e-1f, 3.997754158e-1f, 6.666677638e-1f };
+
+static const float fast_sin_coefficients_float[] = {
+    8.164608743e-3f, -1.666345853e-1f };
+
+static const float accurate_sin_coefficients_float[] = {
+    -1.951729898e-4f, 8.332178146e-3f, -1.666665494e-1f };
+
+static const float fast_cos_coefficients_float[] = {
+    -1.364871437e-3f, 4.166107131e-2f };
+
+static const float accurate_cos_coefficients_float[] = {
+    2.443315707e-5f, -1.388731625e-3f, 4.166664568e-2f };
+
+static const double fast_exp_coefficients_double[] = {
+    2.470828934082064884e-5, 1.990893892804375604e-4, 1.388919712869778143e-3,
+    8.333281808108539829e-3, 4.166666440509034230e-2, 1.666666678444174710e-1,
+    5.000000000426807478e-1 };
+
+static const double accurate_exp_coefficients_double[] = {
+    2.500007229215124423e-8, 2.763023391495863563e-7, 2.755758626640848604e-6,
+    2.480149313619725378e-5, 1.984126950677966373e-4, 1.388888894359768984e-3,
+    8.333333333494332903e-3, 4.166666666653026652e-2, 1.666666666666641317e-1,
+    5.000000000000011102e-1 };
+
+static const double fast_log_coefficients_double[] = {
+    2.358215138902622354e-1, 2.853730853675245371e-1, 4.000033519098376567e-1,
+    6.666666564545578044e-1 };
+
+static const double accurate_log_coefficients_double[] = {
+    1.479594970058285830e-1, 1.531405055211271238e-1, 1.818356432611967499e-1,
+    2.222219857318452341e-1, 2.857142874238762231e-1, 3.999999999941467599e-1,
+    6.666666666666734020e-1 };
+
+static const double fast_sin_coefficients_double[] = {
+    2.718311667725400663e-6, -1.983933485411432899e-4, 8.333329385944736670e-3,
+    -1.666666664162699263e-1 };
+
+static const double accurate_sin_coefficients_double[] = {
+    1.589682793015204808e-10, -2.505075865328764964e-8, 2.755731369522659467e-6,
+    -1.984126982981695021e-4, 8.333333333322425276e-3, -1.666666666666663243e-1 };
+
+static const double fast_cos_coefficients_double[] = {
+    -2.720575548978892654e-7, 2.479946017066843059e-5, -1.388888350013967694e-3,
+    4.166666661949213618e-2 };
+
+static const double accurate_cos_coefficients_double[] = {
+    -1.135853651741480326e-11, 2.087570084189222715e-9, -2.755731417929607832e-7,
+    2.480158728885170042e-5, -1.388888888887305573e-3, 4.166666666666659496e-2 };
+
+
 //==============================================================================
 
 //------------------------------------------------------------------------------
@@ -153,50 +226,3464 @@ public:
             uint32 size) const \
         { \
             divide_buffers_generic(src_buffer_a, src_buffer_b, dst_buffer, size); \
+        } \
+        \
+        void abs_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size) const \
+        { \
+            abs_buffer_generic(src_buffer, size); \
         }
 
 
-    //==========================================================================
+    //--------------------------------------------------------------------------
+
+    #define math_fpu_reduction_functions_impl(datatype, accumtype) \
+        accumtype sum_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size) const \
+        { \
+            return sum_buffer_generic<accumtype>(src_buffer, size); \
+        } \
+        \
+        accumtype dot_product_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            uint32 size) const \
+        { \
+            return dot_product_generic<accumtype>(src_buffer_a, src_buffer_b, size); \
+        } \
+        \
+        datatype min_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            uint32* index) const \
+        { \
+            return min_buffer_generic(src_buffer, size, index); \
+        } \
+        \
+        datatype max_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            uint32* index) const \
+        { \
+            return max_buffer_generic(src_buffer, size, index); \
+        } \
+        \
+        accumtype peak_abs_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size) const \
+        { \
+            return peak_abs_buffer_generic<accumtype>(src_buffer, size); \
+        } \
+        \
+        double rms_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size) const \
+        { \
+            return rms_buffer_generic(src_buffer, size); \
+        }
+
 
     //--------------------------------------------------------------------------
 
-    math_fpu_common_functions_impl(int8)
-    math_fpu_common_functions_impl(uint8)
-    math_fpu_common_functions_impl(int16)
-    math_fpu_common_functions_impl(uint16)
-    math_fpu_common_functions_impl(int32)
-    math_fpu_common_functions_impl(uint32)
-    math_fpu_common_functions_impl(int64)
-    math_fpu_common_functions_impl(uint64)
+    #define math_fpu_saturating_functions_impl(datatype) \
+        void add_buffers_saturate_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            add_buffers_saturate_generic(src_buffer_a, src_buffer_b, dst_buffer, size); \
+        } \
+        \
+        void subtract_buffers_saturate_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            subtract_buffers_saturate_generic(src_buffer_a, src_buffer_b, dst_buffer, size); \
+        } \
+        \
+        void scale_buffer_saturate_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            float gain) const \
+        { \
+            scale_buffer_saturate_generic(src_buffer, size, gain); \
+        } \
+        \
+        void average_buffers_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            average_buffers_generic(src_buffer_a, src_buffer_b, dst_buffer, size); \
+        }
 
 
-    //==========================================================================
+    //--------------------------------------------------------------------------
+
+    // the mixing functions turn their positions into channel gains, then go
+    // through the gain kernels of the most derived backend
+
+    #define math_fpu_mixing_functions_impl(datatype) \
+        void pan_mono_to_stereo_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_left_buffer, \
+            datatype* dst_right_buffer, \
+            uint32 size, \
+            datatype pan, \
+            PanLawTypes law) const \
+        { \
+            datatype left_gain, right_gain; \
+            pan_gains(pan, law, left_gain, right_gain); \
+            \
+            stereo_gain_buffers_ ##datatype (src_buffer, src_buffer, \
+                dst_left_buffer, dst_right_buffer, size, left_gain, right_gain); \
+        } \
+        \
+        void ramp_pan_mono_to_stereo_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_left_buffer, \
+            datatype* dst_right_buffer, \
+            uint32 size, \
+            datatype start_pan, \
+            datatype end_pan, \
+            PanLawTypes law) const \
+        { \
+            if (size == 0) \
+                return; \
+            \
+            datatype start_left, start_right, end_left, end_right; \
+            pan_gains(start_pan, law, start_left, start_right); \
+            pan_gains(end_pan, law, end_left, end_right); \
+            \
+            ramp_stereo_gain_buffers_ ##datatype (src_buffer, src_buffer, \
+                dst_left_buffer, dst_right_buffer, size, \
+                start_left, ramp_increment(start_left, end_left, size), \
+                start_right, ramp_increment(start_right, end_right, size)); \
+        } \
+        \
+        void balance_stereo_ ##datatype ( \
+            datatype* left_buffer, \
+            datatype* right_buffer, \
+            uint32 size, \
+            datatype balance) const \
+        { \
+            datatype left_gain, right_gain; \
+            balance_gains(balance, left_gain, right_gain); \
+            \
+            stereo_gain_buffers_ ##datatype (left_buffer, right_buffer, \
+                left_buffer, right_buffer, size, left_gain, right_gain); \
+        } \
+        \
+        void ramp_balance_stereo_ ##datatype ( \
+            datatype* left_buffer, \
+            datatype* right_buffer, \
+            uint32 size, \
+            datatype start_balance, \
+            datatype end_balance) const \
+        { \
+            if (size == 0) \
+                return; \
+            \
+            datatype start_left, start_right, end_left, end_right; \
+            balance_gains(start_balance, start_left, start_right); \
+            balance_gains(end_balance, end_left, end_right); \
+            \
+            ramp_stereo_gain_buffers_ ##datatype (left_buffer, right_buffer, \
+                left_buffer, right_buffer, size, \
+                start_left, ramp_increment(start_left, end_left, size), \
+                start_right, ramp_increment(start_right, end_right, size)); \
+        } \
+        \
+        void mix_dry_wet_ ##datatype ( \
+            datatype* dry_buffer, \
+            datatype* wet_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype mix) const \
+        { \
+            datatype dry_gain, wet_gain; \
+            mix_gains(mix, dry_gain, wet_gain); \
+            \
+            mix_gain_buffers_ ##datatype (dry_buffer, wet_buffer, \
+                dst_buffer, size, dry_gain, wet_gain); \
+        } \
+        \
+        void ramp_mix_dry_wet_ ##datatype ( \
+            datatype* dry_buffer, \
+            datatype* wet_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype start_mix, \
+            datatype end_mix) const \
+        { \
+            if (size == 0) \
+                return; \
+            \
+            datatype start_dry, start_wet, end_dry, end_wet; \
+            mix_gains(start_mix, start_dry, start_wet); \
+            mix_gains(end_mix, end_dry, end_wet); \
+            \
+            ramp_mix_gain_buffers_ ##datatype (dry_buffer, wet_buffer, \
+                dst_buffer, size, \
+                start_dry, ramp_increment(start_dry, end_dry, size), \
+                start_wet, ramp_increment(start_wet, end_wet, size)); \
+        } \
+        \
+        void interleave_buffers_ ##datatype ( \
+            datatype** src_buffers, \
+            datatype* dst_buffer, \
+            uint32 channels, \
+            uint32 size) const \
+        { \
+            interleave_generic(src_buffers, dst_buffer, channels, 0, channels, 0, size); \
+        } \
+        \
+        void deinterleave_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype** dst_buffers, \
+            uint32 channels, \
+            uint32 size) const \
+        { \
+            deinterleave_generic(src_buffer, dst_buffers, channels, 0, channels, 0, size); \
+        }
+
 
     //--------------------------------------------------------------------------
 
-    void clear_buffer_float(
-        float* src_buffer,
-        uint32 size) const
-    {
-        clear_buffer_generic(src_buffer, size);
-    }
+    // the format limits are computed before switching the rounding mode, the
+    // simd backends run the same generics for their leftovers
+
+    #define math_fpu_conversion_functions_impl(integer, datatype, bits) \
+        void convert_buffer_ ##integer ##_to_ ##datatype ( \
+            integer* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            convert_from_integer_generic(src_buffer, dst_buffer, size, \
+                integer_format<datatype>(bits)); \
+        } \
+        \
+        void convert_buffer_ ##datatype ##_to_ ##integer ( \
+            datatype* src_buffer, \
+            integer* dst_buffer, \
+            uint32 size, \
+            FloatRoundingModeTypes rounding, \
+            uint32* dither_seed) const \
+        { \
+            const integer_format<datatype> format(bits); \
+            const float_rounding_mode round_mode(rounding); \
+            \
+            convert_to_integer_generic(src_buffer, dst_buffer, size, \
+                format, dither_seed, 0); \
+            \
+            advance_dither_seed(dither_seed, size); \
+        }
 
 
     //--------------------------------------------------------------------------
 
-    void set_buffer_float(
-        float* src_buffer,
-        uint32 size,
-        float value) const
-    {
-        set_buffer_generic(src_buffer, size, value);
+    // the state decays towards denormals once the input stops, so the
+    // floating point assertions are kept off while filtering
+
+    #define math_fpu_filter_functions_impl(datatype) \
+        void process_biquad_bank_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 channels, \
+            uint32 frames, \
+            datatype* coefficients, \
+            datatype* state, \
+            uint32 sections) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            biquad_bank_generic(src_buffer, dst_buffer, channels, frames, \
+                coefficients, state, sections, 0); \
+        } \
+        \
+        void process_polyphase_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype* coefficients, \
+            uint32 taps, \
+            uint32* rows, \
+            uint32* offsets) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            for (uint32 i = 0; i < size; ++i) \
+            { \
+                dst_buffer[i] = polyphase_row_generic(src_buffer + offsets[i], \
+                    coefficients + rows[i] * taps, 0, taps, datatype(0)); \
+            } \
+        }
+
+
+    //--------------------------------------------------------------------------
+
+    // the passes go through the radix 4 kernel of the most derived backend,
+    // which vectorizes the ones spanning at least a register
+
+    #define math_fpu_transform_functions_impl(datatype) \
+        void fft_butterflies_ ##datatype ( \
+            datatype* real_buffer, \
+            datatype* imag_buffer, \
+            uint32 size, \
+            const datatype* twiddles) const \
+        { \
+            uint32 span = 1; \
+            \
+            if (fft_needs_radix2_pass(size)) \
+            { \
+                const disable_fpu_denormals disable_denormals; \
+                \
+                fft_radix2_pass_generic(real_buffer, imag_buffer, size); \
+                span = 2; \
+            } \
+            \
+            for (; span < size; span *= 4) \
+            { \
+                fft_radix4_pass_ ##datatype (real_buffer, imag_buffer, size, span, twiddles); \
+                twiddles += 6 * span; \
+            } \
+        }
+
+
+    //--------------------------------------------------------------------------
+
+    // envelopes decay towards denormals like the filter states do, and the
+    // squares of the gain curves can underflow
+
+    #define math_fpu_dynamics_functions_impl(datatype) \
+        void process_envelope_bank_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 channels, \
+            uint32 frames, \
+            datatype* coefficients, \
+            datatype* state, \
+            EnvelopeModeTypes mode) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            envelope_bank_generic(src_buffer, dst_buffer, channels, frames, \
+                coefficients, state, mode, 0); \
+        } \
+        \
+        void compressor_gain_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype threshold, \
+            datatype ratio, \
+            datatype knee) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            compressor_gain_generic(src_buffer, dst_buffer, size, threshold, ratio, knee, 0); \
+        } \
+        \
+        void limiter_gain_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype threshold) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            limiter_gain_generic(src_buffer, dst_buffer, size, threshold, 0); \
+        } \
+        \
+        void soft_clip_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            soft_clip_generic(src_buffer, dst_buffer, size, 0); \
+        }
+
+
+    //--------------------------------------------------------------------------
+
+    // the polynomials underflow at the low end of exp, and the special values
+    // come out of operations on infinities
+
+    #define math_fpu_transcendental_functions_impl(datatype) \
+        void exp_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            exp_generic(src_buffer, dst_buffer, size, accuracy, 0); \
+        } \
+        \
+        void log_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            log_generic(src_buffer, dst_buffer, size, accuracy, 0); \
+        } \
+        \
+        void sin_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            sincos_generic(src_buffer, dst_buffer, (datatype*)0, size, accuracy, 0); \
+        } \
+        \
+        void cos_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            sincos_generic(src_buffer, (datatype*)0, dst_buffer, size, accuracy, 0); \
+        } \
+        \
+        void sincos_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* sin_buffer, \
+            datatype* cos_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            sincos_generic(src_buffer, sin_buffer, cos_buffer, size, accuracy, 0); \
+        } \
+        \
+        void tanh_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            tanh_generic(src_buffer, dst_buffer, size, accuracy, 0); \
+        } \
+        \
+        void pow_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* exponent_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            pow_generic(src_buffer, exponent_buffer, dst_buffer, size, accuracy, 0); \
+        }
+
+
+    //--------------------------------------------------------------------------
+
+    // products of small float channels can underflow
+
+    #define math_fpu_pixel_functions_impl(datatype) \
+        void premultiply_rgba_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 pixels) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            premultiply_rgba_generic(src_buffer, dst_buffer, pixels, 0); \
+        } \
+        \
+        void unpremultiply_rgba_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 pixels) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            unpremultiply_rgba_generic(src_buffer, dst_buffer, pixels, 0); \
+        } \
+        \
+        void composite_rgba_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* backdrop_buffer, \
+            datatype* dst_buffer, \
+            uint32 pixels, \
+            CompositeModeTypes mode) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            composite_rgba_generic(src_buffer, backdrop_buffer, dst_buffer, pixels, mode, 0); \
+        }
+
+
+    //--------------------------------------------------------------------------
+
+    // frame loops of the colour functions, the simd backends vectorize the
+    // row kernels they call
+
+    #define math_fpu_color_functions_impl(datatype) \
+        void rgba_to_gray_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 pixels, \
+            ColorSpaceTypes space) const \
+        { \
+            rgba_to_luma_row_ ##datatype (src_buffer, dst_buffer, pixels, color_matrix(space)); \
+        } \
+        \
+        void gray_to_rgba_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 pixels, \
+            ColorSpaceTypes space) const \
+        { \
+            luma_to_rgba_row_ ##datatype (src_buffer, dst_buffer, pixels, color_matrix(space)); \
+        } \
+        \
+        void rgba_to_i420_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 src_stride, \
+            datatype* y_buffer, \
+            uint32 y_stride, \
+            datatype* u_buffer, \
+            uint32 u_stride, \
+            datatype* v_buffer, \
+            uint32 v_stride, \
+            uint32 width, \
+            uint32 height, \
+            ColorSpaceTypes space) const \
+        { \
+            const color_matrix matrix(space); \
+            \
+            for (uint32 row = 0; row < height; row += 2) \
+            { \
+                datatype* src_row = src_buffer + row * src_stride; \
+                datatype* next_row = row + 1 < height ? src_row + src_stride : src_row; \
+                \
+                rgba_to_luma_row_ ##datatype (src_row, y_buffer + row * y_stride, width, matrix); \
+                if (row + 1 < height) \
+                    rgba_to_luma_row_ ##datatype (next_row, y_buffer + (row + 1) * y_stride, width, matrix); \
+                \
+                rgba_to_chroma_row_ ##datatype (src_row, next_row, \
+                    u_buffer + (row / 2) * u_stride, v_buffer + (row / 2) * v_stride, 1, width, matrix); \
+            } \
+        } \
+        \
+        void i420_to_rgba_ ##datatype ( \
+            datatype* y_buffer, \
+            uint32 y_stride, \
+            datatype* u_buffer, \
+            uint32 u_stride, \
+            datatype* v_buffer, \
+            uint32 v_stride, \
+            datatype* dst_buffer, \
+            uint32 dst_stride, \
+            uint32 width, \
+            uint32 height, \
+            ColorSpaceTypes space) const \
+        { \
+            const color_matrix matrix(space); \
+            \
+            for (uint32 row = 0; row < height; ++row) \
+            { \
+                yuv_to_rgba_row_ ##datatype (y_buffer + row * y_stride, \
+                    u_buffer + (row / 2) * u_stride, v_buffer + (row / 2) * v_stride, 1, \
+                    dst_buffer + row * dst_stride, width, matrix); \
+            } \
+        } \
+        \
+        void rgba_to_nv12_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 src_stride, \
+            datatype* y_buffer, \
+            uint32 y_stride, \
+            datatype* uv_buffer, \
+            uint32 uv_stride, \
+            uint32 width, \
+            uint32 height, \
+            ColorSpaceTypes space) const \
+        { \
+            const color_matrix matrix(space); \
+            \
+            for (uint32 row = 0; row < height; row += 2) \
+            { \
+                datatype* src_row = src_buffer + row * src_stride; \
+                datatype* next_row = row + 1 < height ? src_row + src_stride : src_row; \
+                datatype* uv_row = uv_buffer + (row / 2) * uv_stride; \
+                \
+                rgba_to_luma_row_ ##datatype (src_row, y_buffer + row * y_stride, width, matrix); \
+                if (row + 1 < height) \
+                    rgba_to_luma_row_ ##datatype (next_row, y_buffer + (row + 1) * y_stride, width, matrix); \
+                \
+                rgba_to_chroma_row_ ##datatype (src_row, next_row, uv_row, uv_row + 1, 2, width, matrix); \
+            } \
+        } \
+        \
+        void nv12_to_rgba_ ##datatype ( \
+            datatype* y_buffer, \
+            uint32 y_stride, \
+            datatype* uv_buffer, \
+            uint32 uv_stride, \
+            datatype* dst_buffer, \
+            uint32 dst_stride, \
+            uint32 width, \
+            uint32 height, \
+            ColorSpaceTypes space) const \
+        { \
+            const color_matrix matrix(space); \
+            \
+            for (uint32 row = 0; row < height; ++row) \
+            { \
+                datatype* uv_row = uv_buffer + (row / 2) * uv_stride; \
+                \
+                yuv_to_rgba_row_ ##datatype (y_buffer + row * y_stride, uv_row, uv_row + 1, 2, \
+                    dst_buffer + row * dst_stride, width, matrix); \
+            } \
+        } \
+        \
+        void pack_rgba_planes_ ##datatype ( \
+            datatype* red_buffer, \
+            datatype* green_buffer, \
+            datatype* blue_buffer, \
+            datatype* alpha_buffer, \
+            datatype* dst_buffer, \
+            uint32 pixels) const \
+        { \
+            pack_rgba_planes_generic(red_buffer, green_buffer, blue_buffer, alpha_buffer, dst_buffer, pixels, 0); \
+        } \
+        \
+        void unpack_rgba_planes_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* red_buffer, \
+            datatype* green_buffer, \
+            datatype* blue_buffer, \
+            datatype* alpha_buffer, \
+            uint32 pixels) const \
+        { \
+            unpack_rgba_planes_generic(src_buffer, red_buffer, green_buffer, blue_buffer, alpha_buffer, pixels, 0); \
+        }
+
+
+    //--------------------------------------------------------------------------
+
+    // frame loops of the image functions, rows go one at a time through the
+    // row kernels and columns by tiles through the tile kernels
+
+    #define math_fpu_image_functions_impl(datatype) \
+        void convolve_rows_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 src_stride, \
+            datatype* dst_buffer, \
+            uint32 dst_stride, \
+            uint32 width, \
+            uint32 height, \
+            datatype* kernel, \
+            uint32 kernel_size) const \
+        { \
+            for (uint32 row = 0; row < height; ++row) \
+            { \
+                convolve_row_ ##datatype (src_buffer + row * src_stride, dst_buffer + row * dst_stride, \
+                    width, kernel, kernel_size); \
+            } \
+        } \
+        \
+        void convolve_columns_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 src_stride, \
+            datatype* dst_buffer, \
+            uint32 dst_stride, \
+            uint32 width, \
+            uint32 height, \
+            datatype* kernel, \
+            uint32 kernel_size) const \
+        { \
+            for (uint32 column = 0; column < width; column += image_tile_columns) \
+            { \
+                const uint32 columns = width - column < image_tile_columns ? width - column : uint32(image_tile_columns); \
+                \
+                convolve_column_tile_ ##datatype (src_buffer + column, src_stride, dst_buffer + column, dst_stride, \
+                    columns, height, kernel, kernel_size); \
+            } \
+        } \
+        \
+        void box_blur_rows_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 src_stride, \
+            datatype* dst_buffer, \
+            uint32 dst_stride, \
+            uint32 width, \
+            uint32 height, \
+            uint32 radius) const \
+        { \
+            for (uint32 row = 0; row < height; ++row) \
+            { \
+                box_blur_row_ ##datatype (src_buffer + row * src_stride, dst_buffer + row * dst_stride, \
+                    width, radius); \
+            } \
+        } \
+        \
+        void box_blur_columns_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 src_stride, \
+            datatype* dst_buffer, \
+            uint32 dst_stride, \
+            uint32 width, \
+            uint32 height, \
+            uint32 radius) const \
+        { \
+            for (uint32 column = 0; column < width; column += image_tile_columns) \
+            { \
+                const uint32 columns = width - column < image_tile_columns ? width - column : uint32(image_tile_columns); \
+                \
+                box_blur_column_tile_ ##datatype (src_buffer + column, src_stride, dst_buffer + column, dst_stride, \
+                    columns, height, radius); \
+            } \
+        }
+
+
+    //--------------------------------------------------------------------------
+
+    // frame loops of the resize functions, through the same row kernels and
+    // column tiles as the image functions
+
+    #define math_fpu_resize_functions_impl(datatype) \
+        void resize_rows_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 src_stride, \
+            float* dst_buffer, \
+            uint32 dst_stride, \
+            uint32 width, \
+            uint32 height, \
+            uint32 channels, \
+            float* coefficients, \
+            uint32 taps, \
+            uint32* offsets) const \
+        { \
+            for (uint32 row = 0; row < height; ++row) \
+            { \
+                resize_row_ ##datatype (src_buffer + row * src_stride, dst_buffer + row * dst_stride, \
+                    width, channels, coefficients, taps, offsets); \
+            } \
+        } \
+        \
+        void resize_columns_ ##datatype ( \
+            float* src_buffer, \
+            uint32 src_stride, \
+            datatype* dst_buffer, \
+            uint32 dst_stride, \
+            uint32 width, \
+            uint32 height, \
+            float* coefficients, \
+            uint32 taps, \
+            uint32* offsets) const \
+        { \
+            for (uint32 column = 0; column < width; column += image_tile_columns) \
+            { \
+                const uint32 columns = width - column < image_tile_columns ? width - column : uint32(image_tile_columns); \
+                \
+                resize_column_tile_ ##datatype (src_buffer + column, src_stride, dst_buffer + column, dst_stride, \
+                    columns, height, coefficients, taps, offsets); \
+            } \
+        }
+
+
+    //==========================================================================
+
+    //--------------------------------------------------------------------------
+
+    math_fpu_common_functions_impl(int8)
+    math_fpu_common_functions_impl(uint8)
+    math_fpu_common_functions_impl(int16)
+    math_fpu_common_functions_impl(uint16)
+    math_fpu_common_functions_impl(int32)
+    math_fpu_common_functions_impl(uint32)
+    math_fpu_common_functions_impl(int64)
+    math_fpu_common_functions_impl(uint64)
+
+    math_fpu_reduction_functions_impl(int8, int64)
+    math_fpu_reduction_functions_impl(uint8, uint64)
+    math_fpu_reduction_functions_impl(int16, int64)
+    math_fpu_reduction_functions_impl(uint16, uint64)
+    math_fpu_reduction_functions_impl(int32, int64)
+    math_fpu_reduction_functions_impl(uint32, uint64)
+    math_fpu_reduction_functions_impl(int64, int64)
+    math_fpu_reduction_functions_impl(uint64, uint64)
+
+    math_fpu_saturating_functions_impl(int8)
+    math_fpu_saturating_functions_impl(uint8)
+    math_fpu_saturating_functions_impl(int16)
+    math_fpu_saturating_functions_impl(uint16)
+
+
+    //==========================================================================
+
+    //--------------------------------------------------------------------------
+
+    void clear_buffer_float(
+        float* src_buffer,
+        uint32 size) const
+    {
+        clear_buffer_generic(src_buffer, size);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void set_buffer_float(
+        float* src_buffer,
+        uint32 size,
+        float value) const
+    {
+        set_buffer_generic(src_buffer, size, value);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void scale_buffer_float(
+        float* src_buffer,
+        uint32 size,
+        float gain) const
+    {
+        const disable_fpu_denormals disable_denormals;
+
+        for (uint32 i = 0; i < size; ++i)
+        {
+            *src_buffer = *src_buffer * gain;
+          undenormalizef(*src_buffer);
+            ++src_buffer;
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void scale_buffer_float(
+        float* src_buffer,
+        uint32 size,
+        double gain) const
+    {
+        const disable_fpu_denormals disable_denormals;
+
+        for (uint32 i = 0; i < size; ++i)
+        {
+            *src_buffer = *src_buffer * static_cast<float>(gain);
+          undenormalizef(*src_buffer);
+            ++src_buffer;
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    void copy_buffer_float(
+        float* src_buffer,
+        float* dst_buffer,
+        uint32 size) const
+    {
+        copy_buffer_generic(src_buffer, dst_buffer, size);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void add_buffers_float(
+        float* src_buffer_a,
+        float* src_buffer_b,
+        float* dst_buffer,
+        uint32 size) const
+    {
+        add_buffers_generic(src_buffer_a, src_buffer_b, dst_buffer, size);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void subtract_buffers_float(
+        float* src_buffer_a,
+        float* src_buffer_b,
+        float* dst_buffer,
+        uint32 size) const
+    {
+        subtract_buffers_generic(src_buffer_a, src_buffer_b, dst_buffer, size);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void multiply_buffers_float(
+        float* src_buffer_a,
+        float* src_buffer_b,
+        float* dst_buffer,
+        uint32 size) const
+    {
+        const disable_fpu_denormals disable_denormals;
+
+        for (uint32 i = 0; i < size; ++i)
+        {
+          *dst_buffer = *src_buffer_a++ * *src_buffer_b++;
+          undenormalizef(*dst_buffer);
+          ++dst_buffer;
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void divide_buffers_float(
+        float* src_buffer_a,
+        float* src_buffer_b,
+        float* dst_buffer,
+        uint32 size) const
+    {
+        const disable_fpu_denormals disable_denormals;
+
+        for (uint32 i = 0; i < size; ++i)
+        {
+          *dst_buffer = *src_buffer_a++ / *src_buffer_b++;
+          undenormalizef(*dst_buffer);
+          ++dst_buffer;
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void abs_buffer_float(
+        float* src_buffer,
+        uint32 size) const
+    {
+        abs_buffer_generic(src_buffer, size);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void multiply_add_buffers_float(
+        float* src_buffer_a,
+        float* src_buffer_b,
+        float* src_buffer_c,
+        float* dst_buffer,
+        uint32 size) const
+    {
+        const disable_fpu_denormals disable_denormals;
+
+        for (uint32 i = 0; i < size; ++i)
+        {
+          *dst_buffer = *src_buffer_a++ * *src_buffer_b++ + *src_buffer_c++;
+          undenormalizef(*dst_buffer);
+          ++dst_buffer;
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void scale_add_buffer_float(
+        float* src_buffer,
+        float* dst_buffer,
+        uint32 size,
+        float gain) const
+    {
+        const disable_fpu_denormals disable_denormals;
+
+        for (uint32 i = 0; i < size; ++i)
+        {
+          *dst_buffer = *dst_buffer + *src_buffer++ * gain;
+          undenormalizef(*dst_buffer);
+          ++dst_buffer;
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void ramp_scale_buffer_float(
+        float* src_buffer,
+        uint32 size,
+        float start_gain,
+        float end_gain) const
+    {
+        if (size == 0)
+            return;
+
+        const disable_fpu_denormals disable_denormals;
+
+        ramp_scale_generic(src_buffer, size, start_gain,
+            ramp_increment(start_gain, end_gain, size), 0);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void exp_ramp_scale_buffer_float(
+        float* src_buffer,
+        uint32 size,
+        float start_gain,
+        float end_gain) const
+    {
+        if (! is_exp_ramp(start_gain, end_gain, size))
+        {
+            ramp_scale_buffer_float(src_buffer, size, start_gain, end_gain);
+            return;
+        }
+
+        const disable_fpu_denormals disable_denormals;
+
+        exp_ramp_scale_generic(src_buffer, size, start_gain,
+            exp_ramp_log_ratio(start_gain, end_gain, size), 0);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    double sum_buffer_float(
+        float* src_buffer,
+        uint32 size) const
+    {
+        // double has enough room to accumulate floats without compensation
+        double result = 0.0;
+
+        for (uint32 i = 0; i < size; ++i)
+        {
+          result += static_cast<double>(*src_buffer++);
+        }
+
+        return result;
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    double dot_product_float(
+        float* src_buffer_a,
+        float* src_buffer_b,
+        uint32 size) const
+    {
+        double result = 0.0;
+
+        for (uint32 i = 0; i < size; ++i)
+        {
+          result += static_cast<double>(*src_buffer_a++) * static_cast<double>(*src_buffer_b++);
+        }
+
+        return result;
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    float min_buffer_float(
+        float* src_buffer,
+        uint32 size,
+        uint32* index) const
+    {
+        return min_buffer_generic(src_buffer, size, index);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    float max_buffer_float(
+        float* src_buffer,
+        uint32 size,
+        uint32* index) const
+    {
+        return max_buffer_generic(src_buffer, size, index);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    double peak_abs_buffer_float(
+        float* src_buffer,
+        uint32 size) const
+    {
+        float result = 0;
+
+        for (uint32 i = 0; i < size; ++i)
+        {
+          const float value = std::fabs(*src_buffer++);
+          if (value > result)
+              result = value;
+        }
+
+        return result;
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    double rms_buffer_float(
+        float* src_buffer,
+        uint32 size) const
+    {
+        // goes through the dot product of the most derived backend
+        return rms_from_sum_of_squares(dot_product_float(src_buffer, src_buffer, size), size);
+    }
+
+
+    //==========================================================================
+
+    //--------------------------------------------------------------------------
+
+    void clear_buffer_double(
+        double* src_buffer,
+        uint32 size) const
+    {
+        clear_buffer_generic(src_buffer, size);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void set_buffer_double(
+        double* src_buffer,
+        uint32 size,
+        double value) const
+    {
+        set_buffer_generic(src_buffer, size, value);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void scale_buffer_double(
+        double* src_buffer,
+        uint32 size,
+        float gain) const
+    {
+        const disable_fpu_denormals disable_denormals;
+
+        for (uint32 i = 0; i < size; ++i)
+        {
+            *src_buffer = *src_buffer * (double)gain;
+          undenormalized(*src_buffer);
+            ++src_buffer;
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void scale_buffer_double(
+        double* src_buffer,
+        uint32 size,
+        double gain) const
+    {
+        const disable_fpu_denormals disable_denormals;
+
+        for (uint32 i = 0; i < size; ++i)
+        {
+            *src_buffer = *src_buffer * gain;
+          undenormalized(*src_buffer);
+            ++src_buffer;
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void copy_buffer_double(
+        double* src_buffer,
+        double* dst_buffer,
+        uint32 size) const
+    {
+        for (uint32 i = 0; i < size; ++i)
+        {
+          *dst_buffer++ = *src_buffer++;
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void add_buffers_double(
+        double* src_buffer_a,
+        double* src_buffer_b,
+        double* dst_buffer,
+        uint32 size) const
+    {
+        add_buffers_generic(src_buffer_a, src_buffer_b, dst_buffer, size);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void subtract_buffers_double(
+        double* src_buffer_a,
+        double* src_buffer_b,
+        double* dst_buffer,
+        uint32 size) const
+    {
+        subtract_buffers_generic(src_buffer_a, src_buffer_b, dst_buffer, size);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void multiply_buffers_double(
+        double* src_buffer_a,
+        double* src_buffer_b,
+        double* dst_buffer,
+        uint32 size) const
+    {
+        const disable_fpu_denormals disable_denormals;
+
+        for (uint32 i = 0; i < size; ++i)
+        {
+          *dst_buffer = *src_buffer_a++ * *src_buffer_b++;
+          undenormalized(*dst_buffer);
+          ++dst_buffer;
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void divide_buffers_double(
+        double* src_buffer_a,
+        double* src_buffer_b,
+        double* dst_buffer,
+        uint32 size) const
+    {
+        const disable_fpu_denormals disable_denormals;
+
+        for (uint32 i = 0; i < size; ++i)
+        {
+          *dst_buffer = *src_buffer_a++ / *src_buffer_b++;
+          undenormalized(*dst_buffer);
+          ++dst_buffer;
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void abs_buffer_double(
+        double* src_buffer,
+        uint32 size) const
+    {
+        abs_buffer_generic(src_buffer, size);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void multiply_add_buffers_double(
+        double* src_buffer_a,
+        double* src_buffer_b,
+        double* src_buffer_c,
+        double* dst_buffer,
+        uint32 size) const
+    {
+        const disable_fpu_denormals disable_denormals;
+
+        for (uint32 i = 0; i < size; ++i)
+        {
+          *dst_buffer = *src_buffer_a++ * *src_buffer_b++ + *src_buffer_c++;
+          undenormalized(*dst_buffer);
+          ++dst_buffer;
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void scale_add_buffer_double(
+        double* src_buffer,
+        double* dst_buffer,
+        uint32 size,
+        double gain) const
+    {
+        const disable_fpu_denormals disable_denormals;
+
+        for (uint32 i = 0; i < size; ++i)
+        {
+          *dst_buffer = *dst_buffer + *src_buffer++ * gain;
+          undenormalized(*dst_buffer);
+          ++dst_buffer;
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void ramp_scale_buffer_double(
+        double* src_buffer,
+        uint32 size,
+        double start_gain,
+        double end_gain) const
+    {
+        if (size == 0)
+            return;
+
+        const disable_fpu_denormals disable_denormals;
+
+        ramp_scale_generic(src_buffer, size, start_gain,
+            ramp_increment(start_gain, end_gain, size), 0);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void exp_ramp_scale_buffer_double(
+        double* src_buffer,
+        uint32 size,
+        double start_gain,
+        double end_gain) const
+    {
+        if (! is_exp_ramp(start_gain, end_gain, size))
+        {
+            ramp_scale_buffer_double(src_buffer, size, start_gain, end_gain);
+            return;
+        }
+
+        const disable_fpu_denormals disable_denormals;
+
+        exp_ramp_scale_generic(src_buffer, size, start_gain,
+            exp_ramp_log_ratio(start_gain, end_gain, size), 0);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    double sum_buffer_double(
+        double* src_buffer,
+        uint32 size) const
+    {
+        double result = 0.0, compensation = 0.0;
+
+        for (uint32 i = 0; i < size; ++i)
+        {
+          kahan_add(result, compensation, *src_buffer++);
+        }
+
+        return result;
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    double dot_product_double(
+        double* src_buffer_a,
+        double* src_buffer_b,
+        uint32 size) const
+    {
+        double result = 0.0, compensation = 0.0;
+
+        for (uint32 i = 0; i < size; ++i)
+        {
+          kahan_add(result, compensation, *src_buffer_a++ * *src_buffer_b++);
+        }
+
+        return result;
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    double min_buffer_double(
+        double* src_buffer,
+        uint32 size,
+        uint32* index) const
+    {
+        return min_buffer_generic(src_buffer, size, index);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    double max_buffer_double(
+        double* src_buffer,
+        uint32 size,
+        uint32* index) const
+    {
+        return max_buffer_generic(src_buffer, size, index);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    double peak_abs_buffer_double(
+        double* src_buffer,
+        uint32 size) const
+    {
+        double result = 0;
+
+        for (uint32 i = 0; i < size; ++i)
+        {
+          const double value = std::fabs(*src_buffer++);
+          if (value > result)
+              result = value;
+        }
+
+        return result;
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    double rms_buffer_double(
+        double* src_buffer,
+        uint32 size) const
+    {
+        // goes through the dot product of the most derived backend
+        return rms_from_sum_of_squares(dot_product_double(src_buffer, src_buffer, size), size);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    math_fpu_mixing_functions_impl(float)
+    math_fpu_mixing_functions_impl(double)
+
+
+    //--------------------------------------------------------------------------
+
+    math_fpu_conversion_functions_impl(int16, float, 16)
+    math_fpu_conversion_functions_impl(int24, float, 24)
+    math_fpu_conversion_functions_impl(int32, float, 32)
+    math_fpu_conversion_functions_impl(int16, double, 16)
+    math_fpu_conversion_functions_impl(int24, double, 24)
+    math_fpu_conversion_functions_impl(int32, double, 32)
+
+
+    //--------------------------------------------------------------------------
+
+    math_fpu_filter_functions_impl(float)
+    math_fpu_filter_functions_impl(double)
+
+
+    //--------------------------------------------------------------------------
+
+    math_fpu_transform_functions_impl(float)
+    math_fpu_transform_functions_impl(double)
+
+
+    //--------------------------------------------------------------------------
+
+    math_fpu_dynamics_functions_impl(float)
+    math_fpu_dynamics_functions_impl(double)
+
+
+    //--------------------------------------------------------------------------
+
+    math_fpu_transcendental_functions_impl(float)
+    math_fpu_transcendental_functions_impl(double)
+
+
+    //--------------------------------------------------------------------------
+
+    math_fpu_pixel_functions_impl(uint8)
+    math_fpu_pixel_functions_impl(float)
+
+
+    //--------------------------------------------------------------------------
+
+    math_fpu_color_functions_impl(uint8)
+
+
+    //--------------------------------------------------------------------------
+
+    math_fpu_image_functions_impl(float)
+
+
+    //--------------------------------------------------------------------------
+
+    math_fpu_resize_functions_impl(uint8)
+    math_fpu_resize_functions_impl(float)
+
+
+protected:
+
+    //--------------------------------------------------------------------------
+
+    template<typename T> static forcedinline uint64 magnitude_value(T value)
+    {
+        return value < T(0) ? 0 - static_cast<uint64>(value) : static_cast<uint64>(value);
+    }
+
+    static forcedinline uint64 magnitude_value(uint8 value) { return value; }
+    static forcedinline uint64 magnitude_value(uint16 value) { return value; }
+    static forcedinline uint64 magnitude_value(uint32 value) { return value; }
+    static forcedinline uint64 magnitude_value(uint64 value) { return value; }
+
+
+    //--------------------------------------------------------------------------
+
+    // the 8 and 16 bit sums never overflow an int32, so they are clamped once
+
+    template<typename T> static forcedinline T saturate_value(int32 value)
+    {
+        return static_cast<T>(value < std::numeric_limits<T>::min() ? std::numeric_limits<T>::min() :
+            (value > std::numeric_limits<T>::max() ? std::numeric_limits<T>::max() : value));
+    }
+
+    template<typename T> static forcedinline T add_saturate_scalar(T a, T b)
+    {
+        return saturate_value<T>(int32(a) + int32(b));
+    }
+
+    template<typename T> static forcedinline T subtract_saturate_scalar(T a, T b)
+    {
+        return saturate_value<T>(int32(a) - int32(b));
+    }
+
+    template<typename T> static forcedinline T average_scalar(T a, T b)
+    {
+        return static_cast<T>((int32(a) + int32(b) + 1) >> 1);
+    }
+
+    template<typename T> static forcedinline T scale_saturate_scalar(T value, float gain)
+    {
+        const float lowest = (float)std::numeric_limits<T>::min();
+        const float highest = (float)std::numeric_limits<T>::max();
+        const float scaled = (float)value * gain;
+
+        return static_cast<T>(round::f2i(
+            scaled < lowest ? lowest : (scaled > highest ? highest : scaled)));
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    template<typename T> static forcedinline uint32 index_of_value(
+        T* src_buffer,
+        uint32 size,
+        T value)
+    {
+        // simd reductions only know the extreme value, not where it was
+        for (uint32 i = 0; i < size; ++i)
+        {
+          if (src_buffer[i] == value)
+              return i;
+        }
+
+        return 0;
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // exponential ramps get back on the exact curve every RAMP_BLOCK_SIZE
+    // samples, the gain recurrence in between can't drift noticeably
+
+    enum FPUMathDefines
+    {
+        RAMP_BLOCK_SIZE = 256
+    };
+
+    template<typename T> static forcedinline T ramp_increment(T start_gain, T end_gain, uint32 size)
+    {
+        return (end_gain - start_gain) / static_cast<T>(size);
+    }
+
+    template<typename T> static forcedinline bool is_exp_ramp(T start_gain, T end_gain, uint32 size)
+    {
+        return size > 0 &&
+            ((start_gain > T(0) && end_gain > T(0)) || (start_gain < T(0) && end_gain < T(0)));
+    }
+
+    template<typename T> static forcedinline double exp_ramp_log_ratio(T start_gain, T end_gain, uint32 size)
+    {
+        return std::log(static_cast<double>(end_gain) / static_cast<double>(start_gain)) / size;
+    }
+
+    static forcedinline double exp_ramp_gain(double start_gain, double log_ratio, uint32 index)
+    {
+        return start_gain * std::exp(log_ratio * index);
+    }
+
+    // lanes of the first ramp vector starting at sample index
+    template<typename T> static forcedinline void ramp_index_lanes(T* lanes, uint32 count, uint32 index)
+    {
+        for (uint32 i = 0; i < count; ++i)
+            lanes[i] = static_cast<T>(index + i);
+    }
+
+    template<typename T> static forcedinline void exp_ramp_lanes(
+        T* lanes, uint32 count, double start_gain, double log_ratio, uint32 index)
+    {
+        for (uint32 i = 0; i < count; ++i)
+            lanes[i] = static_cast<T>(exp_ramp_gain(start_gain, log_ratio, index + i));
+    }
+
+    // the scalar ramps take the index of their first sample, so the simd
+    // backends can run them on the heads and tails of their buffers
+    template<typename T> static void ramp_scale_generic(
+        T* src_buffer,
+        uint32 size,
+        T start_gain,
+        T increment,
+        uint32 index)
+    {
+        for (uint32 i = 0; i < size; ++i)
+        {
+            *src_buffer = *src_buffer * (start_gain + increment * static_cast<T>(index++));
+            undenormalize(*src_buffer);
+            ++src_buffer;
+        }
+    }
+
+    template<typename T> static void exp_ramp_scale_generic(
+        T* src_buffer,
+        uint32 size,
+        double start_gain,
+        double log_ratio,
+        uint32 index)
+    {
+        const double ratio = std::exp(log_ratio);
+        double gain = exp_ramp_gain(start_gain, log_ratio, index);
+
+        for (uint32 i = 0; i < size; ++i)
+        {
+            if (i > 0 && (index & (RAMP_BLOCK_SIZE - 1)) == 0)
+                gain = exp_ramp_gain(start_gain, log_ratio, index);
+
+            *src_buffer = *src_buffer * static_cast<T>(gain);
+            undenormalize(*src_buffer);
+            ++src_buffer;
+
+            gain *= ratio;
+            ++index;
+        }
+    }
+
+    static forcedinline void undenormalize(float& value) { undenormalizef(value); }
+    static forcedinline void undenormalize(double& value) { undenormalized(value); }
+
+
+    //--------------------------------------------------------------------------
+
+    // gain kernels of the mixing functions, the only part of them the simd
+    // backends need to vectorize
+
+    #define math_fpu_mixing_kernels_impl(datatype) \
+        virtual void stereo_gain_buffers_ ##datatype ( \
+            datatype* src_left_buffer, \
+            datatype* src_right_buffer, \
+            datatype* dst_left_buffer, \
+            datatype* dst_right_buffer, \
+            uint32 size, \
+            datatype left_gain, \
+            datatype right_gain) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            stereo_gain_generic(src_left_buffer, src_right_buffer, \
+                dst_left_buffer, dst_right_buffer, size, left_gain, right_gain); \
+        } \
+        \
+        virtual void ramp_stereo_gain_buffers_ ##datatype ( \
+            datatype* src_left_buffer, \
+            datatype* src_right_buffer, \
+            datatype* dst_left_buffer, \
+            datatype* dst_right_buffer, \
+            uint32 size, \
+            datatype left_gain, \
+            datatype left_increment, \
+            datatype right_gain, \
+            datatype right_increment) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            ramp_stereo_gain_generic(src_left_buffer, src_right_buffer, \
+                dst_left_buffer, dst_right_buffer, size, \
+                left_gain, left_increment, right_gain, right_increment, 0); \
+        } \
+        \
+        virtual void mix_gain_buffers_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype gain_a, \
+            datatype gain_b) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            mix_gain_generic(src_buffer_a, src_buffer_b, dst_buffer, size, \
+                gain_a, gain_b); \
+        } \
+        \
+        virtual void ramp_mix_gain_buffers_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype gain_a, \
+            datatype increment_a, \
+            datatype gain_b, \
+            datatype increment_b) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            ramp_mix_gain_generic(src_buffer_a, src_buffer_b, dst_buffer, size, \
+                gain_a, increment_a, gain_b, increment_b, 0); \
+        }
+
+    math_fpu_mixing_kernels_impl(float)
+    math_fpu_mixing_kernels_impl(double)
+
+
+    //--------------------------------------------------------------------------
+
+    // radix 4 pass of the transform functions
+
+    #define math_fpu_transform_kernels_impl(datatype) \
+        virtual void fft_radix4_pass_ ##datatype ( \
+            datatype* real_buffer, \
+            datatype* imag_buffer, \
+            uint32 size, \
+            uint32 span, \
+            const datatype* twiddles) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            fft_radix4_pass_generic(real_buffer, imag_buffer, size, span, twiddles); \
+        }
+
+    math_fpu_transform_kernels_impl(float)
+    math_fpu_transform_kernels_impl(double)
+
+
+    //--------------------------------------------------------------------------
+
+    template<typename T> static forcedinline T clamp_position(T value, T low, T high)
+    {
+        return value < low ? low : (value > high ? high : value);
+    }
+
+    template<typename T> static void pan_gains(T pan, PanLawTypes law, T& left_gain, T& right_gain)
+    {
+        const double position = (clamp_position(pan, T(-1), T(1)) + 1.0) * 0.5;
+
+        if (law == CONSTANT_POWER_PAN_LAW)
+        {
+            // sines of both quarter turns, so hard pans are exactly zero and one
+            const double half_pi = 1.57079632679489661923;
+
+            left_gain = static_cast<T>(std::sin((1.0 - position) * half_pi));
+            right_gain = static_cast<T>(std::sin(position * half_pi));
+        }
+        else
+        {
+            left_gain = static_cast<T>(1.0 - position);
+            right_gain = static_cast<T>(position);
+        }
+    }
+
+    template<typename T> static void balance_gains(T balance, T& left_gain, T& right_gain)
+    {
+        balance = clamp_position(balance, T(-1), T(1));
+
+        left_gain = balance > T(0) ? T(1) - balance : T(1);
+        right_gain = balance < T(0) ? T(1) + balance : T(1);
+    }
+
+    template<typename T> static void mix_gains(T mix, T& dry_gain, T& wet_gain)
+    {
+        mix = clamp_position(mix, T(0), T(1));
+
+        dry_gain = T(1) - mix;
+        wet_gain = mix;
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // both channels are read before writing, so the kernels work in place
+
+    template<typename T> static void stereo_gain_generic(
+        T* src_left_buffer,
+        T* src_right_buffer,
+        T* dst_left_buffer,
+        T* dst_right_buffer,
+        uint32 size,
+        T left_gain,
+        T right_gain)
+    {
+        for (uint32 i = 0; i < size; ++i)
+        {
+            const T left = *src_left_buffer++;
+            const T right = *src_right_buffer++;
+
+            *dst_left_buffer = left * left_gain;
+            *dst_right_buffer = right * right_gain;
+            undenormalize(*dst_left_buffer++);
+            undenormalize(*dst_right_buffer++);
+        }
+    }
+
+    template<typename T> static void ramp_stereo_gain_generic(
+        T* src_left_buffer,
+        T* src_right_buffer,
+        T* dst_left_buffer,
+        T* dst_right_buffer,
+        uint32 size,
+        T left_gain,
+        T left_increment,
+        T right_gain,
+        T right_increment,
+        uint32 index)
+    {
+        for (uint32 i = 0; i < size; ++i)
+        {
+            const T left = *src_left_buffer++;
+            const T right = *src_right_buffer++;
+            const T position = static_cast<T>(index++);
+
+            *dst_left_buffer = left * (left_gain + left_increment * position);
+            *dst_right_buffer = right * (right_gain + right_increment * position);
+            undenormalize(*dst_left_buffer++);
+            undenormalize(*dst_right_buffer++);
+        }
+    }
+
+    template<typename T> static void mix_gain_generic(
+        T* src_buffer_a,
+        T* src_buffer_b,
+        T* dst_buffer,
+        uint32 size,
+        T gain_a,
+        T gain_b)
+    {
+        for (uint32 i = 0; i < size; ++i)
+        {
+            *dst_buffer = *src_buffer_a++ * gain_a + *src_buffer_b++ * gain_b;
+            undenormalize(*dst_buffer++);
+        }
+    }
+
+    template<typename T> static void ramp_mix_gain_generic(
+        T* src_buffer_a,
+        T* src_buffer_b,
+        T* dst_buffer,
+        uint32 size,
+        T gain_a,
+        T increment_a,
+        T gain_b,
+        T increment_b,
+        uint32 index)
+    {
+        for (uint32 i = 0; i < size; ++i)
+        {
+            const T position = static_cast<T>(index++);
+
+            *dst_buffer = *src_buffer_a++ * (gain_a + increment_a * position)
+                + *src_buffer_b++ * (gain_b + increment_b * position);
+            undenormalize(*dst_buffer++);
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // the simd backends move groups of channels and frames at once, then
+    // leave the leftover channels and frames to these
+
+    template<typename T> static void interleave_generic(
+        T** src_buffers,
+        T* dst_buffer,
+        uint32 channels,
+        uint32 first_channel,
+        uint32 last_channel,
+        uint32 first_frame,
+        uint32 last_frame)
+    {
+        for (uint32 i = first_frame; i < last_frame; ++i)
+        {
+            T* frame = dst_buffer + i * channels;
+
+            for (uint32 c = first_channel; c < last_channel; ++c)
+                frame[c] = src_buffers[c][i];
+        }
+    }
+
+    template<typename T> static void deinterleave_generic(
+        T* src_buffer,
+        T** dst_buffers,
+        uint32 channels,
+        uint32 first_channel,
+        uint32 last_channel,
+        uint32 first_frame,
+        uint32 last_frame)
+    {
+        for (uint32 i = first_frame; i < last_frame; ++i)
+        {
+            const T* frame = src_buffer + i * channels;
+
+            for (uint32 c = first_channel; c < last_channel; ++c)
+                dst_buffers[c][i] = frame[c];
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // integer samples scale to [-1, 1) by 1 / 2^(bits - 1) and saturate at
+    // max_value, the largest value of the datatype not above max_sample, which
+    // all the backends compute exactly whatever the rounding mode is
+
+    template<typename T> struct integer_format
+    {
+        integer_format(uint32 bits)
+          : scale(T(1) / static_cast<T>(1u << (bits - 1))),
+            range(static_cast<T>(1u << (bits - 1))),
+            min_value(-range),
+            max_value(bits <= (uint32)std::numeric_limits<T>::digits
+                ? range - T(1)
+                : range - std::ldexp(range, -std::numeric_limits<T>::digits)),
+            min_sample(-static_cast<int32>((1u << (bits - 1)) - 1u) - 1),
+            max_sample(static_cast<int32>((1u << (bits - 1)) - 1u))
+        {
+        }
+
+        T scale;
+        T range;
+        T min_value;
+        T max_value;
+        int32 min_sample;
+        int32 max_sample;
+    };
+
+    static forcedinline int32 read_sample(const int16* buffer) { return *buffer; }
+    static forcedinline int32 read_sample(const int32* buffer) { return *buffer; }
+
+    static forcedinline int32 read_sample(const int24* buffer)
+    {
+        const uint8* bytes = (const uint8*)*buffer;
+
+        return static_cast<int32>(((uint32)bytes[0] << 8) |
+            ((uint32)bytes[1] << 16) | ((uint32)bytes[2] << 24)) >> 8;
+    }
+
+    static forcedinline void write_sample(int16* buffer, int32 value) { *buffer = static_cast<int16>(value); }
+    static forcedinline void write_sample(int32* buffer, int32 value) { *buffer = value; }
+
+    static forcedinline void write_sample(int24* buffer, int32 value)
+    {
+        uint8* bytes = (uint8*)*buffer;
+
+        bytes[0] = static_cast<uint8>(value);
+        bytes[1] = static_cast<uint8>(value >> 8);
+        bytes[2] = static_cast<uint8>(value >> 16);
+    }
+
+    // rounds with the mode set by float_rounding_mode
+    template<typename T> static forcedinline int32 round_sample(T value, const integer_format<T>& format)
+    {
+        if (value >= format.max_value)
+            return format.max_sample;
+        else if (value <= format.min_value)
+            return format.min_sample;
+        else
+            return static_cast<int32>(std::lrint(value));
+    }
+
+    // lowbias32 integer hash, so the noise of a sample only depends on seed + index
+    static forcedinline uint32 dither_hash(uint32 value)
+    {
+        value ^= value >> 16;
+        value *= 0x7feb352dU;
+        value ^= value >> 15;
+        value *= 0x846ca68bU;
+        value ^= value >> 16;
+        return value;
+    }
+
+    // triangular noise in 1/65536 LSB steps, summing the two 16 bit halves
+    static forcedinline int32 tpdf_dither(uint32 value)
+    {
+        const uint32 hash = dither_hash(value);
+
+        return static_cast<int32>(hash & 0xFFFF) + static_cast<int32>(hash >> 16) - 65535;
+    }
+
+    static forcedinline void advance_dither_seed(uint32* dither_seed, uint32 size)
+    {
+        if (dither_seed != nullptr)
+            *dither_seed += size;
+    }
+
+    template<typename I, typename T> static void convert_from_integer_generic(
+        const I* src_buffer,
+        T* dst_buffer,
+        uint32 size,
+        const integer_format<T>& format)
+    {
+        for (uint32 i = 0; i < size; ++i)
+            *dst_buffer++ = static_cast<T>(read_sample(src_buffer++)) * format.scale;
+    }
+
+    template<typename T, typename I> static void convert_to_integer_generic(
+        const T* src_buffer,
+        I* dst_buffer,
+        uint32 size,
+        const integer_format<T>& format,
+        const uint32* dither_seed,
+        uint32 index)
+    {
+        const T dither_scale = T(1.0 / 65536.0);
+
+        for (uint32 i = 0; i < size; ++i)
+        {
+            T value = *src_buffer++ * format.range;
+
+            if (dither_seed != nullptr)
+                value += static_cast<T>(tpdf_dither(*dither_seed + index++)) * dither_scale;
+
+            write_sample(dst_buffer++, round_sample(value, format));
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // runs the whole cascade of every channel from first_channel on, frame by
+    // frame, the simd backends leave the channels of a partial register to it
+
+    template<typename T> static void biquad_bank_generic(
+        const T* src_buffer,
+        T* dst_buffer,
+        uint32 channels,
+        uint32 frames,
+        const T* coefficients,
+        T* state,
+        uint32 sections,
+        uint32 first_channel)
+    {
+        for (uint32 frame = 0; frame < frames; ++frame)
+        {
+            for (uint32 channel = first_channel; channel < channels; ++channel)
+            {
+                const T* coefficient = coefficients + channel;
+                T* z = state + channel;
+                T value = src_buffer[frame * channels + channel];
+
+                for (uint32 section = 0; section < sections; ++section)
+                {
+                    const T output = coefficient[0] * value + z[0];
+
+                    z[0] = coefficient[channels] * value - coefficient[3 * channels] * output + z[channels];
+                    z[channels] = coefficient[2 * channels] * value - coefficient[4 * channels] * output;
+                    value = output;
+
+                    coefficient += 5 * channels;
+                    z += 2 * channels;
+                }
+
+                dst_buffer[frame * channels + channel] = value;
+            }
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // adds to sum the products of one polyphase row from the first tap on,
+    // the simd backends leave the taps of a partial register to it
+
+    template<typename T> static forcedinline T polyphase_row_generic(
+        const T* src_buffer,
+        const T* coefficients,
+        uint32 first_tap,
+        uint32 taps,
+        T sum)
+    {
+        for (uint32 k = first_tap; k < taps; ++k)
+        {
+            sum += coefficients[k] * src_buffer[k];
+        }
+
+        return sum;
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // follows the envelope of every channel from first_channel on, frame by
+    // frame, the simd backends leave the channels of a partial register to it
+
+    template<typename T> static void envelope_bank_generic(
+        const T* src_buffer,
+        T* dst_buffer,
+        uint32 channels,
+        uint32 frames,
+        const T* coefficients,
+        T* state,
+        EnvelopeModeTypes mode,
+        uint32 first_channel)
+    {
+        for (uint32 frame = 0; frame < frames; ++frame)
+        {
+            for (uint32 channel = first_channel; channel < channels; ++channel)
+            {
+                const T value = src_buffer[frame * channels + channel];
+                const T level = mode == RMS_ENVELOPE ? value * value : std::fabs(value);
+                const T coefficient = level > state[channel] ? coefficients[channel] : coefficients[channels + channel];
+
+                state[channel] += coefficient * (level - state[channel]);
+
+                dst_buffer[frame * channels + channel] = mode == RMS_ENVELOPE ? std::sqrt(state[channel]) : state[channel];
+            }
+        }
+    }
+
+    // the gain curves from the first sample on, the simd backends leave the
+    // samples of a partial register to them
+
+    template<typename T> static void compressor_gain_generic(
+        const T* src_buffer,
+        T* dst_buffer,
+        uint32 size,
+        T threshold,
+        T ratio,
+        T knee,
+        uint32 first)
+    {
+        assert(ratio > T(0));
+
+        // the knee is (over + knee / 2)^2 / (2 knee) while it lasts, the part
+        // clamped to it joins the straight line above
+        const T slope = T(1) / ratio - T(1);
+        const T width = knee > T(0) ? knee : T(0);
+        const T half_knee = width * T(0.5);
+        const T knee_scale = knee > T(0) ? T(1) / (T(2) * knee) : T(0);
+
+        for (uint32 i = first; i < size; ++i)
+        {
+            const T over = src_buffer[i] - threshold;
+            const T above = over > half_knee ? over - half_knee : T(0);
+
+            T bent = over + half_knee;
+            bent = bent > T(0) ? bent : T(0);
+            bent = bent < width ? bent : width;
+
+            dst_buffer[i] = slope * (bent * bent * knee_scale + above);
+        }
+    }
+
+    template<typename T> static void limiter_gain_generic(
+        const T* src_buffer,
+        T* dst_buffer,
+        uint32 size,
+        T threshold,
+        uint32 first)
+    {
+        assert(threshold > T(0));
+
+        for (uint32 i = first; i < size; ++i)
+        {
+            dst_buffer[i] = threshold / (src_buffer[i] > threshold ? src_buffer[i] : threshold);
+        }
+    }
+
+    template<typename T> static void soft_clip_generic(
+        const T* src_buffer,
+        T* dst_buffer,
+        uint32 size,
+        uint32 first)
+    {
+        for (uint32 i = first; i < size; ++i)
+        {
+            const T value = src_buffer[i] < T(-3) ? T(-3) : (src_buffer[i] > T(3) ? T(3) : src_buffer[i]);
+            const T square = value * value;
+
+            dst_buffer[i] = value * (T(27) + square) / (T(27) + T(9) * square);
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // the transcendental functions one sample at a time, with the reductions
+    // and polynomials of the simd backends so they can take the samples of a
+    // partial register as well
+
+    template<typename T, uint32 count> static forcedinline T polynomial_scalar(
+        T x,
+        const T (&coefficients)[count])
+    {
+        T result = coefficients[0];
+        for (uint32 i = 1; i < count; ++i)
+        {
+            result = result * x + coefficients[i];
+        }
+
+        return result;
+    }
+
+    // e^r - 1 for |r| <= log(2) / 2, shared by exp and tanh
+    static forcedinline float expm1_scalar(float r, bool accurate)
+    {
+        return r + r * r * (accurate
+            ? polynomial_scalar(r, accurate_exp_coefficients_float)
+            : polynomial_scalar(r, fast_exp_coefficients_float));
+    }
+
+    static forcedinline double expm1_scalar(double r, bool accurate)
+    {
+        return r + r * r * (accurate
+            ? polynomial_scalar(r, accurate_exp_coefficients_double)
+            : polynomial_scalar(r, fast_exp_coefficients_double));
+    }
+
+    // exp reduces x to r = x - n log(2) and scales e^r by 2^n, with log(2)
+    // in a part exact in the products by n and the rest
+    static forcedinline float exp_scalar(float x, bool accurate)
+    {
+        if (x != x)
+            return x;
+        else if (x > 88.72283172607421875f)
+            return std::numeric_limits<float>::infinity();
+        else if (x < -87.33654022216796875f)
+            return 0.0f;
+
+        const float n = std::floor(x * 1.44269504088896341f + 0.5f);
+        const float r = (x - n * 0.693359375f) - n * -2.12194440e-4f;
+
+        return std::ldexp(expm1_scalar(r, accurate) + 1.0f, (int)n);
+    }
+
+    static forcedinline double exp_scalar(double x, bool accurate)
+    {
+        if (x != x)
+            return x;
+        else if (x > 709.782712893383)
+            return std::numeric_limits<double>::infinity();
+        else if (x < -708.396418532264)
+            return 0.0;
+
+        const double n = std::floor(x * 1.4426950408889634074 + 0.5);
+        const double r = (x - n * 6.93147180369123816490e-1) - n * 1.90821492927058770002e-10;
+
+        return std::ldexp(expm1_scalar(r, accurate) + 1.0, (int)n);
+    }
+
+    // log splits x in m 2^e with m in [sqrt(1/2), sqrt(2)), then adds e log(2)
+    // to 2 s + s^3 Q(s^2) for s = (m - 1) / (m + 1)
+    static forcedinline float log_scalar(float x, bool accurate)
+    {
+        if (!(x > 0.0f))
+            return x == 0.0f ? -std::numeric_limits<float>::infinity() : std::numeric_limits<float>::quiet_NaN();
+        else if (x == std::numeric_limits<float>::infinity())
+            return x;
+
+        int exponent;
+        float m = std::frexp(x, &exponent);
+        if (m < 0.707106781186547524f)
+        {
+            m += m;
+            --exponent;
+        }
+
+        const float e = (float)exponent;
+        const float s = (m - 1.0f) / (m + 1.0f);
+        const float w = s * s;
+        const float q = accurate
+            ? polynomial_scalar(w, accurate_log_coefficients_float)
+            : polynomial_scalar(w, fast_log_coefficients_float);
+
+        return e * 0.693359375f + ((s + s + s * w * q) + e * -2.12194440e-4f);
+    }
+
+    static forcedinline double log_scalar(double x, bool accurate)
+    {
+        if (!(x > 0.0))
+            return x == 0.0 ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::quiet_NaN();
+        else if (x == std::numeric_limits<double>::infinity())
+            return x;
+
+        int exponent;
+        double m = std::frexp(x, &exponent);
+        if (m < 0.70710678118654752440)
+        {
+            m += m;
+            --exponent;
+        }
+
+        const double e = (double)exponent;
+        const double s = (m - 1.0) / (m + 1.0);
+        const double w = s * s;
+        const double q = accurate
+            ? polynomial_scalar(w, accurate_log_coefficients_double)
+            : polynomial_scalar(w, fast_log_coefficients_double);
+
+        return e * 6.93147180369123816490e-1 + ((s + s + s * w * q) + e * 1.90821492927058770002e-10);
+    }
+
+    // sin and cos reduce x to r = x - j pi / 2, with pi / 2 in parts of 33
+    // bits whose products by j are exact, then the quadrant j picks the
+    // polynomial and the sign. Floats are reduced in double with three parts,
+    // close to the zeros a float pi / 2 loses r, doubles need a fourth. From
+    // 2^30 on r has lost most of its bits and would grow past the polynomials,
+    // so those arguments reduce as zeros
+    static forcedinline void sincos_scalar(float x, float& sin_value, float& cos_value, bool accurate)
+    {
+        if (!(std::fabs(x) < std::numeric_limits<float>::infinity()))
+        {
+            sin_value = cos_value = std::numeric_limits<float>::quiet_NaN();
+            return;
+        }
+
+        if (std::fabs(x) >= 1073741824.0f)
+            x = 0.0f;
+
+        const double j = std::floor(x * 6.36619772367581382433e-1 + 0.5);
+        const float r = (float)(((x - j * 1.57079632673412561417) - j * 6.07710050630396597660e-11) - j * 2.02226624871116645580e-21);
+        const float z = r * r;
+
+        const float sine = r + r * z * (accurate
+            ? polynomial_scalar(z, accurate_sin_coefficients_float)
+            : polynomial_scalar(z, fast_sin_coefficients_float));
+        const float cosine = 1.0f - 0.5f * z + z * z * (accurate
+            ? polynomial_scalar(z, accurate_cos_coefficients_float)
+            : polynomial_scalar(z, fast_cos_coefficients_float));
+
+        const int quadrant = (int)(j - 4.0 * std::floor(j * 0.25));
+
+        sin_value = (quadrant & 1) ? cosine : sine;
+        cos_value = (quadrant & 1) ? sine : cosine;
+
+        if (quadrant & 2)
+            sin_value = -sin_value;
+        if ((quadrant + 1) & 2)
+            cos_value = -cos_value;
+    }
+
+    static forcedinline void sincos_scalar(double x, double& sin_value, double& cos_value, bool accurate)
+    {
+        if (!(std::fabs(x) < std::numeric_limits<double>::infinity()))
+        {
+            sin_value = cos_value = std::numeric_limits<double>::quiet_NaN();
+            return;
+        }
+
+        if (std::fabs(x) >= 1073741824.0)
+            x = 0.0;
+
+        const double j = std::floor(x * 6.36619772367581382433e-1 + 0.5);
+        const double r = (((x - j * 1.57079632673412561417) - j * 6.07710050630396597660e-11)
+            - j * 2.02226624871116645580e-21) - j * 8.47842766036889956997e-32;
+        const double z = r * r;
+
+        const double sine = r + r * z * (accurate
+            ? polynomial_scalar(z, accurate_sin_coefficients_double)
+            : polynomial_scalar(z, fast_sin_coefficients_double));
+        const double cosine = 1.0 - 0.5 * z + z * z * (accurate
+            ? polynomial_scalar(z, accurate_cos_coefficients_double)
+            : polynomial_scalar(z, fast_cos_coefficients_double));
+
+        const int quadrant = (int)(j - 4.0 * std::floor(j * 0.25));
+
+        sin_value = (quadrant & 1) ? cosine : sine;
+        cos_value = (quadrant & 1) ? sine : cosine;
+
+        if (quadrant & 2)
+            sin_value = -sin_value;
+        if ((quadrant + 1) & 2)
+            cos_value = -cos_value;
+    }
+
+    // tanh |x| is -u / (2 + u) for u = e^(-2 |x|) - 1, which stays accurate
+    // close to zero, and the values it rounds to 1 from on are clamped
+    static forcedinline float tanh_scalar(float x, bool accurate)
+    {
+        if (x != x)
+            return x;
+
+        const float a = std::fabs(x) < 9.0f ? std::fabs(x) : 9.0f;
+        const float n = std::floor(-2.0f * a * 1.44269504088896341f + 0.5f);
+        const float r = (-2.0f * a - n * 0.693359375f) - n * -2.12194440e-4f;
+        const float scale = std::ldexp(1.0f, (int)n);
+        const float u = scale * expm1_scalar(r, accurate) + (scale - 1.0f);
+
+        return std::copysign(-u / (2.0f + u), x);
+    }
+
+    static forcedinline double tanh_scalar(double x, bool accurate)
+    {
+        if (x != x)
+            return x;
+
+        const double a = std::fabs(x) < 20.0 ? std::fabs(x) : 20.0;
+        const double n = std::floor(-2.0 * a * 1.4426950408889634074 + 0.5);
+        const double r = (-2.0 * a - n * 6.93147180369123816490e-1) - n * 1.90821492927058770002e-10;
+        const double scale = std::ldexp(1.0, (int)n);
+        const double u = scale * expm1_scalar(r, accurate) + (scale - 1.0);
+
+        return std::copysign(-u / (2.0 + u), x);
+    }
+
+    // pow is e^(y log x), so the error of log is scaled by |y log x|: the
+    // accurate powers of floats go through the fast double functions, which
+    // keeps it well below a float ulp
+    static forcedinline float pow_scalar(float x, float y, bool accurate)
+    {
+        if (accurate)
+            return (float)exp_scalar((double)y * log_scalar((double)x, false), false);
+
+        return exp_scalar(y * log_scalar(x, false), false);
+    }
+
+    static forcedinline double pow_scalar(double x, double y, bool accurate)
+    {
+        return exp_scalar(y * log_scalar(x, accurate), accurate);
+    }
+
+    // denormals are read as signed zeros, as the simd backends do with the
+    // denormals are zero mode on
+    template<typename T> static forcedinline T flush_denormal(T x)
+    {
+        return std::fabs(x) < std::numeric_limits<T>::min() ? x * (T)0 : x;
+    }
+
+    // the buffer loops from the first sample on, the simd backends leave the
+    // samples of a partial register to them
+
+    template<typename T> static void exp_generic(
+        const T* src_buffer,
+        T* dst_buffer,
+        uint32 size,
+        MathAccuracyTypes accuracy,
+        uint32 first)
+    {
+        const bool accurate = accuracy == ACCURATE_MATH_ACCURACY;
+
+        for (uint32 i = first; i < size; ++i)
+        {
+            dst_buffer[i] = exp_scalar(flush_denormal(src_buffer[i]), accurate);
+        }
+    }
+
+    template<typename T> static void log_generic(
+        const T* src_buffer,
+        T* dst_buffer,
+        uint32 size,
+        MathAccuracyTypes accuracy,
+        uint32 first)
+    {
+        const bool accurate = accuracy == ACCURATE_MATH_ACCURACY;
+
+        for (uint32 i = first; i < size; ++i)
+        {
+            dst_buffer[i] = log_scalar(flush_denormal(src_buffer[i]), accurate);
+        }
+    }
+
+    // either output can be null when only the other one is wanted
+    template<typename T> static void sincos_generic(
+        const T* src_buffer,
+        T* sin_buffer,
+        T* cos_buffer,
+        uint32 size,
+        MathAccuracyTypes accuracy,
+        uint32 first)
+    {
+        const bool accurate = accuracy == ACCURATE_MATH_ACCURACY;
+
+        for (uint32 i = first; i < size; ++i)
+        {
+            T sin_value, cos_value;
+            sincos_scalar(flush_denormal(src_buffer[i]), sin_value, cos_value, accurate);
+
+            if (sin_buffer)
+                sin_buffer[i] = sin_value;
+            if (cos_buffer)
+                cos_buffer[i] = cos_value;
+        }
+    }
+
+    template<typename T> static void tanh_generic(
+        const T* src_buffer,
+        T* dst_buffer,
+        uint32 size,
+        MathAccuracyTypes accuracy,
+        uint32 first)
+    {
+        const bool accurate = accuracy == ACCURATE_MATH_ACCURACY;
+
+        for (uint32 i = first; i < size; ++i)
+        {
+            dst_buffer[i] = tanh_scalar(flush_denormal(src_buffer[i]), accurate);
+        }
+    }
+
+    template<typename T> static void pow_generic(
+        const T* src_buffer,
+        const T* exponent_buffer,
+        T* dst_buffer,
+        uint32 size,
+        MathAccuracyTypes accuracy,
+        uint32 first)
+    {
+        const bool accurate = accuracy == ACCURATE_MATH_ACCURACY;
+
+        for (uint32 i = first; i < size; ++i)
+        {
+            dst_buffer[i] = pow_scalar(flush_denormal(src_buffer[i]), flush_denormal(exponent_buffer[i]), accurate);
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // the Porter-Duff factors of the source and of the backdrop, as the bits
+    // PIXEL_FACTOR_ALPHA to take the alpha of the other pixel and
+    // PIXEL_FACTOR_INVERT to take one minus it: 0 is zero, 1 the alpha, 2 one
+    // and 3 one minus the alpha
+
+    enum PixelFactorBits
+    {
+        PIXEL_FACTOR_ALPHA  = 1,
+        PIXEL_FACTOR_INVERT = 2
+    };
+
+    static forcedinline uint32 porter_duff_factor(CompositeModeTypes mode, bool source)
+    {
+        static const uint8 factors[12][2] =
+        {
+            { 0, 0 }, // CLEAR_COMPOSITE
+            { 2, 0 }, // SOURCE_COMPOSITE
+            { 0, 2 }, // DESTINATION_COMPOSITE
+            { 2, 3 }, // SOURCE_OVER_COMPOSITE
+            { 3, 2 }, // DESTINATION_OVER_COMPOSITE
+            { 1, 0 }, // SOURCE_IN_COMPOSITE
+            { 0, 1 }, // DESTINATION_IN_COMPOSITE
+            { 3, 0 }, // SOURCE_OUT_COMPOSITE
+            { 0, 3 }, // DESTINATION_OUT_COMPOSITE
+            { 1, 3 }, // SOURCE_ATOP_COMPOSITE
+            { 3, 1 }, // DESTINATION_ATOP_COMPOSITE
+            { 3, 3 }  // XOR_COMPOSITE
+        };
+
+        assert(mode <= XOR_COMPOSITE);
+
+        return factors[mode][source ? 0 : 1];
+    }
+
+    // the factor as (alpha & mask) ^ invert on 8 bit channels, where one
+    // minus alpha is 255 ^ alpha
+    static forcedinline uint8 pixel_factor_mask(uint32 factor)
+    {
+        return (factor & PIXEL_FACTOR_ALPHA) ? 255 : 0;
+    }
+
+    static forcedinline uint8 pixel_factor_invert(uint32 factor)
+    {
+        return (factor & PIXEL_FACTOR_INVERT) ? 255 : 0;
+    }
+
+    // the factor as offset + scale * alpha on float channels
+    static forcedinline float pixel_factor_offset(uint32 factor)
+    {
+        return (factor & PIXEL_FACTOR_INVERT) ? 1.0f : 0.0f;
+    }
+
+    static forcedinline float pixel_factor_scale(uint32 factor)
+    {
+        return (factor & PIXEL_FACTOR_ALPHA) ? ((factor & PIXEL_FACTOR_INVERT) ? -1.0f : 1.0f) : 0.0f;
+    }
+
+    // x * y / 255 rounded to nearest without dividing, exact for all the
+    // products of two 8 bit channels: the simd backends compute the same
+    static forcedinline int32 multiply_255(int32 x, int32 y)
+    {
+        const int32 t = x * y + 128;
+
+        return (t + (t >> 8)) >> 8;
+    }
+
+    static forcedinline uint8 clamp_channel(int32 value)
+    {
+        return static_cast<uint8>(value < 0 ? 0 : (value > 255 ? 255 : value));
+    }
+
+    static forcedinline uint8 premultiply_channel(uint8 c, uint8 a)
+    {
+        return static_cast<uint8>(multiply_255(c, a));
+    }
+
+    static forcedinline float premultiply_channel(float c, float a)
+    {
+        return c * a;
+    }
+
+    static forcedinline uint8 unpremultiply_channel(uint8 c, uint8 a)
+    {
+        if (a == 0)
+            return 0;
+
+        const int32 value = (c * 255 + (a >> 1)) / a;
+
+        return static_cast<uint8>(value < 255 ? value : 255);
+    }
+
+    static forcedinline float unpremultiply_channel(float c, float a)
+    {
+        return a != 0.0f ? c / a : 0.0f;
+    }
+
+    // one premultiplied channel composited, alpha goes through the same
+    // formulas as the colours with s = sa and d = da
+    static forcedinline uint8 composite_channel(
+        uint8 s,
+        uint8 d,
+        uint8 sa,
+        uint8 da,
+        CompositeModeTypes mode)
+    {
+        switch (mode)
+        {
+        case MULTIPLY_COMPOSITE:
+            return clamp_channel(multiply_255(s, 255 - da) + multiply_255(d, 255 - sa) + multiply_255(s, d));
+
+        case SCREEN_COMPOSITE:
+            return clamp_channel(s + d - multiply_255(s, d));
+
+        case OVERLAY_COMPOSITE:
+        {
+            const int32 blend = 2 * d > da
+                ? multiply_255(sa, da) - 2 * multiply_255(d < da ? da - d : 0, s < sa ? sa - s : 0)
+                : 2 * multiply_255(s, d);
+
+            return clamp_channel(multiply_255(s, 255 - da) + multiply_255(d, 255 - sa) + blend);
+        }
+
+        case ADD_COMPOSITE:
+            return clamp_channel(s + d);
+
+        default:
+        {
+            const uint32 source = porter_duff_factor(mode, true);
+            const uint32 backdrop = porter_duff_factor(mode, false);
+            const uint8 fa = (da & pixel_factor_mask(source)) ^ pixel_factor_invert(source);
+            const uint8 fb = (sa & pixel_factor_mask(backdrop)) ^ pixel_factor_invert(backdrop);
+
+            return clamp_channel(multiply_255(s, fa) + multiply_255(d, fb));
+        }
+        }
+    }
+
+    static forcedinline float composite_channel(
+        float s,
+        float d,
+        float sa,
+        float da,
+        CompositeModeTypes mode)
+    {
+        switch (mode)
+        {
+        case MULTIPLY_COMPOSITE:
+            return s * (1.0f - da) + d * (1.0f - sa) + s * d;
+
+        case SCREEN_COMPOSITE:
+            return s + d - s * d;
+
+        case OVERLAY_COMPOSITE:
+        {
+            const float blend = 2.0f * d > da
+                ? sa * da - 2.0f * (da - d) * (sa - s)
+                : 2.0f * s * d;
+
+            return s * (1.0f - da) + d * (1.0f - sa) + blend;
+        }
+
+        case ADD_COMPOSITE:
+            return s + d < 1.0f ? s + d : 1.0f;
+
+        default:
+        {
+            const uint32 source = porter_duff_factor(mode, true);
+            const uint32 backdrop = porter_duff_factor(mode, false);
+            const float fa = pixel_factor_offset(source) + pixel_factor_scale(source) * da;
+            const float fb = pixel_factor_offset(backdrop) + pixel_factor_scale(backdrop) * sa;
+
+            return s * fa + d * fb;
+        }
+        }
+    }
+
+    // the pixel loops from the first pixel on, the simd backends leave the
+    // pixels of a partial register to them
+
+    template<typename T> static void premultiply_rgba_generic(
+        const T* src_buffer,
+        T* dst_buffer,
+        uint32 pixels,
+        uint32 first)
+    {
+        for (uint32 i = first * 4; i < pixels * 4; i += 4)
+        {
+            const T alpha = src_buffer[i + 3];
+
+            dst_buffer[i + 0] = premultiply_channel(src_buffer[i + 0], alpha);
+            dst_buffer[i + 1] = premultiply_channel(src_buffer[i + 1], alpha);
+            dst_buffer[i + 2] = premultiply_channel(src_buffer[i + 2], alpha);
+            dst_buffer[i + 3] = alpha;
+        }
+    }
+
+    template<typename T> static void unpremultiply_rgba_generic(
+        const T* src_buffer,
+        T* dst_buffer,
+        uint32 pixels,
+        uint32 first)
+    {
+        for (uint32 i = first * 4; i < pixels * 4; i += 4)
+        {
+            const T alpha = src_buffer[i + 3];
+
+            dst_buffer[i + 0] = unpremultiply_channel(src_buffer[i + 0], alpha);
+            dst_buffer[i + 1] = unpremultiply_channel(src_buffer[i + 1], alpha);
+            dst_buffer[i + 2] = unpremultiply_channel(src_buffer[i + 2], alpha);
+            dst_buffer[i + 3] = alpha;
+        }
+    }
+
+    template<typename T> static void composite_rgba_generic(
+        const T* src_buffer,
+        const T* backdrop_buffer,
+        T* dst_buffer,
+        uint32 pixels,
+        CompositeModeTypes mode,
+        uint32 first)
+    {
+        for (uint32 i = first * 4; i < pixels * 4; i += 4)
+        {
+            const T sa = src_buffer[i + 3];
+            const T da = backdrop_buffer[i + 3];
+
+            for (uint32 c = 0; c < 4; ++c)
+                dst_buffer[i + c] = composite_channel(src_buffer[i + c], backdrop_buffer[i + c], sa, da, mode);
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // fixed point coefficients of a colour space: 15 bit weights from RGB to
+    // YUV, the chroma ones applied to the sums of 2x2 blocks, and 13 bit ones
+    // back to RGB. The weights of a row add up exactly to the scale of the
+    // range, so grays have neutral chroma and come back as the same grays
+
+    struct color_matrix
+    {
+        explicit color_matrix(ColorSpaceTypes space)
+        {
+            const bool bt709 = space == BT709_LIMITED_COLOR_SPACE || space == BT709_FULL_COLOR_SPACE;
+            const bool full = space == BT601_FULL_COLOR_SPACE || space == BT709_FULL_COLOR_SPACE;
+
+            const double kr = bt709 ? 0.2126 : 0.299;
+            const double kb = bt709 ? 0.0722 : 0.114;
+            const double kg = 1.0 - kr - kb;
+            const double luma_range = full ? 1.0 : 219.0 / 255.0;
+            const double chroma_range = full ? 1.0 : 224.0 / 255.0;
+
+            y_red = fixed(kr * luma_range, 15);
+            y_blue = fixed(kb * luma_range, 15);
+            y_green = static_cast<int16>(fixed(luma_range, 15) - y_red - y_blue);
+
+            u_red = fixed(-0.5 * kr / (1.0 - kb) * chroma_range, 15);
+            u_blue = fixed(0.5 * chroma_range, 15);
+            u_green = static_cast<int16>(-u_red - u_blue);
+
+            v_red = fixed(0.5 * chroma_range, 15);
+            v_blue = fixed(-0.5 * kb / (1.0 - kr) * chroma_range, 15);
+            v_green = static_cast<int16>(-v_red - v_blue);
+
+            luma = fixed(1.0 / luma_range, 13);
+            red_v = fixed(2.0 * (1.0 - kr) / chroma_range, 13);
+            green_u = fixed(-2.0 * kb * (1.0 - kb) / kg / chroma_range, 13);
+            green_v = fixed(-2.0 * kr * (1.0 - kr) / kg / chroma_range, 13);
+            blue_u = fixed(2.0 * (1.0 - kb) / chroma_range, 13);
+
+            luma_offset = full ? 0 : 16;
+            luma_rounding = (luma_offset << 15) + (1 << 14);
+            chroma_rounding = (128 << 17) + (1 << 16);
+        }
+
+        static int16 fixed(double value, int32 bits)
+        {
+            return static_cast<int16>(std::floor(value * (1 << bits) + 0.5));
+        }
+
+        int16 y_red, y_green, y_blue;
+        int16 u_red, u_green, u_blue;
+        int16 v_red, v_green, v_blue;
+        int16 luma, red_v, green_u, green_v, blue_u;
+        int32 luma_offset;
+        int32 luma_rounding;
+        int32 chroma_rounding;
+    };
+
+    // row kernels of the colour functions, a chroma row is computed from two
+    // rows of pixels and written every step bytes, 1 for I420 and 2 for NV12
+
+    #define math_fpu_color_kernels_impl(datatype) \
+        virtual void rgba_to_luma_row_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 pixels, \
+            const color_matrix& matrix) const \
+        { \
+            rgba_to_luma_generic(src_buffer, dst_buffer, pixels, matrix, 0); \
+        } \
+        \
+        virtual void rgba_to_chroma_row_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* next_buffer, \
+            datatype* u_buffer, \
+            datatype* v_buffer, \
+            uint32 step, \
+            uint32 pixels, \
+            const color_matrix& matrix) const \
+        { \
+            rgba_to_chroma_generic(src_buffer, next_buffer, u_buffer, v_buffer, step, pixels, matrix, 0); \
+        } \
+        \
+        virtual void yuv_to_rgba_row_ ##datatype ( \
+            datatype* y_buffer, \
+            datatype* u_buffer, \
+            datatype* v_buffer, \
+            uint32 step, \
+            datatype* dst_buffer, \
+            uint32 pixels, \
+            const color_matrix& matrix) const \
+        { \
+            yuv_to_rgba_generic(y_buffer, u_buffer, v_buffer, step, dst_buffer, pixels, matrix, 0); \
+        } \
+        \
+        virtual void luma_to_rgba_row_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 pixels, \
+            const color_matrix& matrix) const \
+        { \
+            luma_to_rgba_generic(src_buffer, dst_buffer, pixels, matrix, 0); \
+        }
+
+    math_fpu_color_kernels_impl(uint8)
+
+    static forcedinline uint8 luma_value(int32 r, int32 g, int32 b, const color_matrix& matrix)
+    {
+        return clamp_channel((matrix.y_red * r + matrix.y_green * g + matrix.y_blue * b + matrix.luma_rounding) >> 15);
+    }
+
+    static forcedinline int32 luma_term(int32 y, const color_matrix& matrix)
+    {
+        return matrix.luma * (y - matrix.luma_offset) + (1 << 12);
+    }
+
+    // the colour loops, from the first pixel or chroma sample on
+
+    static void rgba_to_luma_generic(
+        const uint8* src_buffer,
+        uint8* dst_buffer,
+        uint32 pixels,
+        const color_matrix& matrix,
+        uint32 first)
+    {
+        for (uint32 i = first; i < pixels; ++i)
+        {
+            const uint8* pixel = src_buffer + i * 4;
+
+            dst_buffer[i] = luma_value(pixel[0], pixel[1], pixel[2], matrix);
+        }
+    }
+
+    static void rgba_to_chroma_generic(
+        const uint8* src_buffer,
+        const uint8* next_buffer,
+        uint8* u_buffer,
+        uint8* v_buffer,
+        uint32 step,
+        uint32 pixels,
+        const color_matrix& matrix,
+        uint32 first)
+    {
+        for (uint32 i = first; i < (pixels + 1) / 2; ++i)
+        {
+            const uint32 left = i * 8;
+            const uint32 right = i * 2 + 1 < pixels ? left + 4 : left;
+
+            const int32 r = src_buffer[left + 0] + src_buffer[right + 0] + next_buffer[left + 0] + next_buffer[right + 0];
+            const int32 g = src_buffer[left + 1] + src_buffer[right + 1] + next_buffer[left + 1] + next_buffer[right + 1];
+            const int32 b = src_buffer[left + 2] + src_buffer[right + 2] + next_buffer[left + 2] + next_buffer[right + 2];
+
+            u_buffer[i * step] = clamp_channel((matrix.u_red * r + matrix.u_green * g + matrix.u_blue * b + matrix.chroma_rounding) >> 17);
+            v_buffer[i * step] = clamp_channel((matrix.v_red * r + matrix.v_green * g + matrix.v_blue * b + matrix.chroma_rounding) >> 17);
+        }
+    }
+
+    static void yuv_to_rgba_generic(
+        const uint8* y_buffer,
+        const uint8* u_buffer,
+        const uint8* v_buffer,
+        uint32 step,
+        uint8* dst_buffer,
+        uint32 pixels,
+        const color_matrix& matrix,
+        uint32 first)
+    {
+        for (uint32 i = first; i < pixels; ++i)
+        {
+            const int32 y = luma_term(y_buffer[i], matrix);
+            const int32 u = u_buffer[(i / 2) * step] - 128;
+            const int32 v = v_buffer[(i / 2) * step] - 128;
+
+            dst_buffer[i * 4 + 0] = clamp_channel((y + matrix.red_v * v) >> 13);
+            dst_buffer[i * 4 + 1] = clamp_channel((y + matrix.green_u * u + matrix.green_v * v) >> 13);
+            dst_buffer[i * 4 + 2] = clamp_channel((y + matrix.blue_u * u) >> 13);
+            dst_buffer[i * 4 + 3] = 255;
+        }
+    }
+
+    static void luma_to_rgba_generic(
+        const uint8* src_buffer,
+        uint8* dst_buffer,
+        uint32 pixels,
+        const color_matrix& matrix,
+        uint32 first)
+    {
+        for (uint32 i = first; i < pixels; ++i)
+        {
+            const uint8 gray = clamp_channel(luma_term(src_buffer[i], matrix) >> 13);
+
+            dst_buffer[i * 4 + 0] = gray;
+            dst_buffer[i * 4 + 1] = gray;
+            dst_buffer[i * 4 + 2] = gray;
+            dst_buffer[i * 4 + 3] = 255;
+        }
+    }
+
+    static void pack_rgba_planes_generic(
+        const uint8* red_buffer,
+        const uint8* green_buffer,
+        const uint8* blue_buffer,
+        const uint8* alpha_buffer,
+        uint8* dst_buffer,
+        uint32 pixels,
+        uint32 first)
+    {
+        for (uint32 i = first; i < pixels; ++i)
+        {
+            dst_buffer[i * 4 + 0] = red_buffer[i];
+            dst_buffer[i * 4 + 1] = green_buffer[i];
+            dst_buffer[i * 4 + 2] = blue_buffer[i];
+            dst_buffer[i * 4 + 3] = alpha_buffer ? alpha_buffer[i] : 255;
+        }
+    }
+
+    static void unpack_rgba_planes_generic(
+        const uint8* src_buffer,
+        uint8* red_buffer,
+        uint8* green_buffer,
+        uint8* blue_buffer,
+        uint8* alpha_buffer,
+        uint32 pixels,
+        uint32 first)
+    {
+        for (uint32 i = first; i < pixels; ++i)
+        {
+            red_buffer[i] = src_buffer[i * 4 + 0];
+            green_buffer[i] = src_buffer[i * 4 + 1];
+            blue_buffer[i] = src_buffer[i * 4 + 2];
+            if (alpha_buffer)
+                alpha_buffer[i] = src_buffer[i * 4 + 3];
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // the column passes go through tiles of 1 KB wide rows: the rows of a long
+    // kernel fit the L2 cache, the ones of a short kernel even the L1 one
+
+    enum { image_tile_columns = 256 };
+
+    // row and tile kernels of the image functions, a tile is at most
+    // image_tile_columns wide
+
+    #define math_fpu_image_kernels_impl(datatype) \
+        virtual void convolve_row_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 width, \
+            datatype* kernel, \
+            uint32 kernel_size) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            convolve_row_generic(src_buffer, dst_buffer, width, kernel, kernel_size, 0, width); \
+        } \
+        \
+        virtual void convolve_column_tile_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 src_stride, \
+            datatype* dst_buffer, \
+            uint32 dst_stride, \
+            uint32 columns, \
+            uint32 height, \
+            datatype* kernel, \
+            uint32 kernel_size) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            convolve_column_tile_generic(src_buffer, src_stride, dst_buffer, dst_stride, \
+                columns, height, kernel, kernel_size, 0); \
+        } \
+        \
+        virtual void box_blur_row_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 width, \
+            uint32 radius) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            box_blur_row_generic(src_buffer, dst_buffer, width, radius, 0, width); \
+        } \
+        \
+        virtual void box_blur_column_tile_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 src_stride, \
+            datatype* dst_buffer, \
+            uint32 dst_stride, \
+            uint32 columns, \
+            uint32 height, \
+            uint32 radius) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            box_blur_column_tile_generic(src_buffer, src_stride, dst_buffer, dst_stride, \
+                columns, height, radius, 0); \
+        }
+
+    math_fpu_image_kernels_impl(float)
+
+    // the row of a plane at a position that can be past its edges
+
+    template<typename T> static forcedinline const T* image_row(const T* buffer, uint32 stride, int32 row, uint32 height)
+    {
+        return buffer + clamp_position<int32>(row, 0, int32(height) - 1) * stride;
+    }
+
+    // sum of the box of 2 * radius + 1 samples centered on a position
+
+    template<typename T> static forcedinline T box_window_sum(const T* src_buffer, uint32 width, uint32 radius, uint32 position)
+    {
+        T sum = T(0);
+
+        for (int32 k = -int32(radius); k <= int32(radius); ++k)
+            sum += src_buffer[clamp_position<int32>(int32(position) + k, 0, int32(width) - 1)];
+
+        return sum;
+    }
+
+    // the image loops, over the pixels from first to last of a row or over the
+    // columns of a tile from first on
+
+    template<typename T> static void convolve_row_generic(
+        const T* src_buffer,
+        T* dst_buffer,
+        uint32 width,
+        const T* kernel,
+        uint32 kernel_size,
+        uint32 first,
+        uint32 last)
+    {
+        const int32 center = int32(kernel_size / 2);
+        const int32 last_index = int32(width) - 1;
+
+        for (uint32 i = first; i < last; ++i)
+        {
+            T sum = T(0);
+
+            for (uint32 k = 0; k < kernel_size; ++k)
+                sum += kernel[k] * src_buffer[clamp_position<int32>(int32(i + k) - center, 0, last_index)];
+
+            dst_buffer[i] = sum;
+        }
+    }
+
+    template<typename T> static void convolve_column_tile_generic(
+        const T* src_buffer,
+        uint32 src_stride,
+        T* dst_buffer,
+        uint32 dst_stride,
+        uint32 columns,
+        uint32 height,
+        const T* kernel,
+        uint32 kernel_size,
+        uint32 first)
+    {
+        const int32 center = int32(kernel_size / 2);
+
+        for (uint32 row = 0; row < height; ++row)
+        {
+            T* dst_row = dst_buffer + row * dst_stride;
+
+            for (uint32 i = first; i < columns; ++i)
+            {
+                T sum = T(0);
+
+                for (uint32 k = 0; k < kernel_size; ++k)
+                    sum += kernel[k] * image_row(src_buffer, src_stride, int32(row + k) - center, height)[i];
+
+                dst_row[i] = sum;
+            }
+        }
+    }
+
+    template<typename T> static void box_blur_row_generic(
+        const T* src_buffer,
+        T* dst_buffer,
+        uint32 width,
+        uint32 radius,
+        uint32 first,
+        uint32 last)
+    {
+        const T scale = T(1) / T(2 * radius + 1);
+        const int32 last_index = int32(width) - 1;
+
+        T sum = box_window_sum(src_buffer, width, radius, first);
+
+        for (uint32 i = first; i < last; ++i)
+        {
+            dst_buffer[i] = sum * scale;
+
+            sum += src_buffer[clamp_position<int32>(int32(i + radius + 1), 0, last_index)]
+                - src_buffer[clamp_position<int32>(int32(i) - int32(radius), 0, last_index)];
+        }
+    }
+
+    template<typename T> static void box_blur_column_tile_generic(
+        const T* src_buffer,
+        uint32 src_stride,
+        T* dst_buffer,
+        uint32 dst_stride,
+        uint32 columns,
+        uint32 height,
+        uint32 radius,
+        uint32 first)
+    {
+        assert(columns <= image_tile_columns);
+
+        const T scale = T(1) / T(2 * radius + 1);
+        T sums[image_tile_columns];
+
+        for (uint32 i = first; i < columns; ++i)
+            sums[i] = T(0);
+
+        for (int32 k = -int32(radius); k <= int32(radius); ++k)
+        {
+            const T* src_row = image_row(src_buffer, src_stride, k, height);
+
+            for (uint32 i = first; i < columns; ++i)
+                sums[i] += src_row[i];
+        }
+
+        for (uint32 row = 0; row < height; ++row)
+        {
+            const T* add_row = image_row(src_buffer, src_stride, int32(row + radius + 1), height);
+            const T* sub_row = image_row(src_buffer, src_stride, int32(row) - int32(radius), height);
+            T* dst_row = dst_buffer + row * dst_stride;
+
+            for (uint32 i = first; i < columns; ++i)
+            {
+                dst_row[i] = sums[i] * scale;
+                sums[i] += add_row[i] - sub_row[i];
+            }
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // row and tile kernels of the resize functions
+
+    #define math_fpu_resize_kernels_impl(datatype) \
+        virtual void resize_row_ ##datatype ( \
+            datatype* src_buffer, \
+            float* dst_buffer, \
+            uint32 width, \
+            uint32 channels, \
+            float* coefficients, \
+            uint32 taps, \
+            uint32* offsets) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            resize_row_generic(src_buffer, dst_buffer, channels, coefficients, taps, offsets, 0, width); \
+        } \
+        \
+        virtual void resize_column_tile_ ##datatype ( \
+            float* src_buffer, \
+            uint32 src_stride, \
+            datatype* dst_buffer, \
+            uint32 dst_stride, \
+            uint32 columns, \
+            uint32 height, \
+            float* coefficients, \
+            uint32 taps, \
+            uint32* offsets) const \
+        { \
+            const disable_fpu_denormals disable_denormals; \
+            \
+            resize_column_tile_generic(src_buffer, src_stride, dst_buffer, dst_stride, \
+                columns, height, coefficients, taps, offsets, 0); \
+        }
+
+    math_fpu_resize_kernels_impl(uint8)
+    math_fpu_resize_kernels_impl(float)
+
+    // a resized sample, rounded to nearest and saturated for bytes
+
+    static forcedinline void store_resized(float* dst_buffer, float value)
+    {
+        *dst_buffer = value;
+    }
+
+    static forcedinline void store_resized(uint8* dst_buffer, float value)
+    {
+        if (value <= 0.0f)
+            *dst_buffer = 0;
+        else if (value >= 255.0f)
+            *dst_buffer = 255;
+        else
+            *dst_buffer = static_cast<uint8>(std::lrint(value));
+    }
+
+    // the resize loops, over the pixels from first to last of a row or over
+    // the columns of a tile from first on
+
+    template<typename T> static void resize_row_generic(
+        const T* src_buffer,
+        float* dst_buffer,
+        uint32 channels,
+        const float* coefficients,
+        uint32 taps,
+        const uint32* offsets,
+        uint32 first,
+        uint32 last)
+    {
+        for (uint32 i = first; i < last; ++i)
+        {
+            const T* window = src_buffer + offsets[i] * channels;
+            const float* coefficient = coefficients + i * taps;
+
+            for (uint32 c = 0; c < channels; ++c)
+            {
+                float sum = 0.0f;
+
+                for (uint32 k = 0; k < taps; ++k)
+                    sum += coefficient[k] * float(window[k * channels + c]);
+
+                dst_buffer[i * channels + c] = sum;
+            }
+        }
+    }
+
+    template<typename T> static void resize_column_tile_generic(
+        const float* src_buffer,
+        uint32 src_stride,
+        T* dst_buffer,
+        uint32 dst_stride,
+        uint32 columns,
+        uint32 height,
+        const float* coefficients,
+        uint32 taps,
+        const uint32* offsets,
+        uint32 first)
+    {
+        for (uint32 row = 0; row < height; ++row)
+        {
+            const float* window = src_buffer + offsets[row] * src_stride;
+            const float* coefficient = coefficients + row * taps;
+            T* dst_row = dst_buffer + row * dst_stride;
+
+            for (uint32 i = first; i < columns; ++i)
+            {
+                float sum = 0.0f;
+
+                for (uint32 k = 0; k < taps; ++k)
+                    sum += coefficient[k] * window[k * src_stride + i];
+
+                store_resized(dst_row + i, sum);
+            }
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // odd powers of two have one radix 2 pass before the radix 4 ones
+
+    static forcedinline bool fft_needs_radix2_pass(uint32 size)
+    {
+        uint32 bits = 0;
+        while ((1u << bits) < size)
+            ++bits;
+
+        return (bits & 1) != 0;
+    }
+
+    template<typename T> static void fft_radix2_pass_generic(
+        T* real_buffer,
+        T* imag_buffer,
+        uint32 size)
+    {
+        for (uint32 i = 0; i < size; i += 2)
+        {
+            const T real = real_buffer[i + 1];
+            const T imag = imag_buffer[i + 1];
+
+            real_buffer[i + 1] = real_buffer[i] - real;
+            imag_buffer[i + 1] = imag_buffer[i] - imag;
+            real_buffer[i] += real;
+            imag_buffer[i] += imag;
+        }
+    }
+
+    // radix 4 pass over the groups of 4 * span, the simd backends leave to it
+    // the spans narrower than a register. The input is bit reversed, so the
+    // quarter of index 1 is the one at 2 * span and the one of index 2 at span
+
+    template<typename T> static void fft_radix4_pass_generic(
+        T* real_buffer,
+        T* imag_buffer,
+        uint32 size,
+        uint32 span,
+        const T* twiddles)
+    {
+        if (span == 1)
+        {
+            // the first pass of even powers of two has unit twiddles only
+            for (uint32 group = 0; group < size; group += 4)
+            {
+                T* real = real_buffer + group;
+                T* imag = imag_buffer + group;
+
+                const T t0_real = real[0] + real[1];
+                const T t0_imag = imag[0] + imag[1];
+                const T t1_real = real[0] - real[1];
+                const T t1_imag = imag[0] - imag[1];
+                const T t2_real = real[2] + real[3];
+                const T t2_imag = imag[2] + imag[3];
+                const T t3_real = real[2] - real[3];
+                const T t3_imag = imag[2] - imag[3];
+
+                real[0] = t0_real + t2_real;
+                imag[0] = t0_imag + t2_imag;
+                real[1] = t1_real + t3_imag;
+                imag[1] = t1_imag - t3_real;
+                real[2] = t0_real - t2_real;
+                imag[2] = t0_imag - t2_imag;
+                real[3] = t1_real - t3_imag;
+                imag[3] = t1_imag + t3_real;
+            }
+
+            return;
+        }
+
+        for (uint32 group = 0; group < size; group += 4 * span)
+        {
+            T* real = real_buffer + group;
+            T* imag = imag_buffer + group;
+
+            for (uint32 k = 0; k < span; ++k)
+            {
+                const T w1_real = twiddles[k];
+                const T w1_imag = twiddles[span + k];
+                const T w2_real = twiddles[2 * span + k];
+                const T w2_imag = twiddles[3 * span + k];
+                const T w3_real = twiddles[4 * span + k];
+                const T w3_imag = twiddles[5 * span + k];
+
+                const T a_real = real[k];
+                const T a_imag = imag[k];
+                const T b_real = real[span + k] * w2_real - imag[span + k] * w2_imag;
+                const T b_imag = real[span + k] * w2_imag + imag[span + k] * w2_real;
+                const T c_real = real[2 * span + k] * w1_real - imag[2 * span + k] * w1_imag;
+                const T c_imag = real[2 * span + k] * w1_imag + imag[2 * span + k] * w1_real;
+                const T d_real = real[3 * span + k] * w3_real - imag[3 * span + k] * w3_imag;
+                const T d_imag = real[3 * span + k] * w3_imag + imag[3 * span + k] * w3_real;
+
+                const T t0_real = a_real + b_real;
+                const T t0_imag = a_imag + b_imag;
+                const T t1_real = a_real - b_real;
+                const T t1_imag = a_imag - b_imag;
+                const T t2_real = c_real + d_real;
+                const T t2_imag = c_imag + d_imag;
+                const T t3_real = c_real - d_real;
+                const T t3_imag = c_imag - d_imag;
+
+                real[k] = t0_real + t2_real;
+                imag[k] = t0_imag + t2_imag;
+                real[span + k] = t1_real + t3_imag;
+                imag[span + k] = t1_imag - t3_real;
+                real[2 * span + k] = t0_real - t2_real;
+                imag[2 * span + k] = t0_imag - t2_imag;
+                real[3 * span + k] = t1_real - t3_imag;
+                imag[3 * span + k] = t1_imag + t3_real;
+            }
+        }
+    }
+
+private:
+
+    //--------------------------------------------------------------------------
+
+    template<typename T> void clear_buffer_generic(
+        T* src_buffer,
+        uint32 size) const
+    {
+        for (uint32 i = 0; i < size; ++i)
+        {
+          *src_buffer++ = static_cast<T>(0);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    template<typename T> void set_buffer_generic(
+        T* src_buffer,
+        uint32 size,
+        T value) const
+    {
+        for (uint32 i = 0; i < size; ++i)
+        {
+          *src_buffer++ = value;
+        }
     }
 
 
     //--------------------------------------------------------------------------
 
-    void scale_buffer_float(
-        float* src_buffer,
+    template<typename T> void scale_buffer_generic(
+        T* src_buffer,
         uint32 size,
         float gain) const
     {
@@ -204,17 +3691,16 @@ public:
 
         for (uint32 i = 0; i < size; ++i)
         {
-          *src_buffer = *src_buffer * gain;
-          undenormalizef(*src_buffer);
-          ++src_buffer;
+            *src_buffer = static_cast<T>(round::f2i((float)(*src_buffer) * gain));
+            ++src_buffer;
         }
     }
 
 
     //--------------------------------------------------------------------------
 
-    void scale_buffer_float(
-        float* src_buffer,
+    template<typename T> void scale_buffer_generic(
+        T* src_buffer,
         uint32 size,
         double gain) const
     {
@@ -222,353 +3708,341 @@ public:
 
         for (uint32 i = 0; i < size; ++i)
         {
-          *src_buffer = *src_buffer * static_cast<float>(gain);
-          undenormalizef(*src_buffer);
-          ++src_buffer;
+            *src_buffer = static_cast<T>(round::d2i((double)(*src_buffer) * gain));
+            ++src_buffer;
         }
     }
 
-    //--------------------------------------------------------------------------
-
-    void copy_buffer_float(
-        float* src_buffer,
-        float* dst_buffer,
-        uint32 size) const
-    {
-        copy_buffer_generic(src_buffer, dst_buffer, size);
-    }
-
 
     //--------------------------------------------------------------------------
 
-    void add_buffers_float(
-        float* src_buffer_a,
-        float* src_buffer_b,
-        float* dst_buffer,
-        uint32 size) const
+    template<typename T> void scale_buffer_saturate_generic(
+        T* src_buffer,
+        uint32 size,
+        float gain) const
     {
-        add_buffers_generic(src_buffer_a, src_buffer_b, dst_buffer, size);
-    }
-
-
-    //--------------------------------------------------------------------------
+        const disable_fpu_denormals disable_denormals;
 
-    void subtract_buffers_float(
-        float* src_buffer_a,
-        float* src_buffer_b,
-        float* dst_buffer,
-        uint32 size) const
-    {
-        subtract_buffers_generic(src_buffer_a, src_buffer_b, dst_buffer, size);
+        for (uint32 i = 0; i < size; ++i)
+        {
+            *src_buffer = scale_saturate_scalar(*src_buffer, gain);
+            ++src_buffer;
+        }
     }
 
 
     //--------------------------------------------------------------------------
 
-    void multiply_buffers_float(
-        float* src_buffer_a,
-        float* src_buffer_b,
-        float* dst_buffer,
+    template<typename T> void copy_buffer_generic(
+        T* src_buffer,
+        T* dst_buffer,
         uint32 size) const
     {
-        const disable_fpu_denormals disable_denormals;
-
         for (uint32 i = 0; i < size; ++i)
         {
-          *dst_buffer = *src_buffer_a++ * *src_buffer_b++;
-          undenormalizef(*dst_buffer);
-          ++dst_buffer;
+          *dst_buffer++ = *src_buffer++;
         }
     }
 
 
     //--------------------------------------------------------------------------
 
-    void divide_buffers_float(
-        float* src_buffer_a,
-        float* src_buffer_b,
-        float* dst_buffer,
+    template<typename T> void add_buffers_generic(
+        T* src_buffer_a,
+        T* src_buffer_b,
+        T* dst_buffer,
         uint32 size) const
     {
-        const disable_fpu_denormals disable_denormals;
-
         for (uint32 i = 0; i < size; ++i)
         {
-          *dst_buffer = *src_buffer_a++ / *src_buffer_b++;
-          undenormalizef(*dst_buffer);
-          ++dst_buffer;
+          *dst_buffer++ = *src_buffer_a++ + *src_buffer_b++;
         }
     }
 
 
-    //==========================================================================
-
     //--------------------------------------------------------------------------
 
-    void clear_buffer_double(
-        double* src_buffer,
+    template<typename T> void subtract_buffers_generic(
+        T* src_buffer_a,
+        T* src_buffer_b,
+        T* dst_buffer,
         uint32 size) const
     {
-        clear_buffer_generic(src_buffer, size);
+        for (uint32 i = 0; i < size; ++i)
+        {
+          *dst_buffer++ = *src_buffer_a++ - *src_buffer_b++;
+        }
     }
 
 
     //--------------------------------------------------------------------------
 
-    void set_buffer_double(
-        double* src_buffer,
-        uint32 size,
-        double value) const
+    template<typename T> void add_buffers_saturate_generic(
+        T* src_buffer_a,
+        T* src_buffer_b,
+        T* dst_buffer,
+        uint32 size) const
     {
-        set_buffer_generic(src_buffer, size, value);
+        for (uint32 i = 0; i < size; ++i)
+        {
+          *dst_buffer++ = add_saturate_scalar(*src_buffer_a++, *src_buffer_b++);
+        }
     }
 
 
     //--------------------------------------------------------------------------
 
-    void scale_buffer_double(
-        double* src_buffer,
-        uint32 size,
-        float gain) const
+    template<typename T> void subtract_buffers_saturate_generic(
+        T* src_buffer_a,
+        T* src_buffer_b,
+        T* dst_buffer,
+        uint32 size) const
     {
-        const disable_fpu_denormals disable_denormals;
-
         for (uint32 i = 0; i < size; ++i)
         {
-          *src_buffer = *src_buffer * (double)gain;
-          undenormalized(*src_buffer);
-          ++src_buffer;
+          *dst_buffer++ = subtract_saturate_scalar(*src_buffer_a++, *src_buffer_b++);
         }
     }
 
 
     //--------------------------------------------------------------------------
 
-    void scale_buffer_double(
-        double* src_buffer,
-        uint32 size,
-        double gain) const
+    template<typename T> void average_buffers_generic(
+        T* src_buffer_a,
+        T* src_buffer_b,
+        T* dst_buffer,
+        uint32 size) const
     {
-        const disable_fpu_denormals disable_denormals;
-
         for (uint32 i = 0; i < size; ++i)
         {
-          *src_buffer = *src_buffer * gain;
-          undenormalized(*src_buffer);
-          ++src_buffer;
+          *dst_buffer++ = average_scalar(*src_buffer_a++, *src_buffer_b++);
         }
     }
 
 
     //--------------------------------------------------------------------------
 
-    void copy_buffer_double(
-        double* src_buffer,
-        double* dst_buffer,
+    template<typename T> void multiply_buffers_generic(
+        T* src_buffer_a,
+        T* src_buffer_b,
+        T* dst_buffer,
         uint32 size) const
     {
         for (uint32 i = 0; i < size; ++i)
         {
-          *dst_buffer++ = *src_buffer++;
+          *dst_buffer++ = *src_buffer_a++ * *src_buffer_b++;
         }
     }
 
 
     //--------------------------------------------------------------------------
 
-    void add_buffers_double(
-        double* src_buffer_a,
-        double* src_buffer_b,
-        double* dst_buffer,
+    template<typename T> void abs_buffer_generic(
+        T* src_buffer,
         uint32 size) const
     {
-        add_buffers_generic(src_buffer_a, src_buffer_b, dst_buffer, size);
+        for (uint32 i = 0; i < size; ++i)
+        {
+          *src_buffer = abs_value(*src_buffer);
+            ++src_buffer;
+        }
     }
 
 
     //--------------------------------------------------------------------------
 
-    void subtract_buffers_double(
-        double* src_buffer_a,
-        double* src_buffer_b,
-        double* dst_buffer,
-        uint32 size) const
+    template<typename T> static forcedinline T abs_value(T value)
     {
-        subtract_buffers_generic(src_buffer_a, src_buffer_b, dst_buffer, size);
+        // wraps like the simd versions, the minimum stays negative
+        return value < T(0) ? static_cast<T>(0 - static_cast<uint64>(value)) : value;
     }
 
+    static forcedinline uint8 abs_value(uint8 value) { return value; }
+    static forcedinline uint16 abs_value(uint16 value) { return value; }
+    static forcedinline uint32 abs_value(uint32 value) { return value; }
+    static forcedinline uint64 abs_value(uint64 value) { return value; }
+    static forcedinline float abs_value(float value) { return std::fabs(value); }
+    static forcedinline double abs_value(double value) { return std::fabs(value); }
+
 
     //--------------------------------------------------------------------------
 
-    void multiply_buffers_double(
-        double* src_buffer_a,
-        double* src_buffer_b,
-        double* dst_buffer,
+    template<typename T> void divide_buffers_generic(
+        T* src_buffer_a,
+        T* src_buffer_b,
+        T* dst_buffer,
         uint32 size) const
     {
-        const disable_fpu_denormals disable_denormals;
-
         for (uint32 i = 0; i < size; ++i)
         {
-          *dst_buffer = *src_buffer_a++ * *src_buffer_b++;
-          undenormalized(*dst_buffer);
-          ++dst_buffer;
+          *dst_buffer++ = *src_buffer_a++ / *src_buffer_b++;
         }
     }
 
 
     //--------------------------------------------------------------------------
 
-    void divide_buffers_double(
-        double* src_buffer_a,
-        double* src_buffer_b,
-        double* dst_buffer,
+    template<typename A, typename T> A sum_buffer_generic(
+        T* src_buffer,
         uint32 size) const
     {
-        const disable_fpu_denormals disable_denormals;
+        // accumulate as uint64 so wrapping around is well defined
+        uint64 result = 0;
 
         for (uint32 i = 0; i < size; ++i)
         {
-          *dst_buffer = *src_buffer_a++ / *src_buffer_b++;
-          undenormalized(*dst_buffer);
-          ++dst_buffer;
+          result += static_cast<uint64>(*src_buffer++);
         }
-    }
 
+        return static_cast<A>(result);
+    }
 
-private:
 
     //--------------------------------------------------------------------------
 
-    template<typename T> void clear_buffer_generic(
-        T* src_buffer,
+    template<typename A, typename T> A dot_product_generic(
+        T* src_buffer_a,
+        T* src_buffer_b,
         uint32 size) const
     {
+        uint64 result = 0;
+
         for (uint32 i = 0; i < size; ++i)
         {
-          *src_buffer++ = static_cast<T>(0);
+          result += static_cast<uint64>(*src_buffer_a++) * static_cast<uint64>(*src_buffer_b++);
         }
+
+        return static_cast<A>(result);
     }
 
+
     //--------------------------------------------------------------------------
 
-    template<typename T> void set_buffer_generic(
+    template<typename T> T min_buffer_generic(
         T* src_buffer,
         uint32 size,
-        T value) const
+        uint32* index) const
     {
-        for (uint32 i = 0; i < size; ++i)
+        T result = size > 0 ? src_buffer[0] : T(0);
+        uint32 result_index = 0;
+
+        for (uint32 i = 1; i < size; ++i)
         {
-          *src_buffer++ = value;
+          if (src_buffer[i] < result)
+          {
+              result = src_buffer[i];
+              result_index = i;
+          }
         }
+
+        if (index != nullptr)
+            *index = result_index;
+
+        return result;
     }
 
 
     //--------------------------------------------------------------------------
 
-    template<typename T> void scale_buffer_generic(
+    template<typename T> T max_buffer_generic(
         T* src_buffer,
         uint32 size,
-        float gain) const
+        uint32* index) const
     {
-        const disable_fpu_denormals disable_denormals;
+        T result = size > 0 ? src_buffer[0] : T(0);
+        uint32 result_index = 0;
 
-        for (uint32 i = 0; i < size; ++i)
+        for (uint32 i = 1; i < size; ++i)
         {
-            *src_buffer = static_cast<T>(round::f2i((float)(*src_buffer) * gain));
-            ++src_buffer;
+          if (src_buffer[i] > result)
+          {
+              result = src_buffer[i];
+              result_index = i;
+          }
         }
+
+        if (index != nullptr)
+            *index = result_index;
+
+        return result;
     }
 
 
     //--------------------------------------------------------------------------
 
-    template<typename T> void scale_buffer_generic(
+    template<typename A, typename T> A peak_abs_buffer_generic(
         T* src_buffer,
-        uint32 size,
-        double gain) const
+        uint32 size) const
     {
-        const disable_fpu_denormals disable_denormals;
+        uint64 result = 0;
 
         for (uint32 i = 0; i < size; ++i)
         {
-            *src_buffer = static_cast<T>(round::d2i((double)(*src_buffer) * gain));
-            ++src_buffer;
+          const uint64 value = magnitude_value(*src_buffer++);
+          if (value > result)
+              result = value;
         }
+
+        return static_cast<A>(result);
     }
 
 
     //--------------------------------------------------------------------------
 
-    template<typename T> void copy_buffer_generic(
+    template<typename T> double rms_buffer_generic(
         T* src_buffer,
-        T* dst_buffer,
         uint32 size) const
     {
+        double result = 0.0;
+
         for (uint32 i = 0; i < size; ++i)
         {
-          *dst_buffer++ = *src_buffer++;
+          const double value = static_cast<double>(*src_buffer++);
+          result += value * value;
         }
-    }
 
+        return rms_from_sum_of_squares(result, size);
+    }
 
-    //--------------------------------------------------------------------------
-
-    template<typename T> void add_buffers_generic(
-        T* src_buffer_a,
-        T* src_buffer_b,
-        T* dst_buffer,
-        uint32 size) const
+    // squares of 8 and 16 bit values never wrap the dot product accumulator,
+    // so let the most derived backend do the work
+    double rms_buffer_generic(int8* src_buffer, uint32 size) const
     {
-        for (uint32 i = 0; i < size; ++i)
-        {
-          *dst_buffer++ = *src_buffer_a++ + *src_buffer_b++;
-        }
+        return rms_from_sum_of_squares(static_cast<double>(dot_product_int8(src_buffer, src_buffer, size)), size);
     }
 
+    double rms_buffer_generic(uint8* src_buffer, uint32 size) const
+    {
+        return rms_from_sum_of_squares(static_cast<double>(dot_product_uint8(src_buffer, src_buffer, size)), size);
+    }
 
-    //--------------------------------------------------------------------------
+    double rms_buffer_generic(int16* src_buffer, uint32 size) const
+    {
+        return rms_from_sum_of_squares(static_cast<double>(dot_product_int16(src_buffer, src_buffer, size)), size);
+    }
 
-    template<typename T> void subtract_buffers_generic(
-        T* src_buffer_a,
-        T* src_buffer_b,
-        T* dst_buffer,
-        uint32 size) const
+    double rms_buffer_generic(uint16* src_buffer, uint32 size) const
     {
-        for (uint32 i = 0; i < size; ++i)
-        {
-          *dst_buffer++ = *src_buffer_a++ - *src_buffer_b++;
-        }
+        return rms_from_sum_of_squares(static_cast<double>(dot_product_uint16(src_buffer, src_buffer, size)), size);
     }
 
 
     //--------------------------------------------------------------------------
 
-    template<typename T> void multiply_buffers_generic(
-        T* src_buffer_a,
-        T* src_buffer_b,
-        T* dst_buffer,
-        uint32 size) const
+    static forcedinline double rms_from_sum_of_squares(double sum_of_squares, uint32 size)
     {
-        for (uint32 i = 0; i < size; ++i)
-        {
-          *dst_buffer++ = *src_buffer_a++ * *src_buffer_b++;
-        }
+        return size > 0 ? std::sqrt(sum_of_squares / size) : 0.0;
     }
 
 
     //--------------------------------------------------------------------------
 
-    template<typename T> void divide_buffers_generic(
-        T* src_buffer_a,
-        T* src_buffer_b,
-        T* dst_buffer,
-        uint32 size) const
+    static forcedinline void kahan_add(double& sum, double& compensation, double value)
     {
-        for (uint32 i = 0; i < size; ++i)
-        {
-          *dst_buffer++ = *src_buffer_a++ / *src_buffer_b++;
-        }
+        const double y = value - compensation;
+        const double t = sum + y;
+        compensation = (t - sum) - y;
+        sum = t;
     }
 
 };
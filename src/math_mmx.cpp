@@ -0,0 +1,74 @@
+/*
+ * waterspout
+ *
+ *   - simd abstraction library for audio/image manipulation -
+ *
+ * Copyright (c) 2015 Lucio Asnaghi
+ *
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "waterspout_internal.h"
+
+
+#if defined(WATERSPOUT_SIMD_MMX)
+
+
+waterspout_target_begin("mmx")
+
+
+namespace waterspout {
+
+
+//==============================================================================
+
+//------------------------------------------------------------------------------
+
+/**
+ * MMX backend, the first one built for its own instruction set
+ */
+
+namespace simd_mmx {
+
+#include "math_fpu.h"
+#include "math_mmx.h"
+#include "math_dispatch.h"
+
+} // end namespace simd_mmx
+
+
+//------------------------------------------------------------------------------
+
+math_interface_* create_math_mmx(math_dispatch_table& table)
+{
+    simd_mmx::math_dispatch<simd_mmx::math_mmx>::fill_dispatch_table(table);
+
+    return new simd_mmx::math_mmx;
+}
+
+
+} // end namespace
+
+
+waterspout_target_end
+
+
+#endif // WATERSPOUT_SIMD_MMX
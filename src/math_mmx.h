@@ -325,6 +325,78 @@ public:
         }
     }
 
+
+    //--------------------------------------------------------------------------
+
+    #define math_mmx_saturating_buffers_impl(function, datatype, scalar_op, vector_op) \
+        void function ##_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            const ptrdiff_t align_bytes = ((ptrdiff_t)dst_buffer & MMX_ALIGN); \
+            \
+            if (size < MMX_MIN_SAMPLES || \
+                (align_bytes != ((ptrdiff_t)src_buffer_a & MMX_ALIGN) || \
+                 align_bytes != ((ptrdiff_t)src_buffer_b & MMX_ALIGN))) \
+            { \
+                math_fpu::function ##_ ##datatype ( \
+                    src_buffer_a, src_buffer_b, dst_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= MMX_MIN_SIZE); \
+                \
+                /* Copy unaligned head */ \
+                simd_loop_head(datatype, MMX_ALIGN, \
+                    --size; \
+                    *dst_buffer++ = scalar_op(*src_buffer_a++, *src_buffer_b++); \
+                ); \
+                \
+                /* Operate with simd */ \
+                __m64* vector_buffer_a = (__m64*)src_buffer_a; \
+                __m64* vector_buffer_b = (__m64*)src_buffer_b; \
+                __m64* vector_dst_buffer = (__m64*)dst_buffer; \
+                \
+                uint32 vector_count = size / (8 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    *vector_dst_buffer = \
+                      vector_op(*vector_buffer_a, *vector_buffer_b); \
+                    \
+                    ++vector_buffer_a; \
+                    ++vector_buffer_b; \
+                    ++vector_dst_buffer; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer_a = (datatype*)vector_buffer_a; \
+                src_buffer_b = (datatype*)vector_buffer_b; \
+                dst_buffer = (datatype*)vector_dst_buffer; \
+                \
+                simd_loop_tail(8 / sizeof(datatype), \
+                    *dst_buffer++ = scalar_op(*src_buffer_a++, *src_buffer_b++); \
+                ); \
+                \
+                /* Reset floating point state */ \
+                _mm_empty(); \
+            } \
+        }
+
+    math_mmx_saturating_buffers_impl(add_buffers_saturate, int8, add_saturate_scalar, _mm_adds_pi8)
+    math_mmx_saturating_buffers_impl(add_buffers_saturate, uint8, add_saturate_scalar, _mm_adds_pu8)
+    math_mmx_saturating_buffers_impl(add_buffers_saturate, int16, add_saturate_scalar, _mm_adds_pi16)
+    math_mmx_saturating_buffers_impl(add_buffers_saturate, uint16, add_saturate_scalar, _mm_adds_pu16)
+
+    math_mmx_saturating_buffers_impl(subtract_buffers_saturate, int8, subtract_saturate_scalar, _mm_subs_pi8)
+    math_mmx_saturating_buffers_impl(subtract_buffers_saturate, uint8, subtract_saturate_scalar, _mm_subs_pu8)
+    math_mmx_saturating_buffers_impl(subtract_buffers_saturate, int16, subtract_saturate_scalar, _mm_subs_pi16)
+    math_mmx_saturating_buffers_impl(subtract_buffers_saturate, uint16, subtract_saturate_scalar, _mm_subs_pu16)
+
+    // averaging (pavgb / pavgw) only came with the SSE integer extensions and
+    // scaling needs floats, both are left to the base class
+
 };
 
 
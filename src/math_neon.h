@@ -31,12 +31,69 @@
 #define __WATERSPOUT_SIMD_ABSTRACTION_FRAMEWORK_MATH_NEON_H__
 
 
+//==============================================================================
+
+//------------------------------------------------------------------------------
+
+struct disable_neon_denormals
+{
+    disable_neon_denormals()
+    {
+        disable_floating_point_assertions;
+
+        old_fpscr_ = get_fpscr();
+
+        if ((old_fpscr_ & 0x1000000) == 0) // set FZ bit...
+        {
+            set_fpscr(old_fpscr_ | 0x1000000);
+        }
+    }
+
+    ~disable_neon_denormals()
+    {
+        if ((old_fpscr_ & 0x1000000) == 0)
+        {
+            set_fpscr(old_fpscr_);
+        }
+
+        enable_floating_point_assertions;
+    }
+
+private:
+    static forcedinline uintptr_t get_fpscr()
+    {
+        uintptr_t value = 0;
+      #if defined(WATERSPOUT_COMPILER_MSVC)
+        // not reachable from msvc, armv7 neon flushes denormals anyway
+      #elif defined(WATERSPOUT_ARCH_ARM64)
+        __asm__ __volatile__ ("mrs %0, fpcr" : "=r" (value));
+      #else
+        __asm__ __volatile__ ("vmrs %0, fpscr" : "=r" (value));
+      #endif
+        return value;
+    }
+
+    static forcedinline void set_fpscr(uintptr_t value)
+    {
+      #if defined(WATERSPOUT_COMPILER_MSVC)
+        unused(value);
+      #elif defined(WATERSPOUT_ARCH_ARM64)
+        __asm__ __volatile__ ("msr fpcr, %0" : : "r" (value));
+      #else
+        __asm__ __volatile__ ("vmsr fpscr, %0" : : "r" (value));
+      #endif
+    }
+
+    uintptr_t old_fpscr_;
+};
+
+
 //==============================================================================
 
 //------------------------------------------------------------------------------
 
 /**
- * Specific NEON math class
+ * Specific NEON math class elaborating on 128bit registers
  */
 
 class math_neon : public math_fpu
@@ -48,6 +105,15 @@ public:
     const char* name() const { return "NEON"; }
 
 
+    //--------------------------------------------------------------------------
+
+    enum NEONMathDefines
+    {
+        NEON_MIN_SIZE    = 4,
+        NEON_MIN_SAMPLES = 16
+    };
+
+
     //--------------------------------------------------------------------------
 
     math_neon()
@@ -55,6 +121,3604 @@ public:
         //assertfalse; // not implemented !
     }
 
+
+    //==========================================================================
+
+    //--------------------------------------------------------------------------
+
+    // vld1q / vst1q do not require any alignment, so the kernels below don't
+    // need to process an unaligned head: they run the simd loop straight away
+    // and let the fpu implementation finish the leftovers
+
+    #define math_neon_set_buffer_impl(datatype, element_type, vector_type, suffix) \
+        void clear_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size) const \
+        { \
+            set_buffer_ ##datatype (src_buffer, size, datatype(0)); \
+        } \
+        \
+        void set_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            datatype value) const \
+        { \
+            if (size < NEON_MIN_SAMPLES) \
+            { \
+                math_fpu::set_buffer_ ##datatype (src_buffer, size, value); \
+            } \
+            else \
+            { \
+                assert(size >= NEON_MIN_SIZE); \
+                \
+                /* Set with simd */ \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                const vector_type vvalue = vdupq_n_ ##suffix ((element_type)value); \
+                \
+                uint32 vector_count = size / vector_size; \
+                while (vector_count--) \
+                { \
+                    vst1q_ ##suffix ((element_type*)src_buffer, vvalue); \
+                    \
+                    src_buffer += vector_size; \
+                } \
+                \
+                /* Handle any leftovers */ \
+                math_fpu::set_buffer_ ##datatype (src_buffer, \
+                    size & (vector_size - 1), value); \
+            } \
+        }
+
+    #define math_neon_scale_buffer_impl(datatype, gaintype, element_type, suffix, vector_scale_type, vector_scale_set) \
+        void scale_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            gaintype gain) const \
+        { \
+            if (size < NEON_MIN_SAMPLES) \
+            { \
+                math_fpu::scale_buffer_ ##datatype (src_buffer, size, gain); \
+            } \
+            else \
+            { \
+                assert(size >= NEON_MIN_SIZE); \
+                \
+                const disable_neon_denormals disable_denormals; \
+                \
+                /* Scale with simd */ \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                const vector_scale_type vscale = vector_scale_set; \
+                \
+                uint32 vector_count = size / vector_size; \
+                while (vector_count--) \
+                { \
+                    vst1q_ ##suffix ((element_type*)src_buffer, scale_vector( \
+                        vld1q_ ##suffix ((const element_type*)src_buffer), vscale)); \
+                    \
+                    src_buffer += vector_size; \
+                } \
+                \
+                /* Handle any leftovers */ \
+                math_fpu::scale_buffer_ ##datatype (src_buffer, \
+                    size & (vector_size - 1), gain); \
+            } \
+        }
+
+    #define math_neon_scale_saturate_buffer_impl(datatype, element_type, suffix) \
+        void scale_buffer_saturate_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            float gain) const \
+        { \
+            if (size < NEON_MIN_SAMPLES) \
+            { \
+                math_fpu::scale_buffer_saturate_ ##datatype (src_buffer, size, gain); \
+            } \
+            else \
+            { \
+                assert(size >= NEON_MIN_SIZE); \
+                \
+                const disable_neon_denormals disable_denormals; \
+                \
+                /* Scale with simd */ \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                const float32x4_t vscale = vdupq_n_f32(gain); \
+                \
+                uint32 vector_count = size / vector_size; \
+                while (vector_count--) \
+                { \
+                    vst1q_ ##suffix ((element_type*)src_buffer, scale_saturate_vector( \
+                        vld1q_ ##suffix ((const element_type*)src_buffer), vscale)); \
+                    \
+                    src_buffer += vector_size; \
+                } \
+                \
+                /* Handle any leftovers */ \
+                math_fpu::scale_buffer_saturate_ ##datatype (src_buffer, \
+                    size & (vector_size - 1), gain); \
+            } \
+        }
+
+    #define math_neon_copy_buffer_impl(datatype, element_type, suffix) \
+        void copy_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            if (size < NEON_MIN_SAMPLES) \
+            { \
+                math_fpu::copy_buffer_ ##datatype (src_buffer, dst_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= NEON_MIN_SIZE); \
+                \
+                /* Copy with simd */ \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                \
+                uint32 vector_count = size / vector_size; \
+                while (vector_count--) \
+                { \
+                    vst1q_ ##suffix ((element_type*)dst_buffer, \
+                        vld1q_ ##suffix ((const element_type*)src_buffer)); \
+                    \
+                    src_buffer += vector_size; \
+                    dst_buffer += vector_size; \
+                } \
+                \
+                /* Handle any leftovers */ \
+                math_fpu::copy_buffer_ ##datatype (src_buffer, dst_buffer, \
+                    size & (vector_size - 1)); \
+            } \
+        }
+
+    #define math_neon_binary_buffers_impl(function, datatype, element_type, suffix, vector_op, guard) \
+        void function ##_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            if (size < NEON_MIN_SAMPLES) \
+            { \
+                math_fpu::function ##_ ##datatype ( \
+                    src_buffer_a, src_buffer_b, dst_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= NEON_MIN_SIZE); \
+                \
+                guard \
+                \
+                /* Operate with simd */ \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                \
+                uint32 vector_count = size / vector_size; \
+                while (vector_count--) \
+                { \
+                    vst1q_ ##suffix ((element_type*)dst_buffer, vector_op( \
+                        vld1q_ ##suffix ((const element_type*)src_buffer_a), \
+                        vld1q_ ##suffix ((const element_type*)src_buffer_b))); \
+                    \
+                    src_buffer_a += vector_size; \
+                    src_buffer_b += vector_size; \
+                    dst_buffer += vector_size; \
+                } \
+                \
+                /* Handle any leftovers */ \
+                math_fpu::function ##_ ##datatype ( \
+                    src_buffer_a, src_buffer_b, dst_buffer, \
+                    size & (vector_size - 1)); \
+            } \
+        }
+
+    #define math_neon_unary_buffer_impl(function, datatype, element_type, suffix, vector_op) \
+        void function ##_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size) const \
+        { \
+            if (size < NEON_MIN_SAMPLES) \
+            { \
+                math_fpu::function ##_ ##datatype (src_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= NEON_MIN_SIZE); \
+                \
+                /* Operate with simd */ \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                \
+                uint32 vector_count = size / vector_size; \
+                while (vector_count--) \
+                { \
+                    vst1q_ ##suffix ((element_type*)src_buffer, vector_op( \
+                        vld1q_ ##suffix ((const element_type*)src_buffer))); \
+                    \
+                    src_buffer += vector_size; \
+                } \
+                \
+                /* Handle any leftovers */ \
+                math_fpu::function ##_ ##datatype (src_buffer, \
+                    size & (vector_size - 1)); \
+            } \
+        }
+
+    #define math_neon_multiply_add_buffers_impl(datatype, element_type, suffix) \
+        void multiply_add_buffers_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* src_buffer_c, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            if (size < NEON_MIN_SAMPLES) \
+            { \
+                math_fpu::multiply_add_buffers_ ##datatype ( \
+                    src_buffer_a, src_buffer_b, src_buffer_c, dst_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= NEON_MIN_SIZE); \
+                \
+                const disable_neon_denormals disable_denormals; \
+                \
+                /* Multiply and add with simd */ \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                \
+                uint32 vector_count = size / vector_size; \
+                while (vector_count--) \
+                { \
+                    vst1q_ ##suffix ((element_type*)dst_buffer, multiply_add_vector( \
+                        vld1q_ ##suffix ((const element_type*)src_buffer_a), \
+                        vld1q_ ##suffix ((const element_type*)src_buffer_b), \
+                        vld1q_ ##suffix ((const element_type*)src_buffer_c))); \
+                    \
+                    src_buffer_a += vector_size; \
+                    src_buffer_b += vector_size; \
+                    src_buffer_c += vector_size; \
+                    dst_buffer += vector_size; \
+                } \
+                \
+                /* Handle any leftovers */ \
+                math_fpu::multiply_add_buffers_ ##datatype ( \
+                    src_buffer_a, src_buffer_b, src_buffer_c, dst_buffer, \
+                    size & (vector_size - 1)); \
+            } \
+        }
+
+    #define math_neon_scale_add_buffer_impl(datatype, element_type, vector_type, suffix) \
+        void scale_add_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype gain) const \
+        { \
+            if (size < NEON_MIN_SAMPLES) \
+            { \
+                math_fpu::scale_add_buffer_ ##datatype ( \
+                    src_buffer, dst_buffer, size, gain); \
+            } \
+            else \
+            { \
+                assert(size >= NEON_MIN_SIZE); \
+                \
+                const disable_neon_denormals disable_denormals; \
+                \
+                /* Scale and accumulate with simd */ \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                const vector_type vgain = vdupq_n_ ##suffix (gain); \
+                \
+                uint32 vector_count = size / vector_size; \
+                while (vector_count--) \
+                { \
+                    vst1q_ ##suffix ((element_type*)dst_buffer, multiply_add_vector( \
+                        vld1q_ ##suffix ((const element_type*)src_buffer), vgain, \
+                        vld1q_ ##suffix ((const element_type*)dst_buffer))); \
+                    \
+                    src_buffer += vector_size; \
+                    dst_buffer += vector_size; \
+                } \
+                \
+                /* Handle any leftovers */ \
+                math_fpu::scale_add_buffer_ ##datatype ( \
+                    src_buffer, dst_buffer, \
+                    size & (vector_size - 1), gain); \
+            } \
+        }
+
+    #define math_neon_ramp_scale_buffer_impl(datatype, element_type, vector_type, suffix) \
+        void ramp_scale_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            datatype start_gain, \
+            datatype end_gain) const \
+        { \
+            if (size < NEON_MIN_SAMPLES) \
+            { \
+                math_fpu::ramp_scale_buffer_ ##datatype ( \
+                    src_buffer, size, start_gain, end_gain); \
+            } \
+            else \
+            { \
+                assert(size >= NEON_MIN_SIZE); \
+                \
+                const disable_neon_denormals disable_denormals; \
+                \
+                /* Ramp with simd, the sample indices are advanced in registers */ \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                const datatype increment = \
+                    ramp_increment(start_gain, end_gain, size); \
+                \
+                element_type lanes[16 / sizeof(datatype)]; \
+                ramp_index_lanes(lanes, vector_size, 0); \
+                \
+                const vector_type vstart = vdupq_n_ ##suffix (start_gain); \
+                const vector_type vincrement = vdupq_n_ ##suffix (increment); \
+                const vector_type vstep = vdupq_n_ ##suffix ((datatype)vector_size); \
+                vector_type vindex = vld1q_ ##suffix (lanes); \
+                \
+                uint32 vector_count = size / vector_size; \
+                const uint32 index = vector_count * vector_size; \
+                while (vector_count--) \
+                { \
+                    vst1q_ ##suffix ((element_type*)src_buffer, vmulq_ ##suffix ( \
+                        vld1q_ ##suffix ((const element_type*)src_buffer), \
+                        vaddq_ ##suffix (vstart, vmulq_ ##suffix (vincrement, vindex)))); \
+                    vindex = vaddq_ ##suffix (vindex, vstep); \
+                    \
+                    src_buffer += vector_size; \
+                } \
+                \
+                /* Handle any leftovers */ \
+                ramp_scale_generic(src_buffer, size - index, \
+                    start_gain, increment, index); \
+            } \
+        }
+
+    #define math_neon_exp_ramp_scale_buffer_impl(datatype, element_type, vector_type, suffix) \
+        void exp_ramp_scale_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            datatype start_gain, \
+            datatype end_gain) const \
+        { \
+            if (size < NEON_MIN_SAMPLES || \
+                ! is_exp_ramp(start_gain, end_gain, size)) \
+            { \
+                math_fpu::exp_ramp_scale_buffer_ ##datatype ( \
+                    src_buffer, size, start_gain, end_gain); \
+            } \
+            else \
+            { \
+                assert(size >= NEON_MIN_SIZE); \
+                \
+                const disable_neon_denormals disable_denormals; \
+                \
+                /* Ramp with simd, the gains are multiplied in registers and */ \
+                /* put back on the exact curve at the start of every block */ \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                const double log_ratio = \
+                    exp_ramp_log_ratio(start_gain, end_gain, size); \
+                \
+                element_type lanes[16 / sizeof(datatype)]; \
+                \
+                const vector_type vstep = \
+                    vdupq_n_ ##suffix ((datatype)std::exp(log_ratio * vector_size)); \
+                \
+                uint32 index = 0; \
+                uint32 vector_count = size / vector_size; \
+                while (vector_count > 0) \
+                { \
+                    uint32 block_count = vector_count < RAMP_BLOCK_SIZE / vector_size ? \
+                        vector_count : RAMP_BLOCK_SIZE / vector_size; \
+                    vector_count -= block_count; \
+                    \
+                    exp_ramp_lanes(lanes, vector_size, start_gain, log_ratio, index); \
+                    vector_type vgain = vld1q_ ##suffix (lanes); \
+                    index += block_count * vector_size; \
+                    \
+                    while (block_count--) \
+                    { \
+                        vst1q_ ##suffix ((element_type*)src_buffer, vmulq_ ##suffix ( \
+                            vld1q_ ##suffix ((const element_type*)src_buffer), vgain)); \
+                        vgain = vmulq_ ##suffix (vgain, vstep); \
+                        \
+                        src_buffer += vector_size; \
+                    } \
+                } \
+                \
+                /* Handle any leftovers */ \
+                exp_ramp_scale_generic(src_buffer, size - index, \
+                    start_gain, log_ratio, index); \
+            } \
+        }
+
+    #define math_neon_mixing_kernels_impl(datatype, element_type, vector_type, suffix) \
+        void stereo_gain_buffers_ ##datatype ( \
+            datatype* src_left_buffer, \
+            datatype* src_right_buffer, \
+            datatype* dst_left_buffer, \
+            datatype* dst_right_buffer, \
+            uint32 size, \
+            datatype left_gain, \
+            datatype right_gain) const \
+        { \
+            if (size < NEON_MIN_SAMPLES) \
+            { \
+                math_fpu::stereo_gain_buffers_ ##datatype (src_left_buffer, src_right_buffer, \
+                    dst_left_buffer, dst_right_buffer, size, left_gain, right_gain); \
+            } \
+            else \
+            { \
+                assert(size >= NEON_MIN_SIZE); \
+                \
+                const disable_neon_denormals disable_denormals; \
+                \
+                /* Scale both channels with simd */ \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                const vector_type vleft_gain = vdupq_n_ ##suffix (left_gain); \
+                const vector_type vright_gain = vdupq_n_ ##suffix (right_gain); \
+                \
+                uint32 vector_count = size / vector_size; \
+                const uint32 index = vector_count * vector_size; \
+                for (uint32 i = 0; i < index; i += vector_size) \
+                { \
+                    const vector_type vleft = vld1q_ ##suffix ((const element_type*)src_left_buffer + i); \
+                    const vector_type vright = vld1q_ ##suffix ((const element_type*)src_right_buffer + i); \
+                    \
+                    vst1q_ ##suffix ((element_type*)dst_left_buffer + i, vmulq_ ##suffix (vleft, vleft_gain)); \
+                    vst1q_ ##suffix ((element_type*)dst_right_buffer + i, vmulq_ ##suffix (vright, vright_gain)); \
+                } \
+                \
+                /* Handle any leftovers */ \
+                stereo_gain_generic(src_left_buffer + index, src_right_buffer + index, \
+                    dst_left_buffer + index, dst_right_buffer + index, size - index, \
+                    left_gain, right_gain); \
+            } \
+        } \
+        \
+        void ramp_stereo_gain_buffers_ ##datatype ( \
+            datatype* src_left_buffer, \
+            datatype* src_right_buffer, \
+            datatype* dst_left_buffer, \
+            datatype* dst_right_buffer, \
+            uint32 size, \
+            datatype left_gain, \
+            datatype left_increment, \
+            datatype right_gain, \
+            datatype right_increment) const \
+        { \
+            if (size < NEON_MIN_SAMPLES) \
+            { \
+                math_fpu::ramp_stereo_gain_buffers_ ##datatype (src_left_buffer, src_right_buffer, \
+                    dst_left_buffer, dst_right_buffer, size, \
+                    left_gain, left_increment, right_gain, right_increment); \
+            } \
+            else \
+            { \
+                assert(size >= NEON_MIN_SIZE); \
+                \
+                const disable_neon_denormals disable_denormals; \
+                \
+                /* Ramp both channels with simd, sharing the sample indices */ \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                \
+                element_type lanes[16 / sizeof(datatype)]; \
+                ramp_index_lanes(lanes, vector_size, 0); \
+                \
+                const vector_type vleft_gain = vdupq_n_ ##suffix (left_gain); \
+                const vector_type vleft_increment = vdupq_n_ ##suffix (left_increment); \
+                const vector_type vright_gain = vdupq_n_ ##suffix (right_gain); \
+                const vector_type vright_increment = vdupq_n_ ##suffix (right_increment); \
+                const vector_type vstep = vdupq_n_ ##suffix ((datatype)vector_size); \
+                vector_type vindex = vld1q_ ##suffix (lanes); \
+                \
+                uint32 vector_count = size / vector_size; \
+                const uint32 index = vector_count * vector_size; \
+                for (uint32 i = 0; i < index; i += vector_size) \
+                { \
+                    const vector_type vleft = vld1q_ ##suffix ((const element_type*)src_left_buffer + i); \
+                    const vector_type vright = vld1q_ ##suffix ((const element_type*)src_right_buffer + i); \
+                    \
+                    vst1q_ ##suffix ((element_type*)dst_left_buffer + i, vmulq_ ##suffix (vleft, \
+                        vaddq_ ##suffix (vleft_gain, vmulq_ ##suffix (vleft_increment, vindex)))); \
+                    vst1q_ ##suffix ((element_type*)dst_right_buffer + i, vmulq_ ##suffix (vright, \
+                        vaddq_ ##suffix (vright_gain, vmulq_ ##suffix (vright_increment, vindex)))); \
+                    vindex = vaddq_ ##suffix (vindex, vstep); \
+                } \
+                \
+                /* Handle any leftovers */ \
+                ramp_stereo_gain_generic(src_left_buffer + index, src_right_buffer + index, \
+                    dst_left_buffer + index, dst_right_buffer + index, size - index, \
+                    left_gain, left_increment, right_gain, right_increment, index); \
+            } \
+        } \
+        \
+        void mix_gain_buffers_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype gain_a, \
+            datatype gain_b) const \
+        { \
+            if (size < NEON_MIN_SAMPLES) \
+            { \
+                math_fpu::mix_gain_buffers_ ##datatype (src_buffer_a, src_buffer_b, \
+                    dst_buffer, size, gain_a, gain_b); \
+            } \
+            else \
+            { \
+                assert(size >= NEON_MIN_SIZE); \
+                \
+                const disable_neon_denormals disable_denormals; \
+                \
+                /* Mix with simd */ \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                const vector_type vgain_a = vdupq_n_ ##suffix (gain_a); \
+                const vector_type vgain_b = vdupq_n_ ##suffix (gain_b); \
+                \
+                uint32 vector_count = size / vector_size; \
+                const uint32 index = vector_count * vector_size; \
+                for (uint32 i = 0; i < index; i += vector_size) \
+                { \
+                    vst1q_ ##suffix ((element_type*)dst_buffer + i, vaddq_ ##suffix ( \
+                        vmulq_ ##suffix (vld1q_ ##suffix ((const element_type*)src_buffer_a + i), vgain_a), \
+                        vmulq_ ##suffix (vld1q_ ##suffix ((const element_type*)src_buffer_b + i), vgain_b))); \
+                } \
+                \
+                /* Handle any leftovers */ \
+                mix_gain_generic(src_buffer_a + index, src_buffer_b + index, \
+                    dst_buffer + index, size - index, gain_a, gain_b); \
+            } \
+        } \
+        \
+        void ramp_mix_gain_buffers_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype gain_a, \
+            datatype increment_a, \
+            datatype gain_b, \
+            datatype increment_b) const \
+        { \
+            if (size < NEON_MIN_SAMPLES) \
+            { \
+                math_fpu::ramp_mix_gain_buffers_ ##datatype (src_buffer_a, src_buffer_b, \
+                    dst_buffer, size, gain_a, increment_a, gain_b, increment_b); \
+            } \
+            else \
+            { \
+                assert(size >= NEON_MIN_SIZE); \
+                \
+                const disable_neon_denormals disable_denormals; \
+                \
+                /* Mix with simd, both gains share the sample indices */ \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                \
+                element_type lanes[16 / sizeof(datatype)]; \
+                ramp_index_lanes(lanes, vector_size, 0); \
+                \
+                const vector_type vgain_a = vdupq_n_ ##suffix (gain_a); \
+                const vector_type vincrement_a = vdupq_n_ ##suffix (increment_a); \
+                const vector_type vgain_b = vdupq_n_ ##suffix (gain_b); \
+                const vector_type vincrement_b = vdupq_n_ ##suffix (increment_b); \
+                const vector_type vstep = vdupq_n_ ##suffix ((datatype)vector_size); \
+                vector_type vindex = vld1q_ ##suffix (lanes); \
+                \
+                uint32 vector_count = size / vector_size; \
+                const uint32 index = vector_count * vector_size; \
+                for (uint32 i = 0; i < index; i += vector_size) \
+                { \
+                    vst1q_ ##suffix ((element_type*)dst_buffer + i, vaddq_ ##suffix ( \
+                        vmulq_ ##suffix (vld1q_ ##suffix ((const element_type*)src_buffer_a + i), \
+                            vaddq_ ##suffix (vgain_a, vmulq_ ##suffix (vincrement_a, vindex))), \
+                        vmulq_ ##suffix (vld1q_ ##suffix ((const element_type*)src_buffer_b + i), \
+                            vaddq_ ##suffix (vgain_b, vmulq_ ##suffix (vincrement_b, vindex))))); \
+                    vindex = vaddq_ ##suffix (vindex, vstep); \
+                } \
+                \
+                /* Handle any leftovers */ \
+                ramp_mix_gain_generic(src_buffer_a + index, src_buffer_b + index, \
+                    dst_buffer + index, size - index, \
+                    gain_a, increment_a, gain_b, increment_b, index); \
+            } \
+        }
+
+    #define math_neon_sum_buffer_impl(datatype, accumtype, scalar_type, element_type, suffix, vector_type, vector_zero) \
+        accumtype sum_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size) const \
+        { \
+            if (size < NEON_MIN_SAMPLES) \
+            { \
+                return math_fpu::sum_buffer_ ##datatype (src_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= NEON_MIN_SIZE); \
+                \
+                /* Sum with simd */ \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                vector_type vsum = vector_zero; \
+                vector_type vcompensation = vector_zero; \
+                \
+                uint32 vector_count = size / vector_size; \
+                while (vector_count--) \
+                { \
+                    sum_vector(vsum, vcompensation, \
+                        vld1q_ ##suffix ((const element_type*)src_buffer)); \
+                    \
+                    src_buffer += vector_size; \
+                } \
+                \
+                /* Handle any leftovers */ \
+                const scalar_type result = reduce_vector(vsum, vcompensation) + \
+                    static_cast<scalar_type>(math_fpu::sum_buffer_ ##datatype ( \
+                        src_buffer, size & (vector_size - 1))); \
+                \
+                return static_cast<accumtype>(result); \
+            } \
+        }
+
+    #define math_neon_dot_product_impl(datatype, accumtype, scalar_type, element_type, suffix, vector_type, vector_zero) \
+        accumtype dot_product_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            uint32 size) const \
+        { \
+            if (size < NEON_MIN_SAMPLES) \
+            { \
+                return math_fpu::dot_product_ ##datatype (src_buffer_a, src_buffer_b, size); \
+            } \
+            else \
+            { \
+                assert(size >= NEON_MIN_SIZE); \
+                \
+                /* Multiply and sum with simd */ \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                vector_type vsum = vector_zero; \
+                vector_type vcompensation = vector_zero; \
+                \
+                uint32 vector_count = size / vector_size; \
+                while (vector_count--) \
+                { \
+                    dot_vector(vsum, vcompensation, \
+                        vld1q_ ##suffix ((const element_type*)src_buffer_a), \
+                        vld1q_ ##suffix ((const element_type*)src_buffer_b)); \
+                    \
+                    src_buffer_a += vector_size; \
+                    src_buffer_b += vector_size; \
+                } \
+                \
+                /* Handle any leftovers */ \
+                const scalar_type result = reduce_vector(vsum, vcompensation) + \
+                    static_cast<scalar_type>(math_fpu::dot_product_ ##datatype ( \
+                        src_buffer_a, src_buffer_b, size & (vector_size - 1))); \
+                \
+                return static_cast<accumtype>(result); \
+            } \
+        }
+
+    #define math_neon_extreme_buffer_impl(function, datatype, element_type, suffix, vector_type, op, vector_op) \
+        datatype function ##_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            uint32* index) const \
+        { \
+            if (size < NEON_MIN_SAMPLES) \
+            { \
+                return math_fpu::function ##_ ##datatype (src_buffer, size, index); \
+            } \
+            else \
+            { \
+                assert(size >= NEON_MIN_SIZE); \
+                \
+                datatype* const buffer = src_buffer; \
+                const uint32 buffer_size = size; \
+                datatype result = *src_buffer; \
+                \
+                /* Compare with simd */ \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                vector_type vresult = vdupq_n_ ##suffix ((element_type)result); \
+                \
+                uint32 vector_count = size / vector_size; \
+                while (vector_count--) \
+                { \
+                    vresult = vector_op ##_ ##suffix ( \
+                        vld1q_ ##suffix ((const element_type*)src_buffer), vresult); \
+                    \
+                    src_buffer += vector_size; \
+                } \
+                \
+                datatype lanes[16 / sizeof(datatype)]; \
+                vst1q_ ##suffix ((element_type*)lanes, vresult); \
+                for (uint32 i = 0; i < vector_size; ++i) \
+                { \
+                    if (lanes[i] op result) \
+                        result = lanes[i]; \
+                } \
+                \
+                /* Handle any leftovers */ \
+                size &= vector_size - 1; \
+                while (size--) \
+                { \
+                    if (*src_buffer op result) \
+                        result = *src_buffer; \
+                    ++src_buffer; \
+                } \
+                \
+                if (index != nullptr) \
+                    *index = index_of_value(buffer, buffer_size, result); \
+                \
+                return result; \
+            } \
+        }
+
+    #define math_neon_peak_abs_buffer_impl(datatype, element_type, suffix, vector_type) \
+        double peak_abs_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size) const \
+        { \
+            if (size < NEON_MIN_SAMPLES) \
+            { \
+                return math_fpu::peak_abs_buffer_ ##datatype (src_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= NEON_MIN_SIZE); \
+                \
+                /* Compare with simd */ \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                vector_type vresult = vdupq_n_ ##suffix (0); \
+                \
+                uint32 vector_count = size / vector_size; \
+                while (vector_count--) \
+                { \
+                    vresult = vmaxq_ ##suffix (vabsq_ ##suffix ( \
+                        vld1q_ ##suffix ((const element_type*)src_buffer)), vresult); \
+                    \
+                    src_buffer += vector_size; \
+                } \
+                \
+                double result = math_fpu::peak_abs_buffer_ ##datatype (src_buffer, \
+                    size & (vector_size - 1)); \
+                \
+                datatype lanes[16 / sizeof(datatype)]; \
+                vst1q_ ##suffix ((element_type*)lanes, vresult); \
+                for (uint32 i = 0; i < vector_size; ++i) \
+                { \
+                    if (lanes[i] > result) \
+                        result = lanes[i]; \
+                } \
+                \
+                return result; \
+            } \
+        }
+
+    // the integer peak is the larger magnitude of the extremes, which come
+    // from the min and max kernels of this class
+    #define math_neon_integer_peak_abs_buffer_impl(datatype, accumtype) \
+        accumtype peak_abs_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size) const \
+        { \
+            if (size < NEON_MIN_SAMPLES) \
+            { \
+                return math_fpu::peak_abs_buffer_ ##datatype (src_buffer, size); \
+            } \
+            else \
+            { \
+                const uint64 highest = magnitude_value(max_buffer_ ##datatype (src_buffer, size, nullptr)); \
+                const uint64 lowest = datatype(-1) < datatype(0) ? \
+                    magnitude_value(min_buffer_ ##datatype (src_buffer, size, nullptr)) : 0; \
+                \
+                return static_cast<accumtype>(lowest > highest ? lowest : highest); \
+            } \
+        }
+
+    //--------------------------------------------------------------------------
+
+    #define math_neon_common_functions_impl(datatype, element_type, vector_type, suffix) \
+        math_neon_set_buffer_impl(datatype, element_type, vector_type, suffix) \
+        math_neon_copy_buffer_impl(datatype, element_type, suffix) \
+        math_neon_binary_buffers_impl(add_buffers, datatype, element_type, suffix, \
+            vaddq_ ##suffix, /* no guard */) \
+        math_neon_binary_buffers_impl(subtract_buffers, datatype, element_type, suffix, \
+            vsubq_ ##suffix, /* no guard */)
+
+    #define math_neon_multiply_functions_impl(datatype, element_type, suffix) \
+        math_neon_binary_buffers_impl(multiply_buffers, datatype, element_type, suffix, \
+            vmulq_ ##suffix, const disable_neon_denormals disable_denormals;)
+
+    #define math_neon_saturating_functions_impl(datatype, element_type, suffix) \
+        math_neon_binary_buffers_impl(add_buffers_saturate, datatype, element_type, suffix, \
+            vqaddq_ ##suffix, /* no guard */) \
+        math_neon_binary_buffers_impl(subtract_buffers_saturate, datatype, element_type, suffix, \
+            vqsubq_ ##suffix, /* no guard */) \
+        math_neon_binary_buffers_impl(average_buffers, datatype, element_type, suffix, \
+            vrhaddq_ ##suffix, /* no guard */) \
+        math_neon_scale_saturate_buffer_impl(datatype, element_type, suffix)
+
+    #define math_neon_divide_functions_impl(datatype, element_type, suffix) \
+        math_neon_binary_buffers_impl(divide_buffers, datatype, element_type, suffix, \
+            divide_vector, const disable_neon_denormals disable_denormals;)
+
+
+    //--------------------------------------------------------------------------
+
+    #define math_neon_interleave_functions_impl(datatype, element_type, vector_name, suffix) \
+        void interleave_buffers_ ##datatype ( \
+            datatype** src_buffers, \
+            datatype* dst_buffer, \
+            uint32 channels, \
+            uint32 size) const \
+        { \
+            if (size < NEON_MIN_SAMPLES || (channels != 2 && channels != 4 && channels != 6 && channels != 8)) \
+            { \
+                math_fpu::interleave_buffers_ ##datatype ( \
+                    src_buffers, dst_buffer, channels, size); \
+            } \
+            else \
+            { \
+                assert(size >= NEON_MIN_SIZE); \
+                \
+                /* Store whole frames of the channel vectors with vst2q and vst4q, */ \
+                /* six and eight channels a pair of channels at a time */ \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                const uint32 frames = size - size % vector_size; \
+                \
+                if (channels == 2) \
+                { \
+                    vector_name ##x2_t vframes; \
+                    for (uint32 i = 0; i < frames; i += vector_size) \
+                    { \
+                        vframes.val[0] = vld1q_ ##suffix ((const element_type*)src_buffers[0] + i); \
+                        vframes.val[1] = vld1q_ ##suffix ((const element_type*)src_buffers[1] + i); \
+                        vst2q_ ##suffix ((element_type*)dst_buffer + i * 2, vframes); \
+                    } \
+                } \
+                else if (channels == 4) \
+                { \
+                    vector_name ##x4_t vframes; \
+                    for (uint32 i = 0; i < frames; i += vector_size) \
+                    { \
+                        vframes.val[0] = vld1q_ ##suffix ((const element_type*)src_buffers[0] + i); \
+                        vframes.val[1] = vld1q_ ##suffix ((const element_type*)src_buffers[1] + i); \
+                        vframes.val[2] = vld1q_ ##suffix ((const element_type*)src_buffers[2] + i); \
+                        vframes.val[3] = vld1q_ ##suffix ((const element_type*)src_buffers[3] + i); \
+                        vst4q_ ##suffix ((element_type*)dst_buffer + i * 4, vframes); \
+                    } \
+                } \
+                else \
+                { \
+                    for (uint32 c = 0; c < channels; c += 2) \
+                    { \
+                        for (uint32 i = 0; i < frames; i += vector_size) \
+                        { \
+                            interleave_channel_pair(dst_buffer + i * channels + c, channels, \
+                                vld1q_ ##suffix ((const element_type*)src_buffers[c] + i), \
+                                vld1q_ ##suffix ((const element_type*)src_buffers[c + 1] + i)); \
+                        } \
+                    } \
+                } \
+                \
+                /* Handle any leftovers */ \
+                interleave_generic(src_buffers, dst_buffer, channels, 0, channels, frames, size); \
+            } \
+        } \
+        \
+        void deinterleave_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype** dst_buffers, \
+            uint32 channels, \
+            uint32 size) const \
+        { \
+            if (size < NEON_MIN_SAMPLES || (channels != 2 && channels != 4 && channels != 6 && channels != 8)) \
+            { \
+                math_fpu::deinterleave_buffer_ ##datatype ( \
+                    src_buffer, dst_buffers, channels, size); \
+            } \
+            else \
+            { \
+                assert(size >= NEON_MIN_SIZE); \
+                \
+                /* Load whole frames into the channel vectors with vld2q and vld4q, */ \
+                /* six and eight channels a pair of channels at a time */ \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                const uint32 frames = size - size % vector_size; \
+                \
+                if (channels == 2) \
+                { \
+                    for (uint32 i = 0; i < frames; i += vector_size) \
+                    { \
+                        const vector_name ##x2_t vframes = \
+                            vld2q_ ##suffix ((const element_type*)src_buffer + i * 2); \
+                        vst1q_ ##suffix ((element_type*)dst_buffers[0] + i, vframes.val[0]); \
+                        vst1q_ ##suffix ((element_type*)dst_buffers[1] + i, vframes.val[1]); \
+                    } \
+                } \
+                else if (channels == 4) \
+                { \
+                    for (uint32 i = 0; i < frames; i += vector_size) \
+                    { \
+                        const vector_name ##x4_t vframes = \
+                            vld4q_ ##suffix ((const element_type*)src_buffer + i * 4); \
+                        vst1q_ ##suffix ((element_type*)dst_buffers[0] + i, vframes.val[0]); \
+                        vst1q_ ##suffix ((element_type*)dst_buffers[1] + i, vframes.val[1]); \
+                        vst1q_ ##suffix ((element_type*)dst_buffers[2] + i, vframes.val[2]); \
+                        vst1q_ ##suffix ((element_type*)dst_buffers[3] + i, vframes.val[3]); \
+                    } \
+                } \
+                else \
+                { \
+                    for (uint32 c = 0; c < channels; c += 2) \
+                    { \
+                        for (uint32 i = 0; i < frames; i += vector_size) \
+                        { \
+                            vector_name ##_t a, b; \
+                            deinterleave_channel_pair(src_buffer + i * channels + c, channels, a, b); \
+                            vst1q_ ##suffix ((element_type*)dst_buffers[c] + i, a); \
+                            vst1q_ ##suffix ((element_type*)dst_buffers[c + 1] + i, b); \
+                        } \
+                    } \
+                } \
+                \
+                /* Handle any leftovers */ \
+                deinterleave_generic(src_buffer, dst_buffers, channels, 0, channels, frames, size); \
+            } \
+        }
+
+
+    //--------------------------------------------------------------------------
+
+    // four float samples at a time, int24 and the double conversions are left
+    // to the fpu. The vcvt instructions carry their own rounding, armv7 only
+    // has truncation so the conversions to integers need armv8
+    #define math_neon_convert_from_integer_impl(integer, bits) \
+        void convert_buffer_ ##integer ##_to_float ( \
+            integer* src_buffer, \
+            float* dst_buffer, \
+            uint32 size) const \
+        { \
+            if (size < NEON_MIN_SAMPLES) \
+            { \
+                math_fpu::convert_buffer_ ##integer ##_to_float ( \
+                    src_buffer, dst_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= NEON_MIN_SIZE); \
+                \
+                const integer_format<float> format(bits); \
+                const float32x4_t vscale = vdupq_n_f32(format.scale); \
+                \
+                /* Widen the samples to 32 bit lanes, then convert and scale */ \
+                uint32 vector_count = size >> 2; \
+                while (vector_count--) \
+                { \
+                    vst1q_f32(dst_buffer, vmulq_f32(vcvtq_f32_s32(load_samples(src_buffer)), vscale)); \
+                    \
+                    src_buffer += 4; \
+                    dst_buffer += 4; \
+                } \
+                \
+                /* Handle any leftovers */ \
+                convert_from_integer_generic(src_buffer, dst_buffer, size & 3, format); \
+            } \
+        }
+
+    #define math_neon_convert_to_integer_impl(integer, bits) \
+        void convert_buffer_float_to_ ##integer ( \
+            float* src_buffer, \
+            integer* dst_buffer, \
+            uint32 size, \
+            FloatRoundingModeTypes rounding, \
+            uint32* dither_seed) const \
+        { \
+            if (size < NEON_MIN_SAMPLES) \
+            { \
+                math_fpu::convert_buffer_float_to_ ##integer ( \
+                    src_buffer, dst_buffer, size, rounding, dither_seed); \
+            } \
+            else \
+            { \
+                assert(size >= NEON_MIN_SIZE); \
+                \
+                const integer_format<float> format(bits); \
+                const float_rounding_mode round_mode(rounding); \
+                \
+                /* Scale, dither and saturate, then round and narrow the lanes */ \
+                const float32x4_t vrange = vdupq_n_f32(format.range); \
+                const float32x4_t vmin = vdupq_n_f32(format.min_value); \
+                const float32x4_t vmax = vdupq_n_f32(format.max_value); \
+                const int32x4_t vmax_sample = vdupq_n_s32(format.max_sample); \
+                const float32x4_t vdither = vdupq_n_f32(1.0f / 65536.0f); \
+                const uint32x4_t vstep = vdupq_n_u32(4); \
+                const uint32_t lanes[4] = { 0, 1, 2, 3 }; \
+                uint32x4_t vindex = vaddq_u32(vld1q_u32(lanes), \
+                    vdupq_n_u32(dither_seed != nullptr ? *dither_seed : 0)); \
+                \
+                uint32 vector_count = size >> 2; \
+                while (vector_count--) \
+                { \
+                    float32x4_t value = vmulq_f32(vld1q_f32(src_buffer), vrange); \
+                    if (dither_seed != nullptr) \
+                        value = vaddq_f32(value, vmulq_f32(vcvtq_f32_s32(tpdf_dither_vector(vindex)), vdither)); \
+                    \
+                    const uint32x4_t saturated = vcgeq_f32(value, vmax); \
+                    const int32x4_t samples = round_vector( \
+                        vminq_f32(vmaxq_f32(value, vmin), vmax), rounding); \
+                    \
+                    store_samples(dst_buffer, vbslq_s32(saturated, vmax_sample, samples)); \
+                    vindex = vaddq_u32(vindex, vstep); \
+                    \
+                    src_buffer += 4; \
+                    dst_buffer += 4; \
+                } \
+                \
+                /* Handle any leftovers */ \
+                convert_to_integer_generic(src_buffer, dst_buffer, size & 3, \
+                    format, dither_seed, size & ~3); \
+                \
+                advance_dither_seed(dither_seed, size); \
+            } \
+        }
+
+
+    //--------------------------------------------------------------------------
+
+    #define math_neon_biquad_bank_impl(datatype, element_type, vector_type, suffix) \
+        void process_biquad_bank_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 channels, \
+            uint32 frames, \
+            datatype* coefficients, \
+            datatype* state, \
+            uint32 sections) const \
+        { \
+            const uint32 vector_size = 16 / sizeof(datatype); \
+            \
+            if (channels < vector_size) \
+            { \
+                math_fpu::process_biquad_bank_ ##datatype (src_buffer, dst_buffer, channels, frames, \
+                    coefficients, state, sections); \
+            } \
+            else \
+            { \
+                const disable_neon_denormals disable_denormals; \
+                \
+                /* Every lane runs the cascade of one channel, the groups are \
+                   walked each frame so their recurrences overlap */ \
+                const uint32 vector_channels = channels - channels % vector_size; \
+                \
+                for (uint32 frame = 0; frame < frames; ++frame) \
+                { \
+                    const element_type* src = (const element_type*)src_buffer + frame * channels; \
+                    element_type* dst = (element_type*)dst_buffer + frame * channels; \
+                    \
+                    for (uint32 c = 0; c < vector_channels; c += vector_size) \
+                    { \
+                        const element_type* coefficient = (const element_type*)coefficients + c; \
+                        element_type* z = (element_type*)state + c; \
+                        vector_type value = vld1q_ ##suffix (src + c); \
+                        \
+                        for (uint32 section = 0; section < sections; ++section) \
+                        { \
+                            const vector_type output = vaddq_ ##suffix (vmulq_ ##suffix ( \
+                                vld1q_ ##suffix (coefficient), value), vld1q_ ##suffix (z)); \
+                            \
+                            vst1q_ ##suffix (z, vaddq_ ##suffix (vsubq_ ##suffix ( \
+                                vmulq_ ##suffix (vld1q_ ##suffix (coefficient + channels), value), \
+                                vmulq_ ##suffix (vld1q_ ##suffix (coefficient + 3 * channels), output)), \
+                                vld1q_ ##suffix (z + channels))); \
+                            vst1q_ ##suffix (z + channels, vsubq_ ##suffix ( \
+                                vmulq_ ##suffix (vld1q_ ##suffix (coefficient + 2 * channels), value), \
+                                vmulq_ ##suffix (vld1q_ ##suffix (coefficient + 4 * channels), output))); \
+                            value = output; \
+                            \
+                            coefficient += 5 * channels; \
+                            z += 2 * channels; \
+                        } \
+                        \
+                        vst1q_ ##suffix (dst + c, value); \
+                    } \
+                } \
+                \
+                /* Handle the leftover channels */ \
+                biquad_bank_generic(src_buffer, dst_buffer, channels, frames, \
+                    coefficients, state, sections, vector_channels); \
+            } \
+        }
+
+
+    //==========================================================================
+
+    //--------------------------------------------------------------------------
+
+    math_neon_common_functions_impl(int8, int8_t, int8x16_t, s8)
+    math_neon_common_functions_impl(uint8, uint8_t, uint8x16_t, u8)
+    math_neon_common_functions_impl(int16, int16_t, int16x8_t, s16)
+    math_neon_common_functions_impl(uint16, uint16_t, uint16x8_t, u16)
+    math_neon_common_functions_impl(int32, int32_t, int32x4_t, s32)
+    math_neon_common_functions_impl(uint32, uint32_t, uint32x4_t, u32)
+    math_neon_common_functions_impl(int64, int64_t, int64x2_t, s64)
+    math_neon_common_functions_impl(uint64, uint64_t, uint64x2_t, u64)
+    math_neon_common_functions_impl(float, float32_t, float32x4_t, f32)
+
+    // there is no 64bit integer lanes multiply in neon, keep the fpu ones
+    math_neon_multiply_functions_impl(int8, int8_t, s8)
+    math_neon_multiply_functions_impl(uint8, uint8_t, u8)
+    math_neon_multiply_functions_impl(int16, int16_t, s16)
+    math_neon_multiply_functions_impl(uint16, uint16_t, u16)
+    math_neon_multiply_functions_impl(int32, int32_t, s32)
+    math_neon_multiply_functions_impl(uint32, uint32_t, u32)
+    math_neon_multiply_functions_impl(float, float32_t, f32)
+
+    // absolute value of unsigned buffers is left to the fpu no-op
+    math_neon_unary_buffer_impl(abs_buffer, int8, int8_t, s8, vabsq_s8)
+    math_neon_unary_buffer_impl(abs_buffer, int16, int16_t, s16, vabsq_s16)
+    math_neon_unary_buffer_impl(abs_buffer, int32, int32_t, s32, vabsq_s32)
+    math_neon_unary_buffer_impl(abs_buffer, float, float32_t, f32, vabsq_f32)
+
+    math_neon_scale_buffer_impl(int8, float, int8_t, s8, float32x4_t, vdupq_n_f32(gain))
+    math_neon_scale_buffer_impl(uint8, float, uint8_t, u8, float32x4_t, vdupq_n_f32(gain))
+    math_neon_scale_buffer_impl(int16, float, int16_t, s16, float32x4_t, vdupq_n_f32(gain))
+    math_neon_scale_buffer_impl(uint16, float, uint16_t, u16, float32x4_t, vdupq_n_f32(gain))
+    math_neon_scale_buffer_impl(int32, float, int32_t, s32, float32x4_t, vdupq_n_f32(gain))
+    math_neon_scale_buffer_impl(uint32, float, uint32_t, u32, float32x4_t, vdupq_n_f32(gain))
+    math_neon_scale_buffer_impl(float, float, float32_t, f32, float32x4_t, vdupq_n_f32(gain))
+    math_neon_scale_buffer_impl(float, double, float32_t, f32, float32x4_t, vdupq_n_f32((float)gain))
+
+    // vrhadd rounds halves up like pavgb, for the signed lanes too
+    math_neon_saturating_functions_impl(int8, int8_t, s8)
+    math_neon_saturating_functions_impl(uint8, uint8_t, u8)
+    math_neon_saturating_functions_impl(int16, int16_t, s16)
+    math_neon_saturating_functions_impl(uint16, uint16_t, u16)
+
+    math_neon_multiply_add_buffers_impl(float, float32_t, f32)
+    math_neon_scale_add_buffer_impl(float, float32_t, float32x4_t, f32)
+
+    math_neon_ramp_scale_buffer_impl(float, float32_t, float32x4_t, f32)
+    math_neon_exp_ramp_scale_buffer_impl(float, float32_t, float32x4_t, f32)
+
+    // 64bit integers have no widening multiply, their dot products and their
+    // min and max are left to the fpu
+    math_neon_sum_buffer_impl(int8, int64, uint64, int8_t, s8, int64x2_t, vdupq_n_s64(0))
+    math_neon_sum_buffer_impl(uint8, uint64, uint64, uint8_t, u8, uint64x2_t, vdupq_n_u64(0))
+    math_neon_sum_buffer_impl(int16, int64, uint64, int16_t, s16, int64x2_t, vdupq_n_s64(0))
+    math_neon_sum_buffer_impl(uint16, uint64, uint64, uint16_t, u16, uint64x2_t, vdupq_n_u64(0))
+    math_neon_sum_buffer_impl(int32, int64, uint64, int32_t, s32, int64x2_t, vdupq_n_s64(0))
+    math_neon_sum_buffer_impl(uint32, uint64, uint64, uint32_t, u32, uint64x2_t, vdupq_n_u64(0))
+    math_neon_sum_buffer_impl(int64, int64, uint64, int64_t, s64, int64x2_t, vdupq_n_s64(0))
+    math_neon_sum_buffer_impl(uint64, uint64, uint64, uint64_t, u64, uint64x2_t, vdupq_n_u64(0))
+    math_neon_sum_buffer_impl(float, double, double, float32_t, f32, float32x4_t, vdupq_n_f32(0))
+
+    math_neon_dot_product_impl(int8, int64, uint64, int8_t, s8, int64x2_t, vdupq_n_s64(0))
+    math_neon_dot_product_impl(uint8, uint64, uint64, uint8_t, u8, uint64x2_t, vdupq_n_u64(0))
+    math_neon_dot_product_impl(int16, int64, uint64, int16_t, s16, int64x2_t, vdupq_n_s64(0))
+    math_neon_dot_product_impl(uint16, uint64, uint64, uint16_t, u16, uint64x2_t, vdupq_n_u64(0))
+    math_neon_dot_product_impl(int32, int64, uint64, int32_t, s32, int64x2_t, vdupq_n_s64(0))
+    math_neon_dot_product_impl(uint32, uint64, uint64, uint32_t, u32, uint64x2_t, vdupq_n_u64(0))
+    math_neon_dot_product_impl(float, double, double, float32_t, f32, float32x4_t, vdupq_n_f32(0))
+
+    math_neon_extreme_buffer_impl(min_buffer, int8, int8_t, s8, int8x16_t, <, vminq)
+    math_neon_extreme_buffer_impl(max_buffer, int8, int8_t, s8, int8x16_t, >, vmaxq)
+    math_neon_extreme_buffer_impl(min_buffer, uint8, uint8_t, u8, uint8x16_t, <, vminq)
+    math_neon_extreme_buffer_impl(max_buffer, uint8, uint8_t, u8, uint8x16_t, >, vmaxq)
+    math_neon_extreme_buffer_impl(min_buffer, int16, int16_t, s16, int16x8_t, <, vminq)
+    math_neon_extreme_buffer_impl(max_buffer, int16, int16_t, s16, int16x8_t, >, vmaxq)
+    math_neon_extreme_buffer_impl(min_buffer, uint16, uint16_t, u16, uint16x8_t, <, vminq)
+    math_neon_extreme_buffer_impl(max_buffer, uint16, uint16_t, u16, uint16x8_t, >, vmaxq)
+    math_neon_extreme_buffer_impl(min_buffer, int32, int32_t, s32, int32x4_t, <, vminq)
+    math_neon_extreme_buffer_impl(max_buffer, int32, int32_t, s32, int32x4_t, >, vmaxq)
+    math_neon_extreme_buffer_impl(min_buffer, uint32, uint32_t, u32, uint32x4_t, <, vminq)
+    math_neon_extreme_buffer_impl(max_buffer, uint32, uint32_t, u32, uint32x4_t, >, vmaxq)
+    math_neon_extreme_buffer_impl(min_buffer, float, float32_t, f32, float32x4_t, <, vminq)
+    math_neon_extreme_buffer_impl(max_buffer, float, float32_t, f32, float32x4_t, >, vmaxq)
+
+    math_neon_integer_peak_abs_buffer_impl(int8, int64)
+    math_neon_integer_peak_abs_buffer_impl(uint8, uint64)
+    math_neon_integer_peak_abs_buffer_impl(int16, int64)
+    math_neon_integer_peak_abs_buffer_impl(uint16, uint64)
+    math_neon_integer_peak_abs_buffer_impl(int32, int64)
+    math_neon_integer_peak_abs_buffer_impl(uint32, uint64)
+    math_neon_peak_abs_buffer_impl(float, float32_t, f32, float32x4_t)
+
+    math_neon_interleave_functions_impl(float, float32_t, float32x4, f32)
+
+    math_neon_convert_from_integer_impl(int16, 16)
+    math_neon_convert_from_integer_impl(int32, 32)
+
+    math_neon_biquad_bank_impl(float, float32_t, float32x4_t, f32)
+
+
+    //--------------------------------------------------------------------------
+
+    #define math_neon_polyphase_impl(datatype, vector_type, suffix) \
+        void process_polyphase_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype* coefficients, \
+            uint32 taps, \
+            uint32* rows, \
+            uint32* offsets) const \
+        { \
+            const uint32 vector_size = 16 / sizeof(datatype); \
+            \
+            if (taps < vector_size) \
+            { \
+                math_fpu::process_polyphase_ ##datatype (src_buffer, dst_buffer, size, \
+                    coefficients, taps, rows, offsets); \
+            } \
+            else \
+            { \
+                const disable_neon_denormals disable_denormals; \
+                \
+                const uint32 vector_taps = taps - taps % vector_size; \
+                \
+                for (uint32 i = 0; i < size; ++i) \
+                { \
+                    const datatype* src = src_buffer + offsets[i]; \
+                    const datatype* coefficient = coefficients + rows[i] * taps; \
+                    vector_type sum = vdupq_n_ ##suffix (0); \
+                    \
+                    for (uint32 k = 0; k < vector_taps; k += vector_size) \
+                    { \
+                        sum = vaddq_ ##suffix (sum, vmulq_ ##suffix (vld1q_ ##suffix (coefficient + k), vld1q_ ##suffix (src + k))); \
+                    } \
+                    \
+                    datatype sums[16 / sizeof(datatype)]; \
+                    vst1q_ ##suffix (sums, sum); \
+                    \
+                    datatype total = datatype(0); \
+                    for (uint32 lane = 0; lane < vector_size; ++lane) \
+                        total += sums[lane]; \
+                    \
+                    /* Handle the leftover taps */ \
+                    dst_buffer[i] = polyphase_row_generic(src, coefficient, vector_taps, taps, total); \
+                } \
+            } \
+        }
+
+    math_neon_polyphase_impl(float, float32x4_t, f32)
+
+
+    //--------------------------------------------------------------------------
+
+    // square roots and divisions come with armv8, so do the dynamics
+
+    #define math_neon_envelope_bank_impl(datatype, vector_type, suffix) \
+        void process_envelope_bank_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 channels, \
+            uint32 frames, \
+            datatype* coefficients, \
+            datatype* state, \
+            EnvelopeModeTypes mode) const \
+        { \
+            const uint32 vector_size = 16 / sizeof(datatype); \
+            \
+            if (channels < vector_size) \
+            { \
+                math_fpu::process_envelope_bank_ ##datatype (src_buffer, dst_buffer, channels, frames, \
+                    coefficients, state, mode); \
+            } \
+            else \
+            { \
+                const disable_neon_denormals disable_denormals; \
+                \
+                /* Every lane follows the envelope of one channel, all the groups of \
+                   channels are walked each frame as the biquad banks do */ \
+                const uint32 vector_channels = channels - channels % vector_size; \
+                \
+                for (uint32 frame = 0; frame < frames; ++frame) \
+                { \
+                    const datatype* src = src_buffer + frame * channels; \
+                    datatype* dst = dst_buffer + frame * channels; \
+                    \
+                    for (uint32 c = 0; c < vector_channels; c += vector_size) \
+                    { \
+                        const vector_type value = vld1q_ ##suffix (src + c); \
+                        const vector_type level = mode == RMS_ENVELOPE ? vmulq_ ##suffix (value, value) : vabsq_ ##suffix (value); \
+                        vector_type envelope = vld1q_ ##suffix (state + c); \
+                        \
+                        const vector_type coefficient = select_greater_vector(level, envelope, \
+                            vld1q_ ##suffix (coefficients + c), vld1q_ ##suffix (coefficients + channels + c)); \
+                        \
+                        envelope = vaddq_ ##suffix (envelope, vmulq_ ##suffix (coefficient, vsubq_ ##suffix (level, envelope))); \
+                        \
+                        vst1q_ ##suffix (state + c, envelope); \
+                        vst1q_ ##suffix (dst + c, mode == RMS_ENVELOPE ? vsqrtq_ ##suffix (envelope) : envelope); \
+                    } \
+                } \
+                \
+                /* Handle the leftover channels */ \
+                envelope_bank_generic(src_buffer, dst_buffer, channels, frames, \
+                    coefficients, state, mode, vector_channels); \
+            } \
+        }
+
+    #define math_neon_gain_functions_impl(datatype, vector_type, suffix) \
+        void compressor_gain_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype threshold, \
+            datatype ratio, \
+            datatype knee) const \
+        { \
+            const uint32 vector_size = 16 / sizeof(datatype); \
+            \
+            assert(ratio > datatype(0)); \
+            \
+            const disable_neon_denormals disable_denormals; \
+            \
+            const datatype width = knee > datatype(0) ? knee : datatype(0); \
+            const vector_type vthreshold = vdupq_n_ ##suffix (threshold); \
+            const vector_type vslope = vdupq_n_ ##suffix (datatype(1) / ratio - datatype(1)); \
+            const vector_type vhalf_knee = vdupq_n_ ##suffix (width * datatype(0.5)); \
+            const vector_type vwidth = vdupq_n_ ##suffix (width); \
+            const vector_type vknee_scale = vdupq_n_ ##suffix (knee > datatype(0) ? datatype(1) / (datatype(2) * knee) : datatype(0)); \
+            const vector_type vzero = vdupq_n_ ##suffix (datatype(0)); \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            for (uint32 i = 0; i < vector_samples; i += vector_size) \
+            { \
+                const vector_type over = vsubq_ ##suffix (vld1q_ ##suffix (src_buffer + i), vthreshold); \
+                const vector_type above = vmaxq_ ##suffix (vsubq_ ##suffix (over, vhalf_knee), vzero); \
+                const vector_type bent = vminq_ ##suffix (vmaxq_ ##suffix (vaddq_ ##suffix (over, vhalf_knee), vzero), vwidth); \
+                \
+                vst1q_ ##suffix (dst_buffer + i, vmulq_ ##suffix (vslope, \
+                    vaddq_ ##suffix (vmulq_ ##suffix (vmulq_ ##suffix (bent, bent), vknee_scale), above))); \
+            } \
+            \
+            /* Handle the leftovers */ \
+            compressor_gain_generic(src_buffer, dst_buffer, size, threshold, ratio, knee, vector_samples); \
+        } \
+        \
+        void limiter_gain_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype threshold) const \
+        { \
+            const uint32 vector_size = 16 / sizeof(datatype); \
+            \
+            assert(threshold > datatype(0)); \
+            \
+            const disable_neon_denormals disable_denormals; \
+            \
+            const vector_type vthreshold = vdupq_n_ ##suffix (threshold); \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            for (uint32 i = 0; i < vector_samples; i += vector_size) \
+            { \
+                vst1q_ ##suffix (dst_buffer + i, vdivq_ ##suffix (vthreshold, vmaxq_ ##suffix (vld1q_ ##suffix (src_buffer + i), vthreshold))); \
+            } \
+            \
+            /* Handle the leftovers */ \
+            limiter_gain_generic(src_buffer, dst_buffer, size, threshold, vector_samples); \
+        } \
+        \
+        void soft_clip_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            const uint32 vector_size = 16 / sizeof(datatype); \
+            \
+            const disable_neon_denormals disable_denormals; \
+            \
+            const vector_type vlimit = vdupq_n_ ##suffix (datatype(3)); \
+            const vector_type vnegative_limit = vdupq_n_ ##suffix (datatype(-3)); \
+            const vector_type vnumerator = vdupq_n_ ##suffix (datatype(27)); \
+            const vector_type vdenominator = vdupq_n_ ##suffix (datatype(9)); \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            for (uint32 i = 0; i < vector_samples; i += vector_size) \
+            { \
+                const vector_type value = vminq_ ##suffix (vmaxq_ ##suffix (vld1q_ ##suffix (src_buffer + i), vnegative_limit), vlimit); \
+                const vector_type square = vmulq_ ##suffix (value, value); \
+                \
+                vst1q_ ##suffix (dst_buffer + i, vdivq_ ##suffix (vmulq_ ##suffix (value, vaddq_ ##suffix (vnumerator, square)), \
+                    vaddq_ ##suffix (vnumerator, vmulq_ ##suffix (vdenominator, square)))); \
+            } \
+            \
+            /* Handle the leftovers */ \
+            soft_clip_generic(src_buffer, dst_buffer, size, vector_samples); \
+        }
+
+    // the kernels round with vrndnq and divide, both new in armv8, so they
+    // are only built there
+    #define math_neon_transcendental_functions_impl(datatype, vector_type, suffix) \
+        void exp_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 16 / sizeof(datatype); \
+            \
+            const disable_neon_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vst1q_ ##suffix (dst_buffer + i, exp_vector(vld1q_ ##suffix (src_buffer + i), true)); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vst1q_ ##suffix (dst_buffer + i, exp_vector(vld1q_ ##suffix (src_buffer + i), false)); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            exp_generic(src_buffer, dst_buffer, size, accuracy, vector_samples); \
+        } \
+        \
+        void log_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 16 / sizeof(datatype); \
+            \
+            const disable_neon_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vst1q_ ##suffix (dst_buffer + i, log_vector(vld1q_ ##suffix (src_buffer + i), true)); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vst1q_ ##suffix (dst_buffer + i, log_vector(vld1q_ ##suffix (src_buffer + i), false)); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            log_generic(src_buffer, dst_buffer, size, accuracy, vector_samples); \
+        } \
+        \
+        void sin_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 16 / sizeof(datatype); \
+            \
+            const disable_neon_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_type sin_value, cos_value; \
+                    sincos_vector(vld1q_ ##suffix (src_buffer + i), sin_value, cos_value, true); \
+                    vst1q_ ##suffix (dst_buffer + i, sin_value); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_type sin_value, cos_value; \
+                    sincos_vector(vld1q_ ##suffix (src_buffer + i), sin_value, cos_value, false); \
+                    vst1q_ ##suffix (dst_buffer + i, sin_value); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            sincos_generic(src_buffer, dst_buffer, (datatype*)0, size, accuracy, vector_samples); \
+        } \
+        \
+        void cos_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 16 / sizeof(datatype); \
+            \
+            const disable_neon_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_type sin_value, cos_value; \
+                    sincos_vector(vld1q_ ##suffix (src_buffer + i), sin_value, cos_value, true); \
+                    vst1q_ ##suffix (dst_buffer + i, cos_value); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_type sin_value, cos_value; \
+                    sincos_vector(vld1q_ ##suffix (src_buffer + i), sin_value, cos_value, false); \
+                    vst1q_ ##suffix (dst_buffer + i, cos_value); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            sincos_generic(src_buffer, (datatype*)0, dst_buffer, size, accuracy, vector_samples); \
+        } \
+        \
+        void sincos_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* sin_buffer, \
+            datatype* cos_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 16 / sizeof(datatype); \
+            \
+            const disable_neon_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_type sin_value, cos_value; \
+                    sincos_vector(vld1q_ ##suffix (src_buffer + i), sin_value, cos_value, true); \
+                    vst1q_ ##suffix (sin_buffer + i, sin_value); \
+                    vst1q_ ##suffix (cos_buffer + i, cos_value); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_type sin_value, cos_value; \
+                    sincos_vector(vld1q_ ##suffix (src_buffer + i), sin_value, cos_value, false); \
+                    vst1q_ ##suffix (sin_buffer + i, sin_value); \
+                    vst1q_ ##suffix (cos_buffer + i, cos_value); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            sincos_generic(src_buffer, sin_buffer, cos_buffer, size, accuracy, vector_samples); \
+        } \
+        \
+        void tanh_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 16 / sizeof(datatype); \
+            \
+            const disable_neon_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vst1q_ ##suffix (dst_buffer + i, tanh_vector(vld1q_ ##suffix (src_buffer + i), true)); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vst1q_ ##suffix (dst_buffer + i, tanh_vector(vld1q_ ##suffix (src_buffer + i), false)); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            tanh_generic(src_buffer, dst_buffer, size, accuracy, vector_samples); \
+        } \
+        \
+        void pow_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* exponent_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 16 / sizeof(datatype); \
+            \
+            const disable_neon_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vst1q_ ##suffix (dst_buffer + i, pow_vector(vld1q_ ##suffix (src_buffer + i), \
+                        vld1q_ ##suffix (exponent_buffer + i), true)); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vst1q_ ##suffix (dst_buffer + i, pow_vector(vld1q_ ##suffix (src_buffer + i), \
+                        vld1q_ ##suffix (exponent_buffer + i), false)); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            pow_generic(src_buffer, exponent_buffer, dst_buffer, size, accuracy, vector_samples); \
+        }
+
+#if defined(WATERSPOUT_ARCH_ARM64)
+    // armv8 adds double precision lanes and true division
+    math_neon_common_functions_impl(double, float64_t, float64x2_t, f64)
+    math_neon_multiply_functions_impl(double, float64_t, f64)
+
+    math_neon_unary_buffer_impl(abs_buffer, int64, int64_t, s64, vabsq_s64)
+    math_neon_unary_buffer_impl(abs_buffer, double, float64_t, f64, vabsq_f64)
+
+    math_neon_divide_functions_impl(int8, int8_t, s8)
+    math_neon_divide_functions_impl(uint8, uint8_t, u8)
+    math_neon_divide_functions_impl(int16, int16_t, s16)
+    math_neon_divide_functions_impl(uint16, uint16_t, u16)
+    math_neon_divide_functions_impl(int32, int32_t, s32)
+    math_neon_divide_functions_impl(uint32, uint32_t, u32)
+    math_neon_divide_functions_impl(float, float32_t, f32)
+    math_neon_divide_functions_impl(double, float64_t, f64)
+
+    math_neon_scale_buffer_impl(int8, double, int8_t, s8, float64x2_t, vdupq_n_f64(gain))
+    math_neon_scale_buffer_impl(uint8, double, uint8_t, u8, float64x2_t, vdupq_n_f64(gain))
+    math_neon_scale_buffer_impl(int16, double, int16_t, s16, float64x2_t, vdupq_n_f64(gain))
+    math_neon_scale_buffer_impl(uint16, double, uint16_t, u16, float64x2_t, vdupq_n_f64(gain))
+    math_neon_scale_buffer_impl(int32, double, int32_t, s32, float64x2_t, vdupq_n_f64(gain))
+    math_neon_scale_buffer_impl(uint32, double, uint32_t, u32, float64x2_t, vdupq_n_f64(gain))
+    math_neon_scale_buffer_impl(double, float, float64_t, f64, float64x2_t, vdupq_n_f64((double)gain))
+    math_neon_scale_buffer_impl(double, double, float64_t, f64, float64x2_t, vdupq_n_f64(gain))
+
+    math_neon_multiply_add_buffers_impl(double, float64_t, f64)
+    math_neon_scale_add_buffer_impl(double, float64_t, float64x2_t, f64)
+
+    math_neon_ramp_scale_buffer_impl(double, float64_t, float64x2_t, f64)
+    math_neon_exp_ramp_scale_buffer_impl(double, float64_t, float64x2_t, f64)
+
+    math_neon_sum_buffer_impl(double, double, double, float64_t, f64, float64x2_t, vdupq_n_f64(0))
+    math_neon_dot_product_impl(double, double, double, float64_t, f64, float64x2_t, vdupq_n_f64(0))
+    math_neon_extreme_buffer_impl(min_buffer, double, float64_t, f64, float64x2_t, <, vminq)
+    math_neon_extreme_buffer_impl(max_buffer, double, float64_t, f64, float64x2_t, >, vmaxq)
+    math_neon_peak_abs_buffer_impl(double, float64_t, f64, float64x2_t)
+
+    math_neon_interleave_functions_impl(double, float64_t, float64x2, f64)
+
+    math_neon_convert_to_integer_impl(int16, 16)
+    math_neon_convert_to_integer_impl(int32, 32)
+
+    math_neon_biquad_bank_impl(double, float64_t, float64x2_t, f64)
+    math_neon_polyphase_impl(double, float64x2_t, f64)
+
+    math_neon_envelope_bank_impl(float, float32x4_t, f32)
+    math_neon_envelope_bank_impl(double, float64x2_t, f64)
+
+    math_neon_gain_functions_impl(float, float32x4_t, f32)
+    math_neon_gain_functions_impl(double, float64x2_t, f64)
+
+    math_neon_transcendental_functions_impl(float, float32x4_t, f32)
+    math_neon_transcendental_functions_impl(double, float64x2_t, f64)
+#endif
+
+
+    //--------------------------------------------------------------------------
+
+    // pixels are loaded sixteen (or four floats) at a time and split into
+    // their channels, so every channel is composited with the alpha of its
+    // pixel lane by lane
+
+    // the pixels of the source and backdrop into the composited expression,
+    // channel by channel
+    #define math_neon_composite_loop(pixels_type, channel_type, step, vector_load, vector_store, expression) \
+        for (uint32 i = 0; i < vector_pixels; i += step) \
+        { \
+            const pixels_type source_pixels = vector_load(src_buffer + i * 4); \
+            const pixels_type backdrop_pixels = vector_load(backdrop_buffer + i * 4); \
+            const channel_type sa = source_pixels.val[3]; \
+            const channel_type da = backdrop_pixels.val[3]; \
+            \
+            pixels_type result; \
+            for (uint32 c = 0; c < 4; ++c) \
+            { \
+                const channel_type s = source_pixels.val[c]; \
+                const channel_type d = backdrop_pixels.val[c]; \
+                \
+                result.val[c] = expression; \
+            } \
+            \
+            vector_store(dst_buffer + i * 4, result); \
+        }
+
+    void premultiply_rgba_uint8(
+        uint8* src_buffer,
+        uint8* dst_buffer,
+        uint32 pixels) const
+    {
+        const uint32 vector_pixels = pixels & ~15;
+        for (uint32 i = 0; i < vector_pixels; i += 16)
+        {
+            uint8x16x4_t pixel = vld4q_u8(src_buffer + i * 4);
+
+            pixel.val[0] = multiply_255_vector(pixel.val[0], pixel.val[3]);
+            pixel.val[1] = multiply_255_vector(pixel.val[1], pixel.val[3]);
+            pixel.val[2] = multiply_255_vector(pixel.val[2], pixel.val[3]);
+
+            vst4q_u8(dst_buffer + i * 4, pixel);
+        }
+
+        // Handle the leftovers
+        premultiply_rgba_generic(src_buffer, dst_buffer, pixels, vector_pixels);
+    }
+
+    void composite_rgba_uint8(
+        uint8* src_buffer,
+        uint8* backdrop_buffer,
+        uint8* dst_buffer,
+        uint32 pixels,
+        CompositeModeTypes mode) const
+    {
+        const uint32 vector_pixels = pixels & ~15;
+        switch (mode)
+        {
+        case MULTIPLY_COMPOSITE:
+            math_neon_composite_loop(uint8x16x4_t, uint8x16_t, 16, vld4q_u8, vst4q_u8, multiply_pixel_vector(s, d, sa, da))
+            break;
+
+        case SCREEN_COMPOSITE:
+            // Screen and add don't need the alpha, the channels stay interleaved
+            for (uint32 i = 0; i < vector_pixels * 4; i += 16)
+            {
+                vst1q_u8(dst_buffer + i, screen_pixel_vector(vld1q_u8(src_buffer + i), vld1q_u8(backdrop_buffer + i)));
+            }
+            break;
+
+        case OVERLAY_COMPOSITE:
+            math_neon_composite_loop(uint8x16x4_t, uint8x16_t, 16, vld4q_u8, vst4q_u8, overlay_pixel_vector(s, d, sa, da))
+            break;
+
+        case ADD_COMPOSITE:
+            for (uint32 i = 0; i < vector_pixels * 4; i += 16)
+            {
+                vst1q_u8(dst_buffer + i, vqaddq_u8(vld1q_u8(src_buffer + i), vld1q_u8(backdrop_buffer + i)));
+            }
+            break;
+
+        default:
+        {
+            const uint32 source = porter_duff_factor(mode, true);
+            const uint32 backdrop = porter_duff_factor(mode, false);
+            const uint8x16_t source_mask = vdupq_n_u8(pixel_factor_mask(source));
+            const uint8x16_t source_invert = vdupq_n_u8(pixel_factor_invert(source));
+            const uint8x16_t backdrop_mask = vdupq_n_u8(pixel_factor_mask(backdrop));
+            const uint8x16_t backdrop_invert = vdupq_n_u8(pixel_factor_invert(backdrop));
+
+            math_neon_composite_loop(uint8x16x4_t, uint8x16_t, 16, vld4q_u8, vst4q_u8, vqaddq_u8(
+                multiply_255_vector(s, veorq_u8(vandq_u8(da, source_mask), source_invert)),
+                multiply_255_vector(d, veorq_u8(vandq_u8(sa, backdrop_mask), backdrop_invert))))
+            break;
+        }
+        }
+
+        // Handle the leftovers
+        composite_rgba_generic(src_buffer, backdrop_buffer, dst_buffer, pixels, mode, vector_pixels);
+    }
+
+    void premultiply_rgba_float(
+        float* src_buffer,
+        float* dst_buffer,
+        uint32 pixels) const
+    {
+        const disable_neon_denormals disable_denormals;
+
+        const uint32 vector_pixels = pixels & ~3;
+        for (uint32 i = 0; i < vector_pixels; i += 4)
+        {
+            float32x4x4_t pixel = vld4q_f32(src_buffer + i * 4);
+
+            pixel.val[0] = vmulq_f32(pixel.val[0], pixel.val[3]);
+            pixel.val[1] = vmulq_f32(pixel.val[1], pixel.val[3]);
+            pixel.val[2] = vmulq_f32(pixel.val[2], pixel.val[3]);
+
+            vst4q_f32(dst_buffer + i * 4, pixel);
+        }
+
+        // Handle the leftovers
+        premultiply_rgba_generic(src_buffer, dst_buffer, pixels, vector_pixels);
+    }
+
+    void composite_rgba_float(
+        float* src_buffer,
+        float* backdrop_buffer,
+        float* dst_buffer,
+        uint32 pixels,
+        CompositeModeTypes mode) const
+    {
+        const disable_neon_denormals disable_denormals;
+
+        const float32x4_t vone = vdupq_n_f32(1.0f);
+
+        const uint32 vector_pixels = pixels & ~3;
+        switch (mode)
+        {
+        case MULTIPLY_COMPOSITE:
+            math_neon_composite_loop(float32x4x4_t, float32x4_t, 4, vld4q_f32, vst4q_f32, multiply_pixel_vector(s, d, sa, da))
+            break;
+
+        case SCREEN_COMPOSITE:
+            // Screen and add don't need the alpha, the channels stay interleaved
+            for (uint32 i = 0; i < vector_pixels * 4; i += 4)
+            {
+                vst1q_f32(dst_buffer + i, screen_pixel_vector(vld1q_f32(src_buffer + i), vld1q_f32(backdrop_buffer + i)));
+            }
+            break;
+
+        case OVERLAY_COMPOSITE:
+            math_neon_composite_loop(float32x4x4_t, float32x4_t, 4, vld4q_f32, vst4q_f32, overlay_pixel_vector(s, d, sa, da))
+            break;
+
+        case ADD_COMPOSITE:
+            for (uint32 i = 0; i < vector_pixels * 4; i += 4)
+            {
+                vst1q_f32(dst_buffer + i, vminq_f32(vaddq_f32(vld1q_f32(src_buffer + i), vld1q_f32(backdrop_buffer + i)), vone));
+            }
+            break;
+
+        default:
+        {
+            const uint32 source = porter_duff_factor(mode, true);
+            const uint32 backdrop = porter_duff_factor(mode, false);
+            const float32x4_t source_offset = vdupq_n_f32(pixel_factor_offset(source));
+            const float32x4_t source_scale = vdupq_n_f32(pixel_factor_scale(source));
+            const float32x4_t backdrop_offset = vdupq_n_f32(pixel_factor_offset(backdrop));
+            const float32x4_t backdrop_scale = vdupq_n_f32(pixel_factor_scale(backdrop));
+
+            math_neon_composite_loop(float32x4x4_t, float32x4_t, 4, vld4q_f32, vst4q_f32, vaddq_f32(
+                vmulq_f32(s, vaddq_f32(source_offset, vmulq_f32(source_scale, da))),
+                vmulq_f32(d, vaddq_f32(backdrop_offset, vmulq_f32(backdrop_scale, sa)))))
+            break;
+        }
+        }
+
+        // Handle the leftovers
+        composite_rgba_generic(src_buffer, backdrop_buffer, dst_buffer, pixels, mode, vector_pixels);
+    }
+
+#if defined(WATERSPOUT_ARCH_ARM64)
+    // unpremultiplying divides, 8 bit channels as floats like the other
+    // backends do
+    void unpremultiply_rgba_uint8(
+        uint8* src_buffer,
+        uint8* dst_buffer,
+        uint32 pixels) const
+    {
+        const disable_neon_denormals disable_denormals;
+
+        const uint32 vector_pixels = pixels & ~15;
+        for (uint32 i = 0; i < vector_pixels; i += 16)
+        {
+            uint8x16x4_t pixel = vld4q_u8(src_buffer + i * 4);
+
+            pixel.val[0] = unpremultiply_vector(pixel.val[0], pixel.val[3]);
+            pixel.val[1] = unpremultiply_vector(pixel.val[1], pixel.val[3]);
+            pixel.val[2] = unpremultiply_vector(pixel.val[2], pixel.val[3]);
+
+            vst4q_u8(dst_buffer + i * 4, pixel);
+        }
+
+        // Handle the leftovers
+        unpremultiply_rgba_generic(src_buffer, dst_buffer, pixels, vector_pixels);
+    }
+
+    void unpremultiply_rgba_float(
+        float* src_buffer,
+        float* dst_buffer,
+        uint32 pixels) const
+    {
+        const disable_neon_denormals disable_denormals;
+
+        const uint32 vector_pixels = pixels & ~3;
+        for (uint32 i = 0; i < vector_pixels; i += 4)
+        {
+            float32x4x4_t pixel = vld4q_f32(src_buffer + i * 4);
+
+            pixel.val[0] = unpremultiply_vector(pixel.val[0], pixel.val[3]);
+            pixel.val[1] = unpremultiply_vector(pixel.val[1], pixel.val[3]);
+            pixel.val[2] = unpremultiply_vector(pixel.val[2], pixel.val[3]);
+
+            vst4q_f32(dst_buffer + i * 4, pixel);
+        }
+
+        // Handle the leftovers
+        unpremultiply_rgba_generic(src_buffer, dst_buffer, pixels, vector_pixels);
+    }
+#endif
+
+
+    //--------------------------------------------------------------------------
+
+    void pack_rgba_planes_uint8(
+        uint8* red_buffer,
+        uint8* green_buffer,
+        uint8* blue_buffer,
+        uint8* alpha_buffer,
+        uint8* dst_buffer,
+        uint32 pixels) const
+    {
+        const uint32 vector_pixels = pixels & ~15;
+        for (uint32 i = 0; i < vector_pixels; i += 16)
+        {
+            uint8x16x4_t pixel;
+            pixel.val[0] = vld1q_u8(red_buffer + i);
+            pixel.val[1] = vld1q_u8(green_buffer + i);
+            pixel.val[2] = vld1q_u8(blue_buffer + i);
+            pixel.val[3] = alpha_buffer ? vld1q_u8(alpha_buffer + i) : vdupq_n_u8(255);
+
+            vst4q_u8(dst_buffer + i * 4, pixel);
+        }
+
+        // Handle the leftovers
+        pack_rgba_planes_generic(red_buffer, green_buffer, blue_buffer, alpha_buffer, dst_buffer, pixels, vector_pixels);
+    }
+
+    void unpack_rgba_planes_uint8(
+        uint8* src_buffer,
+        uint8* red_buffer,
+        uint8* green_buffer,
+        uint8* blue_buffer,
+        uint8* alpha_buffer,
+        uint32 pixels) const
+    {
+        const uint32 vector_pixels = pixels & ~15;
+        for (uint32 i = 0; i < vector_pixels; i += 16)
+        {
+            const uint8x16x4_t pixel = vld4q_u8(src_buffer + i * 4);
+
+            vst1q_u8(red_buffer + i, pixel.val[0]);
+            vst1q_u8(green_buffer + i, pixel.val[1]);
+            vst1q_u8(blue_buffer + i, pixel.val[2]);
+            if (alpha_buffer)
+                vst1q_u8(alpha_buffer + i, pixel.val[3]);
+        }
+
+        // Handle the leftovers
+        unpack_rgba_planes_generic(src_buffer, red_buffer, green_buffer, blue_buffer, alpha_buffer, pixels, vector_pixels);
+    }
+
+
+protected:
+
+    //--------------------------------------------------------------------------
+
+    math_neon_mixing_kernels_impl(float, float32_t, float32x4_t, f32)
+
+#if defined(WATERSPOUT_ARCH_ARM64)
+    math_neon_mixing_kernels_impl(double, float64_t, float64x2_t, f64)
+#endif
+
+
+    //--------------------------------------------------------------------------
+
+    #define math_neon_fft_radix4_pass_impl(datatype, vector_type, suffix) \
+        void fft_radix4_pass_ ##datatype ( \
+            datatype* real_buffer, \
+            datatype* imag_buffer, \
+            uint32 size, \
+            uint32 span, \
+            const datatype* twiddles) const \
+        { \
+            const uint32 vector_size = 16 / sizeof(datatype); \
+            \
+            if (span < vector_size) \
+            { \
+                math_fpu::fft_radix4_pass_ ##datatype (real_buffer, imag_buffer, size, span, twiddles); \
+            } \
+            else \
+            { \
+                const disable_neon_denormals disable_denormals; \
+                \
+                for (uint32 group = 0; group < size; group += 4 * span) \
+                { \
+                    datatype* real = real_buffer + group; \
+                    datatype* imag = imag_buffer + group; \
+                    \
+                    for (uint32 k = 0; k < span; k += vector_size) \
+                    { \
+                        const vector_type w1_real = vld1q_ ##suffix (twiddles + k); \
+                        const vector_type w1_imag = vld1q_ ##suffix (twiddles + span + k); \
+                        const vector_type w2_real = vld1q_ ##suffix (twiddles + 2 * span + k); \
+                        const vector_type w2_imag = vld1q_ ##suffix (twiddles + 3 * span + k); \
+                        const vector_type w3_real = vld1q_ ##suffix (twiddles + 4 * span + k); \
+                        const vector_type w3_imag = vld1q_ ##suffix (twiddles + 5 * span + k); \
+                        \
+                        const vector_type a_real = vld1q_ ##suffix (real + k); \
+                        const vector_type a_imag = vld1q_ ##suffix (imag + k); \
+                        const vector_type x1_real = vld1q_ ##suffix (real + span + k); \
+                        const vector_type x1_imag = vld1q_ ##suffix (imag + span + k); \
+                        const vector_type x2_real = vld1q_ ##suffix (real + 2 * span + k); \
+                        const vector_type x2_imag = vld1q_ ##suffix (imag + 2 * span + k); \
+                        const vector_type x3_real = vld1q_ ##suffix (real + 3 * span + k); \
+                        const vector_type x3_imag = vld1q_ ##suffix (imag + 3 * span + k); \
+                        \
+                        const vector_type b_real = vsubq_ ##suffix (vmulq_ ##suffix (x1_real, w2_real), vmulq_ ##suffix (x1_imag, w2_imag)); \
+                        const vector_type b_imag = vaddq_ ##suffix (vmulq_ ##suffix (x1_real, w2_imag), vmulq_ ##suffix (x1_imag, w2_real)); \
+                        const vector_type c_real = vsubq_ ##suffix (vmulq_ ##suffix (x2_real, w1_real), vmulq_ ##suffix (x2_imag, w1_imag)); \
+                        const vector_type c_imag = vaddq_ ##suffix (vmulq_ ##suffix (x2_real, w1_imag), vmulq_ ##suffix (x2_imag, w1_real)); \
+                        const vector_type d_real = vsubq_ ##suffix (vmulq_ ##suffix (x3_real, w3_real), vmulq_ ##suffix (x3_imag, w3_imag)); \
+                        const vector_type d_imag = vaddq_ ##suffix (vmulq_ ##suffix (x3_real, w3_imag), vmulq_ ##suffix (x3_imag, w3_real)); \
+                        \
+                        const vector_type t0_real = vaddq_ ##suffix (a_real, b_real); \
+                        const vector_type t0_imag = vaddq_ ##suffix (a_imag, b_imag); \
+                        const vector_type t1_real = vsubq_ ##suffix (a_real, b_real); \
+                        const vector_type t1_imag = vsubq_ ##suffix (a_imag, b_imag); \
+                        const vector_type t2_real = vaddq_ ##suffix (c_real, d_real); \
+                        const vector_type t2_imag = vaddq_ ##suffix (c_imag, d_imag); \
+                        const vector_type t3_real = vsubq_ ##suffix (c_real, d_real); \
+                        const vector_type t3_imag = vsubq_ ##suffix (c_imag, d_imag); \
+                        \
+                        vst1q_ ##suffix (real + k, vaddq_ ##suffix (t0_real, t2_real)); \
+                        vst1q_ ##suffix (imag + k, vaddq_ ##suffix (t0_imag, t2_imag)); \
+                        vst1q_ ##suffix (real + span + k, vaddq_ ##suffix (t1_real, t3_imag)); \
+                        vst1q_ ##suffix (imag + span + k, vsubq_ ##suffix (t1_imag, t3_real)); \
+                        vst1q_ ##suffix (real + 2 * span + k, vsubq_ ##suffix (t0_real, t2_real)); \
+                        vst1q_ ##suffix (imag + 2 * span + k, vsubq_ ##suffix (t0_imag, t2_imag)); \
+                        vst1q_ ##suffix (real + 3 * span + k, vsubq_ ##suffix (t1_real, t3_imag)); \
+                        vst1q_ ##suffix (imag + 3 * span + k, vaddq_ ##suffix (t1_imag, t3_real)); \
+                    } \
+                } \
+            } \
+        }
+
+    math_neon_fft_radix4_pass_impl(float, float32x4_t, f32)
+
+#if defined(WATERSPOUT_ARCH_ARM64)
+    math_neon_fft_radix4_pass_impl(double, float64x2_t, f64)
+#endif
+
+
+    //--------------------------------------------------------------------------
+
+    // the structured loads split the channels of 16 pixels, the multiply
+    // accumulates of 16 bit lanes give the same 32 bit sums of the fpu
+
+    void rgba_to_luma_row_uint8(
+        uint8* src_buffer,
+        uint8* dst_buffer,
+        uint32 pixels,
+        const color_matrix& matrix) const
+    {
+        const int32x4_t rounding = vdupq_n_s32(matrix.luma_rounding);
+
+        const uint32 vector_pixels = pixels & ~15;
+        for (uint32 i = 0; i < vector_pixels; i += 16)
+        {
+            const uint8x16x4_t pixel = vld4q_u8(src_buffer + i * 4);
+
+            int32x4_t luma[4];
+            weight_channels_vector(widen_channel_vector(vget_low_u8(pixel.val[0])),
+                widen_channel_vector(vget_low_u8(pixel.val[1])), widen_channel_vector(vget_low_u8(pixel.val[2])),
+                matrix.y_red, matrix.y_green, matrix.y_blue, rounding, luma[0], luma[1]);
+            weight_channels_vector(widen_channel_vector(vget_high_u8(pixel.val[0])),
+                widen_channel_vector(vget_high_u8(pixel.val[1])), widen_channel_vector(vget_high_u8(pixel.val[2])),
+                matrix.y_red, matrix.y_green, matrix.y_blue, rounding, luma[2], luma[3]);
+
+            vst1q_u8(dst_buffer + i, vcombine_u8(
+                narrow_channel_vector(vshrq_n_s32(luma[0], 15), vshrq_n_s32(luma[1], 15)),
+                narrow_channel_vector(vshrq_n_s32(luma[2], 15), vshrq_n_s32(luma[3], 15))));
+        }
+
+        // Handle the leftovers
+        rgba_to_luma_generic(src_buffer, dst_buffer, pixels, matrix, vector_pixels);
+    }
+
+    void rgba_to_chroma_row_uint8(
+        uint8* src_buffer,
+        uint8* next_buffer,
+        uint8* u_buffer,
+        uint8* v_buffer,
+        uint32 step,
+        uint32 pixels,
+        const color_matrix& matrix) const
+    {
+        const int32x4_t rounding = vdupq_n_s32(matrix.chroma_rounding);
+
+        const uint32 vector_samples = (pixels / 2) & ~7;
+        for (uint32 i = 0; i < vector_samples; i += 8)
+        {
+            const uint8x16x4_t pixel = vld4q_u8(src_buffer + i * 8);
+            const uint8x16x4_t next_pixel = vld4q_u8(next_buffer + i * 8);
+
+            // Sums of the 2x2 blocks, adding pairs of lanes of both rows
+            int16x8_t sums[3];
+            for (uint32 c = 0; c < 3; ++c)
+                sums[c] = vreinterpretq_s16_u16(vpadalq_u8(vpaddlq_u8(pixel.val[c]), next_pixel.val[c]));
+
+            int32x4_t u_lo, u_hi, v_lo, v_hi;
+            weight_channels_vector(sums[0], sums[1], sums[2],
+                matrix.u_red, matrix.u_green, matrix.u_blue, rounding, u_lo, u_hi);
+            weight_channels_vector(sums[0], sums[1], sums[2],
+                matrix.v_red, matrix.v_green, matrix.v_blue, rounding, v_lo, v_hi);
+
+            uint8x8x2_t chroma;
+            chroma.val[0] = narrow_channel_vector(vshrq_n_s32(u_lo, 17), vshrq_n_s32(u_hi, 17));
+            chroma.val[1] = narrow_channel_vector(vshrq_n_s32(v_lo, 17), vshrq_n_s32(v_hi, 17));
+
+            if (step == 1)
+            {
+                vst1_u8(u_buffer + i, chroma.val[0]);
+                vst1_u8(v_buffer + i, chroma.val[1]);
+            }
+            else
+            {
+                vst2_u8(u_buffer + i * 2, chroma);
+            }
+        }
+
+        // Handle the leftovers
+        rgba_to_chroma_generic(src_buffer, next_buffer, u_buffer, v_buffer, step, pixels, matrix, vector_samples);
+    }
+
+    void yuv_to_rgba_row_uint8(
+        uint8* y_buffer,
+        uint8* u_buffer,
+        uint8* v_buffer,
+        uint32 step,
+        uint8* dst_buffer,
+        uint32 pixels,
+        const color_matrix& matrix) const
+    {
+        const uint8x8_t luma_offset = vdup_n_u8((uint8)matrix.luma_offset);
+        const uint8x8_t chroma_offset = vdup_n_u8(128);
+
+        const uint32 vector_pixels = pixels & ~15;
+        for (uint32 i = 0; i < vector_pixels; i += 16)
+        {
+            uint8x8x2_t chroma;
+            if (step == 1)
+            {
+                chroma.val[0] = vld1_u8(u_buffer + i / 2);
+                chroma.val[1] = vld1_u8(v_buffer + i / 2);
+            }
+            else
+            {
+                chroma = vld2_u8(u_buffer + i);
+            }
+
+            // Each chroma sample repeated for two pixels
+            const int16x8_t u = vreinterpretq_s16_u16(vsubl_u8(chroma.val[0], chroma_offset));
+            const int16x8_t v = vreinterpretq_s16_u16(vsubl_u8(chroma.val[1], chroma_offset));
+            const int16x8x2_t u_pixels = vzipq_s16(u, u);
+            const int16x8x2_t v_pixels = vzipq_s16(v, v);
+
+            const uint8x16_t y = vld1q_u8(y_buffer + i);
+
+            uint8x8_t red_lo, green_lo, blue_lo, red_hi, green_hi, blue_hi;
+            yuv_to_rgb_vector(vreinterpretq_s16_u16(vsubl_u8(vget_low_u8(y), luma_offset)),
+                u_pixels.val[0], v_pixels.val[0], matrix, red_lo, green_lo, blue_lo);
+            yuv_to_rgb_vector(vreinterpretq_s16_u16(vsubl_u8(vget_high_u8(y), luma_offset)),
+                u_pixels.val[1], v_pixels.val[1], matrix, red_hi, green_hi, blue_hi);
+
+            uint8x16x4_t pixel;
+            pixel.val[0] = vcombine_u8(red_lo, red_hi);
+            pixel.val[1] = vcombine_u8(green_lo, green_hi);
+            pixel.val[2] = vcombine_u8(blue_lo, blue_hi);
+            pixel.val[3] = vdupq_n_u8(255);
+
+            vst4q_u8(dst_buffer + i * 4, pixel);
+        }
+
+        // Handle the leftovers
+        yuv_to_rgba_generic(y_buffer, u_buffer, v_buffer, step, dst_buffer, pixels, matrix, vector_pixels);
+    }
+
+    void luma_to_rgba_row_uint8(
+        uint8* src_buffer,
+        uint8* dst_buffer,
+        uint32 pixels,
+        const color_matrix& matrix) const
+    {
+        const uint8x8_t luma_offset = vdup_n_u8((uint8)matrix.luma_offset);
+        const int32x4_t rounding = vdupq_n_s32(1 << 12);
+
+        const uint32 vector_pixels = pixels & ~15;
+        for (uint32 i = 0; i < vector_pixels; i += 16)
+        {
+            const uint8x16_t y = vld1q_u8(src_buffer + i);
+            const int16x8_t y_lo = vreinterpretq_s16_u16(vsubl_u8(vget_low_u8(y), luma_offset));
+            const int16x8_t y_hi = vreinterpretq_s16_u16(vsubl_u8(vget_high_u8(y), luma_offset));
+
+            const uint8x16_t gray = vcombine_u8(
+                narrow_channel_vector(vshrq_n_s32(vmlal_n_s16(rounding, vget_low_s16(y_lo), matrix.luma), 13),
+                    vshrq_n_s32(vmlal_n_s16(rounding, vget_high_s16(y_lo), matrix.luma), 13)),
+                narrow_channel_vector(vshrq_n_s32(vmlal_n_s16(rounding, vget_low_s16(y_hi), matrix.luma), 13),
+                    vshrq_n_s32(vmlal_n_s16(rounding, vget_high_s16(y_hi), matrix.luma), 13)));
+
+            uint8x16x4_t pixel;
+            pixel.val[0] = pixel.val[1] = pixel.val[2] = gray;
+            pixel.val[3] = vdupq_n_u8(255);
+
+            vst4q_u8(dst_buffer + i * 4, pixel);
+        }
+
+        // Handle the leftovers
+        luma_to_rgba_generic(src_buffer, dst_buffer, pixels, matrix, vector_pixels);
+    }
+
+
+
+    //--------------------------------------------------------------------------
+
+    void convolve_row_float(
+        float* src_buffer,
+        float* dst_buffer,
+        uint32 width,
+        float* kernel,
+        uint32 kernel_size) const
+    {
+        // the pixels from center to end have their whole window in the row
+        const uint32 center = kernel_size / 2;
+        const uint32 end = width + center + 1 > kernel_size ? width + center + 1 - kernel_size : 0;
+
+        if (end < center + 4)
+        {
+            math_fpu::convolve_row_float(src_buffer, dst_buffer, width, kernel, kernel_size);
+            return;
+        }
+
+        const disable_neon_denormals disable_denormals;
+
+        convolve_row_generic(src_buffer, dst_buffer, width, kernel, kernel_size, 0, center);
+
+        uint32 i = center;
+        for (; i + 16 <= end; i += 16)
+        {
+            const float* window = src_buffer + i - center;
+            float32x4_t sum0 = vdupq_n_f32(0.0f);
+            float32x4_t sum1 = vdupq_n_f32(0.0f);
+            float32x4_t sum2 = vdupq_n_f32(0.0f);
+            float32x4_t sum3 = vdupq_n_f32(0.0f);
+
+            for (uint32 k = 0; k < kernel_size; ++k)
+            {
+                const float32x4_t coefficient = vdupq_n_f32(kernel[k]);
+
+                sum0 = vmlaq_f32(sum0, coefficient, vld1q_f32(window + k));
+                sum1 = vmlaq_f32(sum1, coefficient, vld1q_f32(window + k + 4));
+                sum2 = vmlaq_f32(sum2, coefficient, vld1q_f32(window + k + 8));
+                sum3 = vmlaq_f32(sum3, coefficient, vld1q_f32(window + k + 12));
+            }
+
+            vst1q_f32(dst_buffer + i, sum0);
+            vst1q_f32(dst_buffer + i + 4, sum1);
+            vst1q_f32(dst_buffer + i + 8, sum2);
+            vst1q_f32(dst_buffer + i + 12, sum3);
+        }
+
+        for (; i + 4 <= end; i += 4)
+        {
+            const float* window = src_buffer + i - center;
+            float32x4_t sum = vdupq_n_f32(0.0f);
+
+            for (uint32 k = 0; k < kernel_size; ++k)
+                sum = vmlaq_f32(sum, vdupq_n_f32(kernel[k]), vld1q_f32(window + k));
+
+            vst1q_f32(dst_buffer + i, sum);
+        }
+
+        // Handle the right edge and the leftover pixels
+        convolve_row_generic(src_buffer, dst_buffer, width, kernel, kernel_size, i, width);
+    }
+
+    //--------------------------------------------------------------------------
+
+    void convolve_column_tile_float(
+        float* src_buffer,
+        uint32 src_stride,
+        float* dst_buffer,
+        uint32 dst_stride,
+        uint32 columns,
+        uint32 height,
+        float* kernel,
+        uint32 kernel_size) const
+    {
+        const disable_neon_denormals disable_denormals;
+
+        const int32 center = int32(kernel_size / 2);
+        const uint32 vector_columns = columns & ~3;
+
+        for (uint32 row = 0; row < height; ++row)
+        {
+            float* dst_row = dst_buffer + row * dst_stride;
+
+            uint32 i = 0;
+            for (; i + 16 <= vector_columns; i += 16)
+            {
+                float32x4_t sum0 = vdupq_n_f32(0.0f);
+                float32x4_t sum1 = vdupq_n_f32(0.0f);
+                float32x4_t sum2 = vdupq_n_f32(0.0f);
+                float32x4_t sum3 = vdupq_n_f32(0.0f);
+
+                for (uint32 k = 0; k < kernel_size; ++k)
+                {
+                    const float* src_row = image_row(src_buffer, src_stride, int32(row + k) - center, height) + i;
+                    const float32x4_t coefficient = vdupq_n_f32(kernel[k]);
+
+                    sum0 = vmlaq_f32(sum0, coefficient, vld1q_f32(src_row));
+                    sum1 = vmlaq_f32(sum1, coefficient, vld1q_f32(src_row + 4));
+                    sum2 = vmlaq_f32(sum2, coefficient, vld1q_f32(src_row + 8));
+                    sum3 = vmlaq_f32(sum3, coefficient, vld1q_f32(src_row + 12));
+                }
+
+                vst1q_f32(dst_row + i, sum0);
+                vst1q_f32(dst_row + i + 4, sum1);
+                vst1q_f32(dst_row + i + 8, sum2);
+                vst1q_f32(dst_row + i + 12, sum3);
+            }
+
+            for (; i < vector_columns; i += 4)
+            {
+                float32x4_t sum = vdupq_n_f32(0.0f);
+
+                for (uint32 k = 0; k < kernel_size; ++k)
+                {
+                    const float* src_row = image_row(src_buffer, src_stride, int32(row + k) - center, height) + i;
+
+                    sum = vmlaq_f32(sum, vdupq_n_f32(kernel[k]), vld1q_f32(src_row));
+                }
+
+                vst1q_f32(dst_row + i, sum);
+            }
+        }
+
+        // Handle the leftover columns
+        convolve_column_tile_generic(src_buffer, src_stride, dst_buffer, dst_stride,
+            columns, height, kernel, kernel_size, vector_columns);
+    }
+
+    //--------------------------------------------------------------------------
+
+    void box_blur_row_float(
+        float* src_buffer,
+        float* dst_buffer,
+        uint32 width,
+        uint32 radius) const
+    {
+        // the running sum of the pixels from begin to end adds and removes
+        // pixels inside the row, a register of them is one prefix sum of the
+        // differences
+        const uint32 begin = radius + 1;
+        const uint32 end = width > radius ? width - radius : 0;
+
+        if (end < begin + 4)
+        {
+            math_fpu::box_blur_row_float(src_buffer, dst_buffer, width, radius);
+            return;
+        }
+
+        const disable_neon_denormals disable_denormals;
+
+        box_blur_row_generic(src_buffer, dst_buffer, width, radius, 0, begin);
+
+        const float32x4_t scale = vdupq_n_f32(1.0f / float(2 * radius + 1));
+        const float32x4_t zero = vdupq_n_f32(0.0f);
+        float32x4_t sum = vdupq_n_f32(box_window_sum(src_buffer, width, radius, radius));
+
+        uint32 i = begin;
+        for (; i + 4 <= end; i += 4)
+        {
+            float32x4_t delta = vsubq_f32(vld1q_f32(src_buffer + i + radius),
+                vld1q_f32(src_buffer + i - radius - 1));
+
+            delta = vaddq_f32(delta, vextq_f32(zero, delta, 3));
+            delta = vaddq_f32(delta, vextq_f32(zero, delta, 2));
+
+            sum = vaddq_f32(sum, delta);
+            vst1q_f32(dst_buffer + i, vmulq_f32(sum, scale));
+            sum = vdupq_n_f32(vgetq_lane_f32(sum, 3));
+        }
+
+        // Handle the right edge and the leftover pixels
+        box_blur_row_generic(src_buffer, dst_buffer, width, radius, i, width);
+    }
+
+    //--------------------------------------------------------------------------
+
+    void box_blur_column_tile_float(
+        float* src_buffer,
+        uint32 src_stride,
+        float* dst_buffer,
+        uint32 dst_stride,
+        uint32 columns,
+        uint32 height,
+        uint32 radius) const
+    {
+        assert(columns <= image_tile_columns);
+
+        const disable_neon_denormals disable_denormals;
+
+        const float32x4_t scale = vdupq_n_f32(1.0f / float(2 * radius + 1));
+        const uint32 vector_columns = columns & ~3;
+        float sums[image_tile_columns];
+
+        for (uint32 i = 0; i < vector_columns; i += 4)
+            vst1q_f32(sums + i, vdupq_n_f32(0.0f));
+
+        for (int32 k = -int32(radius); k <= int32(radius); ++k)
+        {
+            const float* src_row = image_row(src_buffer, src_stride, k, height);
+
+            for (uint32 i = 0; i < vector_columns; i += 4)
+                vst1q_f32(sums + i, vaddq_f32(vld1q_f32(sums + i), vld1q_f32(src_row + i)));
+        }
+
+        for (uint32 row = 0; row < height; ++row)
+        {
+            const float* add_row = image_row(src_buffer, src_stride, int32(row + radius + 1), height);
+            const float* sub_row = image_row(src_buffer, src_stride, int32(row) - int32(radius), height);
+            float* dst_row = dst_buffer + row * dst_stride;
+
+            for (uint32 i = 0; i < vector_columns; i += 4)
+            {
+                const float32x4_t sum = vld1q_f32(sums + i);
+
+                vst1q_f32(dst_row + i, vmulq_f32(sum, scale));
+                vst1q_f32(sums + i, vaddq_f32(sum, vsubq_f32(vld1q_f32(add_row + i), vld1q_f32(sub_row + i))));
+            }
+        }
+
+        // Handle the leftover columns
+        box_blur_column_tile_generic(src_buffer, src_stride, dst_buffer, dst_stride,
+            columns, height, radius, vector_columns);
+    }
+
+    //--------------------------------------------------------------------------
+
+    #define math_neon_resize_row_impl(datatype, load_f32) \
+        void resize_row_ ##datatype ( \
+            datatype* src_buffer, \
+            float* dst_buffer, \
+            uint32 width, \
+            uint32 channels, \
+            float* coefficients, \
+            uint32 taps, \
+            uint32* offsets) const \
+        { \
+            if (channels == 4) \
+            { \
+                const disable_neon_denormals disable_denormals; \
+                \
+                /* a register holds the four channels of a pixel */ \
+                for (uint32 i = 0; i < width; ++i) \
+                { \
+                    const datatype* window = src_buffer + offsets[i] * 4; \
+                    const float* coefficient = coefficients + i * taps; \
+                    float32x4_t sum = vdupq_n_f32(0.0f); \
+                    \
+                    for (uint32 k = 0; k < taps; ++k) \
+                        sum = vmlaq_f32(sum, vdupq_n_f32(coefficient[k]), load_f32(window + k * 4)); \
+                    \
+                    vst1q_f32(dst_buffer + i * 4, sum); \
+                } \
+            } \
+            else if (channels == 1 && taps >= 4) \
+            { \
+                const disable_neon_denormals disable_denormals; \
+                \
+                const uint32 vector_taps = taps & ~3; \
+                \
+                for (uint32 i = 0; i < width; ++i) \
+                { \
+                    const datatype* window = src_buffer + offsets[i]; \
+                    const float* coefficient = coefficients + i * taps; \
+                    float32x4_t sum = vdupq_n_f32(0.0f); \
+                    \
+                    for (uint32 k = 0; k < vector_taps; k += 4) \
+                        sum = vmlaq_f32(sum, vld1q_f32(coefficient + k), load_f32(window + k)); \
+                    \
+                    float sums[4]; \
+                    vst1q_f32(sums, sum); \
+                    \
+                    /* Handle the leftover taps */ \
+                    float total = (sums[0] + sums[1]) + (sums[2] + sums[3]); \
+                    for (uint32 k = vector_taps; k < taps; ++k) \
+                        total += coefficient[k] * float(window[k]); \
+                    \
+                    dst_buffer[i] = total; \
+                } \
+            } \
+            else \
+            { \
+                math_fpu::resize_row_ ##datatype (src_buffer, dst_buffer, width, channels, coefficients, taps, offsets); \
+            } \
+        }
+
+    math_neon_resize_row_impl(uint8, load_u8_f32)
+    math_neon_resize_row_impl(float, vld1q_f32)
+
+    //--------------------------------------------------------------------------
+
+    void resize_column_tile_float(
+        float* src_buffer,
+        uint32 src_stride,
+        float* dst_buffer,
+        uint32 dst_stride,
+        uint32 columns,
+        uint32 height,
+        float* coefficients,
+        uint32 taps,
+        uint32* offsets) const
+    {
+        const disable_neon_denormals disable_denormals;
+
+        const uint32 vector_columns = columns & ~3;
+
+        for (uint32 row = 0; row < height; ++row)
+        {
+            const float* window = src_buffer + offsets[row] * src_stride;
+            const float* coefficient = coefficients + row * taps;
+            float* dst_row = dst_buffer + row * dst_stride;
+
+            uint32 i = 0;
+            for (; i + 16 <= vector_columns; i += 16)
+            {
+                float32x4_t sum0 = vdupq_n_f32(0.0f);
+                float32x4_t sum1 = vdupq_n_f32(0.0f);
+                float32x4_t sum2 = vdupq_n_f32(0.0f);
+                float32x4_t sum3 = vdupq_n_f32(0.0f);
+
+                for (uint32 k = 0; k < taps; ++k)
+                {
+                    const float* src_row = window + k * src_stride + i;
+                    const float32x4_t weight = vdupq_n_f32(coefficient[k]);
+
+                    sum0 = vmlaq_f32(sum0, weight, vld1q_f32(src_row));
+                    sum1 = vmlaq_f32(sum1, weight, vld1q_f32(src_row + 4));
+                    sum2 = vmlaq_f32(sum2, weight, vld1q_f32(src_row + 8));
+                    sum3 = vmlaq_f32(sum3, weight, vld1q_f32(src_row + 12));
+                }
+
+                vst1q_f32(dst_row + i, sum0);
+                vst1q_f32(dst_row + i + 4, sum1);
+                vst1q_f32(dst_row + i + 8, sum2);
+                vst1q_f32(dst_row + i + 12, sum3);
+            }
+
+            for (; i < vector_columns; i += 4)
+            {
+                float32x4_t sum = vdupq_n_f32(0.0f);
+
+                for (uint32 k = 0; k < taps; ++k)
+                    sum = vmlaq_f32(sum, vdupq_n_f32(coefficient[k]), vld1q_f32(window + k * src_stride + i));
+
+                vst1q_f32(dst_row + i, sum);
+            }
+        }
+
+        // Handle the leftover columns
+        resize_column_tile_generic(src_buffer, src_stride, dst_buffer, dst_stride,
+            columns, height, coefficients, taps, offsets, vector_columns);
+    }
+
+    //--------------------------------------------------------------------------
+
+    void resize_column_tile_uint8(
+        float* src_buffer,
+        uint32 src_stride,
+        uint8* dst_buffer,
+        uint32 dst_stride,
+        uint32 columns,
+        uint32 height,
+        float* coefficients,
+        uint32 taps,
+        uint32* offsets) const
+    {
+        const disable_neon_denormals disable_denormals;
+
+        // 16 columns a step, rounded by adding a half before the truncating
+        // conversion, which saturates the negative sums to zero, and narrowed
+        // with unsigned saturation
+        const uint32 vector_columns = columns & ~15;
+        const float32x4_t half = vdupq_n_f32(0.5f);
+
+        for (uint32 row = 0; row < height; ++row)
+        {
+            const float* window = src_buffer + offsets[row] * src_stride;
+            const float* coefficient = coefficients + row * taps;
+            uint8* dst_row = dst_buffer + row * dst_stride;
+
+            for (uint32 i = 0; i < vector_columns; i += 16)
+            {
+                float32x4_t sum[4] = { half, half, half, half };
+
+                for (uint32 k = 0; k < taps; ++k)
+                {
+                    const float* src_row = window + k * src_stride + i;
+                    const float32x4_t weight = vdupq_n_f32(coefficient[k]);
+
+                    for (uint32 j = 0; j < 4; ++j)
+                        sum[j] = vmlaq_f32(sum[j], weight, vld1q_f32(src_row + j * 4));
+                }
+
+                const uint16x8_t lo = vcombine_u16(vqmovn_u32(vcvtq_u32_f32(sum[0])), vqmovn_u32(vcvtq_u32_f32(sum[1])));
+                const uint16x8_t hi = vcombine_u16(vqmovn_u32(vcvtq_u32_f32(sum[2])), vqmovn_u32(vcvtq_u32_f32(sum[3])));
+
+                vst1q_u8(dst_row + i, vcombine_u8(vqmovn_u16(lo), vqmovn_u16(hi)));
+            }
+        }
+
+        // Handle the leftover columns
+        resize_column_tile_generic(src_buffer, src_stride, dst_buffer, dst_stride,
+            columns, height, coefficients, taps, offsets, vector_columns);
+    }
+
+private:
+
+    //==========================================================================
+
+    //--------------------------------------------------------------------------
+
+    // armv8 has a fused multiply add, armv7 only guarantees the chained one
+
+    static forcedinline float32x4_t multiply_add_vector(float32x4_t a, float32x4_t b, float32x4_t c)
+    {
+    #if defined(WATERSPOUT_ARCH_ARM64)
+        return vfmaq_f32(c, a, b);
+    #else
+        return vmlaq_f32(c, a, b);
+    #endif
+    }
+
+#if defined(WATERSPOUT_ARCH_ARM64)
+    static forcedinline float64x2_t multiply_add_vector(float64x2_t a, float64x2_t b, float64x2_t c)
+    {
+        return vfmaq_f64(c, a, b);
+    }
+#endif
+
+
+    //--------------------------------------------------------------------------
+
+    // 4 bytes widened to floats
+
+    static forcedinline float32x4_t load_u8_f32(const uint8* src_buffer)
+    {
+        uint32 bytes;
+        std::memcpy(&bytes, src_buffer, sizeof(bytes));
+
+        return vcvtq_f32_u32(vmovl_u16(vget_low_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(bytes))))));
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // a vector of each of two adjacent channels is zipped into the frames at
+    // dst, dst + channels and so on, or split back out of them
+
+    static forcedinline void interleave_channel_pair(float* dst, uint32 channels, float32x4_t a, float32x4_t b)
+    {
+        const float32x4x2_t pairs = vzipq_f32(a, b);
+
+        vst1_f32(dst, vget_low_f32(pairs.val[0]));
+        vst1_f32(dst + channels, vget_high_f32(pairs.val[0]));
+        vst1_f32(dst + channels * 2, vget_low_f32(pairs.val[1]));
+        vst1_f32(dst + channels * 3, vget_high_f32(pairs.val[1]));
+    }
+
+    static forcedinline void deinterleave_channel_pair(const float* src, uint32 channels, float32x4_t& a, float32x4_t& b)
+    {
+        const float32x4x2_t pairs = vuzpq_f32(
+            vcombine_f32(vld1_f32(src), vld1_f32(src + channels)),
+            vcombine_f32(vld1_f32(src + channels * 2), vld1_f32(src + channels * 3)));
+
+        a = pairs.val[0];
+        b = pairs.val[1];
+    }
+
+#if defined(WATERSPOUT_ARCH_ARM64)
+    static forcedinline void interleave_channel_pair(double* dst, uint32 channels, float64x2_t a, float64x2_t b)
+    {
+        vst1q_f64(dst, vzip1q_f64(a, b));
+        vst1q_f64(dst + channels, vzip2q_f64(a, b));
+    }
+
+    static forcedinline void deinterleave_channel_pair(const double* src, uint32 channels, float64x2_t& a, float64x2_t& b)
+    {
+        const float64x2_t frame0 = vld1q_f64(src);
+        const float64x2_t frame1 = vld1q_f64(src + channels);
+
+        a = vzip1q_f64(frame0, frame1);
+        b = vzip2q_f64(frame0, frame1);
+    }
+#endif
+
+
+    //--------------------------------------------------------------------------
+
+    // integer lanes are scaled as 32bit floats (or doubles) and truncated
+    // like round::f2i / round::d2i do, narrowing drops the high bits exactly
+    // as the static_cast in the fpu implementation
+
+    static forcedinline float32x4_t scale_vector(float32x4_t v, float32x4_t s)
+    {
+        return vmulq_f32(v, s);
+    }
+
+    static forcedinline int32x4_t scale_vector(int32x4_t v, float32x4_t s)
+    {
+        return vcvtq_s32_f32(vmulq_f32(vcvtq_f32_s32(v), s));
+    }
+
+    static forcedinline uint32x4_t scale_vector(uint32x4_t v, float32x4_t s)
+    {
+        return vreinterpretq_u32_s32(vcvtq_s32_f32(vmulq_f32(vcvtq_f32_u32(v), s)));
+    }
+
+#if defined(WATERSPOUT_ARCH_ARM64)
+    static forcedinline float64x2_t scale_vector(float64x2_t v, float64x2_t s)
+    {
+        return vmulq_f64(v, s);
+    }
+
+    static forcedinline int32x4_t scale_vector(int32x4_t v, float64x2_t s)
+    {
+        const float64x2_t lo = vmulq_f64(vcvtq_f64_s64(vmovl_s32(vget_low_s32(v))), s);
+        const float64x2_t hi = vmulq_f64(vcvtq_f64_s64(vmovl_s32(vget_high_s32(v))), s);
+
+        // d2i saturates to the int range, so does the narrowing here
+        return vcombine_s32(
+            vqmovn_s64(vcvtq_s64_f64(lo)),
+            vqmovn_s64(vcvtq_s64_f64(hi)));
+    }
+
+    static forcedinline uint32x4_t scale_vector(uint32x4_t v, float64x2_t s)
+    {
+        const float64x2_t lo = vmulq_f64(vcvtq_f64_u64(vmovl_u32(vget_low_u32(v))), s);
+        const float64x2_t hi = vmulq_f64(vcvtq_f64_u64(vmovl_u32(vget_high_u32(v))), s);
+
+        return vreinterpretq_u32_s32(vcombine_s32(
+            vqmovn_s64(vcvtq_s64_f64(lo)),
+            vqmovn_s64(vcvtq_s64_f64(hi))));
+    }
+#endif
+
+    template<typename scale_type>
+    static forcedinline int16x8_t scale_vector(int16x8_t v, scale_type s)
+    {
+        const int32x4_t lo = scale_vector(vmovl_s16(vget_low_s16(v)), s);
+        const int32x4_t hi = scale_vector(vmovl_s16(vget_high_s16(v)), s);
+
+        return vcombine_s16(vmovn_s32(lo), vmovn_s32(hi));
+    }
+
+    template<typename scale_type>
+    static forcedinline uint16x8_t scale_vector(uint16x8_t v, scale_type s)
+    {
+        // 16bit unsigned values fit the signed 32bit lanes
+        const int32x4_t lo = scale_vector(
+            vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(v))), s);
+        const int32x4_t hi = scale_vector(
+            vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(v))), s);
+
+        return vreinterpretq_u16_s16(vcombine_s16(vmovn_s32(lo), vmovn_s32(hi)));
+    }
+
+    template<typename scale_type>
+    static forcedinline int8x16_t scale_vector(int8x16_t v, scale_type s)
+    {
+        const int16x8_t lo = scale_vector(vmovl_s8(vget_low_s8(v)), s);
+        const int16x8_t hi = scale_vector(vmovl_s8(vget_high_s8(v)), s);
+
+        return vcombine_s8(vmovn_s16(lo), vmovn_s16(hi));
+    }
+
+    template<typename scale_type>
+    static forcedinline uint8x16_t scale_vector(uint8x16_t v, scale_type s)
+    {
+        // 8bit unsigned values fit the signed 16bit lanes
+        const int16x8_t lo = scale_vector(
+            vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(v))), s);
+        const int16x8_t hi = scale_vector(
+            vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(v))), s);
+
+        return vreinterpretq_u8_s8(vcombine_s8(vmovn_s16(lo), vmovn_s16(hi)));
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // the float to integer conversion already saturates to the int range, the
+    // narrowing ones clamp to the datatype just like the fpu implementation
+
+    static forcedinline int16x8_t scale_saturate_vector(int16x8_t v, float32x4_t s)
+    {
+        const int32x4_t lo = scale_vector(vmovl_s16(vget_low_s16(v)), s);
+        const int32x4_t hi = scale_vector(vmovl_s16(vget_high_s16(v)), s);
+
+        return vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi));
+    }
+
+    static forcedinline uint16x8_t scale_saturate_vector(uint16x8_t v, float32x4_t s)
+    {
+        const int32x4_t lo = scale_vector(
+            vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(v))), s);
+        const int32x4_t hi = scale_vector(
+            vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(v))), s);
+
+        return vcombine_u16(vqmovun_s32(lo), vqmovun_s32(hi));
+    }
+
+    static forcedinline int8x16_t scale_saturate_vector(int8x16_t v, float32x4_t s)
+    {
+        const int16x8_t lo = scale_saturate_vector(vmovl_s8(vget_low_s8(v)), s);
+        const int16x8_t hi = scale_saturate_vector(vmovl_s8(vget_high_s8(v)), s);
+
+        return vcombine_s8(vqmovn_s16(lo), vqmovn_s16(hi));
+    }
+
+    static forcedinline uint8x16_t scale_saturate_vector(uint8x16_t v, float32x4_t s)
+    {
+        const uint16x8_t lo = scale_saturate_vector(vmovl_u8(vget_low_u8(v)), s);
+        const uint16x8_t hi = scale_saturate_vector(vmovl_u8(vget_high_u8(v)), s);
+
+        return vcombine_u8(vqmovn_u16(lo), vqmovn_u16(hi));
+    }
+
+
+    //--------------------------------------------------------------------------
+
+#if defined(WATERSPOUT_ARCH_ARM64)
+    // there is no integer division in neon: 8 and 16bit lanes are divided as
+    // floats, 32bit lanes as doubles, both represent the quotient exactly
+    // enough for the truncation to match the integer division
+
+    static forcedinline float32x4_t divide_vector(float32x4_t a, float32x4_t b)
+    {
+        return vdivq_f32(a, b);
+    }
+
+    static forcedinline float64x2_t divide_vector(float64x2_t a, float64x2_t b)
+    {
+        return vdivq_f64(a, b);
+    }
+
+    // a > b ? greater : otherwise, lane by lane
+    static forcedinline float32x4_t select_greater_vector(float32x4_t a, float32x4_t b, float32x4_t greater, float32x4_t otherwise)
+    {
+        return vbslq_f32(vcgtq_f32(a, b), greater, otherwise);
+    }
+
+    static forcedinline float64x2_t select_greater_vector(float64x2_t a, float64x2_t b, float64x2_t greater, float64x2_t otherwise)
+    {
+        return vbslq_f64(vcgtq_f64(a, b), greater, otherwise);
+    }
+
+    template<uint32 count> static forcedinline float32x4_t polynomial_vector(float32x4_t x, const float (&coefficients)[count])
+    {
+        float32x4_t result = vdupq_n_f32(coefficients[0]);
+        for (uint32 i = 1; i < count; ++i)
+        {
+            result = vaddq_f32(vmulq_f32(result, x), vdupq_n_f32(coefficients[i]));
+        }
+
+        return result;
+    }
+
+    template<uint32 count> static forcedinline float64x2_t polynomial_vector(float64x2_t x, const double (&coefficients)[count])
+    {
+        float64x2_t result = vdupq_n_f64(coefficients[0]);
+        for (uint32 i = 1; i < count; ++i)
+        {
+            result = vaddq_f64(vmulq_f64(result, x), vdupq_n_f64(coefficients[i]));
+        }
+
+        return result;
+    }
+
+    // 2^n for the integers n of a normal exponent
+    static forcedinline float32x4_t pow2_vector(float32x4_t n)
+    {
+        return vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(n), vdupq_n_s32(127)), 23));
+    }
+
+    static forcedinline float64x2_t pow2_vector(float64x2_t n)
+    {
+        return vreinterpretq_f64_s64(vshlq_n_s64(vaddq_s64(vcvtq_s64_f64(n), vdupq_n_s64(1023)), 52));
+    }
+
+    // e^r - 1 for |r| <= log(2) / 2
+    static forcedinline float32x4_t expm1_vector(float32x4_t r, bool accurate)
+    {
+        const float32x4_t p = accurate
+            ? polynomial_vector(r, accurate_exp_coefficients_float)
+            : polynomial_vector(r, fast_exp_coefficients_float);
+
+        return vaddq_f32(r, vmulq_f32(vmulq_f32(r, r), p));
+    }
+
+    static forcedinline float64x2_t expm1_vector(float64x2_t r, bool accurate)
+    {
+        const float64x2_t p = accurate
+            ? polynomial_vector(r, accurate_exp_coefficients_double)
+            : polynomial_vector(r, fast_exp_coefficients_double);
+
+        return vaddq_f64(r, vmulq_f64(vmulq_f64(r, r), p));
+    }
+
+    // the same reductions as exp_scalar, the top of the range needs 2^128 so
+    // the scaling is split in 2^min(n, 127) and the 1 or 2 left
+    static forcedinline float32x4_t exp_vector(float32x4_t x, bool accurate)
+    {
+        const float32x4_t high = vdupq_n_f32(88.72283172607421875f);
+        const float32x4_t low = vdupq_n_f32(-87.33654022216796875f);
+        const float32x4_t one = vdupq_n_f32(1.0f);
+
+        const float32x4_t clamped = vminq_f32(vmaxq_f32(x, low), high);
+        const float32x4_t n = vrndnq_f32(vmulq_f32(clamped, vdupq_n_f32(1.44269504088896341f)));
+        const float32x4_t r = vsubq_f32(vsubq_f32(clamped, vmulq_f32(n, vdupq_n_f32(0.693359375f))),
+            vmulq_f32(n, vdupq_n_f32(-2.12194440e-4f)));
+
+        const float32x4_t normal = vminq_f32(n, vdupq_n_f32(127.0f));
+        float32x4_t result = vmulq_f32(vmulq_f32(vaddq_f32(expm1_vector(r, accurate), one), pow2_vector(normal)),
+            vaddq_f32(one, vsubq_f32(n, normal)));
+
+        result = vbslq_f32(vcgtq_f32(x, high), vdupq_n_f32(std::numeric_limits<float>::infinity()), result);
+        result = vbslq_f32(vcltq_f32(x, low), vdupq_n_f32(0.0f), result);
+
+        return vbslq_f32(vceqq_f32(x, x), result, x);
+    }
+
+    static forcedinline float64x2_t exp_vector(float64x2_t x, bool accurate)
+    {
+        const float64x2_t high = vdupq_n_f64(709.782712893383);
+        const float64x2_t low = vdupq_n_f64(-708.396418532264);
+        const float64x2_t one = vdupq_n_f64(1.0);
+
+        const float64x2_t clamped = vminq_f64(vmaxq_f64(x, low), high);
+        const float64x2_t n = vrndnq_f64(vmulq_f64(clamped, vdupq_n_f64(1.4426950408889634074)));
+        const float64x2_t r = vsubq_f64(vsubq_f64(clamped, vmulq_f64(n, vdupq_n_f64(6.93147180369123816490e-1))),
+            vmulq_f64(n, vdupq_n_f64(1.90821492927058770002e-10)));
+
+        const float64x2_t normal = vminq_f64(n, vdupq_n_f64(1023.0));
+        float64x2_t result = vmulq_f64(vmulq_f64(vaddq_f64(expm1_vector(r, accurate), one), pow2_vector(normal)),
+            vaddq_f64(one, vsubq_f64(n, normal)));
+
+        result = vbslq_f64(vcgtq_f64(x, high), vdupq_n_f64(std::numeric_limits<double>::infinity()), result);
+        result = vbslq_f64(vcltq_f64(x, low), vdupq_n_f64(0.0), result);
+
+        return vbslq_f64(vceqq_f64(x, x), result, x);
+    }
+
+    // the exponent and mantissa come out of the bits, zero and denormals give
+    // minus infinity and anything not positive a NaN
+    static forcedinline float32x4_t log_vector(float32x4_t x, bool accurate)
+    {
+        const float32x4_t one = vdupq_n_f32(1.0f);
+        const uint32x4_t bits = vreinterpretq_u32_f32(x);
+
+        float32x4_t e = vsubq_f32(vcvtq_f32_u32(vshrq_n_u32(bits, 23)), vdupq_n_f32(127.0f));
+        float32x4_t m = vreinterpretq_f32_u32(vorrq_u32(vandq_u32(bits, vdupq_n_u32(0x007fffff)), vdupq_n_u32(0x3f800000)));
+
+        const uint32x4_t above = vcgtq_f32(m, vdupq_n_f32(1.41421356237309505f));
+        m = vbslq_f32(above, vmulq_f32(m, vdupq_n_f32(0.5f)), m);
+        e = vbslq_f32(above, vaddq_f32(e, one), e);
+
+        const float32x4_t s = vdivq_f32(vsubq_f32(m, one), vaddq_f32(m, one));
+        const float32x4_t w = vmulq_f32(s, s);
+        const float32x4_t q = accurate
+            ? polynomial_vector(w, accurate_log_coefficients_float)
+            : polynomial_vector(w, fast_log_coefficients_float);
+
+        const float32x4_t log_m = vaddq_f32(vaddq_f32(s, s), vmulq_f32(vmulq_f32(s, w), q));
+        float32x4_t result = vaddq_f32(vmulq_f32(e, vdupq_n_f32(0.693359375f)),
+            vaddq_f32(log_m, vmulq_f32(e, vdupq_n_f32(-2.12194440e-4f))));
+
+        result = vbslq_f32(vceqq_f32(x, vdupq_n_f32(std::numeric_limits<float>::infinity())), x, result);
+        result = vbslq_f32(vceqq_f32(x, vdupq_n_f32(0.0f)), vdupq_n_f32(-std::numeric_limits<float>::infinity()), result);
+
+        return vbslq_f32(vcgeq_f32(x, vdupq_n_f32(0.0f)), result, vdupq_n_f32(std::numeric_limits<float>::quiet_NaN()));
+    }
+
+    static forcedinline float64x2_t log_vector(float64x2_t x, bool accurate)
+    {
+        const float64x2_t one = vdupq_n_f64(1.0);
+        const uint64x2_t bits = vreinterpretq_u64_f64(x);
+
+        float64x2_t e = vsubq_f64(vcvtq_f64_u64(vshrq_n_u64(bits, 52)), vdupq_n_f64(1023.0));
+        float64x2_t m = vreinterpretq_f64_u64(vorrq_u64(vandq_u64(bits, vdupq_n_u64(0x000fffffffffffffULL)), vdupq_n_u64(0x3ff0000000000000ULL)));
+
+        const uint64x2_t above = vcgtq_f64(m, vdupq_n_f64(1.41421356237309504880));
+        m = vbslq_f64(above, vmulq_f64(m, vdupq_n_f64(0.5)), m);
+        e = vbslq_f64(above, vaddq_f64(e, one), e);
+
+        const float64x2_t s = vdivq_f64(vsubq_f64(m, one), vaddq_f64(m, one));
+        const float64x2_t w = vmulq_f64(s, s);
+        const float64x2_t q = accurate
+            ? polynomial_vector(w, accurate_log_coefficients_double)
+            : polynomial_vector(w, fast_log_coefficients_double);
+
+        const float64x2_t log_m = vaddq_f64(vaddq_f64(s, s), vmulq_f64(vmulq_f64(s, w), q));
+        float64x2_t result = vaddq_f64(vmulq_f64(e, vdupq_n_f64(6.93147180369123816490e-1)),
+            vaddq_f64(log_m, vmulq_f64(e, vdupq_n_f64(1.90821492927058770002e-10))));
+
+        result = vbslq_f64(vceqq_f64(x, vdupq_n_f64(std::numeric_limits<double>::infinity())), x, result);
+        result = vbslq_f64(vceqq_f64(x, vdupq_n_f64(0.0)), vdupq_n_f64(-std::numeric_limits<double>::infinity()), result);
+
+        return vbslq_f64(vcgeq_f64(x, vdupq_n_f64(0.0)), result, vdupq_n_f64(std::numeric_limits<double>::quiet_NaN()));
+    }
+
+    // r = x - j pi / 2 with pi / 2 in four parts, the first three of 33 bits
+    // so their products by j are exact. From 2^30 on r has lost most of its
+    // bits and would grow past the polynomials, so those arguments reduce as
+    // zeros: x - x keeps infinities and NaNs as NaNs
+    static forcedinline float64x2_t reduce_angle_vector(float64x2_t x, float64x2_t& j)
+    {
+        x = vbslq_f64(vcgeq_f64(vabsq_f64(x), vdupq_n_f64(1073741824.0)), vsubq_f64(x, x), x);
+        j = vrndnq_f64(vmulq_f64(x, vdupq_n_f64(6.36619772367581382433e-1)));
+
+        return vsubq_f64(vsubq_f64(vsubq_f64(vsubq_f64(x,
+            vmulq_f64(j, vdupq_n_f64(1.57079632673412561417))),
+            vmulq_f64(j, vdupq_n_f64(6.07710050630396597660e-11))),
+            vmulq_f64(j, vdupq_n_f64(2.02226624871116645580e-21))),
+            vmulq_f64(j, vdupq_n_f64(8.47842766036889956997e-32)));
+    }
+
+    // the odd quadrants swap the polynomials, the sign flips follow the
+    // second bit of the quadrant, plus one for the cosine. Floats are reduced
+    // in double two at a time, close to the zeros a float pi / 2 loses r
+    static forcedinline void sincos_vector(float32x4_t x, float32x4_t& sin_value, float32x4_t& cos_value, bool accurate)
+    {
+        float64x2_t j_lo, j_hi;
+        const float32x4_t r = vcvt_high_f32_f64(
+            vcvt_f32_f64(reduce_angle_vector(vcvt_f64_f32(vget_low_f32(x)), j_lo)),
+            reduce_angle_vector(vcvt_high_f64_f32(x), j_hi));
+        const float32x4_t z = vmulq_f32(r, r);
+
+        const float32x4_t sine = vaddq_f32(r, vmulq_f32(vmulq_f32(r, z), accurate
+            ? polynomial_vector(z, accurate_sin_coefficients_float)
+            : polynomial_vector(z, fast_sin_coefficients_float)));
+        const float32x4_t cosine = vaddq_f32(vsubq_f32(vdupq_n_f32(1.0f), vmulq_f32(z, vdupq_n_f32(0.5f))),
+            vmulq_f32(vmulq_f32(z, z), accurate
+                ? polynomial_vector(z, accurate_cos_coefficients_float)
+                : polynomial_vector(z, fast_cos_coefficients_float)));
+
+        const int32x4_t quadrant = vcombine_s32(vmovn_s64(vcvtq_s64_f64(j_lo)), vmovn_s64(vcvtq_s64_f64(j_hi)));
+        const int32x4_t one = vdupq_n_s32(1);
+        const int32x4_t two = vdupq_n_s32(2);
+        const uint32x4_t swap = vtstq_s32(quadrant, one);
+
+        sin_value = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(swap, cosine, sine)),
+            vreinterpretq_u32_s32(vshlq_n_s32(vandq_s32(quadrant, two), 30))));
+        cos_value = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(swap, sine, cosine)),
+            vreinterpretq_u32_s32(vshlq_n_s32(vandq_s32(vaddq_s32(quadrant, one), two), 30))));
+    }
+
+    static forcedinline void sincos_vector(float64x2_t x, float64x2_t& sin_value, float64x2_t& cos_value, bool accurate)
+    {
+        float64x2_t j;
+        const float64x2_t r = reduce_angle_vector(x, j);
+        const float64x2_t z = vmulq_f64(r, r);
+
+        const float64x2_t sine = vaddq_f64(r, vmulq_f64(vmulq_f64(r, z), accurate
+            ? polynomial_vector(z, accurate_sin_coefficients_double)
+            : polynomial_vector(z, fast_sin_coefficients_double)));
+        const float64x2_t cosine = vaddq_f64(vsubq_f64(vdupq_n_f64(1.0), vmulq_f64(z, vdupq_n_f64(0.5))),
+            vmulq_f64(vmulq_f64(z, z), accurate
+                ? polynomial_vector(z, accurate_cos_coefficients_double)
+                : polynomial_vector(z, fast_cos_coefficients_double)));
+
+        const int64x2_t quadrant = vcvtq_s64_f64(j);
+        const int64x2_t one = vdupq_n_s64(1);
+        const int64x2_t two = vdupq_n_s64(2);
+        const uint64x2_t swap = vtstq_s64(quadrant, one);
+
+        sin_value = vreinterpretq_f64_u64(veorq_u64(vreinterpretq_u64_f64(vbslq_f64(swap, cosine, sine)),
+            vreinterpretq_u64_s64(vshlq_n_s64(vandq_s64(quadrant, two), 62))));
+        cos_value = vreinterpretq_f64_u64(veorq_u64(vreinterpretq_u64_f64(vbslq_f64(swap, sine, cosine)),
+            vreinterpretq_u64_s64(vshlq_n_s64(vandq_s64(vaddq_s64(quadrant, one), two), 62))));
+    }
+
+    // tanh |x| is -u / (2 + u) for u = e^(-2 |x|) - 1, the sign bit is
+    // selected from x
+    static forcedinline float32x4_t tanh_vector(float32x4_t x, bool accurate)
+    {
+        const float32x4_t a = vmulq_f32(vminq_f32(vabsq_f32(x), vdupq_n_f32(9.0f)), vdupq_n_f32(-2.0f));
+        const float32x4_t n = vrndnq_f32(vmulq_f32(a, vdupq_n_f32(1.44269504088896341f)));
+        const float32x4_t r = vsubq_f32(vsubq_f32(a, vmulq_f32(n, vdupq_n_f32(0.693359375f))),
+            vmulq_f32(n, vdupq_n_f32(-2.12194440e-4f)));
+
+        const float32x4_t scale = pow2_vector(n);
+        const float32x4_t u = vaddq_f32(vmulq_f32(scale, expm1_vector(r, accurate)), vsubq_f32(scale, vdupq_n_f32(1.0f)));
+        const float32x4_t result = vbslq_f32(vdupq_n_u32(0x80000000), x,
+            vdivq_f32(vsubq_f32(vdupq_n_f32(0.0f), u), vaddq_f32(vdupq_n_f32(2.0f), u)));
+
+        return vbslq_f32(vceqq_f32(x, x), result, x);
+    }
+
+    static forcedinline float64x2_t tanh_vector(float64x2_t x, bool accurate)
+    {
+        const float64x2_t a = vmulq_f64(vminq_f64(vabsq_f64(x), vdupq_n_f64(20.0)), vdupq_n_f64(-2.0));
+        const float64x2_t n = vrndnq_f64(vmulq_f64(a, vdupq_n_f64(1.4426950408889634074)));
+        const float64x2_t r = vsubq_f64(vsubq_f64(a, vmulq_f64(n, vdupq_n_f64(6.93147180369123816490e-1))),
+            vmulq_f64(n, vdupq_n_f64(1.90821492927058770002e-10)));
+
+        const float64x2_t scale = pow2_vector(n);
+        const float64x2_t u = vaddq_f64(vmulq_f64(scale, expm1_vector(r, accurate)), vsubq_f64(scale, vdupq_n_f64(1.0)));
+        const float64x2_t result = vbslq_f64(vdupq_n_u64(0x8000000000000000ULL), x,
+            vdivq_f64(vsubq_f64(vdupq_n_f64(0.0), u), vaddq_f64(vdupq_n_f64(2.0), u)));
+
+        return vbslq_f64(vceqq_f64(x, x), result, x);
+    }
+
+    // the accurate powers of floats go through the fast double functions,
+    // like pow_scalar does
+    static forcedinline float32x4_t pow_vector(float32x4_t x, float32x4_t y, bool accurate)
+    {
+        if (accurate)
+        {
+            const float64x2_t low = exp_vector(vmulq_f64(vcvt_f64_f32(vget_low_f32(y)),
+                log_vector(vcvt_f64_f32(vget_low_f32(x)), false)), false);
+            const float64x2_t high = exp_vector(vmulq_f64(vcvt_high_f64_f32(y),
+                log_vector(vcvt_high_f64_f32(x), false)), false);
+
+            return vcvt_high_f32_f64(vcvt_f32_f64(low), high);
+        }
+
+        return exp_vector(vmulq_f32(y, log_vector(x, false)), false);
+    }
+
+    static forcedinline float64x2_t pow_vector(float64x2_t x, float64x2_t y, bool accurate)
+    {
+        return exp_vector(vmulq_f64(y, log_vector(x, accurate)), accurate);
+    }
+
+    static forcedinline int32x4_t divide_vector(int32x4_t a, int32x4_t b)
+    {
+        const float64x2_t lo = vdivq_f64(
+            vcvtq_f64_s64(vmovl_s32(vget_low_s32(a))),
+            vcvtq_f64_s64(vmovl_s32(vget_low_s32(b))));
+        const float64x2_t hi = vdivq_f64(
+            vcvtq_f64_s64(vmovl_s32(vget_high_s32(a))),
+            vcvtq_f64_s64(vmovl_s32(vget_high_s32(b))));
+
+        return vcombine_s32(
+            vmovn_s64(vcvtq_s64_f64(lo)),
+            vmovn_s64(vcvtq_s64_f64(hi)));
+    }
+
+    static forcedinline uint32x4_t divide_vector(uint32x4_t a, uint32x4_t b)
+    {
+        const float64x2_t lo = vdivq_f64(
+            vcvtq_f64_u64(vmovl_u32(vget_low_u32(a))),
+            vcvtq_f64_u64(vmovl_u32(vget_low_u32(b))));
+        const float64x2_t hi = vdivq_f64(
+            vcvtq_f64_u64(vmovl_u32(vget_high_u32(a))),
+            vcvtq_f64_u64(vmovl_u32(vget_high_u32(b))));
+
+        return vcombine_u32(
+            vmovn_u64(vcvtq_u64_f64(lo)),
+            vmovn_u64(vcvtq_u64_f64(hi)));
+    }
+
+    static forcedinline int16x8_t divide_vector(int16x8_t a, int16x8_t b)
+    {
+        const float32x4_t lo = vdivq_f32(
+            vcvtq_f32_s32(vmovl_s16(vget_low_s16(a))),
+            vcvtq_f32_s32(vmovl_s16(vget_low_s16(b))));
+        const float32x4_t hi = vdivq_f32(
+            vcvtq_f32_s32(vmovl_s16(vget_high_s16(a))),
+            vcvtq_f32_s32(vmovl_s16(vget_high_s16(b))));
+
+        return vcombine_s16(
+            vmovn_s32(vcvtq_s32_f32(lo)),
+            vmovn_s32(vcvtq_s32_f32(hi)));
+    }
+
+    static forcedinline uint16x8_t divide_vector(uint16x8_t a, uint16x8_t b)
+    {
+        const float32x4_t lo = vdivq_f32(
+            vcvtq_f32_u32(vmovl_u16(vget_low_u16(a))),
+            vcvtq_f32_u32(vmovl_u16(vget_low_u16(b))));
+        const float32x4_t hi = vdivq_f32(
+            vcvtq_f32_u32(vmovl_u16(vget_high_u16(a))),
+            vcvtq_f32_u32(vmovl_u16(vget_high_u16(b))));
+
+        return vcombine_u16(
+            vmovn_u32(vcvtq_u32_f32(lo)),
+            vmovn_u32(vcvtq_u32_f32(hi)));
+    }
+
+    static forcedinline int8x16_t divide_vector(int8x16_t a, int8x16_t b)
+    {
+        const int16x8_t lo = divide_vector(
+            vmovl_s8(vget_low_s8(a)), vmovl_s8(vget_low_s8(b)));
+        const int16x8_t hi = divide_vector(
+            vmovl_s8(vget_high_s8(a)), vmovl_s8(vget_high_s8(b)));
+
+        return vcombine_s8(vmovn_s16(lo), vmovn_s16(hi));
+    }
+
+    static forcedinline uint8x16_t divide_vector(uint8x16_t a, uint8x16_t b)
+    {
+        const uint16x8_t lo = divide_vector(
+            vmovl_u8(vget_low_u8(a)), vmovl_u8(vget_low_u8(b)));
+        const uint16x8_t hi = divide_vector(
+            vmovl_u8(vget_high_u8(a)), vmovl_u8(vget_high_u8(b)));
+
+        return vcombine_u8(vmovn_u16(lo), vmovn_u16(hi));
+    }
+#endif
+
+    //--------------------------------------------------------------------------
+
+    // integer lanes are summed by pairwise widening into 64bit accumulators,
+    // which wrap exactly like the 64bit scalar sums of the fpu implementation;
+    // float lanes carry a kahan compensation and are reduced in double
+
+    static forcedinline void sum_vector(int64x2_t& sum, int64x2_t&, int8x16_t v)
+    {
+        sum = vpadalq_s32(sum, vpaddlq_s16(vpaddlq_s8(v)));
+    }
+
+    static forcedinline void sum_vector(uint64x2_t& sum, uint64x2_t&, uint8x16_t v)
+    {
+        sum = vpadalq_u32(sum, vpaddlq_u16(vpaddlq_u8(v)));
+    }
+
+    static forcedinline void sum_vector(int64x2_t& sum, int64x2_t&, int16x8_t v)
+    {
+        sum = vpadalq_s32(sum, vpaddlq_s16(v));
+    }
+
+    static forcedinline void sum_vector(uint64x2_t& sum, uint64x2_t&, uint16x8_t v)
+    {
+        sum = vpadalq_u32(sum, vpaddlq_u16(v));
+    }
+
+    static forcedinline void sum_vector(int64x2_t& sum, int64x2_t&, int32x4_t v)
+    {
+        sum = vpadalq_s32(sum, v);
+    }
+
+    static forcedinline void sum_vector(uint64x2_t& sum, uint64x2_t&, uint32x4_t v)
+    {
+        sum = vpadalq_u32(sum, v);
+    }
+
+    static forcedinline void sum_vector(int64x2_t& sum, int64x2_t&, int64x2_t v)
+    {
+        sum = vaddq_s64(sum, v);
+    }
+
+    static forcedinline void sum_vector(uint64x2_t& sum, uint64x2_t&, uint64x2_t v)
+    {
+        sum = vaddq_u64(sum, v);
+    }
+
+    static forcedinline void sum_vector(float32x4_t& sum, float32x4_t& compensation, float32x4_t v)
+    {
+        const float32x4_t y = vsubq_f32(v, compensation);
+        const float32x4_t t = vaddq_f32(sum, y);
+        compensation = vsubq_f32(vsubq_f32(t, sum), y);
+        sum = t;
+    }
+
+    static forcedinline void dot_vector(int64x2_t& sum, int64x2_t&, int8x16_t a, int8x16_t b)
+    {
+        // pairs of 8bit products can't overflow the 32bit lanes
+        const int16x8_t lo = vmull_s8(vget_low_s8(a), vget_low_s8(b));
+        const int16x8_t hi = vmull_s8(vget_high_s8(a), vget_high_s8(b));
+
+        sum = vpadalq_s32(sum, vaddq_s32(vpaddlq_s16(lo), vpaddlq_s16(hi)));
+    }
+
+    static forcedinline void dot_vector(uint64x2_t& sum, uint64x2_t&, uint8x16_t a, uint8x16_t b)
+    {
+        const uint16x8_t lo = vmull_u8(vget_low_u8(a), vget_low_u8(b));
+        const uint16x8_t hi = vmull_u8(vget_high_u8(a), vget_high_u8(b));
+
+        sum = vpadalq_u32(sum, vaddq_u32(vpaddlq_u16(lo), vpaddlq_u16(hi)));
+    }
+
+    static forcedinline void dot_vector(int64x2_t& sum, int64x2_t&, int16x8_t a, int16x8_t b)
+    {
+        sum = vpadalq_s32(sum, vmull_s16(vget_low_s16(a), vget_low_s16(b)));
+        sum = vpadalq_s32(sum, vmull_s16(vget_high_s16(a), vget_high_s16(b)));
+    }
+
+    static forcedinline void dot_vector(uint64x2_t& sum, uint64x2_t&, uint16x8_t a, uint16x8_t b)
+    {
+        sum = vpadalq_u32(sum, vmull_u16(vget_low_u16(a), vget_low_u16(b)));
+        sum = vpadalq_u32(sum, vmull_u16(vget_high_u16(a), vget_high_u16(b)));
+    }
+
+    static forcedinline void dot_vector(int64x2_t& sum, int64x2_t&, int32x4_t a, int32x4_t b)
+    {
+        sum = vaddq_s64(sum, vmull_s32(vget_low_s32(a), vget_low_s32(b)));
+        sum = vaddq_s64(sum, vmull_s32(vget_high_s32(a), vget_high_s32(b)));
+    }
+
+    static forcedinline void dot_vector(uint64x2_t& sum, uint64x2_t&, uint32x4_t a, uint32x4_t b)
+    {
+        sum = vaddq_u64(sum, vmull_u32(vget_low_u32(a), vget_low_u32(b)));
+        sum = vaddq_u64(sum, vmull_u32(vget_high_u32(a), vget_high_u32(b)));
+    }
+
+    static forcedinline void dot_vector(float32x4_t& sum, float32x4_t& compensation, float32x4_t a, float32x4_t b)
+    {
+        sum_vector(sum, compensation, vmulq_f32(a, b));
+    }
+
+    static forcedinline uint64 reduce_vector(int64x2_t sum, int64x2_t)
+    {
+        return static_cast<uint64>(vgetq_lane_s64(sum, 0)) +
+            static_cast<uint64>(vgetq_lane_s64(sum, 1));
+    }
+
+    static forcedinline uint64 reduce_vector(uint64x2_t sum, uint64x2_t)
+    {
+        return vgetq_lane_u64(sum, 0) + vgetq_lane_u64(sum, 1);
+    }
+
+    static forcedinline double reduce_vector(float32x4_t sum, float32x4_t compensation)
+    {
+        float lanes[4], compensations[4];
+        vst1q_f32(lanes, sum);
+        vst1q_f32(compensations, compensation);
+
+        double result = 0.0;
+        for (uint32 i = 0; i < 4; ++i)
+            result += (double)lanes[i] - (double)compensations[i];
+
+        return result;
+    }
+
+#if defined(WATERSPOUT_ARCH_ARM64)
+    static forcedinline void sum_vector(float64x2_t& sum, float64x2_t& compensation, float64x2_t v)
+    {
+        const float64x2_t y = vsubq_f64(v, compensation);
+        const float64x2_t t = vaddq_f64(sum, y);
+        compensation = vsubq_f64(vsubq_f64(t, sum), y);
+        sum = t;
+    }
+
+    static forcedinline void dot_vector(float64x2_t& sum, float64x2_t& compensation, float64x2_t a, float64x2_t b)
+    {
+        sum_vector(sum, compensation, vmulq_f64(a, b));
+    }
+
+    static forcedinline double reduce_vector(float64x2_t sum, float64x2_t compensation)
+    {
+        const float64x2_t result = vsubq_f64(sum, compensation);
+
+        return vgetq_lane_f64(result, 0) + vgetq_lane_f64(result, 1);
+    }
+#endif
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline int32x4_t load_samples(const int16* src_buffer)
+    {
+        return vmovl_s16(vld1_s16((const int16_t*)src_buffer));
+    }
+
+    static forcedinline int32x4_t load_samples(const int32* src_buffer)
+    {
+        return vld1q_s32((const int32_t*)src_buffer);
+    }
+
+#if defined(WATERSPOUT_ARCH_ARM64)
+    static forcedinline void store_samples(int16* dst_buffer, int32x4_t samples)
+    {
+        vst1_s16((int16_t*)dst_buffer, vqmovn_s32(samples));
+    }
+
+    static forcedinline void store_samples(int32* dst_buffer, int32x4_t samples)
+    {
+        vst1q_s32((int32_t*)dst_buffer, samples);
+    }
+
+    static forcedinline int32x4_t round_vector(float32x4_t value, FloatRoundingModeTypes rounding)
+    {
+        switch (rounding)
+        {
+        case ZERO:
+            return vcvtq_s32_f32(value);
+        case UPWARD:
+            return vcvtpq_s32_f32(value);
+        case DOWNWARD:
+            return vcvtmq_s32_f32(value);
+        default:
+            return vcvtnq_s32_f32(value);
+        }
+    }
+
+    // the tpdf_dither of the fpu on four sample indices
+    static forcedinline int32x4_t tpdf_dither_vector(uint32x4_t vindex)
+    {
+        uint32x4_t hash = veorq_u32(vindex, vshrq_n_u32(vindex, 16));
+        hash = vmulq_u32(hash, vdupq_n_u32(0x7feb352dU));
+        hash = veorq_u32(hash, vshrq_n_u32(hash, 15));
+        hash = vmulq_u32(hash, vdupq_n_u32(0x846ca68bU));
+        hash = veorq_u32(hash, vshrq_n_u32(hash, 16));
+
+        return vsubq_s32(vreinterpretq_s32_u32(vaddq_u32(
+            vandq_u32(hash, vdupq_n_u32(0xFFFF)), vshrq_n_u32(hash, 16))),
+            vdupq_n_s32(65535));
+    }
+#endif
+
+
+    //--------------------------------------------------------------------------
+
+    // the multiply_255 of the fpu: vrshrq adds 128 before shifting, and the
+    // rounding narrow adds it once more
+    static forcedinline uint8x16_t multiply_255_vector(uint8x16_t x, uint8x16_t y)
+    {
+        const uint16x8_t lo = vmull_u8(vget_low_u8(x), vget_low_u8(y));
+        const uint16x8_t hi = vmull_u8(vget_high_u8(x), vget_high_u8(y));
+
+        return vcombine_u8(vraddhn_u16(lo, vrshrq_n_u16(lo, 8)), vraddhn_u16(hi, vrshrq_n_u16(hi, 8)));
+    }
+
+    // the blend modes of the fpu composite_channel: saturated sums of 8 bit
+    // products are the clamped ones, only overlay has a negative term and is
+    // summed in 16 bit lanes
+    static forcedinline uint8x16_t multiply_pixel_vector(uint8x16_t s, uint8x16_t d, uint8x16_t sa, uint8x16_t da)
+    {
+        return vqaddq_u8(vqaddq_u8(multiply_255_vector(s, vmvnq_u8(da)),
+            multiply_255_vector(d, vmvnq_u8(sa))), multiply_255_vector(s, d));
+    }
+
+    static forcedinline uint8x16_t screen_pixel_vector(uint8x16_t s, uint8x16_t d)
+    {
+        return vqaddq_u8(vsubq_u8(s, multiply_255_vector(s, d)), d);
+    }
+
+    static forcedinline uint8x16_t overlay_pixel_vector(uint8x16_t s, uint8x16_t d, uint8x16_t sa, uint8x16_t da)
+    {
+        // 2 d > da is d > da - d, with da - d saturated to zero
+        const uint8x16_t backdrop_left = vqsubq_u8(da, d);
+        const uint8x16_t mask = vcgtq_u8(d, backdrop_left);
+        const uint8x16_t zero = vdupq_n_u8(0);
+
+        const uint8x16_t base = multiply_255_vector(s, vmvnq_u8(da));
+        const uint8x16_t other = multiply_255_vector(d, vmvnq_u8(sa));
+        const uint8x16_t screen = vbslq_u8(mask, multiply_255_vector(sa, da), zero);
+        const uint8x16_t screen_cut = vbslq_u8(mask, multiply_255_vector(backdrop_left, vqsubq_u8(sa, s)), zero);
+        const uint8x16_t multiply = vbslq_u8(mask, zero, multiply_255_vector(s, d));
+
+        const uint16x8_t positive_lo = vaddq_u16(vaddw_u8(vaddl_u8(vget_low_u8(base), vget_low_u8(other)),
+            vget_low_u8(screen)), vshll_n_u8(vget_low_u8(multiply), 1));
+        const uint16x8_t positive_hi = vaddq_u16(vaddw_u8(vaddl_u8(vget_high_u8(base), vget_high_u8(other)),
+            vget_high_u8(screen)), vshll_n_u8(vget_high_u8(multiply), 1));
+
+        return vcombine_u8(
+            vqmovun_s16(vreinterpretq_s16_u16(vsubq_u16(positive_lo, vshll_n_u8(vget_low_u8(screen_cut), 1)))),
+            vqmovun_s16(vreinterpretq_s16_u16(vsubq_u16(positive_hi, vshll_n_u8(vget_high_u8(screen_cut), 1)))));
+    }
+
+    static forcedinline float32x4_t multiply_pixel_vector(float32x4_t s, float32x4_t d, float32x4_t sa, float32x4_t da)
+    {
+        const float32x4_t one = vdupq_n_f32(1.0f);
+
+        return vaddq_f32(vaddq_f32(vmulq_f32(s, vsubq_f32(one, da)),
+            vmulq_f32(d, vsubq_f32(one, sa))), vmulq_f32(s, d));
+    }
+
+    static forcedinline float32x4_t screen_pixel_vector(float32x4_t s, float32x4_t d)
+    {
+        return vsubq_f32(vaddq_f32(s, d), vmulq_f32(s, d));
+    }
+
+    static forcedinline float32x4_t overlay_pixel_vector(float32x4_t s, float32x4_t d, float32x4_t sa, float32x4_t da)
+    {
+        const float32x4_t one = vdupq_n_f32(1.0f);
+        const float32x4_t two = vdupq_n_f32(2.0f);
+
+        const float32x4_t blend = vbslq_f32(vcgtq_f32(vmulq_f32(two, d), da),
+            vsubq_f32(vmulq_f32(sa, da), vmulq_f32(vmulq_f32(two, vsubq_f32(da, d)), vsubq_f32(sa, s))),
+            vmulq_f32(vmulq_f32(two, s), d));
+
+        return vaddq_f32(vaddq_f32(vmulq_f32(s, vsubq_f32(one, da)),
+            vmulq_f32(d, vsubq_f32(one, sa))), blend);
+    }
+
+#if defined(WATERSPOUT_ARCH_ARM64)
+    // (c * 255 + a / 2) / a in 32 bit lanes: the numerator and the quotient
+    // are small enough for the float division to truncate to the integer one
+    static forcedinline uint32x4_t unpremultiply_vector(uint32x4_t c, uint32x4_t a)
+    {
+        const float32x4_t numerator = vcvtq_f32_u32(vaddq_u32(vmulq_n_u32(c, 255), vshrq_n_u32(a, 1)));
+        const float32x4_t quotient = vdivq_f32(numerator, vmaxq_f32(vcvtq_f32_u32(a), vdupq_n_f32(1.0f)));
+
+        return vandq_u32(vtstq_u32(a, a), vcvtq_u32_f32(vminq_f32(quotient, vdupq_n_f32(255.0f))));
+    }
+
+    static forcedinline uint16x8_t unpremultiply_vector(uint16x8_t c, uint16x8_t a)
+    {
+        return vcombine_u16(
+            vmovn_u32(unpremultiply_vector(vmovl_u16(vget_low_u16(c)), vmovl_u16(vget_low_u16(a)))),
+            vmovn_u32(unpremultiply_vector(vmovl_u16(vget_high_u16(c)), vmovl_u16(vget_high_u16(a)))));
+    }
+
+    static forcedinline uint8x16_t unpremultiply_vector(uint8x16_t c, uint8x16_t a)
+    {
+        return vcombine_u8(
+            vmovn_u16(unpremultiply_vector(vmovl_u8(vget_low_u8(c)), vmovl_u8(vget_low_u8(a)))),
+            vmovn_u16(unpremultiply_vector(vmovl_u8(vget_high_u8(c)), vmovl_u8(vget_high_u8(a)))));
+    }
+
+    static forcedinline float32x4_t unpremultiply_vector(float32x4_t c, float32x4_t a)
+    {
+        const uint32x4_t opaque = vmvnq_u32(vceqq_f32(a, vdupq_n_f32(0.0f)));
+        const float32x4_t quotient = vdivq_f32(c, vbslq_f32(opaque, a, vdupq_n_f32(1.0f)));
+
+        return vreinterpretq_f32_u32(vandq_u32(opaque, vreinterpretq_u32_f32(quotient)));
+    }
+#endif
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline int16x8_t widen_channel_vector(uint8x8_t channel)
+    {
+        return vreinterpretq_s16_u16(vmovl_u8(channel));
+    }
+
+    // the weighted sum of eight red, green and blue channels plus rounding,
+    // in two halves of 32 bit lanes
+    static forcedinline void weight_channels_vector(int16x8_t red, int16x8_t green, int16x8_t blue,
+        int16 red_weight, int16 green_weight, int16 blue_weight, int32x4_t rounding, int32x4_t& lo, int32x4_t& hi)
+    {
+        lo = vmlal_n_s16(vmlal_n_s16(vmlal_n_s16(rounding, vget_low_s16(red), red_weight),
+            vget_low_s16(green), green_weight), vget_low_s16(blue), blue_weight);
+        hi = vmlal_n_s16(vmlal_n_s16(vmlal_n_s16(rounding, vget_high_s16(red), red_weight),
+            vget_high_s16(green), green_weight), vget_high_s16(blue), blue_weight);
+    }
+
+    // eight shifted sums back to bytes, clamped as clamp_channel does
+    static forcedinline uint8x8_t narrow_channel_vector(int32x4_t lo, int32x4_t hi)
+    {
+        return vqmovn_u16(vcombine_u16(vqmovun_s32(lo), vqmovun_s32(hi)));
+    }
+
+    static forcedinline void yuv_to_rgb_vector(int16x8_t y, int16x8_t u, int16x8_t v, const color_matrix& matrix,
+        uint8x8_t& red, uint8x8_t& green, uint8x8_t& blue)
+    {
+        const int32x4_t rounding = vdupq_n_s32(1 << 12);
+        const int32x4_t luma_lo = vmlal_n_s16(rounding, vget_low_s16(y), matrix.luma);
+        const int32x4_t luma_hi = vmlal_n_s16(rounding, vget_high_s16(y), matrix.luma);
+
+        red = narrow_channel_vector(
+            vshrq_n_s32(vmlal_n_s16(luma_lo, vget_low_s16(v), matrix.red_v), 13),
+            vshrq_n_s32(vmlal_n_s16(luma_hi, vget_high_s16(v), matrix.red_v), 13));
+        green = narrow_channel_vector(
+            vshrq_n_s32(vmlal_n_s16(vmlal_n_s16(luma_lo, vget_low_s16(u), matrix.green_u), vget_low_s16(v), matrix.green_v), 13),
+            vshrq_n_s32(vmlal_n_s16(vmlal_n_s16(luma_hi, vget_high_s16(u), matrix.green_u), vget_high_s16(v), matrix.green_v), 13));
+        blue = narrow_channel_vector(
+            vshrq_n_s32(vmlal_n_s16(luma_lo, vget_low_s16(u), matrix.blue_u), 13),
+            vshrq_n_s32(vmlal_n_s16(luma_hi, vget_high_s16(u), matrix.blue_u), 13));
+    }
+
 };
 
 
@@ -572,6 +572,1955 @@ public:
         }
     }
 
+
+    //--------------------------------------------------------------------------
+
+    void abs_buffer_float(
+        float* src_buffer,
+        uint32 size) const
+    {
+        if (size < SSE_MIN_SAMPLES)
+        {
+            math_mmx::abs_buffer_float(src_buffer, size);
+        }
+        else
+        {
+            assert(size >= SSE_MIN_SIZE);
+
+            const ptrdiff_t align_bytes = ((ptrdiff_t)src_buffer & SSE_ALIGN);
+
+            // Copy unaligned head
+            simd_unroll_head_4(
+                --size;
+                *src_buffer = std::fabs(*src_buffer);
+                ++src_buffer;
+            );
+
+            // Clear the sign bit with simd
+            const __m128 vsign = _mm_set1_ps(-0.0f);
+            __m128* vector_buffer = (__m128*)src_buffer;
+
+            uint32 vector_count = size >> 2;
+            while (vector_count--)
+            {
+                *vector_buffer = _mm_andnot_ps(vsign, *vector_buffer);
+                ++vector_buffer;
+            }
+
+            // Handle any unaligned leftovers
+            src_buffer = (float*)vector_buffer;
+
+            simd_unroll_tail_4(
+                *src_buffer = std::fabs(*src_buffer);
+                ++src_buffer;
+            );
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void multiply_add_buffers_float(
+        float* src_buffer_a,
+        float* src_buffer_b,
+        float* src_buffer_c,
+        float* dst_buffer,
+        uint32 size) const
+    {
+        const ptrdiff_t align_bytes = ((ptrdiff_t)dst_buffer & SSE_ALIGN);
+
+        if (size < SSE_MIN_SAMPLES ||
+            (align_bytes != ((ptrdiff_t)src_buffer_a & SSE_ALIGN) ||
+             align_bytes != ((ptrdiff_t)src_buffer_b & SSE_ALIGN) ||
+             align_bytes != ((ptrdiff_t)src_buffer_c & SSE_ALIGN)))
+        {
+            math_mmx::multiply_add_buffers_float(src_buffer_a, src_buffer_b, src_buffer_c, dst_buffer, size);
+        }
+        else
+        {
+            assert(size >= SSE_MIN_SIZE);
+
+            const disable_sse_denormals disable_denormals;
+
+            // Copy unaligned head
+            simd_unroll_head_4(
+                --size;
+                *dst_buffer = *src_buffer_a++ * *src_buffer_b++ + *src_buffer_c++;
+                undenormalizef(*dst_buffer);
+                ++dst_buffer;
+            );
+
+            // Multiply and add with simd
+            __m128* vector_buffer_a = (__m128*)src_buffer_a;
+            __m128* vector_buffer_b = (__m128*)src_buffer_b;
+            __m128* vector_buffer_c = (__m128*)src_buffer_c;
+            __m128* vector_dst_buffer = (__m128*)dst_buffer;
+
+            uint32 vector_count = size >> 2;
+            while (vector_count--)
+            {
+                *vector_dst_buffer = _mm_add_ps(
+                  _mm_mul_ps(*vector_buffer_a, *vector_buffer_b), *vector_buffer_c);
+
+                ++vector_buffer_a;
+                ++vector_buffer_b;
+                ++vector_buffer_c;
+                ++vector_dst_buffer;
+            }
+
+            // Handle any unaligned leftovers
+            src_buffer_a = (float*)vector_buffer_a;
+            src_buffer_b = (float*)vector_buffer_b;
+            src_buffer_c = (float*)vector_buffer_c;
+            dst_buffer = (float*)vector_dst_buffer;
+
+            simd_unroll_tail_4(
+                *dst_buffer = *src_buffer_a++ * *src_buffer_b++ + *src_buffer_c++;
+                undenormalizef(*dst_buffer);
+                ++dst_buffer;
+            );
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void scale_add_buffer_float(
+        float* src_buffer,
+        float* dst_buffer,
+        uint32 size,
+        float gain) const
+    {
+        const ptrdiff_t align_bytes = ((ptrdiff_t)dst_buffer & SSE_ALIGN);
+
+        if (size < SSE_MIN_SAMPLES ||
+            align_bytes != ((ptrdiff_t)src_buffer & SSE_ALIGN))
+        {
+            math_mmx::scale_add_buffer_float(src_buffer, dst_buffer, size, gain);
+        }
+        else
+        {
+            assert(size >= SSE_MIN_SIZE);
+
+            const disable_sse_denormals disable_denormals;
+
+            // Copy unaligned head
+            simd_unroll_head_4(
+                --size;
+                *dst_buffer = *dst_buffer + *src_buffer++ * gain;
+                undenormalizef(*dst_buffer);
+                ++dst_buffer;
+            );
+
+            // Scale and accumulate with simd
+            const __m128 vgain = _mm_set1_ps(gain);
+            __m128* vector_buffer = (__m128*)src_buffer;
+            __m128* vector_dst_buffer = (__m128*)dst_buffer;
+
+            uint32 vector_count = size >> 2;
+            while (vector_count--)
+            {
+                *vector_dst_buffer = _mm_add_ps(
+                  *vector_dst_buffer, _mm_mul_ps(*vector_buffer, vgain));
+
+                ++vector_buffer;
+                ++vector_dst_buffer;
+            }
+
+            // Handle any unaligned leftovers
+            src_buffer = (float*)vector_buffer;
+            dst_buffer = (float*)vector_dst_buffer;
+
+            simd_unroll_tail_4(
+                *dst_buffer = *dst_buffer + *src_buffer++ * gain;
+                undenormalizef(*dst_buffer);
+                ++dst_buffer;
+            );
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void ramp_scale_buffer_float(
+        float* src_buffer,
+        uint32 size,
+        float start_gain,
+        float end_gain) const
+    {
+        if (size < SSE_MIN_SAMPLES)
+        {
+            math_mmx::ramp_scale_buffer_float(src_buffer, size, start_gain, end_gain);
+        }
+        else
+        {
+            assert(size >= SSE_MIN_SIZE);
+
+            const disable_sse_denormals disable_denormals;
+
+            const ptrdiff_t align_bytes = ((ptrdiff_t)src_buffer & SSE_ALIGN);
+            const float increment = ramp_increment(start_gain, end_gain, size);
+
+            // Ramp unaligned head
+            const uint32 head_count = (uint32)(((SSE_ALIGN + 1) - align_bytes) & SSE_ALIGN) >> 2;
+            ramp_scale_generic(src_buffer, head_count, start_gain, increment, 0);
+
+            // Ramp with simd, the sample indices are advanced in registers
+            float lanes[4];
+            ramp_index_lanes(lanes, 4, head_count);
+
+            const __m128 vstart = _mm_set1_ps(start_gain);
+            const __m128 vincrement = _mm_set1_ps(increment);
+            const __m128 vstep = _mm_set1_ps(4.0f);
+            __m128 vindex = _mm_loadu_ps(lanes);
+            __m128* vector_buffer = (__m128*)(src_buffer + head_count);
+
+            uint32 vector_count = (size - head_count) >> 2;
+            const uint32 index = head_count + (vector_count << 2);
+            while (vector_count--)
+            {
+                *vector_buffer = _mm_mul_ps(*vector_buffer,
+                    _mm_add_ps(vstart, _mm_mul_ps(vincrement, vindex)));
+                vindex = _mm_add_ps(vindex, vstep);
+
+                ++vector_buffer;
+            }
+
+            // Handle any unaligned leftovers
+            ramp_scale_generic((float*)vector_buffer, size - index, start_gain, increment, index);
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void exp_ramp_scale_buffer_float(
+        float* src_buffer,
+        uint32 size,
+        float start_gain,
+        float end_gain) const
+    {
+        if (size < SSE_MIN_SAMPLES || ! is_exp_ramp(start_gain, end_gain, size))
+        {
+            math_mmx::exp_ramp_scale_buffer_float(src_buffer, size, start_gain, end_gain);
+        }
+        else
+        {
+            assert(size >= SSE_MIN_SIZE);
+
+            const disable_sse_denormals disable_denormals;
+
+            const ptrdiff_t align_bytes = ((ptrdiff_t)src_buffer & SSE_ALIGN);
+            const double log_ratio = exp_ramp_log_ratio(start_gain, end_gain, size);
+
+            // Ramp unaligned head
+            const uint32 head_count = (uint32)(((SSE_ALIGN + 1) - align_bytes) & SSE_ALIGN) >> 2;
+            exp_ramp_scale_generic(src_buffer, head_count, start_gain, log_ratio, 0);
+
+            // Ramp with simd, the gains are multiplied in registers and put
+            // back on the exact curve at the start of every block
+            float lanes[4];
+
+            const __m128 vstep = _mm_set1_ps((float)std::exp(log_ratio * 4));
+            __m128* vector_buffer = (__m128*)(src_buffer + head_count);
+
+            uint32 index = head_count;
+            uint32 vector_count = (size - head_count) >> 2;
+            while (vector_count > 0)
+            {
+                uint32 block_count = vector_count < (RAMP_BLOCK_SIZE >> 2) ?
+                    vector_count : (RAMP_BLOCK_SIZE >> 2);
+                vector_count -= block_count;
+
+                exp_ramp_lanes(lanes, 4, start_gain, log_ratio, index);
+                __m128 vgain = _mm_loadu_ps(lanes);
+                index += block_count << 2;
+
+                while (block_count--)
+                {
+                    *vector_buffer = _mm_mul_ps(*vector_buffer, vgain);
+                    vgain = _mm_mul_ps(vgain, vstep);
+
+                    ++vector_buffer;
+                }
+            }
+
+            // Handle any unaligned leftovers
+            exp_ramp_scale_generic((float*)vector_buffer, size - index, start_gain, log_ratio, index);
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    double sum_buffer_float(
+        float* src_buffer,
+        uint32 size) const
+    {
+        if (size < SSE_MIN_SAMPLES)
+        {
+            return math_mmx::sum_buffer_float(src_buffer, size);
+        }
+        else
+        {
+            assert(size >= SSE_MIN_SIZE);
+
+            const ptrdiff_t align_bytes = ((ptrdiff_t)src_buffer & SSE_ALIGN);
+
+            double result = 0.0;
+
+            // Sum unaligned head
+            simd_unroll_head_4(
+                --size;
+                result += *src_buffer++;
+            );
+
+            // Sum with simd, compensating each lane
+            __m128 vsum = _mm_setzero_ps();
+            __m128 vcompensation = _mm_setzero_ps();
+            __m128* vector_buffer = (__m128*)src_buffer;
+
+            uint32 vector_count = size >> 2;
+            while (vector_count--)
+            {
+                kahan_add_ps(vsum, vcompensation, *vector_buffer);
+
+                ++vector_buffer;
+            }
+
+            result += reduce_kahan_ps(vsum, vcompensation);
+
+            // Handle any unaligned leftovers
+            src_buffer = (float*)vector_buffer;
+
+            simd_unroll_tail_4(
+                result += *src_buffer++;
+            );
+
+            return result;
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    double dot_product_float(
+        float* src_buffer_a,
+        float* src_buffer_b,
+        uint32 size) const
+    {
+        const ptrdiff_t align_bytes = ((ptrdiff_t)src_buffer_a & SSE_ALIGN);
+
+        if (size < SSE_MIN_SAMPLES ||
+            align_bytes != ((ptrdiff_t)src_buffer_b & SSE_ALIGN))
+        {
+            return math_mmx::dot_product_float(src_buffer_a, src_buffer_b, size);
+        }
+        else
+        {
+            assert(size >= SSE_MIN_SIZE);
+
+            double result = 0.0;
+
+            // Multiply and sum unaligned head
+            simd_unroll_head_4(
+                --size;
+                result += (double)*src_buffer_a++ * (double)*src_buffer_b++;
+            );
+
+            // Multiply and sum with simd, compensating each lane
+            __m128 vsum = _mm_setzero_ps();
+            __m128 vcompensation = _mm_setzero_ps();
+            __m128* vector_buffer_a = (__m128*)src_buffer_a;
+            __m128* vector_buffer_b = (__m128*)src_buffer_b;
+
+            uint32 vector_count = size >> 2;
+            while (vector_count--)
+            {
+                kahan_add_ps(vsum, vcompensation,
+                  _mm_mul_ps(*vector_buffer_a, *vector_buffer_b));
+
+                ++vector_buffer_a;
+                ++vector_buffer_b;
+            }
+
+            result += reduce_kahan_ps(vsum, vcompensation);
+
+            // Handle any unaligned leftovers
+            src_buffer_a = (float*)vector_buffer_a;
+            src_buffer_b = (float*)vector_buffer_b;
+
+            simd_unroll_tail_4(
+                result += (double)*src_buffer_a++ * (double)*src_buffer_b++;
+            );
+
+            return result;
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    float min_buffer_float(
+        float* src_buffer,
+        uint32 size,
+        uint32* index) const
+    {
+        if (size < SSE_MIN_SAMPLES)
+        {
+            return math_mmx::min_buffer_float(src_buffer, size, index);
+        }
+        else
+        {
+            assert(size >= SSE_MIN_SIZE);
+
+            const ptrdiff_t align_bytes = ((ptrdiff_t)src_buffer & SSE_ALIGN);
+
+            float* const buffer = src_buffer;
+            const uint32 buffer_size = size;
+            float result = *src_buffer;
+
+            // Compare unaligned head
+            simd_unroll_head_4(
+                --size;
+                if (*src_buffer < result)
+                    result = *src_buffer;
+                ++src_buffer;
+            );
+
+            // Compare with simd
+            __m128 vresult = _mm_set1_ps(result);
+            __m128* vector_buffer = (__m128*)src_buffer;
+
+            uint32 vector_count = size >> 2;
+            while (vector_count--)
+            {
+                vresult = _mm_min_ps(*vector_buffer, vresult);
+
+                ++vector_buffer;
+            }
+
+            float lanes[4];
+            _mm_storeu_ps(lanes, vresult);
+            for (uint32 i = 0; i < 4; ++i)
+            {
+                if (lanes[i] < result)
+                    result = lanes[i];
+            }
+
+            // Handle any unaligned leftovers
+            src_buffer = (float*)vector_buffer;
+
+            simd_unroll_tail_4(
+                if (*src_buffer < result)
+                    result = *src_buffer;
+                ++src_buffer;
+            );
+
+            if (index != nullptr)
+                *index = index_of_value(buffer, buffer_size, result);
+
+            return result;
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    float max_buffer_float(
+        float* src_buffer,
+        uint32 size,
+        uint32* index) const
+    {
+        if (size < SSE_MIN_SAMPLES)
+        {
+            return math_mmx::max_buffer_float(src_buffer, size, index);
+        }
+        else
+        {
+            assert(size >= SSE_MIN_SIZE);
+
+            const ptrdiff_t align_bytes = ((ptrdiff_t)src_buffer & SSE_ALIGN);
+
+            float* const buffer = src_buffer;
+            const uint32 buffer_size = size;
+            float result = *src_buffer;
+
+            // Compare unaligned head
+            simd_unroll_head_4(
+                --size;
+                if (*src_buffer > result)
+                    result = *src_buffer;
+                ++src_buffer;
+            );
+
+            // Compare with simd
+            __m128 vresult = _mm_set1_ps(result);
+            __m128* vector_buffer = (__m128*)src_buffer;
+
+            uint32 vector_count = size >> 2;
+            while (vector_count--)
+            {
+                vresult = _mm_max_ps(*vector_buffer, vresult);
+
+                ++vector_buffer;
+            }
+
+            float lanes[4];
+            _mm_storeu_ps(lanes, vresult);
+            for (uint32 i = 0; i < 4; ++i)
+            {
+                if (lanes[i] > result)
+                    result = lanes[i];
+            }
+
+            // Handle any unaligned leftovers
+            src_buffer = (float*)vector_buffer;
+
+            simd_unroll_tail_4(
+                if (*src_buffer > result)
+                    result = *src_buffer;
+                ++src_buffer;
+            );
+
+            if (index != nullptr)
+                *index = index_of_value(buffer, buffer_size, result);
+
+            return result;
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    double peak_abs_buffer_float(
+        float* src_buffer,
+        uint32 size) const
+    {
+        if (size < SSE_MIN_SAMPLES)
+        {
+            return math_mmx::peak_abs_buffer_float(src_buffer, size);
+        }
+        else
+        {
+            assert(size >= SSE_MIN_SIZE);
+
+            const ptrdiff_t align_bytes = ((ptrdiff_t)src_buffer & SSE_ALIGN);
+
+            float result = 0.0f;
+
+            // Compare unaligned head
+            simd_unroll_head_4(
+                --size;
+                if (std::fabs(*src_buffer) > result)
+                    result = std::fabs(*src_buffer);
+                ++src_buffer;
+            );
+
+            // Compare with simd, clearing the sign bits
+            const __m128 vsign = _mm_set1_ps(-0.0f);
+            __m128 vresult = _mm_setzero_ps();
+            __m128* vector_buffer = (__m128*)src_buffer;
+
+            uint32 vector_count = size >> 2;
+            while (vector_count--)
+            {
+                vresult = _mm_max_ps(_mm_andnot_ps(vsign, *vector_buffer), vresult);
+
+                ++vector_buffer;
+            }
+
+            float lanes[4];
+            _mm_storeu_ps(lanes, vresult);
+            for (uint32 i = 0; i < 4; ++i)
+            {
+                if (lanes[i] > result)
+                    result = lanes[i];
+            }
+
+            // Handle any unaligned leftovers
+            src_buffer = (float*)vector_buffer;
+
+            simd_unroll_tail_4(
+                if (std::fabs(*src_buffer) > result)
+                    result = std::fabs(*src_buffer);
+                ++src_buffer;
+            );
+
+            return result;
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void interleave_buffers_float(
+        float** src_buffers,
+        float* dst_buffer,
+        uint32 channels,
+        uint32 size) const
+    {
+        if (size < SSE_MIN_SAMPLES || channels < 2)
+        {
+            math_mmx::interleave_buffers_float(src_buffers, dst_buffer, channels, size);
+        }
+        else
+        {
+            const uint32 frames = size & ~3;
+
+            if (channels == 2)
+            {
+                // Unpack four frames of the two channels into two vectors
+                const float* left_buffer = src_buffers[0];
+                const float* right_buffer = src_buffers[1];
+
+                for (uint32 i = 0; i < frames; i += 4)
+                {
+                    const __m128 vleft = _mm_loadu_ps(left_buffer + i);
+                    const __m128 vright = _mm_loadu_ps(right_buffer + i);
+
+                    _mm_storeu_ps(dst_buffer + i * 2, _mm_unpacklo_ps(vleft, vright));
+                    _mm_storeu_ps(dst_buffer + i * 2 + 4, _mm_unpackhi_ps(vleft, vright));
+                }
+            }
+            else
+            {
+                // Transpose four frames of four channels at a time
+                uint32 c = 0;
+                for (; c + 4 <= channels; c += 4)
+                {
+                    const float* src0 = src_buffers[c];
+                    const float* src1 = src_buffers[c + 1];
+                    const float* src2 = src_buffers[c + 2];
+                    const float* src3 = src_buffers[c + 3];
+                    float* dst = dst_buffer + c;
+
+                    for (uint32 i = 0; i < frames; i += 4)
+                    {
+                        __m128 v0 = _mm_loadu_ps(src0 + i);
+                        __m128 v1 = _mm_loadu_ps(src1 + i);
+                        __m128 v2 = _mm_loadu_ps(src2 + i);
+                        __m128 v3 = _mm_loadu_ps(src3 + i);
+
+                        _MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+
+                        _mm_storeu_ps(dst + i * channels, v0);
+                        _mm_storeu_ps(dst + (i + 1) * channels, v1);
+                        _mm_storeu_ps(dst + (i + 2) * channels, v2);
+                        _mm_storeu_ps(dst + (i + 3) * channels, v3);
+                    }
+                }
+
+                // Then a pair of channels, two frames per vector half
+                if (c + 2 <= channels)
+                {
+                    const float* src0 = src_buffers[c];
+                    const float* src1 = src_buffers[c + 1];
+                    float* dst = dst_buffer + c;
+
+                    for (uint32 i = 0; i < frames; i += 4)
+                    {
+                        const __m128 v0 = _mm_loadu_ps(src0 + i);
+                        const __m128 v1 = _mm_loadu_ps(src1 + i);
+                        const __m128 vlo = _mm_unpacklo_ps(v0, v1);
+                        const __m128 vhi = _mm_unpackhi_ps(v0, v1);
+
+                        _mm_storel_pi((__m64*)(dst + i * channels), vlo);
+                        _mm_storeh_pi((__m64*)(dst + (i + 1) * channels), vlo);
+                        _mm_storel_pi((__m64*)(dst + (i + 2) * channels), vhi);
+                        _mm_storeh_pi((__m64*)(dst + (i + 3) * channels), vhi);
+                    }
+
+                    c += 2;
+                }
+
+                // Handle the last odd channel
+                interleave_generic(src_buffers, dst_buffer, channels, c, channels, 0, frames);
+            }
+
+            // Handle the leftover frames
+            interleave_generic(src_buffers, dst_buffer, channels, 0, channels, frames, size);
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void deinterleave_buffer_float(
+        float* src_buffer,
+        float** dst_buffers,
+        uint32 channels,
+        uint32 size) const
+    {
+        if (size < SSE_MIN_SAMPLES || channels < 2)
+        {
+            math_mmx::deinterleave_buffer_float(src_buffer, dst_buffers, channels, size);
+        }
+        else
+        {
+            const uint32 frames = size & ~3;
+
+            if (channels == 2)
+            {
+                // Shuffle even and odd samples of four frames apart
+                float* left_buffer = dst_buffers[0];
+                float* right_buffer = dst_buffers[1];
+
+                for (uint32 i = 0; i < frames; i += 4)
+                {
+                    const __m128 vlo = _mm_loadu_ps(src_buffer + i * 2);
+                    const __m128 vhi = _mm_loadu_ps(src_buffer + i * 2 + 4);
+
+                    _mm_storeu_ps(left_buffer + i, _mm_shuffle_ps(vlo, vhi, _MM_SHUFFLE(2, 0, 2, 0)));
+                    _mm_storeu_ps(right_buffer + i, _mm_shuffle_ps(vlo, vhi, _MM_SHUFFLE(3, 1, 3, 1)));
+                }
+            }
+            else
+            {
+                // Transpose four frames of four channels at a time
+                uint32 c = 0;
+                for (; c + 4 <= channels; c += 4)
+                {
+                    const float* src = src_buffer + c;
+                    float* dst0 = dst_buffers[c];
+                    float* dst1 = dst_buffers[c + 1];
+                    float* dst2 = dst_buffers[c + 2];
+                    float* dst3 = dst_buffers[c + 3];
+
+                    for (uint32 i = 0; i < frames; i += 4)
+                    {
+                        __m128 v0 = _mm_loadu_ps(src + i * channels);
+                        __m128 v1 = _mm_loadu_ps(src + (i + 1) * channels);
+                        __m128 v2 = _mm_loadu_ps(src + (i + 2) * channels);
+                        __m128 v3 = _mm_loadu_ps(src + (i + 3) * channels);
+
+                        _MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+
+                        _mm_storeu_ps(dst0 + i, v0);
+                        _mm_storeu_ps(dst1 + i, v1);
+                        _mm_storeu_ps(dst2 + i, v2);
+                        _mm_storeu_ps(dst3 + i, v3);
+                    }
+                }
+
+                // Then a pair of channels, two frames per vector half
+                if (c + 2 <= channels)
+                {
+                    const float* src = src_buffer + c;
+                    float* dst0 = dst_buffers[c];
+                    float* dst1 = dst_buffers[c + 1];
+
+                    for (uint32 i = 0; i < frames; i += 4)
+                    {
+                        __m128 vlo = _mm_setzero_ps();
+                        __m128 vhi = _mm_setzero_ps();
+
+                        vlo = _mm_loadl_pi(vlo, (const __m64*)(src + i * channels));
+                        vlo = _mm_loadh_pi(vlo, (const __m64*)(src + (i + 1) * channels));
+                        vhi = _mm_loadl_pi(vhi, (const __m64*)(src + (i + 2) * channels));
+                        vhi = _mm_loadh_pi(vhi, (const __m64*)(src + (i + 3) * channels));
+
+                        _mm_storeu_ps(dst0 + i, _mm_shuffle_ps(vlo, vhi, _MM_SHUFFLE(2, 0, 2, 0)));
+                        _mm_storeu_ps(dst1 + i, _mm_shuffle_ps(vlo, vhi, _MM_SHUFFLE(3, 1, 3, 1)));
+                    }
+
+                    c += 2;
+                }
+
+                // Handle the last odd channel
+                deinterleave_generic(src_buffer, dst_buffers, channels, c, channels, 0, frames);
+            }
+
+            // Handle the leftover frames
+            deinterleave_generic(src_buffer, dst_buffers, channels, 0, channels, frames, size);
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void process_biquad_bank_float(
+        float* src_buffer,
+        float* dst_buffer,
+        uint32 channels,
+        uint32 frames,
+        float* coefficients,
+        float* state,
+        uint32 sections) const
+    {
+        if (channels < 4)
+        {
+            math_mmx::process_biquad_bank_float(src_buffer, dst_buffer, channels, frames,
+                coefficients, state, sections);
+        }
+        else
+        {
+            const disable_sse_denormals disable_denormals;
+
+            // Every lane runs the cascade of one channel: all the groups of
+            // four channels are walked each frame, so their recurrences overlap
+            const uint32 vector_channels = channels & ~3;
+
+            for (uint32 frame = 0; frame < frames; ++frame)
+            {
+                const float* src = src_buffer + frame * channels;
+                float* dst = dst_buffer + frame * channels;
+
+                for (uint32 c = 0; c < vector_channels; c += 4)
+                {
+                    const float* coefficient = coefficients + c;
+                    float* z = state + c;
+                    __m128 value = _mm_loadu_ps(src + c);
+
+                    for (uint32 section = 0; section < sections; ++section)
+                    {
+                        const __m128 output = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(coefficient), value),
+                            _mm_loadu_ps(z));
+
+                        _mm_storeu_ps(z, _mm_add_ps(_mm_sub_ps(
+                            _mm_mul_ps(_mm_loadu_ps(coefficient + channels), value),
+                            _mm_mul_ps(_mm_loadu_ps(coefficient + 3 * channels), output)),
+                            _mm_loadu_ps(z + channels)));
+                        _mm_storeu_ps(z + channels, _mm_sub_ps(
+                            _mm_mul_ps(_mm_loadu_ps(coefficient + 2 * channels), value),
+                            _mm_mul_ps(_mm_loadu_ps(coefficient + 4 * channels), output)));
+                        value = output;
+
+                        coefficient += 5 * channels;
+                        z += 2 * channels;
+                    }
+
+                    _mm_storeu_ps(dst + c, value);
+                }
+            }
+
+            // Handle the leftover channels
+            biquad_bank_generic(src_buffer, dst_buffer, channels, frames,
+                coefficients, state, sections, vector_channels);
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void process_polyphase_float(
+        float* src_buffer,
+        float* dst_buffer,
+        uint32 size,
+        float* coefficients,
+        uint32 taps,
+        uint32* rows,
+        uint32* offsets) const
+    {
+        if (taps < 4)
+        {
+            math_mmx::process_polyphase_float(src_buffer, dst_buffer, size,
+                coefficients, taps, rows, offsets);
+        }
+        else
+        {
+            const disable_sse_denormals disable_denormals;
+
+            const uint32 vector_taps = taps & ~3;
+
+            for (uint32 i = 0; i < size; ++i)
+            {
+                const float* src = src_buffer + offsets[i];
+                const float* coefficient = coefficients + rows[i] * taps;
+                __m128 sum = _mm_setzero_ps();
+
+                for (uint32 k = 0; k < vector_taps; k += 4)
+                {
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(coefficient + k), _mm_loadu_ps(src + k)));
+                }
+
+                float sums[4];
+                _mm_storeu_ps(sums, sum);
+
+                // Handle the leftover taps
+                dst_buffer[i] = polyphase_row_generic(src, coefficient, vector_taps, taps,
+                    (sums[0] + sums[1]) + (sums[2] + sums[3]));
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    void process_envelope_bank_float(
+        float* src_buffer,
+        float* dst_buffer,
+        uint32 channels,
+        uint32 frames,
+        float* coefficients,
+        float* state,
+        EnvelopeModeTypes mode) const
+    {
+        if (channels < 4)
+        {
+            math_mmx::process_envelope_bank_float(src_buffer, dst_buffer, channels, frames,
+                coefficients, state, mode);
+        }
+        else
+        {
+            const disable_sse_denormals disable_denormals;
+
+            // Every lane follows the envelope of one channel, all the groups of
+            // channels are walked each frame as the biquad banks do
+            const uint32 vector_channels = channels & ~3;
+
+            for (uint32 frame = 0; frame < frames; ++frame)
+            {
+                const float* src = src_buffer + frame * channels;
+                float* dst = dst_buffer + frame * channels;
+
+                for (uint32 c = 0; c < vector_channels; c += 4)
+                {
+                    const __m128 value = _mm_loadu_ps(src + c);
+                    const __m128 level = mode == RMS_ENVELOPE ? _mm_mul_ps(value, value) : abs_ps(value);
+                    __m128 envelope = _mm_loadu_ps(state + c);
+
+                    const __m128 coefficient = select_greater_ps(level, envelope,
+                        _mm_loadu_ps(coefficients + c), _mm_loadu_ps(coefficients + channels + c));
+
+                    envelope = _mm_add_ps(envelope, _mm_mul_ps(coefficient, _mm_sub_ps(level, envelope)));
+
+                    _mm_storeu_ps(state + c, envelope);
+                    _mm_storeu_ps(dst + c, mode == RMS_ENVELOPE ? _mm_sqrt_ps(envelope) : envelope);
+                }
+            }
+
+            // Handle the leftover channels
+            envelope_bank_generic(src_buffer, dst_buffer, channels, frames,
+                coefficients, state, mode, vector_channels);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    void compressor_gain_buffer_float(
+        float* src_buffer,
+        float* dst_buffer,
+        uint32 size,
+        float threshold,
+        float ratio,
+        float knee) const
+    {
+        assert(ratio > float(0));
+
+        const disable_sse_denormals disable_denormals;
+
+        const float width = knee > float(0) ? knee : float(0);
+        const __m128 vthreshold = _mm_set1_ps(threshold);
+        const __m128 vslope = _mm_set1_ps(float(1) / ratio - float(1));
+        const __m128 vhalf_knee = _mm_set1_ps(width * float(0.5));
+        const __m128 vwidth = _mm_set1_ps(width);
+        const __m128 vknee_scale = _mm_set1_ps(knee > float(0) ? float(1) / (float(2) * knee) : float(0));
+        const __m128 vzero = _mm_set1_ps(float(0));
+
+        const uint32 vector_samples = size & ~3;
+        for (uint32 i = 0; i < vector_samples; i += 4)
+        {
+            const __m128 over = _mm_sub_ps(_mm_loadu_ps(src_buffer + i), vthreshold);
+            const __m128 above = _mm_max_ps(_mm_sub_ps(over, vhalf_knee), vzero);
+            const __m128 bent = _mm_min_ps(_mm_max_ps(_mm_add_ps(over, vhalf_knee), vzero), vwidth);
+
+            _mm_storeu_ps(dst_buffer + i, _mm_mul_ps(vslope,
+                _mm_add_ps(_mm_mul_ps(_mm_mul_ps(bent, bent), vknee_scale), above)));
+        }
+
+        // Handle the leftovers
+        compressor_gain_generic(src_buffer, dst_buffer, size, threshold, ratio, knee, vector_samples);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void limiter_gain_buffer_float(
+        float* src_buffer,
+        float* dst_buffer,
+        uint32 size,
+        float threshold) const
+    {
+        assert(threshold > float(0));
+
+        const disable_sse_denormals disable_denormals;
+
+        const __m128 vthreshold = _mm_set1_ps(threshold);
+
+        const uint32 vector_samples = size & ~3;
+        for (uint32 i = 0; i < vector_samples; i += 4)
+        {
+            _mm_storeu_ps(dst_buffer + i, _mm_div_ps(vthreshold, _mm_max_ps(_mm_loadu_ps(src_buffer + i), vthreshold)));
+        }
+
+        // Handle the leftovers
+        limiter_gain_generic(src_buffer, dst_buffer, size, threshold, vector_samples);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void soft_clip_buffer_float(
+        float* src_buffer,
+        float* dst_buffer,
+        uint32 size) const
+    {
+        const disable_sse_denormals disable_denormals;
+
+        const __m128 vlimit = _mm_set1_ps(float(3));
+        const __m128 vnegative_limit = _mm_set1_ps(float(-3));
+        const __m128 vnumerator = _mm_set1_ps(float(27));
+        const __m128 vdenominator = _mm_set1_ps(float(9));
+
+        const uint32 vector_samples = size & ~3;
+        for (uint32 i = 0; i < vector_samples; i += 4)
+        {
+            const __m128 value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src_buffer + i), vnegative_limit), vlimit);
+            const __m128 square = _mm_mul_ps(value, value);
+
+            _mm_storeu_ps(dst_buffer + i, _mm_div_ps(_mm_mul_ps(value, _mm_add_ps(vnumerator, square)),
+                _mm_add_ps(vnumerator, _mm_mul_ps(vdenominator, square))));
+        }
+
+        // Handle the leftovers
+        soft_clip_generic(src_buffer, dst_buffer, size, vector_samples);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void premultiply_rgba_float(
+        float* src_buffer,
+        float* dst_buffer,
+        uint32 pixels) const
+    {
+        const disable_sse_denormals disable_denormals;
+
+        const __m128 alpha_mask = alpha_mask_ps();
+
+        // One pixel per register
+        for (uint32 i = 0; i < pixels; ++i)
+        {
+            const __m128 pixel = _mm_loadu_ps(src_buffer + i * 4);
+
+            _mm_storeu_ps(dst_buffer + i * 4, merge_alpha_ps(_mm_mul_ps(pixel, alpha_ps(pixel)), pixel, alpha_mask));
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void unpremultiply_rgba_float(
+        float* src_buffer,
+        float* dst_buffer,
+        uint32 pixels) const
+    {
+        const disable_sse_denormals disable_denormals;
+
+        const __m128 alpha_mask = alpha_mask_ps();
+        const __m128 vzero = _mm_setzero_ps();
+        const __m128 vone = _mm_set1_ps(1.0f);
+
+        for (uint32 i = 0; i < pixels; ++i)
+        {
+            const __m128 pixel = _mm_loadu_ps(src_buffer + i * 4);
+            const __m128 alpha = alpha_ps(pixel);
+
+            // Transparent pixels divide by one and are cleared after
+            const __m128 opaque = _mm_cmpneq_ps(alpha, vzero);
+            const __m128 colour = _mm_and_ps(opaque, _mm_div_ps(pixel,
+                _mm_or_ps(_mm_and_ps(opaque, alpha), _mm_andnot_ps(opaque, vone))));
+
+            _mm_storeu_ps(dst_buffer + i * 4, merge_alpha_ps(colour, pixel, alpha_mask));
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // the pixels of the source and backdrop one at a time into the composited
+    // expression
+    #define math_sse_composite_loop(expression) \
+        for (uint32 i = 0; i < pixels; ++i) \
+        { \
+            const __m128 s = _mm_loadu_ps(src_buffer + i * 4); \
+            const __m128 d = _mm_loadu_ps(backdrop_buffer + i * 4); \
+            \
+            _mm_storeu_ps(dst_buffer + i * 4, expression); \
+        }
+
+    void composite_rgba_float(
+        float* src_buffer,
+        float* backdrop_buffer,
+        float* dst_buffer,
+        uint32 pixels,
+        CompositeModeTypes mode) const
+    {
+        const disable_sse_denormals disable_denormals;
+
+        const __m128 vone = _mm_set1_ps(1.0f);
+        const __m128 vtwo = _mm_set1_ps(2.0f);
+
+        switch (mode)
+        {
+        case MULTIPLY_COMPOSITE:
+            math_sse_composite_loop(multiply_pixel_ps(s, d, alpha_ps(s), alpha_ps(d), vone))
+            break;
+
+        case SCREEN_COMPOSITE:
+            math_sse_composite_loop(screen_pixel_ps(s, d))
+            break;
+
+        case OVERLAY_COMPOSITE:
+            math_sse_composite_loop(overlay_pixel_ps(s, d, alpha_ps(s), alpha_ps(d), vone, vtwo))
+            break;
+
+        case ADD_COMPOSITE:
+            math_sse_composite_loop(_mm_min_ps(_mm_add_ps(s, d), vone))
+            break;
+
+        default:
+        {
+            const uint32 source = porter_duff_factor(mode, true);
+            const uint32 backdrop = porter_duff_factor(mode, false);
+            const __m128 source_offset = _mm_set1_ps(pixel_factor_offset(source));
+            const __m128 source_scale = _mm_set1_ps(pixel_factor_scale(source));
+            const __m128 backdrop_offset = _mm_set1_ps(pixel_factor_offset(backdrop));
+            const __m128 backdrop_scale = _mm_set1_ps(pixel_factor_scale(backdrop));
+
+            math_sse_composite_loop(_mm_add_ps(
+                _mm_mul_ps(s, _mm_add_ps(source_offset, _mm_mul_ps(source_scale, alpha_ps(d)))),
+                _mm_mul_ps(d, _mm_add_ps(backdrop_offset, _mm_mul_ps(backdrop_scale, alpha_ps(s))))))
+            break;
+        }
+        }
+    }
+
+protected:
+
+    //--------------------------------------------------------------------------
+
+    void stereo_gain_buffers_float(
+        float* src_left_buffer,
+        float* src_right_buffer,
+        float* dst_left_buffer,
+        float* dst_right_buffer,
+        uint32 size,
+        float left_gain,
+        float right_gain) const
+    {
+        const ptrdiff_t align_bytes =
+            ((ptrdiff_t)dst_left_buffer & SSE_ALIGN);
+
+        if (size < SSE_MIN_SAMPLES ||
+            align_bytes != ((ptrdiff_t)dst_right_buffer & SSE_ALIGN) ||
+            align_bytes != ((ptrdiff_t)src_left_buffer & SSE_ALIGN) ||
+            align_bytes != ((ptrdiff_t)src_right_buffer & SSE_ALIGN))
+        {
+            math_mmx::stereo_gain_buffers_float(src_left_buffer, src_right_buffer,
+                dst_left_buffer, dst_right_buffer, size, left_gain, right_gain);
+        }
+        else
+        {
+            assert(size >= SSE_MIN_SIZE);
+
+            const disable_sse_denormals disable_denormals;
+
+            const uint32 vector_size = 16 / sizeof(float);
+
+            // Scale unaligned head
+            const uint32 head_count = (uint32)(((SSE_ALIGN + 1) - align_bytes)
+                & SSE_ALIGN) / sizeof(float);
+            stereo_gain_generic(src_left_buffer, src_right_buffer,
+                dst_left_buffer, dst_right_buffer, head_count, left_gain, right_gain);
+
+            // Scale both channels with simd
+            const __m128 vleft_gain = _mm_set1_ps(left_gain);
+            const __m128 vright_gain = _mm_set1_ps(right_gain);
+            __m128* vector_src_left = (__m128*)(src_left_buffer + head_count);
+            __m128* vector_src_right = (__m128*)(src_right_buffer + head_count);
+            __m128* vector_dst_left = (__m128*)(dst_left_buffer + head_count);
+            __m128* vector_dst_right = (__m128*)(dst_right_buffer + head_count);
+
+            uint32 vector_count = (size - head_count) / vector_size;
+            const uint32 index = head_count + vector_count * vector_size;
+            while (vector_count--)
+            {
+                const __m128 vleft = *vector_src_left++;
+                const __m128 vright = *vector_src_right++;
+
+                *vector_dst_left++ = _mm_mul_ps(vleft, vleft_gain);
+                *vector_dst_right++ = _mm_mul_ps(vright, vright_gain);
+            }
+
+            // Handle any unaligned leftovers
+            stereo_gain_generic(src_left_buffer + index, src_right_buffer + index,
+                dst_left_buffer + index, dst_right_buffer + index, size - index,
+                left_gain, right_gain);
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void ramp_stereo_gain_buffers_float(
+        float* src_left_buffer,
+        float* src_right_buffer,
+        float* dst_left_buffer,
+        float* dst_right_buffer,
+        uint32 size,
+        float left_gain,
+        float left_increment,
+        float right_gain,
+        float right_increment) const
+    {
+        const ptrdiff_t align_bytes =
+            ((ptrdiff_t)dst_left_buffer & SSE_ALIGN);
+
+        if (size < SSE_MIN_SAMPLES ||
+            align_bytes != ((ptrdiff_t)dst_right_buffer & SSE_ALIGN) ||
+            align_bytes != ((ptrdiff_t)src_left_buffer & SSE_ALIGN) ||
+            align_bytes != ((ptrdiff_t)src_right_buffer & SSE_ALIGN))
+        {
+            math_mmx::ramp_stereo_gain_buffers_float(src_left_buffer, src_right_buffer,
+                dst_left_buffer, dst_right_buffer, size,
+                left_gain, left_increment, right_gain, right_increment);
+        }
+        else
+        {
+            assert(size >= SSE_MIN_SIZE);
+
+            const disable_sse_denormals disable_denormals;
+
+            const uint32 vector_size = 16 / sizeof(float);
+
+            // Ramp unaligned head
+            const uint32 head_count = (uint32)(((SSE_ALIGN + 1) - align_bytes)
+                & SSE_ALIGN) / sizeof(float);
+            ramp_stereo_gain_generic(src_left_buffer, src_right_buffer,
+                dst_left_buffer, dst_right_buffer, head_count,
+                left_gain, left_increment, right_gain, right_increment, 0);
+
+            // Ramp both channels with simd, sharing the sample indices
+            float lanes[16 / sizeof(float)];
+            ramp_index_lanes(lanes, vector_size, head_count);
+
+            const __m128 vleft_gain = _mm_set1_ps(left_gain);
+            const __m128 vleft_increment = _mm_set1_ps(left_increment);
+            const __m128 vright_gain = _mm_set1_ps(right_gain);
+            const __m128 vright_increment = _mm_set1_ps(right_increment);
+            const __m128 vstep = _mm_set1_ps((float)vector_size);
+            __m128 vindex = _mm_loadu_ps(lanes);
+            __m128* vector_src_left = (__m128*)(src_left_buffer + head_count);
+            __m128* vector_src_right = (__m128*)(src_right_buffer + head_count);
+            __m128* vector_dst_left = (__m128*)(dst_left_buffer + head_count);
+            __m128* vector_dst_right = (__m128*)(dst_right_buffer + head_count);
+
+            uint32 vector_count = (size - head_count) / vector_size;
+            const uint32 index = head_count + vector_count * vector_size;
+            while (vector_count--)
+            {
+                const __m128 vleft = *vector_src_left++;
+                const __m128 vright = *vector_src_right++;
+
+                *vector_dst_left++ = _mm_mul_ps(vleft,
+                    _mm_add_ps(vleft_gain, _mm_mul_ps(vleft_increment, vindex)));
+                *vector_dst_right++ = _mm_mul_ps(vright,
+                    _mm_add_ps(vright_gain, _mm_mul_ps(vright_increment, vindex)));
+                vindex = _mm_add_ps(vindex, vstep);
+            }
+
+            // Handle any unaligned leftovers
+            ramp_stereo_gain_generic(src_left_buffer + index, src_right_buffer + index,
+                dst_left_buffer + index, dst_right_buffer + index, size - index,
+                left_gain, left_increment, right_gain, right_increment, index);
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void mix_gain_buffers_float(
+        float* src_buffer_a,
+        float* src_buffer_b,
+        float* dst_buffer,
+        uint32 size,
+        float gain_a,
+        float gain_b) const
+    {
+        const ptrdiff_t align_bytes =
+            ((ptrdiff_t)dst_buffer & SSE_ALIGN);
+
+        if (size < SSE_MIN_SAMPLES ||
+            align_bytes != ((ptrdiff_t)src_buffer_a & SSE_ALIGN) ||
+            align_bytes != ((ptrdiff_t)src_buffer_b & SSE_ALIGN))
+        {
+            math_mmx::mix_gain_buffers_float(src_buffer_a, src_buffer_b,
+                dst_buffer, size, gain_a, gain_b);
+        }
+        else
+        {
+            assert(size >= SSE_MIN_SIZE);
+
+            const disable_sse_denormals disable_denormals;
+
+            const uint32 vector_size = 16 / sizeof(float);
+
+            // Mix unaligned head
+            const uint32 head_count = (uint32)(((SSE_ALIGN + 1) - align_bytes)
+                & SSE_ALIGN) / sizeof(float);
+            mix_gain_generic(src_buffer_a, src_buffer_b, dst_buffer, head_count,
+                gain_a, gain_b);
+
+            // Mix with simd
+            const __m128 vgain_a = _mm_set1_ps(gain_a);
+            const __m128 vgain_b = _mm_set1_ps(gain_b);
+            __m128* vector_buffer_a = (__m128*)(src_buffer_a + head_count);
+            __m128* vector_buffer_b = (__m128*)(src_buffer_b + head_count);
+            __m128* vector_dst_buffer = (__m128*)(dst_buffer + head_count);
+
+            uint32 vector_count = (size - head_count) / vector_size;
+            const uint32 index = head_count + vector_count * vector_size;
+            while (vector_count--)
+            {
+                *vector_dst_buffer++ = _mm_add_ps(
+                    _mm_mul_ps(*vector_buffer_a++, vgain_a),
+                    _mm_mul_ps(*vector_buffer_b++, vgain_b));
+            }
+
+            // Handle any unaligned leftovers
+            mix_gain_generic(src_buffer_a + index, src_buffer_b + index,
+                dst_buffer + index, size - index, gain_a, gain_b);
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void ramp_mix_gain_buffers_float(
+        float* src_buffer_a,
+        float* src_buffer_b,
+        float* dst_buffer,
+        uint32 size,
+        float gain_a,
+        float increment_a,
+        float gain_b,
+        float increment_b) const
+    {
+        const ptrdiff_t align_bytes =
+            ((ptrdiff_t)dst_buffer & SSE_ALIGN);
+
+        if (size < SSE_MIN_SAMPLES ||
+            align_bytes != ((ptrdiff_t)src_buffer_a & SSE_ALIGN) ||
+            align_bytes != ((ptrdiff_t)src_buffer_b & SSE_ALIGN))
+        {
+            math_mmx::ramp_mix_gain_buffers_float(src_buffer_a, src_buffer_b,
+                dst_buffer, size, gain_a, increment_a, gain_b, increment_b);
+        }
+        else
+        {
+            assert(size >= SSE_MIN_SIZE);
+
+            const disable_sse_denormals disable_denormals;
+
+            const uint32 vector_size = 16 / sizeof(float);
+
+            // Mix unaligned head
+            const uint32 head_count = (uint32)(((SSE_ALIGN + 1) - align_bytes)
+                & SSE_ALIGN) / sizeof(float);
+            ramp_mix_gain_generic(src_buffer_a, src_buffer_b, dst_buffer, head_count,
+                gain_a, increment_a, gain_b, increment_b, 0);
+
+            // Mix with simd, both gains share the sample indices
+            float lanes[16 / sizeof(float)];
+            ramp_index_lanes(lanes, vector_size, head_count);
+
+            const __m128 vgain_a = _mm_set1_ps(gain_a);
+            const __m128 vincrement_a = _mm_set1_ps(increment_a);
+            const __m128 vgain_b = _mm_set1_ps(gain_b);
+            const __m128 vincrement_b = _mm_set1_ps(increment_b);
+            const __m128 vstep = _mm_set1_ps((float)vector_size);
+            __m128 vindex = _mm_loadu_ps(lanes);
+            __m128* vector_buffer_a = (__m128*)(src_buffer_a + head_count);
+            __m128* vector_buffer_b = (__m128*)(src_buffer_b + head_count);
+            __m128* vector_dst_buffer = (__m128*)(dst_buffer + head_count);
+
+            uint32 vector_count = (size - head_count) / vector_size;
+            const uint32 index = head_count + vector_count * vector_size;
+            while (vector_count--)
+            {
+                *vector_dst_buffer++ = _mm_add_ps(
+                    _mm_mul_ps(*vector_buffer_a++,
+                        _mm_add_ps(vgain_a, _mm_mul_ps(vincrement_a, vindex))),
+                    _mm_mul_ps(*vector_buffer_b++,
+                        _mm_add_ps(vgain_b, _mm_mul_ps(vincrement_b, vindex))));
+                vindex = _mm_add_ps(vindex, vstep);
+            }
+
+            // Handle any unaligned leftovers
+            ramp_mix_gain_generic(src_buffer_a + index, src_buffer_b + index,
+                dst_buffer + index, size - index,
+                gain_a, increment_a, gain_b, increment_b, index);
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void fft_radix4_pass_float(
+        float* real_buffer,
+        float* imag_buffer,
+        uint32 size,
+        uint32 span,
+        const float* twiddles) const
+    {
+        if (span == 1 && size >= 16)
+        {
+            const disable_sse_denormals disable_denormals;
+
+            // Four groups at once, transposed so every register holds the
+            // same quarter of each group
+            for (uint32 group = 0; group < size; group += 16)
+            {
+                float* real = real_buffer + group;
+                float* imag = imag_buffer + group;
+
+                __m128 a_real = _mm_loadu_ps(real);
+                __m128 b_real = _mm_loadu_ps(real + 4);
+                __m128 c_real = _mm_loadu_ps(real + 8);
+                __m128 d_real = _mm_loadu_ps(real + 12);
+                __m128 a_imag = _mm_loadu_ps(imag);
+                __m128 b_imag = _mm_loadu_ps(imag + 4);
+                __m128 c_imag = _mm_loadu_ps(imag + 8);
+                __m128 d_imag = _mm_loadu_ps(imag + 12);
+
+                _MM_TRANSPOSE4_PS(a_real, b_real, c_real, d_real);
+                _MM_TRANSPOSE4_PS(a_imag, b_imag, c_imag, d_imag);
+
+                const __m128 t0_real = _mm_add_ps(a_real, b_real);
+                const __m128 t0_imag = _mm_add_ps(a_imag, b_imag);
+                const __m128 t1_real = _mm_sub_ps(a_real, b_real);
+                const __m128 t1_imag = _mm_sub_ps(a_imag, b_imag);
+                const __m128 t2_real = _mm_add_ps(c_real, d_real);
+                const __m128 t2_imag = _mm_add_ps(c_imag, d_imag);
+                const __m128 t3_real = _mm_sub_ps(c_real, d_real);
+                const __m128 t3_imag = _mm_sub_ps(c_imag, d_imag);
+
+                a_real = _mm_add_ps(t0_real, t2_real);
+                a_imag = _mm_add_ps(t0_imag, t2_imag);
+                b_real = _mm_add_ps(t1_real, t3_imag);
+                b_imag = _mm_sub_ps(t1_imag, t3_real);
+                c_real = _mm_sub_ps(t0_real, t2_real);
+                c_imag = _mm_sub_ps(t0_imag, t2_imag);
+                d_real = _mm_sub_ps(t1_real, t3_imag);
+                d_imag = _mm_add_ps(t1_imag, t3_real);
+
+                _MM_TRANSPOSE4_PS(a_real, b_real, c_real, d_real);
+                _MM_TRANSPOSE4_PS(a_imag, b_imag, c_imag, d_imag);
+
+                _mm_storeu_ps(real, a_real);
+                _mm_storeu_ps(real + 4, b_real);
+                _mm_storeu_ps(real + 8, c_real);
+                _mm_storeu_ps(real + 12, d_real);
+                _mm_storeu_ps(imag, a_imag);
+                _mm_storeu_ps(imag + 4, b_imag);
+                _mm_storeu_ps(imag + 8, c_imag);
+                _mm_storeu_ps(imag + 12, d_imag);
+            }
+        }
+        else if (span < 4)
+        {
+            math_mmx::fft_radix4_pass_float(real_buffer, imag_buffer, size, span, twiddles);
+        }
+        else
+        {
+            const disable_sse_denormals disable_denormals;
+
+            // Every lane runs the butterfly of one k, the spans are multiples
+            // of the register so there are no leftovers
+            for (uint32 group = 0; group < size; group += 4 * span)
+            {
+                float* real = real_buffer + group;
+                float* imag = imag_buffer + group;
+
+                for (uint32 k = 0; k < span; k += 4)
+                {
+                    const __m128 w1_real = _mm_loadu_ps(twiddles + k);
+                    const __m128 w1_imag = _mm_loadu_ps(twiddles + span + k);
+                    const __m128 w2_real = _mm_loadu_ps(twiddles + 2 * span + k);
+                    const __m128 w2_imag = _mm_loadu_ps(twiddles + 3 * span + k);
+                    const __m128 w3_real = _mm_loadu_ps(twiddles + 4 * span + k);
+                    const __m128 w3_imag = _mm_loadu_ps(twiddles + 5 * span + k);
+
+                    const __m128 a_real = _mm_loadu_ps(real + k);
+                    const __m128 a_imag = _mm_loadu_ps(imag + k);
+                    const __m128 x1_real = _mm_loadu_ps(real + span + k);
+                    const __m128 x1_imag = _mm_loadu_ps(imag + span + k);
+                    const __m128 x2_real = _mm_loadu_ps(real + 2 * span + k);
+                    const __m128 x2_imag = _mm_loadu_ps(imag + 2 * span + k);
+                    const __m128 x3_real = _mm_loadu_ps(real + 3 * span + k);
+                    const __m128 x3_imag = _mm_loadu_ps(imag + 3 * span + k);
+
+                    const __m128 b_real = _mm_sub_ps(_mm_mul_ps(x1_real, w2_real), _mm_mul_ps(x1_imag, w2_imag));
+                    const __m128 b_imag = _mm_add_ps(_mm_mul_ps(x1_real, w2_imag), _mm_mul_ps(x1_imag, w2_real));
+                    const __m128 c_real = _mm_sub_ps(_mm_mul_ps(x2_real, w1_real), _mm_mul_ps(x2_imag, w1_imag));
+                    const __m128 c_imag = _mm_add_ps(_mm_mul_ps(x2_real, w1_imag), _mm_mul_ps(x2_imag, w1_real));
+                    const __m128 d_real = _mm_sub_ps(_mm_mul_ps(x3_real, w3_real), _mm_mul_ps(x3_imag, w3_imag));
+                    const __m128 d_imag = _mm_add_ps(_mm_mul_ps(x3_real, w3_imag), _mm_mul_ps(x3_imag, w3_real));
+
+                    const __m128 t0_real = _mm_add_ps(a_real, b_real);
+                    const __m128 t0_imag = _mm_add_ps(a_imag, b_imag);
+                    const __m128 t1_real = _mm_sub_ps(a_real, b_real);
+                    const __m128 t1_imag = _mm_sub_ps(a_imag, b_imag);
+                    const __m128 t2_real = _mm_add_ps(c_real, d_real);
+                    const __m128 t2_imag = _mm_add_ps(c_imag, d_imag);
+                    const __m128 t3_real = _mm_sub_ps(c_real, d_real);
+                    const __m128 t3_imag = _mm_sub_ps(c_imag, d_imag);
+
+                    _mm_storeu_ps(real + k, _mm_add_ps(t0_real, t2_real));
+                    _mm_storeu_ps(imag + k, _mm_add_ps(t0_imag, t2_imag));
+                    _mm_storeu_ps(real + span + k, _mm_add_ps(t1_real, t3_imag));
+                    _mm_storeu_ps(imag + span + k, _mm_sub_ps(t1_imag, t3_real));
+                    _mm_storeu_ps(real + 2 * span + k, _mm_sub_ps(t0_real, t2_real));
+                    _mm_storeu_ps(imag + 2 * span + k, _mm_sub_ps(t0_imag, t2_imag));
+                    _mm_storeu_ps(real + 3 * span + k, _mm_sub_ps(t1_real, t3_imag));
+                    _mm_storeu_ps(imag + 3 * span + k, _mm_add_ps(t1_imag, t3_real));
+                }
+            }
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    void convolve_row_float(
+        float* src_buffer,
+        float* dst_buffer,
+        uint32 width,
+        float* kernel,
+        uint32 kernel_size) const
+    {
+        // the pixels from center to end have their whole window in the row
+        const uint32 center = kernel_size / 2;
+        const uint32 end = width + center + 1 > kernel_size ? width + center + 1 - kernel_size : 0;
+
+        if (end < center + 4)
+        {
+            math_mmx::convolve_row_float(src_buffer, dst_buffer, width, kernel, kernel_size);
+            return;
+        }
+
+        const disable_sse_denormals disable_denormals;
+
+        convolve_row_generic(src_buffer, dst_buffer, width, kernel, kernel_size, 0, center);
+
+        uint32 i = center;
+        for (; i + 16 <= end; i += 16)
+        {
+            const float* window = src_buffer + i - center;
+            __m128 sum0 = _mm_setzero_ps();
+            __m128 sum1 = _mm_setzero_ps();
+            __m128 sum2 = _mm_setzero_ps();
+            __m128 sum3 = _mm_setzero_ps();
+
+            for (uint32 k = 0; k < kernel_size; ++k)
+            {
+                const __m128 coefficient = _mm_set1_ps(kernel[k]);
+
+                sum0 = _mm_add_ps(sum0, _mm_mul_ps(coefficient, _mm_loadu_ps(window + k)));
+                sum1 = _mm_add_ps(sum1, _mm_mul_ps(coefficient, _mm_loadu_ps(window + k + 4)));
+                sum2 = _mm_add_ps(sum2, _mm_mul_ps(coefficient, _mm_loadu_ps(window + k + 8)));
+                sum3 = _mm_add_ps(sum3, _mm_mul_ps(coefficient, _mm_loadu_ps(window + k + 12)));
+            }
+
+            _mm_storeu_ps(dst_buffer + i, sum0);
+            _mm_storeu_ps(dst_buffer + i + 4, sum1);
+            _mm_storeu_ps(dst_buffer + i + 8, sum2);
+            _mm_storeu_ps(dst_buffer + i + 12, sum3);
+        }
+
+        for (; i + 4 <= end; i += 4)
+        {
+            const float* window = src_buffer + i - center;
+            __m128 sum = _mm_setzero_ps();
+
+            for (uint32 k = 0; k < kernel_size; ++k)
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(kernel[k]), _mm_loadu_ps(window + k)));
+
+            _mm_storeu_ps(dst_buffer + i, sum);
+        }
+
+        // Handle the right edge and the leftover pixels
+        convolve_row_generic(src_buffer, dst_buffer, width, kernel, kernel_size, i, width);
+    }
+
+    //--------------------------------------------------------------------------
+
+    void convolve_column_tile_float(
+        float* src_buffer,
+        uint32 src_stride,
+        float* dst_buffer,
+        uint32 dst_stride,
+        uint32 columns,
+        uint32 height,
+        float* kernel,
+        uint32 kernel_size) const
+    {
+        const disable_sse_denormals disable_denormals;
+
+        const int32 center = int32(kernel_size / 2);
+        const uint32 vector_columns = columns & ~3;
+
+        for (uint32 row = 0; row < height; ++row)
+        {
+            float* dst_row = dst_buffer + row * dst_stride;
+
+            uint32 i = 0;
+            for (; i + 16 <= vector_columns; i += 16)
+            {
+                __m128 sum0 = _mm_setzero_ps();
+                __m128 sum1 = _mm_setzero_ps();
+                __m128 sum2 = _mm_setzero_ps();
+                __m128 sum3 = _mm_setzero_ps();
+
+                for (uint32 k = 0; k < kernel_size; ++k)
+                {
+                    const float* src_row = image_row(src_buffer, src_stride, int32(row + k) - center, height) + i;
+                    const __m128 coefficient = _mm_set1_ps(kernel[k]);
+
+                    sum0 = _mm_add_ps(sum0, _mm_mul_ps(coefficient, _mm_loadu_ps(src_row)));
+                    sum1 = _mm_add_ps(sum1, _mm_mul_ps(coefficient, _mm_loadu_ps(src_row + 4)));
+                    sum2 = _mm_add_ps(sum2, _mm_mul_ps(coefficient, _mm_loadu_ps(src_row + 8)));
+                    sum3 = _mm_add_ps(sum3, _mm_mul_ps(coefficient, _mm_loadu_ps(src_row + 12)));
+                }
+
+                _mm_storeu_ps(dst_row + i, sum0);
+                _mm_storeu_ps(dst_row + i + 4, sum1);
+                _mm_storeu_ps(dst_row + i + 8, sum2);
+                _mm_storeu_ps(dst_row + i + 12, sum3);
+            }
+
+            for (; i < vector_columns; i += 4)
+            {
+                __m128 sum = _mm_setzero_ps();
+
+                for (uint32 k = 0; k < kernel_size; ++k)
+                {
+                    const float* src_row = image_row(src_buffer, src_stride, int32(row + k) - center, height) + i;
+
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(kernel[k]), _mm_loadu_ps(src_row)));
+                }
+
+                _mm_storeu_ps(dst_row + i, sum);
+            }
+        }
+
+        // Handle the leftover columns
+        convolve_column_tile_generic(src_buffer, src_stride, dst_buffer, dst_stride,
+            columns, height, kernel, kernel_size, vector_columns);
+    }
+
+    //--------------------------------------------------------------------------
+
+    void box_blur_row_float(
+        float* src_buffer,
+        float* dst_buffer,
+        uint32 width,
+        uint32 radius) const
+    {
+        // the running sum of the pixels from begin to end adds and removes
+        // pixels inside the row, a register of them is one prefix sum of the
+        // differences
+        const uint32 begin = radius + 1;
+        const uint32 end = width > radius ? width - radius : 0;
+
+        if (end < begin + 4)
+        {
+            math_mmx::box_blur_row_float(src_buffer, dst_buffer, width, radius);
+            return;
+        }
+
+        const disable_sse_denormals disable_denormals;
+
+        box_blur_row_generic(src_buffer, dst_buffer, width, radius, 0, begin);
+
+        const __m128 scale = _mm_set1_ps(1.0f / float(2 * radius + 1));
+        const __m128 zero = _mm_setzero_ps();
+        __m128 sum = _mm_set1_ps(box_window_sum(src_buffer, width, radius, radius));
+
+        uint32 i = begin;
+        for (; i + 4 <= end; i += 4)
+        {
+            __m128 delta = _mm_sub_ps(_mm_loadu_ps(src_buffer + i + radius),
+                _mm_loadu_ps(src_buffer + i - radius - 1));
+
+            delta = _mm_add_ps(delta, _mm_move_ss(_mm_shuffle_ps(delta, delta, _MM_SHUFFLE(2, 1, 0, 0)), zero));
+            delta = _mm_add_ps(delta, _mm_movelh_ps(zero, delta));
+
+            sum = _mm_add_ps(sum, delta);
+            _mm_storeu_ps(dst_buffer + i, _mm_mul_ps(sum, scale));
+            sum = _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(3, 3, 3, 3));
+        }
+
+        // Handle the right edge and the leftover pixels
+        box_blur_row_generic(src_buffer, dst_buffer, width, radius, i, width);
+    }
+
+    //--------------------------------------------------------------------------
+
+    void box_blur_column_tile_float(
+        float* src_buffer,
+        uint32 src_stride,
+        float* dst_buffer,
+        uint32 dst_stride,
+        uint32 columns,
+        uint32 height,
+        uint32 radius) const
+    {
+        assert(columns <= image_tile_columns);
+
+        const disable_sse_denormals disable_denormals;
+
+        const __m128 scale = _mm_set1_ps(1.0f / float(2 * radius + 1));
+        const uint32 vector_columns = columns & ~3;
+        float sums[image_tile_columns];
+
+        for (uint32 i = 0; i < vector_columns; i += 4)
+            _mm_storeu_ps(sums + i, _mm_setzero_ps());
+
+        for (int32 k = -int32(radius); k <= int32(radius); ++k)
+        {
+            const float* src_row = image_row(src_buffer, src_stride, k, height);
+
+            for (uint32 i = 0; i < vector_columns; i += 4)
+                _mm_storeu_ps(sums + i, _mm_add_ps(_mm_loadu_ps(sums + i), _mm_loadu_ps(src_row + i)));
+        }
+
+        for (uint32 row = 0; row < height; ++row)
+        {
+            const float* add_row = image_row(src_buffer, src_stride, int32(row + radius + 1), height);
+            const float* sub_row = image_row(src_buffer, src_stride, int32(row) - int32(radius), height);
+            float* dst_row = dst_buffer + row * dst_stride;
+
+            for (uint32 i = 0; i < vector_columns; i += 4)
+            {
+                const __m128 sum = _mm_loadu_ps(sums + i);
+
+                _mm_storeu_ps(dst_row + i, _mm_mul_ps(sum, scale));
+                _mm_storeu_ps(sums + i, _mm_add_ps(sum, _mm_sub_ps(_mm_loadu_ps(add_row + i), _mm_loadu_ps(sub_row + i))));
+            }
+        }
+
+        // Handle the leftover columns
+        box_blur_column_tile_generic(src_buffer, src_stride, dst_buffer, dst_stride,
+            columns, height, radius, vector_columns);
+    }
+
+    //--------------------------------------------------------------------------
+
+    void resize_row_float(
+        float* src_buffer,
+        float* dst_buffer,
+        uint32 width,
+        uint32 channels,
+        float* coefficients,
+        uint32 taps,
+        uint32* offsets) const
+    {
+        if (channels == 4)
+        {
+            const disable_sse_denormals disable_denormals;
+
+            // a register holds the four channels of a pixel
+            for (uint32 i = 0; i < width; ++i)
+            {
+                const float* window = src_buffer + offsets[i] * 4;
+                const float* coefficient = coefficients + i * taps;
+                __m128 sum = _mm_setzero_ps();
+
+                for (uint32 k = 0; k < taps; ++k)
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(coefficient[k]), _mm_loadu_ps(window + k * 4)));
+
+                _mm_storeu_ps(dst_buffer + i * 4, sum);
+            }
+        }
+        else if (channels == 1 && taps >= 4)
+        {
+            const disable_sse_denormals disable_denormals;
+
+            const uint32 vector_taps = taps & ~3;
+
+            for (uint32 i = 0; i < width; ++i)
+            {
+                const float* window = src_buffer + offsets[i];
+                const float* coefficient = coefficients + i * taps;
+                __m128 sum = _mm_setzero_ps();
+
+                for (uint32 k = 0; k < vector_taps; k += 4)
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(coefficient + k), _mm_loadu_ps(window + k)));
+
+                float sums[4];
+                _mm_storeu_ps(sums, sum);
+
+                // Handle the leftover taps
+                dst_buffer[i] = polyphase_row_generic(window, coefficient, vector_taps, taps,
+                    (sums[0] + sums[1]) + (sums[2] + sums[3]));
+            }
+        }
+        else
+        {
+            math_mmx::resize_row_float(src_buffer, dst_buffer, width, channels, coefficients, taps, offsets);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    void resize_column_tile_float(
+        float* src_buffer,
+        uint32 src_stride,
+        float* dst_buffer,
+        uint32 dst_stride,
+        uint32 columns,
+        uint32 height,
+        float* coefficients,
+        uint32 taps,
+        uint32* offsets) const
+    {
+        const disable_sse_denormals disable_denormals;
+
+        const uint32 vector_columns = columns & ~3;
+
+        for (uint32 row = 0; row < height; ++row)
+        {
+            const float* window = src_buffer + offsets[row] * src_stride;
+            const float* coefficient = coefficients + row * taps;
+            float* dst_row = dst_buffer + row * dst_stride;
+
+            uint32 i = 0;
+            for (; i + 16 <= vector_columns; i += 16)
+            {
+                __m128 sum0 = _mm_setzero_ps();
+                __m128 sum1 = _mm_setzero_ps();
+                __m128 sum2 = _mm_setzero_ps();
+                __m128 sum3 = _mm_setzero_ps();
+
+                for (uint32 k = 0; k < taps; ++k)
+                {
+                    const float* src_row = window + k * src_stride + i;
+                    const __m128 weight = _mm_set1_ps(coefficient[k]);
+
+                    sum0 = _mm_add_ps(sum0, _mm_mul_ps(weight, _mm_loadu_ps(src_row)));
+                    sum1 = _mm_add_ps(sum1, _mm_mul_ps(weight, _mm_loadu_ps(src_row + 4)));
+                    sum2 = _mm_add_ps(sum2, _mm_mul_ps(weight, _mm_loadu_ps(src_row + 8)));
+                    sum3 = _mm_add_ps(sum3, _mm_mul_ps(weight, _mm_loadu_ps(src_row + 12)));
+                }
+
+                _mm_storeu_ps(dst_row + i, sum0);
+                _mm_storeu_ps(dst_row + i + 4, sum1);
+                _mm_storeu_ps(dst_row + i + 8, sum2);
+                _mm_storeu_ps(dst_row + i + 12, sum3);
+            }
+
+            for (; i < vector_columns; i += 4)
+            {
+                __m128 sum = _mm_setzero_ps();
+
+                for (uint32 k = 0; k < taps; ++k)
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(coefficient[k]), _mm_loadu_ps(window + k * src_stride + i)));
+
+                _mm_storeu_ps(dst_row + i, sum);
+            }
+        }
+
+        // Handle the leftover columns
+        resize_column_tile_generic(src_buffer, src_stride, dst_buffer, dst_stride,
+            columns, height, coefficients, taps, offsets, vector_columns);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline void kahan_add_ps(__m128& sum, __m128& compensation, __m128 value)
+    {
+        const __m128 y = _mm_sub_ps(value, compensation);
+        const __m128 t = _mm_add_ps(sum, y);
+        compensation = _mm_sub_ps(_mm_sub_ps(t, sum), y);
+        sum = t;
+    }
+
+    static forcedinline double reduce_kahan_ps(__m128 sum, __m128 compensation)
+    {
+        float sums[4], compensations[4];
+        _mm_storeu_ps(sums, sum);
+        _mm_storeu_ps(compensations, compensation);
+
+        double result = 0.0;
+        for (uint32 i = 0; i < 4; ++i)
+        {
+            result += (double)sums[i] - (double)compensations[i];
+        }
+
+        return result;
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline __m128 abs_ps(__m128 value)
+    {
+        return _mm_andnot_ps(_mm_set1_ps(-0.0f), value);
+    }
+
+    // a > b ? greater : otherwise, lane by lane
+    static forcedinline __m128 select_greater_ps(__m128 a, __m128 b, __m128 greater, __m128 otherwise)
+    {
+        const __m128 mask = _mm_cmpgt_ps(a, b);
+        return _mm_or_ps(_mm_and_ps(mask, greater), _mm_andnot_ps(mask, otherwise));
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // all bits set in the alpha lane of a pixel
+    static forcedinline __m128 alpha_mask_ps()
+    {
+        return _mm_cmpneq_ps(_mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f), _mm_setzero_ps());
+    }
+
+    // the alpha of a pixel in all of its lanes
+    static forcedinline __m128 alpha_ps(__m128 pixel)
+    {
+        return _mm_shuffle_ps(pixel, pixel, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+
+    // the colour lanes of colour with the alpha lane of alpha
+    static forcedinline __m128 merge_alpha_ps(__m128 colour, __m128 alpha, __m128 alpha_mask)
+    {
+        return _mm_or_ps(_mm_andnot_ps(alpha_mask, colour), _mm_and_ps(alpha_mask, alpha));
+    }
+
+    // the blend modes of the fpu composite_channel on premultiplied pixels
+    static forcedinline __m128 multiply_pixel_ps(__m128 s, __m128 d, __m128 sa, __m128 da, __m128 one)
+    {
+        return _mm_add_ps(_mm_add_ps(_mm_mul_ps(s, _mm_sub_ps(one, da)),
+            _mm_mul_ps(d, _mm_sub_ps(one, sa))), _mm_mul_ps(s, d));
+    }
+
+    static forcedinline __m128 screen_pixel_ps(__m128 s, __m128 d)
+    {
+        return _mm_sub_ps(_mm_add_ps(s, d), _mm_mul_ps(s, d));
+    }
+
+    static forcedinline __m128 overlay_pixel_ps(__m128 s, __m128 d, __m128 sa, __m128 da, __m128 one, __m128 two)
+    {
+        const __m128 blend = select_greater_ps(_mm_mul_ps(two, d), da,
+            _mm_sub_ps(_mm_mul_ps(sa, da), _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(da, d)), _mm_sub_ps(sa, s))),
+            _mm_mul_ps(_mm_mul_ps(two, s), d));
+
+        return _mm_add_ps(_mm_add_ps(_mm_mul_ps(s, _mm_sub_ps(one, da)),
+            _mm_mul_ps(d, _mm_sub_ps(one, sa))), blend);
+    }
+
 };
 
 
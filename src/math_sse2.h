@@ -36,7 +36,7 @@
 //------------------------------------------------------------------------------
 
 /**
- * Specific SSE2 math class elaborating on __m128d buffers
+ * Specific SSE2 math class elaborating on __m128i and __m128d buffers
  */
 
 class math_sse2 : public math_sse
@@ -65,256 +65,3711 @@ public:
     }
 
 
+    //==========================================================================
+
+    //--------------------------------------------------------------------------
+
+    #define math_sse2_set_buffer_impl(datatype, vector_type, vector_set) \
+        void clear_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size) const \
+        { \
+            set_buffer_ ##datatype (src_buffer, size, datatype(0)); \
+        } \
+        \
+        void set_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            datatype value) const \
+        { \
+            if (size < SSE2_MIN_SAMPLES) \
+            { \
+                math_sse::set_buffer_ ##datatype (src_buffer, size, value); \
+            } \
+            else \
+            { \
+                assert(size >= SSE2_MIN_SIZE); \
+                \
+                const ptrdiff_t align_bytes = \
+                    ((ptrdiff_t)src_buffer & SSE2_ALIGN); \
+                \
+                /* Copy unaligned head */ \
+                simd_loop_head(datatype, SSE2_ALIGN, \
+                    --size; \
+                    *src_buffer++ = value; \
+                ); \
+                \
+                /* Set with simd */ \
+                const vector_type vvalue = vector_set; \
+                vector_type* vector_buffer = (vector_type*)src_buffer; \
+                \
+                uint32 vector_count = size / (16 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    *vector_buffer = vvalue; \
+                    \
+                    ++vector_buffer; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer = (datatype*)vector_buffer; \
+                \
+                simd_loop_tail(16 / sizeof(datatype), \
+                    *src_buffer++ = value; \
+                ); \
+            } \
+        }
+
+    #define math_sse2_scale_buffer_impl(datatype, gaintype, vector_type, vector_scale_type, vector_scale_set, scalar_scale) \
+        void scale_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            gaintype gain) const \
+        { \
+            if (size < SSE2_MIN_SAMPLES) \
+            { \
+                math_sse::scale_buffer_ ##datatype (src_buffer, size, gain); \
+            } \
+            else \
+            { \
+                assert(size >= SSE2_MIN_SIZE); \
+                \
+                const disable_sse_denormals disable_denormals; \
+                \
+                const ptrdiff_t align_bytes = \
+                    ((ptrdiff_t)src_buffer & SSE2_ALIGN); \
+                \
+                /* Scale unaligned head */ \
+                simd_loop_head(datatype, SSE2_ALIGN, \
+                    --size; \
+                    *src_buffer = scalar_scale; \
+                    ++src_buffer; \
+                ); \
+                \
+                /* Scale with simd */ \
+                const vector_scale_type vscale = vector_scale_set; \
+                vector_type* vector_buffer = (vector_type*)src_buffer; \
+                \
+                uint32 vector_count = size / (16 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    *vector_buffer = scale_vector_ ##datatype (*vector_buffer, vscale); \
+                    \
+                    ++vector_buffer; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer = (datatype*)vector_buffer; \
+                \
+                simd_loop_tail(16 / sizeof(datatype), \
+                    *src_buffer = scalar_scale; \
+                    ++src_buffer; \
+                ); \
+            } \
+        }
+
+    #define math_sse2_copy_buffer_impl(datatype, vector_type) \
+        void copy_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)src_buffer & SSE2_ALIGN); \
+            \
+            if (size < SSE2_MIN_SAMPLES || \
+                ((ptrdiff_t)dst_buffer & SSE2_ALIGN) != align_bytes) \
+            { \
+                math_sse::copy_buffer_ ##datatype (src_buffer, dst_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= SSE2_MIN_SIZE); \
+                \
+                /* Copy unaligned head */ \
+                simd_loop_head(datatype, SSE2_ALIGN, \
+                    --size; \
+                    *dst_buffer++ = *src_buffer++; \
+                ); \
+                \
+                /* Copy with simd */ \
+                vector_type* source_vector = (vector_type*)src_buffer; \
+                vector_type* dest_vector = (vector_type*)dst_buffer; \
+                \
+                uint32 vector_count = size / (16 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    *dest_vector = *source_vector; \
+                    \
+                    ++dest_vector; \
+                    ++source_vector; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer = (datatype*)source_vector; \
+                dst_buffer = (datatype*)dest_vector; \
+                \
+                simd_loop_tail(16 / sizeof(datatype), \
+                    *dst_buffer++ = *src_buffer++; \
+                ); \
+            } \
+        }
+
+    #define math_sse2_binary_buffers_impl(function, datatype, vector_type, op, vector_op, guard) \
+        void function ##_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_buffer & SSE2_ALIGN); \
+            \
+            if (size < SSE2_MIN_SAMPLES || \
+                (align_bytes != ((ptrdiff_t)src_buffer_a & SSE2_ALIGN) || \
+                 align_bytes != ((ptrdiff_t)src_buffer_b & SSE2_ALIGN))) \
+            { \
+                math_sse::function ##_ ##datatype ( \
+                    src_buffer_a, src_buffer_b, dst_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= SSE2_MIN_SIZE); \
+                \
+                guard \
+                \
+                /* Copy unaligned head */ \
+                simd_loop_head(datatype, SSE2_ALIGN, \
+                    --size; \
+                    *dst_buffer++ = *src_buffer_a++ op *src_buffer_b++; \
+                ); \
+                \
+                /* Operate with simd */ \
+                vector_type* vector_buffer_a = (vector_type*)src_buffer_a; \
+                vector_type* vector_buffer_b = (vector_type*)src_buffer_b; \
+                vector_type* vector_dst_buffer = (vector_type*)dst_buffer; \
+                \
+                uint32 vector_count = size / (16 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    *vector_dst_buffer = \
+                      vector_op(*vector_buffer_a, *vector_buffer_b); \
+                    \
+                    ++vector_buffer_a; \
+                    ++vector_buffer_b; \
+                    ++vector_dst_buffer; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer_a = (datatype*)vector_buffer_a; \
+                src_buffer_b = (datatype*)vector_buffer_b; \
+                dst_buffer = (datatype*)vector_dst_buffer; \
+                \
+                simd_loop_tail(16 / sizeof(datatype), \
+                    *dst_buffer++ = *src_buffer_a++ op *src_buffer_b++; \
+                ); \
+            } \
+        }
+
+    #define math_sse2_unary_buffer_impl(function, datatype, vector_type, scalar_op, vector_op) \
+        void function ##_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size) const \
+        { \
+            if (size < SSE2_MIN_SAMPLES) \
+            { \
+                math_sse::function ##_ ##datatype (src_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= SSE2_MIN_SIZE); \
+                \
+                const ptrdiff_t align_bytes = \
+                    ((ptrdiff_t)src_buffer & SSE2_ALIGN); \
+                \
+                /* Operate on unaligned head */ \
+                simd_loop_head(datatype, SSE2_ALIGN, \
+                    --size; \
+                    *src_buffer = scalar_op(*src_buffer); \
+                    ++src_buffer; \
+                ); \
+                \
+                /* Operate with simd */ \
+                vector_type* vector_buffer = (vector_type*)src_buffer; \
+                \
+                uint32 vector_count = size / (16 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    *vector_buffer = vector_op(*vector_buffer); \
+                    \
+                    ++vector_buffer; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer = (datatype*)vector_buffer; \
+                \
+                simd_loop_tail(16 / sizeof(datatype), \
+                    *src_buffer = scalar_op(*src_buffer); \
+                    ++src_buffer; \
+                ); \
+            } \
+        }
+
+    #define math_sse2_saturating_buffers_impl(function, datatype, scalar_op, vector_op) \
+        void function ##_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_buffer & SSE2_ALIGN); \
+            \
+            if (size < SSE2_MIN_SAMPLES || \
+                (align_bytes != ((ptrdiff_t)src_buffer_a & SSE2_ALIGN) || \
+                 align_bytes != ((ptrdiff_t)src_buffer_b & SSE2_ALIGN))) \
+            { \
+                math_sse::function ##_ ##datatype ( \
+                    src_buffer_a, src_buffer_b, dst_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= SSE2_MIN_SIZE); \
+                \
+                /* Copy unaligned head */ \
+                simd_loop_head(datatype, SSE2_ALIGN, \
+                    --size; \
+                    *dst_buffer++ = scalar_op(*src_buffer_a++, *src_buffer_b++); \
+                ); \
+                \
+                /* Operate with simd */ \
+                __m128i* vector_buffer_a = (__m128i*)src_buffer_a; \
+                __m128i* vector_buffer_b = (__m128i*)src_buffer_b; \
+                __m128i* vector_dst_buffer = (__m128i*)dst_buffer; \
+                \
+                uint32 vector_count = size / (16 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    *vector_dst_buffer = \
+                      vector_op(*vector_buffer_a, *vector_buffer_b); \
+                    \
+                    ++vector_buffer_a; \
+                    ++vector_buffer_b; \
+                    ++vector_dst_buffer; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer_a = (datatype*)vector_buffer_a; \
+                src_buffer_b = (datatype*)vector_buffer_b; \
+                dst_buffer = (datatype*)vector_dst_buffer; \
+                \
+                simd_loop_tail(16 / sizeof(datatype), \
+                    *dst_buffer++ = scalar_op(*src_buffer_a++, *src_buffer_b++); \
+                ); \
+            } \
+        }
+
+    #define math_sse2_scale_saturate_buffer_impl(datatype) \
+        void scale_buffer_saturate_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            float gain) const \
+        { \
+            if (size < SSE2_MIN_SAMPLES) \
+            { \
+                math_sse::scale_buffer_saturate_ ##datatype (src_buffer, size, gain); \
+            } \
+            else \
+            { \
+                assert(size >= SSE2_MIN_SIZE); \
+                \
+                const disable_sse_denormals disable_denormals; \
+                \
+                const ptrdiff_t align_bytes = \
+                    ((ptrdiff_t)src_buffer & SSE2_ALIGN); \
+                \
+                /* Scale unaligned head */ \
+                simd_loop_head(datatype, SSE2_ALIGN, \
+                    --size; \
+                    *src_buffer = scale_saturate_scalar(*src_buffer, gain); \
+                    ++src_buffer; \
+                ); \
+                \
+                /* Scale with simd */ \
+                const __m128 vscale = _mm_set1_ps(gain); \
+                __m128i* vector_buffer = (__m128i*)src_buffer; \
+                \
+                uint32 vector_count = size / (16 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    *vector_buffer = scale_saturate_vector_ ##datatype (*vector_buffer, vscale); \
+                    \
+                    ++vector_buffer; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer = (datatype*)vector_buffer; \
+                \
+                simd_loop_tail(16 / sizeof(datatype), \
+                    *src_buffer = scale_saturate_scalar(*src_buffer, gain); \
+                    ++src_buffer; \
+                ); \
+            } \
+        }
+
+    #define math_sse2_multiply_add_buffers_impl(datatype, vector_type, scalar_madd, vector_madd) \
+        void multiply_add_buffers_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* src_buffer_c, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_buffer & SSE2_ALIGN); \
+            \
+            if (size < SSE2_MIN_SAMPLES || \
+                (align_bytes != ((ptrdiff_t)src_buffer_a & SSE2_ALIGN) || \
+                 align_bytes != ((ptrdiff_t)src_buffer_b & SSE2_ALIGN) || \
+                 align_bytes != ((ptrdiff_t)src_buffer_c & SSE2_ALIGN))) \
+            { \
+                math_sse::multiply_add_buffers_ ##datatype ( \
+                    src_buffer_a, src_buffer_b, src_buffer_c, dst_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= SSE2_MIN_SIZE); \
+                \
+                const disable_sse_denormals disable_denormals; \
+                \
+                /* Copy unaligned head */ \
+                simd_loop_head(datatype, SSE2_ALIGN, \
+                    --size; \
+                    *dst_buffer++ = scalar_madd(*src_buffer_a++, *src_buffer_b++, *src_buffer_c++); \
+                ); \
+                \
+                /* Multiply and add with simd */ \
+                vector_type* vector_buffer_a = (vector_type*)src_buffer_a; \
+                vector_type* vector_buffer_b = (vector_type*)src_buffer_b; \
+                vector_type* vector_buffer_c = (vector_type*)src_buffer_c; \
+                vector_type* vector_dst_buffer = (vector_type*)dst_buffer; \
+                \
+                uint32 vector_count = size / (16 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    *vector_dst_buffer = vector_madd( \
+                        *vector_buffer_a, *vector_buffer_b, *vector_buffer_c); \
+                    \
+                    ++vector_buffer_a; \
+                    ++vector_buffer_b; \
+                    ++vector_buffer_c; \
+                    ++vector_dst_buffer; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer_a = (datatype*)vector_buffer_a; \
+                src_buffer_b = (datatype*)vector_buffer_b; \
+                src_buffer_c = (datatype*)vector_buffer_c; \
+                dst_buffer = (datatype*)vector_dst_buffer; \
+                \
+                simd_loop_tail(16 / sizeof(datatype), \
+                    *dst_buffer++ = scalar_madd(*src_buffer_a++, *src_buffer_b++, *src_buffer_c++); \
+                ); \
+            } \
+        }
+
+    #define math_sse2_scale_add_buffer_impl(datatype, vector_type, vector_set, scalar_madd, vector_madd) \
+        void scale_add_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype gain) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_buffer & SSE2_ALIGN); \
+            \
+            if (size < SSE2_MIN_SAMPLES || \
+                align_bytes != ((ptrdiff_t)src_buffer & SSE2_ALIGN)) \
+            { \
+                math_sse::scale_add_buffer_ ##datatype ( \
+                    src_buffer, dst_buffer, size, gain); \
+            } \
+            else \
+            { \
+                assert(size >= SSE2_MIN_SIZE); \
+                \
+                const disable_sse_denormals disable_denormals; \
+                \
+                /* Copy unaligned head */ \
+                simd_loop_head(datatype, SSE2_ALIGN, \
+                    --size; \
+                    *dst_buffer = scalar_madd(*src_buffer++, gain, *dst_buffer); \
+                    ++dst_buffer; \
+                ); \
+                \
+                /* Scale and accumulate with simd */ \
+                const vector_type vgain = vector_set; \
+                vector_type* vector_buffer = (vector_type*)src_buffer; \
+                vector_type* vector_dst_buffer = (vector_type*)dst_buffer; \
+                \
+                uint32 vector_count = size / (16 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    *vector_dst_buffer = vector_madd( \
+                        *vector_buffer, vgain, *vector_dst_buffer); \
+                    \
+                    ++vector_buffer; \
+                    ++vector_dst_buffer; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer = (datatype*)vector_buffer; \
+                dst_buffer = (datatype*)vector_dst_buffer; \
+                \
+                simd_loop_tail(16 / sizeof(datatype), \
+                    *dst_buffer = scalar_madd(*src_buffer++, gain, *dst_buffer); \
+                    ++dst_buffer; \
+                ); \
+            } \
+        }
+
+
+    //--------------------------------------------------------------------------
+
+    #define math_sse2_ramp_scale_buffer_impl(datatype, vector_type, vector_set, vector_loadu, vector_mul, vector_add) \
+        void ramp_scale_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            datatype start_gain, \
+            datatype end_gain) const \
+        { \
+            if (size < SSE2_MIN_SAMPLES) \
+            { \
+                math_sse::ramp_scale_buffer_ ##datatype ( \
+                    src_buffer, size, start_gain, end_gain); \
+            } \
+            else \
+            { \
+                assert(size >= SSE2_MIN_SIZE); \
+                \
+                const disable_sse_denormals disable_denormals; \
+                \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                const ptrdiff_t align_bytes = \
+                    ((ptrdiff_t)src_buffer & SSE2_ALIGN); \
+                const datatype increment = \
+                    ramp_increment(start_gain, end_gain, size); \
+                \
+                /* Ramp unaligned head */ \
+                const uint32 head_count = (uint32)(((SSE2_ALIGN + 1) - align_bytes) \
+                    & SSE2_ALIGN) / sizeof(datatype); \
+                ramp_scale_generic(src_buffer, head_count, start_gain, increment, 0); \
+                \
+                /* Ramp with simd, the sample indices are advanced in registers */ \
+                datatype lanes[16 / sizeof(datatype)]; \
+                ramp_index_lanes(lanes, vector_size, head_count); \
+                \
+                const vector_type vstart = vector_set(start_gain); \
+                const vector_type vincrement = vector_set(increment); \
+                const vector_type vstep = vector_set((datatype)vector_size); \
+                vector_type vindex = vector_loadu(lanes); \
+                vector_type* vector_buffer = (vector_type*)(src_buffer + head_count); \
+                \
+                uint32 vector_count = (size - head_count) / vector_size; \
+                const uint32 index = head_count + vector_count * vector_size; \
+                while (vector_count--) \
+                { \
+                    *vector_buffer = vector_mul(*vector_buffer, \
+                        vector_add(vstart, vector_mul(vincrement, vindex))); \
+                    vindex = vector_add(vindex, vstep); \
+                    \
+                    ++vector_buffer; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                ramp_scale_generic((datatype*)vector_buffer, size - index, \
+                    start_gain, increment, index); \
+            } \
+        }
+
+    #define math_sse2_exp_ramp_scale_buffer_impl(datatype, vector_type, vector_set, vector_loadu, vector_mul) \
+        void exp_ramp_scale_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            datatype start_gain, \
+            datatype end_gain) const \
+        { \
+            if (size < SSE2_MIN_SAMPLES || \
+                ! is_exp_ramp(start_gain, end_gain, size)) \
+            { \
+                math_sse::exp_ramp_scale_buffer_ ##datatype ( \
+                    src_buffer, size, start_gain, end_gain); \
+            } \
+            else \
+            { \
+                assert(size >= SSE2_MIN_SIZE); \
+                \
+                const disable_sse_denormals disable_denormals; \
+                \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                const ptrdiff_t align_bytes = \
+                    ((ptrdiff_t)src_buffer & SSE2_ALIGN); \
+                const double log_ratio = \
+                    exp_ramp_log_ratio(start_gain, end_gain, size); \
+                \
+                /* Ramp unaligned head */ \
+                const uint32 head_count = (uint32)(((SSE2_ALIGN + 1) - align_bytes) \
+                    & SSE2_ALIGN) / sizeof(datatype); \
+                exp_ramp_scale_generic(src_buffer, head_count, start_gain, log_ratio, 0); \
+                \
+                /* Ramp with simd, the gains are multiplied in registers and */ \
+                /* put back on the exact curve at the start of every block */ \
+                datatype lanes[16 / sizeof(datatype)]; \
+                \
+                const vector_type vstep = \
+                    vector_set((datatype)std::exp(log_ratio * vector_size)); \
+                vector_type* vector_buffer = (vector_type*)(src_buffer + head_count); \
+                \
+                uint32 index = head_count; \
+                uint32 vector_count = (size - head_count) / vector_size; \
+                while (vector_count > 0) \
+                { \
+                    uint32 block_count = vector_count < RAMP_BLOCK_SIZE / vector_size ? \
+                        vector_count : RAMP_BLOCK_SIZE / vector_size; \
+                    vector_count -= block_count; \
+                    \
+                    exp_ramp_lanes(lanes, vector_size, start_gain, log_ratio, index); \
+                    vector_type vgain = vector_loadu(lanes); \
+                    index += block_count * vector_size; \
+                    \
+                    while (block_count--) \
+                    { \
+                        *vector_buffer = vector_mul(*vector_buffer, vgain); \
+                        vgain = vector_mul(vgain, vstep); \
+                        \
+                        ++vector_buffer; \
+                    } \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                exp_ramp_scale_generic((datatype*)vector_buffer, size - index, \
+                    start_gain, log_ratio, index); \
+            } \
+        }
+
+
+    //--------------------------------------------------------------------------
+
+    #define math_sse2_mixing_kernels_impl(datatype, vector_type, vector_set, vector_loadu, vector_mul, vector_add) \
+        void stereo_gain_buffers_ ##datatype ( \
+            datatype* src_left_buffer, \
+            datatype* src_right_buffer, \
+            datatype* dst_left_buffer, \
+            datatype* dst_right_buffer, \
+            uint32 size, \
+            datatype left_gain, \
+            datatype right_gain) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_left_buffer & SSE2_ALIGN); \
+            \
+            if (size < SSE2_MIN_SAMPLES || \
+                align_bytes != ((ptrdiff_t)dst_right_buffer & SSE2_ALIGN) || \
+                align_bytes != ((ptrdiff_t)src_left_buffer & SSE2_ALIGN) || \
+                align_bytes != ((ptrdiff_t)src_right_buffer & SSE2_ALIGN)) \
+            { \
+                math_sse::stereo_gain_buffers_ ##datatype (src_left_buffer, src_right_buffer, \
+                    dst_left_buffer, dst_right_buffer, size, left_gain, right_gain); \
+            } \
+            else \
+            { \
+                assert(size >= SSE2_MIN_SIZE); \
+                \
+                const disable_sse_denormals disable_denormals; \
+                \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                \
+                /* Scale unaligned head */ \
+                const uint32 head_count = (uint32)(((SSE2_ALIGN + 1) - align_bytes) \
+                    & SSE2_ALIGN) / sizeof(datatype); \
+                stereo_gain_generic(src_left_buffer, src_right_buffer, \
+                    dst_left_buffer, dst_right_buffer, head_count, left_gain, right_gain); \
+                \
+                /* Scale both channels with simd */ \
+                const vector_type vleft_gain = vector_set(left_gain); \
+                const vector_type vright_gain = vector_set(right_gain); \
+                vector_type* vector_src_left = (vector_type*)(src_left_buffer + head_count); \
+                vector_type* vector_src_right = (vector_type*)(src_right_buffer + head_count); \
+                vector_type* vector_dst_left = (vector_type*)(dst_left_buffer + head_count); \
+                vector_type* vector_dst_right = (vector_type*)(dst_right_buffer + head_count); \
+                \
+                uint32 vector_count = (size - head_count) / vector_size; \
+                const uint32 index = head_count + vector_count * vector_size; \
+                while (vector_count--) \
+                { \
+                    const vector_type vleft = *vector_src_left++; \
+                    const vector_type vright = *vector_src_right++; \
+                    \
+                    *vector_dst_left++ = vector_mul(vleft, vleft_gain); \
+                    *vector_dst_right++ = vector_mul(vright, vright_gain); \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                stereo_gain_generic(src_left_buffer + index, src_right_buffer + index, \
+                    dst_left_buffer + index, dst_right_buffer + index, size - index, \
+                    left_gain, right_gain); \
+            } \
+        } \
+        \
+        void ramp_stereo_gain_buffers_ ##datatype ( \
+            datatype* src_left_buffer, \
+            datatype* src_right_buffer, \
+            datatype* dst_left_buffer, \
+            datatype* dst_right_buffer, \
+            uint32 size, \
+            datatype left_gain, \
+            datatype left_increment, \
+            datatype right_gain, \
+            datatype right_increment) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_left_buffer & SSE2_ALIGN); \
+            \
+            if (size < SSE2_MIN_SAMPLES || \
+                align_bytes != ((ptrdiff_t)dst_right_buffer & SSE2_ALIGN) || \
+                align_bytes != ((ptrdiff_t)src_left_buffer & SSE2_ALIGN) || \
+                align_bytes != ((ptrdiff_t)src_right_buffer & SSE2_ALIGN)) \
+            { \
+                math_sse::ramp_stereo_gain_buffers_ ##datatype (src_left_buffer, src_right_buffer, \
+                    dst_left_buffer, dst_right_buffer, size, \
+                    left_gain, left_increment, right_gain, right_increment); \
+            } \
+            else \
+            { \
+                assert(size >= SSE2_MIN_SIZE); \
+                \
+                const disable_sse_denormals disable_denormals; \
+                \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                \
+                /* Ramp unaligned head */ \
+                const uint32 head_count = (uint32)(((SSE2_ALIGN + 1) - align_bytes) \
+                    & SSE2_ALIGN) / sizeof(datatype); \
+                ramp_stereo_gain_generic(src_left_buffer, src_right_buffer, \
+                    dst_left_buffer, dst_right_buffer, head_count, \
+                    left_gain, left_increment, right_gain, right_increment, 0); \
+                \
+                /* Ramp both channels with simd, sharing the sample indices */ \
+                datatype lanes[16 / sizeof(datatype)]; \
+                ramp_index_lanes(lanes, vector_size, head_count); \
+                \
+                const vector_type vleft_gain = vector_set(left_gain); \
+                const vector_type vleft_increment = vector_set(left_increment); \
+                const vector_type vright_gain = vector_set(right_gain); \
+                const vector_type vright_increment = vector_set(right_increment); \
+                const vector_type vstep = vector_set((datatype)vector_size); \
+                vector_type vindex = vector_loadu(lanes); \
+                vector_type* vector_src_left = (vector_type*)(src_left_buffer + head_count); \
+                vector_type* vector_src_right = (vector_type*)(src_right_buffer + head_count); \
+                vector_type* vector_dst_left = (vector_type*)(dst_left_buffer + head_count); \
+                vector_type* vector_dst_right = (vector_type*)(dst_right_buffer + head_count); \
+                \
+                uint32 vector_count = (size - head_count) / vector_size; \
+                const uint32 index = head_count + vector_count * vector_size; \
+                while (vector_count--) \
+                { \
+                    const vector_type vleft = *vector_src_left++; \
+                    const vector_type vright = *vector_src_right++; \
+                    \
+                    *vector_dst_left++ = vector_mul(vleft, \
+                        vector_add(vleft_gain, vector_mul(vleft_increment, vindex))); \
+                    *vector_dst_right++ = vector_mul(vright, \
+                        vector_add(vright_gain, vector_mul(vright_increment, vindex))); \
+                    vindex = vector_add(vindex, vstep); \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                ramp_stereo_gain_generic(src_left_buffer + index, src_right_buffer + index, \
+                    dst_left_buffer + index, dst_right_buffer + index, size - index, \
+                    left_gain, left_increment, right_gain, right_increment, index); \
+            } \
+        } \
+        \
+        void mix_gain_buffers_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype gain_a, \
+            datatype gain_b) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_buffer & SSE2_ALIGN); \
+            \
+            if (size < SSE2_MIN_SAMPLES || \
+                align_bytes != ((ptrdiff_t)src_buffer_a & SSE2_ALIGN) || \
+                align_bytes != ((ptrdiff_t)src_buffer_b & SSE2_ALIGN)) \
+            { \
+                math_sse::mix_gain_buffers_ ##datatype (src_buffer_a, src_buffer_b, \
+                    dst_buffer, size, gain_a, gain_b); \
+            } \
+            else \
+            { \
+                assert(size >= SSE2_MIN_SIZE); \
+                \
+                const disable_sse_denormals disable_denormals; \
+                \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                \
+                /* Mix unaligned head */ \
+                const uint32 head_count = (uint32)(((SSE2_ALIGN + 1) - align_bytes) \
+                    & SSE2_ALIGN) / sizeof(datatype); \
+                mix_gain_generic(src_buffer_a, src_buffer_b, dst_buffer, head_count, \
+                    gain_a, gain_b); \
+                \
+                /* Mix with simd */ \
+                const vector_type vgain_a = vector_set(gain_a); \
+                const vector_type vgain_b = vector_set(gain_b); \
+                vector_type* vector_buffer_a = (vector_type*)(src_buffer_a + head_count); \
+                vector_type* vector_buffer_b = (vector_type*)(src_buffer_b + head_count); \
+                vector_type* vector_dst_buffer = (vector_type*)(dst_buffer + head_count); \
+                \
+                uint32 vector_count = (size - head_count) / vector_size; \
+                const uint32 index = head_count + vector_count * vector_size; \
+                while (vector_count--) \
+                { \
+                    *vector_dst_buffer++ = vector_add( \
+                        vector_mul(*vector_buffer_a++, vgain_a), \
+                        vector_mul(*vector_buffer_b++, vgain_b)); \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                mix_gain_generic(src_buffer_a + index, src_buffer_b + index, \
+                    dst_buffer + index, size - index, gain_a, gain_b); \
+            } \
+        } \
+        \
+        void ramp_mix_gain_buffers_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            datatype gain_a, \
+            datatype increment_a, \
+            datatype gain_b, \
+            datatype increment_b) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_buffer & SSE2_ALIGN); \
+            \
+            if (size < SSE2_MIN_SAMPLES || \
+                align_bytes != ((ptrdiff_t)src_buffer_a & SSE2_ALIGN) || \
+                align_bytes != ((ptrdiff_t)src_buffer_b & SSE2_ALIGN)) \
+            { \
+                math_sse::ramp_mix_gain_buffers_ ##datatype (src_buffer_a, src_buffer_b, \
+                    dst_buffer, size, gain_a, increment_a, gain_b, increment_b); \
+            } \
+            else \
+            { \
+                assert(size >= SSE2_MIN_SIZE); \
+                \
+                const disable_sse_denormals disable_denormals; \
+                \
+                const uint32 vector_size = 16 / sizeof(datatype); \
+                \
+                /* Mix unaligned head */ \
+                const uint32 head_count = (uint32)(((SSE2_ALIGN + 1) - align_bytes) \
+                    & SSE2_ALIGN) / sizeof(datatype); \
+                ramp_mix_gain_generic(src_buffer_a, src_buffer_b, dst_buffer, head_count, \
+                    gain_a, increment_a, gain_b, increment_b, 0); \
+                \
+                /* Mix with simd, both gains share the sample indices */ \
+                datatype lanes[16 / sizeof(datatype)]; \
+                ramp_index_lanes(lanes, vector_size, head_count); \
+                \
+                const vector_type vgain_a = vector_set(gain_a); \
+                const vector_type vincrement_a = vector_set(increment_a); \
+                const vector_type vgain_b = vector_set(gain_b); \
+                const vector_type vincrement_b = vector_set(increment_b); \
+                const vector_type vstep = vector_set((datatype)vector_size); \
+                vector_type vindex = vector_loadu(lanes); \
+                vector_type* vector_buffer_a = (vector_type*)(src_buffer_a + head_count); \
+                vector_type* vector_buffer_b = (vector_type*)(src_buffer_b + head_count); \
+                vector_type* vector_dst_buffer = (vector_type*)(dst_buffer + head_count); \
+                \
+                uint32 vector_count = (size - head_count) / vector_size; \
+                const uint32 index = head_count + vector_count * vector_size; \
+                while (vector_count--) \
+                { \
+                    *vector_dst_buffer++ = vector_add( \
+                        vector_mul(*vector_buffer_a++, \
+                            vector_add(vgain_a, vector_mul(vincrement_a, vindex))), \
+                        vector_mul(*vector_buffer_b++, \
+                            vector_add(vgain_b, vector_mul(vincrement_b, vindex)))); \
+                    vindex = vector_add(vindex, vstep); \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                ramp_mix_gain_generic(src_buffer_a + index, src_buffer_b + index, \
+                    dst_buffer + index, size - index, \
+                    gain_a, increment_a, gain_b, increment_b, index); \
+            } \
+        }
+
+
+    //--------------------------------------------------------------------------
+
+    #define math_sse2_sum_buffer_impl(datatype, accumtype, scalar_type, vector_type, vector_zero, vector_sum, vector_reduce) \
+        accumtype sum_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size) const \
+        { \
+            if (size < SSE2_MIN_SAMPLES) \
+            { \
+                return math_sse::sum_buffer_ ##datatype (src_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= SSE2_MIN_SIZE); \
+                \
+                const ptrdiff_t align_bytes = \
+                    ((ptrdiff_t)src_buffer & SSE2_ALIGN); \
+                \
+                scalar_type result = 0; \
+                \
+                /* Sum unaligned head */ \
+                simd_loop_head(datatype, SSE2_ALIGN, \
+                    --size; \
+                    result += static_cast<scalar_type>(*src_buffer++); \
+                ); \
+                \
+                /* Sum with simd */ \
+                vector_type vsum = vector_zero; \
+                vector_type vcompensation = vector_zero; \
+                vector_type* vector_buffer = (vector_type*)src_buffer; \
+                \
+                uint32 vector_count = size / (16 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    vector_sum(vsum, vcompensation, *vector_buffer); \
+                    \
+                    ++vector_buffer; \
+                } \
+                \
+                result += vector_reduce(vsum, vcompensation); \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer = (datatype*)vector_buffer; \
+                \
+                simd_loop_tail(16 / sizeof(datatype), \
+                    result += static_cast<scalar_type>(*src_buffer++); \
+                ); \
+                \
+                return static_cast<accumtype>(result); \
+            } \
+        }
+
+    #define math_sse2_dot_product_impl(datatype, accumtype, scalar_type, vector_type, vector_zero, vector_dot, vector_reduce) \
+        accumtype dot_product_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            uint32 size) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)src_buffer_a & SSE2_ALIGN); \
+            \
+            if (size < SSE2_MIN_SAMPLES || \
+                align_bytes != ((ptrdiff_t)src_buffer_b & SSE2_ALIGN)) \
+            { \
+                return math_sse::dot_product_ ##datatype (src_buffer_a, src_buffer_b, size); \
+            } \
+            else \
+            { \
+                assert(size >= SSE2_MIN_SIZE); \
+                \
+                scalar_type result = 0; \
+                \
+                /* Multiply and sum unaligned head */ \
+                simd_loop_head(datatype, SSE2_ALIGN, \
+                    --size; \
+                    result += static_cast<scalar_type>(*src_buffer_a++) * \
+                        static_cast<scalar_type>(*src_buffer_b++); \
+                ); \
+                \
+                /* Multiply and sum with simd */ \
+                vector_type vsum = vector_zero; \
+                vector_type vcompensation = vector_zero; \
+                vector_type* vector_buffer_a = (vector_type*)src_buffer_a; \
+                vector_type* vector_buffer_b = (vector_type*)src_buffer_b; \
+                \
+                uint32 vector_count = size / (16 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    vector_dot(vsum, vcompensation, *vector_buffer_a, *vector_buffer_b); \
+                    \
+                    ++vector_buffer_a; \
+                    ++vector_buffer_b; \
+                } \
+                \
+                result += vector_reduce(vsum, vcompensation); \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer_a = (datatype*)vector_buffer_a; \
+                src_buffer_b = (datatype*)vector_buffer_b; \
+                \
+                simd_loop_tail(16 / sizeof(datatype), \
+                    result += static_cast<scalar_type>(*src_buffer_a++) * \
+                        static_cast<scalar_type>(*src_buffer_b++); \
+                ); \
+                \
+                return static_cast<accumtype>(result); \
+            } \
+        }
+
+    #define math_sse2_extreme_buffer_impl(function, datatype, vector_type, op, vector_set, vector_op) \
+        datatype function ##_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            uint32* index) const \
+        { \
+            if (size < SSE2_MIN_SAMPLES) \
+            { \
+                return math_sse::function ##_ ##datatype (src_buffer, size, index); \
+            } \
+            else \
+            { \
+                assert(size >= SSE2_MIN_SIZE); \
+                \
+                const ptrdiff_t align_bytes = \
+                    ((ptrdiff_t)src_buffer & SSE2_ALIGN); \
+                \
+                datatype* const buffer = src_buffer; \
+                const uint32 buffer_size = size; \
+                datatype result = *src_buffer; \
+                \
+                /* Compare unaligned head */ \
+                simd_loop_head(datatype, SSE2_ALIGN, \
+                    --size; \
+                    if (*src_buffer op result) \
+                        result = *src_buffer; \
+                    ++src_buffer; \
+                ); \
+                \
+                /* Compare with simd */ \
+                vector_type vresult = vector_set; \
+                vector_type* vector_buffer = (vector_type*)src_buffer; \
+                \
+                uint32 vector_count = size / (16 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    vresult = vector_op(*vector_buffer, vresult); \
+                    \
+                    ++vector_buffer; \
+                } \
+                \
+                datatype lanes[16 / sizeof(datatype)]; \
+                memcpy(lanes, &vresult, sizeof(vresult)); \
+                for (uint32 i = 0; i < 16 / sizeof(datatype); ++i) \
+                { \
+                    if (lanes[i] op result) \
+                        result = lanes[i]; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer = (datatype*)vector_buffer; \
+                \
+                simd_loop_tail(16 / sizeof(datatype), \
+                    if (*src_buffer op result) \
+                        result = *src_buffer; \
+                    ++src_buffer; \
+                ); \
+                \
+                if (index != nullptr) \
+                    *index = index_of_value(buffer, buffer_size, result); \
+                \
+                return result; \
+            } \
+        }
+
+    #define math_sse2_peak_abs_buffer_impl(datatype, vector_type, vector_zero, vector_peak) \
+        double peak_abs_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size) const \
+        { \
+            if (size < SSE2_MIN_SAMPLES) \
+            { \
+                return math_sse::peak_abs_buffer_ ##datatype (src_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= SSE2_MIN_SIZE); \
+                \
+                const ptrdiff_t align_bytes = \
+                    ((ptrdiff_t)src_buffer & SSE2_ALIGN); \
+                \
+                datatype result = 0; \
+                \
+                /* Compare unaligned head */ \
+                simd_loop_head(datatype, SSE2_ALIGN, \
+                    --size; \
+                    if (abs_scalar(*src_buffer) > result) \
+                        result = abs_scalar(*src_buffer); \
+                    ++src_buffer; \
+                ); \
+                \
+                /* Compare with simd */ \
+                vector_type vresult = vector_zero; \
+                vector_type* vector_buffer = (vector_type*)src_buffer; \
+                \
+                uint32 vector_count = size / (16 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    vresult = vector_peak(*vector_buffer, vresult); \
+                    \
+                    ++vector_buffer; \
+                } \
+                \
+                datatype lanes[16 / sizeof(datatype)]; \
+                memcpy(lanes, &vresult, sizeof(vresult)); \
+                for (uint32 i = 0; i < 16 / sizeof(datatype); ++i) \
+                { \
+                    if (lanes[i] > result) \
+                        result = lanes[i]; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer = (datatype*)vector_buffer; \
+                \
+                simd_loop_tail(16 / sizeof(datatype), \
+                    if (abs_scalar(*src_buffer) > result) \
+                        result = abs_scalar(*src_buffer); \
+                    ++src_buffer; \
+                ); \
+                \
+                return result; \
+            } \
+        }
+
+    // the integer peak is the larger magnitude of the extremes, which come
+    // from the min and max kernels of the most derived backend
+    #define math_sse2_integer_peak_abs_buffer_impl(datatype, accumtype) \
+        accumtype peak_abs_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size) const \
+        { \
+            if (size < SSE2_MIN_SAMPLES) \
+            { \
+                return math_sse::peak_abs_buffer_ ##datatype (src_buffer, size); \
+            } \
+            else \
+            { \
+                const uint64 highest = magnitude_value(max_buffer_ ##datatype (src_buffer, size, nullptr)); \
+                const uint64 lowest = datatype(-1) < datatype(0) ? \
+                    magnitude_value(min_buffer_ ##datatype (src_buffer, size, nullptr)) : 0; \
+                \
+                return static_cast<accumtype>(lowest > highest ? lowest : highest); \
+            } \
+        }
+
+    //--------------------------------------------------------------------------
+
+    // samples move four at a time through 32 bit lanes, cvtps2dq and cvtpd2dq
+    // follow the rounding mode set by float_rounding_mode
+    #define math_sse2_conversion_functions_impl(integer, datatype, bits) \
+        void convert_buffer_ ##integer ##_to_ ##datatype ( \
+            integer* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            if (size < SSE2_MIN_SAMPLES) \
+            { \
+                math_sse::convert_buffer_ ##integer ##_to_ ##datatype ( \
+                    src_buffer, dst_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= SSE2_MIN_SIZE); \
+                \
+                const integer_format<datatype> format(bits); \
+                \
+                /* Widen the samples to 32 bit lanes, then convert and scale */ \
+                uint32 vector_count = size >> 2; \
+                while (vector_count--) \
+                { \
+                    store_scaled_samples(dst_buffer, load_samples(src_buffer), format.scale); \
+                    \
+                    src_buffer += 4; \
+                    dst_buffer += 4; \
+                } \
+                \
+                /* Handle any leftovers */ \
+                convert_from_integer_generic(src_buffer, dst_buffer, size & 3, format); \
+            } \
+        } \
+        \
+        void convert_buffer_ ##datatype ##_to_ ##integer ( \
+            datatype* src_buffer, \
+            integer* dst_buffer, \
+            uint32 size, \
+            FloatRoundingModeTypes rounding, \
+            uint32* dither_seed) const \
+        { \
+            if (size < SSE2_MIN_SAMPLES) \
+            { \
+                math_sse::convert_buffer_ ##datatype ##_to_ ##integer ( \
+                    src_buffer, dst_buffer, size, rounding, dither_seed); \
+            } \
+            else \
+            { \
+                assert(size >= SSE2_MIN_SIZE); \
+                \
+                const integer_format<datatype> format(bits); \
+                const float_rounding_mode round_mode(rounding); \
+                \
+                /* Scale, dither and saturate, then round and narrow the lanes */ \
+                const bool dither = dither_seed != nullptr; \
+                const __m128i vstep = _mm_set1_epi32(4); \
+                __m128i vindex = _mm_add_epi32(_mm_set1_epi32(dither ? (int32)*dither_seed : 0), \
+                    _mm_set_epi32(3, 2, 1, 0)); \
+                \
+                uint32 vector_count = size >> 2; \
+                while (vector_count--) \
+                { \
+                    store_samples(dst_buffer, round_samples(src_buffer, format, dither, vindex)); \
+                    vindex = _mm_add_epi32(vindex, vstep); \
+                    \
+                    src_buffer += 4; \
+                    dst_buffer += 4; \
+                } \
+                \
+                /* Handle any leftovers */ \
+                convert_to_integer_generic(src_buffer, dst_buffer, size & 3, \
+                    format, dither_seed, size & ~3); \
+                \
+                advance_dither_seed(dither_seed, size); \
+            } \
+        }
+
+
+    //--------------------------------------------------------------------------
+
+    #define math_sse2_common_functions_impl(datatype, vector_type, vector_set, add, sub, mul) \
+        math_sse2_set_buffer_impl(datatype, vector_type, vector_set) \
+        math_sse2_copy_buffer_impl(datatype, vector_type) \
+        math_sse2_binary_buffers_impl(add_buffers, datatype, vector_type, +, add, \
+            /* no guard */) \
+        math_sse2_binary_buffers_impl(subtract_buffers, datatype, vector_type, -, sub, \
+            /* no guard */) \
+        math_sse2_binary_buffers_impl(multiply_buffers, datatype, vector_type, *, mul, \
+            const disable_sse_denormals disable_denormals;)
+
+    #define math_sse2_divide_functions_impl(datatype, vector_type, div) \
+        math_sse2_binary_buffers_impl(divide_buffers, datatype, vector_type, /, div, \
+            const disable_sse_denormals disable_denormals;)
+
+    #define math_sse2_integer_scale_functions_impl(datatype) \
+        math_sse2_scale_buffer_impl(datatype, float, __m128i, __m128, _mm_set1_ps(gain), \
+            static_cast<datatype>(round::f2i((float)(*src_buffer) * gain))) \
+        math_sse2_scale_buffer_impl(datatype, double, __m128i, __m128d, _mm_set1_pd(gain), \
+            static_cast<datatype>(round::d2i((double)(*src_buffer) * gain)))
+
+    #define math_sse2_saturating_functions_impl(datatype, adds, subs, avg) \
+        math_sse2_saturating_buffers_impl(add_buffers_saturate, datatype, add_saturate_scalar, adds) \
+        math_sse2_saturating_buffers_impl(subtract_buffers_saturate, datatype, subtract_saturate_scalar, subs) \
+        math_sse2_saturating_buffers_impl(average_buffers, datatype, average_scalar, avg) \
+        math_sse2_scale_saturate_buffer_impl(datatype)
+
+
+    //==========================================================================
+
+    //--------------------------------------------------------------------------
+
+    math_sse2_common_functions_impl(int8, __m128i, _mm_set1_epi8(value),
+        _mm_add_epi8, _mm_sub_epi8, mullo_epi8)
+    math_sse2_common_functions_impl(uint8, __m128i, _mm_set1_epi8((char)value),
+        _mm_add_epi8, _mm_sub_epi8, mullo_epi8)
+    math_sse2_common_functions_impl(int16, __m128i, _mm_set1_epi16(value),
+        _mm_add_epi16, _mm_sub_epi16, _mm_mullo_epi16)
+    math_sse2_common_functions_impl(uint16, __m128i, _mm_set1_epi16((short)value),
+        _mm_add_epi16, _mm_sub_epi16, _mm_mullo_epi16)
+    math_sse2_common_functions_impl(int32, __m128i, _mm_set1_epi32(value),
+        _mm_add_epi32, _mm_sub_epi32, mullo_epi32)
+    math_sse2_common_functions_impl(uint32, __m128i, _mm_set1_epi32((int)value),
+        _mm_add_epi32, _mm_sub_epi32, mullo_epi32)
+    math_sse2_common_functions_impl(int64, __m128i, _mm_set1_epi64x(value),
+        _mm_add_epi64, _mm_sub_epi64, mullo_epi64)
+    math_sse2_common_functions_impl(uint64, __m128i, _mm_set1_epi64x((long long)value),
+        _mm_add_epi64, _mm_sub_epi64, mullo_epi64)
+    math_sse2_common_functions_impl(double, __m128d, _mm_set1_pd(value),
+        _mm_add_pd, _mm_sub_pd, _mm_mul_pd)
+
+    // 64 bit integers division is left to the base class, there is no way to
+    // get an exact quotient out of SSE2 for them
+    math_sse2_divide_functions_impl(int8, __m128i, div_epi8)
+    math_sse2_divide_functions_impl(uint8, __m128i, div_epu8)
+    math_sse2_divide_functions_impl(int16, __m128i, div_epi16)
+    math_sse2_divide_functions_impl(uint16, __m128i, div_epu16)
+    math_sse2_divide_functions_impl(int32, __m128i, div_epi32)
+    math_sse2_divide_functions_impl(uint32, __m128i, div_epu32)
+    math_sse2_divide_functions_impl(double, __m128d, _mm_div_pd)
+
+    // 64 bit integers scaling is left to the base class, as there is no
+    // packed conversion between 64 bit integers and floating point in SSE2
+    math_sse2_integer_scale_functions_impl(int8)
+    math_sse2_integer_scale_functions_impl(uint8)
+    math_sse2_integer_scale_functions_impl(int16)
+    math_sse2_integer_scale_functions_impl(uint16)
+    math_sse2_integer_scale_functions_impl(int32)
+    math_sse2_integer_scale_functions_impl(uint32)
+
+    // pavgb and pavgw only exist for unsigned lanes, the signed ones are
+    // biased to unsigned around them
+    math_sse2_saturating_functions_impl(int8, _mm_adds_epi8, _mm_subs_epi8, avg_epi8)
+    math_sse2_saturating_functions_impl(uint8, _mm_adds_epu8, _mm_subs_epu8, _mm_avg_epu8)
+    math_sse2_saturating_functions_impl(int16, _mm_adds_epi16, _mm_subs_epi16, avg_epi16)
+    math_sse2_saturating_functions_impl(uint16, _mm_adds_epu16, _mm_subs_epu16, _mm_avg_epu16)
+
+    // absolute value of unsigned buffers is left to the base class no-op
+    math_sse2_unary_buffer_impl(abs_buffer, int8, __m128i, abs_scalar, abs_epi8)
+    math_sse2_unary_buffer_impl(abs_buffer, int16, __m128i, abs_scalar, abs_epi16)
+    math_sse2_unary_buffer_impl(abs_buffer, int32, __m128i, abs_scalar, abs_epi32)
+    math_sse2_unary_buffer_impl(abs_buffer, int64, __m128i, abs_scalar, abs_epi64)
+    math_sse2_unary_buffer_impl(abs_buffer, double, __m128d, abs_scalar, abs_pd)
+
+    math_sse2_scale_buffer_impl(double, float, __m128d, __m128d, _mm_set1_pd((double)gain),
+        *src_buffer * (double)gain)
+    math_sse2_scale_buffer_impl(double, double, __m128d, __m128d, _mm_set1_pd(gain),
+        *src_buffer * gain)
+
+    math_sse2_multiply_add_buffers_impl(double, __m128d, madd_scalar, madd_pd)
+    math_sse2_scale_add_buffer_impl(double, __m128d, _mm_set1_pd(gain), madd_scalar, madd_pd)
+
+    math_sse2_ramp_scale_buffer_impl(double, __m128d, _mm_set1_pd, _mm_loadu_pd, _mm_mul_pd, _mm_add_pd)
+    math_sse2_exp_ramp_scale_buffer_impl(double, __m128d, _mm_set1_pd, _mm_loadu_pd, _mm_mul_pd)
+
+    math_sse2_sum_buffer_impl(int8, int64, uint64, __m128i, _mm_setzero_si128(), sum_epi8, reduce_epi64)
+    math_sse2_sum_buffer_impl(uint8, uint64, uint64, __m128i, _mm_setzero_si128(), sum_epu8, reduce_epi64)
+    math_sse2_sum_buffer_impl(int16, int64, uint64, __m128i, _mm_setzero_si128(), sum_epi16, reduce_epi64)
+    math_sse2_sum_buffer_impl(uint16, uint64, uint64, __m128i, _mm_setzero_si128(), sum_epu16, reduce_epi64)
+    math_sse2_sum_buffer_impl(int32, int64, uint64, __m128i, _mm_setzero_si128(), sum_epi32, reduce_epi64)
+    math_sse2_sum_buffer_impl(uint32, uint64, uint64, __m128i, _mm_setzero_si128(), sum_epu32, reduce_epi64)
+    math_sse2_sum_buffer_impl(int64, int64, uint64, __m128i, _mm_setzero_si128(), sum_epi64, reduce_epi64)
+    math_sse2_sum_buffer_impl(uint64, uint64, uint64, __m128i, _mm_setzero_si128(), sum_epi64, reduce_epi64)
+    math_sse2_sum_buffer_impl(double, double, double, __m128d, _mm_setzero_pd(), kahan_add_pd, reduce_kahan_pd)
+
+    math_sse2_dot_product_impl(int8, int64, uint64, __m128i, _mm_setzero_si128(), dot_epi8, reduce_epi64)
+    math_sse2_dot_product_impl(uint8, uint64, uint64, __m128i, _mm_setzero_si128(), dot_epu8, reduce_epi64)
+    math_sse2_dot_product_impl(int16, int64, uint64, __m128i, _mm_setzero_si128(), dot_epi16, reduce_epi64)
+    math_sse2_dot_product_impl(uint16, uint64, uint64, __m128i, _mm_setzero_si128(), dot_epu16, reduce_epi64)
+    math_sse2_dot_product_impl(int32, int64, uint64, __m128i, _mm_setzero_si128(), dot_epi32, reduce_epi64)
+    math_sse2_dot_product_impl(uint32, uint64, uint64, __m128i, _mm_setzero_si128(), dot_epu32, reduce_epi64)
+    math_sse2_dot_product_impl(int64, int64, uint64, __m128i, _mm_setzero_si128(), dot_epi64, reduce_epi64)
+    math_sse2_dot_product_impl(uint64, uint64, uint64, __m128i, _mm_setzero_si128(), dot_epi64, reduce_epi64)
+    math_sse2_dot_product_impl(double, double, double, __m128d, _mm_setzero_pd(), dot_pd, reduce_kahan_pd)
+
+    // 64 bit integers min and max are left to the base class, there is no 64
+    // bit compare in SSE2
+    math_sse2_extreme_buffer_impl(min_buffer, int8, __m128i, <, _mm_set1_epi8(result), min_epi8)
+    math_sse2_extreme_buffer_impl(max_buffer, int8, __m128i, >, _mm_set1_epi8(result), max_epi8)
+    math_sse2_extreme_buffer_impl(min_buffer, uint8, __m128i, <, _mm_set1_epi8((char)result), _mm_min_epu8)
+    math_sse2_extreme_buffer_impl(max_buffer, uint8, __m128i, >, _mm_set1_epi8((char)result), _mm_max_epu8)
+    math_sse2_extreme_buffer_impl(min_buffer, int16, __m128i, <, _mm_set1_epi16(result), _mm_min_epi16)
+    math_sse2_extreme_buffer_impl(max_buffer, int16, __m128i, >, _mm_set1_epi16(result), _mm_max_epi16)
+    math_sse2_extreme_buffer_impl(min_buffer, uint16, __m128i, <, _mm_set1_epi16((short)result), min_epu16)
+    math_sse2_extreme_buffer_impl(max_buffer, uint16, __m128i, >, _mm_set1_epi16((short)result), max_epu16)
+    math_sse2_extreme_buffer_impl(min_buffer, int32, __m128i, <, _mm_set1_epi32(result), min_epi32)
+    math_sse2_extreme_buffer_impl(max_buffer, int32, __m128i, >, _mm_set1_epi32(result), max_epi32)
+    math_sse2_extreme_buffer_impl(min_buffer, uint32, __m128i, <, _mm_set1_epi32((int)result), min_epu32)
+    math_sse2_extreme_buffer_impl(max_buffer, uint32, __m128i, >, _mm_set1_epi32((int)result), max_epu32)
+    math_sse2_extreme_buffer_impl(min_buffer, double, __m128d, <, _mm_set1_pd(result), _mm_min_pd)
+    math_sse2_extreme_buffer_impl(max_buffer, double, __m128d, >, _mm_set1_pd(result), _mm_max_pd)
+
+    math_sse2_integer_peak_abs_buffer_impl(int8, int64)
+    math_sse2_integer_peak_abs_buffer_impl(uint8, uint64)
+    math_sse2_integer_peak_abs_buffer_impl(int16, int64)
+    math_sse2_integer_peak_abs_buffer_impl(uint16, uint64)
+    math_sse2_integer_peak_abs_buffer_impl(int32, int64)
+    math_sse2_integer_peak_abs_buffer_impl(uint32, uint64)
+    math_sse2_peak_abs_buffer_impl(double, __m128d, _mm_setzero_pd(), peak_pd)
+
+
     //--------------------------------------------------------------------------
 
-    void clear_buffer_int32(
-        int32* src_buffer,
+    void interleave_buffers_double(
+        double** src_buffers,
+        double* dst_buffer,
+        uint32 channels,
         uint32 size) const
     {
-        if (size < SSE2_MIN_SAMPLES)
+        if (size < SSE2_MIN_SAMPLES || channels < 2)
         {
-            math_sse::clear_buffer_int32(src_buffer, size);
+            math_sse::interleave_buffers_double(src_buffers, dst_buffer, channels, size);
         }
         else
         {
-            assert(size >= SSE2_MIN_SIZE);
+            const uint32 frames = size & ~1;
+
+            // Transpose two frames of two channels at a time
+            uint32 c = 0;
+            for (; c + 2 <= channels; c += 2)
+            {
+                const double* src0 = src_buffers[c];
+                const double* src1 = src_buffers[c + 1];
+                double* dst = dst_buffer + c;
+
+                for (uint32 i = 0; i < frames; i += 2)
+                {
+                    const __m128d v0 = _mm_loadu_pd(src0 + i);
+                    const __m128d v1 = _mm_loadu_pd(src1 + i);
+
+                    _mm_storeu_pd(dst + i * channels, _mm_unpacklo_pd(v0, v1));
+                    _mm_storeu_pd(dst + (i + 1) * channels, _mm_unpackhi_pd(v0, v1));
+                }
+            }
 
-            const ptrdiff_t align_bytes =
-                ((ptrdiff_t)src_buffer & SSE2_ALIGN);
+            // Handle the last odd channel and the leftover frame
+            interleave_generic(src_buffers, dst_buffer, channels, c, channels, 0, frames);
+            interleave_generic(src_buffers, dst_buffer, channels, 0, channels, frames, size);
+        }
+    }
 
-            // Copy unaligned head
-            simd_unroll_head_4(
-                --size;
-                *src_buffer++ = 0;
-            );
 
-            // Clear with simd
-            const __m128i vvalue = _mm_setzero_si128();
-            __m128i* vector_buffer = (__m128i*)src_buffer;
+    //--------------------------------------------------------------------------
 
-            uint32 vector_count = size >> 2;
-            while (vector_count--)
-            {
-                *vector_buffer = vvalue;
+    void deinterleave_buffer_double(
+        double* src_buffer,
+        double** dst_buffers,
+        uint32 channels,
+        uint32 size) const
+    {
+        if (size < SSE2_MIN_SAMPLES || channels < 2)
+        {
+            math_sse::deinterleave_buffer_double(src_buffer, dst_buffers, channels, size);
+        }
+        else
+        {
+            const uint32 frames = size & ~1;
 
-                ++vector_buffer;
+            // Transpose two frames of two channels at a time
+            uint32 c = 0;
+            for (; c + 2 <= channels; c += 2)
+            {
+                const double* src = src_buffer + c;
+                double* dst0 = dst_buffers[c];
+                double* dst1 = dst_buffers[c + 1];
+
+                for (uint32 i = 0; i < frames; i += 2)
+                {
+                    const __m128d v0 = _mm_loadu_pd(src + i * channels);
+                    const __m128d v1 = _mm_loadu_pd(src + (i + 1) * channels);
+
+                    _mm_storeu_pd(dst0 + i, _mm_unpacklo_pd(v0, v1));
+                    _mm_storeu_pd(dst1 + i, _mm_unpackhi_pd(v0, v1));
+                }
             }
 
-            // Handle any unaligned leftovers
-            src_buffer = (int32*)vector_buffer;
+            // Handle the last odd channel and the leftover frame
+            deinterleave_generic(src_buffer, dst_buffers, channels, c, channels, 0, frames);
+            deinterleave_generic(src_buffer, dst_buffers, channels, 0, channels, frames, size);
+        }
+    }
+
 
-            simd_unroll_tail_4(
-                *src_buffer++ = 0;
-            );
+    //--------------------------------------------------------------------------
+
+    void process_biquad_bank_double(
+        double* src_buffer,
+        double* dst_buffer,
+        uint32 channels,
+        uint32 frames,
+        double* coefficients,
+        double* state,
+        uint32 sections) const
+    {
+        if (channels < 2)
+        {
+            math_sse::process_biquad_bank_double(src_buffer, dst_buffer, channels, frames,
+                coefficients, state, sections);
+        }
+        else
+        {
+            const disable_sse_denormals disable_denormals;
+
+            // Every lane runs the cascade of one channel: all the pairs of
+            // channels are walked each frame, so their recurrences overlap
+            const uint32 vector_channels = channels & ~1;
+
+            for (uint32 frame = 0; frame < frames; ++frame)
+            {
+                const double* src = src_buffer + frame * channels;
+                double* dst = dst_buffer + frame * channels;
+
+                for (uint32 c = 0; c < vector_channels; c += 2)
+                {
+                    const double* coefficient = coefficients + c;
+                    double* z = state + c;
+                    __m128d value = _mm_loadu_pd(src + c);
+
+                    for (uint32 section = 0; section < sections; ++section)
+                    {
+                        const __m128d output = _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(coefficient), value),
+                            _mm_loadu_pd(z));
+
+                        _mm_storeu_pd(z, _mm_add_pd(_mm_sub_pd(
+                            _mm_mul_pd(_mm_loadu_pd(coefficient + channels), value),
+                            _mm_mul_pd(_mm_loadu_pd(coefficient + 3 * channels), output)),
+                            _mm_loadu_pd(z + channels)));
+                        _mm_storeu_pd(z + channels, _mm_sub_pd(
+                            _mm_mul_pd(_mm_loadu_pd(coefficient + 2 * channels), value),
+                            _mm_mul_pd(_mm_loadu_pd(coefficient + 4 * channels), output)));
+                        value = output;
+
+                        coefficient += 5 * channels;
+                        z += 2 * channels;
+                    }
+
+                    _mm_storeu_pd(dst + c, value);
+                }
+            }
+
+            // Handle the leftover channels
+            biquad_bank_generic(src_buffer, dst_buffer, channels, frames,
+                coefficients, state, sections, vector_channels);
         }
     }
 
 
     //--------------------------------------------------------------------------
 
-    void set_buffer_int32(
-        int32* src_buffer,
+    math_sse2_conversion_functions_impl(int16, float, 16)
+    math_sse2_conversion_functions_impl(int24, float, 24)
+    math_sse2_conversion_functions_impl(int32, float, 32)
+    math_sse2_conversion_functions_impl(int16, double, 16)
+    math_sse2_conversion_functions_impl(int24, double, 24)
+    math_sse2_conversion_functions_impl(int32, double, 32)
+
+
+    //--------------------------------------------------------------------------
+
+    void process_polyphase_double(
+        double* src_buffer,
+        double* dst_buffer,
         uint32 size,
-        int32 value) const
+        double* coefficients,
+        uint32 taps,
+        uint32* rows,
+        uint32* offsets) const
     {
-        if (size < SSE2_MIN_SAMPLES)
+        if (taps < 2)
         {
-            math_sse::set_buffer_int32(src_buffer, size, value);
+            math_sse::process_polyphase_double(src_buffer, dst_buffer, size,
+                coefficients, taps, rows, offsets);
         }
         else
         {
-            assert(size >= SSE2_MIN_SIZE);
+            const disable_sse_denormals disable_denormals;
 
-            const ptrdiff_t align_bytes =
-                ((ptrdiff_t)src_buffer & SSE2_ALIGN);
+            const uint32 vector_taps = taps & ~1;
 
-            // Copy unaligned head
-            simd_unroll_head_4(
-                --size;
-                *src_buffer++ = value;
-            );
+            for (uint32 i = 0; i < size; ++i)
+            {
+                const double* src = src_buffer + offsets[i];
+                const double* coefficient = coefficients + rows[i] * taps;
+                __m128d sum = _mm_setzero_pd();
+
+                for (uint32 k = 0; k < vector_taps; k += 2)
+                {
+                    sum = _mm_add_pd(sum, _mm_mul_pd(_mm_loadu_pd(coefficient + k), _mm_loadu_pd(src + k)));
+                }
+
+                double sums[2];
+                _mm_storeu_pd(sums, sum);
+
+                // Handle the leftover taps
+                dst_buffer[i] = polyphase_row_generic(src, coefficient, vector_taps, taps,
+                    sums[0] + sums[1]);
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    void process_envelope_bank_double(
+        double* src_buffer,
+        double* dst_buffer,
+        uint32 channels,
+        uint32 frames,
+        double* coefficients,
+        double* state,
+        EnvelopeModeTypes mode) const
+    {
+        if (channels < 2)
+        {
+            math_sse::process_envelope_bank_double(src_buffer, dst_buffer, channels, frames,
+                coefficients, state, mode);
+        }
+        else
+        {
+            const disable_sse_denormals disable_denormals;
 
-            // Clear with simd
-            const __m128i vvalue = _mm_set1_epi32(value);
-            __m128i* vector_buffer = (__m128i*)src_buffer;
+            // Every lane follows the envelope of one channel, all the groups of
+            // channels are walked each frame as the biquad banks do
+            const uint32 vector_channels = channels & ~1;
 
-            uint32 vector_count = size >> 2;
-            while (vector_count--)
+            for (uint32 frame = 0; frame < frames; ++frame)
             {
-                *vector_buffer = vvalue;
+                const double* src = src_buffer + frame * channels;
+                double* dst = dst_buffer + frame * channels;
+
+                for (uint32 c = 0; c < vector_channels; c += 2)
+                {
+                    const __m128d value = _mm_loadu_pd(src + c);
+                    const __m128d level = mode == RMS_ENVELOPE ? _mm_mul_pd(value, value) : abs_pd(value);
+                    __m128d envelope = _mm_loadu_pd(state + c);
 
-                ++vector_buffer;
+                    const __m128d coefficient = select_greater_pd(level, envelope,
+                        _mm_loadu_pd(coefficients + c), _mm_loadu_pd(coefficients + channels + c));
+
+                    envelope = _mm_add_pd(envelope, _mm_mul_pd(coefficient, _mm_sub_pd(level, envelope)));
+
+                    _mm_storeu_pd(state + c, envelope);
+                    _mm_storeu_pd(dst + c, mode == RMS_ENVELOPE ? _mm_sqrt_pd(envelope) : envelope);
+                }
             }
 
-            // Handle any unaligned leftovers
-            src_buffer = (int32*)vector_buffer;
+            // Handle the leftover channels
+            envelope_bank_generic(src_buffer, dst_buffer, channels, frames,
+                coefficients, state, mode, vector_channels);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    void compressor_gain_buffer_double(
+        double* src_buffer,
+        double* dst_buffer,
+        uint32 size,
+        double threshold,
+        double ratio,
+        double knee) const
+    {
+        assert(ratio > double(0));
+
+        const disable_sse_denormals disable_denormals;
+
+        const double width = knee > double(0) ? knee : double(0);
+        const __m128d vthreshold = _mm_set1_pd(threshold);
+        const __m128d vslope = _mm_set1_pd(double(1) / ratio - double(1));
+        const __m128d vhalf_knee = _mm_set1_pd(width * double(0.5));
+        const __m128d vwidth = _mm_set1_pd(width);
+        const __m128d vknee_scale = _mm_set1_pd(knee > double(0) ? double(1) / (double(2) * knee) : double(0));
+        const __m128d vzero = _mm_set1_pd(double(0));
+
+        const uint32 vector_samples = size & ~1;
+        for (uint32 i = 0; i < vector_samples; i += 2)
+        {
+            const __m128d over = _mm_sub_pd(_mm_loadu_pd(src_buffer + i), vthreshold);
+            const __m128d above = _mm_max_pd(_mm_sub_pd(over, vhalf_knee), vzero);
+            const __m128d bent = _mm_min_pd(_mm_max_pd(_mm_add_pd(over, vhalf_knee), vzero), vwidth);
 
-            simd_unroll_tail_4(
-                *src_buffer++ = value;
-            );
+            _mm_storeu_pd(dst_buffer + i, _mm_mul_pd(vslope,
+                _mm_add_pd(_mm_mul_pd(_mm_mul_pd(bent, bent), vknee_scale), above)));
         }
+
+        // Handle the leftovers
+        compressor_gain_generic(src_buffer, dst_buffer, size, threshold, ratio, knee, vector_samples);
     }
 
 
     //--------------------------------------------------------------------------
 
-    void copy_buffer_int32(
-        int32* src_buffer,
-        int32* dst_buffer,
-        uint32 size) const
+    void limiter_gain_buffer_double(
+        double* src_buffer,
+        double* dst_buffer,
+        uint32 size,
+        double threshold) const
     {
-        const ptrdiff_t align_bytes =
-            ((ptrdiff_t)src_buffer & SSE2_ALIGN);
+        assert(threshold > double(0));
 
-        if (size < SSE2_MIN_SAMPLES ||
-            ((ptrdiff_t)dst_buffer & SSE2_ALIGN) != align_bytes)
+        const disable_sse_denormals disable_denormals;
+
+        const __m128d vthreshold = _mm_set1_pd(threshold);
+
+        const uint32 vector_samples = size & ~1;
+        for (uint32 i = 0; i < vector_samples; i += 2)
         {
-            math_sse::copy_buffer_int32(src_buffer, dst_buffer, size);
+            _mm_storeu_pd(dst_buffer + i, _mm_div_pd(vthreshold, _mm_max_pd(_mm_loadu_pd(src_buffer + i), vthreshold)));
         }
-        else
-        {
-            assert(size >= SSE2_MIN_SIZE);
 
-            // Copy unaligned head
-            simd_unroll_head_4(
-                --size;
-                *dst_buffer++ = *src_buffer++;
-            );
+        // Handle the leftovers
+        limiter_gain_generic(src_buffer, dst_buffer, size, threshold, vector_samples);
+    }
 
-            // Scale with simd
-            __m128i* source_vector = (__m128i*)src_buffer;
-            __m128i* dest_vector = (__m128i*)dst_buffer;
 
-            uint32 vector_count = size >> 2;
-            while (vector_count--)
-            {
-                *dest_vector = *source_vector;
+    //--------------------------------------------------------------------------
 
-                ++dest_vector;
-                ++source_vector;
-            }
+    void soft_clip_buffer_double(
+        double* src_buffer,
+        double* dst_buffer,
+        uint32 size) const
+    {
+        const disable_sse_denormals disable_denormals;
 
-            // Handle any unaligned leftovers
-            src_buffer = (int32*)source_vector;
-            dst_buffer = (int32*)dest_vector;
+        const __m128d vlimit = _mm_set1_pd(double(3));
+        const __m128d vnegative_limit = _mm_set1_pd(double(-3));
+        const __m128d vnumerator = _mm_set1_pd(double(27));
+        const __m128d vdenominator = _mm_set1_pd(double(9));
+
+        const uint32 vector_samples = size & ~1;
+        for (uint32 i = 0; i < vector_samples; i += 2)
+        {
+            const __m128d value = _mm_min_pd(_mm_max_pd(_mm_loadu_pd(src_buffer + i), vnegative_limit), vlimit);
+            const __m128d square = _mm_mul_pd(value, value);
 
-            simd_unroll_tail_4(
-                *dst_buffer++ = *src_buffer++;
-            );
+            _mm_storeu_pd(dst_buffer + i, _mm_div_pd(_mm_mul_pd(value, _mm_add_pd(vnumerator, square)),
+                _mm_add_pd(vnumerator, _mm_mul_pd(vdenominator, square))));
         }
+
+        // Handle the leftovers
+        soft_clip_generic(src_buffer, dst_buffer, size, vector_samples);
     }
 
 
     //--------------------------------------------------------------------------
 
-    void add_buffers_int32(
-        int32* src_buffer_a,
-        int32* src_buffer_b,
-        int32* dst_buffer,
-        uint32 size) const
+    // both accuracies get a loop of their own so the polynomials are picked
+    // once per buffer, the floats need the integer instructions of SSE2 to
+    // build and split their exponents so they start here as well
+
+    #define math_sse2_transcendental_functions_impl(datatype, vector_type, vector_loadu, vector_storeu, vector_exp, vector_log, vector_sincos, vector_tanh, vector_pow) \
+        void exp_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 16 / sizeof(datatype); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_storeu(dst_buffer + i, vector_exp(vector_loadu(src_buffer + i), true)); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_storeu(dst_buffer + i, vector_exp(vector_loadu(src_buffer + i), false)); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            exp_generic(src_buffer, dst_buffer, size, accuracy, vector_samples); \
+        } \
+        \
+        void log_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 16 / sizeof(datatype); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_storeu(dst_buffer + i, vector_log(vector_loadu(src_buffer + i), true)); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_storeu(dst_buffer + i, vector_log(vector_loadu(src_buffer + i), false)); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            log_generic(src_buffer, dst_buffer, size, accuracy, vector_samples); \
+        } \
+        \
+        void sin_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 16 / sizeof(datatype); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_type sin_value, cos_value; \
+                    vector_sincos(vector_loadu(src_buffer + i), sin_value, cos_value, true); \
+                    vector_storeu(dst_buffer + i, sin_value); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_type sin_value, cos_value; \
+                    vector_sincos(vector_loadu(src_buffer + i), sin_value, cos_value, false); \
+                    vector_storeu(dst_buffer + i, sin_value); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            sincos_generic(src_buffer, dst_buffer, (datatype*)0, size, accuracy, vector_samples); \
+        } \
+        \
+        void cos_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 16 / sizeof(datatype); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_type sin_value, cos_value; \
+                    vector_sincos(vector_loadu(src_buffer + i), sin_value, cos_value, true); \
+                    vector_storeu(dst_buffer + i, cos_value); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_type sin_value, cos_value; \
+                    vector_sincos(vector_loadu(src_buffer + i), sin_value, cos_value, false); \
+                    vector_storeu(dst_buffer + i, cos_value); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            sincos_generic(src_buffer, (datatype*)0, dst_buffer, size, accuracy, vector_samples); \
+        } \
+        \
+        void sincos_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* sin_buffer, \
+            datatype* cos_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 16 / sizeof(datatype); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_type sin_value, cos_value; \
+                    vector_sincos(vector_loadu(src_buffer + i), sin_value, cos_value, true); \
+                    vector_storeu(sin_buffer + i, sin_value); \
+                    vector_storeu(cos_buffer + i, cos_value); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_type sin_value, cos_value; \
+                    vector_sincos(vector_loadu(src_buffer + i), sin_value, cos_value, false); \
+                    vector_storeu(sin_buffer + i, sin_value); \
+                    vector_storeu(cos_buffer + i, cos_value); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            sincos_generic(src_buffer, sin_buffer, cos_buffer, size, accuracy, vector_samples); \
+        } \
+        \
+        void tanh_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 16 / sizeof(datatype); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_storeu(dst_buffer + i, vector_tanh(vector_loadu(src_buffer + i), true)); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_storeu(dst_buffer + i, vector_tanh(vector_loadu(src_buffer + i), false)); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            tanh_generic(src_buffer, dst_buffer, size, accuracy, vector_samples); \
+        } \
+        \
+        void pow_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* exponent_buffer, \
+            datatype* dst_buffer, \
+            uint32 size, \
+            MathAccuracyTypes accuracy) const \
+        { \
+            const uint32 vector_size = 16 / sizeof(datatype); \
+            \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const uint32 vector_samples = size - size % vector_size; \
+            if (accuracy == ACCURATE_MATH_ACCURACY) \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_storeu(dst_buffer + i, vector_pow(vector_loadu(src_buffer + i), \
+                        vector_loadu(exponent_buffer + i), true)); \
+                } \
+            } \
+            else \
+            { \
+                for (uint32 i = 0; i < vector_samples; i += vector_size) \
+                { \
+                    vector_storeu(dst_buffer + i, vector_pow(vector_loadu(src_buffer + i), \
+                        vector_loadu(exponent_buffer + i), false)); \
+                } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            pow_generic(src_buffer, exponent_buffer, dst_buffer, size, accuracy, vector_samples); \
+        }
+
+    math_sse2_transcendental_functions_impl(float, __m128, _mm_loadu_ps, _mm_storeu_ps, exp_ps, log_ps, sincos_ps, tanh_ps, pow_ps)
+    math_sse2_transcendental_functions_impl(double, __m128d, _mm_loadu_pd, _mm_storeu_pd, exp_pd, log_pd, sincos_pd, tanh_pd, pow_pd)
+
+
+    //--------------------------------------------------------------------------
+
+    // 8 bit pixels are widened to 16 bit lanes, two pixels per register, where
+    // the products by 255 fit: vector_alpha broadcasts their alpha, SSSE3
+    // replaces it with a byte shuffle
+
+    // the pixels of the source and backdrop four at a time, widened, into the
+    // composited expression
+    #define math_sse2_composite_loop(expression) \
+        for (uint32 i = 0; i < vector_pixels; i += 4) \
+        { \
+            const __m128i source_pixels = _mm_loadu_si128((const __m128i*)(src_buffer + i * 4)); \
+            const __m128i backdrop_pixels = _mm_loadu_si128((const __m128i*)(backdrop_buffer + i * 4)); \
+            \
+            __m128i s = _mm_unpacklo_epi8(source_pixels, vzero); \
+            __m128i d = _mm_unpacklo_epi8(backdrop_pixels, vzero); \
+            const __m128i lo = expression; \
+            \
+            s = _mm_unpackhi_epi8(source_pixels, vzero); \
+            d = _mm_unpackhi_epi8(backdrop_pixels, vzero); \
+            const __m128i hi = expression; \
+            \
+            _mm_storeu_si128((__m128i*)(dst_buffer + i * 4), _mm_packus_epi16(lo, hi)); \
+        }
+
+    #define math_sse2_pixel_functions_impl(vector_alpha) \
+        void premultiply_rgba_uint8 ( \
+            uint8* src_buffer, \
+            uint8* dst_buffer, \
+            uint32 pixels) const \
+        { \
+            const __m128i vzero = _mm_setzero_si128(); \
+            \
+            /* Alpha is multiplied by 255, which leaves it as it is */ \
+            const __m128i alpha_one = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0); \
+            \
+            const uint32 vector_pixels = pixels & ~3; \
+            for (uint32 i = 0; i < vector_pixels; i += 4) \
+            { \
+                const __m128i pixel = _mm_loadu_si128((const __m128i*)(src_buffer + i * 4)); \
+                const __m128i lo = _mm_unpacklo_epi8(pixel, vzero); \
+                const __m128i hi = _mm_unpackhi_epi8(pixel, vzero); \
+                \
+                _mm_storeu_si128((__m128i*)(dst_buffer + i * 4), _mm_packus_epi16( \
+                    multiply_255_epi16(lo, _mm_or_si128(vector_alpha(lo), alpha_one)), \
+                    multiply_255_epi16(hi, _mm_or_si128(vector_alpha(hi), alpha_one)))); \
+            } \
+            \
+            /* Handle the leftovers */ \
+            premultiply_rgba_generic(src_buffer, dst_buffer, pixels, vector_pixels); \
+        } \
+        \
+        void unpremultiply_rgba_uint8 ( \
+            uint8* src_buffer, \
+            uint8* dst_buffer, \
+            uint32 pixels) const \
+        { \
+            const disable_sse_denormals disable_denormals; \
+            \
+            const __m128i vzero = _mm_setzero_si128(); \
+            const __m128i alpha_mask = _mm_set1_epi32((int)0xFF000000); \
+            \
+            const uint32 vector_pixels = pixels & ~3; \
+            for (uint32 i = 0; i < vector_pixels; i += 4) \
+            { \
+                const __m128i pixel = _mm_loadu_si128((const __m128i*)(src_buffer + i * 4)); \
+                const __m128i colour = _mm_packus_epi16( \
+                    unpremultiply_epi16(_mm_unpacklo_epi8(pixel, vzero)), \
+                    unpremultiply_epi16(_mm_unpackhi_epi8(pixel, vzero))); \
+                \
+                _mm_storeu_si128((__m128i*)(dst_buffer + i * 4), _mm_or_si128( \
+                    _mm_andnot_si128(alpha_mask, colour), _mm_and_si128(alpha_mask, pixel))); \
+            } \
+            \
+            /* Handle the leftovers */ \
+            unpremultiply_rgba_generic(src_buffer, dst_buffer, pixels, vector_pixels); \
+        } \
+        \
+        void composite_rgba_uint8 ( \
+            uint8* src_buffer, \
+            uint8* backdrop_buffer, \
+            uint8* dst_buffer, \
+            uint32 pixels, \
+            CompositeModeTypes mode) const \
+        { \
+            const __m128i vzero = _mm_setzero_si128(); \
+            const __m128i vmax = _mm_set1_epi16(255); \
+            \
+            const uint32 vector_pixels = pixels & ~3; \
+            switch (mode) \
+            { \
+            case MULTIPLY_COMPOSITE: \
+                math_sse2_composite_loop(multiply_pixel_epi16(s, d, vector_alpha(s), vector_alpha(d), vmax)) \
+                break; \
+            \
+            case SCREEN_COMPOSITE: \
+                math_sse2_composite_loop(screen_pixel_epi16(s, d)) \
+                break; \
+            \
+            case OVERLAY_COMPOSITE: \
+                math_sse2_composite_loop(overlay_pixel_epi16(s, d, vector_alpha(s), vector_alpha(d), vmax)) \
+                break; \
+            \
+            case ADD_COMPOSITE: \
+                /* Saturated bytes need no widening */ \
+                for (uint32 i = 0; i < vector_pixels; i += 4) \
+                { \
+                    _mm_storeu_si128((__m128i*)(dst_buffer + i * 4), _mm_adds_epu8( \
+                        _mm_loadu_si128((const __m128i*)(src_buffer + i * 4)), \
+                        _mm_loadu_si128((const __m128i*)(backdrop_buffer + i * 4)))); \
+                } \
+                break; \
+            \
+            default: \
+            { \
+                const uint32 source = porter_duff_factor(mode, true); \
+                const uint32 backdrop = porter_duff_factor(mode, false); \
+                const __m128i source_mask = _mm_set1_epi16(pixel_factor_mask(source)); \
+                const __m128i source_invert = _mm_set1_epi16(pixel_factor_invert(source)); \
+                const __m128i backdrop_mask = _mm_set1_epi16(pixel_factor_mask(backdrop)); \
+                const __m128i backdrop_invert = _mm_set1_epi16(pixel_factor_invert(backdrop)); \
+                \
+                math_sse2_composite_loop(_mm_add_epi16( \
+                    multiply_255_epi16(s, _mm_xor_si128(_mm_and_si128(vector_alpha(d), source_mask), source_invert)), \
+                    multiply_255_epi16(d, _mm_xor_si128(_mm_and_si128(vector_alpha(s), backdrop_mask), backdrop_invert)))) \
+                break; \
+            } \
+            } \
+            \
+            /* Handle the leftovers */ \
+            composite_rgba_generic(src_buffer, backdrop_buffer, dst_buffer, pixels, mode, vector_pixels); \
+        }
+
+    math_sse2_pixel_functions_impl(alpha_epi16)
+
+
+    //--------------------------------------------------------------------------
+
+    void pack_rgba_planes_uint8(
+        uint8* red_buffer,
+        uint8* green_buffer,
+        uint8* blue_buffer,
+        uint8* alpha_buffer,
+        uint8* dst_buffer,
+        uint32 pixels) const
     {
-        const ptrdiff_t align_bytes =
-            ((ptrdiff_t)dst_buffer & SSE2_ALIGN);
+        const __m128i opaque = _mm_set1_epi8((char)0xFF);
 
-        if (size < SSE2_MIN_SAMPLES ||
-            (align_bytes != ((ptrdiff_t)src_buffer_a & SSE2_ALIGN) ||
-             align_bytes != ((ptrdiff_t)src_buffer_b & SSE2_ALIGN)))
+        const uint32 vector_pixels = pixels & ~15;
+        for (uint32 i = 0; i < vector_pixels; i += 16)
         {
-            math_sse::add_buffers_int32(src_buffer_a, src_buffer_b, dst_buffer, size);
+            store_rgba_epi8(dst_buffer + i * 4,
+                _mm_loadu_si128((const __m128i*)(red_buffer + i)),
+                _mm_loadu_si128((const __m128i*)(green_buffer + i)),
+                _mm_loadu_si128((const __m128i*)(blue_buffer + i)),
+                alpha_buffer ? _mm_loadu_si128((const __m128i*)(alpha_buffer + i)) : opaque);
         }
-        else
+
+        // Handle the leftovers
+        pack_rgba_planes_generic(red_buffer, green_buffer, blue_buffer, alpha_buffer, dst_buffer, pixels, vector_pixels);
+    }
+
+    void unpack_rgba_planes_uint8(
+        uint8* src_buffer,
+        uint8* red_buffer,
+        uint8* green_buffer,
+        uint8* blue_buffer,
+        uint8* alpha_buffer,
+        uint32 pixels) const
+    {
+        const uint32 vector_pixels = pixels & ~15;
+        for (uint32 i = 0; i < vector_pixels; i += 16)
+        {
+            __m128i rgba[4];
+            for (uint32 j = 0; j < 4; ++j)
+                rgba[j] = _mm_loadu_si128((const __m128i*)(src_buffer + i * 4 + j * 16));
+
+            _mm_storeu_si128((__m128i*)(red_buffer + i), rgba_channel_epi8(rgba, 0));
+            _mm_storeu_si128((__m128i*)(green_buffer + i), rgba_channel_epi8(rgba, 8));
+            _mm_storeu_si128((__m128i*)(blue_buffer + i), rgba_channel_epi8(rgba, 16));
+            if (alpha_buffer)
+                _mm_storeu_si128((__m128i*)(alpha_buffer + i), rgba_channel_epi8(rgba, 24));
+        }
+
+        // Handle the leftovers
+        unpack_rgba_planes_generic(src_buffer, red_buffer, green_buffer, blue_buffer, alpha_buffer, pixels, vector_pixels);
+    }
+
+protected:
+
+    //--------------------------------------------------------------------------
+
+    math_sse2_mixing_kernels_impl(double, __m128d, _mm_set1_pd, _mm_loadu_pd, _mm_mul_pd, _mm_add_pd)
+
+
+    //--------------------------------------------------------------------------
+
+    // 16 pixels or 8 chroma samples at a time, the madd of 16 bit channels by
+    // the 16 bit weights gives the same 32 bit sums of the fpu
+
+    void rgba_to_luma_row_uint8(
+        uint8* src_buffer,
+        uint8* dst_buffer,
+        uint32 pixels,
+        const color_matrix& matrix) const
+    {
+        const __m128i weights = color_weights_epi16(matrix.y_red, matrix.y_green, matrix.y_blue);
+        const __m128i rounding = _mm_set1_epi32(matrix.luma_rounding);
+
+        const uint32 vector_pixels = pixels & ~15;
+        for (uint32 i = 0; i < vector_pixels; i += 16)
         {
-            assert(size >= SSE2_MIN_SIZE);
+            __m128i luma[4];
+            for (uint32 j = 0; j < 4; ++j)
+            {
+                const __m128i rgba = _mm_loadu_si128((const __m128i*)(src_buffer + i * 4 + j * 16));
+
+                luma[j] = _mm_srai_epi32(_mm_add_epi32(weight_pixels_epi32(
+                    _mm_unpacklo_epi8(rgba, _mm_setzero_si128()),
+                    _mm_unpackhi_epi8(rgba, _mm_setzero_si128()), weights), rounding), 15);
+            }
+
+            _mm_storeu_si128((__m128i*)(dst_buffer + i), pack_epi32_epi8(luma));
+        }
+
+        // Handle the leftovers
+        rgba_to_luma_generic(src_buffer, dst_buffer, pixels, matrix, vector_pixels);
+    }
+
+    void rgba_to_chroma_row_uint8(
+        uint8* src_buffer,
+        uint8* next_buffer,
+        uint8* u_buffer,
+        uint8* v_buffer,
+        uint32 step,
+        uint32 pixels,
+        const color_matrix& matrix) const
+    {
+        const __m128i u_weights = color_weights_epi16(matrix.u_red, matrix.u_green, matrix.u_blue);
+        const __m128i v_weights = color_weights_epi16(matrix.v_red, matrix.v_green, matrix.v_blue);
+        const __m128i rounding = _mm_set1_epi32(matrix.chroma_rounding);
 
-            // Copy unaligned head
-            simd_unroll_head_4(
-                --size;
-                *dst_buffer++ = *src_buffer_a++ + *src_buffer_b++;
-            );
+        const uint32 vector_samples = (pixels / 2) & ~7;
+        for (uint32 i = 0; i < vector_samples; i += 8)
+        {
+            // Sums of the 2x2 blocks, two blocks of 16 bit channels each
+            __m128i sums[4];
+            for (uint32 j = 0; j < 4; ++j)
+            {
+                sums[j] = block_sums_epi16(
+                    _mm_loadu_si128((const __m128i*)(src_buffer + i * 8 + j * 16)),
+                    _mm_loadu_si128((const __m128i*)(next_buffer + i * 8 + j * 16)));
+            }
 
-            // Scale with simd
-            __m128i* vector_buffer_a = (__m128i*)src_buffer_a;
-            __m128i* vector_buffer_b = (__m128i*)src_buffer_b;
-            __m128i* vector_dst_buffer = (__m128i*)dst_buffer;
+            __m128i chroma[4];
+            chroma[0] = _mm_srai_epi32(_mm_add_epi32(weight_pixels_epi32(sums[0], sums[1], u_weights), rounding), 17);
+            chroma[1] = _mm_srai_epi32(_mm_add_epi32(weight_pixels_epi32(sums[2], sums[3], u_weights), rounding), 17);
+            chroma[2] = _mm_srai_epi32(_mm_add_epi32(weight_pixels_epi32(sums[0], sums[1], v_weights), rounding), 17);
+            chroma[3] = _mm_srai_epi32(_mm_add_epi32(weight_pixels_epi32(sums[2], sums[3], v_weights), rounding), 17);
 
-            uint32 vector_count = size >> 2;
-            while (vector_count--)
+            // U samples in the low half, V ones in the high half
+            const __m128i uv = pack_epi32_epi8(chroma);
+            if (step == 1)
             {
-                *vector_dst_buffer =
-                  _mm_add_epi32(*vector_buffer_a, *vector_buffer_b);
+                _mm_storel_epi64((__m128i*)(u_buffer + i), uv);
+                _mm_storel_epi64((__m128i*)(v_buffer + i), _mm_srli_si128(uv, 8));
+            }
+            else
+            {
+                _mm_storeu_si128((__m128i*)(u_buffer + i * 2), _mm_unpacklo_epi8(uv, _mm_srli_si128(uv, 8)));
+            }
+        }
 
-                ++vector_buffer_a;
-                ++vector_buffer_b;
-                ++vector_dst_buffer;
+        // Handle the leftovers
+        rgba_to_chroma_generic(src_buffer, next_buffer, u_buffer, v_buffer, step, pixels, matrix, vector_samples);
+    }
+
+    void yuv_to_rgba_row_uint8(
+        uint8* y_buffer,
+        uint8* u_buffer,
+        uint8* v_buffer,
+        uint32 step,
+        uint8* dst_buffer,
+        uint32 pixels,
+        const color_matrix& matrix) const
+    {
+        const __m128i vzero = _mm_setzero_si128();
+        const __m128i luma_weights = _mm_set_epi16(1 << 12, matrix.luma, 1 << 12, matrix.luma, 1 << 12, matrix.luma, 1 << 12, matrix.luma);
+        const __m128i luma_offset = _mm_set1_epi16((short)matrix.luma_offset);
+        const __m128i chroma_offset = _mm_set1_epi16(128);
+        const __m128i low_mask = _mm_set1_epi16(0xFF);
+        const __m128i one = _mm_set1_epi16(1);
+        const __m128i red_weights = _mm_set_epi16(matrix.red_v, 0, matrix.red_v, 0, matrix.red_v, 0, matrix.red_v, 0);
+        const __m128i green_weights = _mm_set_epi16(matrix.green_v, matrix.green_u, matrix.green_v, matrix.green_u,
+            matrix.green_v, matrix.green_u, matrix.green_v, matrix.green_u);
+        const __m128i blue_weights = _mm_set_epi16(0, matrix.blue_u, 0, matrix.blue_u, 0, matrix.blue_u, 0, matrix.blue_u);
+
+        const uint32 vector_pixels = pixels & ~15;
+        for (uint32 i = 0; i < vector_pixels; i += 16)
+        {
+            __m128i u, v;
+            if (step == 1)
+            {
+                u = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(u_buffer + i / 2)), vzero);
+                v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(v_buffer + i / 2)), vzero);
+            }
+            else
+            {
+                const __m128i uv = _mm_loadu_si128((const __m128i*)(u_buffer + i));
+                u = _mm_and_si128(uv, low_mask);
+                v = _mm_srli_epi16(uv, 8);
             }
 
-            // Handle any unaligned leftovers
-            src_buffer_a = (int32*)vector_buffer_a;
-            src_buffer_b = (int32*)vector_buffer_b;
-            dst_buffer = (int32*)vector_dst_buffer;
+            // U, V pairs of 8 samples, each one repeated for two pixels
+            const __m128i uv_lo = _mm_unpacklo_epi16(_mm_sub_epi16(u, chroma_offset), _mm_sub_epi16(v, chroma_offset));
+            const __m128i uv_hi = _mm_unpackhi_epi16(_mm_sub_epi16(u, chroma_offset), _mm_sub_epi16(v, chroma_offset));
+
+            __m128i chroma[4];
+            chroma[0] = _mm_unpacklo_epi32(uv_lo, uv_lo);
+            chroma[1] = _mm_unpackhi_epi32(uv_lo, uv_lo);
+            chroma[2] = _mm_unpacklo_epi32(uv_hi, uv_hi);
+            chroma[3] = _mm_unpackhi_epi32(uv_hi, uv_hi);
+
+            // Luma paired with one, to add the rounding in the same madd
+            const __m128i y = _mm_loadu_si128((const __m128i*)(y_buffer + i));
+            const __m128i y_lo = _mm_sub_epi16(_mm_unpacklo_epi8(y, vzero), luma_offset);
+            const __m128i y_hi = _mm_sub_epi16(_mm_unpackhi_epi8(y, vzero), luma_offset);
+
+            __m128i luma[4];
+            luma[0] = _mm_madd_epi16(_mm_unpacklo_epi16(y_lo, one), luma_weights);
+            luma[1] = _mm_madd_epi16(_mm_unpackhi_epi16(y_lo, one), luma_weights);
+            luma[2] = _mm_madd_epi16(_mm_unpacklo_epi16(y_hi, one), luma_weights);
+            luma[3] = _mm_madd_epi16(_mm_unpackhi_epi16(y_hi, one), luma_weights);
+
+            store_rgba_epi8(dst_buffer + i * 4,
+                rgb_channel_epi8(luma, chroma, red_weights),
+                rgb_channel_epi8(luma, chroma, green_weights),
+                rgb_channel_epi8(luma, chroma, blue_weights),
+                _mm_set1_epi8((char)0xFF));
+        }
+
+        // Handle the leftovers
+        yuv_to_rgba_generic(y_buffer, u_buffer, v_buffer, step, dst_buffer, pixels, matrix, vector_pixels);
+    }
+
+    void luma_to_rgba_row_uint8(
+        uint8* src_buffer,
+        uint8* dst_buffer,
+        uint32 pixels,
+        const color_matrix& matrix) const
+    {
+        const __m128i vzero = _mm_setzero_si128();
+        const __m128i luma_weights = _mm_set_epi16(1 << 12, matrix.luma, 1 << 12, matrix.luma, 1 << 12, matrix.luma, 1 << 12, matrix.luma);
+        const __m128i luma_offset = _mm_set1_epi16((short)matrix.luma_offset);
+        const __m128i one = _mm_set1_epi16(1);
 
-            simd_unroll_tail_4(
-                *dst_buffer++ = *src_buffer_a++ + *src_buffer_b++;
-            );
+        const uint32 vector_pixels = pixels & ~15;
+        for (uint32 i = 0; i < vector_pixels; i += 16)
+        {
+            const __m128i y = _mm_loadu_si128((const __m128i*)(src_buffer + i));
+            const __m128i y_lo = _mm_sub_epi16(_mm_unpacklo_epi8(y, vzero), luma_offset);
+            const __m128i y_hi = _mm_sub_epi16(_mm_unpackhi_epi8(y, vzero), luma_offset);
+
+            __m128i gray[4];
+            gray[0] = _mm_srai_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(y_lo, one), luma_weights), 13);
+            gray[1] = _mm_srai_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(y_lo, one), luma_weights), 13);
+            gray[2] = _mm_srai_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(y_hi, one), luma_weights), 13);
+            gray[3] = _mm_srai_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(y_hi, one), luma_weights), 13);
+
+            const __m128i g = pack_epi32_epi8(gray);
+            store_rgba_epi8(dst_buffer + i * 4, g, g, g, _mm_set1_epi8((char)0xFF));
         }
+
+        // Handle the leftovers
+        luma_to_rgba_generic(src_buffer, dst_buffer, pixels, matrix, vector_pixels);
     }
 
 
     //--------------------------------------------------------------------------
 
-    void subtract_buffers_int32(
-        int32* src_buffer_a,
-        int32* src_buffer_b,
-        int32* dst_buffer,
-        uint32 size) const
+    void resize_row_uint8(
+        uint8* src_buffer,
+        float* dst_buffer,
+        uint32 width,
+        uint32 channels,
+        float* coefficients,
+        uint32 taps,
+        uint32* offsets) const
     {
-        const ptrdiff_t align_bytes =
-            ((ptrdiff_t)dst_buffer & SSE2_ALIGN);
+        if (channels == 4)
+        {
+            const disable_sse_denormals disable_denormals;
 
-        if (size < SSE2_MIN_SAMPLES ||
-            (align_bytes != ((ptrdiff_t)src_buffer_a & SSE2_ALIGN) ||
-             align_bytes != ((ptrdiff_t)src_buffer_b & SSE2_ALIGN)))
+            // a register holds the four channels of a pixel
+            for (uint32 i = 0; i < width; ++i)
+            {
+                const uint8* window = src_buffer + offsets[i] * 4;
+                const float* coefficient = coefficients + i * taps;
+                __m128 sum = _mm_setzero_ps();
+
+                for (uint32 k = 0; k < taps; ++k)
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(coefficient[k]), load_epu8_ps(window + k * 4)));
+
+                _mm_storeu_ps(dst_buffer + i * 4, sum);
+            }
+        }
+        else if (channels == 1 && taps >= 4)
         {
-            math_sse::subtract_buffers_int32(src_buffer_a, src_buffer_b, dst_buffer, size);
+            const disable_sse_denormals disable_denormals;
+
+            const uint32 vector_taps = taps & ~3;
+
+            for (uint32 i = 0; i < width; ++i)
+            {
+                const uint8* window = src_buffer + offsets[i];
+                const float* coefficient = coefficients + i * taps;
+                __m128 sum = _mm_setzero_ps();
+
+                for (uint32 k = 0; k < vector_taps; k += 4)
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(coefficient + k), load_epu8_ps(window + k)));
+
+                float sums[4];
+                _mm_storeu_ps(sums, sum);
+
+                // Handle the leftover taps
+                float total = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+                for (uint32 k = vector_taps; k < taps; ++k)
+                    total += coefficient[k] * float(window[k]);
+
+                dst_buffer[i] = total;
+            }
         }
         else
         {
-            assert(size >= SSE2_MIN_SIZE);
+            math_sse::resize_row_uint8(src_buffer, dst_buffer, width, channels, coefficients, taps, offsets);
+        }
+    }
+
+    void resize_column_tile_uint8(
+        float* src_buffer,
+        uint32 src_stride,
+        uint8* dst_buffer,
+        uint32 dst_stride,
+        uint32 columns,
+        uint32 height,
+        float* coefficients,
+        uint32 taps,
+        uint32* offsets) const
+    {
+        const disable_sse_denormals disable_denormals;
 
-            // Copy unaligned head
-            simd_unroll_head_4(
-                --size;
-                *dst_buffer++ = *src_buffer_a++ - *src_buffer_b++;
-            );
+        // 16 columns a step, converted with the default round to nearest and
+        // saturated by the packs
+        const uint32 vector_columns = columns & ~15;
 
-            // Scale with simd
-            __m128i* vector_buffer_a = (__m128i*)src_buffer_a;
-            __m128i* vector_buffer_b = (__m128i*)src_buffer_b;
-            __m128i* vector_dst_buffer = (__m128i*)dst_buffer;
+        for (uint32 row = 0; row < height; ++row)
+        {
+            const float* window = src_buffer + offsets[row] * src_stride;
+            const float* coefficient = coefficients + row * taps;
+            uint8* dst_row = dst_buffer + row * dst_stride;
 
-            uint32 vector_count = size >> 2;
-            while (vector_count--)
+            for (uint32 i = 0; i < vector_columns; i += 16)
             {
-                *vector_dst_buffer =
-                  _mm_sub_epi32(*vector_buffer_a, *vector_buffer_b);
+                __m128 sum[4] = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+
+                for (uint32 k = 0; k < taps; ++k)
+                {
+                    const float* src_row = window + k * src_stride + i;
+                    const __m128 weight = _mm_set1_ps(coefficient[k]);
+
+                    for (uint32 j = 0; j < 4; ++j)
+                        sum[j] = _mm_add_ps(sum[j], _mm_mul_ps(weight, _mm_loadu_ps(src_row + j * 4)));
+                }
 
-                ++vector_buffer_a;
-                ++vector_buffer_b;
-                ++vector_dst_buffer;
+                __m128i values[4];
+                for (uint32 j = 0; j < 4; ++j)
+                    values[j] = _mm_cvtps_epi32(sum[j]);
+
+                _mm_storeu_si128((__m128i*)(dst_row + i), pack_epi32_epi8(values));
             }
+        }
+
+        // Handle the leftover columns
+        resize_column_tile_generic(src_buffer, src_stride, dst_buffer, dst_stride,
+            columns, height, coefficients, taps, offsets, vector_columns);
+    }
 
-            // Handle any unaligned leftovers
-            src_buffer_a = (int32*)vector_buffer_a;
-            src_buffer_b = (int32*)vector_buffer_b;
-            dst_buffer = (int32*)vector_dst_buffer;
 
-            simd_unroll_tail_4(
-                *dst_buffer++ = *src_buffer_a++ - *src_buffer_b++;
-            );
+    //--------------------------------------------------------------------------
+
+    void fft_radix4_pass_double(
+        double* real_buffer,
+        double* imag_buffer,
+        uint32 size,
+        uint32 span,
+        const double* twiddles) const
+    {
+        if (span < 2)
+        {
+            math_sse::fft_radix4_pass_double(real_buffer, imag_buffer, size, span, twiddles);
+        }
+        else
+        {
+            const disable_sse_denormals disable_denormals;
+
+            // Two values of k per register, as in the float pass
+            for (uint32 group = 0; group < size; group += 4 * span)
+            {
+                double* real = real_buffer + group;
+                double* imag = imag_buffer + group;
+
+                for (uint32 k = 0; k < span; k += 2)
+                {
+                    const __m128d w1_real = _mm_loadu_pd(twiddles + k);
+                    const __m128d w1_imag = _mm_loadu_pd(twiddles + span + k);
+                    const __m128d w2_real = _mm_loadu_pd(twiddles + 2 * span + k);
+                    const __m128d w2_imag = _mm_loadu_pd(twiddles + 3 * span + k);
+                    const __m128d w3_real = _mm_loadu_pd(twiddles + 4 * span + k);
+                    const __m128d w3_imag = _mm_loadu_pd(twiddles + 5 * span + k);
+
+                    const __m128d a_real = _mm_loadu_pd(real + k);
+                    const __m128d a_imag = _mm_loadu_pd(imag + k);
+                    const __m128d x1_real = _mm_loadu_pd(real + span + k);
+                    const __m128d x1_imag = _mm_loadu_pd(imag + span + k);
+                    const __m128d x2_real = _mm_loadu_pd(real + 2 * span + k);
+                    const __m128d x2_imag = _mm_loadu_pd(imag + 2 * span + k);
+                    const __m128d x3_real = _mm_loadu_pd(real + 3 * span + k);
+                    const __m128d x3_imag = _mm_loadu_pd(imag + 3 * span + k);
+
+                    const __m128d b_real = _mm_sub_pd(_mm_mul_pd(x1_real, w2_real), _mm_mul_pd(x1_imag, w2_imag));
+                    const __m128d b_imag = _mm_add_pd(_mm_mul_pd(x1_real, w2_imag), _mm_mul_pd(x1_imag, w2_real));
+                    const __m128d c_real = _mm_sub_pd(_mm_mul_pd(x2_real, w1_real), _mm_mul_pd(x2_imag, w1_imag));
+                    const __m128d c_imag = _mm_add_pd(_mm_mul_pd(x2_real, w1_imag), _mm_mul_pd(x2_imag, w1_real));
+                    const __m128d d_real = _mm_sub_pd(_mm_mul_pd(x3_real, w3_real), _mm_mul_pd(x3_imag, w3_imag));
+                    const __m128d d_imag = _mm_add_pd(_mm_mul_pd(x3_real, w3_imag), _mm_mul_pd(x3_imag, w3_real));
+
+                    const __m128d t0_real = _mm_add_pd(a_real, b_real);
+                    const __m128d t0_imag = _mm_add_pd(a_imag, b_imag);
+                    const __m128d t1_real = _mm_sub_pd(a_real, b_real);
+                    const __m128d t1_imag = _mm_sub_pd(a_imag, b_imag);
+                    const __m128d t2_real = _mm_add_pd(c_real, d_real);
+                    const __m128d t2_imag = _mm_add_pd(c_imag, d_imag);
+                    const __m128d t3_real = _mm_sub_pd(c_real, d_real);
+                    const __m128d t3_imag = _mm_sub_pd(c_imag, d_imag);
+
+                    _mm_storeu_pd(real + k, _mm_add_pd(t0_real, t2_real));
+                    _mm_storeu_pd(imag + k, _mm_add_pd(t0_imag, t2_imag));
+                    _mm_storeu_pd(real + span + k, _mm_add_pd(t1_real, t3_imag));
+                    _mm_storeu_pd(imag + span + k, _mm_sub_pd(t1_imag, t3_real));
+                    _mm_storeu_pd(real + 2 * span + k, _mm_sub_pd(t0_real, t2_real));
+                    _mm_storeu_pd(imag + 2 * span + k, _mm_sub_pd(t0_imag, t2_imag));
+                    _mm_storeu_pd(real + 3 * span + k, _mm_sub_pd(t1_real, t3_imag));
+                    _mm_storeu_pd(imag + 3 * span + k, _mm_add_pd(t1_imag, t3_real));
+                }
+            }
         }
     }
 
 
+    //--------------------------------------------------------------------------
+
+    template<typename T> static forcedinline T abs_scalar(T value)
+    {
+        return value < T(0) ? static_cast<T>(0 - static_cast<uint64>(value)) : value;
+    }
+
+    static forcedinline double abs_scalar(double value)
+    {
+        return std::fabs(value);
+    }
+
+    static forcedinline double madd_scalar(double a, double b, double c)
+    {
+        return a * b + c;
+    }
+
+    static forcedinline __m128d madd_pd(__m128d a, __m128d b, __m128d c)
+    {
+        return _mm_add_pd(_mm_mul_pd(a, b), c);
+    }
+
+    static forcedinline __m128i abs_epi8(__m128i value)
+    {
+        const __m128i sign = _mm_cmpgt_epi8(_mm_setzero_si128(), value);
+        return _mm_sub_epi8(_mm_xor_si128(value, sign), sign);
+    }
+
+    static forcedinline __m128i abs_epi16(__m128i value)
+    {
+        const __m128i sign = _mm_srai_epi16(value, 15);
+        return _mm_sub_epi16(_mm_xor_si128(value, sign), sign);
+    }
+
+    static forcedinline __m128i abs_epi32(__m128i value)
+    {
+        const __m128i sign = _mm_srai_epi32(value, 31);
+        return _mm_sub_epi32(_mm_xor_si128(value, sign), sign);
+    }
+
+    static forcedinline __m128i abs_epi64(__m128i value)
+    {
+        // spread the sign of the high halves over the whole 64 bit lanes
+        const __m128i sign = _mm_shuffle_epi32(
+            _mm_srai_epi32(value, 31), _MM_SHUFFLE(3, 3, 1, 1));
+        return _mm_sub_epi64(_mm_xor_si128(value, sign), sign);
+    }
+
+    static forcedinline __m128d abs_pd(__m128d value)
+    {
+        return _mm_andnot_pd(_mm_set1_pd(-0.0), value);
+    }
+
+    // a > b ? greater : otherwise, lane by lane
+    static forcedinline __m128d select_greater_pd(__m128d a, __m128d b, __m128d greater, __m128d otherwise)
+    {
+        const __m128d mask = _mm_cmpgt_pd(a, b);
+        return _mm_or_pd(_mm_and_pd(mask, greater), _mm_andnot_pd(mask, otherwise));
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // mask ? value : otherwise, lane by lane
+    static forcedinline __m128 select_ps(__m128 mask, __m128 value, __m128 otherwise)
+    {
+        return _mm_or_ps(_mm_and_ps(mask, value), _mm_andnot_ps(mask, otherwise));
+    }
+
+    static forcedinline __m128d select_pd(__m128d mask, __m128d value, __m128d otherwise)
+    {
+        return _mm_or_pd(_mm_and_pd(mask, value), _mm_andnot_pd(mask, otherwise));
+    }
+
+    // rounds to the nearest integer, pushing the fraction out of the mantissa
+    static forcedinline __m128 round_ps(__m128 value)
+    {
+        const __m128 magic = _mm_set1_ps(12582912.0f);
+        return _mm_sub_ps(_mm_add_ps(value, magic), magic);
+    }
+
+    static forcedinline __m128d round_pd(__m128d value)
+    {
+        const __m128d magic = _mm_set1_pd(6755399441055744.0);
+        return _mm_sub_pd(_mm_add_pd(value, magic), magic);
+    }
+
+    // 2^n for the integers n of a normal exponent
+    static forcedinline __m128 pow2_ps(__m128 n)
+    {
+        return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(n), _mm_set1_epi32(127)), 23));
+    }
+
+    static forcedinline __m128d pow2_pd(__m128d n)
+    {
+        // the biased exponents go in the high words of the lanes
+        const __m128i exponents = _mm_add_epi32(_mm_cvtpd_epi32(n), _mm_set1_epi32(1023));
+        return _mm_castsi128_pd(_mm_unpacklo_epi32(_mm_setzero_si128(), _mm_slli_epi32(exponents, 20)));
+    }
+
+    template<uint32 count> static forcedinline __m128 polynomial_ps(__m128 x, const float (&coefficients)[count])
+    {
+        __m128 result = _mm_set1_ps(coefficients[0]);
+        for (uint32 i = 1; i < count; ++i)
+        {
+            result = _mm_add_ps(_mm_mul_ps(result, x), _mm_set1_ps(coefficients[i]));
+        }
+
+        return result;
+    }
+
+    template<uint32 count> static forcedinline __m128d polynomial_pd(__m128d x, const double (&coefficients)[count])
+    {
+        __m128d result = _mm_set1_pd(coefficients[0]);
+        for (uint32 i = 1; i < count; ++i)
+        {
+            result = _mm_add_pd(_mm_mul_pd(result, x), _mm_set1_pd(coefficients[i]));
+        }
+
+        return result;
+    }
+
+    // e^r - 1 for |r| <= log(2) / 2
+    static forcedinline __m128 expm1_ps(__m128 r, bool accurate)
+    {
+        const __m128 p = accurate
+            ? polynomial_ps(r, accurate_exp_coefficients_float)
+            : polynomial_ps(r, fast_exp_coefficients_float);
+
+        return _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r), p));
+    }
+
+    static forcedinline __m128d expm1_pd(__m128d r, bool accurate)
+    {
+        const __m128d p = accurate
+            ? polynomial_pd(r, accurate_exp_coefficients_double)
+            : polynomial_pd(r, fast_exp_coefficients_double);
+
+        return _mm_add_pd(r, _mm_mul_pd(_mm_mul_pd(r, r), p));
+    }
+
+    // the same reductions as exp_scalar, the top of the range needs 2^128 so
+    // the scaling is split in 2^min(n, 127) and the 1 or 2 left
+    static forcedinline __m128 exp_ps(__m128 x, bool accurate)
+    {
+        const __m128 high = _mm_set1_ps(88.72283172607421875f);
+        const __m128 low = _mm_set1_ps(-87.33654022216796875f);
+        const __m128 one = _mm_set1_ps(1.0f);
+
+        const __m128 clamped = _mm_min_ps(_mm_max_ps(x, low), high);
+        const __m128 n = round_ps(_mm_mul_ps(clamped, _mm_set1_ps(1.44269504088896341f)));
+        const __m128 r = _mm_sub_ps(_mm_sub_ps(clamped, _mm_mul_ps(n, _mm_set1_ps(0.693359375f))),
+            _mm_mul_ps(n, _mm_set1_ps(-2.12194440e-4f)));
+
+        const __m128 normal = _mm_min_ps(n, _mm_set1_ps(127.0f));
+        __m128 result = _mm_mul_ps(_mm_mul_ps(_mm_add_ps(expm1_ps(r, accurate), one), pow2_ps(normal)),
+            _mm_add_ps(one, _mm_sub_ps(n, normal)));
+
+        result = select_ps(_mm_cmpgt_ps(x, high), _mm_set1_ps(std::numeric_limits<float>::infinity()), result);
+        result = _mm_and_ps(_mm_cmpnlt_ps(x, low), result);
+
+        return select_ps(_mm_cmpunord_ps(x, x), x, result);
+    }
+
+    static forcedinline __m128d exp_pd(__m128d x, bool accurate)
+    {
+        const __m128d high = _mm_set1_pd(709.782712893383);
+        const __m128d low = _mm_set1_pd(-708.396418532264);
+        const __m128d one = _mm_set1_pd(1.0);
+
+        const __m128d clamped = _mm_min_pd(_mm_max_pd(x, low), high);
+        const __m128d n = round_pd(_mm_mul_pd(clamped, _mm_set1_pd(1.4426950408889634074)));
+        const __m128d r = _mm_sub_pd(_mm_sub_pd(clamped, _mm_mul_pd(n, _mm_set1_pd(6.93147180369123816490e-1))),
+            _mm_mul_pd(n, _mm_set1_pd(1.90821492927058770002e-10)));
+
+        const __m128d normal = _mm_min_pd(n, _mm_set1_pd(1023.0));
+        __m128d result = _mm_mul_pd(_mm_mul_pd(_mm_add_pd(expm1_pd(r, accurate), one), pow2_pd(normal)),
+            _mm_add_pd(one, _mm_sub_pd(n, normal)));
+
+        result = select_pd(_mm_cmpgt_pd(x, high), _mm_set1_pd(std::numeric_limits<double>::infinity()), result);
+        result = _mm_and_pd(_mm_cmpnlt_pd(x, low), result);
+
+        return select_pd(_mm_cmpunord_pd(x, x), x, result);
+    }
+
+    // the exponent and mantissa come out of the bits, zero and denormals give
+    // minus infinity and anything not positive a NaN
+    static forcedinline __m128 log_ps(__m128 x, bool accurate)
+    {
+        const __m128 one = _mm_set1_ps(1.0f);
+
+        __m128 e = _mm_sub_ps(_mm_cvtepi32_ps(_mm_srli_epi32(_mm_castps_si128(x), 23)), _mm_set1_ps(127.0f));
+        __m128 m = _mm_or_ps(_mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x007fffff))), one);
+
+        const __m128 above = _mm_cmpgt_ps(m, _mm_set1_ps(1.41421356237309505f));
+        m = select_ps(above, _mm_mul_ps(m, _mm_set1_ps(0.5f)), m);
+        e = _mm_add_ps(e, _mm_and_ps(above, one));
+
+        const __m128 s = _mm_div_ps(_mm_sub_ps(m, one), _mm_add_ps(m, one));
+        const __m128 w = _mm_mul_ps(s, s);
+        const __m128 q = accurate
+            ? polynomial_ps(w, accurate_log_coefficients_float)
+            : polynomial_ps(w, fast_log_coefficients_float);
+
+        const __m128 log_m = _mm_add_ps(_mm_add_ps(s, s), _mm_mul_ps(_mm_mul_ps(s, w), q));
+        __m128 result = _mm_add_ps(_mm_mul_ps(e, _mm_set1_ps(0.693359375f)),
+            _mm_add_ps(log_m, _mm_mul_ps(e, _mm_set1_ps(-2.12194440e-4f))));
+
+        result = select_ps(_mm_cmpeq_ps(x, _mm_set1_ps(std::numeric_limits<float>::infinity())), x, result);
+        result = select_ps(_mm_cmpeq_ps(x, _mm_setzero_ps()), _mm_set1_ps(-std::numeric_limits<float>::infinity()), result);
+
+        return select_ps(_mm_cmpnge_ps(x, _mm_setzero_ps()), _mm_set1_ps(std::numeric_limits<float>::quiet_NaN()), result);
+    }
+
+    static forcedinline __m128d log_pd(__m128d x, bool accurate)
+    {
+        const __m128d one = _mm_set1_pd(1.0);
+
+        const __m128i exponents = _mm_shuffle_epi32(_mm_srli_epi64(_mm_castpd_si128(x), 52), _MM_SHUFFLE(3, 1, 2, 0));
+        __m128d e = _mm_sub_pd(_mm_cvtepi32_pd(exponents), _mm_set1_pd(1023.0));
+        __m128d m = _mm_or_pd(_mm_and_pd(x, _mm_castsi128_pd(_mm_set1_epi64x(0x000fffffffffffffLL))), one);
+
+        const __m128d above = _mm_cmpgt_pd(m, _mm_set1_pd(1.41421356237309504880));
+        m = select_pd(above, _mm_mul_pd(m, _mm_set1_pd(0.5)), m);
+        e = _mm_add_pd(e, _mm_and_pd(above, one));
+
+        const __m128d s = _mm_div_pd(_mm_sub_pd(m, one), _mm_add_pd(m, one));
+        const __m128d w = _mm_mul_pd(s, s);
+        const __m128d q = accurate
+            ? polynomial_pd(w, accurate_log_coefficients_double)
+            : polynomial_pd(w, fast_log_coefficients_double);
+
+        const __m128d log_m = _mm_add_pd(_mm_add_pd(s, s), _mm_mul_pd(_mm_mul_pd(s, w), q));
+        __m128d result = _mm_add_pd(_mm_mul_pd(e, _mm_set1_pd(6.93147180369123816490e-1)),
+            _mm_add_pd(log_m, _mm_mul_pd(e, _mm_set1_pd(1.90821492927058770002e-10))));
+
+        result = select_pd(_mm_cmpeq_pd(x, _mm_set1_pd(std::numeric_limits<double>::infinity())), x, result);
+        result = select_pd(_mm_cmpeq_pd(x, _mm_setzero_pd()), _mm_set1_pd(-std::numeric_limits<double>::infinity()), result);
+
+        return select_pd(_mm_cmpnge_pd(x, _mm_setzero_pd()), _mm_set1_pd(std::numeric_limits<double>::quiet_NaN()), result);
+    }
+
+    // r = x - j pi / 2 with pi / 2 in four parts, the first three of 33 bits
+    // so their products by j are exact. From 2^30 on r has lost most of its
+    // bits and would grow past the polynomials, so those arguments reduce as
+    // zeros: x - x keeps infinities and NaNs as NaNs
+    static forcedinline __m128d reduce_angle_pd(__m128d x, __m128d& j)
+    {
+        x = select_pd(_mm_cmpge_pd(_mm_andnot_pd(_mm_set1_pd(-0.0), x), _mm_set1_pd(1073741824.0)), _mm_sub_pd(x, x), x);
+        j = round_pd(_mm_mul_pd(x, _mm_set1_pd(6.36619772367581382433e-1)));
+
+        return _mm_sub_pd(_mm_sub_pd(_mm_sub_pd(_mm_sub_pd(x,
+            _mm_mul_pd(j, _mm_set1_pd(1.57079632673412561417))),
+            _mm_mul_pd(j, _mm_set1_pd(6.07710050630396597660e-11))),
+            _mm_mul_pd(j, _mm_set1_pd(2.02226624871116645580e-21))),
+            _mm_mul_pd(j, _mm_set1_pd(8.47842766036889956997e-32)));
+    }
+
+    // the odd quadrants swap the polynomials, the sign flips follow the
+    // second bit of the quadrant, plus one for the cosine. Floats are reduced
+    // in double two at a time, close to the zeros a float pi / 2 loses r
+    static forcedinline void sincos_ps(__m128 x, __m128& sin_value, __m128& cos_value, bool accurate)
+    {
+        __m128d j_lo, j_hi;
+        const __m128 r = _mm_movelh_ps(
+            _mm_cvtpd_ps(reduce_angle_pd(_mm_cvtps_pd(x), j_lo)),
+            _mm_cvtpd_ps(reduce_angle_pd(_mm_cvtps_pd(_mm_movehl_ps(x, x)), j_hi)));
+        const __m128 z = _mm_mul_ps(r, r);
+
+        const __m128 sine = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, z), accurate
+            ? polynomial_ps(z, accurate_sin_coefficients_float)
+            : polynomial_ps(z, fast_sin_coefficients_float)));
+        const __m128 cosine = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(z, _mm_set1_ps(0.5f))),
+            _mm_mul_ps(_mm_mul_ps(z, z), accurate
+                ? polynomial_ps(z, accurate_cos_coefficients_float)
+                : polynomial_ps(z, fast_cos_coefficients_float)));
+
+        const __m128i quadrant = _mm_unpacklo_epi64(_mm_cvtpd_epi32(j_lo), _mm_cvtpd_epi32(j_hi));
+        const __m128i one = _mm_set1_epi32(1);
+        const __m128i two = _mm_set1_epi32(2);
+        const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+
+        sin_value = _mm_xor_ps(select_ps(swap, cosine, sine),
+            _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30)));
+        cos_value = _mm_xor_ps(select_ps(swap, sine, cosine),
+            _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30)));
+    }
+
+    static forcedinline void sincos_pd(__m128d x, __m128d& sin_value, __m128d& cos_value, bool accurate)
+    {
+        __m128d j;
+        const __m128d r = reduce_angle_pd(x, j);
+        const __m128d z = _mm_mul_pd(r, r);
+
+        const __m128d sine = _mm_add_pd(r, _mm_mul_pd(_mm_mul_pd(r, z), accurate
+            ? polynomial_pd(z, accurate_sin_coefficients_double)
+            : polynomial_pd(z, fast_sin_coefficients_double)));
+        const __m128d cosine = _mm_add_pd(_mm_sub_pd(_mm_set1_pd(1.0), _mm_mul_pd(z, _mm_set1_pd(0.5))),
+            _mm_mul_pd(_mm_mul_pd(z, z), accurate
+                ? polynomial_pd(z, accurate_cos_coefficients_double)
+                : polynomial_pd(z, fast_cos_coefficients_double)));
+
+        // both words of a lane hold its quadrant, the sign mask keeps the
+        // flip to the top bit
+        const __m128i quadrant = _mm_shuffle_epi32(_mm_cvtpd_epi32(j), _MM_SHUFFLE(1, 1, 0, 0));
+        const __m128i one = _mm_set1_epi32(1);
+        const __m128i two = _mm_set1_epi32(2);
+        const __m128d swap = _mm_castsi128_pd(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+        const __m128d sign = _mm_set1_pd(-0.0);
+
+        sin_value = _mm_xor_pd(select_pd(swap, cosine, sine), _mm_and_pd(sign,
+            _mm_castsi128_pd(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30))));
+        cos_value = _mm_xor_pd(select_pd(swap, sine, cosine), _mm_and_pd(sign,
+            _mm_castsi128_pd(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30))));
+    }
+
+    // tanh |x| is -u / (2 + u) for u = e^(-2 |x|) - 1, with the sign of x
+    static forcedinline __m128 tanh_ps(__m128 x, bool accurate)
+    {
+        const __m128 sign = _mm_set1_ps(-0.0f);
+
+        const __m128 a = _mm_mul_ps(_mm_min_ps(_mm_andnot_ps(sign, x), _mm_set1_ps(9.0f)), _mm_set1_ps(-2.0f));
+        const __m128 n = round_ps(_mm_mul_ps(a, _mm_set1_ps(1.44269504088896341f)));
+        const __m128 r = _mm_sub_ps(_mm_sub_ps(a, _mm_mul_ps(n, _mm_set1_ps(0.693359375f))),
+            _mm_mul_ps(n, _mm_set1_ps(-2.12194440e-4f)));
+
+        const __m128 scale = pow2_ps(n);
+        const __m128 u = _mm_add_ps(_mm_mul_ps(scale, expm1_ps(r, accurate)), _mm_sub_ps(scale, _mm_set1_ps(1.0f)));
+        const __m128 result = _mm_or_ps(_mm_div_ps(_mm_sub_ps(_mm_setzero_ps(), u), _mm_add_ps(_mm_set1_ps(2.0f), u)),
+            _mm_and_ps(sign, x));
+
+        return select_ps(_mm_cmpunord_ps(x, x), x, result);
+    }
+
+    static forcedinline __m128d tanh_pd(__m128d x, bool accurate)
+    {
+        const __m128d sign = _mm_set1_pd(-0.0);
+
+        const __m128d a = _mm_mul_pd(_mm_min_pd(_mm_andnot_pd(sign, x), _mm_set1_pd(20.0)), _mm_set1_pd(-2.0));
+        const __m128d n = round_pd(_mm_mul_pd(a, _mm_set1_pd(1.4426950408889634074)));
+        const __m128d r = _mm_sub_pd(_mm_sub_pd(a, _mm_mul_pd(n, _mm_set1_pd(6.93147180369123816490e-1))),
+            _mm_mul_pd(n, _mm_set1_pd(1.90821492927058770002e-10)));
+
+        const __m128d scale = pow2_pd(n);
+        const __m128d u = _mm_add_pd(_mm_mul_pd(scale, expm1_pd(r, accurate)), _mm_sub_pd(scale, _mm_set1_pd(1.0)));
+        const __m128d result = _mm_or_pd(_mm_div_pd(_mm_sub_pd(_mm_setzero_pd(), u), _mm_add_pd(_mm_set1_pd(2.0), u)),
+            _mm_and_pd(sign, x));
+
+        return select_pd(_mm_cmpunord_pd(x, x), x, result);
+    }
+
+    // the accurate powers of floats go through the fast double functions,
+    // like pow_scalar does
+    static forcedinline __m128 pow_ps(__m128 x, __m128 y, bool accurate)
+    {
+        if (accurate)
+        {
+            const __m128d low = exp_pd(_mm_mul_pd(_mm_cvtps_pd(y), log_pd(_mm_cvtps_pd(x), false)), false);
+            const __m128d high = exp_pd(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(y, y)),
+                log_pd(_mm_cvtps_pd(_mm_movehl_ps(x, x)), false)), false);
+
+            return _mm_movelh_ps(_mm_cvtpd_ps(low), _mm_cvtpd_ps(high));
+        }
+
+        return exp_ps(_mm_mul_ps(y, log_ps(x, false)), false);
+    }
+
+    static forcedinline __m128d pow_pd(__m128d x, __m128d y, bool accurate)
+    {
+        return exp_pd(_mm_mul_pd(y, log_pd(x, accurate)), accurate);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline __m128i mullo_epi8(__m128i a, __m128i b)
+    {
+        // multiply even and odd bytes separately as 16 bit lanes
+        const __m128i even = _mm_mullo_epi16(a, b);
+        const __m128i odd = _mm_mullo_epi16(
+            _mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+
+        return _mm_or_si128(
+            _mm_slli_epi16(odd, 8),
+            _mm_and_si128(even, _mm_set1_epi16(0x00FF)));
+    }
+
+    static forcedinline __m128i mullo_epi32(__m128i a, __m128i b)
+    {
+        // multiply even and odd lanes as 64 bit, then keep the low halves
+        const __m128i even = _mm_mul_epu32(a, b);
+        const __m128i odd = _mm_mul_epu32(
+            _mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+
+        return _mm_unpacklo_epi32(
+            _mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+            _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+
+    static forcedinline __m128i mullo_epi64(__m128i a, __m128i b)
+    {
+        // lo(a) * lo(b) + ((hi(a) * lo(b) + lo(a) * hi(b)) << 32)
+        const __m128i lo = _mm_mul_epu32(a, b);
+        const __m128i cross = _mm_add_epi64(
+            _mm_mul_epu32(_mm_srli_epi64(a, 32), b),
+            _mm_mul_epu32(a, _mm_srli_epi64(b, 32)));
+
+        return _mm_add_epi64(lo, _mm_slli_epi64(cross, 32));
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline __m128i widen_lo_epi8(__m128i value)
+    {
+        return _mm_srai_epi16(_mm_unpacklo_epi8(value, value), 8);
+    }
+
+    static forcedinline __m128i widen_hi_epi8(__m128i value)
+    {
+        return _mm_srai_epi16(_mm_unpackhi_epi8(value, value), 8);
+    }
+
+    static forcedinline __m128i widen_lo_epi16(__m128i value)
+    {
+        return _mm_srai_epi32(_mm_unpacklo_epi16(value, value), 16);
+    }
+
+    static forcedinline __m128i widen_hi_epi16(__m128i value)
+    {
+        return _mm_srai_epi32(_mm_unpackhi_epi16(value, value), 16);
+    }
+
+    static forcedinline __m128i narrow_epi32_epi16(__m128i lo, __m128i hi)
+    {
+        // truncate like a static_cast: sign extend the low halves so the
+        // saturating pack never clamps
+        return _mm_packs_epi32(
+            _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16),
+            _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16));
+    }
+
+    static forcedinline __m128i narrow_epi16_epi8(__m128i lo, __m128i hi)
+    {
+        // truncate like a static_cast
+        const __m128i mask = _mm_set1_epi16(0x00FF);
+        return _mm_packus_epi16(
+            _mm_and_si128(lo, mask), _mm_and_si128(hi, mask));
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // four samples of the integer formats to and from 32 bit lanes, int24 go
+    // through the 48 bit pairs packed in each 64 bit half
+
+    static forcedinline __m128i load_samples(const int16* src_buffer)
+    {
+        return widen_lo_epi16(_mm_loadl_epi64((const __m128i*)src_buffer));
+    }
+
+    static forcedinline __m128i load_samples(const int32* src_buffer)
+    {
+        return _mm_loadu_si128((const __m128i*)src_buffer);
+    }
+
+    static forcedinline __m128i load_samples(const int24* src_buffer)
+    {
+        int32 tail;
+        std::memcpy(&tail, (const uint8*)src_buffer + 8, sizeof(tail));
+
+        const __m128i bytes = _mm_unpacklo_epi64(
+            _mm_loadl_epi64((const __m128i*)src_buffer), _mm_cvtsi32_si128(tail));
+        const __m128i pairs = _mm_or_si128(
+            _mm_and_si128(bytes, _mm_set_epi32(0, 0, 0x0000FFFF, -1)),
+            _mm_slli_si128(_mm_srli_si128(bytes, 6), 8));
+
+        // move each sample to the top of its lane, then sign extend it back
+        const __m128i even = _mm_set_epi32(0, -1, 0, -1);
+        return _mm_srai_epi32(_mm_or_si128(
+            _mm_and_si128(even, _mm_slli_epi64(pairs, 8)),
+            _mm_andnot_si128(even, _mm_slli_epi64(pairs, 16))), 8);
+    }
+
+    static forcedinline void store_samples(int16* dst_buffer, __m128i samples)
+    {
+        _mm_storel_epi64((__m128i*)dst_buffer, _mm_packs_epi32(samples, samples));
+    }
+
+    static forcedinline void store_samples(int32* dst_buffer, __m128i samples)
+    {
+        _mm_storeu_si128((__m128i*)dst_buffer, samples);
+    }
+
+    static forcedinline void store_samples(int24* dst_buffer, __m128i samples)
+    {
+        const __m128i low = _mm_and_si128(samples, _mm_set1_epi32(0x00FFFFFF));
+        const __m128i even = _mm_set_epi32(0, -1, 0, -1);
+        const __m128i pairs = _mm_or_si128(
+            _mm_and_si128(even, low), _mm_srli_epi64(_mm_andnot_si128(even, low), 8));
+        const __m128i bytes = _mm_or_si128(
+            _mm_and_si128(pairs, _mm_set_epi32(0, 0, 0x0000FFFF, -1)),
+            _mm_slli_si128(_mm_srli_si128(pairs, 8), 6));
+
+        const int32 tail = _mm_cvtsi128_si32(_mm_srli_si128(bytes, 8));
+        _mm_storel_epi64((__m128i*)dst_buffer, bytes);
+        std::memcpy((uint8*)dst_buffer + 8, &tail, sizeof(tail));
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline void store_scaled_samples(float* dst_buffer, __m128i samples, float scale)
+    {
+        _mm_storeu_ps(dst_buffer, _mm_mul_ps(_mm_cvtepi32_ps(samples), _mm_set1_ps(scale)));
+    }
+
+    static forcedinline void store_scaled_samples(double* dst_buffer, __m128i samples, double scale)
+    {
+        const __m128d vscale = _mm_set1_pd(scale);
+
+        _mm_storeu_pd(dst_buffer, _mm_mul_pd(_mm_cvtepi32_pd(samples), vscale));
+        _mm_storeu_pd(dst_buffer + 2, _mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(samples, 8)), vscale));
+    }
+
+    // lanes at or above max_value saturate to max_sample, for float int32 the
+    // rounded max_value would overflow
+    static forcedinline __m128i round_samples(
+        const float* src_buffer,
+        const integer_format<float>& format,
+        bool dither,
+        __m128i vindex)
+    {
+        __m128 value = _mm_mul_ps(_mm_loadu_ps(src_buffer), _mm_set1_ps(format.range));
+
+        if (dither)
+        {
+            value = _mm_add_ps(value, _mm_mul_ps(
+                _mm_cvtepi32_ps(tpdf_dither_epi32(vindex)), _mm_set1_ps(1.0f / 65536.0f)));
+        }
+
+        const __m128 vmax = _mm_set1_ps(format.max_value);
+        const __m128i saturated = _mm_castps_si128(_mm_cmpge_ps(value, vmax));
+        const __m128i samples = _mm_cvtps_epi32(
+            _mm_min_ps(_mm_max_ps(value, _mm_set1_ps(format.min_value)), vmax));
+
+        return _mm_or_si128(_mm_andnot_si128(saturated, samples),
+            _mm_and_si128(saturated, _mm_set1_epi32(format.max_sample)));
+    }
+
+    // max_value is exact for doubles, clamping is enough
+    static forcedinline __m128i round_samples(
+        const double* src_buffer,
+        const integer_format<double>& format,
+        bool dither,
+        __m128i vindex)
+    {
+        const __m128d vscale = _mm_set1_pd(format.range);
+        const __m128d vmin = _mm_set1_pd(format.min_value);
+        const __m128d vmax = _mm_set1_pd(format.max_value);
+
+        __m128d lo = _mm_mul_pd(_mm_loadu_pd(src_buffer), vscale);
+        __m128d hi = _mm_mul_pd(_mm_loadu_pd(src_buffer + 2), vscale);
+
+        if (dither)
+        {
+            const __m128i noise = tpdf_dither_epi32(vindex);
+            const __m128d vdither = _mm_set1_pd(1.0 / 65536.0);
+
+            lo = _mm_add_pd(lo, _mm_mul_pd(_mm_cvtepi32_pd(noise), vdither));
+            hi = _mm_add_pd(hi, _mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(noise, 8)), vdither));
+        }
+
+        return _mm_unpacklo_epi64(
+            _mm_cvtpd_epi32(_mm_min_pd(_mm_max_pd(lo, vmin), vmax)),
+            _mm_cvtpd_epi32(_mm_min_pd(_mm_max_pd(hi, vmin), vmax)));
+    }
+
+    // the tpdf_dither of the fpu on four sample indices
+    static forcedinline __m128i tpdf_dither_epi32(__m128i vindex)
+    {
+        __m128i hash = _mm_xor_si128(vindex, _mm_srli_epi32(vindex, 16));
+        hash = mullo_epi32(hash, _mm_set1_epi32(0x7feb352d));
+        hash = _mm_xor_si128(hash, _mm_srli_epi32(hash, 15));
+        hash = mullo_epi32(hash, _mm_set1_epi32((int32)0x846ca68bU));
+        hash = _mm_xor_si128(hash, _mm_srli_epi32(hash, 16));
+
+        return _mm_sub_epi32(_mm_add_epi32(
+            _mm_and_si128(hash, _mm_set1_epi32(0xFFFF)), _mm_srli_epi32(hash, 16)),
+            _mm_set1_epi32(65535));
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline __m128i widen_lo_epi32(__m128i value)
+    {
+        return _mm_unpacklo_epi32(value, _mm_srai_epi32(value, 31));
+    }
+
+    static forcedinline __m128i widen_hi_epi32(__m128i value)
+    {
+        return _mm_unpackhi_epi32(value, _mm_srai_epi32(value, 31));
+    }
+
+    static forcedinline __m128i mul_epi32(__m128i a, __m128i b)
+    {
+        // signed 64 bit products of the even lanes, out of the unsigned ones
+        const __m128i sign_a = _mm_srai_epi32(a, 31);
+        const __m128i sign_b = _mm_srai_epi32(b, 31);
+        const __m128i correction = _mm_add_epi64(
+            _mm_slli_epi64(_mm_and_si128(sign_a, b), 32),
+            _mm_slli_epi64(_mm_and_si128(sign_b, a), 32));
+
+        return _mm_sub_epi64(_mm_mul_epu32(a, b), correction);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // integer reductions accumulate two 64 bit lanes, the compensation is
+    // only used by the floating point ones
+    static forcedinline void sum_epi8(__m128i& sum, __m128i&, __m128i value)
+    {
+        // bias to unsigned bytes for sad, then take the bias of 8 bytes back
+        const __m128i bias = _mm_set1_epi8((char)0x80);
+        sum = _mm_add_epi64(sum, _mm_sub_epi64(
+            _mm_sad_epu8(_mm_xor_si128(value, bias), _mm_setzero_si128()),
+            _mm_set1_epi64x(8 * 128)));
+    }
+
+    static forcedinline void sum_epu8(__m128i& sum, __m128i&, __m128i value)
+    {
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(value, _mm_setzero_si128()));
+    }
+
+    static forcedinline void sum_epi16(__m128i& sum, __m128i&, __m128i value)
+    {
+        const __m128i pairs = _mm_madd_epi16(value, _mm_set1_epi16(1));
+        sum = _mm_add_epi64(sum,
+            _mm_add_epi64(widen_lo_epi32(pairs), widen_hi_epi32(pairs)));
+    }
+
+    static forcedinline void sum_epu16(__m128i& sum, __m128i&, __m128i value)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i pairs = _mm_add_epi32(
+            _mm_unpacklo_epi16(value, zero), _mm_unpackhi_epi16(value, zero));
+        sum = _mm_add_epi64(sum, _mm_add_epi64(
+            _mm_unpacklo_epi32(pairs, zero), _mm_unpackhi_epi32(pairs, zero)));
+    }
+
+    static forcedinline void sum_epi32(__m128i& sum, __m128i&, __m128i value)
+    {
+        sum = _mm_add_epi64(sum,
+            _mm_add_epi64(widen_lo_epi32(value), widen_hi_epi32(value)));
+    }
+
+    static forcedinline void sum_epu32(__m128i& sum, __m128i&, __m128i value)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        sum = _mm_add_epi64(sum, _mm_add_epi64(
+            _mm_unpacklo_epi32(value, zero), _mm_unpackhi_epi32(value, zero)));
+    }
+
+    static forcedinline void sum_epi64(__m128i& sum, __m128i&, __m128i value)
+    {
+        sum = _mm_add_epi64(sum, value);
+    }
+
+    static forcedinline void kahan_add_pd(__m128d& sum, __m128d& compensation, __m128d value)
+    {
+        const __m128d y = _mm_sub_pd(value, compensation);
+        const __m128d t = _mm_add_pd(sum, y);
+        compensation = _mm_sub_pd(_mm_sub_pd(t, sum), y);
+        sum = t;
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline void dot_epi8(__m128i& sum, __m128i& compensation, __m128i a, __m128i b)
+    {
+        // pairs of 8 bit products can't overflow 32 bit lanes
+        sum_epi32(sum, compensation, _mm_add_epi32(
+            _mm_madd_epi16(widen_lo_epi8(a), widen_lo_epi8(b)),
+            _mm_madd_epi16(widen_hi_epi8(a), widen_hi_epi8(b))));
+    }
+
+    static forcedinline void dot_epu8(__m128i& sum, __m128i& compensation, __m128i a, __m128i b)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        sum_epu32(sum, compensation, _mm_add_epi32(
+            _mm_madd_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)),
+            _mm_madd_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero))));
+    }
+
+    static forcedinline void dot_epi16(__m128i& sum, __m128i& compensation, __m128i a, __m128i b)
+    {
+        // full 32 bit products, a pair of them could overflow so widen each
+        const __m128i lo = _mm_mullo_epi16(a, b);
+        const __m128i hi = _mm_mulhi_epi16(a, b);
+        sum_epi32(sum, compensation, _mm_unpacklo_epi16(lo, hi));
+        sum_epi32(sum, compensation, _mm_unpackhi_epi16(lo, hi));
+    }
+
+    static forcedinline void dot_epu16(__m128i& sum, __m128i& compensation, __m128i a, __m128i b)
+    {
+        const __m128i lo = _mm_mullo_epi16(a, b);
+        const __m128i hi = _mm_mulhi_epu16(a, b);
+        sum_epu32(sum, compensation, _mm_unpacklo_epi16(lo, hi));
+        sum_epu32(sum, compensation, _mm_unpackhi_epi16(lo, hi));
+    }
+
+    static forcedinline void dot_epi32(__m128i& sum, __m128i&, __m128i a, __m128i b)
+    {
+        sum = _mm_add_epi64(sum, _mm_add_epi64(mul_epi32(a, b),
+            mul_epi32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32))));
+    }
+
+    static forcedinline void dot_epu32(__m128i& sum, __m128i&, __m128i a, __m128i b)
+    {
+        sum = _mm_add_epi64(sum, _mm_add_epi64(_mm_mul_epu32(a, b),
+            _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32))));
+    }
+
+    static forcedinline void dot_epi64(__m128i& sum, __m128i&, __m128i a, __m128i b)
+    {
+        sum = _mm_add_epi64(sum, mullo_epi64(a, b));
+    }
+
+    static forcedinline void dot_pd(__m128d& sum, __m128d& compensation, __m128d a, __m128d b)
+    {
+        kahan_add_pd(sum, compensation, _mm_mul_pd(a, b));
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline uint64 reduce_epi64(__m128i sum, __m128i)
+    {
+        uint64 lanes[2];
+        _mm_storeu_si128((__m128i*)lanes, sum);
+        return lanes[0] + lanes[1];
+    }
+
+    static forcedinline double reduce_kahan_pd(__m128d sum, __m128d compensation)
+    {
+        double sums[2], compensations[2];
+        _mm_storeu_pd(sums, sum);
+        _mm_storeu_pd(compensations, compensation);
+        return (sums[0] - compensations[0]) + (sums[1] - compensations[1]);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline __m128i select_si128(__m128i mask, __m128i a, __m128i b)
+    {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    }
+
+    static forcedinline __m128i min_epi8(__m128i a, __m128i b)
+    {
+        const __m128i bias = _mm_set1_epi8((char)0x80);
+        return _mm_xor_si128(bias, _mm_min_epu8(
+            _mm_xor_si128(a, bias), _mm_xor_si128(b, bias)));
+    }
+
+    static forcedinline __m128i max_epi8(__m128i a, __m128i b)
+    {
+        const __m128i bias = _mm_set1_epi8((char)0x80);
+        return _mm_xor_si128(bias, _mm_max_epu8(
+            _mm_xor_si128(a, bias), _mm_xor_si128(b, bias)));
+    }
+
+    static forcedinline __m128i min_epu16(__m128i a, __m128i b)
+    {
+        const __m128i bias = _mm_set1_epi16((short)0x8000);
+        return _mm_xor_si128(bias, _mm_min_epi16(
+            _mm_xor_si128(a, bias), _mm_xor_si128(b, bias)));
+    }
+
+    static forcedinline __m128i max_epu16(__m128i a, __m128i b)
+    {
+        const __m128i bias = _mm_set1_epi16((short)0x8000);
+        return _mm_xor_si128(bias, _mm_max_epi16(
+            _mm_xor_si128(a, bias), _mm_xor_si128(b, bias)));
+    }
+
+    static forcedinline __m128i min_epi32(__m128i a, __m128i b)
+    {
+        return select_si128(_mm_cmplt_epi32(a, b), a, b);
+    }
+
+    static forcedinline __m128i max_epi32(__m128i a, __m128i b)
+    {
+        return select_si128(_mm_cmpgt_epi32(a, b), a, b);
+    }
+
+    static forcedinline __m128i min_epu32(__m128i a, __m128i b)
+    {
+        const __m128i bias = _mm_set1_epi32((int)0x80000000);
+        return select_si128(_mm_cmplt_epi32(
+            _mm_xor_si128(a, bias), _mm_xor_si128(b, bias)), a, b);
+    }
+
+    static forcedinline __m128i max_epu32(__m128i a, __m128i b)
+    {
+        const __m128i bias = _mm_set1_epi32((int)0x80000000);
+        return select_si128(_mm_cmpgt_epi32(
+            _mm_xor_si128(a, bias), _mm_xor_si128(b, bias)), a, b);
+    }
+
+    static forcedinline __m128d peak_pd(__m128d value, __m128d peak)
+    {
+        return _mm_max_pd(abs_pd(value), peak);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline __m128d cvtepu32_pd(__m128i value)
+    {
+        // bias the unsigned lanes into the signed range, exact in doubles
+        return _mm_add_pd(
+            _mm_cvtepi32_pd(_mm_xor_si128(value, _mm_set1_epi32((int)0x80000000))),
+            _mm_set1_pd(2147483648.0));
+    }
+
+    static forcedinline __m128 cvtepu32_ps(__m128i value)
+    {
+        // convert as unsigned splitting in two exact 16 bit halves
+        const __m128 vhi = _mm_cvtepi32_ps(_mm_srli_epi32(value, 16));
+        const __m128 vlo = _mm_cvtepi32_ps(
+            _mm_and_si128(value, _mm_set1_epi32(0xFFFF)));
+
+        return _mm_add_ps(_mm_mul_ps(vhi, _mm_set1_ps(65536.0f)), vlo);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline __m128i scale_epi32(__m128i value, __m128 vscale)
+    {
+        return _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(value), vscale));
+    }
+
+    static forcedinline __m128i scale_epi32(__m128i value, __m128d vscale)
+    {
+        const __m128i lo = _mm_cvttpd_epi32(
+            _mm_mul_pd(_mm_cvtepi32_pd(value), vscale));
+        const __m128i hi = _mm_cvttpd_epi32(
+            _mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(value, 8)), vscale));
+
+        return _mm_unpacklo_epi64(lo, hi);
+    }
+
+    static forcedinline __m128i scale_epu32(__m128i value, __m128 vscale)
+    {
+        return _mm_cvttps_epi32(_mm_mul_ps(cvtepu32_ps(value), vscale));
+    }
+
+    static forcedinline __m128i scale_epu32(__m128i value, __m128d vscale)
+    {
+        const __m128i lo = _mm_cvttpd_epi32(
+            _mm_mul_pd(cvtepu32_pd(value), vscale));
+        const __m128i hi = _mm_cvttpd_epi32(
+            _mm_mul_pd(cvtepu32_pd(_mm_srli_si128(value, 8)), vscale));
+
+        return _mm_unpacklo_epi64(lo, hi);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    template<typename vector_type>
+    static forcedinline __m128i scale_vector_int8(__m128i value, vector_type vscale)
+    {
+        return narrow_epi16_epi8(
+            scale_vector_int16(widen_lo_epi8(value), vscale),
+            scale_vector_int16(widen_hi_epi8(value), vscale));
+    }
+
+    template<typename vector_type>
+    static forcedinline __m128i scale_vector_uint8(__m128i value, vector_type vscale)
+    {
+        const __m128i zero = _mm_setzero_si128();
+
+        return narrow_epi16_epi8(
+            scale_vector_int16(_mm_unpacklo_epi8(value, zero), vscale),
+            scale_vector_int16(_mm_unpackhi_epi8(value, zero), vscale));
+    }
+
+    template<typename vector_type>
+    static forcedinline __m128i scale_vector_int16(__m128i value, vector_type vscale)
+    {
+        return narrow_epi32_epi16(
+            scale_epi32(widen_lo_epi16(value), vscale),
+            scale_epi32(widen_hi_epi16(value), vscale));
+    }
+
+    template<typename vector_type>
+    static forcedinline __m128i scale_vector_uint16(__m128i value, vector_type vscale)
+    {
+        const __m128i zero = _mm_setzero_si128();
+
+        return narrow_epi32_epi16(
+            scale_epi32(_mm_unpacklo_epi16(value, zero), vscale),
+            scale_epi32(_mm_unpackhi_epi16(value, zero), vscale));
+    }
+
+    template<typename vector_type>
+    static forcedinline __m128i scale_vector_int32(__m128i value, vector_type vscale)
+    {
+        return scale_epi32(value, vscale);
+    }
+
+    template<typename vector_type>
+    static forcedinline __m128i scale_vector_uint32(__m128i value, vector_type vscale)
+    {
+        return scale_epu32(value, vscale);
+    }
+
+    static forcedinline __m128d scale_vector_double(__m128d value, __m128d vscale)
+    {
+        return _mm_mul_pd(value, vscale);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // the products are clamped to the range of the datatype before being
+    // truncated, so the saturating packs below never clamp anything else
+
+    static forcedinline __m128i scale_saturate_epi32(__m128i value, __m128 vscale, float lowest, float highest)
+    {
+        return _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(
+            _mm_mul_ps(_mm_cvtepi32_ps(value), vscale), _mm_set1_ps(lowest)), _mm_set1_ps(highest)));
+    }
+
+    static forcedinline __m128i scale_saturate_vector_int8(__m128i value, __m128 vscale)
+    {
+        const __m128i lo = widen_lo_epi8(value);
+        const __m128i hi = widen_hi_epi8(value);
+
+        return _mm_packs_epi16(
+            _mm_packs_epi32(
+                scale_saturate_epi32(widen_lo_epi16(lo), vscale, -128.0f, 127.0f),
+                scale_saturate_epi32(widen_hi_epi16(lo), vscale, -128.0f, 127.0f)),
+            _mm_packs_epi32(
+                scale_saturate_epi32(widen_lo_epi16(hi), vscale, -128.0f, 127.0f),
+                scale_saturate_epi32(widen_hi_epi16(hi), vscale, -128.0f, 127.0f)));
+    }
+
+    static forcedinline __m128i scale_saturate_vector_uint8(__m128i value, __m128 vscale)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i lo = _mm_unpacklo_epi8(value, zero);
+        const __m128i hi = _mm_unpackhi_epi8(value, zero);
+
+        return _mm_packus_epi16(
+            _mm_packs_epi32(
+                scale_saturate_epi32(_mm_unpacklo_epi16(lo, zero), vscale, 0.0f, 255.0f),
+                scale_saturate_epi32(_mm_unpackhi_epi16(lo, zero), vscale, 0.0f, 255.0f)),
+            _mm_packs_epi32(
+                scale_saturate_epi32(_mm_unpacklo_epi16(hi, zero), vscale, 0.0f, 255.0f),
+                scale_saturate_epi32(_mm_unpackhi_epi16(hi, zero), vscale, 0.0f, 255.0f)));
+    }
+
+    static forcedinline __m128i scale_saturate_vector_int16(__m128i value, __m128 vscale)
+    {
+        return _mm_packs_epi32(
+            scale_saturate_epi32(widen_lo_epi16(value), vscale, -32768.0f, 32767.0f),
+            scale_saturate_epi32(widen_hi_epi16(value), vscale, -32768.0f, 32767.0f));
+    }
+
+    static forcedinline __m128i scale_saturate_vector_uint16(__m128i value, __m128 vscale)
+    {
+        // there is no unsigned 32 bit pack before SSE4.1, the lanes are
+        // moved to the signed range around it
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i offset = _mm_set1_epi32(32768);
+
+        const __m128i packed = _mm_packs_epi32(
+            _mm_sub_epi32(scale_saturate_epi32(
+                _mm_unpacklo_epi16(value, zero), vscale, 0.0f, 65535.0f), offset),
+            _mm_sub_epi32(scale_saturate_epi32(
+                _mm_unpackhi_epi16(value, zero), vscale, 0.0f, 65535.0f), offset));
+
+        return _mm_xor_si128(packed, _mm_set1_epi16((short)0x8000));
+    }
+
+    static forcedinline __m128i avg_epi8(__m128i a, __m128i b)
+    {
+        const __m128i bias = _mm_set1_epi8((char)0x80);
+        return _mm_xor_si128(_mm_avg_epu8(
+            _mm_xor_si128(a, bias), _mm_xor_si128(b, bias)), bias);
+    }
+
+    static forcedinline __m128i avg_epi16(__m128i a, __m128i b)
+    {
+        const __m128i bias = _mm_set1_epi16((short)0x8000);
+        return _mm_xor_si128(_mm_avg_epu16(
+            _mm_xor_si128(a, bias), _mm_xor_si128(b, bias)), bias);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // there is no integer division in SSE2: 8 and 16 bit lanes are divided as
+    // floats, 32 bit lanes as doubles, both represent the quotient exactly
+    // enough for the truncation to match the integer division
+
+    static forcedinline __m128i div_epi32_ps(__m128i a, __m128i b)
+    {
+        return _mm_cvttps_epi32(
+            _mm_div_ps(_mm_cvtepi32_ps(a), _mm_cvtepi32_ps(b)));
+    }
+
+    static forcedinline __m128i div_epi16(__m128i a, __m128i b)
+    {
+        return narrow_epi32_epi16(
+            div_epi32_ps(widen_lo_epi16(a), widen_lo_epi16(b)),
+            div_epi32_ps(widen_hi_epi16(a), widen_hi_epi16(b)));
+    }
+
+    static forcedinline __m128i div_epu16(__m128i a, __m128i b)
+    {
+        const __m128i zero = _mm_setzero_si128();
+
+        return narrow_epi32_epi16(
+            div_epi32_ps(_mm_unpacklo_epi16(a, zero), _mm_unpacklo_epi16(b, zero)),
+            div_epi32_ps(_mm_unpackhi_epi16(a, zero), _mm_unpackhi_epi16(b, zero)));
+    }
+
+    static forcedinline __m128i div_epi8(__m128i a, __m128i b)
+    {
+        return narrow_epi16_epi8(
+            div_epi16(widen_lo_epi8(a), widen_lo_epi8(b)),
+            div_epi16(widen_hi_epi8(a), widen_hi_epi8(b)));
+    }
+
+    static forcedinline __m128i div_epu8(__m128i a, __m128i b)
+    {
+        const __m128i zero = _mm_setzero_si128();
+
+        return narrow_epi16_epi8(
+            div_epu16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)),
+            div_epu16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero)));
+    }
+
+    static forcedinline __m128i div_epi32(__m128i a, __m128i b)
+    {
+        const __m128i lo = _mm_cvttpd_epi32(_mm_div_pd(
+            _mm_cvtepi32_pd(a), _mm_cvtepi32_pd(b)));
+        const __m128i hi = _mm_cvttpd_epi32(_mm_div_pd(
+            _mm_cvtepi32_pd(_mm_srli_si128(a, 8)),
+            _mm_cvtepi32_pd(_mm_srli_si128(b, 8))));
+
+        return _mm_unpacklo_epi64(lo, hi);
+    }
+
+    static forcedinline __m128i cvttpd_epu32(__m128d value)
+    {
+        // quotients above the signed range are truncated after removing the
+        // bias, this is exact as they share the exponent with 2^31
+        const __m128d bias = _mm_set1_pd(2147483648.0);
+        const __m128i large = _mm_shuffle_epi32(
+            _mm_castpd_si128(_mm_cmpge_pd(value, bias)), _MM_SHUFFLE(3, 3, 2, 0));
+
+        const __m128i small_value = _mm_cvttpd_epi32(value);
+        const __m128i large_value = _mm_xor_si128(
+            _mm_cvttpd_epi32(_mm_sub_pd(value, bias)),
+            _mm_set1_epi32((int)0x80000000));
+
+        return _mm_or_si128(
+            _mm_and_si128(large, large_value),
+            _mm_andnot_si128(large, small_value));
+    }
+
+    static forcedinline __m128i div_epu32(__m128i a, __m128i b)
+    {
+        const __m128i lo = cvttpd_epu32(_mm_div_pd(
+            cvtepu32_pd(a), cvtepu32_pd(b)));
+        const __m128i hi = cvttpd_epu32(_mm_div_pd(
+            cvtepu32_pd(_mm_srli_si128(a, 8)),
+            cvtepu32_pd(_mm_srli_si128(b, 8))));
+
+        return _mm_unpacklo_epi64(lo, hi);
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // the alpha of the two pixels in 16 bit lanes in all of their lanes
+    static forcedinline __m128i alpha_epi16(__m128i pixels)
+    {
+        return _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    }
+
+    // the multiply_255 of the fpu, (t + (t >> 8)) >> 8 is the high half of
+    // t * 257
+    static forcedinline __m128i multiply_255_epi16(__m128i x, __m128i y)
+    {
+        return _mm_mulhi_epu16(_mm_add_epi16(_mm_mullo_epi16(x, y), _mm_set1_epi16(128)), _mm_set1_epi16(257));
+    }
+
+    // (c * 255 + a / 2) / a of one pixel in 32 bit lanes: the numerator and
+    // the quotient are small enough for the float division to truncate to
+    // the integer one
+    static forcedinline __m128i unpremultiply_epi32(__m128i pixel)
+    {
+        const __m128i alpha = _mm_shuffle_epi32(pixel, _MM_SHUFFLE(3, 3, 3, 3));
+        const __m128i numerator = _mm_add_epi32(_mm_sub_epi32(_mm_slli_epi32(pixel, 8), pixel), _mm_srli_epi32(alpha, 1));
+        const __m128 quotient = _mm_div_ps(_mm_cvtepi32_ps(numerator), _mm_max_ps(_mm_cvtepi32_ps(alpha), _mm_set1_ps(1.0f)));
+
+        return _mm_and_si128(_mm_cmpgt_epi32(alpha, _mm_setzero_si128()),
+            _mm_cvttps_epi32(_mm_min_ps(quotient, _mm_set1_ps(255.0f))));
+    }
+
+    static forcedinline __m128i unpremultiply_epi16(__m128i pixels)
+    {
+        const __m128i zero = _mm_setzero_si128();
+
+        return _mm_packs_epi32(unpremultiply_epi32(_mm_unpacklo_epi16(pixels, zero)),
+            unpremultiply_epi32(_mm_unpackhi_epi16(pixels, zero)));
+    }
+
+    // the blend modes of the fpu composite_channel on 8 bit channels in 16
+    // bit lanes, the results are clamped when packed back
+    static forcedinline __m128i multiply_pixel_epi16(__m128i s, __m128i d, __m128i sa, __m128i da, __m128i max)
+    {
+        return _mm_add_epi16(_mm_add_epi16(multiply_255_epi16(s, _mm_xor_si128(da, max)),
+            multiply_255_epi16(d, _mm_xor_si128(sa, max))), multiply_255_epi16(s, d));
+    }
+
+    static forcedinline __m128i screen_pixel_epi16(__m128i s, __m128i d)
+    {
+        return _mm_sub_epi16(_mm_add_epi16(s, d), multiply_255_epi16(s, d));
+    }
+
+    static forcedinline __m128i overlay_pixel_epi16(__m128i s, __m128i d, __m128i sa, __m128i da, __m128i max)
+    {
+        const __m128i screen = _mm_sub_epi16(multiply_255_epi16(sa, da),
+            _mm_slli_epi16(multiply_255_epi16(_mm_subs_epu16(da, d), _mm_subs_epu16(sa, s)), 1));
+        const __m128i multiply = _mm_slli_epi16(multiply_255_epi16(s, d), 1);
+        const __m128i mask = _mm_cmpgt_epi16(_mm_add_epi16(d, d), da);
+
+        return _mm_add_epi16(_mm_add_epi16(multiply_255_epi16(s, _mm_xor_si128(da, max)),
+            multiply_255_epi16(d, _mm_xor_si128(sa, max))),
+            _mm_or_si128(_mm_and_si128(mask, screen), _mm_andnot_si128(mask, multiply)));
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    // the weights of a colour row for the red, green and blue channels of two
+    // pixels in 16 bit lanes, alpha is weighted zero
+    static forcedinline __m128i color_weights_epi16(int16 red, int16 green, int16 blue)
+    {
+        return _mm_set_epi16(0, blue, green, red, 0, blue, green, red);
+    }
+
+    // the weighted sums of the four pixels of lo and hi, two each in 16 bit
+    // lanes: madd leaves red + green and blue + alpha of a pixel side by side
+    static forcedinline __m128i weight_pixels_epi32(__m128i lo, __m128i hi, __m128i weights)
+    {
+        const __m128 a = _mm_castsi128_ps(_mm_madd_epi16(lo, weights));
+        const __m128 b = _mm_castsi128_ps(_mm_madd_epi16(hi, weights));
+
+        return _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))),
+            _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))));
+    }
+
+    // the channel sums of the two 2x2 blocks of four pixels of two rows
+    static forcedinline __m128i block_sums_epi16(__m128i pixels, __m128i next_pixels)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(pixels, zero), _mm_unpacklo_epi8(next_pixels, zero));
+        const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(pixels, zero), _mm_unpackhi_epi8(next_pixels, zero));
+
+        return _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+    }
+
+    // 4 bytes widened to floats
+    static forcedinline __m128 load_epu8_ps(const uint8* src_buffer)
+    {
+        int32 bytes;
+        std::memcpy(&bytes, src_buffer, sizeof(bytes));
+
+        const __m128i zero = _mm_setzero_si128();
+        return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero));
+    }
+
+    // 16 values in 32 bit lanes packed in bytes, clamped as clamp_channel does
+    static forcedinline __m128i pack_epi32_epi8(const __m128i* values)
+    {
+        return _mm_packus_epi16(_mm_packs_epi32(values[0], values[1]), _mm_packs_epi32(values[2], values[3]));
+    }
+
+    // one channel of 16 pixels from their luma terms and U, V pairs
+    static forcedinline __m128i rgb_channel_epi8(const __m128i* luma, const __m128i* chroma, __m128i weights)
+    {
+        __m128i channel[4];
+        for (uint32 j = 0; j < 4; ++j)
+            channel[j] = _mm_srai_epi32(_mm_add_epi32(luma[j], _mm_madd_epi16(chroma[j], weights)), 13);
+
+        return pack_epi32_epi8(channel);
+    }
+
+    // one channel of 16 RGBA pixels, shifted down by 0, 8, 16 or 24 bits
+    static forcedinline __m128i rgba_channel_epi8(const __m128i* pixels, int shift)
+    {
+        const __m128i mask = _mm_set1_epi32(0xFF);
+        const __m128i count = _mm_cvtsi32_si128(shift);
+
+        __m128i channel[4];
+        for (uint32 j = 0; j < 4; ++j)
+            channel[j] = _mm_and_si128(_mm_srl_epi32(pixels[j], count), mask);
+
+        return pack_epi32_epi8(channel);
+    }
+
+    static forcedinline void store_rgba_epi8(uint8* dst_buffer, __m128i red, __m128i green, __m128i blue, __m128i alpha)
+    {
+        const __m128i rg_lo = _mm_unpacklo_epi8(red, green);
+        const __m128i rg_hi = _mm_unpackhi_epi8(red, green);
+        const __m128i ba_lo = _mm_unpacklo_epi8(blue, alpha);
+        const __m128i ba_hi = _mm_unpackhi_epi8(blue, alpha);
+
+        _mm_storeu_si128((__m128i*)(dst_buffer + 0), _mm_unpacklo_epi16(rg_lo, ba_lo));
+        _mm_storeu_si128((__m128i*)(dst_buffer + 16), _mm_unpackhi_epi16(rg_lo, ba_lo));
+        _mm_storeu_si128((__m128i*)(dst_buffer + 32), _mm_unpacklo_epi16(rg_hi, ba_hi));
+        _mm_storeu_si128((__m128i*)(dst_buffer + 48), _mm_unpackhi_epi16(rg_hi, ba_hi));
+    }
+
 };
 
 
@@ -34,7 +34,7 @@
 //------------------------------------------------------------------------------
 
 /**
- * Specific SSE3 math class
+ * Specific SSE3 math class adding unaligned loads with lddqu
  */
 
 class math_sse3 : public math_sse2
@@ -53,6 +53,88 @@ public:
         //assertfalse; // not implemented !
     }
 
+
+    //--------------------------------------------------------------------------
+
+    enum SSE3MathDefines
+    {
+        SSE3_MIN_SIZE    = 4,
+        SSE3_MIN_SAMPLES = 32,
+        SSE3_ALIGN       = 0x0F
+    };
+
+
+    //==========================================================================
+
+    //--------------------------------------------------------------------------
+
+    // math_sse2 falls back to scalar code when source and destination don't
+    // share the same alignment, here the destination gets aligned and the
+    // source is read with lddqu which is cheap on split cache lines
+
+    #define math_sse3_copy_buffer_impl(datatype) \
+        void copy_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_buffer & SSE3_ALIGN); \
+            \
+            if (size < SSE3_MIN_SAMPLES || \
+                ((ptrdiff_t)src_buffer & SSE3_ALIGN) == align_bytes) \
+            { \
+                math_sse2::copy_buffer_ ##datatype (src_buffer, dst_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= SSE3_MIN_SIZE); \
+                \
+                /* Copy unaligned head */ \
+                simd_loop_head(datatype, SSE3_ALIGN, \
+                    --size; \
+                    *dst_buffer++ = *src_buffer++; \
+                ); \
+                \
+                /* Copy with simd */ \
+                const __m128i* source_vector = (const __m128i*)src_buffer; \
+                __m128i* dest_vector = (__m128i*)dst_buffer; \
+                \
+                uint32 vector_count = size / (16 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    *dest_vector = _mm_lddqu_si128(source_vector); \
+                    \
+                    ++dest_vector; \
+                    ++source_vector; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer = (datatype*)source_vector; \
+                dst_buffer = (datatype*)dest_vector; \
+                \
+                simd_loop_tail(16 / sizeof(datatype), \
+                    *dst_buffer++ = *src_buffer++; \
+                ); \
+            } \
+        }
+
+
+    //==========================================================================
+
+    //--------------------------------------------------------------------------
+
+    math_sse3_copy_buffer_impl(int8)
+    math_sse3_copy_buffer_impl(uint8)
+    math_sse3_copy_buffer_impl(int16)
+    math_sse3_copy_buffer_impl(uint16)
+    math_sse3_copy_buffer_impl(int32)
+    math_sse3_copy_buffer_impl(uint32)
+    math_sse3_copy_buffer_impl(int64)
+    math_sse3_copy_buffer_impl(uint64)
+    math_sse3_copy_buffer_impl(float)
+    math_sse3_copy_buffer_impl(double)
+
 };
 
 
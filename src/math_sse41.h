@@ -34,7 +34,8 @@
 //------------------------------------------------------------------------------
 
 /**
- * Specific SSE2 math class elaborating on __m128d buffers
+ * Specific SSE41 math class adding packed 32 bit multiply, sign/zero
+ * extension and blending
  */
 
 class math_sse41 : public math_ssse3
@@ -53,6 +54,231 @@ public:
         //assertfalse; // not implemented !
     }
 
+
+    //--------------------------------------------------------------------------
+
+    enum SSE41MathDefines
+    {
+        SSE41_MIN_SIZE    = 4,
+        SSE41_MIN_SAMPLES = 32,
+        SSE41_ALIGN       = 0x0F
+    };
+
+
+    //==========================================================================
+
+    //--------------------------------------------------------------------------
+
+    #define math_sse41_scale_buffer_impl(datatype, gaintype, vector_scale_type, vector_scale_set, round_function) \
+        void scale_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size, \
+            gaintype gain) const \
+        { \
+            if (size < SSE41_MIN_SAMPLES) \
+            { \
+                math_ssse3::scale_buffer_ ##datatype (src_buffer, size, gain); \
+            } \
+            else \
+            { \
+                assert(size >= SSE41_MIN_SIZE); \
+                \
+                const disable_sse_denormals disable_denormals; \
+                \
+                const ptrdiff_t align_bytes = \
+                    ((ptrdiff_t)src_buffer & SSE41_ALIGN); \
+                \
+                /* Scale unaligned head */ \
+                simd_loop_head(datatype, SSE41_ALIGN, \
+                    --size; \
+                    *src_buffer = static_cast<datatype>( \
+                        round::round_function((gaintype)(*src_buffer) * gain)); \
+                    ++src_buffer; \
+                ); \
+                \
+                /* Scale with simd */ \
+                const vector_scale_type vscale = vector_scale_set; \
+                __m128i* vector_buffer = (__m128i*)src_buffer; \
+                \
+                uint32 vector_count = size / (16 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    *vector_buffer = scale_vector_ ##datatype (*vector_buffer, vscale); \
+                    \
+                    ++vector_buffer; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer = (datatype*)vector_buffer; \
+                \
+                simd_loop_tail(16 / sizeof(datatype), \
+                    *src_buffer = static_cast<datatype>( \
+                        round::round_function((gaintype)(*src_buffer) * gain)); \
+                    ++src_buffer; \
+                ); \
+            } \
+        }
+
+    #define math_sse41_binary_buffers_impl(function, datatype, op, vector_op) \
+        void function ##_ ##datatype ( \
+            datatype* src_buffer_a, \
+            datatype* src_buffer_b, \
+            datatype* dst_buffer, \
+            uint32 size) const \
+        { \
+            const ptrdiff_t align_bytes = \
+                ((ptrdiff_t)dst_buffer & SSE41_ALIGN); \
+            \
+            if (size < SSE41_MIN_SAMPLES || \
+                (align_bytes != ((ptrdiff_t)src_buffer_a & SSE41_ALIGN) || \
+                 align_bytes != ((ptrdiff_t)src_buffer_b & SSE41_ALIGN))) \
+            { \
+                math_ssse3::function ##_ ##datatype ( \
+                    src_buffer_a, src_buffer_b, dst_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= SSE41_MIN_SIZE); \
+                \
+                /* Copy unaligned head */ \
+                simd_loop_head(datatype, SSE41_ALIGN, \
+                    --size; \
+                    *dst_buffer++ = *src_buffer_a++ op *src_buffer_b++; \
+                ); \
+                \
+                /* Operate with simd */ \
+                __m128i* vector_buffer_a = (__m128i*)src_buffer_a; \
+                __m128i* vector_buffer_b = (__m128i*)src_buffer_b; \
+                __m128i* vector_dst_buffer = (__m128i*)dst_buffer; \
+                \
+                uint32 vector_count = size / (16 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    *vector_dst_buffer = \
+                      vector_op(*vector_buffer_a, *vector_buffer_b); \
+                    \
+                    ++vector_buffer_a; \
+                    ++vector_buffer_b; \
+                    ++vector_dst_buffer; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer_a = (datatype*)vector_buffer_a; \
+                src_buffer_b = (datatype*)vector_buffer_b; \
+                dst_buffer = (datatype*)vector_dst_buffer; \
+                \
+                simd_loop_tail(16 / sizeof(datatype), \
+                    *dst_buffer++ = *src_buffer_a++ op *src_buffer_b++; \
+                ); \
+            } \
+        }
+
+
+    //--------------------------------------------------------------------------
+
+    #define math_sse41_scale_functions_impl(datatype) \
+        math_sse41_scale_buffer_impl(datatype, float, __m128, _mm_set1_ps(gain), f2i) \
+        math_sse41_scale_buffer_impl(datatype, double, __m128d, _mm_set1_pd(gain), d2i)
+
+
+    //==========================================================================
+
+    //--------------------------------------------------------------------------
+
+    math_sse41_binary_buffers_impl(multiply_buffers, int32, *, _mm_mullo_epi32)
+    math_sse41_binary_buffers_impl(multiply_buffers, uint32, *, _mm_mullo_epi32)
+
+    math_sse41_binary_buffers_impl(divide_buffers, uint32, /, div_epu32)
+
+    math_sse41_scale_functions_impl(int8)
+    math_sse41_scale_functions_impl(uint8)
+    math_sse41_scale_functions_impl(int16)
+    math_sse41_scale_functions_impl(uint16)
+
+
+private:
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline __m128i narrow_epi32_epi16(__m128i lo, __m128i hi)
+    {
+        // truncate like a static_cast
+        const __m128i mask = _mm_set1_epi32(0xFFFF);
+        return _mm_packus_epi32(
+            _mm_and_si128(lo, mask), _mm_and_si128(hi, mask));
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    template<typename vector_type>
+    static forcedinline __m128i scale_vector_int8(__m128i value, vector_type vscale)
+    {
+        return narrow_epi16_epi8(
+            narrow_epi32_epi16(
+                scale_epi32(_mm_cvtepi8_epi32(value), vscale),
+                scale_epi32(_mm_cvtepi8_epi32(_mm_srli_si128(value, 4)), vscale)),
+            narrow_epi32_epi16(
+                scale_epi32(_mm_cvtepi8_epi32(_mm_srli_si128(value, 8)), vscale),
+                scale_epi32(_mm_cvtepi8_epi32(_mm_srli_si128(value, 12)), vscale)));
+    }
+
+    template<typename vector_type>
+    static forcedinline __m128i scale_vector_uint8(__m128i value, vector_type vscale)
+    {
+        return narrow_epi16_epi8(
+            narrow_epi32_epi16(
+                scale_epi32(_mm_cvtepu8_epi32(value), vscale),
+                scale_epi32(_mm_cvtepu8_epi32(_mm_srli_si128(value, 4)), vscale)),
+            narrow_epi32_epi16(
+                scale_epi32(_mm_cvtepu8_epi32(_mm_srli_si128(value, 8)), vscale),
+                scale_epi32(_mm_cvtepu8_epi32(_mm_srli_si128(value, 12)), vscale)));
+    }
+
+    template<typename vector_type>
+    static forcedinline __m128i scale_vector_int16(__m128i value, vector_type vscale)
+    {
+        return narrow_epi32_epi16(
+            scale_epi32(_mm_cvtepi16_epi32(value), vscale),
+            scale_epi32(_mm_cvtepi16_epi32(_mm_srli_si128(value, 8)), vscale));
+    }
+
+    template<typename vector_type>
+    static forcedinline __m128i scale_vector_uint16(__m128i value, vector_type vscale)
+    {
+        return narrow_epi32_epi16(
+            scale_epi32(_mm_cvtepu16_epi32(value), vscale),
+            scale_epi32(_mm_cvtepu16_epi32(_mm_srli_si128(value, 8)), vscale));
+    }
+
+
+    //--------------------------------------------------------------------------
+
+    static forcedinline __m128i cvttpd_epu32(__m128d value)
+    {
+        // blend in the unbiased quotients above the signed range, then put
+        // the top bit back once truncated
+        const __m128d bias = _mm_set1_pd(2147483648.0);
+        const __m128d large = _mm_cmpge_pd(value, bias);
+        const __m128i top_bit = _mm_and_si128(
+            _mm_shuffle_epi32(_mm_castpd_si128(large), _MM_SHUFFLE(3, 3, 2, 0)),
+            _mm_set1_epi32((int)0x80000000));
+
+        return _mm_xor_si128(top_bit, _mm_cvttpd_epi32(
+            _mm_blendv_pd(value, _mm_sub_pd(value, bias), large)));
+    }
+
+    static forcedinline __m128i div_epu32(__m128i a, __m128i b)
+    {
+        const __m128i lo = cvttpd_epu32(_mm_div_pd(
+            cvtepu32_pd(a), cvtepu32_pd(b)));
+        const __m128i hi = cvttpd_epu32(_mm_div_pd(
+            cvtepu32_pd(_mm_srli_si128(a, 8)),
+            cvtepu32_pd(_mm_srli_si128(b, 8))));
+
+        return _mm_unpacklo_epi64(lo, hi);
+    }
+
 };
 
 
@@ -34,7 +34,7 @@
 //------------------------------------------------------------------------------
 
 /**
- * Specific SSE42 math class
+ * Specific SSE42 math class adding 64 bit packed compares
  */
 
 class math_sse42 : public math_sse41
@@ -53,6 +53,65 @@ public:
         //assertfalse; // not implemented !
     }
 
+
+    //--------------------------------------------------------------------------
+
+    enum SSE42MathDefines
+    {
+        SSE42_MIN_SIZE    = 4,
+        SSE42_MIN_SAMPLES = 32,
+        SSE42_ALIGN       = 0x0F
+    };
+
+
+    //--------------------------------------------------------------------------
+
+    void abs_buffer_int64(
+        int64* src_buffer,
+        uint32 size) const
+    {
+        if (size < SSE42_MIN_SAMPLES)
+        {
+            math_sse41::abs_buffer_int64(src_buffer, size);
+        }
+        else
+        {
+            assert(size >= SSE42_MIN_SIZE);
+
+            const ptrdiff_t align_bytes =
+                ((ptrdiff_t)src_buffer & SSE42_ALIGN);
+
+            // Operate on unaligned head
+            simd_loop_head(int64, SSE42_ALIGN,
+                --size;
+                *src_buffer = abs_scalar(*src_buffer);
+                ++src_buffer;
+            );
+
+            // Operate with simd
+            const __m128i zero = _mm_setzero_si128();
+            __m128i* vector_buffer = (__m128i*)src_buffer;
+
+            uint32 vector_count = size >> 1;
+            while (vector_count--)
+            {
+                const __m128i sign = _mm_cmpgt_epi64(zero, *vector_buffer);
+                *vector_buffer = _mm_sub_epi64(
+                    _mm_xor_si128(*vector_buffer, sign), sign);
+
+                ++vector_buffer;
+            }
+
+            // Handle any unaligned leftovers
+            src_buffer = (int64*)vector_buffer;
+
+            simd_loop_tail(2,
+                *src_buffer = abs_scalar(*src_buffer);
+                ++src_buffer;
+            );
+        }
+    }
+
 };
 
 
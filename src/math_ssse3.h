@@ -34,7 +34,7 @@
 //------------------------------------------------------------------------------
 
 /**
- * Specific SSSE3 math class
+ * Specific SSSE3 math class adding packed absolute values and byte shuffles
  */
 
 class math_ssse3 : public math_sse3
@@ -53,6 +53,91 @@ public:
         //assertfalse; // not implemented !
     }
 
+
+    //--------------------------------------------------------------------------
+
+    enum SSSE3MathDefines
+    {
+        SSSE3_MIN_SIZE    = 4,
+        SSSE3_MIN_SAMPLES = 32,
+        SSSE3_ALIGN       = 0x0F
+    };
+
+
+    //==========================================================================
+
+    //--------------------------------------------------------------------------
+
+    #define math_ssse3_abs_buffer_impl(datatype, vector_abs) \
+        void abs_buffer_ ##datatype ( \
+            datatype* src_buffer, \
+            uint32 size) const \
+        { \
+            if (size < SSSE3_MIN_SAMPLES) \
+            { \
+                math_sse3::abs_buffer_ ##datatype (src_buffer, size); \
+            } \
+            else \
+            { \
+                assert(size >= SSSE3_MIN_SIZE); \
+                \
+                const ptrdiff_t align_bytes = \
+                    ((ptrdiff_t)src_buffer & SSSE3_ALIGN); \
+                \
+                /* Operate on unaligned head */ \
+                simd_loop_head(datatype, SSSE3_ALIGN, \
+                    --size; \
+                    *src_buffer = abs_scalar(*src_buffer); \
+                    ++src_buffer; \
+                ); \
+                \
+                /* Operate with simd */ \
+                __m128i* vector_buffer = (__m128i*)src_buffer; \
+                \
+                uint32 vector_count = size / (16 / sizeof(datatype)); \
+                while (vector_count--) \
+                { \
+                    *vector_buffer = vector_abs(*vector_buffer); \
+                    \
+                    ++vector_buffer; \
+                } \
+                \
+                /* Handle any unaligned leftovers */ \
+                src_buffer = (datatype*)vector_buffer; \
+                \
+                simd_loop_tail(16 / sizeof(datatype), \
+                    *src_buffer = abs_scalar(*src_buffer); \
+                    ++src_buffer; \
+                ); \
+            } \
+        }
+
+
+    //==========================================================================
+
+    //--------------------------------------------------------------------------
+
+    math_ssse3_abs_buffer_impl(int8, _mm_abs_epi8)
+    math_ssse3_abs_buffer_impl(int16, _mm_abs_epi16)
+    math_ssse3_abs_buffer_impl(int32, _mm_abs_epi32)
+
+
+    //--------------------------------------------------------------------------
+
+    math_sse2_pixel_functions_impl(alpha_shuffle_epi16)
+
+
+protected:
+
+    //--------------------------------------------------------------------------
+
+    // the alpha of the two pixels in 16 bit lanes broadcast by a single byte
+    // shuffle
+    static forcedinline __m128i alpha_shuffle_epi16(__m128i pixels)
+    {
+        return _mm_shuffle_epi8(pixels, _mm_setr_epi8(6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15));
+    }
+
 };
 
 
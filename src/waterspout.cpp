@@ -26,10 +26,8 @@
  * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
-#include <waterspout.h>
+#include "waterspout_internal.h"
 
-#include <cstdlib>
-#include <cstring>
 #include <ctime>
 #include <chrono>
 #include <stdexcept>
@@ -43,104 +41,24 @@
 #include <fstream>
 #include <string>
 #include <map>
+#include <algorithm>
 
 
-#if defined(WATERSPOUT_COMPILER_GCC) || defined(WATERSPOUT_COMPILER_MINGW) || defined(WATERSPOUT_COMPILER_CLANG)
+#if defined(WATERSPOUT_ARCH_X86)
+  #if defined(WATERSPOUT_COMPILER_GCC) || defined(WATERSPOUT_COMPILER_MINGW) || defined(WATERSPOUT_COMPILER_CLANG)
     #include <cpuid.h>
+  #endif
 #endif
 
-
-#if defined(WATERSPOUT_SIMD_MMX)
-    #include <mmintrin.h>  // MMX
-#endif
-
-#if defined(WATERSPOUT_SIMD_SSE)
-    #include <xmmintrin.h> // SSE
-#endif
-
-#if defined(WATERSPOUT_SIMD_SSE2)
-    #include <emmintrin.h> // SSE2
-#endif
-
-#if defined(WATERSPOUT_SIMD_SSE3)
-    #include <pmmintrin.h> // SSE3
-#endif
-
-#if defined(WATERSPOUT_SIMD_SSSE3)
-    #include <tmmintrin.h> // SSSE3
-#endif
-
-#if defined(WATERSPOUT_SIMD_SSE41)
-    #include <smmintrin.h> // SSE4.1
-#endif
-
-#if defined(WATERSPOUT_SIMD_SSE42)
-    #include <nmmintrin.h> // SSE4.2
-#endif
-
-#if defined(WATERSPOUT_SIMD_AVX) || defined(WATERSPOUT_SIMD_AVX2)
-    #include <immintrin.h> // AVX and AVX2
-#endif
-
-#if defined(WATERSPOUT_SIMD_NEON)
-    // which include ?
+#if defined(WATERSPOUT_ARCH_ARM) && defined(WATERSPOUT_SYSTEM_LINUX) && ! defined(WATERSPOUT_ARCH_ARM64)
+    #include <sys/auxv.h>  // getauxval
+    #include <asm/hwcap.h> // HWCAP_NEON
 #endif
 
 
 namespace waterspout {
 
 
-//==============================================================================
-
-//------------------------------------------------------------------------------
-
-/**
- * These macros are ripped from Intel Architecture Code Analyzer (IACA) and
- * serves the purpose to check for performance bottleneck in SIMD instructions
- *
- * http://software.intel.com/en-us/articles/intel-architecture-code-analyzer
- */
-
-#ifdef IACA_MARKS_OFF
-    #define IACA_START
-    #define IACA_END
-    #define IACA_MSC64_START
-    #define IACA_MSC64_END
-
-#else
-    #if defined(WATERSPOUT_COMPILER_GCC) || defined(WATERSPOUT_COMPILER_MINGW) || defined(WATERSPOUT_COMPILER_CLANG)
-        #define IACA_SSC_MARK(MARK_ID) \
-            __asm__ __volatile__( \
-                "\n\t  movl $"#MARK_ID", %%ebx"	\
-                "\n\t  .byte 0x64, 0x67, 0x90" \
-                : : : "memory" );
-
-        #define IACA_UD_BYTES \
-            __asm__ __volatile__( \
-                "\n\t .byte 0x0F, 0x0B");
-
-    #else
-        #define IACA_UD_BYTES \
-            { __asm _emit 0x0F \
-              __asm _emit 0x0B }
-
-        #define IACA_SSC_MARK(x) \
-            { __asm  mov ebx, x \
-              __asm  _emit 0x64 \
-              __asm  _emit 0x67 \
-              __asm  _emit 0x90 }
-
-        #define IACA_VC64_START __writegsbyte(111, 111);
-        #define IACA_VC64_END   __writegsbyte(222, 222);
-
-    #endif
-
-    #define IACA_START { IACA_UD_BYTES      IACA_SSC_MARK(111) }
-    #define IACA_END   { IACA_SSC_MARK(222) IACA_UD_BYTES }
-
-#endif
-
-
 //==============================================================================
 
 //------------------------------------------------------------------------------
@@ -620,56 +538,6 @@ typedef logger_detail_::info logger_info;
 #define WATERSPOUT_LOG_INFO(s) waterspout::logger_info(#s)
 
 
-//==============================================================================
-
-//------------------------------------------------------------------------------
-
-/**
- * @brief The CpuFeatures enum
- *
- * Reference:
- * http://datasheets.chipdb.org/Intel/x86/CPUID/24161821.pdf
- * http://www.flounder.com/cpuid_explorer2.htm
- */
-enum CpuFeatures
-{
-    FPU   = 1 <<  0, // Floating-Point Unit on-chip
-    MMX   = 1 << 23, // MultiMedia eXtension
-    SSE   = 1 << 25, // Streaming SIMD Extension 1
-    SSE2  = 1 << 26  // Streaming SIMD Extension 2
-};
-
-/**
- * @brief The CpuExtendedFeatures enum
- *
- * Reference:
- * http://datasheets.chipdb.org/Intel/x86/CPUID/24161821.pdf
- * http://www.flounder.com/cpuid_explorer2.htm
- */
-enum CpuExtendedFeatures
-{
-    SSE3  = 1 <<  0, // Streaming SIMD Extension 3
-    SSE4A = 1 <<  6, // SSE4A (only for AMD)
-    SSSE3 = 1 <<  9, // SSSE3
-    SSE41 = 1 << 19, // SSE41
-    SSE42 = 1 << 20, // SSE42
-    AVX   = 1 << 28, // AVX
-    AVX2  = 1 <<  5  // AVX2
-};
-
-/**
- * @brief The CpuEndianess enum
- */
-enum CpuEndianess
-{
-    ENDIAN_UNKNOWN     = 0,
-    ENDIAN_BIG         = 1,
-    ENDIAN_LITTLE      = 2,
-    ENDIAN_BIG_WORD    = 3, // Middle-endian, Honeywell 316 style
-    ENDIAN_LITTLE_WORD = 4  // Middle-endian, PDP-11 style
-};
-
-
 //------------------------------------------------------------------------------
 
 /**
@@ -683,14 +551,23 @@ enum CpuEndianess
 
 void cpuid(uint32 op, uint32& eax, uint32& ebx, uint32& ecx, uint32& edx)
 {
-#if defined(WATERSPOUT_COMPILER_GCC) || defined(WATERSPOUT_COMPILER_MINGW) || defined(WATERSPOUT_COMPILER_CLANG)
-    // GCC/MINGW/CLANG provides a __get_cpuid function
-    __get_cpuid(op, &eax, &ebx, &ecx, &edx);
+#if ! defined(WATERSPOUT_ARCH_X86)
+    // there is no cpuid outside x86, report no features at all
+    unused(op);
+    eax = ebx = ecx = edx = 0;
+
+#elif defined(WATERSPOUT_COMPILER_GCC) || defined(WATERSPOUT_COMPILER_MINGW) || defined(WATERSPOUT_COMPILER_CLANG)
+    // GCC/MINGW/CLANG provides a __cpuid_count macro, subleaf is always 0
+    eax = ebx = ecx = edx = 0;
+    if (__get_cpuid_max(op & 0x80000000, nullptr) >= op)
+    {
+        __cpuid_count(op, 0, eax, ebx, ecx, edx);
+    }
 
 #elif defined(WATERSPOUT_COMPILER_MSVC)
-    // MSVC provides a __cpuid function
+    // MSVC provides a __cpuidex function, subleaf is always 0
     int regs[4];
-    __cpuid(regs, op);
+    __cpuidex(regs, op, 0);
     eax = (uint32)regs[0];
     ebx = (uint32)regs[1];
     ecx = (uint32)regs[2];
@@ -730,6 +607,87 @@ uint32 cpu_extended_features()
 }
 
 
+//------------------------------------------------------------------------------
+
+/**
+ * This will retrieve the structured extended CPU features available
+ * \return The content of the ebx register containing structured extended features
+ */
+
+uint32 cpu_structured_extended_features()
+{
+    uint32 eax, ebx, ecx, edx;
+    cpuid(7, eax, ebx, ecx, edx);
+    return ebx;
+}
+
+
+//------------------------------------------------------------------------------
+
+/**
+ * This will retrieve the processor state components enabled by the OS
+ * \return The content of the XCR0 register, or 0 if XGETBV is not enabled
+ */
+
+uint32 cpu_os_state_features()
+{
+    if ((cpu_extended_features() & OSXSAVE) == 0)
+    {
+        return 0;
+    }
+
+#if ! defined(WATERSPOUT_ARCH_X86)
+    return 0;
+
+#elif defined(WATERSPOUT_COMPILER_GCC) || defined(WATERSPOUT_COMPILER_MINGW) || defined(WATERSPOUT_COMPILER_CLANG)
+    uint32 eax, edx;
+    __asm__ __volatile__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+    return eax;
+
+#elif defined(WATERSPOUT_COMPILER_MSVC)
+    return (uint32)_xgetbv(0);
+
+#else
+    return 0;
+
+#endif
+}
+
+
+//------------------------------------------------------------------------------
+
+/**
+ * This will check if the ARM processor supports NEON (Advanced SIMD)
+ * \return True if NEON instructions can be executed on this processor
+ */
+
+bool cpu_has_neon()
+{
+#if ! defined(WATERSPOUT_ARCH_ARM)
+    return false;
+
+#elif defined(WATERSPOUT_SYSTEM_ANDROID)
+    // Android provides the cpufeatures library, arm64 always has NEON
+    return (android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM64) ||
+        (android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM &&
+         (android_getCpuFeatures() & ANDROID_CPU_ARM_FEATURE_NEON) != 0);
+
+#elif defined(WATERSPOUT_ARCH_ARM64)
+    // Advanced SIMD is mandatory on every ARMv8-A application processor
+    return true;
+
+#elif defined(WATERSPOUT_SYSTEM_LINUX)
+    // On ARMv7 the kernel reports NEON in the auxiliary vector
+    return (getauxval(AT_HWCAP) & HWCAP_NEON) != 0;
+
+#else
+    // Compiled with NEON enabled, so we assume it is there
+    return true;
+
+#endif
+}
+
+
 //------------------------------------------------------------------------------
 
 /**
@@ -815,212 +773,150 @@ void memory::aligned_free(void* ptr)
 
 //------------------------------------------------------------------------------
 
-#define simd_unroll_head_16(s) \
-    switch (align_bytes >> 4) \
-    { \
-    case 1:  s; \
-    case 2:  s; \
-    case 3:  s; \
-    case 4:  s; \
-    case 5:  s; \
-    case 6:  s; \
-    case 7:  s; \
-    case 8:  s; \
-    case 9:  s; \
-    case 10: s; \
-    case 11: s; \
-    case 12: s; \
-    case 13: s; \
-    case 14: s; \
-    case 15: s; \
-    }
-
-#define simd_unroll_tail_16(s) \
-    switch (size & 15) \
-    { \
-    case 15: s; \
-    case 14: s; \
-    case 13: s; \
-    case 12: s; \
-    case 11: s; \
-    case 10: s; \
-    case 9:  s; \
-    case 8:  s; \
-    case 7:  s; \
-    case 6:  s; \
-    case 5:  s; \
-    case 4:  s; \
-    case 3:  s; \
-    case 2:  s; \
-    case 1:  s; \
-    }
-
-
-//------------------------------------------------------------------------------
-
-#define simd_unroll_head_8(s) \
-    switch (align_bytes >> 3) \
-    { \
-    case 1: s; \
-    case 2: s; \
-    case 3: s; \
-    case 4: s; \
-    case 5: s; \
-    case 6: s; \
-    case 7: s; \
-    }
-
-#define simd_unroll_tail_8(s) \
-    switch (size & 7) \
-    { \
-    case 7: s; \
-    case 6: s; \
-    case 5: s; \
-    case 4: s; \
-    case 3: s; \
-    case 2: s; \
-    case 1: s; \
-    }
-
-
-//------------------------------------------------------------------------------
-
-#define simd_unroll_head_4(s) \
-    switch (align_bytes >> 2) \
-    { \
-    case 1: s; \
-    case 2: s; \
-    case 3: s; \
-    }
-
-#define simd_unroll_tail_4(s) \
-    switch (size & 3) \
-    { \
-    case 3: s; \
-    case 2: s; \
-    case 1: s; \
-    }
-
+bool math::is_supported(int flags)
+{
+#if defined(WATERSPOUT_ARCH_ARM)
+    static bool has_neon = cpu_has_neon();
+    unused(has_neon);
 
-//------------------------------------------------------------------------------
+    switch (flags)
+    {
+    case AUTODETECT:
+    case FORCE_FPU:
+        return true;
 
-#define simd_unroll_head_2(s) \
-    switch (align_bytes >> 1) \
-    { \
-    case 1: s; \
-    }
+    #if defined(WATERSPOUT_SIMD_NEON)
+    case FORCE_NEON:
+        return has_neon;
+    #endif
 
-#define simd_unroll_tail_2(s) \
-    switch (size & 1) \
-    { \
-    case 1: s; \
+    default:
+        return false;
     }
 
+#else
+    static uint32 features = cpu_features();
+    static uint32 features_ext = cpu_extended_features();
+    static uint32 features_struct = cpu_structured_extended_features();
+    static uint32 features_os = cpu_os_state_features();
+
+    // keep quiet when building for the baseline instruction set only
+    unused(features);
+    unused(features_ext);
+    unused(features_struct);
+    unused(features_os);
+
+    switch (flags)
+    {
+    case AUTODETECT:
+    case FORCE_FPU:
+        return true;
 
-//------------------------------------------------------------------------------
+    #if defined(WATERSPOUT_SIMD_MMX)
+    case FORCE_MMX:
+        return (features & MMX) != 0;
+    #endif
 
-#include "math_fpu.h"
+    #if defined(WATERSPOUT_SIMD_SSE)
+    case FORCE_SSE:
+        return (features & SSE) != 0;
+    #endif
 
-#if defined(WATERSPOUT_SIMD_MMX)
-    #include "math_mmx.h"
-#endif
+    #if defined(WATERSPOUT_SIMD_SSE2)
+    case FORCE_SSE2:
+        return (features & SSE2) != 0;
+    #endif
 
-#if defined(WATERSPOUT_SIMD_SSE)
-    #include "math_sse.h"
-#endif
+    #if defined(WATERSPOUT_SIMD_SSE3)
+    case FORCE_SSE3:
+        return (features_ext & SSE3) != 0;
+    #endif
 
-#if defined(WATERSPOUT_SIMD_SSE2)
-    #include "math_sse2.h"
-#endif
+    #if defined(WATERSPOUT_SIMD_SSSE3)
+    case FORCE_SSSE3:
+        return (features_ext & SSSE3) != 0;
+    #endif
 
-#if defined(WATERSPOUT_SIMD_SSE3)
-    #include "math_sse3.h"
-#endif
+    #if defined(WATERSPOUT_SIMD_SSE41)
+    case FORCE_SSE41:
+        return (features_ext & SSE41) != 0;
+    #endif
 
-#if defined(WATERSPOUT_SIMD_SSSE3)
-    #include "math_ssse3.h"
-#endif
+    #if defined(WATERSPOUT_SIMD_SSE42)
+    case FORCE_SSE42:
+        return (features_ext & SSE42) != 0;
+    #endif
 
-#if defined(WATERSPOUT_SIMD_SSE41)
-    #include "math_sse41.h"
-#endif
+    #if defined(WATERSPOUT_SIMD_AVX)
+    case FORCE_AVX:
+        return (features_ext & AVX)
+            && (features_os & OS_AVX) == OS_AVX;
+    #endif
 
-#if defined(WATERSPOUT_SIMD_SSE42)
-    #include "math_sse42.h"
-#endif
+    #if defined(WATERSPOUT_SIMD_AVX2)
+    case FORCE_AVX2:
+        return (features_struct & AVX2)
+            && (features_ext & FMA)
+            && (features_os & OS_AVX) == OS_AVX;
+    #endif
 
-#if defined(WATERSPOUT_SIMD_AVX)
-    #include "math_avx.h"
-#endif
+    #if defined(WATERSPOUT_SIMD_AVX512)
+    case FORCE_AVX512:
+        return (features_struct & (AVX512F | AVX512DQ | AVX512BW)) == (AVX512F | AVX512DQ | AVX512BW)
+            && (features_ext & FMA)
+            && (features_os & OS_AVX512) == OS_AVX512;
+    #endif
 
-#if defined(WATERSPOUT_SIMD_AVX2)
-    #include "math_avx2.h"
-#endif
+    default:
+        return false;
+    }
 
-#if defined(WATERSPOUT_SIMD_NEON)
-    #include "math_neon.h"
 #endif
+}
 
 
-//==============================================================================
-
 //------------------------------------------------------------------------------
 
 math::math(int flags, bool fallback)
 {
-    if (! fallback)
+    if (! fallback && ! is_supported(flags))
     {
-#if ! defined(WATERSPOUT_SIMD_AVX2)
-        if (flags == FORCE_AVX2)
-            throw std::runtime_error("math_factory: AVX2 not available!");
-#endif
-#if ! defined(WATERSPOUT_SIMD_AVX)
-        if (flags == FORCE_AVX)
-            throw std::runtime_error("math_factory: AVX not available!");
-#endif
-#if ! defined(WATERSPOUT_SIMD_SSE42)
-        if (flags == FORCE_SSE42)
-            throw std::runtime_error("math_factory: SSE42 not available!");
-#endif
-#if ! defined(WATERSPOUT_SIMD_SSE41)
-        if (flags == FORCE_SSE41)
-            throw std::runtime_error("math_factory: SSE41 not available!");
-#endif
-#if ! defined(WATERSPOUT_SIMD_SSSE3)
-        if (flags == FORCE_SSSE3)
-            throw std::runtime_error("math_factory: SSSE3 not available!");
-#endif
-#if ! defined(WATERSPOUT_SIMD_SSE3)
-        if (flags == FORCE_SSE3)
-            throw std::runtime_error("math_factory: SSE3 not available!");
-#endif
-#if ! defined(WATERSPOUT_SIMD_SSE2)
-        if (flags == FORCE_SSE2)
-            throw std::runtime_error("math_factory: SSE2 not available!");
-#endif
-#if ! defined(WATERSPOUT_SIMD_SSE)
-        if (flags == FORCE_SSE)
-            throw std::runtime_error("math_factory: SSE not available!");
-#endif
-#if ! defined(WATERSPOUT_SIMD_MMX)
-        if (flags == FORCE_MMX)
-            throw std::runtime_error("math_factory: MMX not available!");
-#endif
+        static const char* names[] =
+        {
+            "AUTODETECT", "FPU", "MMX", "SSE", "SSE2", "SSE3", "SSSE3",
+            "SSE41", "SSE42", "AVX", "AVX2", "NEON", "AVX512"
+        };
+
+        const bool known = flags >= AUTODETECT && flags <= FORCE_AVX512;
+        throw std::runtime_error(std::string("math_factory: ")
+            + (known ? names[flags] : "unknown instruction set") + " not available!");
     }
 
-#if defined(WATERSPOUT_SYSTEM_ANDROID)
-    if ((android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM &&
-         (android_getCpuFeatures() & ANDROID_CPU_ARM_FEATURE_NEON) != 0) ||
-         (flags == FORCE_NEON))
+#if defined(WATERSPOUT_ARCH_ARM)
     {
-        math_implementation_ = std::unique_ptr<math_interface_>(new math_neon);
+        bool placeholder = false;
+        if (placeholder)
+        {
+        	// this must be here for VS to not complain !
+        	placeholder = false;
+        }
+
+    #if defined(WATERSPOUT_SIMD_NEON)
+        else if (is_supported(FORCE_NEON)
+            && flags != FORCE_FPU)
+        {
+            math_implementation_ = std::unique_ptr<math_interface_>(create_math_neon(dispatch_table_));
+        }
+    #endif
+
+        else // if (flags == FORCE_FPU)
+        {
+            math_implementation_ = std::unique_ptr<math_interface_>(create_math_fpu(dispatch_table_));
+        }
     }
 
 #else
     {
-        static uint32 features = cpu_features();
-        static uint32 features_ext = cpu_extended_features();
-
         bool placeholder = false;
         if (placeholder)
         {
@@ -1028,8 +924,25 @@ math::math(int flags, bool fallback)
         	placeholder = false;
         }
 
+    #if defined(WATERSPOUT_SIMD_AVX512)
+        else if (is_supported(FORCE_AVX512)
+            && flags != FORCE_AVX2
+            && flags != FORCE_AVX
+            && flags != FORCE_SSE42
+            && flags != FORCE_SSE41
+            && flags != FORCE_SSSE3
+            && flags != FORCE_SSE3
+            && flags != FORCE_SSE2
+            && flags != FORCE_SSE
+            && flags != FORCE_MMX
+            && flags != FORCE_FPU)
+        {
+            math_implementation_ = std::unique_ptr<math_interface_>(create_math_avx512(dispatch_table_));
+        }
+    #endif
+
     #if defined(WATERSPOUT_SIMD_AVX2)
-        else if ((features_ext & AVX2)
+        else if (is_supported(FORCE_AVX2)
             && flags != FORCE_AVX
             && flags != FORCE_SSE42
             && flags != FORCE_SSE41
@@ -1040,12 +953,12 @@ math::math(int flags, bool fallback)
             && flags != FORCE_MMX
             && flags != FORCE_FPU)
         {
-            math_implementation_ = std::unique_ptr<math_interface_>(new math_avx2);
+            math_implementation_ = std::unique_ptr<math_interface_>(create_math_avx2(dispatch_table_));
         }
     #endif
 
     #if defined(WATERSPOUT_SIMD_AVX)
-        else if ((features_ext & AVX)
+        else if (is_supported(FORCE_AVX)
             && flags != FORCE_SSE42
             && flags != FORCE_SSE41
             && flags != FORCE_SSSE3
@@ -1055,12 +968,12 @@ math::math(int flags, bool fallback)
             && flags != FORCE_MMX
             && flags != FORCE_FPU)
         {
-            math_implementation_ = std::unique_ptr<math_interface_>(new math_avx);
+            math_implementation_ = std::unique_ptr<math_interface_>(create_math_avx(dispatch_table_));
         }
     #endif
 
     #if defined(WATERSPOUT_SIMD_SSE42)
-        else if ((features_ext & SSE42)
+        else if (is_supported(FORCE_SSE42)
             && flags != FORCE_SSE41
             && flags != FORCE_SSSE3
             && flags != FORCE_SSE3
@@ -1069,12 +982,12 @@ math::math(int flags, bool fallback)
             && flags != FORCE_MMX
             && flags != FORCE_FPU)
         {
-            math_implementation_ = std::unique_ptr<math_interface_>(new math_sse42);
+            math_implementation_ = std::unique_ptr<math_interface_>(create_math_sse42(dispatch_table_));
         }
     #endif
 
     #if defined(WATERSPOUT_SIMD_SSE41)
-        else if ((features_ext & SSE41)
+        else if (is_supported(FORCE_SSE41)
             && flags != FORCE_SSSE3
             && flags != FORCE_SSE3
             && flags != FORCE_SSE2
@@ -1082,63 +995,63 @@ math::math(int flags, bool fallback)
             && flags != FORCE_MMX
             && flags != FORCE_FPU)
         {
-            math_implementation_ = std::unique_ptr<math_interface_>(new math_sse41);
+            math_implementation_ = std::unique_ptr<math_interface_>(create_math_sse41(dispatch_table_));
         }
     #endif
 
     #if defined(WATERSPOUT_SIMD_SSSE3)
-        else if ((features_ext & SSSE3)
+        else if (is_supported(FORCE_SSSE3)
             && flags != FORCE_SSE3
             && flags != FORCE_SSE2
             && flags != FORCE_SSE
             && flags != FORCE_MMX
             && flags != FORCE_FPU)
         {
-            math_implementation_ = std::unique_ptr<math_interface_>(new math_ssse3);
+            math_implementation_ = std::unique_ptr<math_interface_>(create_math_ssse3(dispatch_table_));
         }
     #endif
 
     #if defined(WATERSPOUT_SIMD_SSE3)
-        else if ((features_ext & SSE3)
+        else if (is_supported(FORCE_SSE3)
             && flags != FORCE_SSE2
             && flags != FORCE_SSE
             && flags != FORCE_MMX
             && flags != FORCE_FPU)
         {
-            math_implementation_ = std::unique_ptr<math_interface_>(new math_sse3);
+            math_implementation_ = std::unique_ptr<math_interface_>(create_math_sse3(dispatch_table_));
         }
     #endif
 
     #if defined(WATERSPOUT_SIMD_SSE2)
-        else if ((features & SSE2)
+        else if (is_supported(FORCE_SSE2)
             && flags != FORCE_SSE
             && flags != FORCE_MMX
             && flags != FORCE_FPU)
         {
-            math_implementation_ = std::unique_ptr<math_interface_>(new math_sse2);
+            math_implementation_ = std::unique_ptr<math_interface_>(create_math_sse2(dispatch_table_));
         }
     #endif
 
     #if defined(WATERSPOUT_SIMD_SSE)
-        else if ((features & SSE)
+        else if (is_supported(FORCE_SSE)
             && flags != FORCE_MMX
             && flags != FORCE_FPU)
         {
-            math_implementation_ = std::unique_ptr<math_interface_>(new math_sse);
+            math_implementation_ = std::unique_ptr<math_interface_>(create_math_sse(dispatch_table_));
         }
     #endif
 
     #if defined(WATERSPOUT_SIMD_MMX)
-        else if ((features & MMX)
+        else if (is_supported(FORCE_MMX)
             && flags != FORCE_FPU)
         {
-            math_implementation_ = std::unique_ptr<math_interface_>(new math_mmx);
+            math_implementation_ = std::unique_ptr<math_interface_>(create_math_mmx(dispatch_table_));
         }
     #endif
 
         else // if ((features & FPU) || flags == FORCE_FPU)
         {
-            math_implementation_ = std::unique_ptr<math_interface_>(new math_fpu);
+            math_implementation_ = std::unique_ptr<math_interface_>(create_math_fpu(dispatch_table_));
         }
     }
 #endif
@@ -1193,7 +1106,15 @@ math::math(int flags, bool fallback)
     #endif
     #if defined(WATERSPOUT_SIMD_AVX2)
         WATERSPOUT_LOG_DEBUG(math_factory)
-            << "  AVX2  = " << std::boolalpha << (bool)(cpu_extended_features() & AVX2);
+            << "  FMA   = " << std::boolalpha << (bool)(cpu_extended_features() & FMA);
+    #endif
+    #if defined(WATERSPOUT_SIMD_AVX2)
+        WATERSPOUT_LOG_DEBUG(math_factory)
+            << "  AVX2  = " << std::boolalpha << (bool)(cpu_structured_extended_features() & AVX2);
+    #endif
+    #if defined(WATERSPOUT_SIMD_AVX512)
+        WATERSPOUT_LOG_DEBUG(math_factory)
+            << "  AVX512 = " << std::boolalpha << (bool)(cpu_structured_extended_features() & AVX512F);
     #endif
 
     if (math_implementation_ != nullptr)
@@ -1225,4 +1146,1115 @@ const char* math::name() const
 }
 
 
+//==============================================================================
+
+//------------------------------------------------------------------------------
+
+/**
+ * Tables of the complex transforms of one size: the bit reversed order of the
+ * input, the twiddles of the radix 4 passes as the transform functions read
+ * them, and the quarter turn of twiddles splitting the spectrum of a complex
+ * transform in the one of a real transform twice as long.
+ */
+
+template<class T>
+class fft_plan
+{
+public:
+    explicit fft_plan(uint32 size)
+      : bit_reverse_(size),
+        twiddles_(size * 2 + 6),
+        real_twiddles_((size / 2 + 1) * 2),
+        size_(size)
+    {
+        const double pi = 3.14159265358979323846;
+
+        uint32 bits = 0;
+        while ((1u << bits) < size)
+            ++bits;
+
+        for (uint32 i = 0; i < size; ++i)
+        {
+            uint32 reversed = 0;
+            for (uint32 bit = 0; bit < bits; ++bit)
+                reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+
+            bit_reverse_[i] = reversed;
+        }
+
+        T* twiddle = twiddles_.data();
+        for (uint32 span = (bits & 1) ? 2 : 1; span < size; span *= 4)
+        {
+            for (uint32 k = 0; k < span; ++k)
+            {
+                const double angle = -2.0 * pi * k / (4.0 * span);
+
+                twiddle[k] = (T)std::cos(angle);
+                twiddle[span + k] = (T)std::sin(angle);
+                twiddle[2 * span + k] = (T)std::cos(2.0 * angle);
+                twiddle[3 * span + k] = (T)std::sin(2.0 * angle);
+                twiddle[4 * span + k] = (T)std::cos(3.0 * angle);
+                twiddle[5 * span + k] = (T)std::sin(3.0 * angle);
+            }
+
+            twiddle += 6 * span;
+        }
+
+        const uint32 quarter = size / 2 + 1;
+        for (uint32 k = 0; k < quarter; ++k)
+        {
+            real_twiddles_[k] = (T)std::cos(pi * k / size);
+            real_twiddles_[quarter + k] = (T)std::sin(pi * k / size);
+        }
+    }
+
+    forcedinline const uint32* bit_reverse() const
+    {
+        return bit_reverse_.data();
+    }
+
+    forcedinline const T* twiddles() const
+    {
+        return twiddles_.data();
+    }
+
+    forcedinline const T* real_twiddles() const
+    {
+        return real_twiddles_.data();
+    }
+
+    forcedinline uint32 size() const
+    {
+        return size_;
+    }
+
+private:
+    uint32_buffer bit_reverse_;
+    aligned_buffer<T, 32> twiddles_;
+    aligned_buffer<T, 32> real_twiddles_;
+    uint32 size_;
+};
+
+
+//------------------------------------------------------------------------------
+
+namespace fft_detail_ {
+
+    // plans are shared by every transform of the same size and type, and kept
+    // for the lifetime of the process
+    template<class T> std::shared_ptr<const fft_plan<T> > cached_plan(uint32 size)
+    {
+        static std::mutex mutex;
+        static std::map<uint32, std::shared_ptr<const fft_plan<T> > > plans;
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        std::shared_ptr<const fft_plan<T> >& plan = plans[size];
+        if (! plan)
+        {
+            plan = std::make_shared<fft_plan<T> >(size);
+        }
+
+        return plan;
+    }
+
+    // the dispatch table functions of each datatype
+
+    forcedinline void butterflies(const math_dispatch_table& d, float* real, float* imag, uint32 size, const float* twiddles)
+    {
+        d.fft_butterflies_float(real, imag, size, twiddles);
+    }
+
+    forcedinline void butterflies(const math_dispatch_table& d, double* real, double* imag, uint32 size, const double* twiddles)
+    {
+        d.fft_butterflies_double(real, imag, size, twiddles);
+    }
+
+    forcedinline void scale(const math_dispatch_table& d, float* buffer, uint32 size, float gain)
+    {
+        d.scale_buffer_float(buffer, size, gain);
+    }
+
+    forcedinline void scale(const math_dispatch_table& d, double* buffer, uint32 size, double gain)
+    {
+        d.scale_buffer_double_double_gain(buffer, size, gain);
+    }
+
+    forcedinline void interleave(const math_dispatch_table& d, float** src_buffers, float* dst_buffer, uint32 size)
+    {
+        d.interleave_buffers_float(src_buffers, dst_buffer, 2, size);
+    }
+
+    forcedinline void interleave(const math_dispatch_table& d, double** src_buffers, double* dst_buffer, uint32 size)
+    {
+        d.interleave_buffers_double(src_buffers, dst_buffer, 2, size);
+    }
+
+    forcedinline void deinterleave(const math_dispatch_table& d, float* src_buffer, float** dst_buffers, uint32 size)
+    {
+        d.deinterleave_buffer_float(src_buffer, dst_buffers, 2, size);
+    }
+
+    forcedinline void deinterleave(const math_dispatch_table& d, double* src_buffer, double** dst_buffers, uint32 size)
+    {
+        d.deinterleave_buffer_double(src_buffer, dst_buffers, 2, size);
+    }
+
+} // end namespace fft_detail_
+
+
+//------------------------------------------------------------------------------
+
+template<class T>
+fft<T>::fft(const math& m, uint32 size)
+  : dispatch_(m.dispatch()),
+    size_(size),
+    work_(size)
+{
+    assert(size >= 2);
+    assert((size & (size - 1)) == 0);
+
+    complex_plan_ = fft_detail_::cached_plan<T>(size);
+    real_plan_ = fft_detail_::cached_plan<T>(size / 2);
+}
+
+
+//------------------------------------------------------------------------------
+
+template<class T>
+void fft<T>::forward(T* src_real, T* src_imag, T* dst_real, T* dst_imag)
+{
+    transform(*complex_plan_, src_real, src_imag, dst_real, dst_imag);
+}
+
+
+//------------------------------------------------------------------------------
+
+template<class T>
+void fft<T>::inverse(T* src_real, T* src_imag, T* dst_real, T* dst_imag)
+{
+    // swapping the real and imaginary parts turns the forward transform in
+    // the inverse one
+    transform(*complex_plan_, src_imag, src_real, dst_imag, dst_real);
+
+    fft_detail_::scale(dispatch_, dst_real, size_, T(1) / size_);
+    fft_detail_::scale(dispatch_, dst_imag, size_, T(1) / size_);
+}
+
+
+//------------------------------------------------------------------------------
+
+template<class T>
+void fft<T>::forward_real(T* src_buffer, T* dst_real, T* dst_imag)
+{
+    const uint32 half = size_ / 2;
+    const T* cosine = real_plan_->real_twiddles();
+    const T* sine = cosine + half / 2 + 1;
+
+    // the even samples are the real parts of a transform half as long, the
+    // odd ones its imaginary parts
+    T* work[2] = { work_.data(), work_.data() + half };
+    fft_detail_::deinterleave(dispatch_, src_buffer, work, half);
+
+    transform(*real_plan_, work[0], work[1], dst_real, dst_imag);
+
+    disable_floating_point_assertions;
+
+    // split the spectrum of both halves and join them in the one of the
+    // whole, bins k and half - k come from the same pair of values
+    const T first_real = dst_real[0];
+    const T first_imag = dst_imag[0];
+    dst_real[0] = first_real + first_imag;
+    dst_imag[0] = T(0);
+    dst_real[half] = first_real - first_imag;
+    dst_imag[half] = T(0);
+
+    for (uint32 k = 1; k <= half / 2; ++k)
+    {
+        const uint32 j = half - k;
+
+        const T even_real = (dst_real[k] + dst_real[j]) * T(0.5);
+        const T even_imag = (dst_imag[k] - dst_imag[j]) * T(0.5);
+        const T odd_real = (dst_imag[k] + dst_imag[j]) * T(0.5);
+        const T odd_imag = (dst_real[j] - dst_real[k]) * T(0.5);
+
+        const T twiddled_real = cosine[k] * odd_real + sine[k] * odd_imag;
+        const T twiddled_imag = cosine[k] * odd_imag - sine[k] * odd_real;
+
+        dst_real[k] = even_real + twiddled_real;
+        dst_imag[k] = even_imag + twiddled_imag;
+        dst_real[j] = even_real - twiddled_real;
+        dst_imag[j] = twiddled_imag - even_imag;
+    }
+
+    enable_floating_point_assertions;
+}
+
+
+//------------------------------------------------------------------------------
+
+template<class T>
+void fft<T>::inverse_real(T* src_real, T* src_imag, T* dst_buffer)
+{
+    const uint32 half = size_ / 2;
+    const T* cosine = real_plan_->real_twiddles();
+    const T* sine = cosine + half / 2 + 1;
+    const T scale = T(1) / size_;
+
+    T* work[2] = { work_.data(), work_.data() + half };
+
+    disable_floating_point_assertions;
+
+    // fold the bins back in the spectrum of the transform half as long, the
+    // 1 / size scale of the inverse transform goes in here too
+    work[0][0] = (src_real[0] + src_real[half]) * scale;
+    work[1][0] = (src_real[0] - src_real[half]) * scale;
+
+    for (uint32 k = 1; k <= half / 2; ++k)
+    {
+        const uint32 j = half - k;
+
+        const T even_real = (src_real[k] + src_real[j]) * scale;
+        const T even_imag = (src_imag[k] - src_imag[j]) * scale;
+        const T difference_real = (src_real[k] - src_real[j]) * scale;
+        const T difference_imag = (src_imag[k] + src_imag[j]) * scale;
+
+        const T odd_real = cosine[k] * difference_real - sine[k] * difference_imag;
+        const T odd_imag = cosine[k] * difference_imag + sine[k] * difference_real;
+
+        work[0][k] = even_real - odd_imag;
+        work[1][k] = even_imag + odd_real;
+        work[0][j] = even_real + odd_imag;
+        work[1][j] = odd_real - even_imag;
+    }
+
+    enable_floating_point_assertions;
+
+    transform(*real_plan_, work[1], work[0], work[1], work[0]);
+
+    fft_detail_::interleave(dispatch_, work, dst_buffer, half);
+}
+
+
+//------------------------------------------------------------------------------
+
+template<class T>
+void fft<T>::transform(const fft_plan<T>& plan, T* src_real, T* src_imag, T* dst_real, T* dst_imag)
+{
+    const uint32 size = plan.size();
+    const uint32* reverse = plan.bit_reverse();
+
+    if (src_real == dst_real)
+    {
+        for (uint32 i = 0; i < size; ++i)
+        {
+            const uint32 j = reverse[i];
+            if (j > i)
+            {
+                std::swap(dst_real[i], dst_real[j]);
+                std::swap(dst_imag[i], dst_imag[j]);
+            }
+        }
+    }
+    else
+    {
+        for (uint32 i = 0; i < size; ++i)
+        {
+            dst_real[i] = src_real[reverse[i]];
+            dst_imag[i] = src_imag[reverse[i]];
+        }
+    }
+
+    fft_detail_::butterflies(dispatch_, dst_real, dst_imag, size, plan.twiddles());
+}
+
+
+//------------------------------------------------------------------------------
+
+template class fft<float>;
+template class fft<double>;
+
+
+//==============================================================================
+
+//------------------------------------------------------------------------------
+
+fir_convolver::fir_convolver(const math& m, const float* kernel, uint32 kernel_size, uint32 block_size)
+  : dispatch_(m.dispatch()),
+    kernel_size_(kernel_size),
+    block_size_(block_size),
+    fft_size_(0),
+    bins_(0),
+    bins_stride_(0),
+    partitions_(0),
+    current_partition_(0)
+{
+    assert(kernel != nullptr);
+    assert(kernel_size > 0);
+    assert(block_size > 0);
+
+    if (kernel_size < direct_max_taps)
+    {
+        // the block is appended to the last kernel_size - 1 input samples
+        kernel_.resize(kernel_size);
+        history_.resize(kernel_size - 1 + block_size);
+
+        for (uint32 i = 0; i < kernel_size; ++i)
+        {
+            kernel_[i] = kernel[i];
+        }
+    }
+    else
+    {
+        // partitions of one block, zero padded to twice the next power of two
+        // of their size so the products of the spectra are linear convolutions
+        fft_size_ = 2;
+        while (fft_size_ < block_size * 2)
+            fft_size_ <<= 1;
+
+        bins_ = fft_size_ / 2 + 1;
+        bins_stride_ = (bins_ + 7) & ~7;
+        partitions_ = (kernel_size + block_size - 1) / block_size;
+
+        fft_.reset(new float_fft(m, fft_size_));
+        work_.resize(fft_size_);
+        spectra_.resize(partitions_ * 2 * bins_stride_);
+        delay_line_.resize(partitions_ * 3 * bins_stride_);
+        accumulator_.resize(2 * bins_stride_);
+        overlap_.resize(block_size);
+
+        // transform the partitions
+        float* work = work_.data();
+
+        for (uint32 p = 0; p < partitions_; ++p)
+        {
+            const uint32 offset = p * block_size;
+            const uint32 taps = kernel_size - offset < block_size ? kernel_size - offset : block_size;
+
+            dispatch_.clear_buffer_float(work, fft_size_);
+            for (uint32 i = 0; i < taps; ++i)
+            {
+                work[i] = kernel[offset + i];
+            }
+
+            float* spectrum = spectra_.data() + p * 2 * bins_stride_;
+            fft_->forward_real(work, spectrum, spectrum + bins_stride_);
+        }
+    }
+
+    reset();
+}
+
+
+//------------------------------------------------------------------------------
+
+void fir_convolver::process(float* src_buffer, float* dst_buffer, uint32 size)
+{
+    assert(size % block_size_ == 0);
+
+    for (uint32 i = 0; i < size; i += block_size_)
+    {
+        if (is_partitioned())
+        {
+            process_partitioned(src_buffer + i, dst_buffer + i);
+        }
+        else
+        {
+            process_direct(src_buffer + i, dst_buffer + i);
+        }
+    }
+}
+
+
+//------------------------------------------------------------------------------
+
+void fir_convolver::reset()
+{
+    if (is_partitioned())
+    {
+        dispatch_.clear_buffer_float(delay_line_.data(), delay_line_.size());
+        dispatch_.clear_buffer_float(overlap_.data(), overlap_.size());
+        current_partition_ = 0;
+    }
+    else
+    {
+        dispatch_.clear_buffer_float(history_.data(), history_.size());
+    }
+}
+
+
+//------------------------------------------------------------------------------
+
+void fir_convolver::process_direct(float* src_buffer, float* dst_buffer)
+{
+    const uint32 history_size = kernel_size_ - 1;
+    float* history = history_.data();
+
+    // the block is copied first, so the destination can be the source
+    dispatch_.copy_buffer_float(src_buffer, history + history_size, block_size_);
+    dispatch_.clear_buffer_float(dst_buffer, block_size_);
+
+    // one scaled add of the delayed block per tap
+    for (uint32 k = 0; k < kernel_size_; ++k)
+    {
+        dispatch_.scale_add_buffer_float(history + history_size - k, dst_buffer,
+            block_size_, kernel_[k]);
+    }
+
+    std::memmove(history, history + block_size_, history_size * sizeof(float));
+}
+
+
+//------------------------------------------------------------------------------
+
+void fir_convolver::process_partitioned(float* src_buffer, float* dst_buffer)
+{
+    const uint32 stride = bins_stride_;
+    float* work = work_.data();
+
+    // transform the block padded with zeros straight in the frequency domain
+    // delay line, with the imaginary part negated too so the complex products
+    // are multiply adds only
+    float* slot = delay_line_.data() + current_partition_ * 3 * stride;
+    dispatch_.copy_buffer_float(src_buffer, work, block_size_);
+    dispatch_.clear_buffer_float(work + block_size_, fft_size_ - block_size_);
+    fft_->forward_real(work, slot, slot + stride);
+    dispatch_.copy_buffer_float(slot + stride, slot + 2 * stride, bins_);
+    dispatch_.scale_buffer_float(slot + 2 * stride, bins_, -1.0f);
+
+    // the spectrum of each past block meets the partition of its delay
+    float* accumulator_real = accumulator_.data();
+    float* accumulator_imag = accumulator_real + stride;
+    dispatch_.clear_buffer_float(accumulator_real, 2 * stride);
+
+    uint32 index = current_partition_;
+    for (uint32 p = 0; p < partitions_; ++p)
+    {
+        float* x = delay_line_.data() + index * 3 * stride;
+        float* h = spectra_.data() + p * 2 * stride;
+
+        dispatch_.multiply_add_buffers_float(x, h, accumulator_real, accumulator_real, bins_);
+        dispatch_.multiply_add_buffers_float(x + 2 * stride, h + stride, accumulator_real, accumulator_real, bins_);
+        dispatch_.multiply_add_buffers_float(x, h + stride, accumulator_imag, accumulator_imag, bins_);
+        dispatch_.multiply_add_buffers_float(x + stride, h, accumulator_imag, accumulator_imag, bins_);
+
+        index = (index == 0 ? partitions_ : index) - 1;
+    }
+
+    current_partition_ = (current_partition_ + 1) % partitions_;
+
+    fft_->inverse_real(accumulator_real, accumulator_imag, work);
+
+    // overlap add the tail of the previous block
+    dispatch_.add_buffers_float(work, overlap_.data(), dst_buffer, block_size_);
+    dispatch_.copy_buffer_float(work + block_size_, overlap_.data(), block_size_);
+}
+
+
+//==============================================================================
+
+//------------------------------------------------------------------------------
+
+namespace resampler_detail_ {
+
+struct quality_settings
+{
+    uint32 taps;
+    uint32 phases;
+    double rolloff;
+    double beta;
+};
+
+// taps, phases of arbitrary ratios, passband edge over nyquist, kaiser beta
+static const quality_settings qualities[] =
+{
+    { 8, 64, 0.80, 5.0 },
+    { 32, 256, 0.90, 8.0 },
+    { 64, 1024, 0.95, 10.0 }
+};
+
+static uint64 greatest_common_divisor(uint64 a, uint64 b)
+{
+    while (b != 0)
+    {
+        const uint64 remainder = a % b;
+        a = b;
+        b = remainder;
+    }
+
+    return a;
+}
+
+// zeroth order modified bessel function of the first kind
+static double bessel_i0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+
+    for (int k = 1; k < 64 && term > sum * 1e-12; ++k)
+    {
+        term *= (x * x * 0.25) / (double(k) * k);
+        sum += term;
+    }
+
+    return sum;
+}
+
+} // end namespace
+
+
+//------------------------------------------------------------------------------
+
+resampler::resampler(const math& m, double src_rate, double dst_rate, ResamplerQualityTypes quality)
+  : dispatch_(m.dispatch()),
+    src_rate_(src_rate),
+    dst_rate_(dst_rate),
+    rational_(false),
+    taps_(0),
+    phases_(0),
+    up_(1),
+    down_(1),
+    step_(src_rate / dst_rate),
+    position_(0),
+    phase_(0),
+    fraction_(0.0)
+{
+    assert(src_rate > 0.0);
+    assert(dst_rate > 0.0);
+    assert(quality >= DRAFT_RESAMPLER_QUALITY && quality <= HIGH_RESAMPLER_QUALITY);
+
+    const resampler_detail_::quality_settings& settings = resampler_detail_::qualities[quality];
+
+    // integer rates with a short enough cycle of phases are converted exactly
+    if (src_rate == std::floor(src_rate) && dst_rate == std::floor(dst_rate)
+        && src_rate < 4294967296.0 && dst_rate < 4294967296.0)
+    {
+        const uint64 divisor = resampler_detail_::greatest_common_divisor((uint64)src_rate, (uint64)dst_rate);
+        const uint64 up = (uint64)dst_rate / divisor;
+
+        if (up <= max_rational_phases)
+        {
+            rational_ = true;
+            up_ = (uint32)up;
+            down_ = (uint32)((uint64)src_rate / divisor);
+        }
+    }
+
+    phases_ = rational_ ? up_ : settings.phases;
+
+    // decimating narrows the band, so it takes as many more taps, rounded to
+    // whole registers
+    taps_ = settings.taps;
+    if (dst_rate < src_rate)
+    {
+        taps_ = (uint32)std::ceil(settings.taps * src_rate / dst_rate);
+        taps_ = (taps_ + 7) & ~7;
+    }
+
+    design(settings.rolloff, settings.beta);
+
+    history_.resize(taps_ - 1);
+
+    reset();
+}
+
+
+//------------------------------------------------------------------------------
+
+uint32 resampler::process(float* src_buffer, float* dst_buffer, uint32 size)
+{
+    const uint32 history_size = taps_ - 1;
+    const uint32 total = history_size + size;
+    const uint32 outputs = max_output_size(size);
+
+    // the block is appended to the last taps - 1 input samples
+    if (work_.size() < total)
+        work_.resize(total);
+
+    // the arbitrary path takes two rows, offsets and products per output
+    const uint32 entries = rational_ ? outputs : outputs * 2;
+
+    if (offsets_.size() < entries)
+    {
+        rows_.resize(entries);
+        offsets_.resize(entries);
+    }
+
+    if (! rational_ && weights_.size() < outputs)
+    {
+        products_.resize(entries);
+        weights_.resize(outputs);
+    }
+
+    float* work = work_.data();
+    dispatch_.copy_buffer_float(history_.data(), work, history_size);
+    dispatch_.copy_buffer_float(src_buffer, work + history_size, size);
+
+    // every output position with all its taps in the block, along with its
+    // phase, the last taps of a row meet the sample at the position
+    uint32* rows = rows_.data();
+    uint32* offsets = offsets_.data();
+    uint32 count = 0;
+
+    if (rational_)
+    {
+        while (position_ < total)
+        {
+            rows[count] = phase_;
+            offsets[count] = position_ - history_size;
+            ++count;
+
+            phase_ += down_;
+            position_ += phase_ / up_;
+            phase_ %= up_;
+        }
+
+        dispatch_.process_polyphase_float(work, dst_buffer, count,
+            kernel_.data(), taps_, rows, offsets);
+    }
+    else
+    {
+        float* weights = weights_.data();
+
+        disable_floating_point_assertions;
+
+        while (position_ < total)
+        {
+            const double phase = fraction_ * phases_;
+            const uint32 row = (uint32)phase;
+
+            rows[count * 2] = row;
+            rows[count * 2 + 1] = row + 1;
+            offsets[count * 2] = position_ - history_size;
+            offsets[count * 2 + 1] = position_ - history_size;
+            weights[count] = (float)(phase - row);
+            ++count;
+
+            fraction_ += step_;
+            const double whole = std::floor(fraction_);
+            position_ += (uint32)whole;
+            fraction_ -= whole;
+        }
+
+        enable_floating_point_assertions;
+
+        // the two closest phases of each output and the line between them
+        float* products = products_.data();
+        dispatch_.process_polyphase_float(work, products, count * 2,
+            kernel_.data(), taps_, rows, offsets);
+
+        disable_floating_point_assertions;
+
+        for (uint32 i = 0; i < count; ++i)
+        {
+            dst_buffer[i] = products[i * 2] + weights[i] * (products[i * 2 + 1] - products[i * 2]);
+        }
+
+        enable_floating_point_assertions;
+    }
+
+    dispatch_.copy_buffer_float(work + size, history_.data(), history_size);
+    position_ -= size;
+
+    return count;
+}
+
+
+//------------------------------------------------------------------------------
+
+void resampler::reset()
+{
+    dispatch_.clear_buffer_float(history_.data(), history_.size());
+
+    position_ = taps_ - 1;
+    phase_ = 0;
+    fraction_ = 0.0;
+}
+
+
+//------------------------------------------------------------------------------
+
+uint32 resampler::max_output_size(uint32 size) const
+{
+    if (rational_)
+    {
+        return (uint32)(((uint64)size * up_ + down_ - 1) / down_);
+    }
+
+    return (uint32)std::ceil(size / step_) + 1;
+}
+
+
+//------------------------------------------------------------------------------
+
+double resampler::latency() const
+{
+    return taps_ * 0.5 * dst_rate_ / src_rate_;
+}
+
+
+//------------------------------------------------------------------------------
+
+void resampler::design(double rolloff, double beta)
+{
+    const double pi = 3.14159265358979323846;
+
+    // the rows of arbitrary ratios go one phase further, to interpolate
+    // towards the next sample
+    const uint32 rows = rational_ ? phases_ : phases_ + 1;
+    const uint32 length = phases_ * taps_;
+    const double centre = length * 0.5;
+    const double cutoff = rolloff * 0.5 * std::min(1.0, dst_rate_ / src_rate_) / phases_;
+    const double window_scale = 1.0 / resampler_detail_::bessel_i0(beta);
+
+    kernel_.resize(rows * taps_);
+
+    disable_floating_point_assertions;
+
+    // kaiser windowed sinc prototype at phases times the input rate, each
+    // row holds the taps of one phase reversed so it runs along the input
+    // and is scaled so a constant signal comes out unchanged
+    double_buffer row(taps_);
+    for (uint32 p = 0; p < rows; ++p)
+    {
+        double sum = 0.0;
+
+        for (uint32 j = 0; j < taps_; ++j)
+        {
+            const uint32 n = p + (taps_ - 1 - j) * phases_;
+            double value = 0.0;
+
+            if (n < length)
+            {
+                const double x = 2.0 * cutoff * (n - centre);
+                const double sinc = x == 0.0 ? 1.0 : std::sin(pi * x) / (pi * x);
+                const double position = 2.0 * n / length - 1.0;
+                const double window = resampler_detail_::bessel_i0(beta * std::sqrt(1.0 - position * position)) * window_scale;
+
+                value = sinc * window;
+            }
+
+            row[j] = value;
+            sum += value;
+        }
+
+        for (uint32 j = 0; j < taps_; ++j)
+        {
+            kernel_[p * taps_ + j] = (float)(row[j] / sum);
+        }
+    }
+
+    enable_floating_point_assertions;
+}
+
+
+//==============================================================================
+
+//------------------------------------------------------------------------------
+
+image_filter::image_filter(const math& m)
+  : dispatch_(m.dispatch())
+{
+}
+
+
+//------------------------------------------------------------------------------
+
+void image_filter::convolve(float_plane& src, float_plane& dst,
+    float* horizontal_kernel, uint32 horizontal_size,
+    float* vertical_kernel, uint32 vertical_size)
+{
+    assert(horizontal_size > 0 && vertical_size > 0);
+
+    prepare(src, dst);
+
+    dispatch_.convolve_rows_float(src.data(), src.stride(), work_.data(), work_.stride(),
+        src.width(), src.height(), horizontal_kernel, horizontal_size);
+    dispatch_.convolve_columns_float(work_.data(), work_.stride(), dst.data(), dst.stride(),
+        src.width(), src.height(), vertical_kernel, vertical_size);
+}
+
+
+//------------------------------------------------------------------------------
+
+void image_filter::box_blur(float_plane& src, float_plane& dst,
+    uint32 horizontal_radius, uint32 vertical_radius)
+{
+    prepare(src, dst);
+
+    dispatch_.box_blur_rows_float(src.data(), src.stride(), work_.data(), work_.stride(),
+        src.width(), src.height(), horizontal_radius);
+    dispatch_.box_blur_columns_float(work_.data(), work_.stride(), dst.data(), dst.stride(),
+        src.width(), src.height(), vertical_radius);
+}
+
+
+//------------------------------------------------------------------------------
+
+void image_filter::gaussian_blur(float_plane& src, float_plane& dst, double sigma, GaussianBlurTypes type)
+{
+    if (type == KERNEL_GAUSSIAN_BLUR)
+    {
+        gaussian_kernel(sigma, kernel_);
+
+        convolve(src, dst, kernel_.data(), kernel_.size(), kernel_.data(), kernel_.size());
+        return;
+    }
+
+    uint32 radii[box_gaussian_passes];
+    gaussian_box_radii(sigma, radii);
+
+    prepare(src, dst);
+
+    // the passes go back and forth between the work and destination planes,
+    // the rows ones first, so the last of an even count lands in dst
+    float_plane* from = &src;
+
+    for (uint32 pass = 0; pass < 2 * box_gaussian_passes; ++pass)
+    {
+        float_plane* to = (pass & 1) ? &dst : &work_;
+
+        if (pass < box_gaussian_passes)
+        {
+            dispatch_.box_blur_rows_float(from->data(), from->stride(), to->data(), to->stride(),
+                src.width(), src.height(), radii[pass]);
+        }
+        else
+        {
+            dispatch_.box_blur_columns_float(from->data(), from->stride(), to->data(), to->stride(),
+                src.width(), src.height(), radii[pass - box_gaussian_passes]);
+        }
+
+        from = to;
+    }
+}
+
+
+//------------------------------------------------------------------------------
+
+void image_filter::gaussian_kernel(double sigma, float_buffer& kernel)
+{
+    const uint32 radius = sigma > 0.0 ? (uint32)std::ceil(3.0 * sigma) : 0;
+
+    kernel.resize(2 * radius + 1);
+
+    if (radius == 0)
+    {
+        kernel[0] = 1.0f;
+        return;
+    }
+
+    double sum = 0.0;
+    for (int32 i = -int32(radius); i <= int32(radius); ++i)
+    {
+        sum += std::exp(-0.5 * i * i / (sigma * sigma));
+    }
+
+    for (int32 i = -int32(radius); i <= int32(radius); ++i)
+    {
+        kernel[i + radius] = (float)(std::exp(-0.5 * i * i / (sigma * sigma)) / sum);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+
+void image_filter::gaussian_box_radii(double sigma, uint32* radii)
+{
+    // boxes of odd widths lower and lower + 2 whose variances, (width^2 - 1) / 12
+    // each, add up the closest to sigma^2
+    const double passes = box_gaussian_passes;
+    const double variance = sigma > 0.0 ? sigma * sigma : 0.0;
+
+    int32 lower = (int32)std::floor(std::sqrt(12.0 * variance / passes + 1.0));
+    if ((lower & 1) == 0)
+        --lower;
+
+    const double lower_passes = (12.0 * variance - passes * lower * lower - 4.0 * passes * lower - 3.0 * passes)
+        / (-4.0 * lower - 4.0);
+    const int32 lower_count = std::min(std::max((int32)std::floor(lower_passes + 0.5), 0), int32(box_gaussian_passes));
+
+    for (int32 pass = 0; pass < box_gaussian_passes; ++pass)
+    {
+        radii[pass] = (uint32)((pass < lower_count ? lower : lower + 2) - 1) / 2;
+    }
+}
+
+
+//------------------------------------------------------------------------------
+
+void image_filter::prepare(const float_plane& src, const float_plane& dst)
+{
+    assert(src.width() == dst.width() && src.height() == dst.height());
+
+    if (work_.width() != src.width() || work_.height() != src.height())
+        work_.resize(src.width(), src.height());
+}
+
+
+//==============================================================================
+
+//------------------------------------------------------------------------------
+
+image_resizer::image_resizer(const math& m, uint32 src_width, uint32 src_height,
+    uint32 dst_width, uint32 dst_height, ResizeFilterTypes filter, uint32 channels)
+  : dispatch_(m.dispatch()),
+    src_width_(src_width),
+    src_height_(src_height),
+    dst_width_(dst_width),
+    dst_height_(dst_height),
+    channels_(channels),
+    horizontal_taps_(0),
+    vertical_taps_(0)
+{
+    assert(channels >= 1 && channels <= 4);
+    assert(src_width > 0 && src_height > 0 && dst_width > 0 && dst_height > 0);
+    assert(dst_width * uint32(max_downscale) >= src_width && dst_width <= src_width * uint32(max_upscale));
+    assert(dst_height * uint32(max_downscale) >= src_height && dst_height <= src_height * uint32(max_upscale));
+
+    horizontal_taps_ = design(filter, src_width, dst_width, horizontal_coefficients_, horizontal_offsets_);
+    vertical_taps_ = design(filter, src_height, dst_height, vertical_coefficients_, vertical_offsets_);
+
+    work_.resize(dst_width * channels, src_height);
+}
+
+
+//------------------------------------------------------------------------------
+
+void image_resizer::process(uint8_plane& src, uint8_plane& dst)
+{
+    assert(src.width() == src_width_ * channels_ && src.height() == src_height_);
+    assert(dst.width() == dst_width_ * channels_ && dst.height() == dst_height_);
+
+    dispatch_.resize_rows_uint8(src.data(), src.stride(), work_.data(), work_.stride(),
+        dst_width_, src_height_, channels_, horizontal_coefficients_.data(), horizontal_taps_, horizontal_offsets_.data());
+    dispatch_.resize_columns_uint8(work_.data(), work_.stride(), dst.data(), dst.stride(),
+        dst_width_ * channels_, dst_height_, vertical_coefficients_.data(), vertical_taps_, vertical_offsets_.data());
+}
+
+
+//------------------------------------------------------------------------------
+
+void image_resizer::process(float_plane& src, float_plane& dst)
+{
+    assert(src.width() == src_width_ * channels_ && src.height() == src_height_);
+    assert(dst.width() == dst_width_ * channels_ && dst.height() == dst_height_);
+
+    dispatch_.resize_rows_float(src.data(), src.stride(), work_.data(), work_.stride(),
+        dst_width_, src_height_, channels_, horizontal_coefficients_.data(), horizontal_taps_, horizontal_offsets_.data());
+    dispatch_.resize_columns_float(work_.data(), work_.stride(), dst.data(), dst.stride(),
+        dst_width_ * channels_, dst_height_, vertical_coefficients_.data(), vertical_taps_, vertical_offsets_.data());
+}
+
+
+//------------------------------------------------------------------------------
+
+double image_resizer::filter_weight(ResizeFilterTypes filter, double x)
+{
+    const double pi = 3.14159265358979323846;
+
+    x = std::fabs(x);
+
+    switch (filter)
+    {
+    case BILINEAR_RESIZE_FILTER:
+        return x < 1.0 ? 1.0 - x : 0.0;
+
+    case BICUBIC_RESIZE_FILTER:
+        // Keys cubic convolution with a = -0.5, the Catmull-Rom spline
+        if (x < 1.0)
+            return (1.5 * x - 2.5) * x * x + 1.0;
+        else if (x < 2.0)
+            return ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0;
+        return 0.0;
+
+    case LANCZOS3_RESIZE_FILTER:
+        if (x < 1e-8)
+            return 1.0;
+        else if (x < 3.0)
+            return 3.0 * std::sin(pi * x) * std::sin(pi * x / 3.0) / (pi * pi * x * x);
+        return 0.0;
+    }
+
+    return 0.0;
+}
+
+
+//------------------------------------------------------------------------------
+
+double image_resizer::filter_support(ResizeFilterTypes filter)
+{
+    switch (filter)
+    {
+    case BILINEAR_RESIZE_FILTER:
+        return 1.0;
+
+    case BICUBIC_RESIZE_FILTER:
+        return 2.0;
+
+    case LANCZOS3_RESIZE_FILTER:
+        return 3.0;
+    }
+
+    return 1.0;
+}
+
+
+//------------------------------------------------------------------------------
+
+uint32 image_resizer::design(ResizeFilterTypes filter, uint32 src_size, uint32 dst_size,
+    float_buffer& coefficients, uint32_buffer& offsets)
+{
+    // downscaling stretches the filter over 1 / scale source pixels, the taps
+    // cover its support around any center and never exceed the source
+    const double scale = double(dst_size) / double(src_size);
+    const double stretch = scale < 1.0 ? 1.0 / scale : 1.0;
+    const double support = filter_support(filter) * stretch;
+    const uint32 taps = std::min(uint32(std::ceil(support)) * 2 + 1, src_size);
+
+    coefficients.resize(dst_size * taps);
+    offsets.resize(dst_size);
+
+    double_buffer weights(taps);
+
+    disable_floating_point_assertions;
+
+    for (uint32 i = 0; i < dst_size; ++i)
+    {
+        // pixel centers sit at half pixels in both sizes
+        const double center = (i + 0.5) / scale;
+        const int32 first = int32(std::floor(center - support));
+        const int32 last = int32(std::ceil(center + support));
+
+        // the window starts at the first position, moved inside the source:
+        // the positions past the edges add their weights to the edge ones
+        const int32 offset = std::min(std::max(first, 0), int32(src_size - taps));
+
+        for (uint32 k = 0; k < taps; ++k)
+            weights[k] = 0.0;
+
+        double sum = 0.0;
+        for (int32 j = first; j < last; ++j)
+        {
+            const double weight = filter_weight(filter, (j + 0.5 - center) / stretch);
+            if (weight == 0.0)
+                continue;
+
+            const int32 position = std::min(std::max(j, 0), int32(src_size) - 1);
+            weights[position - offset] += weight;
+            sum += weight;
+        }
+
+        for (uint32 k = 0; k < taps; ++k)
+            coefficients[i * taps + k] = float(weights[k] / sum);
+
+        offsets[i] = uint32(offset);
+    }
+
+    enable_floating_point_assertions;
+
+    return taps;
+}
+
+
 } // end namespace
@@ -0,0 +1,448 @@
+/*
+ * waterspout
+ *
+ *   - simd abstraction library for audio/image manipulation -
+ *
+ * Copyright (c) 2015 Lucio Asnaghi
+ *
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __WATERSPOUT_SIMD_ABSTRACTION_FRAMEWORK_INTERNAL_H__
+#define __WATERSPOUT_SIMD_ABSTRACTION_FRAMEWORK_INTERNAL_H__
+
+#include <waterspout.h>
+
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+
+// intrinsics headers must be seen before any waterspout_target_begin
+#if defined(WATERSPOUT_SIMD_MMX)
+    #include <mmintrin.h>  // MMX
+#endif
+
+#if defined(WATERSPOUT_SIMD_SSE)
+    #include <xmmintrin.h> // SSE
+#endif
+
+#if defined(WATERSPOUT_SIMD_SSE2)
+    #include <emmintrin.h> // SSE2
+#endif
+
+#if defined(WATERSPOUT_SIMD_SSE3)
+    #include <pmmintrin.h> // SSE3
+#endif
+
+#if defined(WATERSPOUT_SIMD_SSSE3)
+    #include <tmmintrin.h> // SSSE3
+#endif
+
+#if defined(WATERSPOUT_SIMD_SSE41)
+    #include <smmintrin.h> // SSE4.1
+#endif
+
+#if defined(WATERSPOUT_SIMD_SSE42)
+    #include <nmmintrin.h> // SSE4.2
+#endif
+
+#if defined(WATERSPOUT_SIMD_AVX) || defined(WATERSPOUT_SIMD_AVX2) || defined(WATERSPOUT_SIMD_AVX512)
+    #include <immintrin.h> // AVX, AVX2 and AVX-512
+#endif
+
+#if defined(WATERSPOUT_SIMD_NEON)
+    #include <arm_neon.h>  // NEON
+#endif
+
+
+namespace waterspout {
+
+
+//==============================================================================
+
+//------------------------------------------------------------------------------
+
+/**
+ * These macros are ripped from Intel Architecture Code Analyzer (IACA) and
+ * serves the purpose to check for performance bottleneck in SIMD instructions
+ *
+ * http://software.intel.com/en-us/articles/intel-architecture-code-analyzer
+ */
+
+#ifdef IACA_MARKS_OFF
+    #define IACA_START
+    #define IACA_END
+    #define IACA_MSC64_START
+    #define IACA_MSC64_END
+
+#else
+    #if defined(WATERSPOUT_COMPILER_GCC) || defined(WATERSPOUT_COMPILER_MINGW) || defined(WATERSPOUT_COMPILER_CLANG)
+        #define IACA_SSC_MARK(MARK_ID) \
+            __asm__ __volatile__( \
+                "\n\t  movl $"#MARK_ID", %%ebx"	\
+                "\n\t  .byte 0x64, 0x67, 0x90" \
+                : : : "memory" );
+
+        #define IACA_UD_BYTES \
+            __asm__ __volatile__( \
+                "\n\t .byte 0x0F, 0x0B");
+
+    #else
+        #define IACA_UD_BYTES \
+            { __asm _emit 0x0F \
+              __asm _emit 0x0B }
+
+        #define IACA_SSC_MARK(x) \
+            { __asm  mov ebx, x \
+              __asm  _emit 0x64 \
+              __asm  _emit 0x67 \
+              __asm  _emit 0x90 }
+
+        #define IACA_VC64_START __writegsbyte(111, 111);
+        #define IACA_VC64_END   __writegsbyte(222, 222);
+
+    #endif
+
+    #define IACA_START { IACA_UD_BYTES      IACA_SSC_MARK(111) }
+    #define IACA_END   { IACA_SSC_MARK(222) IACA_UD_BYTES }
+
+#endif
+
+
+//==============================================================================
+
+//------------------------------------------------------------------------------
+
+/**
+ * @brief The CpuFeatures enum
+ *
+ * Reference:
+ * http://datasheets.chipdb.org/Intel/x86/CPUID/24161821.pdf
+ * http://www.flounder.com/cpuid_explorer2.htm
+ */
+enum CpuFeatures
+{
+    FPU   = 1 <<  0, // Floating-Point Unit on-chip
+    MMX   = 1 << 23, // MultiMedia eXtension
+    SSE   = 1 << 25, // Streaming SIMD Extension 1
+    SSE2  = 1 << 26  // Streaming SIMD Extension 2
+};
+
+/**
+ * @brief The CpuExtendedFeatures enum
+ *
+ * Reference:
+ * http://datasheets.chipdb.org/Intel/x86/CPUID/24161821.pdf
+ * http://www.flounder.com/cpuid_explorer2.htm
+ */
+enum CpuExtendedFeatures
+{
+    SSE3  = 1 <<  0, // Streaming SIMD Extension 3
+    SSE4A = 1 <<  6, // SSE4A (only for AMD)
+    SSSE3 = 1 <<  9, // SSSE3
+    FMA   = 1 << 12, // Fused Multiply Add (FMA3)
+    SSE41 = 1 << 19, // SSE41
+    SSE42 = 1 << 20, // SSE42
+    OSXSAVE = 1 << 27, // OS enabled XGETBV
+    AVX   = 1 << 28  // AVX
+};
+
+/**
+ * @brief The CpuStructuredExtendedFeatures enum
+ *
+ * Reference:
+ * http://www.intel.com/content/dam/www/public/us/en/documents/manuals/64-ia-32-architectures-software-developer-vol-2a-manual.pdf
+ */
+enum CpuStructuredExtendedFeatures
+{
+    AVX2     = 1 <<  5, // AVX2
+    AVX512F  = 1 << 16, // AVX-512 Foundation
+    AVX512DQ = 1 << 17, // AVX-512 Doubleword and Quadword
+    AVX512BW = 1 << 30  // AVX-512 Byte and Word
+};
+
+/**
+ * @brief The CpuOsStateFeatures enum (XCR0 register bits)
+ */
+enum CpuOsStateFeatures
+{
+    OS_AVX    = 0x06, // XMM and YMM state
+    OS_AVX512 = 0xE6  // XMM, YMM, opmask and ZMM state
+};
+
+/**
+ * @brief The CpuEndianess enum
+ */
+enum CpuEndianess
+{
+    ENDIAN_UNKNOWN     = 0,
+    ENDIAN_BIG         = 1,
+    ENDIAN_LITTLE      = 2,
+    ENDIAN_BIG_WORD    = 3, // Middle-endian, Honeywell 316 style
+    ENDIAN_LITTLE_WORD = 4  // Middle-endian, PDP-11 style
+};
+
+
+//------------------------------------------------------------------------------
+
+/**
+ * Processor queries, implemented in waterspout.cpp
+ */
+
+void cpuid(uint32 op, uint32& eax, uint32& ebx, uint32& ecx, uint32& edx);
+uint32 cpu_features();
+uint32 cpu_extended_features();
+uint32 cpu_structured_extended_features();
+uint32 cpu_os_state_features();
+bool cpu_has_neon();
+
+
+//==============================================================================
+
+//------------------------------------------------------------------------------
+
+#define simd_unroll_head_16(s) \
+    switch (align_bytes >> 4) \
+    { \
+    case 1:  s; \
+    case 2:  s; \
+    case 3:  s; \
+    case 4:  s; \
+    case 5:  s; \
+    case 6:  s; \
+    case 7:  s; \
+    case 8:  s; \
+    case 9:  s; \
+    case 10: s; \
+    case 11: s; \
+    case 12: s; \
+    case 13: s; \
+    case 14: s; \
+    case 15: s; \
+    }
+
+#define simd_unroll_tail_16(s) \
+    switch (size & 15) \
+    { \
+    case 15: s; \
+    case 14: s; \
+    case 13: s; \
+    case 12: s; \
+    case 11: s; \
+    case 10: s; \
+    case 9:  s; \
+    case 8:  s; \
+    case 7:  s; \
+    case 6:  s; \
+    case 5:  s; \
+    case 4:  s; \
+    case 3:  s; \
+    case 2:  s; \
+    case 1:  s; \
+    }
+
+
+//------------------------------------------------------------------------------
+
+#define simd_unroll_head_8(s) \
+    switch (align_bytes >> 3) \
+    { \
+    case 1: s; \
+    case 2: s; \
+    case 3: s; \
+    case 4: s; \
+    case 5: s; \
+    case 6: s; \
+    case 7: s; \
+    }
+
+#define simd_unroll_tail_8(s) \
+    switch (size & 7) \
+    { \
+    case 7: s; \
+    case 6: s; \
+    case 5: s; \
+    case 4: s; \
+    case 3: s; \
+    case 2: s; \
+    case 1: s; \
+    }
+
+
+//------------------------------------------------------------------------------
+
+#define simd_unroll_head_4(s) \
+    switch (align_bytes >> 2) \
+    { \
+    case 1: s; \
+    case 2: s; \
+    case 3: s; \
+    }
+
+#define simd_unroll_tail_4(s) \
+    switch (size & 3) \
+    { \
+    case 3: s; \
+    case 2: s; \
+    case 1: s; \
+    }
+
+
+//------------------------------------------------------------------------------
+
+#define simd_unroll_head_2(s) \
+    switch (align_bytes >> 1) \
+    { \
+    case 1: s; \
+    }
+
+#define simd_unroll_tail_2(s) \
+    switch (size & 1) \
+    { \
+    case 1: s; \
+    }
+
+
+//------------------------------------------------------------------------------
+
+#define simd_loop_head(datatype, alignment, s) \
+    { \
+        uint32 head_count = (uint32)((((alignment) + 1) - align_bytes) \
+            & (alignment)) / (uint32)sizeof(datatype); \
+        while (head_count--) \
+        { \
+            s; \
+        } \
+    }
+
+#define simd_loop_tail(vector_size, s) \
+    { \
+        uint32 tail_count = size & ((vector_size) - 1); \
+        while (tail_count--) \
+        { \
+            s; \
+        } \
+    }
+
+
+//==============================================================================
+
+//------------------------------------------------------------------------------
+
+/**
+ * Every backend lives in its own translation unit (src/math_*.cpp), which is
+ * compiled for the baseline architecture and switches the code generation of
+ * the backend to its own instruction set with these macros. This way the
+ * whole library can be built without -march flags and the math factory picks
+ * the best backend at runtime from cpuid only.
+ *
+ * Once FMA is enabled GCC fuses multiplies and adds across statements and
+ * clang within expressions, so the scalar code the FMA backends inherit would
+ * round differently from the backends it comes from: both compilers have
+ * contraction off between the two macros, only fma intrinsics fuse.
+ *
+ * MSVC doesn't need anything: it allows every intrinsic in every function.
+ */
+
+#define waterspout_pragma(x) _Pragma(#x)
+
+#if defined(WATERSPOUT_SIMD_RUNTIME_DISPATCH) && defined(WATERSPOUT_COMPILER_CLANG)
+    #define waterspout_target_begin(isa) \
+        waterspout_pragma(clang attribute push (__attribute__((target(isa))), apply_to = function)) \
+        waterspout_pragma(STDC FP_CONTRACT OFF)
+    #define waterspout_target_end \
+        waterspout_pragma(STDC FP_CONTRACT DEFAULT) \
+        waterspout_pragma(clang attribute pop)
+
+#elif defined(WATERSPOUT_SIMD_RUNTIME_DISPATCH)
+    #define waterspout_target_begin(isa) \
+        waterspout_pragma(GCC push_options) \
+        waterspout_pragma(GCC target(isa)) \
+        waterspout_pragma(GCC optimize("fp-contract=off"))
+    #define waterspout_target_end \
+        waterspout_pragma(GCC pop_options)
+
+#else
+    #define waterspout_target_begin(isa)
+    #define waterspout_target_end
+
+#endif
+
+
+//------------------------------------------------------------------------------
+
+/**
+ * Backend factories, each one implemented in its own translation unit, they
+ * also fill the dispatch table with the functions of the very same backend
+ */
+
+math_interface_* create_math_fpu(math_dispatch_table& table);
+
+#if defined(WATERSPOUT_SIMD_MMX)
+    math_interface_* create_math_mmx(math_dispatch_table& table);
+#endif
+
+#if defined(WATERSPOUT_SIMD_SSE)
+    math_interface_* create_math_sse(math_dispatch_table& table);
+#endif
+
+#if defined(WATERSPOUT_SIMD_SSE2)
+    math_interface_* create_math_sse2(math_dispatch_table& table);
+#endif
+
+#if defined(WATERSPOUT_SIMD_SSE3)
+    math_interface_* create_math_sse3(math_dispatch_table& table);
+#endif
+
+#if defined(WATERSPOUT_SIMD_SSSE3)
+    math_interface_* create_math_ssse3(math_dispatch_table& table);
+#endif
+
+#if defined(WATERSPOUT_SIMD_SSE41)
+    math_interface_* create_math_sse41(math_dispatch_table& table);
+#endif
+
+#if defined(WATERSPOUT_SIMD_SSE42)
+    math_interface_* create_math_sse42(math_dispatch_table& table);
+#endif
+
+#if defined(WATERSPOUT_SIMD_AVX)
+    math_interface_* create_math_avx(math_dispatch_table& table);
+#endif
+
+#if defined(WATERSPOUT_SIMD_AVX2)
+    math_interface_* create_math_avx2(math_dispatch_table& table);
+#endif
+
+#if defined(WATERSPOUT_SIMD_AVX512)
+    math_interface_* create_math_avx512(math_dispatch_table& table);
+#endif
+
+#if defined(WATERSPOUT_SIMD_NEON)
+    math_interface_* create_math_neon(math_dispatch_table& table);
+#endif
+
+
+} // end namespace
+
+#endif // __WATERSPOUT_SIMD_ABSTRACTION_FRAMEWORK_INTERNAL_H__
@@ -32,12 +32,17 @@
 
 #include <waterspout.h>
 
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <limits>
 #include <ctime>
 #include <memory>
 #include <typeinfo>
 #include <iostream>
 #include <sstream>
 #include <exception>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -492,6 +497,27 @@ void test_buffers_are_equal_(const char* file, int line, T* a, T* b, uint32 size
 }
 
 
+//------------------------------------------------------------------------------
+
+template<typename T>
+void test_buffers_are_near_(const char* file, int line, T* a, T* b, uint32 size, double tolerance)
+{
+    for (uint32 i = 0; i < size; ++i)
+    {
+        const double difference = std::fabs((double)a[i] - (double)b[i]);
+
+        if (difference > tolerance * std::fabs((double)b[i]))
+        {
+            std::ostringstream error;
+            error << file << "(" << line << "): " << "Buffers are not near... "
+                  << "at index " << i << " (" << print_var_(a[i]) << "!=" << print_var_(b[i]) << ")" << std::endl;
+
+            throw test_exception(error.str());
+        }
+    }
+}
+
+
 //==============================================================================
 
 //------------------------------------------------------------------------------
@@ -520,5 +546,8 @@ void test_buffers_are_equal_(const char* file, int line, T* a, T* b, uint32 size
 #define TEST_BUFFERS_ARE_EQUAL(a, b, size) \
     test_buffers_are_equal_(__FILE__, __LINE__, a, b, size);
 
+#define TEST_BUFFERS_ARE_NEAR(a, b, size, tolerance) \
+    test_buffers_are_near_(__FILE__, __LINE__, a, b, size, tolerance);
+
 
 #endif // __WATERSPOUT_SIMD_ABSTRACTION_FRAMEWORK_TESTS_COMMON_H__
@@ -209,6 +209,2312 @@
         TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), s); \
     }
 
+#define test_abs_buffer_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_abs_buffer_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1a(s); \
+        datatype##_buffer buffer2a(s); \
+        \
+        simd->set_buffer_ ##datatype (buffer1a.data(), s, (datatype)-3); \
+        simd->abs_buffer_ ##datatype (buffer1a.data(), s); \
+        fpu->set_buffer_ ##datatype (buffer2a.data(), s, (datatype)-3); \
+        fpu->abs_buffer_ ##datatype (buffer2a.data(), s); \
+        \
+        TEST_BUFFERS_ARE_EQUAL(buffer1a.data(), buffer2a.data(), s); \
+    }
+
+
+// random values with bits random bits, centered on zero for the signed types
+// when they don't span the whole datatype, in [-1000, 1000) for float and double
+#define fill_random_buffer(datatype, buffer, size, state, bits) \
+    for (uint32 i = 0; i < (uint32)(size); ++i) \
+    { \
+        state = state * 6364136223846793005ull + 1442695040888963407ull; \
+        buffer[i] = ! std::numeric_limits<datatype>::is_integer ? \
+            (datatype)((double)(state >> 11) / 4503599627370496.0 * 1000.0 - 1000.0) : ((bits) == 8 * sizeof(datatype) ? \
+            (datatype)(state >> (64 - (bits))) : (datatype)((int64)(state >> (64 - (bits))) - \
+            (std::numeric_limits<datatype>::is_signed ? (int64)1 << ((bits) - 1) : 0))); \
+    }
+
+// small enough for the products (and their sums) to stay in the datatype range
+#define random_arithmetic_bits(datatype) \
+    (sizeof(datatype) == 1 ? 8 : (sizeof(datatype) == 2 ? 15 : (sizeof(datatype) == 4 ? 16 : 26)))
+
+// odd runs share one misalignment (the backends align a head), even runs
+// misalign every buffer differently (the backends fall back to unaligned code)
+#define random_buffer_offsets(datatype, run, state, oa, ob, od) \
+    state = state * 6364136223846793005ull + 1442695040888963407ull; \
+    const uint32 oa = (uint32)(state >> 40) % (64 / sizeof(datatype)); \
+    const uint32 ob = run % 2 ? oa : (uint32)(state >> 48) % (64 / sizeof(datatype)); \
+    const uint32 od = run % 2 ? oa : (uint32)(state >> 56) % (64 / sizeof(datatype));
+
+#define random_buffer_sizes(s) \
+    { 1, 2, 3, 5, 7, 9, 15, 17, 31, 33, 63, 65, 127, 129, 255, 1021, (uint32)(s) - 1 }
+
+#define test_random_buffers_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_random_buffers_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        const uint32 sizes[] = random_buffer_sizes(s); \
+        const uint32 length = s + 64; \
+        uint64 state = 0x5DEECE66Dull; \
+        \
+        datatype##_buffer buffer1a(length); \
+        datatype##_buffer buffer1b(length); \
+        datatype##_buffer buffer1full(length); \
+        datatype##_buffer buffer1dest(length); \
+        datatype##_buffer buffer2dest(length); \
+        \
+        fill_random_buffer(datatype, buffer1a, length, state, random_arithmetic_bits(datatype)); \
+        fill_random_buffer(datatype, buffer1b, length, state, random_arithmetic_bits(datatype)); \
+        fill_random_buffer(datatype, buffer1full, length, state, 8 * sizeof(datatype)); \
+        for (uint32 i = 0; i < length; ++i) \
+        { \
+            buffer1b[i] = buffer1b[i] == (datatype)0 ? (datatype)1 : buffer1b[i]; \
+            buffer1dest[i] = buffer2dest[i] = (datatype)0; \
+        } \
+        \
+        for (uint32 n = 0; n < sizeof(sizes) / sizeof(sizes[0]); ++n) \
+        { \
+            for (uint32 run = 0; run < 4; ++run) \
+            { \
+                const uint32 size = sizes[n]; \
+                random_buffer_offsets(datatype, run, state, oa, ob, od) \
+                \
+                simd->add_buffers_##datatype (buffer1a.data() + oa, buffer1b.data() + ob, buffer1dest.data() + od, size); \
+                fpu->add_buffers_##datatype (buffer1a.data() + oa, buffer1b.data() + ob, buffer2dest.data() + od, size); \
+                TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), length); \
+                \
+                simd->subtract_buffers_##datatype (buffer1a.data() + oa, buffer1b.data() + ob, buffer1dest.data() + od, size); \
+                fpu->subtract_buffers_##datatype (buffer1a.data() + oa, buffer1b.data() + ob, buffer2dest.data() + od, size); \
+                TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), length); \
+                \
+                simd->multiply_buffers_##datatype (buffer1a.data() + oa, buffer1b.data() + ob, buffer1dest.data() + od, size); \
+                fpu->multiply_buffers_##datatype (buffer1a.data() + oa, buffer1b.data() + ob, buffer2dest.data() + od, size); \
+                TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), length); \
+                \
+                simd->divide_buffers_##datatype (buffer1a.data() + oa, buffer1b.data() + ob, buffer1dest.data() + od, size); \
+                fpu->divide_buffers_##datatype (buffer1a.data() + oa, buffer1b.data() + ob, buffer2dest.data() + od, size); \
+                TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), length); \
+                \
+                simd->copy_buffer_##datatype (buffer1a.data() + oa, buffer1dest.data() + od, size); \
+                fpu->copy_buffer_##datatype (buffer1a.data() + oa, buffer2dest.data() + od, size); \
+                TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), length); \
+                \
+                simd->scale_buffer_##datatype (buffer1dest.data() + od, size, 0.37f); \
+                fpu->scale_buffer_##datatype (buffer2dest.data() + od, size, 0.37f); \
+                TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), length); \
+                \
+                simd->copy_buffer_##datatype (buffer1b.data() + ob, buffer1dest.data() + od, size); \
+                fpu->copy_buffer_##datatype (buffer1b.data() + ob, buffer2dest.data() + od, size); \
+                TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), length); \
+                \
+                simd->scale_buffer_##datatype (buffer1dest.data() + od, size, 0.75); \
+                fpu->scale_buffer_##datatype (buffer2dest.data() + od, size, 0.75); \
+                TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), length); \
+                \
+                simd->copy_buffer_##datatype (buffer1full.data() + oa, buffer1dest.data() + od, size); \
+                fpu->copy_buffer_##datatype (buffer1full.data() + oa, buffer2dest.data() + od, size); \
+                simd->abs_buffer_##datatype (buffer1dest.data() + od, size); \
+                fpu->abs_buffer_##datatype (buffer2dest.data() + od, size); \
+                TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), length); \
+                \
+                simd->set_buffer_##datatype (buffer1dest.data() + od, size, buffer1full[n]); \
+                fpu->set_buffer_##datatype (buffer2dest.data() + od, size, buffer1full[n]); \
+                TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), length); \
+                \
+                simd->clear_buffer_##datatype (buffer1dest.data() + od + size / 2, size - size / 2); \
+                fpu->clear_buffer_##datatype (buffer2dest.data() + od + size / 2, size - size / 2); \
+                TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), length); \
+            } \
+        } \
+    }
+
+#define test_backend_impl(simd, simd_type) \
+    void test_##simd##_backend() \
+    { \
+        math simd(simd_type, false); \
+        \
+        std::string expected(#simd); \
+        std::transform(expected.begin(), expected.end(), expected.begin(), ::toupper); \
+        \
+        TEST_IS_EQUAL(std::string(simd.name()), expected); \
+        TEST_IS_EQUAL(std::string(simd.dispatch().name), expected); \
+    }
+
+#define test_dispatch_table_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_dispatch_table_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1a(s); \
+        datatype##_buffer buffer1b(s); \
+        datatype##_buffer buffer1dest(s); \
+        datatype##_buffer buffer2a(s); \
+        datatype##_buffer buffer2b(s); \
+        datatype##_buffer buffer2dest(s); \
+        \
+        simd.dispatch().set_buffer_ ##datatype (buffer1a.data(), s, (datatype)3); \
+        simd.dispatch().set_buffer_ ##datatype (buffer1b.data(), s, (datatype)2); \
+        simd.dispatch().multiply_buffers_ ##datatype (buffer1a.data(), buffer1b.data(), buffer1dest.data(), s); \
+        simd.dispatch().scale_buffer_ ##datatype (buffer1dest.data(), s, 0.5f); \
+        fpu->set_buffer_ ##datatype (buffer2a.data(), s, (datatype)3); \
+        fpu->set_buffer_ ##datatype (buffer2b.data(), s, (datatype)2); \
+        fpu->multiply_buffers_ ##datatype (buffer2a.data(), buffer2b.data(), buffer2dest.data(), s); \
+        fpu->scale_buffer_ ##datatype (buffer2dest.data(), s, 0.5f); \
+        \
+        TEST_IS_EQUAL(std::string(simd.dispatch().name), std::string(simd.name())); \
+        TEST_BUFFER_IS_VALUE(buffer1dest.data(), s, (datatype)3); \
+        TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), s); \
+    }
+
+
+// values all over the range of the datatype, extremes included
+#define fill_saturating_buffer(datatype, buffer, size, seed) \
+    for (uint32 i = 0; i < (uint32)size; ++i) \
+        buffer[i] = i % 13 == 0 ? std::numeric_limits<datatype>::max() : (i % 11 == 0 ? \
+            std::numeric_limits<datatype>::min() : (datatype)(i * 40503u + seed));
+
+#define saturate_reference(datatype, value) \
+    (datatype)((value) < (double)std::numeric_limits<datatype>::min() ? std::numeric_limits<datatype>::min() : \
+        ((value) > (double)std::numeric_limits<datatype>::max() ? std::numeric_limits<datatype>::max() : (value)))
+
+#define test_saturating_buffers_impl(simd, simd_type, function, datatype, s, expected) \
+    void test_##simd##_##function##_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1a(s); \
+        datatype##_buffer buffer1b(s); \
+        datatype##_buffer buffer1dest(s); \
+        datatype##_buffer buffer2dest(s); \
+        \
+        fill_saturating_buffer(datatype, buffer1a, s, 0x3579u); \
+        fill_saturating_buffer(datatype, buffer1b, s, 0x8ACEu); \
+        \
+        simd->function##_##datatype (buffer1a.data(), buffer1b.data(), buffer1dest.data(), s); \
+        fpu->function##_##datatype (buffer1a.data(), buffer1b.data(), buffer2dest.data(), s); \
+        \
+        TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), s); \
+        for (uint32 i = 0; i < (uint32)s; ++i) \
+        { \
+            const double a = (double)buffer1a[i]; \
+            const double b = (double)buffer1b[i]; \
+            TEST_IS_EQUAL(buffer1dest[i], saturate_reference(datatype, expected)); \
+        } \
+        \
+        simd->function##_##datatype (buffer1a.data() + 1, buffer1b.data() + 1, buffer1dest.data() + 1, s - 1); \
+        TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), s); \
+    }
+
+#define test_add_buffers_saturate_impl(simd, simd_type, datatype, s) \
+    test_saturating_buffers_impl(simd, simd_type, add_buffers_saturate, datatype, s, a + b)
+
+#define test_subtract_buffers_saturate_impl(simd, simd_type, datatype, s) \
+    test_saturating_buffers_impl(simd, simd_type, subtract_buffers_saturate, datatype, s, a - b)
+
+#define test_average_buffers_impl(simd, simd_type, datatype, s) \
+    test_saturating_buffers_impl(simd, simd_type, average_buffers, datatype, s, std::floor((a + b + 1) / 2))
+
+#define test_scale_buffer_saturate_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_scale_buffer_saturate_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        const float gains[] = { 0.5f, 1.7f, -1.3f, 3.0f, 0.0f }; \
+        \
+        datatype##_buffer buffer1a(s); \
+        datatype##_buffer buffer1dest(s); \
+        datatype##_buffer buffer2dest(s); \
+        \
+        fill_saturating_buffer(datatype, buffer1a, s, 0x2468u); \
+        \
+        for (uint32 g = 0; g < sizeof(gains) / sizeof(gains[0]); ++g) \
+        { \
+            simd->copy_buffer_##datatype (buffer1a.data(), buffer1dest.data(), s); \
+            fpu->copy_buffer_##datatype (buffer1a.data(), buffer2dest.data(), s); \
+            \
+            simd->scale_buffer_saturate_##datatype (buffer1dest.data() + g, s - g, gains[g]); \
+            fpu->scale_buffer_saturate_##datatype (buffer2dest.data() + g, s - g, gains[g]); \
+            \
+            TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), s); \
+            for (uint32 i = g; i < (uint32)s; ++i) \
+            { \
+                const double scaled = (double)((float)buffer1a[i] * gains[g]); \
+                TEST_IS_EQUAL(buffer1dest[i], saturate_reference(datatype, \
+                    scaled < 0 ? std::ceil(scaled) : std::floor(scaled))); \
+            } \
+        } \
+    }
+
+#define test_random_saturating_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_random_saturating_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        const uint32 sizes[] = random_buffer_sizes(s); \
+        const uint32 length = s + 64; \
+        uint64 state = 0x2545F4914F6CDD1Dull; \
+        \
+        datatype##_buffer buffer1a(length); \
+        datatype##_buffer buffer1b(length); \
+        datatype##_buffer buffer1dest(length); \
+        datatype##_buffer buffer2dest(length); \
+        \
+        fill_random_buffer(datatype, buffer1a, length, state, 8 * sizeof(datatype)); \
+        fill_random_buffer(datatype, buffer1b, length, state, 8 * sizeof(datatype)); \
+        fpu->clear_buffer_##datatype (buffer1dest.data(), length); \
+        fpu->clear_buffer_##datatype (buffer2dest.data(), length); \
+        \
+        for (uint32 n = 0; n < sizeof(sizes) / sizeof(sizes[0]); ++n) \
+        { \
+            for (uint32 run = 0; run < 4; ++run) \
+            { \
+                const uint32 size = sizes[n]; \
+                random_buffer_offsets(datatype, run, state, oa, ob, od) \
+                \
+                simd->add_buffers_saturate_##datatype (buffer1a.data() + oa, buffer1b.data() + ob, buffer1dest.data() + od, size); \
+                fpu->add_buffers_saturate_##datatype (buffer1a.data() + oa, buffer1b.data() + ob, buffer2dest.data() + od, size); \
+                TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), length); \
+                \
+                simd->subtract_buffers_saturate_##datatype (buffer1a.data() + oa, buffer1b.data() + ob, buffer1dest.data() + od, size); \
+                fpu->subtract_buffers_saturate_##datatype (buffer1a.data() + oa, buffer1b.data() + ob, buffer2dest.data() + od, size); \
+                TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), length); \
+                \
+                simd->average_buffers_##datatype (buffer1a.data() + oa, buffer1b.data() + ob, buffer1dest.data() + od, size); \
+                fpu->average_buffers_##datatype (buffer1a.data() + oa, buffer1b.data() + ob, buffer2dest.data() + od, size); \
+                TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), length); \
+                \
+                simd->scale_buffer_saturate_##datatype (buffer1dest.data() + od, size, run < 2 ? 1.7f : -1.3f); \
+                fpu->scale_buffer_saturate_##datatype (buffer2dest.data() + od, size, run < 2 ? 1.7f : -1.3f); \
+                TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), length); \
+            } \
+        } \
+    }
+
+
+#define test_multiply_add_buffers_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_multiply_add_buffers_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1a(s); \
+        datatype##_buffer buffer1b(s); \
+        datatype##_buffer buffer1c(s); \
+        datatype##_buffer buffer1dest(s); \
+        datatype##_buffer buffer2a(s); \
+        datatype##_buffer buffer2b(s); \
+        datatype##_buffer buffer2c(s); \
+        datatype##_buffer buffer2dest(s); \
+        \
+        simd->set_buffer_ ##datatype (buffer1a.data(), s, (datatype)3); \
+        simd->set_buffer_ ##datatype (buffer1b.data(), s, (datatype)2); \
+        simd->set_buffer_ ##datatype (buffer1c.data(), s, (datatype)1); \
+        simd->multiply_add_buffers_ ##datatype (buffer1a.data(), buffer1b.data(), buffer1c.data(), buffer1dest.data(), s); \
+        fpu->set_buffer_ ##datatype (buffer2a.data(), s, (datatype)3); \
+        fpu->set_buffer_ ##datatype (buffer2b.data(), s, (datatype)2); \
+        fpu->set_buffer_ ##datatype (buffer2c.data(), s, (datatype)1); \
+        fpu->multiply_add_buffers_ ##datatype (buffer2a.data(), buffer2b.data(), buffer2c.data(), buffer2dest.data(), s); \
+        \
+        TEST_BUFFER_IS_VALUE(buffer1dest.data(), s, (datatype)7); \
+        TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), s); \
+    }
+
+#define test_scale_add_buffer_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_scale_add_buffer_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1a(s); \
+        datatype##_buffer buffer1dest(s); \
+        datatype##_buffer buffer2a(s); \
+        datatype##_buffer buffer2dest(s); \
+        \
+        simd->set_buffer_ ##datatype (buffer1a.data(), s, (datatype)3); \
+        simd->set_buffer_ ##datatype (buffer1dest.data(), s, (datatype)1); \
+        simd->scale_add_buffer_ ##datatype (buffer1a.data(), buffer1dest.data(), s, (datatype)2); \
+        fpu->set_buffer_ ##datatype (buffer2a.data(), s, (datatype)3); \
+        fpu->set_buffer_ ##datatype (buffer2dest.data(), s, (datatype)1); \
+        fpu->scale_add_buffer_ ##datatype (buffer2a.data(), buffer2dest.data(), s, (datatype)2); \
+        \
+        TEST_BUFFER_IS_VALUE(buffer1dest.data(), s, (datatype)7); \
+        TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), s); \
+    }
+
+// fused multiply adds round once, so the backends differ in the last bit
+#define random_floating_tolerance(datatype) \
+    (sizeof(datatype) == sizeof(float) ? 3e-7 : 5e-16)
+
+#define test_random_floating_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_random_floating_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        const uint32 sizes[] = random_buffer_sizes(s); \
+        const uint32 length = s + 64; \
+        uint64 state = 0x9E3779B97F4A7C15ull; \
+        \
+        datatype##_buffer buffer1a(length); \
+        datatype##_buffer buffer1b(length); \
+        datatype##_buffer buffer1c(length); \
+        datatype##_buffer buffer1dest(length); \
+        datatype##_buffer buffer2dest(length); \
+        \
+        fill_random_buffer(datatype, buffer1a, length, state, 8 * sizeof(datatype)); \
+        fill_random_buffer(datatype, buffer1b, length, state, 8 * sizeof(datatype)); \
+        fill_random_buffer(datatype, buffer1c, length, state, 8 * sizeof(datatype)); \
+        \
+        for (uint32 n = 0; n < sizeof(sizes) / sizeof(sizes[0]); ++n) \
+        { \
+            for (uint32 run = 0; run < 4; ++run) \
+            { \
+                const uint32 size = sizes[n]; \
+                random_buffer_offsets(datatype, run, state, oa, ob, od) \
+                \
+                simd->multiply_add_buffers_##datatype (buffer1a.data() + oa, buffer1b.data() + ob, \
+                    buffer1c.data() + oa, buffer1dest.data() + od, size); \
+                fpu->multiply_add_buffers_##datatype (buffer1a.data() + oa, buffer1b.data() + ob, \
+                    buffer1c.data() + oa, buffer2dest.data() + od, size); \
+                for (uint32 i = 0; i < size; ++i) \
+                { \
+                    const double magnitude = std::fabs((double)buffer1a[oa + i] * buffer1b[ob + i]) + \
+                        std::fabs((double)buffer1c[oa + i]); \
+                    TEST_IS_MORE(random_floating_tolerance(datatype) * magnitude, \
+                        std::fabs((double)buffer1dest[od + i] - (double)buffer2dest[od + i])); \
+                } \
+                \
+                simd->copy_buffer_##datatype (buffer1c.data() + ob, buffer1dest.data() + od, size); \
+                fpu->copy_buffer_##datatype (buffer1c.data() + ob, buffer2dest.data() + od, size); \
+                simd->scale_add_buffer_##datatype (buffer1a.data() + oa, buffer1dest.data() + od, size, (datatype)-0.37); \
+                fpu->scale_add_buffer_##datatype (buffer1a.data() + oa, buffer2dest.data() + od, size, (datatype)-0.37); \
+                for (uint32 i = 0; i < size; ++i) \
+                { \
+                    const double magnitude = std::fabs((double)buffer1a[oa + i] * 0.37) + \
+                        std::fabs((double)buffer1c[ob + i]); \
+                    TEST_IS_MORE(random_floating_tolerance(datatype) * magnitude, \
+                        std::fabs((double)buffer1dest[od + i] - (double)buffer2dest[od + i])); \
+                } \
+            } \
+        } \
+    }
+
+#define test_ramp_scale_buffer_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_ramp_scale_buffer_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1a(s); \
+        datatype##_buffer buffer2a(s); \
+        \
+        simd->set_buffer_ ##datatype (buffer1a.data(), s, (datatype)1); \
+        simd->ramp_scale_buffer_ ##datatype (buffer1a.data(), s, (datatype)0, (datatype)1); \
+        fpu->set_buffer_ ##datatype (buffer2a.data(), s, (datatype)1); \
+        fpu->ramp_scale_buffer_ ##datatype (buffer2a.data(), s, (datatype)0, (datatype)1); \
+        \
+        TEST_IS_EQUAL(buffer1a[0], (datatype)0); \
+        TEST_IS_EQUAL(buffer1a[s / 2], (datatype)0.5); \
+        TEST_BUFFERS_ARE_EQUAL(buffer1a.data(), buffer2a.data(), s); \
+    }
+
+#define test_exp_ramp_scale_buffer_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_exp_ramp_scale_buffer_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1a(s); \
+        datatype##_buffer buffer2a(s); \
+        \
+        simd->set_buffer_ ##datatype (buffer1a.data(), s, (datatype)1); \
+        simd->exp_ramp_scale_buffer_ ##datatype (buffer1a.data(), s, (datatype)0.5, (datatype)2); \
+        fpu->set_buffer_ ##datatype (buffer2a.data(), s, (datatype)1); \
+        fpu->exp_ramp_scale_buffer_ ##datatype (buffer2a.data(), s, (datatype)0.5, (datatype)2); \
+        \
+        TEST_IS_EQUAL(buffer1a[0], (datatype)0.5); \
+        TEST_BUFFERS_ARE_NEAR(buffer1a.data(), buffer2a.data(), s, 1e-5); \
+    }
+
+#define test_pan_mono_to_stereo_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_pan_mono_to_stereo_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1a(s); \
+        datatype##_buffer buffer1left(s); \
+        datatype##_buffer buffer1right(s); \
+        datatype##_buffer buffer2left(s); \
+        datatype##_buffer buffer2right(s); \
+        \
+        simd->set_buffer_ ##datatype (buffer1a.data(), s, (datatype)2); \
+        simd->pan_mono_to_stereo_ ##datatype (buffer1a.data(), buffer1left.data(), buffer1right.data(), \
+            s, (datatype)0.5, LINEAR_PAN_LAW); \
+        \
+        TEST_BUFFER_IS_VALUE(buffer1left.data(), s, (datatype)0.5); \
+        TEST_BUFFER_IS_VALUE(buffer1right.data(), s, (datatype)1.5); \
+        \
+        simd->pan_mono_to_stereo_ ##datatype (buffer1a.data(), buffer1left.data(), buffer1right.data(), \
+            s, (datatype)0, CONSTANT_POWER_PAN_LAW); \
+        fpu->pan_mono_to_stereo_ ##datatype (buffer1a.data(), buffer2left.data(), buffer2right.data(), \
+            s, (datatype)0, CONSTANT_POWER_PAN_LAW); \
+        \
+        TEST_BUFFERS_ARE_EQUAL(buffer1left.data(), buffer1right.data(), s); \
+        TEST_BUFFERS_ARE_EQUAL(buffer1left.data(), buffer2left.data(), s); \
+        TEST_BUFFERS_ARE_EQUAL(buffer1right.data(), buffer2right.data(), s); \
+    }
+
+#define test_ramp_pan_mono_to_stereo_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_ramp_pan_mono_to_stereo_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1a(s); \
+        datatype##_buffer buffer1left(s); \
+        datatype##_buffer buffer1right(s); \
+        datatype##_buffer buffer2left(s); \
+        datatype##_buffer buffer2right(s); \
+        \
+        simd->set_buffer_ ##datatype (buffer1a.data(), s, (datatype)1); \
+        simd->ramp_pan_mono_to_stereo_ ##datatype (buffer1a.data(), buffer1left.data(), buffer1right.data(), \
+            s, (datatype)-1, (datatype)1, CONSTANT_POWER_PAN_LAW); \
+        fpu->ramp_pan_mono_to_stereo_ ##datatype (buffer1a.data(), buffer2left.data(), buffer2right.data(), \
+            s, (datatype)-1, (datatype)1, CONSTANT_POWER_PAN_LAW); \
+        \
+        TEST_IS_EQUAL(buffer1left[0], (datatype)1); \
+        TEST_IS_EQUAL(buffer1right[0], (datatype)0); \
+        TEST_IS_EQUAL(buffer1left[s / 2], (datatype)0.5); \
+        TEST_BUFFERS_ARE_EQUAL(buffer1left.data(), buffer2left.data(), s); \
+        TEST_BUFFERS_ARE_EQUAL(buffer1right.data(), buffer2right.data(), s); \
+    }
+
+#define test_balance_stereo_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_balance_stereo_##datatype() \
+    { \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1left(s); \
+        datatype##_buffer buffer1right(s); \
+        \
+        simd->set_buffer_ ##datatype (buffer1left.data(), s, (datatype)1); \
+        simd->set_buffer_ ##datatype (buffer1right.data(), s, (datatype)1); \
+        simd->balance_stereo_ ##datatype (buffer1left.data(), buffer1right.data(), s, (datatype)-0.5); \
+        \
+        TEST_BUFFER_IS_VALUE(buffer1left.data(), s, (datatype)1); \
+        TEST_BUFFER_IS_VALUE(buffer1right.data(), s, (datatype)0.5); \
+    }
+
+#define test_ramp_balance_stereo_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_ramp_balance_stereo_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1left(s); \
+        datatype##_buffer buffer1right(s); \
+        datatype##_buffer buffer2left(s); \
+        datatype##_buffer buffer2right(s); \
+        \
+        simd->set_buffer_ ##datatype (buffer1left.data(), s, (datatype)1); \
+        simd->set_buffer_ ##datatype (buffer1right.data(), s, (datatype)1); \
+        simd->ramp_balance_stereo_ ##datatype (buffer1left.data(), buffer1right.data(), \
+            s, (datatype)0, (datatype)1); \
+        fpu->set_buffer_ ##datatype (buffer2left.data(), s, (datatype)1); \
+        fpu->set_buffer_ ##datatype (buffer2right.data(), s, (datatype)1); \
+        fpu->ramp_balance_stereo_ ##datatype (buffer2left.data(), buffer2right.data(), \
+            s, (datatype)0, (datatype)1); \
+        \
+        TEST_IS_EQUAL(buffer1left[s / 2], (datatype)0.5); \
+        TEST_BUFFER_IS_VALUE(buffer1right.data(), s, (datatype)1); \
+        TEST_BUFFERS_ARE_EQUAL(buffer1left.data(), buffer2left.data(), s); \
+    }
+
+#define test_mix_dry_wet_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_mix_dry_wet_##datatype() \
+    { \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1a(s); \
+        datatype##_buffer buffer1b(s); \
+        datatype##_buffer buffer1dest(s); \
+        \
+        simd->set_buffer_ ##datatype (buffer1a.data(), s, (datatype)1); \
+        simd->set_buffer_ ##datatype (buffer1b.data(), s, (datatype)3); \
+        simd->mix_dry_wet_ ##datatype (buffer1a.data(), buffer1b.data(), buffer1dest.data(), \
+            s, (datatype)0.25); \
+        \
+        TEST_BUFFER_IS_VALUE(buffer1dest.data(), s, (datatype)1.5); \
+    }
+
+#define test_ramp_mix_dry_wet_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_ramp_mix_dry_wet_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1a(s); \
+        datatype##_buffer buffer1b(s); \
+        datatype##_buffer buffer1dest(s); \
+        datatype##_buffer buffer2dest(s); \
+        \
+        simd->set_buffer_ ##datatype (buffer1a.data(), s, (datatype)1); \
+        simd->set_buffer_ ##datatype (buffer1b.data(), s, (datatype)3); \
+        simd->ramp_mix_dry_wet_ ##datatype (buffer1a.data(), buffer1b.data(), buffer1dest.data(), \
+            s, (datatype)0, (datatype)1); \
+        fpu->ramp_mix_dry_wet_ ##datatype (buffer1a.data(), buffer1b.data(), buffer2dest.data(), \
+            s, (datatype)0, (datatype)1); \
+        \
+        TEST_IS_EQUAL(buffer1dest[0], (datatype)1); \
+        TEST_IS_EQUAL(buffer1dest[s / 2], (datatype)2); \
+        TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), s); \
+    }
+
+#define test_interleave_buffers_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_interleave_buffers_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        const uint32 channel_counts[] = { 2, 3, 4, 6, 8 }; \
+        const uint32 frames = s - 3; \
+        \
+        datatype##_buffer planes(s * 8); \
+        datatype##_buffer buffer1dest(s * 8); \
+        datatype##_buffer buffer2dest(s * 8); \
+        \
+        for (int i = 0; i < s * 8; ++i) \
+            planes[i] = (datatype)i; \
+        \
+        for (uint32 n = 0; n < 5; ++n) \
+        { \
+            const uint32 channels = channel_counts[n]; \
+            \
+            datatype* src_buffers[8]; \
+            for (uint32 c = 0; c < channels; ++c) \
+                src_buffers[c] = planes.data() + c * s; \
+            \
+            simd->interleave_buffers_ ##datatype (src_buffers, buffer1dest.data(), channels, frames); \
+            fpu->interleave_buffers_ ##datatype (src_buffers, buffer2dest.data(), channels, frames); \
+            \
+            TEST_IS_EQUAL(buffer1dest[channels + 1], planes[s + 1]); \
+            TEST_IS_EQUAL(buffer1dest[(frames - 1) * channels], planes[frames - 1]); \
+            TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), frames * channels); \
+        } \
+    }
+
+#define test_deinterleave_buffer_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_deinterleave_buffer_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        const uint32 channel_counts[] = { 2, 3, 4, 6, 8 }; \
+        const uint32 frames = s - 3; \
+        \
+        datatype##_buffer buffer1a(s * 8); \
+        datatype##_buffer planes1(s * 8); \
+        datatype##_buffer planes2(s * 8); \
+        \
+        for (int i = 0; i < s * 8; ++i) \
+            buffer1a[i] = (datatype)i; \
+        \
+        for (uint32 n = 0; n < 5; ++n) \
+        { \
+            const uint32 channels = channel_counts[n]; \
+            \
+            datatype* dst1_buffers[8]; \
+            datatype* dst2_buffers[8]; \
+            for (uint32 c = 0; c < channels; ++c) \
+            { \
+                dst1_buffers[c] = planes1.data() + c * s; \
+                dst2_buffers[c] = planes2.data() + c * s; \
+            } \
+            \
+            simd->deinterleave_buffer_ ##datatype (buffer1a.data(), dst1_buffers, channels, frames); \
+            fpu->deinterleave_buffer_ ##datatype (buffer1a.data(), dst2_buffers, channels, frames); \
+            \
+            TEST_IS_EQUAL(planes1[s + 1], buffer1a[channels + 1]); \
+            TEST_IS_EQUAL(planes1[frames - 1], buffer1a[(frames - 1) * channels]); \
+            for (uint32 c = 0; c < channels; ++c) \
+                TEST_BUFFERS_ARE_EQUAL(dst1_buffers[c], dst2_buffers[c], frames); \
+        } \
+    }
+
+#define test_convert_integer_impl(simd, simd_type, integer, datatype, bits, s) \
+    void test_##simd##_convert_##integer##_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1a(s); \
+        datatype##_buffer buffer1dest(s); \
+        uint8_buffer samples1(s * sizeof(integer)); \
+        uint8_buffer samples2(s * sizeof(integer)); \
+        integer* samples1_buffer = (integer*)samples1.data(); \
+        integer* samples2_buffer = (integer*)samples2.data(); \
+        \
+        for (int i = 0; i < s; ++i) \
+            buffer1a[i] = (datatype)(i % 2001 - 1000) / (datatype)1024; \
+        buffer1a[0] = (datatype)1; \
+        buffer1a[1] = (datatype)-1; \
+        buffer1a[2] = (datatype)2; \
+        \
+        simd->convert_buffer_ ##datatype ##_to_ ##integer (buffer1a.data(), samples1_buffer, s, NEAREST, nullptr); \
+        fpu->convert_buffer_ ##datatype ##_to_ ##integer (buffer1a.data(), samples2_buffer, s, NEAREST, nullptr); \
+        simd->convert_buffer_ ##integer ##_to_ ##datatype (samples1_buffer, buffer1dest.data(), s); \
+        \
+        TEST_IS_EQUAL(buffer1dest[0], (datatype)(1.0 - std::ldexp(1.0, 1 - bits))); \
+        TEST_IS_EQUAL(buffer1dest[1], (datatype)-1); \
+        TEST_IS_EQUAL(buffer1dest[2], buffer1dest[0]); \
+        TEST_BUFFERS_ARE_EQUAL(buffer1dest.data() + 3, buffer1a.data() + 3, s - 3); \
+        TEST_BUFFERS_ARE_EQUAL(samples1.data(), samples2.data(), s * sizeof(integer)); \
+        \
+        uint32 seed1 = 12345, seed2 = 12345; \
+        simd->convert_buffer_ ##datatype ##_to_ ##integer (buffer1a.data(), samples1_buffer, s, DOWNWARD, &seed1); \
+        fpu->convert_buffer_ ##datatype ##_to_ ##integer (buffer1a.data(), samples2_buffer, s, DOWNWARD, &seed2); \
+        \
+        TEST_IS_EQUAL(seed1, (uint32)(12345 + s)); \
+        TEST_IS_EQUAL(seed1, seed2); \
+        TEST_BUFFERS_ARE_EQUAL(samples1.data(), samples2.data(), s * sizeof(integer)); \
+    }
+
+#define test_process_biquad_bank_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_process_biquad_bank_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        const uint32 channels = 19; \
+        const uint32 sections = 3; \
+        const uint32 frames = s / channels; \
+        \
+        datatype##_biquad_bank bank1(channels, sections); \
+        datatype##_biquad_bank bank2(channels, sections); \
+        datatype##_buffer buffer1a(channels * frames); \
+        datatype##_buffer buffer1dest(channels * frames); \
+        datatype##_buffer buffer2dest(channels * frames); \
+        \
+        for (uint32 i = 0; i < channels * frames; ++i) \
+            buffer1a[i] = (datatype)((int)(i % 7) - 3) / (datatype)4; \
+        \
+        simd->process_biquad_bank_ ##datatype (buffer1a.data(), buffer1dest.data(), channels, frames, \
+            bank1.coefficients(), bank1.state(), sections); \
+        \
+        TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer1a.data(), channels * frames); \
+        \
+        for (uint32 c = 0; c < channels; ++c) \
+        { \
+            for (uint32 k = 0; k < sections; ++k) \
+            { \
+                const datatype b1 = (datatype)(c % 3) / (datatype)10; \
+                bank1.set_section(c, k, (datatype)0.25, b1, (datatype)0.125, (datatype)-0.5, (datatype)0.125); \
+                bank2.set_section(c, k, (datatype)0.25, b1, (datatype)0.125, (datatype)-0.5, (datatype)0.125); \
+            } \
+        } \
+        \
+        simd->process_biquad_bank_ ##datatype (buffer1a.data(), buffer1dest.data(), channels, frames, \
+            bank1.coefficients(), bank1.state(), sections); \
+        fpu->process_biquad_bank_ ##datatype (buffer1a.data(), buffer2dest.data(), channels, frames, \
+            bank2.coefficients(), bank2.state(), sections); \
+        \
+        TEST_BUFFERS_ARE_NEAR(buffer1dest.data(), buffer2dest.data(), channels * frames, 1e-4); \
+        TEST_BUFFERS_ARE_NEAR(bank1.state(), bank2.state(), channels * sections * 2, 1e-4); \
+        \
+        fpu->copy_buffer_ ##datatype (buffer1a.data(), buffer2dest.data(), channels * frames); \
+        simd->process_biquad_bank_ ##datatype (buffer1a.data(), buffer1a.data(), channels, frames, \
+            bank1.coefficients(), bank1.state(), sections); \
+        fpu->process_biquad_bank_ ##datatype (buffer2dest.data(), buffer2dest.data(), channels, frames, \
+            bank2.coefficients(), bank2.state(), sections); \
+        \
+        TEST_BUFFERS_ARE_NEAR(buffer1a.data(), buffer2dest.data(), channels * frames, 1e-4); \
+        \
+        simd->set_buffer_ ##datatype (buffer1a.data(), channels * frames, (datatype)1); \
+        bank1.reset(); \
+        simd->process_biquad_bank_ ##datatype (buffer1a.data(), buffer1dest.data(), channels, frames, \
+            bank1.coefficients(), bank1.state(), sections); \
+        \
+        const double gain = (0.25 + 0.125) / (1.0 - 0.5 + 0.125); \
+        datatype expected = (datatype)(gain * gain * gain); \
+        TEST_BUFFERS_ARE_NEAR(buffer1dest.data() + channels * (frames - 1), &expected, 1, 1e-5); \
+    }
+
+#define test_process_polyphase_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_process_polyphase_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        const uint32 taps_sizes[] = { 3, 13, 32 }; \
+        const uint32 phases = 5; \
+        const uint32 size = s / 8; \
+        \
+        datatype##_buffer buffer1a(s); \
+        datatype##_buffer buffer1dest(size); \
+        datatype##_buffer buffer2dest(size); \
+        datatype##_buffer buffer3dest(size); \
+        datatype##_buffer coefficients(phases * 32); \
+        uint32_buffer rows(size); \
+        uint32_buffer offsets(size); \
+        \
+        for (uint32 i = 0; i < (uint32)s; ++i) \
+            buffer1a[i] = (datatype)0.5 + (datatype)(i % 7) / (datatype)16; \
+        \
+        for (uint32 k = 0; k < phases * 32; ++k) \
+            coefficients[k] = (datatype)1 / (datatype)(1 + k % 11); \
+        \
+        for (uint32 n = 0; n < 3; ++n) \
+        { \
+            const uint32 taps = taps_sizes[n]; \
+            \
+            for (uint32 i = 0; i < size; ++i) \
+            { \
+                rows[i] = (i * 3) % phases; \
+                offsets[i] = (i * 7) % (s - taps); \
+                \
+                double sum = 0.0; \
+                for (uint32 k = 0; k < taps; ++k) \
+                    sum += (double)coefficients[rows[i] * taps + k] * (double)buffer1a[offsets[i] + k]; \
+                buffer3dest[i] = (datatype)sum; \
+            } \
+            \
+            simd->process_polyphase_ ##datatype (buffer1a.data(), buffer1dest.data(), size, \
+                coefficients.data(), taps, rows.data(), offsets.data()); \
+            fpu->process_polyphase_ ##datatype (buffer1a.data(), buffer2dest.data(), size, \
+                coefficients.data(), taps, rows.data(), offsets.data()); \
+            \
+            TEST_BUFFERS_ARE_NEAR(buffer1dest.data(), buffer3dest.data(), size, 1e-5); \
+            TEST_BUFFERS_ARE_NEAR(buffer1dest.data(), buffer2dest.data(), size, 1e-5); \
+        } \
+    }
+
+#define test_process_envelope_bank_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_process_envelope_bank_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        const uint32 channels = 19; \
+        const uint32 frames = s / channels; \
+        const EnvelopeModeTypes modes[] = { PEAK_ENVELOPE, RMS_ENVELOPE }; \
+        \
+        datatype##_buffer buffer1a(channels * frames); \
+        datatype##_buffer buffer1dest(channels * frames); \
+        datatype##_buffer buffer2dest(channels * frames); \
+        \
+        for (uint32 i = 0; i < channels * frames; ++i) \
+            buffer1a[i] = ((i & 1) ? (datatype)-0.5 : (datatype)0.5) + (datatype)(i % 7) / (datatype)16; \
+        \
+        for (uint32 n = 0; n < 2; ++n) \
+        { \
+            datatype##_envelope_bank bank1(channels); \
+            datatype##_envelope_bank bank2(channels); \
+            \
+            for (uint32 c = 0; c < channels; ++c) \
+            { \
+                bank1.set_times(c, 0.001 * (1 + c % 3), 0.05, 48000.0); \
+                bank2.set_times(c, 0.001 * (1 + c % 3), 0.05, 48000.0); \
+            } \
+            \
+            simd->process_envelope_bank_ ##datatype (buffer1a.data(), buffer1dest.data(), channels, frames, \
+                bank1.coefficients(), bank1.state(), modes[n]); \
+            fpu->process_envelope_bank_ ##datatype (buffer1a.data(), buffer2dest.data(), channels, frames, \
+                bank2.coefficients(), bank2.state(), modes[n]); \
+            \
+            TEST_BUFFERS_ARE_NEAR(buffer1dest.data(), buffer2dest.data(), channels * frames, 1e-4); \
+            TEST_BUFFERS_ARE_NEAR(bank1.state(), bank2.state(), channels, 1e-4); \
+        } \
+        \
+        datatype##_envelope_bank bank1(channels); \
+        const datatype attack = (datatype)0.125; \
+        for (uint32 c = 0; c < channels; ++c) \
+            bank1.set_channel(c, attack, (datatype)0.5); \
+        \
+        simd->set_buffer_ ##datatype (buffer1a.data(), channels * frames, (datatype)-2); \
+        simd->process_envelope_bank_ ##datatype (buffer1a.data(), buffer1a.data(), channels, 8, \
+            bank1.coefficients(), bank1.state(), PEAK_ENVELOPE); \
+        \
+        datatype expected = (datatype)(2.0 * (1.0 - std::pow(1.0 - attack, 8.0))); \
+        for (uint32 c = 0; c < channels; ++c) \
+            TEST_BUFFERS_ARE_NEAR(buffer1a.data() + channels * 7 + c, &expected, 1, 1e-5); \
+    }
+
+#define test_compressor_gain_buffer_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_compressor_gain_buffer_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        const datatype knees[] = { 0, 6 }; \
+        \
+        datatype##_buffer buffer1a(s); \
+        datatype##_buffer buffer1dest(s); \
+        datatype##_buffer buffer2dest(s); \
+        \
+        for (uint32 i = 0; i < (uint32)s; ++i) \
+            buffer1a[i] = (datatype)-60 + (datatype)(i % 241) / (datatype)4; \
+        \
+        for (uint32 n = 0; n < 2; ++n) \
+        { \
+            simd->compressor_gain_buffer_ ##datatype (buffer1a.data(), buffer1dest.data(), s, -20, 4, knees[n]); \
+            fpu->compressor_gain_buffer_ ##datatype (buffer1a.data(), buffer2dest.data(), s, -20, 4, knees[n]); \
+            \
+            for (uint32 i = 0; i < (uint32)s; ++i) \
+            { \
+                const double over = (double)buffer1a[i] + 20.0; \
+                double expected = 0.0; \
+                if (2.0 * over > knees[n]) \
+                    expected = -0.75 * over; \
+                else if (2.0 * over > -knees[n]) \
+                    expected = -0.75 * (over + knees[n] / 2.0) * (over + knees[n] / 2.0) / (2.0 * knees[n]); \
+                \
+                TEST_IS_EQUAL(std::fabs(buffer1dest[i] - expected) <= 1e-4, true); \
+                TEST_IS_EQUAL(std::fabs(buffer1dest[i] - buffer2dest[i]) <= 1e-4, true); \
+            } \
+        } \
+    }
+
+#define test_limiter_gain_buffer_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_limiter_gain_buffer_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1a(s); \
+        datatype##_buffer buffer1dest(s); \
+        datatype##_buffer buffer2dest(s); \
+        \
+        for (uint32 i = 0; i < (uint32)s; ++i) \
+            buffer1a[i] = (datatype)(i % 33) / (datatype)16; \
+        \
+        simd->limiter_gain_buffer_ ##datatype (buffer1a.data(), buffer1dest.data(), s, (datatype)0.75); \
+        fpu->limiter_gain_buffer_ ##datatype (buffer1a.data(), buffer2dest.data(), s, (datatype)0.75); \
+        \
+        TEST_BUFFERS_ARE_NEAR(buffer1dest.data(), buffer2dest.data(), s, 1e-6); \
+        \
+        for (uint32 i = 0; i < (uint32)s; ++i) \
+        { \
+            const datatype limited = buffer1a[i] * buffer1dest[i]; \
+            TEST_IS_EQUAL(buffer1dest[i] <= (datatype)1, true); \
+            TEST_IS_EQUAL(std::fabs(limited - (buffer1a[i] < (datatype)0.75 ? buffer1a[i] : (datatype)0.75)) <= 1e-6, true); \
+        } \
+        \
+        simd->limiter_gain_buffer_ ##datatype (buffer1a.data(), buffer1a.data(), s, (datatype)0.75); \
+        TEST_BUFFERS_ARE_EQUAL(buffer1a.data(), buffer1dest.data(), s); \
+    }
+
+#define test_soft_clip_buffer_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_soft_clip_buffer_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1a(s); \
+        datatype##_buffer buffer1dest(s); \
+        datatype##_buffer buffer2dest(s); \
+        \
+        for (uint32 i = 0; i < (uint32)s; ++i) \
+            buffer1a[i] = (datatype)((int)(i % 201) - 100) / (datatype)16 + (datatype)1 / (datatype)32; \
+        \
+        simd->soft_clip_buffer_ ##datatype (buffer1a.data(), buffer1dest.data(), s); \
+        fpu->soft_clip_buffer_ ##datatype (buffer1a.data(), buffer2dest.data(), s); \
+        \
+        TEST_BUFFERS_ARE_NEAR(buffer1dest.data(), buffer2dest.data(), s, 1e-6); \
+        \
+        for (uint32 i = 0; i < (uint32)s; ++i) \
+        { \
+            const double x = (double)buffer1a[i]; \
+            TEST_IS_EQUAL(std::fabs(buffer1dest[i]) <= 1.0, true); \
+            TEST_IS_EQUAL(std::fabs(buffer1dest[i] - std::tanh(x)) <= 0.03, true); \
+            if (std::fabs(x) >= 3.0) \
+                TEST_IS_EQUAL((double)buffer1dest[i], x > 0.0 ? 1.0 : -1.0); \
+        } \
+    }
+
+#define transcendental_tolerance(datatype, accuracy) \
+    (accuracy == ACCURATE_MATH_ACCURACY \
+        ? (sizeof(datatype) == sizeof(float) ? 1e-6 : 1e-14) \
+        : (sizeof(datatype) == sizeof(float) ? 5e-5 : 1e-10))
+
+#define test_exp_buffer_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_exp_buffer_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1a(s); \
+        datatype##_buffer buffer1dest(s); \
+        datatype##_buffer buffer2dest(s); \
+        \
+        for (uint32 i = 0; i < (uint32)s; ++i) \
+            buffer1a[i] = (datatype)((int)(i % 6401) - 3200) / (datatype)40 + (datatype)1 / (datatype)64; \
+        \
+        for (uint32 n = 0; n < 2; ++n) \
+        { \
+            const MathAccuracyTypes accuracy = (MathAccuracyTypes)n; \
+            const double tolerance = transcendental_tolerance(datatype, accuracy); \
+            \
+            simd->exp_buffer_ ##datatype (buffer1a.data(), buffer1dest.data(), s, accuracy); \
+            fpu->exp_buffer_ ##datatype (buffer1a.data(), buffer2dest.data(), s, accuracy); \
+            \
+            TEST_BUFFERS_ARE_NEAR(buffer1dest.data(), buffer2dest.data(), s, 2 * tolerance); \
+            \
+            for (uint32 i = 0; i < (uint32)s; ++i) \
+            { \
+                const double expected = std::exp((double)buffer1a[i]); \
+                TEST_IS_EQUAL(std::fabs(buffer1dest[i] - expected) <= tolerance * expected, true); \
+            } \
+        } \
+        \
+        datatype special[4] = { std::numeric_limits<datatype>::infinity(), -std::numeric_limits<datatype>::infinity(), \
+            std::numeric_limits<datatype>::quiet_NaN(), (datatype)0 }; \
+        simd->exp_buffer_ ##datatype (special, special, 4, ACCURATE_MATH_ACCURACY); \
+        TEST_IS_EQUAL(special[0] == std::numeric_limits<datatype>::infinity(), true); \
+        TEST_IS_EQUAL(special[1] == (datatype)0, true); \
+        TEST_IS_EQUAL(special[2] != special[2], true); \
+        TEST_IS_EQUAL(special[3] == (datatype)1, true); \
+        \
+        simd->exp_buffer_ ##datatype (buffer1a.data(), buffer1a.data(), s, ACCURATE_MATH_ACCURACY); \
+        TEST_BUFFERS_ARE_EQUAL(buffer1a.data(), buffer1dest.data(), s); \
+    }
+
+#define test_log_buffer_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_log_buffer_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1a(s); \
+        datatype##_buffer buffer1dest(s); \
+        datatype##_buffer buffer2dest(s); \
+        \
+        for (uint32 i = 0; i < (uint32)s; ++i) \
+            buffer1a[i] = (datatype)(i % 4096 + 1) / (datatype)64; \
+        \
+        for (uint32 n = 0; n < 2; ++n) \
+        { \
+            const MathAccuracyTypes accuracy = (MathAccuracyTypes)n; \
+            const double tolerance = transcendental_tolerance(datatype, accuracy); \
+            \
+            simd->log_buffer_ ##datatype (buffer1a.data(), buffer1dest.data(), s, accuracy); \
+            fpu->log_buffer_ ##datatype (buffer1a.data(), buffer2dest.data(), s, accuracy); \
+            \
+            TEST_BUFFERS_ARE_NEAR(buffer1dest.data(), buffer2dest.data(), s, 2 * tolerance); \
+            \
+            for (uint32 i = 0; i < (uint32)s; ++i) \
+            { \
+                const double expected = std::log((double)buffer1a[i]); \
+                TEST_IS_EQUAL(std::fabs(buffer1dest[i] - expected) <= tolerance * std::fabs(expected), true); \
+            } \
+        } \
+        \
+        datatype special[4] = { (datatype)0, (datatype)-1, std::numeric_limits<datatype>::infinity(), \
+            std::numeric_limits<datatype>::quiet_NaN() }; \
+        simd->log_buffer_ ##datatype (special, special, 4, ACCURATE_MATH_ACCURACY); \
+        TEST_IS_EQUAL(special[0] == -std::numeric_limits<datatype>::infinity(), true); \
+        TEST_IS_EQUAL(special[1] != special[1], true); \
+        TEST_IS_EQUAL(special[2] == std::numeric_limits<datatype>::infinity(), true); \
+        TEST_IS_EQUAL(special[3] != special[3], true); \
+    }
+
+#define test_sincos_buffer_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_sincos_buffer_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1a(s); \
+        datatype##_buffer buffer1sin(s); \
+        datatype##_buffer buffer1cos(s); \
+        datatype##_buffer buffer2sin(s); \
+        datatype##_buffer buffer2cos(s); \
+        \
+        for (uint32 i = 0; i < (uint32)s; ++i) \
+            buffer1a[i] = (datatype)((int)i - (int)s / 2) / (datatype)16 + (datatype)1 / (datatype)128; \
+        \
+        for (uint32 n = 0; n < 2; ++n) \
+        { \
+            const MathAccuracyTypes accuracy = (MathAccuracyTypes)n; \
+            const double tolerance = transcendental_tolerance(datatype, accuracy); \
+            \
+            simd->sincos_buffer_ ##datatype (buffer1a.data(), buffer1sin.data(), buffer1cos.data(), s, accuracy); \
+            fpu->sincos_buffer_ ##datatype (buffer1a.data(), buffer2sin.data(), buffer2cos.data(), s, accuracy); \
+            \
+            for (uint32 i = 0; i < (uint32)s; ++i) \
+            { \
+                const double x = (double)buffer1a[i]; \
+                TEST_IS_EQUAL(std::fabs(buffer1sin[i] - std::sin(x)) <= tolerance, true); \
+                TEST_IS_EQUAL(std::fabs(buffer1cos[i] - std::cos(x)) <= tolerance, true); \
+                TEST_IS_EQUAL(std::fabs(buffer1sin[i] - buffer2sin[i]) <= 2 * tolerance, true); \
+                TEST_IS_EQUAL(std::fabs(buffer1cos[i] - buffer2cos[i]) <= 2 * tolerance, true); \
+            } \
+            \
+            simd->sin_buffer_ ##datatype (buffer1a.data(), buffer2sin.data(), s, accuracy); \
+            simd->cos_buffer_ ##datatype (buffer1a.data(), buffer2cos.data(), s, accuracy); \
+            \
+            TEST_BUFFERS_ARE_EQUAL(buffer1sin.data(), buffer2sin.data(), s); \
+            TEST_BUFFERS_ARE_EQUAL(buffer1cos.data(), buffer2cos.data(), s); \
+        } \
+    }
+
+// the documented bounds in ulps of sin and cos, for floats and doubles
+#define sincos_ulp_bound(datatype, accuracy) \
+    (accuracy == ACCURATE_MATH_ACCURACY \
+        ? (sizeof(datatype) == sizeof(float) ? 2.0 : 3.0) \
+        : (sizeof(datatype) == sizeof(float) ? 26.0 : 40100.0))
+
+#define test_sincos_ulp_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_sincos_ulp_##datatype() \
+    { \
+        math simd(simd_type); \
+        \
+        const uint32 count = 4096; \
+        const uint32 size = count * 4; \
+        \
+        datatype##_buffer buffer1a(size); \
+        datatype##_buffer buffer1sin(size); \
+        datatype##_buffer buffer1cos(size); \
+        \
+        /* the closest values to multiples of pi / 2 up to 2^20, where the */ \
+        /* reduction decides the error, and random ones in between */ \
+        const datatype infinity = std::numeric_limits<datatype>::infinity(); \
+        uint32 seed = 1; \
+        for (uint32 k = 0; k < count; ++k) \
+        { \
+            const double multiple = k < count / 2 ? k + 1 : k * 163; \
+            const datatype x = (datatype)(multiple * 1.57079632679489661923); \
+            seed = seed * 1103515245 + 12345; \
+            const double random = ((double)(seed >> 8) / 8388608.0 - 1.0) * 1048576.0; \
+            buffer1a[k * 4 + 0] = (k & 1) ? x : -x; \
+            buffer1a[k * 4 + 1] = std::nextafter(x, infinity); \
+            buffer1a[k * 4 + 2] = std::nextafter(x, -infinity); \
+            buffer1a[k * 4 + 3] = (datatype)(k < count / 2 ? random / 1024.0 : random); \
+        } \
+        \
+        for (uint32 n = 0; n < 2; ++n) \
+        { \
+            const MathAccuracyTypes accuracy = (MathAccuracyTypes)n; \
+            const double bound = sincos_ulp_bound(datatype, accuracy); \
+            \
+            simd->sincos_buffer_ ##datatype (buffer1a.data(), buffer1sin.data(), buffer1cos.data(), size, accuracy); \
+            \
+            for (uint32 i = 0; i < size; ++i) \
+            { \
+                const long double x = (long double)buffer1a[i]; \
+                const long double expected[2] = { std::sin(x), std::cos(x) }; \
+                const datatype values[2] = { buffer1sin[i], buffer1cos[i] }; \
+                \
+                for (uint32 f = 0; f < 2; ++f) \
+                { \
+                    const datatype rounded = std::fabs((datatype)expected[f]); \
+                    const long double ulp = (long double)(std::nextafter(rounded, infinity) - rounded); \
+                    TEST_IS_EQUAL(std::fabs(values[f] - expected[f]) <= bound * ulp, true); \
+                } \
+            } \
+        } \
+    }
+
+#define test_tanh_buffer_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_tanh_buffer_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1a(s); \
+        datatype##_buffer buffer1dest(s); \
+        datatype##_buffer buffer2dest(s); \
+        \
+        for (uint32 i = 0; i < (uint32)s; ++i) \
+            buffer1a[i] = (datatype)((int)(i % 801) - 400) / (datatype)32 + (datatype)1 / (datatype)64; \
+        \
+        for (uint32 n = 0; n < 2; ++n) \
+        { \
+            const MathAccuracyTypes accuracy = (MathAccuracyTypes)n; \
+            const double tolerance = transcendental_tolerance(datatype, accuracy); \
+            \
+            simd->tanh_buffer_ ##datatype (buffer1a.data(), buffer1dest.data(), s, accuracy); \
+            fpu->tanh_buffer_ ##datatype (buffer1a.data(), buffer2dest.data(), s, accuracy); \
+            \
+            TEST_BUFFERS_ARE_NEAR(buffer1dest.data(), buffer2dest.data(), s, 2 * tolerance); \
+            \
+            for (uint32 i = 0; i < (uint32)s; ++i) \
+            { \
+                const double expected = std::tanh((double)buffer1a[i]); \
+                TEST_IS_EQUAL(std::fabs(buffer1dest[i]) <= 1.0, true); \
+                TEST_IS_EQUAL(std::fabs(buffer1dest[i] - expected) <= tolerance * std::fabs(expected), true); \
+            } \
+        } \
+    }
+
+#define test_pow_buffer_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_pow_buffer_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1a(s); \
+        datatype##_buffer buffer1b(s); \
+        datatype##_buffer buffer1dest(s); \
+        datatype##_buffer buffer2dest(s); \
+        \
+        for (uint32 i = 0; i < (uint32)s; ++i) \
+        { \
+            buffer1a[i] = (datatype)(i % 256 + 1) / (datatype)32; \
+            buffer1b[i] = (datatype)((int)(i % 97) - 48) / (datatype)16; \
+        } \
+        \
+        for (uint32 n = 0; n < 2; ++n) \
+        { \
+            const MathAccuracyTypes accuracy = (MathAccuracyTypes)n; \
+            const double tolerance = transcendental_tolerance(datatype, accuracy); \
+            \
+            simd->pow_buffer_ ##datatype (buffer1a.data(), buffer1b.data(), buffer1dest.data(), s, accuracy); \
+            fpu->pow_buffer_ ##datatype (buffer1a.data(), buffer1b.data(), buffer2dest.data(), s, accuracy); \
+            \
+            TEST_BUFFERS_ARE_NEAR(buffer1dest.data(), buffer2dest.data(), s, 2 * tolerance); \
+            \
+            for (uint32 i = 0; i < (uint32)s; ++i) \
+            { \
+                const double expected = std::pow((double)buffer1a[i], (double)buffer1b[i]); \
+                TEST_IS_EQUAL(std::fabs(buffer1dest[i] - expected) <= tolerance * expected, true); \
+            } \
+        } \
+    }
+
+// finite arguments from 2^30 on are reduced as zeros on every backend, up to
+// the largest float, instead of growing past [-1, 1] or turning into NaNs
+#define test_sincos_large_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_sincos_large_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        const double values[] = { 1073741824.0, 1.5e9, 5e15, 1.4e16, 1.8e16, 1e20, 1e30, 3e38 }; \
+        const uint32 count = sizeof(values) / sizeof(values[0]); \
+        const uint32 size = 37; \
+        \
+        datatype##_buffer buffer1a(size); \
+        datatype##_buffer buffer1sin(size); \
+        datatype##_buffer buffer1cos(size); \
+        datatype##_buffer buffer2sin(size); \
+        datatype##_buffer buffer2cos(size); \
+        \
+        for (uint32 i = 0; i < size; ++i) \
+            buffer1a[i] = (datatype)((i & 1) ? -values[i % count] : values[i % count]); \
+        \
+        for (uint32 n = 0; n < 2; ++n) \
+        { \
+            const MathAccuracyTypes accuracy = (MathAccuracyTypes)n; \
+            \
+            simd->sincos_buffer_ ##datatype (buffer1a.data(), buffer1sin.data(), buffer1cos.data(), size, accuracy); \
+            fpu->sincos_buffer_ ##datatype (buffer1a.data(), buffer2sin.data(), buffer2cos.data(), size, accuracy); \
+            \
+            TEST_BUFFERS_ARE_EQUAL(buffer1sin.data(), buffer2sin.data(), size); \
+            TEST_BUFFERS_ARE_EQUAL(buffer1cos.data(), buffer2cos.data(), size); \
+            \
+            for (uint32 i = 0; i < size; ++i) \
+            { \
+                TEST_IS_EQUAL(std::fabs(buffer1sin[i]) <= 1.0, true); \
+                TEST_IS_EQUAL(std::fabs(buffer1cos[i]) <= 1.0, true); \
+            } \
+            \
+            simd->sin_buffer_ ##datatype (buffer1a.data(), buffer1sin.data(), size, accuracy); \
+            simd->cos_buffer_ ##datatype (buffer1a.data(), buffer1cos.data(), size, accuracy); \
+            TEST_BUFFERS_ARE_EQUAL(buffer1sin.data(), buffer2sin.data(), size); \
+            TEST_BUFFERS_ARE_EQUAL(buffer1cos.data(), buffer2cos.data(), size); \
+        } \
+    }
+
+// denormal inputs give the results of signed zeros on every backend, in the
+// vector loops and in the leftovers
+#define test_transcendental_denormals_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_transcendental_denormals_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        const uint32 size = 37; \
+        const datatype denormal = std::numeric_limits<datatype>::denorm_min() * 1000; \
+        \
+        datatype##_buffer buffer1a(size); \
+        datatype##_buffer buffer1b(size); \
+        datatype##_buffer buffer2a(size); \
+        datatype##_buffer buffer2b(size); \
+        datatype##_buffer buffer1dest(size); \
+        datatype##_buffer buffer2dest(size); \
+        \
+        for (uint32 i = 0; i < size; ++i) \
+        { \
+            buffer1a[i] = (i & 1) ? -denormal : denormal; \
+            buffer2a[i] = (i & 1) ? -(datatype)0 : (datatype)0; \
+            buffer1b[i] = (datatype)2; \
+            buffer2b[i] = (datatype)2; \
+        } \
+        \
+        for (uint32 n = 0; n < 2; ++n) \
+        { \
+            const MathAccuracyTypes accuracy = (MathAccuracyTypes)n; \
+            math* backends[] = { &fpu, &simd }; \
+            \
+            for (uint32 b = 0; b < 2; ++b) \
+            { \
+                math& m = *backends[b]; \
+                \
+                m->exp_buffer_ ##datatype (buffer1a.data(), buffer1dest.data(), size, accuracy); \
+                m->exp_buffer_ ##datatype (buffer2a.data(), buffer2dest.data(), size, accuracy); \
+                TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), size); \
+                \
+                m->sin_buffer_ ##datatype (buffer1a.data(), buffer1dest.data(), size, accuracy); \
+                m->sin_buffer_ ##datatype (buffer2a.data(), buffer2dest.data(), size, accuracy); \
+                TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), size); \
+                \
+                m->cos_buffer_ ##datatype (buffer1a.data(), buffer1dest.data(), size, accuracy); \
+                m->cos_buffer_ ##datatype (buffer2a.data(), buffer2dest.data(), size, accuracy); \
+                TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), size); \
+                \
+                m->tanh_buffer_ ##datatype (buffer1a.data(), buffer1dest.data(), size, accuracy); \
+                TEST_BUFFER_IS_ZERO(buffer1dest.data(), size); \
+                \
+                m->log_buffer_ ##datatype (buffer1a.data(), buffer1dest.data(), size, accuracy); \
+                for (uint32 i = 0; i < size; i += 2) \
+                    TEST_IS_EQUAL(buffer1dest[i] == -std::numeric_limits<datatype>::infinity(), true); \
+                \
+                m->pow_buffer_ ##datatype (buffer1a.data(), buffer1b.data(), buffer1dest.data(), size, accuracy); \
+                for (uint32 i = 0; i < size; i += 2) \
+                    TEST_IS_EQUAL(buffer1dest[i] == (datatype)0, true); \
+                \
+                m->pow_buffer_ ##datatype (buffer1b.data(), buffer1a.data(), buffer1dest.data(), size, accuracy); \
+                TEST_BUFFER_IS_VALUE(buffer1dest.data(), size, (datatype)1); \
+            } \
+        } \
+    }
+
+// 8 bit pixels match the fpu to the bit, float ones up to the rounding of
+// the products
+#define pixel_tolerance(datatype) \
+    (sizeof(datatype) == 1 ? 0.0 : 1e-6)
+
+#define pixel_scale(datatype) \
+    (sizeof(datatype) == 1 ? 1.0 : 1.0 / 255.0)
+
+// premultiplied pixels with every alpha, transparent and opaque included
+#define fill_premultiplied_pixels(datatype, buffer, pixels, seed) \
+    for (uint32 i = 0; i < pixels; ++i) \
+    { \
+        const uint32 alpha = (i * 37 + seed) % 256; \
+        for (uint32 c = 0; c < 3; ++c) \
+            buffer[i * 4 + c] = (datatype)(((i * 53 + c * 29 + seed) % (alpha + 1)) * pixel_scale(datatype)); \
+        buffer[i * 4 + 3] = (datatype)(alpha * pixel_scale(datatype)); \
+    }
+
+#define test_pixels_are_near(a, b, size, tolerance) \
+    for (uint32 i = 0; i < size; ++i) \
+        TEST_IS_EQUAL(std::fabs((double)a[i] - (double)b[i]) <= tolerance, true);
+
+#define test_premultiply_rgba_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_premultiply_rgba_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        const uint32 pixels = s / 4 - 3; \
+        const double tolerance = pixel_tolerance(datatype); \
+        \
+        datatype##_buffer buffer1a(pixels * 4); \
+        datatype##_buffer buffer1dest(pixels * 4); \
+        datatype##_buffer buffer2dest(pixels * 4); \
+        \
+        for (uint32 i = 0; i < pixels * 4; ++i) \
+            buffer1a[i] = (datatype)(((i * 97 + i / 4) % 256) * pixel_scale(datatype)); \
+        \
+        simd->premultiply_rgba_ ##datatype (buffer1a.data(), buffer1dest.data(), pixels); \
+        fpu->premultiply_rgba_ ##datatype (buffer1a.data(), buffer2dest.data(), pixels); \
+        \
+        test_pixels_are_near(buffer1dest, buffer2dest, pixels * 4, tolerance); \
+        \
+        for (uint32 i = 0; i < pixels * 4; ++i) \
+        { \
+            const double alpha = (double)buffer1a[i | 3]; \
+            const double expected = (i & 3) == 3 ? alpha : (sizeof(datatype) == 1 \
+                ? std::floor((double)buffer1a[i] * alpha / 255.0 + 0.5) : (double)buffer1a[i] * alpha); \
+            TEST_IS_EQUAL(std::fabs((double)buffer1dest[i] - expected) <= tolerance, true); \
+        } \
+        \
+        simd->premultiply_rgba_ ##datatype (buffer1a.data(), buffer1a.data(), pixels); \
+        test_pixels_are_near(buffer1a, buffer2dest, pixels * 4, tolerance); \
+    }
+
+#define test_unpremultiply_rgba_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_unpremultiply_rgba_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        const uint32 pixels = s / 4 - 3; \
+        const double tolerance = pixel_tolerance(datatype); \
+        \
+        datatype##_buffer buffer1a(pixels * 4); \
+        datatype##_buffer buffer1dest(pixels * 4); \
+        datatype##_buffer buffer2dest(pixels * 4); \
+        \
+        fill_premultiplied_pixels(datatype, buffer1a, pixels, 11) \
+        \
+        simd->unpremultiply_rgba_ ##datatype (buffer1a.data(), buffer1dest.data(), pixels); \
+        fpu->unpremultiply_rgba_ ##datatype (buffer1a.data(), buffer2dest.data(), pixels); \
+        \
+        test_pixels_are_near(buffer1dest, buffer2dest, pixels * 4, tolerance); \
+        \
+        /* Premultiplying back gives the same pixels */ \
+        simd->premultiply_rgba_ ##datatype (buffer1dest.data(), buffer1dest.data(), pixels); \
+        test_pixels_are_near(buffer1dest, buffer1a, pixels * 4, tolerance); \
+    }
+
+#define test_composite_rgba_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_composite_rgba_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        const uint32 pixels = s / 4 - 3; \
+        const double tolerance = pixel_tolerance(datatype); \
+        \
+        datatype##_buffer buffer1a(pixels * 4); \
+        datatype##_buffer buffer1b(pixels * 4); \
+        datatype##_buffer buffer1dest(pixels * 4); \
+        datatype##_buffer buffer2dest(pixels * 4); \
+        \
+        fill_premultiplied_pixels(datatype, buffer1a, pixels, 11) \
+        fill_premultiplied_pixels(datatype, buffer1b, pixels, 130) \
+        \
+        for (uint32 n = CLEAR_COMPOSITE; n <= ADD_COMPOSITE; ++n) \
+        { \
+            const CompositeModeTypes mode = (CompositeModeTypes)n; \
+            \
+            simd->composite_rgba_ ##datatype (buffer1a.data(), buffer1b.data(), buffer1dest.data(), pixels, mode); \
+            fpu->composite_rgba_ ##datatype (buffer1a.data(), buffer1b.data(), buffer2dest.data(), pixels, mode); \
+            \
+            test_pixels_are_near(buffer1dest, buffer2dest, pixels * 4, tolerance); \
+        } \
+        \
+        /* Source over is the source plus what the source alpha lets through */ \
+        simd->composite_rgba_ ##datatype (buffer1a.data(), buffer1b.data(), buffer1dest.data(), pixels, SOURCE_OVER_COMPOSITE); \
+        for (uint32 i = 0; i < pixels * 4; ++i) \
+        { \
+            const double inverse = (sizeof(datatype) == 1 ? 255.0 : 1.0) - (double)buffer1a[i | 3]; \
+            const double expected = (double)buffer1a[i] + (sizeof(datatype) == 1 \
+                ? std::floor((double)buffer1b[i] * inverse / 255.0 + 0.5) : (double)buffer1b[i] * inverse); \
+            TEST_IS_EQUAL(std::fabs((double)buffer1dest[i] - expected) <= tolerance, true); \
+        } \
+        \
+        /* Compositing in place over the backdrop */ \
+        fpu->composite_rgba_ ##datatype (buffer1a.data(), buffer1b.data(), buffer2dest.data(), pixels, OVERLAY_COMPOSITE); \
+        simd->composite_rgba_ ##datatype (buffer1a.data(), buffer1b.data(), buffer1b.data(), pixels, OVERLAY_COMPOSITE); \
+        test_pixels_are_near(buffer1b, buffer2dest, pixels * 4, tolerance); \
+    }
+
+// pixels of every colour, the 2x2 blocks of the chroma far from uniform
+#define fill_color_pixels(datatype, buffer, pixels, seed) \
+    for (uint32 i = 0; i < pixels * 4; ++i) \
+        buffer[i] = (datatype)((i * 97 + (i / 4) * 13 + seed) % 256);
+
+#define test_rgba_to_gray_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_rgba_to_gray_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        const uint32 pixels = s / 4 - 3; \
+        \
+        datatype##_buffer buffer1a(pixels * 4); \
+        datatype##_buffer buffer1b(pixels); \
+        datatype##_buffer buffer2b(pixels); \
+        datatype##_buffer buffer1dest(pixels * 4); \
+        datatype##_buffer buffer2dest(pixels * 4); \
+        \
+        fill_color_pixels(datatype, buffer1a, pixels, 0) \
+        \
+        for (uint32 n = BT601_LIMITED_COLOR_SPACE; n <= BT709_FULL_COLOR_SPACE; ++n) \
+        { \
+            const ColorSpaceTypes space = (ColorSpaceTypes)n; \
+            const bool full = space == BT601_FULL_COLOR_SPACE || space == BT709_FULL_COLOR_SPACE; \
+            \
+            simd->rgba_to_gray_ ##datatype (buffer1a.data(), buffer1b.data(), pixels, space); \
+            fpu->rgba_to_gray_ ##datatype (buffer1a.data(), buffer2b.data(), pixels, space); \
+            test_pixels_are_near(buffer1b, buffer2b, pixels, 0); \
+            \
+            simd->gray_to_rgba_ ##datatype (buffer1b.data(), buffer1dest.data(), pixels, space); \
+            fpu->gray_to_rgba_ ##datatype (buffer1b.data(), buffer2dest.data(), pixels, space); \
+            test_pixels_are_near(buffer1dest, buffer2dest, pixels * 4, 0); \
+            \
+            /* Grays go back to the same grays, within a step of the limited range */ \
+            for (uint32 i = 0; i < pixels; ++i) \
+            { \
+                const uint32 gray = i % 256; \
+                buffer1a[i * 4 + 0] = buffer1a[i * 4 + 1] = buffer1a[i * 4 + 2] = (datatype)gray; \
+            } \
+            \
+            simd->rgba_to_gray_ ##datatype (buffer1a.data(), buffer1b.data(), pixels, space); \
+            simd->gray_to_rgba_ ##datatype (buffer1b.data(), buffer1dest.data(), pixels, space); \
+            for (uint32 i = 0; i < pixels; ++i) \
+            { \
+                TEST_IS_EQUAL(std::abs((int)buffer1dest[i * 4] - (int)(i % 256)) <= (full ? 0 : 1), true); \
+                TEST_IS_EQUAL((int)buffer1dest[i * 4 + 3], 255); \
+            } \
+            \
+            fill_color_pixels(datatype, buffer1a, pixels, 0) \
+        } \
+    }
+
+#define test_rgba_to_yuv_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_rgba_to_yuv_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        const uint32 widths[] = { 67, 128, 1, 2 }; \
+        const uint32 heights[] = { 37, 16, 3, 1 }; \
+        \
+        for (uint32 k = 0; k < sizeof(widths) / sizeof(widths[0]); ++k) \
+        { \
+            const uint32 width = widths[k], height = heights[k]; \
+            const uint32 chroma_width = (width + 1) / 2, chroma_height = (height + 1) / 2; \
+            \
+            /* Strides with some padding after every row */ \
+            const uint32 rgba_stride = width * 4 + 12; \
+            const uint32 y_stride = width + 5; \
+            const uint32 chroma_stride = chroma_width * 2 + 3; \
+            \
+            datatype##_buffer buffer1a(rgba_stride * height); \
+            datatype##_buffer buffer1y(y_stride * height), buffer2y(y_stride * height); \
+            datatype##_buffer buffer1u(chroma_stride * chroma_height), buffer2u(chroma_stride * chroma_height); \
+            datatype##_buffer buffer1v(chroma_stride * chroma_height), buffer2v(chroma_stride * chroma_height); \
+            datatype##_buffer buffer1dest(rgba_stride * height), buffer2dest(rgba_stride * height); \
+            \
+            fill_color_pixels(datatype, buffer1a, rgba_stride * height / 4, k) \
+            \
+            for (uint32 n = BT601_LIMITED_COLOR_SPACE; n <= BT709_FULL_COLOR_SPACE; ++n) \
+            { \
+                const ColorSpaceTypes space = (ColorSpaceTypes)n; \
+                \
+                for (uint32 i = 0; i < y_stride * height; ++i) buffer1y[i] = buffer2y[i] = 0; \
+                for (uint32 i = 0; i < chroma_stride * chroma_height; ++i) buffer1u[i] = buffer2u[i] = buffer1v[i] = buffer2v[i] = 0; \
+                for (uint32 i = 0; i < rgba_stride * height; ++i) buffer1dest[i] = buffer2dest[i] = 0; \
+                \
+                simd->rgba_to_i420_ ##datatype (buffer1a.data(), rgba_stride, buffer1y.data(), y_stride, \
+                    buffer1u.data(), chroma_stride, buffer1v.data(), chroma_stride, width, height, space); \
+                fpu->rgba_to_i420_ ##datatype (buffer1a.data(), rgba_stride, buffer2y.data(), y_stride, \
+                    buffer2u.data(), chroma_stride, buffer2v.data(), chroma_stride, width, height, space); \
+                test_pixels_are_near(buffer1y, buffer2y, y_stride * height, 0); \
+                test_pixels_are_near(buffer1u, buffer2u, chroma_stride * chroma_height, 0); \
+                test_pixels_are_near(buffer1v, buffer2v, chroma_stride * chroma_height, 0); \
+                \
+                simd->i420_to_rgba_ ##datatype (buffer1y.data(), y_stride, buffer1u.data(), chroma_stride, \
+                    buffer1v.data(), chroma_stride, buffer1dest.data(), rgba_stride, width, height, space); \
+                fpu->i420_to_rgba_ ##datatype (buffer1y.data(), y_stride, buffer1u.data(), chroma_stride, \
+                    buffer1v.data(), chroma_stride, buffer2dest.data(), rgba_stride, width, height, space); \
+                test_pixels_are_near(buffer1dest, buffer2dest, rgba_stride * height, 0); \
+                \
+                /* NV12 holds the same samples, U and V interleaved */ \
+                simd->rgba_to_nv12_ ##datatype (buffer1a.data(), rgba_stride, buffer2y.data(), y_stride, \
+                    buffer2u.data(), chroma_stride, width, height, space); \
+                test_pixels_are_near(buffer1y, buffer2y, y_stride * height, 0); \
+                for (uint32 row = 0; row < chroma_height; ++row) \
+                { \
+                    for (uint32 i = 0; i < chroma_width; ++i) \
+                    { \
+                        TEST_IS_EQUAL(buffer2u[row * chroma_stride + i * 2], buffer1u[row * chroma_stride + i]); \
+                        TEST_IS_EQUAL(buffer2u[row * chroma_stride + i * 2 + 1], buffer1v[row * chroma_stride + i]); \
+                    } \
+                } \
+                \
+                simd->nv12_to_rgba_ ##datatype (buffer2y.data(), y_stride, buffer2u.data(), chroma_stride, \
+                    buffer2dest.data(), rgba_stride, width, height, space); \
+                test_pixels_are_near(buffer1dest, buffer2dest, rgba_stride * height, 0); \
+            } \
+        } \
+        \
+        /* Pure red in all the colour spaces, then back */ \
+        const uint32 expected[][3] = { { 81, 90, 240 }, { 76, 85, 255 }, { 63, 102, 240 }, { 54, 99, 255 } }; \
+        \
+        datatype##_buffer buffer3a(32 * 2 * 4), buffer3y(32 * 2), buffer3u(16), buffer3v(16), buffer3dest(32 * 2 * 4); \
+        for (uint32 i = 0; i < 32 * 2; ++i) \
+        { \
+            buffer3a[i * 4 + 0] = 255; \
+            buffer3a[i * 4 + 1] = buffer3a[i * 4 + 2] = 0; \
+            buffer3a[i * 4 + 3] = 255; \
+        } \
+        \
+        for (uint32 n = BT601_LIMITED_COLOR_SPACE; n <= BT709_FULL_COLOR_SPACE; ++n) \
+        { \
+            const ColorSpaceTypes space = (ColorSpaceTypes)n; \
+            \
+            simd->rgba_to_i420_ ##datatype (buffer3a.data(), 32 * 4, buffer3y.data(), 32, \
+                buffer3u.data(), 16, buffer3v.data(), 16, 32, 2, space); \
+            simd->i420_to_rgba_ ##datatype (buffer3y.data(), 32, buffer3u.data(), 16, \
+                buffer3v.data(), 16, buffer3dest.data(), 32 * 4, 32, 2, space); \
+            \
+            for (uint32 i = 0; i < 16; ++i) \
+            { \
+                TEST_IS_EQUAL((uint32)buffer3y[i * 2], expected[n][0]); \
+                TEST_IS_EQUAL((uint32)buffer3u[i], expected[n][1]); \
+                TEST_IS_EQUAL((uint32)buffer3v[i], expected[n][2]); \
+            } \
+            \
+            for (uint32 i = 0; i < 32 * 2 * 4; ++i) \
+                TEST_IS_EQUAL(std::abs((int)buffer3dest[i] - (int)buffer3a[i]) <= 2, true); \
+        } \
+    }
+
+#define test_pack_rgba_planes_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_pack_rgba_planes_##datatype() \
+    { \
+        math simd(simd_type); \
+        \
+        const uint32 pixels = s / 4 - 3; \
+        \
+        datatype##_buffer buffer1a(pixels * 4); \
+        datatype##_buffer buffer1r(pixels), buffer1g(pixels), buffer1b(pixels), buffer1alpha(pixels); \
+        datatype##_buffer buffer1dest(pixels * 4); \
+        \
+        fill_color_pixels(datatype, buffer1a, pixels, 5) \
+        \
+        simd->unpack_rgba_planes_ ##datatype (buffer1a.data(), buffer1r.data(), buffer1g.data(), \
+            buffer1b.data(), buffer1alpha.data(), pixels); \
+        for (uint32 i = 0; i < pixels; ++i) \
+        { \
+            TEST_IS_EQUAL(buffer1r[i], buffer1a[i * 4 + 0]); \
+            TEST_IS_EQUAL(buffer1g[i], buffer1a[i * 4 + 1]); \
+            TEST_IS_EQUAL(buffer1b[i], buffer1a[i * 4 + 2]); \
+            TEST_IS_EQUAL(buffer1alpha[i], buffer1a[i * 4 + 3]); \
+        } \
+        \
+        simd->pack_rgba_planes_ ##datatype (buffer1r.data(), buffer1g.data(), buffer1b.data(), \
+            buffer1alpha.data(), buffer1dest.data(), pixels); \
+        test_pixels_are_near(buffer1dest, buffer1a, pixels * 4, 0); \
+        \
+        /* Without the alpha plane pixels are opaque */ \
+        simd->pack_rgba_planes_ ##datatype (buffer1r.data(), buffer1g.data(), buffer1b.data(), \
+            0, buffer1dest.data(), pixels); \
+        for (uint32 i = 0; i < pixels * 4; ++i) \
+            TEST_IS_EQUAL((int)buffer1dest[i], (i % 4) == 3 ? 255 : (int)buffer1a[i]); \
+        \
+        simd->clear_buffer_ ##datatype (buffer1alpha.data(), pixels); \
+        simd->unpack_rgba_planes_ ##datatype (buffer1dest.data(), buffer1r.data(), buffer1g.data(), \
+            buffer1b.data(), 0, pixels); \
+        for (uint32 i = 0; i < pixels; ++i) \
+        { \
+            TEST_IS_EQUAL(buffer1r[i], buffer1a[i * 4 + 0]); \
+            TEST_IS_EQUAL((int)buffer1alpha[i], 0); \
+        } \
+    }
+
+#define fill_image_plane(plane, seed) \
+    for (uint32 y = 0; y < plane.height(); ++y) \
+        for (uint32 x = 0; x < plane.width(); ++x) \
+            plane(x, y) = (float)((x * 37 + y * 101 + (x * y) % 17 + seed) % 256) / 255.0f;
+
+#define test_planes_are_near(a, b, tolerance) \
+    for (uint32 y = 0; y < a.height(); ++y) \
+        for (uint32 x = 0; x < a.width(); ++x) \
+            TEST_IS_EQUAL(std::fabs((double)a(x, y) - (double)b(x, y)) <= tolerance, true);
+
+#define test_convolve_image_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_convolve_image_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        /* Wider than a tile, narrower than the kernels, a single pixel */ \
+        const uint32 sizes[][2] = { { 300, 41 }, { 67, 3 }, { 5, 70 }, { 1, 1 } }; \
+        const uint32 kernel_sizes[] = { 1, 4, 9, 25 }; \
+        \
+        datatype##_buffer kernel(25); \
+        for (uint32 k = 0; k < 25; ++k) \
+            kernel[k] = (datatype)(1 + k % 5) / (datatype)(8 + k); \
+        \
+        for (uint32 n = 0; n < 4; ++n) \
+        { \
+            const uint32 width = sizes[n][0], height = sizes[n][1]; \
+            \
+            datatype##_plane plane1a(width, height, width + 5); \
+            datatype##_plane plane1dest(width, height); \
+            datatype##_plane plane2dest(width, height); \
+            \
+            fill_image_plane(plane1a, 3) \
+            \
+            for (uint32 m = 0; m < 4; ++m) \
+            { \
+                const uint32 kernel_size = kernel_sizes[m]; \
+                const int32 center = (int32)(kernel_size / 2); \
+                \
+                simd->convolve_rows_ ##datatype (plane1a.data(), plane1a.stride(), plane1dest.data(), plane1dest.stride(), \
+                    width, height, kernel.data(), kernel_size); \
+                fpu->convolve_rows_ ##datatype (plane1a.data(), plane1a.stride(), plane2dest.data(), plane2dest.stride(), \
+                    width, height, kernel.data(), kernel_size); \
+                test_planes_are_near(plane1dest, plane2dest, 1e-5); \
+                \
+                for (uint32 y = 0; y < height; ++y) \
+                    for (uint32 x = 0; x < width; ++x) \
+                    { \
+                        double sum = 0.0; \
+                        for (uint32 k = 0; k < kernel_size; ++k) \
+                        { \
+                            const int32 i = std::min(std::max((int32)(x + k) - center, 0), (int32)width - 1); \
+                            sum += (double)kernel[k] * (double)plane1a(i, y); \
+                        } \
+                        TEST_IS_EQUAL(std::fabs(plane1dest(x, y) - sum) <= 1e-5, true); \
+                    } \
+                \
+                simd->convolve_columns_ ##datatype (plane1a.data(), plane1a.stride(), plane1dest.data(), plane1dest.stride(), \
+                    width, height, kernel.data(), kernel_size); \
+                fpu->convolve_columns_ ##datatype (plane1a.data(), plane1a.stride(), plane2dest.data(), plane2dest.stride(), \
+                    width, height, kernel.data(), kernel_size); \
+                test_planes_are_near(plane1dest, plane2dest, 1e-5); \
+                \
+                for (uint32 y = 0; y < height; ++y) \
+                    for (uint32 x = 0; x < width; ++x) \
+                    { \
+                        double sum = 0.0; \
+                        for (uint32 k = 0; k < kernel_size; ++k) \
+                        { \
+                            const int32 j = std::min(std::max((int32)(y + k) - center, 0), (int32)height - 1); \
+                            sum += (double)kernel[k] * (double)plane1a(x, j); \
+                        } \
+                        TEST_IS_EQUAL(std::fabs(plane1dest(x, y) - sum) <= 1e-5, true); \
+                    } \
+            } \
+            \
+            /* The filter runs the rows pass then the columns one, in place too */ \
+            image_filter filter(simd); \
+            datatype##_plane plane1b(width, height); \
+            \
+            fpu->convolve_rows_ ##datatype (plane1a.data(), plane1a.stride(), plane1b.data(), plane1b.stride(), \
+                width, height, kernel.data(), 9); \
+            fpu->convolve_columns_ ##datatype (plane1b.data(), plane1b.stride(), plane2dest.data(), plane2dest.stride(), \
+                width, height, kernel.data() + 3, 5); \
+            \
+            filter.convolve(plane1a, plane1dest, kernel.data(), 9, kernel.data() + 3, 5); \
+            test_planes_are_near(plane1dest, plane2dest, 1e-5); \
+            \
+            filter.convolve(plane1a, plane1a, kernel.data(), 9, kernel.data() + 3, 5); \
+            test_planes_are_near(plane1a, plane2dest, 1e-5); \
+        } \
+    }
+
+#define test_box_blur_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_box_blur_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        const uint32 sizes[][2] = { { 300, 41 }, { 67, 3 }, { 5, 70 }, { 1, 1 } }; \
+        const uint32 radii[] = { 0, 1, 6, 40 }; \
+        \
+        for (uint32 n = 0; n < 4; ++n) \
+        { \
+            const uint32 width = sizes[n][0], height = sizes[n][1]; \
+            \
+            datatype##_plane plane1a(width, height, width + 5); \
+            datatype##_plane plane1dest(width, height); \
+            datatype##_plane plane2dest(width, height); \
+            \
+            fill_image_plane(plane1a, 11) \
+            \
+            for (uint32 m = 0; m < 4; ++m) \
+            { \
+                const int32 radius = (int32)radii[m]; \
+                \
+                simd->box_blur_rows_ ##datatype (plane1a.data(), plane1a.stride(), plane1dest.data(), plane1dest.stride(), \
+                    width, height, radius); \
+                fpu->box_blur_rows_ ##datatype (plane1a.data(), plane1a.stride(), plane2dest.data(), plane2dest.stride(), \
+                    width, height, radius); \
+                test_planes_are_near(plane1dest, plane2dest, 1e-5); \
+                \
+                for (uint32 y = 0; y < height; ++y) \
+                    for (uint32 x = 0; x < width; ++x) \
+                    { \
+                        double sum = 0.0; \
+                        for (int32 k = -radius; k <= radius; ++k) \
+                            sum += plane1a(std::min(std::max((int32)x + k, 0), (int32)width - 1), y); \
+                        TEST_IS_EQUAL(std::fabs(plane1dest(x, y) - sum / (2 * radius + 1)) <= 1e-5, true); \
+                    } \
+                \
+                simd->box_blur_columns_ ##datatype (plane1a.data(), plane1a.stride(), plane1dest.data(), plane1dest.stride(), \
+                    width, height, radius); \
+                fpu->box_blur_columns_ ##datatype (plane1a.data(), plane1a.stride(), plane2dest.data(), plane2dest.stride(), \
+                    width, height, radius); \
+                test_planes_are_near(plane1dest, plane2dest, 1e-5); \
+                \
+                for (uint32 y = 0; y < height; ++y) \
+                    for (uint32 x = 0; x < width; ++x) \
+                    { \
+                        double sum = 0.0; \
+                        for (int32 k = -radius; k <= radius; ++k) \
+                            sum += plane1a(x, std::min(std::max((int32)y + k, 0), (int32)height - 1)); \
+                        TEST_IS_EQUAL(std::fabs(plane1dest(x, y) - sum / (2 * radius + 1)) <= 1e-5, true); \
+                    } \
+            } \
+        } \
+        \
+        /* A constant plane stays constant */ \
+        datatype##_plane plane1b(517, 300); \
+        for (uint32 y = 0; y < plane1b.height(); ++y) \
+            simd->set_buffer_ ##datatype (plane1b.row(y), plane1b.width(), (datatype)0.75); \
+        \
+        image_filter filter(simd); \
+        filter.box_blur(plane1b, plane1b, 25, 3); \
+        for (uint32 y = 0; y < plane1b.height(); ++y) \
+            for (uint32 x = 0; x < plane1b.width(); ++x) \
+                TEST_IS_EQUAL(std::fabs(plane1b(x, y) - 0.75) <= 1e-5, true); \
+    }
+
+#define test_gaussian_blur_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_gaussian_blur_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        const double sigmas[] = { 0.0, 0.8, 2.5, 12.0 }; \
+        \
+        for (uint32 n = 0; n < 4; ++n) \
+        { \
+            const double sigma = sigmas[n]; \
+            \
+            /* The kernel is normalized, the boxes have about its variance */ \
+            datatype##_buffer kernel; \
+            image_filter::gaussian_kernel(sigma, kernel); \
+            TEST_IS_EQUAL(kernel.size(), 2 * (uint32)std::ceil(3.0 * sigma) + 1); \
+            TEST_IS_EQUAL(std::fabs(simd->sum_buffer_ ##datatype (kernel.data(), kernel.size()) - 1.0) < 1e-5, true); \
+            \
+            double kernel_variance = 0.0; \
+            for (uint32 k = 0; k < kernel.size(); ++k) \
+                kernel_variance += kernel[k] * ((double)k - kernel.size() / 2) * ((double)k - kernel.size() / 2); \
+            TEST_IS_EQUAL(std::fabs(kernel_variance - sigma * sigma) <= 0.03 * sigma * sigma, true); \
+            \
+            uint32 radii[image_filter::box_gaussian_passes]; \
+            image_filter::gaussian_box_radii(sigma, radii); \
+            double box_variance = 0.0; \
+            for (uint32 pass = 0; pass < (uint32)image_filter::box_gaussian_passes; ++pass) \
+                box_variance += radii[pass] * (radii[pass] + 1) / 3.0; \
+            TEST_IS_EQUAL(std::fabs(box_variance - sigma * sigma) <= 2.0 * sigma + 0.5, true); \
+            \
+            /* An impulse far from the edges keeps its energy and its center */ \
+            for (uint32 type = KERNEL_GAUSSIAN_BLUR; type <= BOX_GAUSSIAN_BLUR; ++type) \
+            { \
+                datatype##_plane plane1a(301, 203); \
+                datatype##_plane plane1dest(301, 203); \
+                datatype##_plane plane2dest(301, 203); \
+                \
+                for (uint32 y = 0; y < plane1a.height(); ++y) \
+                    simd->clear_buffer_ ##datatype (plane1a.row(y), plane1a.width()); \
+                plane1a(150, 101) = (datatype)1; \
+                \
+                image_filter filter1(simd); \
+                image_filter filter2(fpu); \
+                filter1.gaussian_blur(plane1a, plane1dest, sigma, (GaussianBlurTypes)type); \
+                filter2.gaussian_blur(plane1a, plane2dest, sigma, (GaussianBlurTypes)type); \
+                test_planes_are_near(plane1dest, plane2dest, 1e-6); \
+                \
+                double sum = 0.0, x_moment = 0.0, y_moment = 0.0, x_variance = 0.0; \
+                for (uint32 y = 0; y < plane1dest.height(); ++y) \
+                    for (uint32 x = 0; x < plane1dest.width(); ++x) \
+                    { \
+                        sum += plane1dest(x, y); \
+                        x_moment += plane1dest(x, y) * x; \
+                        y_moment += plane1dest(x, y) * y; \
+                        x_variance += plane1dest(x, y) * (x - 150.0) * (x - 150.0); \
+                    } \
+                \
+                TEST_IS_EQUAL(std::fabs(sum - 1.0) < 1e-4, true); \
+                TEST_IS_EQUAL(std::fabs(x_moment - 150.0) < 1e-2, true); \
+                TEST_IS_EQUAL(std::fabs(y_moment - 101.0) < 1e-2, true); \
+                const double expected_variance = type == BOX_GAUSSIAN_BLUR ? box_variance : kernel_variance; \
+                TEST_IS_EQUAL(std::fabs(x_variance - expected_variance) < 1e-2 * (expected_variance + 1.0), true); \
+                \
+                /* In place gives the same */ \
+                filter1.gaussian_blur(plane1a, plane1a, sigma, (GaussianBlurTypes)type); \
+                test_planes_are_near(plane1a, plane1dest, 0); \
+            } \
+        } \
+    }
+
+#define test_resize_image_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_resize_image_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        /* Downscales down to 1/64, upscales up to 8x, odd ratios, single pixels */ \
+        const uint32 sizes[][4] = { { 320, 9, 5, 3 }, { 7, 41, 56, 13 }, { 300, 200, 97, 151 }, \
+            { 33, 17, 33, 17 }, { 1, 1, 8, 3 }, { 64, 1, 1, 1 } }; \
+        const uint32 channels[] = { 1, 4, 3 }; \
+        const double tolerance = sizeof(datatype) == 1 ? 1.0 : 1e-3; \
+        \
+        for (uint32 n = 0; n < 6; ++n) \
+        { \
+            const uint32 src_width = sizes[n][0], src_height = sizes[n][1]; \
+            const uint32 dst_width = sizes[n][2], dst_height = sizes[n][3]; \
+            \
+            for (uint32 c = 0; c < 3; ++c) \
+            { \
+                const uint32 ch = channels[c]; \
+                \
+                datatype##_plane plane1a(src_width * ch, src_height, src_width * ch + 3); \
+                datatype##_plane plane1b(src_width * ch, src_height); \
+                datatype##_plane plane1dest(dst_width * ch, dst_height); \
+                datatype##_plane plane2dest(dst_width * ch, dst_height); \
+                \
+                for (uint32 y = 0; y < src_height; ++y) \
+                    for (uint32 x = 0; x < src_width * ch; ++x) \
+                    { \
+                        plane1a(x, y) = (datatype)((x * 37 + y * 101 + (x * y) % 17) % 256); \
+                        plane1b(x, y) = (datatype)200; \
+                    } \
+                \
+                for (uint32 f = BILINEAR_RESIZE_FILTER; f <= LANCZOS3_RESIZE_FILTER; ++f) \
+                { \
+                    image_resizer resizer1(simd, src_width, src_height, dst_width, dst_height, (ResizeFilterTypes)f, ch); \
+                    image_resizer resizer2(fpu, src_width, src_height, dst_width, dst_height, (ResizeFilterTypes)f, ch); \
+                    \
+                    /* Every backend gives the same, up to rounding */ \
+                    resizer1.process(plane1a, plane1dest); \
+                    resizer2.process(plane1a, plane2dest); \
+                    test_planes_are_near(plane1dest, plane2dest, tolerance); \
+                    \
+                    /* The weights are normalized, a constant plane stays constant */ \
+                    resizer1.process(plane1b, plane1dest); \
+                    for (uint32 y = 0; y < dst_height; ++y) \
+                        for (uint32 x = 0; x < dst_width * ch; ++x) \
+                            TEST_IS_EQUAL(std::fabs(plane1dest(x, y) - 200.0) <= 1e-3, true); \
+                    \
+                    /* At the same size every filter is the identity */ \
+                    if (src_width == dst_width && src_height == dst_height) \
+                    { \
+                        resizer1.process(plane1a, plane1dest); \
+                        test_planes_are_near(plane1dest, plane1a, 1e-3); \
+                    } \
+                } \
+            } \
+        } \
+        \
+        /* Bilinear and bicubic keep a ramp away from the edges, nearly when downscaling */ \
+        for (uint32 f = BILINEAR_RESIZE_FILTER; f <= BICUBIC_RESIZE_FILTER; ++f) \
+        { \
+            const uint32 widths[][2] = { { 120, 48 }, { 30, 107 } }; \
+            \
+            for (uint32 n = 0; n < 2; ++n) \
+            { \
+                const uint32 src_width = widths[n][0], dst_width = widths[n][1]; \
+                \
+                datatype##_plane plane1a(src_width, 4); \
+                datatype##_plane plane1dest(dst_width, 4); \
+                for (uint32 y = 0; y < 4; ++y) \
+                    for (uint32 x = 0; x < src_width; ++x) \
+                        plane1a(x, y) = (datatype)(2 * x); \
+                \
+                image_resizer resizer(simd, src_width, 4, dst_width, 4, (ResizeFilterTypes)f); \
+                resizer.process(plane1a, plane1dest); \
+                \
+                const double scale = (double)dst_width / src_width; \
+                const double reach = image_resizer::filter_support((ResizeFilterTypes)f) * std::max(1.0, 1.0 / scale); \
+                for (uint32 x = 0; x < dst_width; ++x) \
+                { \
+                    const double center = (x + 0.5) / scale; \
+                    if (center - reach < 0.0 || center + reach > src_width) \
+                        continue; \
+                    \
+                    for (uint32 y = 0; y < 4; ++y) \
+                        TEST_IS_EQUAL(std::fabs(plane1dest(x, y) - 2.0 * (center - 0.5)) <= tolerance + 0.05, true); \
+                } \
+            } \
+        } \
+        \
+        /* The taps cover the stretched support, up to the whole source */ \
+        image_resizer resizer1(simd, 640, 64, 10, 512, LANCZOS3_RESIZE_FILTER, 4); \
+        TEST_IS_EQUAL(resizer1.horizontal_taps(), (uint32)(2 * 3 * 64 + 1)); \
+        TEST_IS_EQUAL(resizer1.vertical_taps(), (uint32)(2 * 3 + 1)); \
+        TEST_IS_EQUAL(resizer1.channels(), (uint32)4); \
+        \
+        image_resizer resizer2(simd, 100, 3, 2, 1, BICUBIC_RESIZE_FILTER); \
+        TEST_IS_EQUAL(resizer2.horizontal_taps(), (uint32)100); \
+        TEST_IS_EQUAL(resizer2.vertical_taps(), (uint32)3); \
+    }
+
+#define test_fft_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_fft_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        const double pi = 3.14159265358979323846; \
+        const double tolerance = sizeof(datatype) == sizeof(float) ? 1e-5 : 1e-12; \
+        const uint32 sizes[] = { 2, 4, 8, 32, 512, (uint32)s }; \
+        \
+        for (uint32 n = 0; n < sizeof(sizes) / sizeof(sizes[0]); ++n) \
+        { \
+            const uint32 size = sizes[n]; \
+            datatype##_fft transform1(simd, size); \
+            datatype##_fft transform2(fpu, size); \
+            \
+            datatype##_buffer buffer1a(size); \
+            datatype##_buffer buffer1b(size); \
+            datatype##_buffer buffer1c(size); \
+            datatype##_buffer buffer1d(size); \
+            datatype##_buffer buffer2c(size); \
+            datatype##_buffer buffer2d(size); \
+            \
+            for (uint32 i = 0; i < size; ++i) \
+            { \
+                buffer1a[i] = (datatype)((int)((i * 7) % 13) * 2 - 13) / (datatype)16; \
+                buffer1b[i] = (datatype)((int)((i * 5) % 11) * 2 - 11) / (datatype)16; \
+            } \
+            \
+            transform1.forward(buffer1a.data(), buffer1b.data(), buffer1c.data(), buffer1d.data()); \
+            transform2.forward(buffer1a.data(), buffer1b.data(), buffer2c.data(), buffer2d.data()); \
+            \
+            double error = 0.0, peak = 0.0; \
+            for (uint32 k = 0; k < size; ++k) \
+            { \
+                double real = 0.0, imag = 0.0; \
+                if (size <= 512) \
+                { \
+                    for (uint32 i = 0; i < size; ++i) \
+                    { \
+                        const double angle = -2.0 * pi * (double)((uint64)i * k % size) / size; \
+                        real += buffer1a[i] * std::cos(angle) - buffer1b[i] * std::sin(angle); \
+                        imag += buffer1a[i] * std::sin(angle) + buffer1b[i] * std::cos(angle); \
+                    } \
+                } \
+                else \
+                { \
+                    real = buffer2c[k]; \
+                    imag = buffer2d[k]; \
+                } \
+                error = std::max(error, std::fabs(buffer1c[k] - real) + std::fabs(buffer1d[k] - imag)); \
+                peak = std::max(peak, std::fabs(real) + std::fabs(imag)); \
+            } \
+            \
+            TEST_IS_EQUAL(error <= tolerance * peak, true); \
+            \
+            transform1.inverse(buffer1c.data(), buffer1d.data(), buffer2c.data(), buffer2d.data()); \
+            \
+            TEST_BUFFERS_ARE_NEAR(buffer2c.data(), buffer1a.data(), size, tolerance * 16); \
+            TEST_BUFFERS_ARE_NEAR(buffer2d.data(), buffer1b.data(), size, tolerance * 16); \
+            \
+            simd->copy_buffer_ ##datatype (buffer1a.data(), buffer2c.data(), size); \
+            simd->copy_buffer_ ##datatype (buffer1b.data(), buffer2d.data(), size); \
+            transform1.forward(buffer2c.data(), buffer2d.data(), buffer2c.data(), buffer2d.data()); \
+            \
+            TEST_BUFFERS_ARE_EQUAL(buffer2c.data(), buffer1c.data(), size); \
+            TEST_BUFFERS_ARE_EQUAL(buffer2d.data(), buffer1d.data(), size); \
+            \
+            simd->clear_buffer_ ##datatype (buffer1b.data(), size); \
+            transform1.forward(buffer1a.data(), buffer1b.data(), buffer1c.data(), buffer1d.data()); \
+            simd->copy_buffer_ ##datatype (buffer1a.data(), buffer2c.data(), size); \
+            transform1.forward_real(buffer2c.data(), buffer2c.data(), buffer2d.data()); \
+            \
+            error = 0.0; \
+            peak = 0.0; \
+            for (uint32 k = 0; k < transform1.bins(); ++k) \
+            { \
+                error = std::max(error, std::fabs((double)buffer2c[k] - buffer1c[k]) + std::fabs((double)buffer2d[k] - buffer1d[k])); \
+                peak = std::max(peak, std::fabs((double)buffer1c[k]) + std::fabs((double)buffer1d[k])); \
+            } \
+            \
+            TEST_IS_EQUAL(error <= tolerance * peak, true); \
+            \
+            transform1.inverse_real(buffer2c.data(), buffer2d.data(), buffer2c.data()); \
+            \
+            TEST_BUFFERS_ARE_NEAR(buffer2c.data(), buffer1a.data(), size, tolerance * 16); \
+        } \
+    }
+
+#define test_fir_convolver_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_fir_convolver_##datatype() \
+    { \
+        math simd(simd_type); \
+        \
+        const uint32 block_sizes[] = { 64, 48 }; \
+        const uint32 kernel_sizes[] = { 31, 1000 }; \
+        \
+        datatype##_buffer buffer1a(s); \
+        datatype##_buffer buffer1dest(s); \
+        datatype##_buffer buffer2dest(s); \
+        datatype##_buffer kernel(kernel_sizes[1]); \
+        \
+        for (uint32 i = 0; i < (uint32)s; ++i) \
+            buffer1a[i] = (datatype)0.5 + (datatype)(i % 7) / (datatype)16; \
+        \
+        for (uint32 k = 0; k < kernel_sizes[1]; ++k) \
+            kernel[k] = (datatype)1 / (datatype)(1 + k % 13) / (datatype)(1 + k / 64); \
+        \
+        for (uint32 b = 0; b < 2; ++b) \
+        { \
+            const uint32 block_size = block_sizes[b]; \
+            const uint32 size = s - s % block_size; \
+            \
+            for (uint32 n = 0; n < 2; ++n) \
+            { \
+                const uint32 kernel_size = kernel_sizes[n]; \
+                fir_convolver convolver(simd, kernel.data(), kernel_size, block_size); \
+                \
+                TEST_IS_EQUAL(convolver.is_partitioned(), kernel_size >= (uint32)fir_convolver::direct_max_taps); \
+                \
+                for (uint32 i = 0; i < size; ++i) \
+                { \
+                    double sum = 0.0; \
+                    for (uint32 k = 0; k < kernel_size && k <= i; ++k) \
+                        sum += (double)kernel[k] * (double)buffer1a[i - k]; \
+                    buffer2dest[i] = (datatype)sum; \
+                } \
+                \
+                convolver.process(buffer1a.data(), buffer1dest.data(), size); \
+                \
+                TEST_BUFFERS_ARE_NEAR(buffer1dest.data(), buffer2dest.data(), size, 1e-4); \
+                \
+                convolver.reset(); \
+                simd->copy_buffer_ ##datatype (buffer1a.data(), buffer1dest.data(), size); \
+                convolver.process(buffer1dest.data(), buffer1dest.data(), block_size); \
+                convolver.process(buffer1dest.data() + block_size, buffer1dest.data() + block_size, size - block_size); \
+                \
+                TEST_BUFFERS_ARE_NEAR(buffer1dest.data(), buffer2dest.data(), size, 1e-4); \
+            } \
+        } \
+    }
+
+#define test_resampler_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_resampler_##datatype() \
+    { \
+        math simd(simd_type); \
+        \
+        const double rates[][2] = { { 44100, 48000 }, { 48000, 44100 }, { 48000, 33941.125 }, { 44100, 47999.7 } }; \
+        const uint32 block_size = 100; \
+        const uint32 size = s - s % block_size; \
+        \
+        datatype##_buffer buffer1a(size); \
+        \
+        simd->set_buffer_ ##datatype (buffer1a.data(), size, (datatype)1); \
+        \
+        for (uint32 n = 0; n < 4; ++n) \
+        { \
+            resampler resampler1(simd, rates[n][0], rates[n][1]); \
+            resampler resampler2(simd, rates[n][0], rates[n][1]); \
+            resampler resampler3(simd, rates[n][0], rates[n][1]); \
+            \
+            TEST_IS_EQUAL(resampler1.is_rational(), n < 2); \
+            \
+            datatype##_buffer buffer1dest(resampler1.max_output_size(size)); \
+            datatype##_buffer buffer2dest(resampler1.max_output_size(size)); \
+            \
+            uint32 count1 = 0; \
+            for (uint32 i = 0; i < size; i += block_size) \
+                count1 += resampler1.process(buffer1a.data() + i, buffer1dest.data() + count1, block_size); \
+            \
+            const uint32 count2 = resampler2.process(buffer1a.data(), buffer2dest.data(), size); \
+            \
+            const double expected = size * resampler1.ratio(); \
+            TEST_IS_EQUAL(count1, count2); \
+            TEST_IS_EQUAL(count1 + 1 >= expected && count1 <= expected + 1, true); \
+            TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), count1); \
+            \
+            const uint32 settled = (uint32)(resampler1.latency() * 2.0); \
+            for (uint32 i = settled; i < count1; ++i) \
+                TEST_IS_EQUAL(std::fabs(buffer1dest[i] - 1.0) < 1e-4, true); \
+            \
+            resampler1.reset(); \
+            const uint32 count3 = resampler1.process(buffer1a.data(), buffer1dest.data(), size); \
+            TEST_IS_EQUAL(count3, count2); \
+            TEST_BUFFERS_ARE_EQUAL(buffer1dest.data(), buffer2dest.data(), count3); \
+            \
+            /* growing then random block sizes, each one reallocating the work buffers */ \
+            datatype##_buffer buffer3dest(resampler3.max_output_size(size) + 2); \
+            const uint32 growing[] = { 100, 150, 250, 400, 1 }; \
+            uint32 count4 = 0, seed = 12345; \
+            for (uint32 i = 0, k = 0, block = 0; i < size; i += block, ++k) \
+            { \
+                seed = seed * 1103515245 + 12345; \
+                block = std::min(size - i, k < 5 ? growing[k] : 1 + (seed >> 16) % 700); \
+                count4 += resampler3.process(buffer1a.data() + i, buffer3dest.data() + count4, block); \
+            } \
+            TEST_IS_EQUAL(count4, count2); \
+            TEST_BUFFERS_ARE_EQUAL(buffer3dest.data(), buffer2dest.data(), count4); \
+        } \
+    }
+
+#define test_sum_buffer_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_sum_buffer_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1a(s); \
+        datatype##_buffer buffer2a(s); \
+        \
+        simd->set_buffer_ ##datatype (buffer1a.data(), s, (datatype)3); \
+        fpu->set_buffer_ ##datatype (buffer2a.data(), s, (datatype)3); \
+        \
+        TEST_IS_EQUAL((double)simd->sum_buffer_ ##datatype (buffer1a.data(), s), (double)(3 * s)); \
+        TEST_IS_EQUAL((double)simd->sum_buffer_ ##datatype (buffer1a.data(), s), \
+            (double)fpu->sum_buffer_ ##datatype (buffer2a.data(), s)); \
+    }
+
+#define test_dot_product_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_dot_product_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1a(s); \
+        datatype##_buffer buffer1b(s); \
+        datatype##_buffer buffer2a(s); \
+        datatype##_buffer buffer2b(s); \
+        \
+        simd->set_buffer_ ##datatype (buffer1a.data(), s, (datatype)3); \
+        simd->set_buffer_ ##datatype (buffer1b.data(), s, (datatype)2); \
+        fpu->set_buffer_ ##datatype (buffer2a.data(), s, (datatype)3); \
+        fpu->set_buffer_ ##datatype (buffer2b.data(), s, (datatype)2); \
+        \
+        TEST_IS_EQUAL((double)simd->dot_product_ ##datatype (buffer1a.data(), buffer1b.data(), s), (double)(6 * s)); \
+        TEST_IS_EQUAL((double)simd->dot_product_ ##datatype (buffer1a.data(), buffer1b.data(), s), \
+            (double)fpu->dot_product_ ##datatype (buffer2a.data(), buffer2b.data(), s)); \
+    }
+
+#define test_min_max_buffer_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_min_max_buffer_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1a(s); \
+        uint32 index1 = 0; \
+        uint32 index2 = 0; \
+        \
+        simd->set_buffer_ ##datatype (buffer1a.data(), s, (datatype)3); \
+        buffer1a.data()[s / 3] = (datatype)1; \
+        buffer1a.data()[s / 2] = (datatype)1; \
+        buffer1a.data()[s / 4] = (datatype)7; \
+        buffer1a.data()[s - 1] = (datatype)7; \
+        \
+        TEST_IS_EQUAL(simd->min_buffer_ ##datatype (buffer1a.data(), s, &index1), (datatype)1); \
+        TEST_IS_EQUAL(fpu->min_buffer_ ##datatype (buffer1a.data(), s, &index2), (datatype)1); \
+        TEST_IS_EQUAL(index1, (uint32)(s / 3)); \
+        TEST_IS_EQUAL(index1, index2); \
+        \
+        TEST_IS_EQUAL(simd->max_buffer_ ##datatype (buffer1a.data(), s, &index1), (datatype)7); \
+        TEST_IS_EQUAL(fpu->max_buffer_ ##datatype (buffer1a.data(), s, &index2), (datatype)7); \
+        TEST_IS_EQUAL(index1, (uint32)(s / 4)); \
+        TEST_IS_EQUAL(index1, index2); \
+    }
+
+#define test_peak_abs_buffer_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_peak_abs_buffer_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1a(s); \
+        \
+        simd->set_buffer_ ##datatype (buffer1a.data(), s, (datatype)3); \
+        buffer1a.data()[s / 5] = (datatype)(datatype(-1) < datatype(0) ? -5 : 5); \
+        \
+        TEST_IS_EQUAL((double)simd->peak_abs_buffer_ ##datatype (buffer1a.data(), s), 5.0); \
+        TEST_IS_EQUAL((double)simd->peak_abs_buffer_ ##datatype (buffer1a.data(), s), \
+            (double)fpu->peak_abs_buffer_ ##datatype (buffer1a.data(), s)); \
+    }
+
+#define test_rms_buffer_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_rms_buffer_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        datatype##_buffer buffer1a(s); \
+        \
+        simd->set_buffer_ ##datatype (buffer1a.data(), s, (datatype)3); \
+        \
+        TEST_IS_EQUAL(simd->rms_buffer_ ##datatype (buffer1a.data(), s), 3.0); \
+        TEST_IS_EQUAL(simd->rms_buffer_ ##datatype (buffer1a.data(), s), \
+            fpu->rms_buffer_ ##datatype (buffer1a.data(), s)); \
+    }
+
+// integer reductions are exact, floating ones differ in the summation order
+#define test_reductions_are_near(datatype, a, b, magnitude) \
+    if (std::numeric_limits<datatype>::is_integer) \
+    { \
+        TEST_IS_EQUAL(a, b); \
+    } \
+    else \
+    { \
+        TEST_IS_MORE((sizeof(datatype) == sizeof(float) ? 1e-6 : 1e-13) * (magnitude), \
+            std::fabs((double)(a) - (double)(b))); \
+    }
+
+#define test_random_reductions_impl(simd, simd_type, datatype, s) \
+    void test_##simd##_random_reductions_##datatype() \
+    { \
+        math fpu(FORCE_FPU); \
+        math simd(simd_type); \
+        \
+        const uint32 sizes[] = random_buffer_sizes(s); \
+        const uint32 length = s + 64; \
+        uint64 state = 0xD1B54A32D192ED03ull; \
+        \
+        datatype##_buffer buffer1a(length); \
+        datatype##_buffer buffer1b(length); \
+        datatype##_buffer buffer1full(length); \
+        \
+        fill_random_buffer(datatype, buffer1a, length, state, random_arithmetic_bits(datatype)); \
+        fill_random_buffer(datatype, buffer1b, length, state, random_arithmetic_bits(datatype)); \
+        fill_random_buffer(datatype, buffer1full, length, state, 8 * sizeof(datatype)); \
+        \
+        for (uint32 n = 0; n < sizeof(sizes) / sizeof(sizes[0]); ++n) \
+        { \
+            for (uint32 run = 0; run < 4; ++run) \
+            { \
+                const uint32 size = sizes[n]; \
+                random_buffer_offsets(datatype, run, state, oa, ob, od) \
+                \
+                double sum_magnitude = 0.0, dot_magnitude = 0.0, rms_magnitude = 0.0; \
+                for (uint32 i = 0; i < size; ++i) \
+                { \
+                    sum_magnitude += std::fabs((double)buffer1a[oa + i]); \
+                    dot_magnitude += std::fabs((double)buffer1a[oa + i] * (double)buffer1b[ob + i]); \
+                    rms_magnitude = std::max(rms_magnitude, std::fabs((double)buffer1full[od + i])); \
+                } \
+                \
+                test_reductions_are_near(datatype, simd->sum_buffer_##datatype (buffer1a.data() + oa, size), \
+                    fpu->sum_buffer_##datatype (buffer1a.data() + oa, size), sum_magnitude); \
+                test_reductions_are_near(datatype, simd->dot_product_##datatype (buffer1a.data() + oa, buffer1b.data() + ob, size), \
+                    fpu->dot_product_##datatype (buffer1a.data() + oa, buffer1b.data() + ob, size), dot_magnitude); \
+                \
+                uint32 index1 = 0, index2 = 0; \
+                TEST_IS_EQUAL(simd->min_buffer_##datatype (buffer1full.data() + od, size, &index1), \
+                    fpu->min_buffer_##datatype (buffer1full.data() + od, size, &index2)); \
+                TEST_IS_EQUAL(index1, index2); \
+                TEST_IS_EQUAL(simd->max_buffer_##datatype (buffer1full.data() + od, size, &index1), \
+                    fpu->max_buffer_##datatype (buffer1full.data() + od, size, &index2)); \
+                TEST_IS_EQUAL(index1, index2); \
+                TEST_IS_EQUAL(simd->peak_abs_buffer_##datatype (buffer1full.data() + od, size), \
+                    fpu->peak_abs_buffer_##datatype (buffer1full.data() + od, size)); \
+                \
+                const double rms1 = simd->rms_buffer_##datatype (buffer1full.data() + od, size); \
+                const double rms2 = fpu->rms_buffer_##datatype (buffer1full.data() + od, size); \
+                TEST_IS_MORE((sizeof(datatype) == sizeof(float) ? 1e-6 : 1e-12) * rms_magnitude, std::fabs(rms1 - rms2)); \
+            } \
+        } \
+    }
 
 //------------------------------------------------------------------------------
 
@@ -220,9 +2526,95 @@
     test_add_buffers_impl(simd, simd_type, datatype, buffer_size) \
     test_subtract_buffers_impl(simd, simd_type, datatype, buffer_size) \
     test_multiply_buffers_impl(simd, simd_type, datatype, buffer_size) \
-    test_divide_buffers_impl(simd, simd_type, datatype, buffer_size)
+    test_divide_buffers_impl(simd, simd_type, datatype, buffer_size) \
+    test_abs_buffer_impl(simd, simd_type, datatype, buffer_size) \
+    test_random_buffers_impl(simd, simd_type, datatype, buffer_size) \
+    test_dispatch_table_impl(simd, simd_type, datatype, buffer_size)
+
+#define test_saturating_functions_for_impl_datatype(simd, simd_type, datatype) \
+    test_add_buffers_saturate_impl(simd, simd_type, datatype, buffer_size) \
+    test_subtract_buffers_saturate_impl(simd, simd_type, datatype, buffer_size) \
+    test_scale_buffer_saturate_impl(simd, simd_type, datatype, buffer_size) \
+    test_average_buffers_impl(simd, simd_type, datatype, buffer_size) \
+    test_random_saturating_impl(simd, simd_type, datatype, buffer_size)
+
+#define test_floating_functions_for_impl_datatype(simd, simd_type, datatype) \
+    test_multiply_add_buffers_impl(simd, simd_type, datatype, buffer_size) \
+    test_scale_add_buffer_impl(simd, simd_type, datatype, buffer_size) \
+    test_ramp_scale_buffer_impl(simd, simd_type, datatype, buffer_size) \
+    test_exp_ramp_scale_buffer_impl(simd, simd_type, datatype, buffer_size) \
+    test_random_floating_impl(simd, simd_type, datatype, buffer_size)
+
+#define test_mixing_functions_for_impl_datatype(simd, simd_type, datatype) \
+    test_pan_mono_to_stereo_impl(simd, simd_type, datatype, buffer_size) \
+    test_ramp_pan_mono_to_stereo_impl(simd, simd_type, datatype, buffer_size) \
+    test_balance_stereo_impl(simd, simd_type, datatype, buffer_size) \
+    test_ramp_balance_stereo_impl(simd, simd_type, datatype, buffer_size) \
+    test_mix_dry_wet_impl(simd, simd_type, datatype, buffer_size) \
+    test_ramp_mix_dry_wet_impl(simd, simd_type, datatype, buffer_size) \
+    test_interleave_buffers_impl(simd, simd_type, datatype, buffer_size) \
+    test_deinterleave_buffer_impl(simd, simd_type, datatype, buffer_size)
+
+#define test_conversion_functions_for_impl_datatype(simd, simd_type, datatype) \
+    test_convert_integer_impl(simd, simd_type, int16, datatype, 16, buffer_size) \
+    test_convert_integer_impl(simd, simd_type, int24, datatype, 24, buffer_size) \
+    test_convert_integer_impl(simd, simd_type, int32, datatype, 32, buffer_size)
+
+#define test_filter_functions_for_impl_datatype(simd, simd_type, datatype) \
+    test_process_biquad_bank_impl(simd, simd_type, datatype, buffer_size) \
+    test_process_polyphase_impl(simd, simd_type, datatype, buffer_size)
+
+#define test_transform_functions_for_impl_datatype(simd, simd_type, datatype) \
+    test_fft_impl(simd, simd_type, datatype, buffer_size)
+
+#define test_dynamics_functions_for_impl_datatype(simd, simd_type, datatype) \
+    test_process_envelope_bank_impl(simd, simd_type, datatype, buffer_size) \
+    test_compressor_gain_buffer_impl(simd, simd_type, datatype, buffer_size) \
+    test_limiter_gain_buffer_impl(simd, simd_type, datatype, buffer_size) \
+    test_soft_clip_buffer_impl(simd, simd_type, datatype, buffer_size)
+
+#define test_transcendental_functions_for_impl_datatype(simd, simd_type, datatype) \
+    test_exp_buffer_impl(simd, simd_type, datatype, buffer_size) \
+    test_log_buffer_impl(simd, simd_type, datatype, buffer_size) \
+    test_sincos_buffer_impl(simd, simd_type, datatype, buffer_size) \
+    test_sincos_ulp_impl(simd, simd_type, datatype, buffer_size) \
+    test_sincos_large_impl(simd, simd_type, datatype, buffer_size) \
+    test_tanh_buffer_impl(simd, simd_type, datatype, buffer_size) \
+    test_pow_buffer_impl(simd, simd_type, datatype, buffer_size) \
+    test_transcendental_denormals_impl(simd, simd_type, datatype, buffer_size)
+
+#define test_pixel_functions_for_impl_datatype(simd, simd_type, datatype) \
+    test_premultiply_rgba_impl(simd, simd_type, datatype, buffer_size) \
+    test_unpremultiply_rgba_impl(simd, simd_type, datatype, buffer_size) \
+    test_composite_rgba_impl(simd, simd_type, datatype, buffer_size)
+
+#define test_color_functions_for_impl_datatype(simd, simd_type, datatype) \
+    test_rgba_to_gray_impl(simd, simd_type, datatype, buffer_size) \
+    test_rgba_to_yuv_impl(simd, simd_type, datatype, buffer_size) \
+    test_pack_rgba_planes_impl(simd, simd_type, datatype, buffer_size)
+
+#define test_image_functions_for_impl_datatype(simd, simd_type, datatype) \
+    test_convolve_image_impl(simd, simd_type, datatype, buffer_size) \
+    test_box_blur_impl(simd, simd_type, datatype, buffer_size) \
+    test_gaussian_blur_impl(simd, simd_type, datatype, buffer_size)
+
+#define test_resize_functions_for_impl_datatype(simd, simd_type, datatype) \
+    test_resize_image_impl(simd, simd_type, datatype, buffer_size)
+
+#define test_convolution_functions_for_impl_datatype(simd, simd_type, datatype) \
+    test_fir_convolver_impl(simd, simd_type, datatype, buffer_size) \
+    test_resampler_impl(simd, simd_type, datatype, buffer_size)
+
+#define test_reduction_functions_for_impl_datatype(simd, simd_type, datatype) \
+    test_sum_buffer_impl(simd, simd_type, datatype, buffer_size) \
+    test_dot_product_impl(simd, simd_type, datatype, buffer_size) \
+    test_min_max_buffer_impl(simd, simd_type, datatype, buffer_size) \
+    test_peak_abs_buffer_impl(simd, simd_type, datatype, buffer_size) \
+    test_rms_buffer_impl(simd, simd_type, datatype, buffer_size) \
+    test_random_reductions_impl(simd, simd_type, datatype, buffer_size)
 
 #define test_functions_for_impl(simd, simd_type) \
+    test_backend_impl(simd, simd_type); \
     test_functions_for_impl_datatype(simd, simd_type, int8); \
     test_functions_for_impl_datatype(simd, simd_type, uint8); \
     test_functions_for_impl_datatype(simd, simd_type, int16); \
@@ -232,7 +2624,42 @@
     test_functions_for_impl_datatype(simd, simd_type, int64); \
     test_functions_for_impl_datatype(simd, simd_type, uint64); \
     test_functions_for_impl_datatype(simd, simd_type, float); \
-    test_functions_for_impl_datatype(simd, simd_type, double);
+    test_functions_for_impl_datatype(simd, simd_type, double); \
+    test_saturating_functions_for_impl_datatype(simd, simd_type, int8); \
+    test_saturating_functions_for_impl_datatype(simd, simd_type, uint8); \
+    test_saturating_functions_for_impl_datatype(simd, simd_type, int16); \
+    test_saturating_functions_for_impl_datatype(simd, simd_type, uint16); \
+    test_floating_functions_for_impl_datatype(simd, simd_type, float); \
+    test_floating_functions_for_impl_datatype(simd, simd_type, double); \
+    test_mixing_functions_for_impl_datatype(simd, simd_type, float); \
+    test_mixing_functions_for_impl_datatype(simd, simd_type, double); \
+    test_conversion_functions_for_impl_datatype(simd, simd_type, float); \
+    test_conversion_functions_for_impl_datatype(simd, simd_type, double); \
+    test_filter_functions_for_impl_datatype(simd, simd_type, float); \
+    test_filter_functions_for_impl_datatype(simd, simd_type, double); \
+    test_transform_functions_for_impl_datatype(simd, simd_type, float); \
+    test_transform_functions_for_impl_datatype(simd, simd_type, double); \
+    test_dynamics_functions_for_impl_datatype(simd, simd_type, float); \
+    test_dynamics_functions_for_impl_datatype(simd, simd_type, double); \
+    test_transcendental_functions_for_impl_datatype(simd, simd_type, float); \
+    test_transcendental_functions_for_impl_datatype(simd, simd_type, double); \
+    test_pixel_functions_for_impl_datatype(simd, simd_type, uint8); \
+    test_pixel_functions_for_impl_datatype(simd, simd_type, float); \
+    test_color_functions_for_impl_datatype(simd, simd_type, uint8); \
+    test_image_functions_for_impl_datatype(simd, simd_type, float); \
+    test_resize_functions_for_impl_datatype(simd, simd_type, uint8); \
+    test_resize_functions_for_impl_datatype(simd, simd_type, float); \
+    test_convolution_functions_for_impl_datatype(simd, simd_type, float); \
+    test_reduction_functions_for_impl_datatype(simd, simd_type, int8); \
+    test_reduction_functions_for_impl_datatype(simd, simd_type, uint8); \
+    test_reduction_functions_for_impl_datatype(simd, simd_type, int16); \
+    test_reduction_functions_for_impl_datatype(simd, simd_type, uint16); \
+    test_reduction_functions_for_impl_datatype(simd, simd_type, int32); \
+    test_reduction_functions_for_impl_datatype(simd, simd_type, uint32); \
+    test_reduction_functions_for_impl_datatype(simd, simd_type, int64); \
+    test_reduction_functions_for_impl_datatype(simd, simd_type, uint64); \
+    test_reduction_functions_for_impl_datatype(simd, simd_type, float); \
+    test_reduction_functions_for_impl_datatype(simd, simd_type, double);
 
 
 //------------------------------------------------------------------------------
@@ -253,7 +2680,103 @@
     add_test_macro(test_buffers, add_buffers, simd, datatype); \
     add_test_macro(test_buffers, subtract_buffers, simd, datatype); \
     add_test_macro(test_buffers, multiply_buffers, simd, datatype); \
-    add_test_macro(test_buffers, divide_buffers, simd, datatype);
+    add_test_macro(test_buffers, divide_buffers, simd, datatype); \
+    add_test_macro(test_buffers, abs_buffer, simd, datatype); \
+    add_test_macro(test_buffers, random_buffers, simd, datatype); \
+    add_test_macro(test_buffers, dispatch_table, simd, datatype);
+
+#define add_saturating_tests_for_impl_datatype(simd, datatype) \
+    add_test_macro(test_buffers, add_buffers_saturate, simd, datatype); \
+    add_test_macro(test_buffers, subtract_buffers_saturate, simd, datatype); \
+    add_test_macro(test_buffers, scale_buffer_saturate, simd, datatype); \
+    add_test_macro(test_buffers, average_buffers, simd, datatype); \
+    add_test_macro(test_buffers, random_saturating, simd, datatype);
+
+#define add_floating_tests_for_impl_datatype(simd, datatype) \
+    add_test_macro(test_buffers, multiply_add_buffers, simd, datatype); \
+    add_test_macro(test_buffers, scale_add_buffer, simd, datatype); \
+    add_test_macro(test_buffers, ramp_scale_buffer, simd, datatype); \
+    add_test_macro(test_buffers, exp_ramp_scale_buffer, simd, datatype); \
+    add_test_macro(test_buffers, random_floating, simd, datatype);
+
+#define add_mixing_tests_for_impl_datatype(simd, datatype) \
+    add_test_macro(test_buffers, pan_mono_to_stereo, simd, datatype); \
+    add_test_macro(test_buffers, ramp_pan_mono_to_stereo, simd, datatype); \
+    add_test_macro(test_buffers, balance_stereo, simd, datatype); \
+    add_test_macro(test_buffers, ramp_balance_stereo, simd, datatype); \
+    add_test_macro(test_buffers, mix_dry_wet, simd, datatype); \
+    add_test_macro(test_buffers, ramp_mix_dry_wet, simd, datatype); \
+    add_test_macro(test_buffers, interleave_buffers, simd, datatype); \
+    add_test_macro(test_buffers, deinterleave_buffer, simd, datatype);
+
+#define add_conversion_tests_for_impl_datatype(simd, datatype) \
+    add_test_macro(test_buffers, convert_int16, simd, datatype); \
+    add_test_macro(test_buffers, convert_int24, simd, datatype); \
+    add_test_macro(test_buffers, convert_int32, simd, datatype);
+
+#define add_filter_tests_for_impl_datatype(simd, datatype) \
+    add_test_macro(test_buffers, process_biquad_bank, simd, datatype); \
+    add_test_macro(test_buffers, process_polyphase, simd, datatype);
+
+#define add_transform_tests_for_impl_datatype(simd, datatype) \
+    add_test_macro(test_buffers, fft, simd, datatype);
+
+#define add_dynamics_tests_for_impl_datatype(simd, datatype) \
+    add_test_macro(test_buffers, process_envelope_bank, simd, datatype); \
+    add_test_macro(test_buffers, compressor_gain_buffer, simd, datatype); \
+    add_test_macro(test_buffers, limiter_gain_buffer, simd, datatype); \
+    add_test_macro(test_buffers, soft_clip_buffer, simd, datatype);
+
+#define add_transcendental_tests_for_impl_datatype(simd, datatype) \
+    add_test_macro(test_buffers, exp_buffer, simd, datatype); \
+    add_test_macro(test_buffers, log_buffer, simd, datatype); \
+    add_test_macro(test_buffers, sincos_buffer, simd, datatype); \
+    add_test_macro(test_buffers, sincos_ulp, simd, datatype); \
+    add_test_macro(test_buffers, sincos_large, simd, datatype); \
+    add_test_macro(test_buffers, tanh_buffer, simd, datatype); \
+    add_test_macro(test_buffers, pow_buffer, simd, datatype); \
+    add_test_macro(test_buffers, transcendental_denormals, simd, datatype);
+
+#define add_pixel_tests_for_impl_datatype(simd, datatype) \
+    add_test_macro(test_buffers, premultiply_rgba, simd, datatype); \
+    add_test_macro(test_buffers, unpremultiply_rgba, simd, datatype); \
+    add_test_macro(test_buffers, composite_rgba, simd, datatype);
+
+#define add_color_tests_for_impl_datatype(simd, datatype) \
+    add_test_macro(test_buffers, rgba_to_gray, simd, datatype); \
+    add_test_macro(test_buffers, rgba_to_yuv, simd, datatype); \
+    add_test_macro(test_buffers, pack_rgba_planes, simd, datatype);
+
+#define add_image_tests_for_impl_datatype(simd, datatype) \
+    add_test_macro(test_buffers, convolve_image, simd, datatype); \
+    add_test_macro(test_buffers, box_blur, simd, datatype); \
+    add_test_macro(test_buffers, gaussian_blur, simd, datatype);
+
+#define add_resize_tests_for_impl_datatype(simd, datatype) \
+    add_test_macro(test_buffers, resize_image, simd, datatype);
+
+#define add_convolution_tests_for_impl_datatype(simd, datatype) \
+    add_test_macro(test_buffers, fir_convolver, simd, datatype); \
+    add_test_macro(test_buffers, resampler, simd, datatype);
+
+#define add_reduction_tests_for_impl_datatype(simd, datatype) \
+    add_test_macro(test_buffers, sum_buffer, simd, datatype); \
+    add_test_macro(test_buffers, dot_product, simd, datatype); \
+    add_test_macro(test_buffers, min_max_buffer, simd, datatype); \
+    add_test_macro(test_buffers, peak_abs_buffer, simd, datatype); \
+    add_test_macro(test_buffers, rms_buffer, simd, datatype); \
+    add_test_macro(test_buffers, random_reductions, simd, datatype);
+
+#define add_supported_tests_for_impl(simd, simd_type) \
+    if (math::is_supported(simd_type)) \
+    { \
+        add_test_macro_no_datatype(test_buffers, backend, simd); \
+        add_tests_for_impl(simd); \
+    } \
+    else \
+    { \
+        std::clog << "Skipping " #simd " tests, not supported by this processor" << std::endl; \
+    }
 
 #define add_tests_for_impl(simd) \
     add_tests_for_impl_datatype(simd, int8); \
@@ -265,7 +2788,42 @@
     add_tests_for_impl_datatype(simd, int64); \
     add_tests_for_impl_datatype(simd, uint64); \
     add_tests_for_impl_datatype(simd, float); \
-    add_tests_for_impl_datatype(simd, double);
+    add_tests_for_impl_datatype(simd, double); \
+    add_saturating_tests_for_impl_datatype(simd, int8); \
+    add_saturating_tests_for_impl_datatype(simd, uint8); \
+    add_saturating_tests_for_impl_datatype(simd, int16); \
+    add_saturating_tests_for_impl_datatype(simd, uint16); \
+    add_floating_tests_for_impl_datatype(simd, float); \
+    add_floating_tests_for_impl_datatype(simd, double); \
+    add_mixing_tests_for_impl_datatype(simd, float); \
+    add_mixing_tests_for_impl_datatype(simd, double); \
+    add_conversion_tests_for_impl_datatype(simd, float); \
+    add_conversion_tests_for_impl_datatype(simd, double); \
+    add_filter_tests_for_impl_datatype(simd, float); \
+    add_filter_tests_for_impl_datatype(simd, double); \
+    add_transform_tests_for_impl_datatype(simd, float); \
+    add_transform_tests_for_impl_datatype(simd, double); \
+    add_dynamics_tests_for_impl_datatype(simd, float); \
+    add_dynamics_tests_for_impl_datatype(simd, double); \
+    add_transcendental_tests_for_impl_datatype(simd, float); \
+    add_transcendental_tests_for_impl_datatype(simd, double); \
+    add_pixel_tests_for_impl_datatype(simd, uint8); \
+    add_pixel_tests_for_impl_datatype(simd, float); \
+    add_color_tests_for_impl_datatype(simd, uint8); \
+    add_image_tests_for_impl_datatype(simd, float); \
+    add_resize_tests_for_impl_datatype(simd, uint8); \
+    add_resize_tests_for_impl_datatype(simd, float); \
+    add_convolution_tests_for_impl_datatype(simd, float); \
+    add_reduction_tests_for_impl_datatype(simd, int8); \
+    add_reduction_tests_for_impl_datatype(simd, uint8); \
+    add_reduction_tests_for_impl_datatype(simd, int16); \
+    add_reduction_tests_for_impl_datatype(simd, uint16); \
+    add_reduction_tests_for_impl_datatype(simd, int32); \
+    add_reduction_tests_for_impl_datatype(simd, uint32); \
+    add_reduction_tests_for_impl_datatype(simd, int64); \
+    add_reduction_tests_for_impl_datatype(simd, uint64); \
+    add_reduction_tests_for_impl_datatype(simd, float); \
+    add_reduction_tests_for_impl_datatype(simd, double);
 
 
 //------------------------------------------------------------------------------
@@ -277,32 +2835,71 @@ public:
         : buffer_size(8192)
     {
         // add tests
+        add_test("test_buffers::test_math_factory",
+            static_cast<test_runner::test_function>(&test_buffers::test_math_factory));
+
 #if defined(WATERSPOUT_SIMD_MMX)
-        add_tests_for_impl(mmx);
+        add_supported_tests_for_impl(mmx, FORCE_MMX)
 #endif
 #if defined(WATERSPOUT_SIMD_SSE)
-        add_tests_for_impl(sse);
+        add_supported_tests_for_impl(sse, FORCE_SSE)
 #endif
 #if defined(WATERSPOUT_SIMD_SSE2)
-        add_tests_for_impl(sse2);
+        add_supported_tests_for_impl(sse2, FORCE_SSE2)
 #endif
 #if defined(WATERSPOUT_SIMD_SSE3)
-        add_tests_for_impl(sse3);
+        add_supported_tests_for_impl(sse3, FORCE_SSE3)
 #endif
 #if defined(WATERSPOUT_SIMD_SSSE3)
-        add_tests_for_impl(ssse3);
+        add_supported_tests_for_impl(ssse3, FORCE_SSSE3)
 #endif
 #if defined(WATERSPOUT_SIMD_SSE41)
-        add_tests_for_impl(sse41);
+        add_supported_tests_for_impl(sse41, FORCE_SSE41)
 #endif
 #if defined(WATERSPOUT_SIMD_SSE42)
-        add_tests_for_impl(sse42);
+        add_supported_tests_for_impl(sse42, FORCE_SSE42)
 #endif
 #if defined(WATERSPOUT_SIMD_AVX)
-        add_tests_for_impl(avx);
+        add_supported_tests_for_impl(avx, FORCE_AVX)
 #endif
 #if defined(WATERSPOUT_SIMD_AVX2)
-        add_tests_for_impl(avx2);
+        add_supported_tests_for_impl(avx2, FORCE_AVX2)
+#endif
+#if defined(WATERSPOUT_SIMD_AVX512)
+        add_supported_tests_for_impl(avx512, FORCE_AVX512)
+#endif
+#if defined(WATERSPOUT_SIMD_NEON)
+        add_supported_tests_for_impl(neon, FORCE_NEON)
+#endif
+    }
+
+    // forcing an instruction set without fallback throws when it can't run
+    void test_math_factory()
+    {
+        for (int flag = FORCE_FPU; flag <= FORCE_AVX512; ++flag)
+        {
+            bool thrown = false;
+
+            try
+            {
+                math m(flag, false);
+            }
+            catch (std::runtime_error&)
+            {
+                thrown = true;
+            }
+
+            TEST_IS_EQUAL(thrown, ! math::is_supported(flag));
+        }
+
+        TEST_IS_EQUAL(math::is_supported(FORCE_FPU), true);
+        TEST_IS_EQUAL(std::string(math(FORCE_FPU, false).name()), std::string("FPU"));
+
+#if defined(WATERSPOUT_SIMD_NEON)
+        // the whole binary targets neon, so a run that skips the neon tests
+        // (a broken cpu_has_neon) must not pass as green
+        TEST_IS_EQUAL(math::is_supported(FORCE_NEON), true);
+        TEST_IS_EQUAL(std::string(math(FORCE_NEON, false).name()), std::string("NEON"));
 #endif
     }
 
@@ -334,6 +2931,12 @@ public:
 #if defined(WATERSPOUT_SIMD_AVX2)
     test_functions_for_impl(avx2, FORCE_AVX2)
 #endif
+#if defined(WATERSPOUT_SIMD_AVX512)
+    test_functions_for_impl(avx512, FORCE_AVX512)
+#endif
+#if defined(WATERSPOUT_SIMD_NEON)
+    test_functions_for_impl(neon, FORCE_NEON)
+#endif
 
 private:
 